@@ -77,6 +77,14 @@ float analogReadTemp();  // Returns core temp in Centigrade
 void analogWriteFreq(uint32_t freq);
 void analogWriteRange(uint32_t range);
 void analogWriteResolution(int res);
+// Streams raw compare values out a pin, one per PWM period, using DMA
+bool analogWriteStream(pin_size_t pin, const uint16_t *samples, size_t count, bool loop);
+void analogWriteStreamStop(pin_size_t pin);
+bool analogWriteStreamBusy(pin_size_t pin);
+
+// GPIO RP2040-specific calls, all of the masked pins change or are sampled together
+void digitalWriteMask(uint32_t mask, uint32_t values);
+uint32_t digitalReadAll();
 
 // FreeRTOS potential calls
 extern bool __isFreeRTOS;
@@ -106,12 +114,32 @@ extern bool __isFreeRTOS;
 #include "Adafruit_USBD_CDC.h"
 #else
 #include "SerialUSB.h"
+#include "USBBulk.h"
+#include "USBMassStorage.h"
+#include "USBHost.h"
 #endif
 
 #include "SerialUART.h"
 #include "RP2040Support.h"
+#include "MulticoreQueue.h"
+#include "RingBufferSPSC.h"
+#include "LinePrint.h"
+#include "MemoryPool.h"
+#include "TimerWheel.h"
+#include "DMAChannel.h"
+#include "Interpolator.h"
+#include "Profiler.h"
+#include "PCSampler.h"
+#include "MallocTrace.h"
+#include "CrashDump.h"
 #include "SerialPIO.h"
+#include "PIOCounter.h"
+#include "EdgeCapture.h"
+#include "PIOShifter.h"
+#include "PIONeoPixel.h"
 #include "Bootsel.h"
+#include "FlashService.h"
+#include "FastPin.h"
 
 // Template which will evaluate at *compile time* to a single 32b number
 // with the specified bits set.
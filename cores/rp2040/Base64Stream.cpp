@@ -0,0 +1,105 @@
+/*
+    Base64Stream - Incremental base64 encoding and decoding into any Print
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <algorithm>
+#include "Base64Stream.h"
+
+// Input bytes encoded per write to out, a whole number of 3-byte groups
+#define B64_ENC_CHUNK 96
+// Characters decoded per write to out, a whole number of 4-character groups
+#define B64_DEC_CHUNK 128
+
+Base64EncodeStream::Base64EncodeStream(Print &out, bool doNewLines) {
+    _out = &out;
+    _encoded = 0;
+    if (doNewLines) {
+        base64_init_encodestate(&_state);
+    } else {
+        base64_init_encodestate_nonewlines(&_state);
+    }
+}
+
+size_t Base64EncodeStream::write(const uint8_t *data, size_t len) {
+    // 4 characters per group plus at most one newline per 72 characters
+    char buf[B64_ENC_CHUNK / 3 * 4 + B64_ENC_CHUNK / 54 + 2];
+    size_t done = 0;
+    while (done < len) {
+        size_t n = std::min((size_t)B64_ENC_CHUNK, len - done);
+        size_t chars = base64_encode_block((const char *)data + done, n, buf, &_state);
+        size_t w = _out->write((const uint8_t *)buf, chars);
+        _encoded += w;
+        if (w != chars) {
+            // The encoder state has moved past these bytes, so they can't be retried
+            setWriteError();
+            break;
+        }
+        done += n;
+    }
+    return done;
+}
+
+int Base64EncodeStream::availableForWrite() {
+    // Let Stream::sendAll() size its chunks so the encoded output fits in one write
+    int room = _out->availableForWrite();
+    return (room > 0) ? std::max(1, room / 4 * 3) : room;
+}
+
+size_t Base64EncodeStream::end() {
+    char buf[4];
+    size_t chars = base64_encode_blockend(buf, &_state);
+    size_t w = _out->write((const uint8_t *)buf, chars);
+    _encoded += w;
+    if (w != chars) {
+        setWriteError();
+    }
+    return w;
+}
+
+size_t Base64EncodeStream::encodedLength(size_t len, bool doNewLines) {
+    size_t chars = (len + 2) / 3 * 4;
+    if (doNewLines) {
+        chars += len / 3 / (BASE64_CHARS_PER_LINE / 4);
+    }
+    return chars;
+}
+
+Base64DecodeStream::Base64DecodeStream(Print &out) {
+    _out = &out;
+    _decoded = 0;
+    base64_init_decodestate(&_state);
+}
+
+size_t Base64DecodeStream::write(const uint8_t *data, size_t len) {
+    // The decoder always stores the partial next byte after the ones it returns
+    char buf[B64_DEC_CHUNK / 4 * 3 + 1];
+    size_t done = 0;
+    while (done < len) {
+        size_t n = std::min((size_t)B64_DEC_CHUNK, len - done);
+        size_t bytes = base64_decode_block((const char *)data + done, n, buf, &_state);
+        size_t w = _out->write((const uint8_t *)buf, bytes);
+        _decoded += w;
+        if (w != bytes) {
+            setWriteError();
+            break;
+        }
+        done += n;
+    }
+    return done;
+}
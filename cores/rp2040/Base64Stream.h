@@ -0,0 +1,93 @@
+/*
+    Base64Stream - Incremental base64 encoding and decoding into any Print
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include "Print.h"
+#include "libb64/cencode.h"
+#include "libb64/cdecode.h"
+
+// Everything written is base64 encoded on the fly and passed on to out, a small
+// block at a time, so nothing the size of the whole payload is ever held in RAM.
+// Call end() once done to emit the final group and its '=' padding.
+//
+//     Base64EncodeStream b64(client);
+//     file.sendAll(b64);
+//     b64.end();
+class Base64EncodeStream : public Print {
+public:
+    // The libb64 default is a newline every 72 characters, which breaks URIs and JSON
+    Base64EncodeStream(Print &out, bool doNewLines = false);
+
+    virtual size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+    virtual size_t write(const uint8_t *data, size_t len) override;
+    virtual int availableForWrite() override;
+    virtual void flush() override {
+        _out->flush();
+    }
+    using Print::write;
+
+    // Writes any final partial group with its padding.  Returns the characters written
+    size_t end();
+
+    // Characters written to out so far
+    size_t encoded() const {
+        return _encoded;
+    }
+
+    // The final length of encoding len bytes, to send as a Content-Length up front
+    static size_t encodedLength(size_t len, bool doNewLines = false);
+
+private:
+    Print *_out;
+    base64_encodestate _state;
+    size_t _encoded;
+};
+
+// Base64 text written in is decoded on the fly and the binary passed on to out.
+// Whitespace and other non-base64 characters, including the padding, are skipped.
+//
+//     Base64DecodeStream bin(file);
+//     http.writeToPrint(&bin);
+class Base64DecodeStream : public Print {
+public:
+    Base64DecodeStream(Print &out);
+
+    virtual size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+    virtual size_t write(const uint8_t *data, size_t len) override;
+    virtual void flush() override {
+        _out->flush();
+    }
+    using Print::write;
+
+    // Bytes written to out so far
+    size_t decoded() const {
+        return _decoded;
+    }
+
+private:
+    Print *_out;
+    base64_decodestate _state;
+    size_t _decoded;
+};
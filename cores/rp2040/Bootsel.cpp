@@ -21,13 +21,23 @@
 // This doesn't work if others are trying to access flash at the same time,
 // e.g. XIP streamer, or the other core.
 
-static bool __no_inline_not_in_flash_func(get_bootsel_button)() {
+// Takes the button state from the CS pin once the other core is out of flash.  Called
+// from the sampler IRQ it doesn't wait for a flash write from the other core to finish,
+// and just returns false without sampling.
+static bool __no_inline_not_in_flash_func(get_bootsel_button)(bool *state, bool fromIRQ) {
     const uint CS_PIN_INDEX = 1;
 
     // Must disable interrupts, as interrupt handlers may be in flash, and we
     // are about to temporarily disable flash access!
     noInterrupts();
-    rp2040.idleOtherCore();
+    if (fromIRQ) {
+        if (!rp2040.tryIdleOtherCore()) {
+            interrupts();
+            return false;
+        }
+    } else {
+        rp2040.idleOtherCore();
+    }
 
     // Set chip select to Hi-Z
     hw_write_masked(&ioqspi_hw->io[CS_PIN_INDEX].ctrl,
@@ -50,11 +60,58 @@ static bool __no_inline_not_in_flash_func(get_bootsel_button)() {
     rp2040.resumeOtherCore();
     interrupts();
 
-    return button_state;
+    *state = button_state;
+    return true;
 }
 
 __Bootsel::operator bool() {
-    return get_bootsel_button();
+    if (_running) {
+        return _state;
+    }
+    bool state;
+    get_bootsel_button(&state, false);
+    return state;
+}
+
+bool __Bootsel::_sample(repeating_timer_t *t) {
+    __Bootsel *b = (__Bootsel *)t->user_data;
+    bool state;
+    if (!get_bootsel_button(&state, true)) {
+        return true; // Flash is busy, try again next time
+    }
+    if (state != b->_last) {
+        b->_last = state;
+        b->_count = 1;
+    } else if (b->_count < b->_debounce) {
+        b->_count++;
+    }
+    if ((b->_count >= b->_debounce) && (state != b->_state)) {
+        b->_state = state;
+        if (b->_cb) {
+            b->_cb(state);
+        }
+    }
+    return true;
+}
+
+bool __Bootsel::begin(uint32_t intervalMs, uint8_t debounce) {
+    if (__isFreeRTOS || !intervalMs) {
+        return false;
+    }
+    end();
+    _debounce = debounce ? debounce : 1;
+    get_bootsel_button(&_last, false);
+    _state = _last;
+    _count = _debounce;
+    _running = add_repeating_timer_ms(intervalMs, _sample, this, &_timer);
+    return _running;
+}
+
+void __Bootsel::end() {
+    if (_running) {
+        cancel_repeating_timer(&_timer);
+        _running = false;
+    }
 }
 
 __Bootsel BOOTSEL;
@@ -20,10 +20,37 @@
 
 #pragma once
 
+#include <stdint.h>
+#include "pico/time.h"
+
+// Reading BOOTSEL stops flash access, so interrupts are off and the other core is idled for
+// the ~10us it takes.  Polling it in loop() therefore stalls the whole chip each time.  After
+// begin() it is instead sampled from a timer every intervalMs, skipping any sample which would
+// collide with a flash write, and reads just return the debounced state.
 class __Bootsel {
 public:
     __Bootsel() { }
     operator bool();
+
+    // The state must be the same for debounce samples in a row before it changes
+    bool begin(uint32_t intervalMs = 10, uint8_t debounce = 3);
+    void end();
+
+    // Called from the timer IRQ on each debounced change
+    void onChange(void (*cb)(bool pressed)) {
+        _cb = cb;
+    }
+
+private:
+    static bool _sample(repeating_timer_t *t);
+
+    void (*volatile _cb)(bool pressed) = nullptr;
+    volatile bool _state = false;
+    bool _last = false;
+    uint8_t _count = 0;
+    uint8_t _debounce = 0;
+    bool _running = false;
+    repeating_timer_t _timer;
 };
 
 extern __Bootsel BOOTSEL;
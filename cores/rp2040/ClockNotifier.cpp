@@ -0,0 +1,144 @@
+/*
+    Notifications for drivers when the system clock changes at runtime
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <hardware/clocks.h>
+#include <hardware/vreg.h>
+#include <pico/stdlib.h>
+#include "ClockNotifier.h"
+#include "FlashService.h"
+#include <algorithm>
+
+// Held across the whole change, so a driver stopping on the other core can't be called halfway
+auto_init_mutex(_clockMutex);
+static ClockNotifier *_clockNotifiers = nullptr;
+static enum vreg_voltage _vreg = VREG_VOLTAGE_DEFAULT;
+
+// Overclocks past 250MHz need more than the default 1.10V core voltage to be stable
+static enum vreg_voltage _vregFor(uint32_t hz) {
+#ifdef RP2040_VREG_VOLTAGE
+    (void) hz;
+    return RP2040_VREG_VOLTAGE;
+#else
+    if (hz > 275000000) {
+        return VREG_VOLTAGE_1_20;
+    } else if (hz > 250000000) {
+        return VREG_VOLTAGE_1_15;
+    }
+    return VREG_VOLTAGE_DEFAULT;
+#endif
+}
+
+// The voltage and flash divider a faster clock needs are put in place before it starts, and
+// relaxed only once a slower one is running
+static void _changeSysClock(uint32_t hz, uint vco, uint postdiv1, uint postdiv2) {
+    uint32_t old = clock_get_hz(clk_sys);
+    enum vreg_voltage v = _vregFor(hz);
+    if (v > _vreg) {
+        vreg_set_voltage(v);
+        _vreg = v;
+        busy_wait_us_32(1000); // Let the regulator settle
+    }
+    if (hz != old) {
+        __flashSetClockDivider(std::max(__flashClockDivider(old), __flashClockDivider(hz)));
+        set_sys_clock_pll(vco, postdiv1, postdiv2);
+    }
+    __flashSetClockDivider(__flashClockDivider(hz));
+    if (v < _vreg) {
+        vreg_set_voltage(v);
+        _vreg = v;
+    }
+}
+
+void ClockNotifier::attach() {
+    CoreMutex m(&_clockMutex);
+    if (!m || _attached) {
+        return;
+    }
+    _next = _clockNotifiers;
+    _clockNotifiers = this;
+    _attached = true;
+}
+
+void ClockNotifier::detach() {
+    CoreMutex m(&_clockMutex);
+    if (!m || !_attached) {
+        return;
+    }
+    for (ClockNotifier **p = &_clockNotifiers; *p; p = &(*p)->_next) {
+        if (*p == this) {
+            *p = _next;
+            break;
+        }
+    }
+    _next = nullptr;
+    _attached = false;
+}
+
+bool __setSysClock(uint32_t hz) {
+    uint vco, postdiv1, postdiv2;
+    if (__isFreeRTOS || (hz % 1000) || !check_sys_clock_khz(hz / 1000, &vco, &postdiv1, &postdiv2)) {
+        return false;
+    }
+    CoreMutex m(&_clockMutex);
+    if (!m) {
+        return false;
+    }
+    if (clock_get_hz(clk_sys) == hz) {
+        return true;
+    }
+    for (ClockNotifier *n = _clockNotifiers; n; n = n->_next) {
+        n->_cb(n->_arg, false);
+    }
+    _changeSysClock(hz, vco, postdiv1, postdiv2);
+    for (ClockNotifier *n = _clockNotifiers; n; n = n->_next) {
+        n->_cb(n->_arg, true);
+    }
+    return true;
+}
+
+void __initSysClock(uint32_t hz) {
+    uint vco, postdiv1, postdiv2;
+    if (check_sys_clock_khz(hz / 1000, &vco, &postdiv1, &postdiv2)) {
+        _changeSysClock(hz, vco, postdiv1, postdiv2);
+    }
+}
+
+bool __sysClockStop(void (*fn)(void *arg), void *arg) {
+    uint vco, postdiv1, postdiv2;
+    uint32_t hz = clock_get_hz(clk_sys);
+    if (__isFreeRTOS || !check_sys_clock_khz(hz / 1000, &vco, &postdiv1, &postdiv2)) {
+        return false;
+    }
+    CoreMutex m(&_clockMutex);
+    if (!m) {
+        return false;
+    }
+    for (ClockNotifier *n = _clockNotifiers; n; n = n->_next) {
+        n->_cb(n->_arg, false);
+    }
+    fn(arg);
+    clocks_init(); // Back to the boot clocks, then up to where we were
+    _changeSysClock(hz, vco, postdiv1, postdiv2);
+    for (ClockNotifier *n = _clockNotifiers; n; n = n->_next) {
+        n->_cb(n->_arg, true);
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+/*
+    Notifications for drivers when the system clock changes at runtime
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// Drivers whose dividers come from clk_sys (or clk_peri, which the SDK moves along with it)
+// keep one of these attached while running.  __setSysClock() calls every attached notifier
+// with after=false before the change, so it can let anything in flight finish, and with
+// after=true once the new clock is running, so it can recompute its dividers.  Callbacks run
+// in the caller's context, and must not attach or detach notifiers themselves.
+typedef void (*ClockNotifierCB)(void *arg, bool after);
+
+class ClockNotifier {
+public:
+    ClockNotifier(ClockNotifierCB cb, void *arg) : _cb(cb), _arg(arg) { }
+    ~ClockNotifier() {
+        detach();
+    }
+
+    void attach();
+    void detach();
+
+private:
+    friend bool __setSysClock(uint32_t hz);
+    friend bool __sysClockStop(void (*fn)(void *arg), void *arg);
+
+    ClockNotifierCB _cb;
+    void *_arg;
+    ClockNotifier *_next = nullptr;
+    bool _attached = false;
+};
+
+// Moves clk_sys to hz (which must be reachable by the system PLL) and lets every attached
+// notifier reprogram its hardware.  Not available under FreeRTOS, whose tick is clk_sys based.
+// The core voltage and flash clock divider are adjusted to suit the new clock.
+extern bool __setSysClock(uint32_t hz);
+
+// Boot time version for F_CPU, before anything needs notifying
+extern void __initSysClock(uint32_t hz);
+
+// For sleep modes: notifies as for a clock change, runs fn (which may stop the PLLs and
+// oscillators) and then brings the clocks back up at the current frequency before notifying
+// again.  Not available under FreeRTOS.
+extern bool __sysClockStop(void (*fn)(void *arg), void *arg);
@@ -0,0 +1,90 @@
+/*
+    Per-core CPU load accounting for the setup()/loop() and setup1()/loop1() model
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+
+// Each core is always "in" exactly one bucket.  Switching buckets charges the time since
+// the last switch to the old one, so nested states (an IRQ during delay() during loop())
+// are each only counted once.
+typedef struct {
+    uint64_t last;
+    uint8_t cur;
+    uint64_t us[CORELOAD_BUCKETS];
+} CoreLoadState;
+
+static CoreLoadState _coreLoad[2];
+static volatile bool _coreLoadEnabled = false;
+// Only held for a few instructions, but lets either core read the other's totals consistently
+static spin_lock_t *_coreLoadLock = spin_lock_instance(next_striped_spin_lock_num());
+
+uint8_t __not_in_flash_func(__coreLoadSwitch)(uint8_t next) {
+    CoreLoadState *c = &_coreLoad[get_core_num()];
+    if (!_coreLoadEnabled) {
+        uint8_t prev = c->cur;
+        c->cur = next;
+        return prev;
+    }
+    uint32_t irqs = spin_lock_blocking(_coreLoadLock);
+    uint8_t prev = c->cur;
+    uint64_t now = time_us_64();
+    c->us[prev] += now - c->last;
+    c->last = now;
+    c->cur = next;
+    spin_unlock(_coreLoadLock, irqs);
+    return prev;
+}
+
+void __coreLoadEnable(bool enable) {
+    if (enable) {
+        __coreLoadReset();
+    }
+    _coreLoadEnabled = enable;
+}
+
+void __coreLoadReset() {
+    uint32_t irqs = spin_lock_blocking(_coreLoadLock);
+    uint64_t now = time_us_64();
+    for (int i = 0; i < 2; i++) {
+        _coreLoad[i].last = now;
+        for (int j = 0; j < CORELOAD_BUCKETS; j++) {
+            _coreLoad[i].us[j] = 0;
+        }
+    }
+    spin_unlock(_coreLoadLock, irqs);
+}
+
+void __coreLoadGet(int core, CoreLoadStats *s) {
+    CoreLoadState *c = &_coreLoad[core & 1];
+    uint32_t irqs = spin_lock_blocking(_coreLoadLock);
+    uint64_t us[CORELOAD_BUCKETS];
+    for (int j = 0; j < CORELOAD_BUCKETS; j++) {
+        us[j] = c->us[j];
+    }
+    if (_coreLoadEnabled) {
+        // Include the time in the current bucket that hasn't been charged yet
+        us[c->cur] += time_us_64() - c->last;
+    }
+    spin_unlock(_coreLoadLock, irqs);
+    s->loop = us[CORELOAD_LOOP];
+    s->events = us[CORELOAD_EVENTS];
+    s->irq = us[CORELOAD_IRQ];
+    s->idle = us[CORELOAD_IDLE];
+    s->total = s->loop + s->events + s->irq + s->idle;
+}
@@ -0,0 +1,58 @@
+/*
+    Per-core CPU load accounting for the setup()/loop() and setup1()/loop1() model
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// CPU load accounting buckets, each core is always charging time to exactly one
+enum {
+    CORELOAD_LOOP = 0,  // setup()/loop() or setup1()/loop1()
+    CORELOAD_EVENTS,    // serialEvent and other background servicing between loop() calls
+    CORELOAD_IRQ,       // Core interrupt handlers (USB, Serial, inter-core FIFO)
+    CORELOAD_IDLE,      // Sleeping in delay()
+    CORELOAD_BUCKETS
+};
+
+typedef struct {
+    uint64_t total;     // All in microseconds
+    uint64_t loop;
+    uint64_t events;
+    uint64_t irq;
+    uint64_t idle;
+} CoreLoadStats;
+
+extern uint8_t __coreLoadSwitch(uint8_t next);
+extern void __coreLoadEnable(bool enable);
+extern void __coreLoadReset();
+extern void __coreLoadGet(int core, CoreLoadStats *s);
+
+// Charges the enclosing block to a load bucket, restoring the previous one on exit
+class CoreLoadScope {
+public:
+    CoreLoadScope(uint8_t bucket) {
+        _prev = __coreLoadSwitch(bucket);
+    }
+    ~CoreLoadScope() {
+        __coreLoadSwitch(_prev);
+    }
+private:
+    uint8_t _prev;
+};
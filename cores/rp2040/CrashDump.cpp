@@ -0,0 +1,343 @@
+/*
+    Post-mortem crash records, kept in RAM across a reboot and optionally saved to flash
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include "CrashDump.h"
+#include "FlashService.h"
+#include <hardware/exception.h>
+#include <hardware/regs/addressmap.h>
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+#include <hardware/watchdog.h>
+
+extern "C" {
+    extern uint32_t __StackOneTop;
+    extern uint32_t __StackTop;
+}
+
+#if defined(DEBUG_RP2040_PORT) && defined(DEBUG_RP2040_DEFERRED)
+extern "C" {
+    extern __DebugLogEntry __debugLogRing[DEBUG_RP2040_DEFERRED_ENTRIES];
+    extern volatile uint32_t __debugLogHead;
+}
+#endif
+
+static_assert(sizeof(CrashDump::Record) <= 4096, "CrashDump::Record must fit in one flash sector");
+
+static constexpr uint32_t CRASHDUMP_MAGIC = 0x48535243; // "CRSH"
+
+// .uninitialized_data is neither loaded nor zeroed by crt0, and a watchdog reboot leaves RAM
+// alone, so the record is still there on the next boot.  At power on it holds garbage, which
+// the check word weeds out.
+static CrashDump::Record _rec __attribute__((section(".uninitialized_data.crashdump")));
+static bool _valid = false;
+static bool _reboot = true;
+static spin_lock_t *_lock = nullptr;   // Only the first core to fault records
+static volatile uint32_t _otherSP;
+
+static uint32_t _check(const CrashDump::Record *r) {
+    const uint32_t *w = (const uint32_t *)r;
+    uint32_t h = 2166136261UL;
+    for (size_t i = 2; i < sizeof(*r) / sizeof(uint32_t); i++) {
+        h = (h ^ w[i]) * 16777619UL;
+    }
+    return h;
+}
+
+static inline uint32_t _stackTop(int core) {
+    return (uint32_t)(core ? &__StackOneTop : &__StackTop);
+}
+
+// Copies up from sp, stopping at the top of the core's own stack if sp is in it (otherwise it
+// is a FreeRTOS task stack, with its top unknown)
+static void __not_in_flash_func(_copyStack)(CrashDump::Stack *s, int core, uint32_t sp) {
+    uint32_t top = _stackTop(core);
+    if (!sp) {
+        // Couldn't stop it, so only the bottom of its call chain
+        sp = top - CRASHDUMP_STACK_BYTES;
+    } else if ((sp > top) || (sp < top - 4096)) {
+        top = SRAM_END;
+    }
+    s->sp = sp;
+    s->len = 0;
+    if ((sp & 3) || (sp < SRAM_BASE) || (sp >= top)) {
+        return;
+    }
+    s->len = std::min((uint32_t)CRASHDUMP_STACK_BYTES, top - sp);
+    const uint32_t *src = (const uint32_t *)sp;
+    for (uint32_t i = 0; i < s->len / 4; i++) {
+        s->data[i] = src[i];
+    }
+}
+
+static void __not_in_flash_func(_begin)(uint32_t reason, uint32_t code) {
+    _rec.magic = 0; // Never valid while half written
+    _valid = false;
+    _rec.reason = reason;
+    _rec.code = code;
+    _rec.core = get_core_num();
+    _rec.time = timer_hw->timerawl;
+    for (int i = 0; i < 13; i++) {
+        _rec.r[i] = 0;
+    }
+    _rec.lr = 0;
+    _rec.xpsr = 0;
+    _rec.excReturn = 0;
+}
+
+// Stacks and log, then seals the record.  Stopping the other core only makes sense when this
+// one isn't going to carry on.
+static void __not_in_flash_func(_finish)(bool stopOther) {
+    int me = _rec.core;
+    _copyStack(&_rec.stack[me], me, _rec.sp);
+
+    uint32_t other = 0;
+    if (stopOther) {
+        rp2040.fifo.crashStopOtherCore();
+        uint32_t start = timer_hw->timerawl;
+        while (!_otherSP && (timer_hw->timerawl - start < 2000)) {
+            /* Give its FIFO IRQ a chance */
+        }
+        other = _otherSP;
+    }
+    _copyStack(&_rec.stack[me ^ 1], me ^ 1, other);
+
+    _rec.logCount = 0;
+#if defined(DEBUG_RP2040_PORT) && defined(DEBUG_RP2040_DEFERRED)
+    // Printed or not, the newest entries are all still in the ring
+    uint32_t head = __debugLogHead;
+    uint32_t n = std::min(std::min((uint32_t)CRASHDUMP_LOG_ENTRIES, (uint32_t)DEBUG_RP2040_DEFERRED_ENTRIES), head);
+    for (uint32_t i = 0; i < n; i++) {
+        _rec.log[i] = __debugLogRing[(head - n + i) % DEBUG_RP2040_DEFERRED_ENTRIES];
+    }
+    _rec.logCount = n;
+#endif
+
+    _rec.check = _check(&_rec);
+    __dmb();
+    _rec.magic = CRASHDUMP_MAGIC;
+    _valid = true;
+}
+
+static void __not_in_flash_func(_halt)() {
+    if (_reboot) {
+        watchdog_reboot(0, 0, 10);
+    }
+    while (true) {
+        /* Wait for the watchdog, a debugger, or the reset button */
+    }
+}
+
+// Runs on the other core from its FIFO IRQ.  Its stack from here up holds the IRQ's exception
+// frame and whatever that interrupted.
+extern "C" void __not_in_flash_func(__crashDumpStop)() {
+    noInterrupts();
+    uint32_t sp;
+    asm volatile("mov %0, sp" : "=r"(sp));
+    _otherSP = sp;
+    while (true) {
+        /* Parked until the reboot */
+    }
+}
+
+// Entered from __crashDumpHardFault with the exception frame, EXC_RETURN, and the r8-r11 then
+// r4-r7 it pushed.  Only the asm calls it, so it's marked used for LTO.
+extern "C" __attribute__((used)) void __not_in_flash_func(__crashDumpFault)(uint32_t *frame, uint32_t excReturn, uint32_t *saved) {
+    // Whatever the stacked xPSR's bit 9 says was added to align the frame also comes off
+    uint32_t sp = (uint32_t)(frame + 8) + ((frame[7] & (1 << 9)) ? 4 : 0);
+    if (_lock && !*_lock) {
+        // The other core faulted first and is recording, so only give it our stack
+        _otherSP = sp;
+        while (true) {
+            /* Parked until the reboot */
+        }
+    }
+    _begin(CrashDump::HardFault, 0);
+    for (int i = 0; i < 4; i++) {
+        _rec.r[i] = frame[i];
+        _rec.r[4 + i] = saved[4 + i];
+        _rec.r[8 + i] = saved[i];
+    }
+    _rec.r[12] = frame[4];
+    _rec.lr = frame[5];
+    _rec.pc = frame[6];
+    _rec.xpsr = frame[7];
+    _rec.sp = sp;
+    _rec.excReturn = excReturn;
+    _finish(true);
+    _halt();
+}
+
+// EXC_RETURN bit 2 says whether the frame went on the process stack (a FreeRTOS task) or the
+// main stack.  Only r0-r3, r12, lr, pc and xPSR are stacked by the hardware, so the rest are
+// pushed here, the high ones through low registers as the M0+ can't push them directly.
+extern "C" void __attribute__((naked, section(".time_critical.__crashDumpHardFault"))) __crashDumpHardFault() {
+    asm volatile(
+        ".syntax unified\n"
+        "mov r1, lr\n"
+        "movs r2, #4\n"
+        "tst r1, r2\n"
+        "bne 1f\n"
+        "mrs r0, msp\n"
+        "b 2f\n"
+        "1:\n"
+        "mrs r0, psp\n"
+        "2:\n"
+        "push {r4-r7}\n"
+        "mov r4, r8\n"
+        "mov r5, r9\n"
+        "mov r6, r10\n"
+        "mov r7, r11\n"
+        "push {r4-r7}\n"
+        "mov r2, sp\n"
+        "bl __crashDumpFault\n"
+    );
+}
+
+// From main(), before anything can fault.  Both cores share the vector table.
+extern "C" void __crashDumpInit() {
+    _valid = (_rec.magic == CRASHDUMP_MAGIC) && (_rec.check == _check(&_rec));
+    _lock = spin_lock_instance(spin_lock_claim_unused(true));
+    exception_set_exclusive_handler(HARDFAULT_EXCEPTION, __crashDumpHardFault);
+}
+
+// rtosFatalError() and other fatal paths outside an exception.  Returns only if rebooting is off.
+extern "C" void __crashDumpFatal(uint32_t reason, uint32_t code, void *caller) {
+    uint32_t sp;
+    asm volatile("mov %0, sp" : "=r"(sp));
+    _begin(reason, code);
+    _rec.sp = sp;
+    _rec.pc = (uint32_t)caller;
+    _finish(false);
+    if (_reboot) {
+        _halt();
+    }
+}
+
+bool CrashDump::available() {
+    return _valid;
+}
+
+const CrashDump::Record *CrashDump::get() {
+    return _valid ? &_rec : nullptr;
+}
+
+void CrashDump::clear() {
+    _rec.magic = 0;
+    _valid = false;
+}
+
+void __attribute__((noinline)) CrashDump::save(uint32_t code) {
+    uint32_t sp;
+    asm volatile("mov %0, sp" : "=r"(sp));
+    _begin(User, code);
+    _rec.sp = sp;
+    _rec.pc = (uint32_t)__builtin_return_address(0);
+    _finish(false);
+}
+
+void CrashDump::rebootOnFault(bool reboot) {
+    _reboot = reboot;
+}
+
+bool CrashDump::saveToFlash(uint32_t offset) {
+    constexpr size_t len = (sizeof(Record) + 255) & ~255;
+    if (!_valid || (offset & 4095)) {
+        return false;
+    }
+    uint8_t *buf = (uint8_t *)malloc(len);
+    if (!buf) {
+        return false;
+    }
+    memset(buf, 0xff, len);
+    memcpy(buf, &_rec, sizeof(_rec));
+    bool ok = __flashErase(offset, 4096) && __flashProgram(offset, buf, len);
+    free(buf);
+    return ok;
+}
+
+bool CrashDump::loadFromFlash(uint32_t offset) {
+    const Record *r = (const Record *)(XIP_BASE + offset);
+    if ((r->magic != CRASHDUMP_MAGIC) || (r->check != _check(r))) {
+        return false;
+    }
+    memcpy(&_rec, r, sizeof(_rec));
+    _valid = true;
+    return true;
+}
+
+static void _printWords(Print &p, const char *const *names, const uint32_t *v, int n) {
+    for (int i = 0; i < n; i++) {
+        p.printf("%5s %08lx%s", names[i], v[i], ((i % 4) == 3) || (i == n - 1) ? "\n" : "  ");
+    }
+}
+
+void CrashDump::print(Print &p) {
+    if (!_valid) {
+        p.printf("No crash record\n");
+        return;
+    }
+    const Record &r = _rec;
+    switch (r.reason) {
+    case HardFault:
+        p.printf("HardFault");
+        break;
+    case FreeRTOSFatal:
+        p.printf("FreeRTOS fatal error");
+        break;
+    default:
+        p.printf("CrashDump::save(%lu)", r.code);
+        break;
+    }
+    p.printf(" on core %lu at %lu us\n", r.core, r.time);
+
+    static const char *const regs[] = { "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7", "r8", "r9", "r10", "r11", "r12" };
+    static const char *const special[] = { "sp", "lr", "pc", "xpsr" };
+    _printWords(p, regs, r.r, 13);
+    uint32_t s[4] = { r.sp, r.lr, r.pc, r.xpsr };
+    _printWords(p, special, s, 4);
+
+    for (int c = 0; c < 2; c++) {
+        const Stack &st = r.stack[c];
+        if (!st.len) {
+            continue;
+        }
+        p.printf("Core %d stack%s:\n", c, (c == (int)r.core) ? "" : " (other core)");
+        for (uint32_t i = 0; i < st.len / 4; i++) {
+            if (!(i % 4)) {
+                p.printf("%08lx:", st.sp + i * 4);
+            }
+            p.printf(" %08lx", st.data[i]);
+            if (((i % 4) == 3) || (i == st.len / 4 - 1)) {
+                p.printf("\n");
+            }
+        }
+    }
+
+#if defined(DEBUG_RP2040_PORT) && defined(DEBUG_RP2040_DEFERRED)
+    if (r.logCount) {
+        p.printf("Last debug messages:\n");
+        for (uint32_t i = 0; i < r.logCount; i++) {
+            p.printf("[%lu us, core %u] ", r.log[i].time, r.log[i].core);
+            __debugLogPrint(p, r.log[i]);
+        }
+    }
+#endif
+}
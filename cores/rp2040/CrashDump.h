@@ -0,0 +1,93 @@
+/*
+    Post-mortem crash records, kept in RAM across a reboot and optionally saved to flash
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Print;
+
+#ifndef CRASHDUMP_STACK_BYTES
+#define CRASHDUMP_STACK_BYTES 256
+#endif
+
+#ifndef CRASHDUMP_LOG_ENTRIES
+#define CRASHDUMP_LOG_ENTRIES 8
+#endif
+
+// A HardFault on either core records the registers, the top of both cores' stacks and (with
+// DEBUG_RP2040_DEFERRED) the last debug messages into RAM which isn't cleared at boot, then
+// reboots through the watchdog.  On the next boot available() says whether there is a record
+// to look at.  It stays until clear(), or until the next crash replaces it.
+class CrashDump {
+public:
+    typedef enum {
+        HardFault = 1,
+        FreeRTOSFatal = 2,   // rtosFatalError(), a FreeRTOS assert or stack overflow
+        User = 3             // save() called by the sketch
+    } Reason;
+
+    typedef struct {
+        uint32_t sp;         // 0 if the core couldn't be stopped, and data[] is the top of its stack
+        uint32_t len;        // Bytes in data[], copied upwards from sp
+        uint32_t data[CRASHDUMP_STACK_BYTES / 4];
+    } Stack;
+
+    typedef struct {
+        uint32_t magic;
+        uint32_t check;
+        uint32_t reason;
+        uint32_t code;       // save()'s code
+        uint32_t core;
+        uint32_t time;       // Microseconds since boot, low 32 bits
+        uint32_t r[13];      // r0-r12
+        uint32_t sp;
+        uint32_t lr;
+        uint32_t pc;
+        uint32_t xpsr;
+        uint32_t excReturn;  // LR on fault entry, 0xfffffffd when a FreeRTOS task faulted
+        Stack stack[2];      // By core number
+        uint32_t logCount;
+#if defined(DEBUG_RP2040_PORT) && defined(DEBUG_RP2040_DEFERRED)
+        __DebugLogEntry log[CRASHDUMP_LOG_ENTRIES];   // Oldest first
+#endif
+    } Record;
+
+    // Whether there is a record, from the last crash or loadFromFlash()
+    static bool available();
+    static const Record *get();
+    static void clear();
+
+    // Registers, stacks and log in a form arm-none-eabi-addr2line can be pointed at
+    static void print(Print &p);
+
+    // Records the caller's state as if it had crashed, without rebooting
+    static void save(uint32_t code = 0);
+
+    // After a fault the core normally reboots through the watchdog.  Turned off it stops
+    // with interrupts disabled instead, for a debugger or an external reset.
+    static void rebootOnFault(bool reboot);
+
+    // Copies the record into the 4K flash sector at offset (from the start of flash), which
+    // must be left free for it, so it survives a power cycle.  loadFromFlash() brings it back.
+    static bool saveToFlash(uint32_t offset);
+    static bool loadFromFlash(uint32_t offset);
+};
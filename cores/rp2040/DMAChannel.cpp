@@ -0,0 +1,259 @@
+/*
+    DMAChannel - DMA channel allocation, transfers, and shared completion interrupts
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "DMAChannel.h"
+#include <hardware/irq.h>
+#include "CoreMutex.h"
+
+typedef struct {
+    void (*volatile cb)(int, void *);
+    void *volatile param;
+} DMACallback;
+
+static DMACallback _dmaCB[NUM_DMA_CHANNELS];
+static auto_init_mutex(_dmaIRQMutex);
+static bool _dmaIRQInstalled = false;
+
+static void __not_in_flash_func(_dmaIRQ)() {
+    uint32_t pending = dma_hw->ints0;
+    while (pending) {
+        int ch = __builtin_ctz(pending);
+        pending &= ~(1u << ch);
+        auto cb = _dmaCB[ch].cb;
+        // Channels without a callback belong to some other shared handler, leave them be
+        if (cb) {
+            dma_hw->ints0 = 1u << ch;
+            cb(ch, _dmaCB[ch].param);
+        }
+    }
+}
+
+bool DMAChannel::attachInterrupt(int channel, void (*fn)(int, void *), void *param) {
+    if ((channel < 0) || (channel >= NUM_DMA_CHANNELS) || !fn) {
+        return false;
+    }
+    CoreMutex m(&_dmaIRQMutex);
+    if (!m) {
+        return false;
+    }
+    dma_channel_set_irq0_enabled(channel, false);
+    _dmaCB[channel].param = param;
+    _dmaCB[channel].cb = fn;
+    dma_hw->ints0 = 1u << channel;
+    dma_channel_set_irq0_enabled(channel, true);
+    // One handler for every channel, taken on the core which first asks for it
+    if (!_dmaIRQInstalled) {
+        irq_add_shared_handler(DMA_IRQ_0, _dmaIRQ, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        _dmaIRQInstalled = true;
+    }
+    return true;
+}
+
+void DMAChannel::detachInterrupt(int channel) {
+    if ((channel < 0) || (channel >= NUM_DMA_CHANNELS)) {
+        return;
+    }
+    dma_channel_set_irq0_enabled(channel, false);
+    _dmaCB[channel].cb = nullptr;
+    _dmaCB[channel].param = nullptr;
+    dma_hw->ints0 = 1u << channel;
+}
+
+DMAChannel::DMAChannel() {
+    _ch = -1;
+    _chain = -1;
+    _hasIRQ = false;
+    _fill = 0;
+}
+
+DMAChannel::~DMAChannel() {
+    unclaim();
+}
+
+bool DMAChannel::claim() {
+    if (_ch >= 0) {
+        return true;
+    }
+    _ch = dma_claim_unused_channel(false);
+    if (_ch < 0) {
+        DEBUGCORE("ERROR: DMAChannel unable to claim a channel\n");
+        return false;
+    }
+    _cfg = dma_channel_get_default_config(_ch);
+    _chain = -1;
+    return true;
+}
+
+void DMAChannel::unclaim() {
+    if (_ch < 0) {
+        return;
+    }
+    abort();
+    if (_hasIRQ) {
+        detachInterrupt(_ch);
+        _hasIRQ = false;
+    }
+    dma_channel_unclaim(_ch);
+    _ch = -1;
+}
+
+void DMAChannel::setSize(enum dma_channel_transfer_size size) {
+    channel_config_set_transfer_data_size(&_cfg, size);
+}
+
+void DMAChannel::setIncrement(bool read, bool write) {
+    channel_config_set_read_increment(&_cfg, read);
+    channel_config_set_write_increment(&_cfg, write);
+}
+
+void DMAChannel::setDREQ(uint dreq) {
+    channel_config_set_dreq(&_cfg, dreq);
+}
+
+void DMAChannel::chainTo(DMAChannel &next) {
+    if ((_ch < 0) || (next._ch < 0)) {
+        return;
+    }
+    _chain = next._ch;
+    channel_config_set_chain_to(&_cfg, _chain);
+}
+
+void DMAChannel::unchain() {
+    if (_ch < 0) {
+        return;
+    }
+    // Chaining to itself means no chain
+    _chain = -1;
+    channel_config_set_chain_to(&_cfg, _ch);
+}
+
+void DMAChannel::setRing(bool write, uint bits) {
+    channel_config_set_ring(&_cfg, write, bits);
+}
+
+bool DMAChannel::prepare(volatile void *write, const volatile void *read, uint32_t count) {
+    if ((_ch < 0) || busy()) {
+        return false;
+    }
+    dma_channel_configure(_ch, &_cfg, write, read, count, false);
+    return true;
+}
+
+bool DMAChannel::start(volatile void *write, const volatile void *read, uint32_t count) {
+    if (!prepare(write, read, count)) {
+        return false;
+    }
+    dma_channel_start(_ch);
+    return true;
+}
+
+bool DMAChannel::start() {
+    if ((_ch < 0) || busy()) {
+        return false;
+    }
+    dma_channel_start(_ch);
+    return true;
+}
+
+bool DMAChannel::busy() {
+    return (_ch >= 0) && dma_channel_is_busy(_ch);
+}
+
+void DMAChannel::wait() {
+    while (busy()) {
+        /* noop busy wait */
+    }
+}
+
+void DMAChannel::abort() {
+    if (_ch < 0) {
+        return;
+    }
+    if (_chain >= 0) {
+        dma_channel_config c = dma_get_channel_config(_ch);
+        channel_config_set_chain_to(&c, _ch);
+        dma_channel_set_config(_ch, &c, false);
+    }
+    // An abort can raise a spurious completion IRQ (RP2040-E13), so keep it masked
+    if (_hasIRQ) {
+        dma_channel_set_irq0_enabled(_ch, false);
+    }
+    dma_channel_abort(_ch);
+    if (_hasIRQ) {
+        dma_hw->ints0 = 1u << _ch;
+        dma_channel_set_irq0_enabled(_ch, true);
+    }
+    if (_chain >= 0) {
+        // Restore the chain for the next transfer
+        dma_channel_set_config(_ch, &_cfg, false);
+    }
+}
+
+// Widest transfer size every address and the length are aligned to
+static enum dma_channel_transfer_size _bestSize(uint32_t bits, size_t *count) {
+    size_t bytes = *count;
+    if (!(bits & 3)) {
+        *count = bytes / 4;
+        return DMA_SIZE_32;
+    } else if (!(bits & 1)) {
+        *count = bytes / 2;
+        return DMA_SIZE_16;
+    }
+    return DMA_SIZE_8;
+}
+
+bool DMAChannel::memcpyAsync(void *dest, const void *src, size_t bytes) {
+    if ((_ch < 0) || busy() || !dest || !src) {
+        return false;
+    }
+    size_t count = bytes;
+    setSize(_bestSize((uint32_t)dest | (uint32_t)src | bytes, &count));
+    setIncrement(true, true);
+    setDREQ(DREQ_FORCE);
+    setRing(false, 0);
+    return start(dest, src, count);
+}
+
+bool DMAChannel::memsetAsync(void *dest, uint8_t val, size_t bytes) {
+    if ((_ch < 0) || busy() || !dest) {
+        return false;
+    }
+    // Every transfer size reads the low part of the same replicated word
+    _fill = val * 0x01010101U;
+    size_t count = bytes;
+    setSize(_bestSize((uint32_t)dest | bytes, &count));
+    setIncrement(false, true);
+    setDREQ(DREQ_FORCE);
+    setRing(false, 0);
+    return start(dest, &_fill, count);
+}
+
+void DMAChannel::onComplete(void (*fn)(int, void *), void *param) {
+    if (_ch < 0) {
+        return;
+    }
+    if (fn) {
+        _hasIRQ = attachInterrupt(_ch, fn, param);
+    } else if (_hasIRQ) {
+        detachInterrupt(_ch);
+        _hasIRQ = false;
+    }
+}
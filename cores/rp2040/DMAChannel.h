@@ -0,0 +1,85 @@
+/*
+    DMAChannel - DMA channel allocation, transfers, and shared completion interrupts
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/dma.h>
+
+// Owns one DMA channel.  The transfer settings (size, increments, DREQ, chaining, ring)
+// are kept between transfers, so set them once and start() as often as needed.
+class DMAChannel {
+public:
+    DMAChannel();
+    ~DMAChannel();
+
+    bool claim();
+    void unclaim();
+    bool claimed() {
+        return _ch >= 0;
+    }
+    int channel() {
+        return _ch;
+    }
+
+    // Transfer settings, taking effect on the next start()/prepare().  The defaults are
+    // 32-bit, incrementing read, fixed write, unpaced, no chain or ring
+    void setSize(enum dma_channel_transfer_size size);
+    void setIncrement(bool read, bool write);
+    void setDREQ(uint dreq);
+    void chainTo(DMAChannel &next);
+    void unchain();
+    // Wraps the read (or write) address on a 1 << bits byte boundary, 0 turns it off
+    void setRing(bool write, uint bits);
+    // Anything else the SDK's channel_config_* calls can change
+    dma_channel_config *config() {
+        return &_cfg;
+    }
+
+    // Programs a transfer of count items without starting it, e.g. for a channel which
+    // is triggered by another's chain
+    bool prepare(volatile void *write, const volatile void *read, uint32_t count);
+    bool start(volatile void *write, const volatile void *read, uint32_t count);
+    bool start();
+    bool busy();
+    void wait();
+    // Breaks any chain first so aborting doesn't just start the next channel
+    void abort();
+
+    // Background copies and fills using the widest transfer the alignment allows.  These
+    // change the transfer settings
+    bool memcpyAsync(void *dest, const void *src, size_t bytes);
+    bool memsetAsync(void *dest, uint8_t val, size_t bytes);
+
+    // Called from **INTERRUPT CONTEXT** (DMA_IRQ_0) each time the transfer completes
+    void onComplete(void (*fn)(int channel, void *param), void *param);
+
+    // The shared DMA_IRQ_0 dispatcher, for channels claimed elsewhere.  The interrupt is
+    // acknowledged before fn is called, so it may restart the channel
+    static bool attachInterrupt(int channel, void (*fn)(int channel, void *param), void *param);
+    static void detachInterrupt(int channel);
+
+private:
+    int _ch;
+    dma_channel_config _cfg;
+    int _chain;
+    bool _hasIRQ;
+    uint32_t _fill;
+};
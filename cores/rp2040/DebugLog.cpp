@@ -0,0 +1,155 @@
+/*
+    Deferred debug output, recorded to a RAM ring and printed later
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+
+#if defined(DEBUG_RP2040_PORT) && defined(DEBUG_RP2040_DEFERRED)
+
+static spin_lock_t *_lock = nullptr;
+
+// Global so a debugger can find them: entries [tail, head) modulo the size are unprinted
+extern "C" {
+    __DebugLogEntry __debugLogRing[DEBUG_RP2040_DEFERRED_ENTRIES];
+    volatile uint32_t __debugLogHead = 0;
+    volatile uint32_t __debugLogTail = 0;
+    volatile uint32_t __debugLogDropped = 0;
+}
+
+// From main(), anything logged earlier is counted as dropped
+extern "C" void __debugLogInit() {
+    _lock = spin_lock_instance(spin_lock_claim_unused(true));
+}
+
+extern "C" void __debugLogPush(__DebugLogEntry *e) {
+    e->time = timer_hw->timerawl;
+    e->core = get_core_num();
+    if (!_lock) {
+        __debugLogDropped++;
+        return;
+    }
+    uint32_t irqs = spin_lock_blocking(_lock);
+    if (__debugLogHead - __debugLogTail >= DEBUG_RP2040_DEFERRED_ENTRIES) {
+        __debugLogDropped++;
+    } else {
+        __debugLogRing[__debugLogHead % DEBUG_RP2040_DEFERRED_ENTRIES] = *e;
+        __debugLogHead++;
+    }
+    spin_unlock(_lock, irqs);
+}
+
+// Walks the format, printing the literal text as is and handing each conversion to printf()
+// along with the argument rebuilt from the recorded words.  Also used for crash records.
+void __debugLogPrint(Print &p, const __DebugLogEntry &e) {
+    uint32_t a = 0;
+    auto next = [&]() -> uint32_t {
+        return (a < e.nargs) ? e.args[a++] : 0;
+    };
+    const char *f = e.fmt;
+    while (*f) {
+        if (*f != '%') {
+            const char *lit = f;
+            while (*f && (*f != '%')) {
+                f++;
+            }
+            p.write((const uint8_t *)lit, f - lit);
+            continue;
+        }
+        char spec[24];
+        size_t n = 0;
+        int longs = 0;
+        spec[n++] = *f++;
+        while (*f && !strchr("diouxXcspfFeEgGaAn%", *f) && (n < sizeof(spec) - 12)) {
+            if (*f == '*') {
+                n += snprintf(spec + n, sizeof(spec) - n, "%d", (int)next());
+                f++;
+                continue;
+            }
+            if (*f == 'l') {
+                longs++;
+            } else if ((*f == 'j') || (*f == 'q')) {
+                longs = 2;
+            }
+            spec[n++] = *f++;
+        }
+        if (!*f) {
+            break;
+        }
+        char conv = *f++;
+        spec[n++] = conv;
+        spec[n] = 0;
+        switch (conv) {
+        case '%':
+            p.write('%');
+            break;
+        case 'n':
+            break; // Nowhere to store it
+        case 's': {
+            uint32_t off = next();
+            p.printf(spec, (off < e.strLen) ? &e.str[off] : "");
+            break;
+        }
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            uint32_t w[2] = { next(), next() };
+            double d;
+            memcpy(&d, w, sizeof(d));
+            p.printf(spec, d);
+            break;
+        }
+        default:
+            if (longs >= 2) {
+                uint64_t lo = next();
+                p.printf(spec, lo | ((uint64_t)next() << 32));
+            } else {
+                p.printf(spec, next());
+            }
+            break;
+        }
+    }
+}
+
+// Called between loop()s, or by hand from code which doesn't return to loop() for a while
+extern "C" void __debugLogDrain() {
+    if (!_lock) {
+        return;
+    }
+    while (true) {
+        __DebugLogEntry e;
+        uint32_t irqs = spin_lock_blocking(_lock);
+        bool any = __debugLogTail != __debugLogHead;
+        if (any) {
+            e = __debugLogRing[__debugLogTail % DEBUG_RP2040_DEFERRED_ENTRIES];
+            __debugLogTail++;
+        }
+        uint32_t dropped = __debugLogDropped;
+        __debugLogDropped = 0;
+        spin_unlock(_lock, irqs);
+        if (dropped) {
+            DEBUG_RP2040_PORT.printf("[%lu debug messages dropped]\n", dropped);
+        }
+        if (!any) {
+            return;
+        }
+        __debugLogPrint(DEBUG_RP2040_PORT, e);
+    }
+}
+
+#endif
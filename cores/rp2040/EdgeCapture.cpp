@@ -0,0 +1,214 @@
+/*
+    Non-blocking pulse width and frequency measurement using PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "EdgeCapture.h"
+#include "CoreMutex.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include "pio_counter.pio.h"
+
+static PIOProgram _edgePgm(&edgecapture_program);
+
+EdgeCapture::EdgeCapture(pin_size_t pin, size_t edges) {
+    _pin = pin;
+    _depth = (edges >= 4) && !(edges & (edges - 1)) ? edges : 64;
+    _running = false;
+    _startHigh = false;
+    _pio = nullptr;
+    _sm = -1;
+    _dma = -1;
+    _ring = nullptr;
+    _lastCount = 0;
+    _lastChange = 0;
+}
+
+EdgeCapture::~EdgeCapture() {
+    end();
+}
+
+bool EdgeCapture::begin() {
+    if (_running) {
+        return true;
+    }
+    if (_pin > 29) {
+        DEBUGCORE("ERROR: Illegal EdgeCapture pin (%d)\n", _pin);
+        return false;
+    }
+    int off;
+    if (!_edgePgm.prepare(&_pio, &_sm, &off)) {
+        DEBUGCORE("ERROR: EdgeCapture unable to find PIO resources\n");
+        return false;
+    }
+    _dma = dma_claim_unused_channel(false);
+    if (_dma < 0) {
+        DEBUGCORE("ERROR: EdgeCapture unable to claim DMA channel\n");
+        PIOProgram::unprepare(_pio, _sm);
+        return false;
+    }
+    // Timestamps go into a HW-wrapped ring, and the DMA count tells how many have arrived
+    _ring = (uint32_t *)aligned_alloc(_depth * 4, _depth * 4);
+    dma_channel_config c = dma_channel_get_default_config(_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, __builtin_ctz(_depth * 4));
+    channel_config_set_dreq(&c, pio_get_dreq(_pio, _sm, false));
+    dma_channel_configure(_dma, &c, _ring, &_pio->rxf[_sm], 0xffffffff, true);
+
+    _startHigh = gpio_get(_pin);
+    edgecapture_program_init(_pio, _sm, off, _pin, _startHigh);
+    pio_sm_set_enabled(_pio, _sm, true);
+    _lastCount = 0;
+    _lastChange = millis();
+    _running = true;
+    return true;
+}
+
+void EdgeCapture::end() {
+    if (!_running) {
+        return;
+    }
+    pio_sm_set_enabled(_pio, _sm, false);
+    PIOProgram::unprepare(_pio, _sm);
+    dma_channel_abort(_dma);
+    dma_channel_unclaim(_dma);
+    _dma = -1;
+    free(_ring);
+    _ring = nullptr;
+    _running = false;
+}
+
+uint32_t EdgeCapture::_written() {
+    return 0xffffffff - dma_channel_hw_addr(_dma)->transfer_count;
+}
+
+uint32_t EdgeCapture::edges() {
+    return _running ? _written() : 0;
+}
+
+bool EdgeCapture::lastPulse(PinStatus state, uint32_t *cycles) {
+    if (!_running || !cycles) {
+        return false;
+    }
+    // A HIGH pulse ends on a falling edge, a LOW one on a rising edge
+    bool endRising = state != HIGH;
+    while (true) {
+        uint32_t w = _written();
+        if (w < 2) {
+            return false;
+        }
+        uint32_t e = w - 1;
+        if (_isRising(e) != endRising) {
+            e--;
+        }
+        if (e < 1) {
+            return false;
+        }
+        uint32_t t0 = _ring[(e - 1) & (_depth - 1)];
+        uint32_t t1 = _ring[e & (_depth - 1)];
+        // If the DMA lapped us while reading, try again with the newer edges
+        if (_written() - (e - 1) <= _depth) {
+            *cycles = 2 * (t0 - t1) + 3;
+            return true;
+        }
+    }
+}
+
+float EdgeCapture::frequency(uint32_t timeoutMs) {
+    if (!_running) {
+        return 0.0f;
+    }
+    uint32_t w = _written();
+    if (w != _lastCount) {
+        _lastCount = w;
+        _lastChange = millis();
+    } else if (millis() - _lastChange > timeoutMs) {
+        return 0.0f;
+    }
+    while (true) {
+        if (w < 3) {
+            return 0.0f;
+        }
+        uint32_t newest = w - 1;
+        if (!_isRising(newest)) {
+            newest--;
+        }
+        // Stay a couple of entries clear of the one the DMA will overwrite next
+        uint32_t oldest = (w > _depth - 2) ? w - (_depth - 2) : 0;
+        if (!_isRising(oldest)) {
+            oldest++;
+        }
+        if (oldest >= newest) {
+            return 0.0f;
+        }
+        uint32_t t0 = _ring[oldest & (_depth - 1)];
+        uint32_t t1 = _ring[newest & (_depth - 1)];
+        uint32_t w2 = _written();
+        if (w2 - oldest <= _depth) {
+            uint32_t edges = newest - oldest;
+            float cycles = 2.0f * (t0 - t1) + 3.0f * edges;
+            return (edges / 2) * (float)clock_get_hz(clk_sys) / cycles;
+        }
+        w = w2;
+    }
+}
+
+auto_init_mutex(_asyncMutex);
+static EdgeCapture *_asyncCapture[30];
+
+static EdgeCapture *_getCapture(pin_size_t pin) {
+    CoreMutex m(&_asyncMutex);
+    if (!m || (pin > 29)) {
+        return nullptr;
+    }
+    if (!_asyncCapture[pin]) {
+        _asyncCapture[pin] = new EdgeCapture(pin);
+        if (!_asyncCapture[pin]->begin()) {
+            delete _asyncCapture[pin];
+            _asyncCapture[pin] = nullptr;
+        }
+    }
+    return _asyncCapture[pin];
+}
+
+bool pulseInAsync(pin_size_t pin, PinStatus state, unsigned long *us) {
+    auto ec = _getCapture(pin);
+    uint32_t cycles;
+    if (!ec || !us || !ec->lastPulse(state, &cycles)) {
+        return false;
+    }
+    *us = cycles / (clock_get_hz(clk_sys) / 1000000);
+    return true;
+}
+
+float measureFrequency(pin_size_t pin, uint32_t timeoutMs) {
+    auto ec = _getCapture(pin);
+    return ec ? ec->frequency(timeoutMs) : 0.0f;
+}
+
+void pulseInAsyncEnd(pin_size_t pin) {
+    CoreMutex m(&_asyncMutex);
+    if (!m || (pin > 29)) {
+        return;
+    }
+    delete _asyncCapture[pin];
+    _asyncCapture[pin] = nullptr;
+}
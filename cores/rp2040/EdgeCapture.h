@@ -0,0 +1,66 @@
+/*
+    Non-blocking pulse width and frequency measurement using PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+
+// A PIO state machine timestamps every edge on a pin at 2 system clock resolution and
+// DMA drops them into a ring of the last "edges" entries, so measurements are just
+// arithmetic on the ring and never wait on the pin
+class EdgeCapture {
+public:
+    EdgeCapture(pin_size_t pin, size_t edges = 64); // edges must be a power of 2
+    ~EdgeCapture();
+
+    bool begin();
+    void end();
+
+    // Width in system clock cycles of the most recent complete HIGH or LOW pulse
+    bool lastPulse(PinStatus state, uint32_t *cycles);
+    // Average over the buffered rising edges, 0 if fewer than 2 or none in timeoutMs
+    float frequency(uint32_t timeoutMs = 1000);
+    // Edges seen since begin()
+    uint32_t edges();
+
+private:
+    uint32_t _written();
+    bool _isRising(uint32_t idx) {
+        return ((idx & 1) == 0) != _startHigh;
+    }
+
+    pin_size_t _pin;
+    size_t _depth;
+    bool _running;
+    bool _startHigh;
+    PIO _pio;
+    int _sm;
+    int _dma;
+    uint32_t *_ring;
+    uint32_t _lastCount;
+    uint32_t _lastChange;
+};
+
+// Lazily start an EdgeCapture on the pin and return the latest result without blocking.
+// pulseInAsync returns false until a full pulse of the requested state has been seen.
+bool pulseInAsync(pin_size_t pin, PinStatus state, unsigned long *us);
+float measureFrequency(pin_size_t pin, uint32_t timeoutMs = 1000);
+void pulseInAsyncEnd(pin_size_t pin);
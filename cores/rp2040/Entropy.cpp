@@ -0,0 +1,176 @@
+/*
+    Entropy pool and fast random numbers, fed in the background by ROSC bits and timer jitter
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <hardware/structs/rosc.h>
+#include <hardware/structs/systick.h>
+#include <hardware/timer.h>
+#include <hardware/sync.h>
+#include <pico/time.h>
+
+#ifndef ENTROPY_SAMPLE_MS
+#define ENTROPY_SAMPLE_MS 5
+#endif
+
+// Random numbers come from xoshiro128++, which is quick and never blocks.  Every tick of the
+// sampler folds a raw sample into the pool and from there into one word of the generator's
+// state, so the state keeps drifting away from anything earlier outputs gave away.  Nothing
+// here is a vetted cryptographic RNG, but the pool makes a good seed for one (BearSSL's
+// HMAC-DRBG hashes whatever it is given).
+static spin_lock_t *_lock = nullptr;
+static uint32_t _s[4];
+static uint32_t _pool[8];
+static uint32_t _poolIdx = 0;
+static uint32_t _samples = 0;   // Mixed in since the pool was last drawn from
+static volatile bool _started = false;
+static bool _sampling = false;
+static repeating_timer_t _timer;
+
+static inline uint32_t _rotl(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+// The ROSC random bit, read until two reads differ.  Slow, so only used to give the state
+// something to start from at boot.
+static uint32_t _roscWord() {
+    uint32_t r = 0;
+    for (int k = 0; k < 32; k++) {
+        uint32_t b;
+        do {
+            b = rosc_hw->randombit & 1;
+        } while (b == (rosc_hw->randombit & 1));
+        r = (r << 1) | b;
+    }
+    return r;
+}
+
+// A few raw ROSC bits, plus exactly when this ran by the microsecond timer and the SysTick
+// cycle counter, which jitter with interrupt latency and bus contention
+static uint32_t _sample() {
+    uint32_t r = 0;
+    for (int k = 0; k < 8; k++) {
+        r = (r << 1) | (rosc_hw->randombit & 1);
+    }
+    return r ^ _rotl(timer_hw->timerawl, 8) ^ _rotl(systick_hw->cvr, 16);
+}
+
+// Called with _lock held
+static void _mix(uint32_t v) {
+    uint32_t i = _poolIdx++ & 7;
+    _pool[i] = _rotl(_pool[i] ^ v, 11) * 0x9e3779b1;
+    _s[i & 3] ^= _pool[i];
+    if (!(_s[0] | _s[1] | _s[2] | _s[3])) {
+        _s[0] = 1; // The one state xoshiro can't leave
+    }
+}
+
+// Called with _lock held
+static uint32_t _next() {
+    uint32_t result = _rotl(_s[0] + _s[3], 7) + _s[0];
+    uint32_t t = _s[1] << 9;
+    _s[2] ^= _s[0];
+    _s[3] ^= _s[1];
+    _s[1] ^= _s[2];
+    _s[0] ^= _s[3];
+    _s[2] ^= t;
+    _s[3] = _rotl(_s[3], 11);
+    return result;
+}
+
+static bool _tick(repeating_timer_t *t) {
+    (void) t;
+    uint32_t v = _sample();
+    uint32_t irqs = spin_lock_blocking(_lock);
+    _mix(v);
+    _samples++;
+    spin_unlock(_lock, irqs);
+    return true;
+}
+
+// The sampler only starts once something wants random numbers, and needs the alarm pool, so
+// not from an IRQ or under FreeRTOS.  Until then each call stirs in a sample itself.
+static bool _startSampler() {
+    if (_started) {
+        return _sampling;
+    }
+    if (__isFreeRTOS || __get_current_exception()) {
+        return false;
+    }
+    uint32_t irqs = spin_lock_blocking(_lock);
+    bool mine = !_started;
+    _started = true;
+    spin_unlock(_lock, irqs);
+    if (mine) {
+        _sampling = add_repeating_timer_ms(ENTROPY_SAMPLE_MS, _tick, nullptr, &_timer);
+    }
+    return _sampling;
+}
+
+// From main(), before anything could want a random number
+extern "C" void __entropyInit() {
+    _lock = spin_lock_instance(spin_lock_claim_unused(true));
+    for (int i = 0; i < 8; i++) {
+        _pool[i] = _roscWord() ^ _sample();
+    }
+    for (int i = 0; i < 4; i++) {
+        _s[i] = _pool[i] ^ _rotl(_pool[i + 4], 16);
+    }
+    if (!(_s[0] | _s[1] | _s[2] | _s[3])) {
+        _s[0] = 1;
+    }
+}
+
+extern "C" uint32_t __entropyRand32() {
+    bool sampling = _startSampler();
+    uint32_t v = sampling ? 0 : _sample();
+    uint32_t irqs = spin_lock_blocking(_lock);
+    if (!sampling) {
+        _mix(v);
+    }
+    uint32_t r = _next();
+    spin_unlock(_lock, irqs);
+    return r;
+}
+
+// Each word is the generator's output XORed with a pool word, which is then stirred on so
+// the same pool contents are never handed out twice.  Returns how many background samples
+// went in since the last draw.
+extern "C" uint32_t __entropyFill(void *buf, size_t len) {
+    _startSampler();
+    uint8_t *p = (uint8_t *)buf;
+    uint32_t irqs = spin_lock_blocking(_lock);
+    uint32_t samples = _samples;
+    _samples = 0;
+    while (len) {
+        uint32_t v = _next() ^ _pool[_poolIdx & 7];
+        _mix(_sample());
+        size_t n = std::min(len, sizeof(v));
+        memcpy(p, &v, n);
+        p += n;
+        len -= n;
+    }
+    spin_unlock(_lock, irqs);
+    return samples;
+}
+
+// BearSSL's system seeder (in libbearssl) asks for its seed 32 bits at a time
+extern "C" uint32_t __picoRand() {
+    return __entropyRand32();
+}
@@ -25,6 +25,191 @@ using namespace fs;
 
 static bool sflags(const char* mode, OpenMode& om, AccessMode& am);
 
+namespace fs {
+
+// Sits in front of any FileImpl, turning small reads into read-ahead of a whole buffer and
+// collecting small writes until the buffer fills.  Only one of the two holds data at a time,
+// and the underlying file's position is only brought back in line with ours when needed.
+class BufferedFileImpl : public FileImpl {
+public:
+    BufferedFileImpl(FileImplPtr p, uint8_t *rbuf, size_t rsize, uint8_t *wbuf, size_t wsize) :
+        _p(p), _rbuf(rbuf), _rsize(rsize), _wbuf(wbuf), _wsize(wsize) { }
+
+    ~BufferedFileImpl() override {
+        _flushWrite();
+        free(_rbuf);
+        free(_wbuf);
+    }
+
+    size_t write(const uint8_t *buf, size_t size) override {
+        _dropRead();
+        if (!_wsize || (!_wlen && (size >= _wsize))) {
+            return _p->write(buf, size);
+        }
+        size_t done = 0;
+        while (done < size) {
+            if (!_wlen) {
+                _wpos = _p->position();
+            }
+            size_t n = std::min(size - done, _wsize - _wlen);
+            memcpy(_wbuf + _wlen, buf + done, n);
+            _wlen += n;
+            done += n;
+            if ((_wlen == _wsize) && !_flushWrite()) {
+                // Whatever of this call didn't make it out is lost
+                return done - std::min(done, _lost);
+            }
+        }
+        return done;
+    }
+
+    int read(uint8_t *buf, size_t size) override {
+        if (!_flushWrite()) {
+            return -1;
+        }
+        size_t done = std::min(size, _rlen - _roff);
+        memcpy(buf, _rbuf + _roff, done);
+        _roff += done;
+        if ((done == size) || !_rsize) {
+            int r = (done == size) ? 0 : _p->read(buf + done, size - done);
+            return done + std::max(r, 0);
+        }
+        // The buffer is used up, so the underlying file is where we are
+        if (size - done >= _rsize) {
+            _rlen = _roff = 0;
+            int r = _p->read(buf + done, size - done);
+            return done + std::max(r, 0);
+        }
+        _rpos = _p->position();
+        int r = _p->read(_rbuf, _rsize);
+        _rlen = std::max(r, 0);
+        _roff = std::min(size - done, _rlen);
+        memcpy(buf + done, _rbuf, _roff);
+        return done + _roff;
+    }
+
+    void flush() override {
+        _flushWrite();
+        _p->flush();
+    }
+
+    bool seek(uint32_t pos, SeekMode mode) override {
+        if (!_flushWrite()) {
+            return false;
+        }
+        if (mode == SeekCur) {
+            pos += position();
+            mode = SeekSet;
+        }
+        // peek() and short backtracks stay inside what's already been read
+        if ((mode == SeekSet) && _rlen && (pos >= _rpos) && (pos <= _rpos + _rlen)) {
+            _roff = pos - _rpos;
+            return true;
+        }
+        _rlen = _roff = 0;
+        return _p->seek(pos, mode);
+    }
+
+    size_t position() const override {
+        if (_wlen) {
+            return _wpos + _wlen;
+        } else if (_rlen) {
+            return _rpos + _roff;
+        }
+        return _p->position();
+    }
+
+    size_t size() const override {
+        return _wlen ? std::max(_p->size(), _wpos + _wlen) : _p->size();
+    }
+
+    int availableForWrite() override {
+        return _p->availableForWrite();
+    }
+
+    bool truncate(uint32_t size) override {
+        _flushWrite();
+        _dropRead();
+        return _p->truncate(size);
+    }
+
+    bool preallocate(uint32_t size) override {
+        return _p->preallocate(size);
+    }
+
+    const void *mmap() override {
+        return _flushWrite() ? _p->mmap() : nullptr;
+    }
+
+    void close() override {
+        _flushWrite();
+        _rlen = _roff = 0;
+        _p->close();
+    }
+
+    const char* name() const override {
+        return _p->name();
+    }
+
+    const char* fullName() const override {
+        return _p->fullName();
+    }
+
+    bool isFile() const override {
+        return _p->isFile();
+    }
+
+    bool isDirectory() const override {
+        return _p->isDirectory();
+    }
+
+    void setTimeCallback(time_t (*cb)(void)) override {
+        _p->setTimeCallback(cb);
+    }
+
+    time_t getLastWrite() override {
+        _flushWrite();
+        return _p->getLastWrite();
+    }
+
+    time_t getCreationTime() override {
+        return _p->getCreationTime();
+    }
+
+protected:
+    bool _flushWrite() {
+        if (!_wlen) {
+            return true;
+        }
+        size_t w = _p->write(_wbuf, _wlen);
+        _lost = _wlen - std::min(w, _wlen);
+        _wlen = 0;
+        return !_lost;
+    }
+
+    // About to write, so put the underlying file back where we logically are
+    void _dropRead() {
+        if (_rlen) {
+            _p->seek(_rpos + _roff, SeekSet);
+            _rlen = _roff = 0;
+        }
+    }
+
+    FileImplPtr _p;
+    uint8_t *_rbuf;
+    size_t _rsize;
+    size_t _rpos = 0;   // File offset of _rbuf[0]
+    size_t _rlen = 0;
+    size_t _roff = 0;
+    uint8_t *_wbuf;
+    size_t _wsize;
+    size_t _wpos = 0;   // File offset of _wbuf[0]
+    size_t _wlen = 0;
+    size_t _lost = 0;
+};
+
+}; // namespace fs
+
 size_t File::write(uint8_t c) {
     if (!_p) {
         return 0;
@@ -141,6 +326,38 @@ bool File::truncate(uint32_t size) {
     return _p->truncate(size);
 }
 
+bool File::preallocate(uint32_t size) {
+    if (!_p) {
+        return false;
+    }
+
+    return _p->preallocate(size);
+}
+
+bool File::setBufferSize(size_t readSize, size_t writeSize) {
+    if (!_p || _buffered || !(readSize || writeSize)) {
+        return false;
+    }
+    uint8_t *rbuf = readSize ? (uint8_t *)malloc(readSize) : nullptr;
+    uint8_t *wbuf = writeSize ? (uint8_t *)malloc(writeSize) : nullptr;
+    if ((readSize && !rbuf) || (writeSize && !wbuf)) {
+        free(rbuf);
+        free(wbuf);
+        return false;
+    }
+    _p = std::make_shared<BufferedFileImpl>(_p, rbuf, readSize, wbuf, writeSize);
+    _buffered = true;
+    return true;
+}
+
+const void *File::mmap() {
+    if (!_p) {
+        return nullptr;
+    }
+
+    return _p->mmap();
+}
+
 const char* File::name() const {
     if (!_p) {
         return nullptr;
@@ -294,6 +511,7 @@ bool Dir::next() {
         return false;
     }
 
+    _pending = false;
     return _impl->next();
 }
 
@@ -302,9 +520,36 @@ bool Dir::rewind() {
         return false;
     }
 
+    _pending = false;
     return _impl->rewind();
 }
 
+size_t Dir::readEntries(DirEntry *entries, size_t count, char *names, size_t namesLen) {
+    if (!_impl || !entries || !names) {
+        return 0;
+    }
+
+    size_t n = 0;
+    while ((n < count) && (_pending || _impl->next())) {
+        const char *name = _impl->fileName();
+        size_t len = strlen(name) + 1;
+        if (len > namesLen) {
+            _pending = true;
+            break;
+        }
+        _pending = false;
+        memcpy(names, name, len);
+        entries[n].name = names;
+        entries[n].isDirectory = _impl->isDirectory();
+        entries[n].size = entries[n].isDirectory ? 0 : _impl->fileSize();
+        entries[n].time = _impl->fileTime();
+        names += len;
+        namesLen -= len;
+        n++;
+    }
+    return n;
+}
+
 void Dir::setTimeCallback(time_t (*cb)(void)) {
     if (!_impl) {
         return;
@@ -339,11 +584,11 @@ void FS::end() {
     }
 }
 
-bool FS::gc() {
+bool FS::gc(uint32_t budgetUs) {
     if (!_impl) {
         return false;
     }
-    return _impl->gc();
+    return _impl->gc(budgetUs);
 }
 
 bool FS::check() {
@@ -496,16 +741,16 @@ static bool sflags(const char* mode, OpenMode& om, AccessMode& am) {
     default:
         return false;
     }
-    switch (mode[1]) {
-    case '+':
+    mode++;
+    if (*mode == '+') {
         am = (AccessMode)(AM_WRITE | AM_READ);
-        break;
-    case 0:
-        break;
-    default:
-        return false;
+        mode++;
     }
-    return true;
+    if (*mode == 'z') {
+        om = (OpenMode)(om | OM_COMPRESS);
+        mode++;
+    }
+    return !*mode;
 }
 
 
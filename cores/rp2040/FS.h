@@ -64,7 +64,7 @@ public:
     int read() override;
     int peek() override;
     void flush() override;
-    size_t readBytes(char *buffer, size_t length) {
+    size_t readBytes(char *buffer, size_t length) override {
         return read((uint8_t*)buffer, length);
     }
     int read(uint8_t* buf, size_t size);
@@ -77,36 +77,30 @@ public:
     virtual ssize_t streamRemaining() {
         return (ssize_t)size() - (ssize_t)position();
     }
+    // Nothing more will show up by waiting at the end of a file
+    virtual bool inputCanTimeout() override {
+        return false;
+    }
     void close();
     operator bool() const;
     const char* name() const;
     const char* fullName() const; // Includes path
     bool truncate(uint32_t size);
+    // Reserve contiguous space for size bytes of writes, where the filesystem supports it
+    bool preallocate(uint32_t size);
+    // Read ahead and collect writes in RAM buffers of these sizes (0 for none).  Only
+    // once per File, and copies of it made before this call aren't buffered.
+    bool setBufferSize(size_t readSize, size_t writeSize = 0);
+    // The file's contents in place in XIP flash, when stored contiguously, else nullptr.
+    // Good until the file is written to or removed.
+    const void *mmap();
 
     bool isFile() const;
     bool isDirectory() const;
 
     // Arduino "class SD" methods for compatibility
-    //TODO use stream::send / check read(buf,size) result
     template<typename T> size_t write(T &src) {
-        uint8_t obuf[256];
-        size_t doneLen = 0;
-        size_t sentLen;
-
-        while ((size_t)src.available() > sizeof(obuf)) {
-            src.read(obuf, sizeof(obuf));
-            sentLen = write(obuf, sizeof(obuf));
-            doneLen = doneLen + sentLen;
-            if (sentLen != sizeof(obuf)) {
-                return doneLen;
-            }
-        }
-
-        size_t leftLen = src.available();
-        src.read(obuf, leftLen);
-        sentLen = write(obuf, leftLen);
-        doneLen = doneLen + sentLen;
-        return doneLen;
+        return src.sendAll(*this, src.available(), 0);
     }
     using Print::write;
 
@@ -121,6 +115,7 @@ public:
 
 protected:
     FileImplPtr _p;
+    bool _buffered = false;
     time_t (*_timeCallback)(void) = nullptr;
 
     // Arduino SD class emulation
@@ -128,9 +123,17 @@ protected:
     FS                  *_baseFS;
 };
 
+// One entry returned by Dir::readEntries()
+struct DirEntry {
+    const char *name;   // Stored in the caller's name buffer
+    size_t      size;
+    time_t      time;   // Last write, 0 if not known
+    bool        isDirectory;
+};
+
 class Dir {
 public:
-    Dir(DirImplPtr impl = DirImplPtr(), FS *baseFS = nullptr): _impl(impl), _baseFS(baseFS) { }
+    Dir(DirImplPtr impl = DirImplPtr(), FS *baseFS = nullptr): _impl(impl), _baseFS(baseFS), _pending(false) { }
 
     File openFile(const char* mode);
 
@@ -144,12 +147,18 @@ public:
     bool next();
     bool rewind();
 
+    // Reads up to count of the following entries in one pass, with their names packed into
+    // names.  Returns how many were read, 0 at the end of the directory.  An entry whose name
+    // doesn't fit in what's left of names is the first one returned by the next call.
+    size_t readEntries(DirEntry *entries, size_t count, char *names, size_t namesLen);
+
     void setTimeCallback(time_t (*cb)(void));
 
 protected:
     DirImplPtr _impl;
     FS       *_baseFS;
     time_t (*_timeCallback)(void) = nullptr;
+    bool      _pending; // The current entry hasn't been returned by readEntries() yet
 };
 
 // Backwards compatible, <4GB filesystem usage
@@ -225,7 +234,8 @@ public:
     bool rmdir(const String& path);
 
     // Low-level FS routines, not needed by most applications
-    bool gc();
+    // Idle time maintenance, spending about budgetUs microseconds (0 for as long as it takes)
+    bool gc(uint32_t budgetUs = 0);
     bool check();
 
     time_t getCreationTime();
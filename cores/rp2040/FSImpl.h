@@ -39,6 +39,13 @@ public:
         return 0;
     }
     virtual bool truncate(uint32_t size) = 0;
+    virtual bool preallocate(uint32_t size) {
+        (void) size;
+        return false;
+    }
+    virtual const void *mmap() {
+        return nullptr;
+    }
     virtual void close() = 0;
     virtual const char* name() const = 0;
     virtual const char* fullName() const = 0;
@@ -71,7 +78,8 @@ enum OpenMode {
     OM_DEFAULT = 0,
     OM_CREATE = 1,
     OM_APPEND = 2,
-    OM_TRUNCATE = 4
+    OM_TRUNCATE = 4,
+    OM_COMPRESS = 8   // Store compressed, where the filesystem supports it
 };
 
 enum AccessMode {
@@ -127,7 +135,8 @@ public:
     virtual bool remove(const char* path) = 0;
     virtual bool mkdir(const char* path) = 0;
     virtual bool rmdir(const char* path) = 0;
-    virtual bool gc() {
+    virtual bool gc(uint32_t budgetUs) {
+        (void) budgetUs;
         return true;    // May not be implemented in all file systems.
     }
     virtual bool check() {
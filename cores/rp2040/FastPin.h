@@ -0,0 +1,60 @@
+/*
+    FastPin - Compile-time GPIO access through the SIO set/clear/xor registers
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <hardware/structs/sio.h>
+
+// Each call is a single store to (or load from) the SIO, with no pin checks or
+// pinMode emulation.  Set the pin up with pinMode() first.
+//     FastPin<15> strobe;
+//     strobe.high(); strobe.low();
+template <unsigned N>
+class FastPin {
+    static_assert(N < 30, "FastPin only supports GPIO 0..29");
+public:
+    static constexpr uint32_t mask = 1UL << N;
+
+    static inline __attribute__((always_inline)) void high() {
+        sio_hw->gpio_set = mask;
+    }
+    static inline __attribute__((always_inline)) void low() {
+        sio_hw->gpio_clr = mask;
+    }
+    static inline __attribute__((always_inline)) void toggle() {
+        sio_hw->gpio_togl = mask;
+    }
+    static inline __attribute__((always_inline)) void write(bool v) {
+        if (v) {
+            high();
+        } else {
+            low();
+        }
+    }
+    static inline __attribute__((always_inline)) bool read() {
+        return sio_hw->gpio_in & mask;
+    }
+    static inline __attribute__((always_inline)) void output() {
+        sio_hw->gpio_oe_set = mask;
+    }
+    static inline __attribute__((always_inline)) void input() {
+        sio_hw->gpio_oe_clr = mask;
+    }
+};
@@ -0,0 +1,372 @@
+/*
+    Shared flash erase/program service for LittleFS, EEPROM, Updater and sketches
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <hardware/flash.h>
+#include <hardware/sync.h>
+#include <hardware/structs/ssi.h>
+#include "FlashService.h"
+
+#ifndef RP2040_QSPI_MAX_HZ
+#define RP2040_QSPI_MAX_HZ 133000000
+#endif
+
+// One flash command: a page program, or an erase of len bytes
+typedef struct FlashOp {
+    struct FlashOp *next;
+    uint32_t seq;
+    uint32_t offset;
+    uint32_t len;               // 0 for a program
+    uint8_t data[];             // FLASH_PAGE_SIZE bytes for a program
+} FlashOp;
+
+// An async request, finished once every op up to seq is done
+typedef struct FlashReq {
+    struct FlashReq *next;
+    uint32_t seq;
+    FlashServiceCB cb;
+    void *arg;
+} FlashReq;
+
+static FlashOp *_opHead = nullptr;
+static FlashOp *_opTail = nullptr;
+static FlashReq *_reqHead = nullptr;
+static FlashReq *_reqTail = nullptr;
+static uint32_t _seq = 0;
+static volatile uint32_t _doneSeq = 0;
+static volatile int _serviceCore = -1; // Core inside __flashService(), if any
+static spin_lock_t *_flashLock = spin_lock_instance(next_striped_spin_lock_num());
+static uint32_t _bootSSIDiv = 0; // boot2's QSPI divider
+static uint32_t _ssiDiv = 0; // Divider to restore after boot2 is rerun, 0 for boot2's own
+
+// The SSI can only be changed while disabled, when nothing at all can come from flash
+static void __no_inline_not_in_flash_func(_setSSIDiv)(uint32_t div) {
+    ssi_hw->ssienr = 0;
+    ssi_hw->baudr = div;
+    ssi_hw->ssienr = 1;
+}
+
+// Every SDK flash call ends by rerunning boot2, which puts back its own divider.  They're
+// wrapped at link time (lib/platform_wrap.txt), so whoever calls them, the chosen divider is
+// restored from RAM before anything is fetched from flash again.
+extern "C" {
+    void __real_flash_range_erase(uint32_t offset, size_t count);
+    void __real_flash_range_program(uint32_t offset, const uint8_t *data, size_t count);
+    void __real_flash_do_cmd(const uint8_t *txbuf, uint8_t *rxbuf, size_t count);
+    void __real_flash_get_unique_id(uint8_t *id);
+
+    __attribute__((used)) void __no_inline_not_in_flash_func(__wrap_flash_range_erase)(uint32_t offset, size_t count) {
+        __real_flash_range_erase(offset, count);
+        if (_ssiDiv) {
+            _setSSIDiv(_ssiDiv);
+        }
+    }
+
+    __attribute__((used)) void __no_inline_not_in_flash_func(__wrap_flash_range_program)(uint32_t offset, const uint8_t *data, size_t count) {
+        __real_flash_range_program(offset, data, count);
+        if (_ssiDiv) {
+            _setSSIDiv(_ssiDiv);
+        }
+    }
+
+    __attribute__((used)) void __no_inline_not_in_flash_func(__wrap_flash_do_cmd)(const uint8_t *txbuf, uint8_t *rxbuf, size_t count) {
+        __real_flash_do_cmd(txbuf, rxbuf, count);
+        if (_ssiDiv) {
+            _setSSIDiv(_ssiDiv);
+        }
+    }
+
+    __attribute__((used)) void __no_inline_not_in_flash_func(__wrap_flash_get_unique_id)(uint8_t *id) {
+        __real_flash_get_unique_id(id);
+        if (_ssiDiv) {
+            _setSSIDiv(_ssiDiv);
+        }
+    }
+}
+
+static void _erase(uint32_t offset, uint32_t len) {
+    PROFILE_CORE_SCOPE("Flash erase");
+    noInterrupts();
+    rp2040.idleOtherCore();
+    flash_range_erase(offset, len);
+    rp2040.resumeOtherCore();
+    interrupts();
+}
+
+// The page is always in RAM, since the source can't be read from flash while programming
+static void _program(uint32_t offset, const uint8_t *page) {
+    PROFILE_CORE_SCOPE("Flash program");
+    noInterrupts();
+    rp2040.idleOtherCore();
+    flash_range_program(offset, page, FLASH_PAGE_SIZE);
+    rp2040.resumeOtherCore();
+    interrupts();
+}
+
+// Does the oldest queued command, only from the core owning the service
+static void _runOp() {
+    uint32_t irqs = spin_lock_blocking(_flashLock);
+    FlashOp *op = _opHead;
+    if (op) {
+        _opHead = op->next;
+        if (!_opHead) {
+            _opTail = nullptr;
+        }
+    }
+    spin_unlock(_flashLock, irqs);
+    if (op) {
+        if (op->len) {
+            _erase(op->offset, op->len);
+        } else {
+            _program(op->offset, op->data);
+        }
+        _doneSeq = op->seq;
+        free(op);
+    }
+}
+
+// Synchronous calls finish every queued command first, so an older async write can never
+// land on top of them.  From a callback the service is already this core's, so the commands
+// are run directly.
+static void _drainOps() {
+    while (_opHead) {
+        if (_serviceCore == (int)get_core_num()) {
+            _runOp();
+        } else {
+            __flashService();
+        }
+    }
+}
+
+bool __flashErase(uint32_t offset, size_t len, bool allowBlockErase) {
+    if ((offset | len) & (FLASH_SECTOR_SIZE - 1)) {
+        return false;
+    }
+    _drainOps();
+    while (len) {
+        uint32_t n = FLASH_SECTOR_SIZE;
+        if (allowBlockErase && !(offset & (FLASH_BLOCK_SIZE - 1)) && (len >= FLASH_BLOCK_SIZE)) {
+            n = FLASH_BLOCK_SIZE;
+        }
+        _erase(offset, n);
+        offset += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool __flashProgram(uint32_t offset, const void *src, size_t len) {
+    if (offset & (FLASH_PAGE_SIZE - 1)) {
+        return false;
+    }
+    _drainOps();
+    const uint8_t *data = (const uint8_t *)src;
+    uint8_t page[FLASH_PAGE_SIZE] __attribute__((aligned(4)));
+    while (len) {
+        size_t n = std::min(len, (size_t)FLASH_PAGE_SIZE);
+        memcpy(page, data, n);
+        memset(page + n, 0xff, FLASH_PAGE_SIZE - n); // Programming 0xff leaves flash as-is
+        _program(offset, page);
+        offset += FLASH_PAGE_SIZE;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Called with the lock held
+static void _appendOp(FlashOp *op) {
+    op->next = nullptr;
+    op->seq = ++_seq;
+    if (_opTail) {
+        _opTail->next = op;
+    } else {
+        _opHead = op;
+    }
+    _opTail = op;
+}
+
+static bool _appendReq(uint32_t seq, FlashServiceCB cb, void *arg) {
+    FlashReq *r = (FlashReq *)malloc(sizeof(FlashReq));
+    if (!r) {
+        return false;
+    }
+    r->next = nullptr;
+    r->seq = seq;
+    r->cb = cb;
+    r->arg = arg;
+    uint32_t irqs = spin_lock_blocking(_flashLock);
+    if (_reqTail) {
+        _reqTail->next = r;
+    } else {
+        _reqHead = r;
+    }
+    _reqTail = r;
+    spin_unlock(_flashLock, irqs);
+    return true;
+}
+
+bool __flashEraseAsync(uint32_t offset, size_t len, FlashServiceCB cb, void *arg) {
+    if ((offset | len) & (FLASH_SECTOR_SIZE - 1)) {
+        return false;
+    }
+    uint32_t seq = _seq;
+    for (; len; offset += FLASH_SECTOR_SIZE, len -= FLASH_SECTOR_SIZE) {
+        FlashOp *op = (FlashOp *)malloc(sizeof(FlashOp));
+        if (!op) {
+            return false;
+        }
+        op->offset = offset;
+        op->len = FLASH_SECTOR_SIZE;
+        uint32_t irqs = spin_lock_blocking(_flashLock);
+        _appendOp(op);
+        seq = op->seq;
+        spin_unlock(_flashLock, irqs);
+    }
+    return _appendReq(seq, cb, arg);
+}
+
+bool __flashProgramAsync(uint32_t offset, const void *src, size_t len, FlashServiceCB cb, void *arg) {
+    if (offset & (FLASH_PAGE_SIZE - 1)) {
+        return false;
+    }
+    const uint8_t *data = (const uint8_t *)src;
+    uint32_t seq = _seq;
+    for (; len; offset += FLASH_PAGE_SIZE) {
+        size_t n = std::min(len, (size_t)FLASH_PAGE_SIZE);
+        FlashOp *op = (FlashOp *)malloc(sizeof(FlashOp) + FLASH_PAGE_SIZE);
+        if (!op) {
+            return false;
+        }
+        op->offset = offset;
+        op->len = 0;
+        memcpy(op->data, data, n);
+        memset(op->data + n, 0xff, FLASH_PAGE_SIZE - n);
+        data += n;
+        len -= n;
+
+        uint32_t irqs = spin_lock_blocking(_flashLock);
+        // The last program of this page not followed by an erase of it can simply take these
+        // bits too, since programming only ever clears them
+        FlashOp *match = nullptr;
+        for (FlashOp *p = _opHead; p; p = p->next) {
+            if (!p->len && (p->offset == offset)) {
+                match = p;
+            } else if (p->len && (offset >= p->offset) && (offset < p->offset + p->len)) {
+                match = nullptr;
+            }
+        }
+        if (match) {
+            for (size_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+                match->data[i] &= op->data[i];
+            }
+            seq = std::max(seq, match->seq);
+        } else {
+            _appendOp(op);
+            seq = op->seq;
+            op = nullptr;
+        }
+        spin_unlock(_flashLock, irqs);
+        free(op);
+    }
+    return _appendReq(seq, cb, arg);
+}
+
+bool __flashBusy() {
+    return _opHead || _reqHead;
+}
+
+void __flashService() {
+    if (!__flashBusy()) {
+        return;
+    }
+    uint32_t irqs = spin_lock_blocking(_flashLock);
+    bool mine = _serviceCore < 0;
+    if (mine) {
+        _serviceCore = get_core_num();
+    }
+    spin_unlock(_flashLock, irqs);
+    if (!mine) {
+        return; // The other core is already at it
+    }
+
+    _runOp();
+
+    // Finished requests, in the order they were made
+    while (true) {
+        irqs = spin_lock_blocking(_flashLock);
+        FlashReq *r = _reqHead;
+        if (r && ((int32_t)(r->seq - _doneSeq) <= 0)) {
+            _reqHead = r->next;
+            if (!_reqHead) {
+                _reqTail = nullptr;
+            }
+        } else {
+            r = nullptr;
+        }
+        spin_unlock(_flashLock, irqs);
+        if (!r) {
+            break;
+        }
+        if (r->cb) {
+            r->cb(r->arg, true);
+        }
+        free(r);
+    }
+    _serviceCore = -1;
+}
+
+void __flashFlush() {
+    while (__flashBusy()) {
+        __flashService();
+    }
+}
+
+uint32_t __flashClockDivider(uint32_t sysHz) {
+    if (!_bootSSIDiv) {
+        _bootSSIDiv = ssi_hw->baudr;
+    }
+#ifdef RP2040_QSPI_CLKDIV
+    uint32_t div = RP2040_QSPI_CLKDIV;
+#else
+    uint32_t div = _bootSSIDiv;
+#endif
+    while (sysHz > div * (uint32_t)RP2040_QSPI_MAX_HZ) {
+        div += 2;
+    }
+    return div;
+}
+
+void __flashSetClockDivider(uint32_t div) {
+    if (!_bootSSIDiv) {
+        _bootSSIDiv = ssi_hw->baudr;
+    }
+    if ((div < 2) || (div & 1)) {
+        return;
+    }
+    noInterrupts();
+    rp2040.idleOtherCore();
+    _ssiDiv = (div == _bootSSIDiv) ? 0 : div;
+    if (ssi_hw->baudr != div) {
+        _setSSIDiv(div);
+    }
+    rp2040.resumeOtherCore();
+    interrupts();
+}
@@ -0,0 +1,56 @@
+/*
+    Shared flash erase/program service for LittleFS, EEPROM, Updater and sketches
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// While flash is erased or programmed nothing can run from it, so interrupts are off and the
+// other core is idled.  These split every request into single page programs and single
+// sector (or 64K block) erases, and let interrupts and the other core run between each one,
+// so nothing is ever held off for longer than one flash command.  Offsets are from the start
+// of flash, erases must be sector aligned and programs page aligned.  Anything still queued
+// by the async calls below is written first, so the two never land out of order.
+extern bool __flashErase(uint32_t offset, size_t len, bool allowBlockErase = false);
+extern bool __flashProgram(uint32_t offset, const void *data, size_t len);
+
+// Queued versions, returning immediately.  The data is copied, and a page program queued
+// behind another program of the same page (with no erase in between) is merged into it.
+// The queue is worked through one command per pass of the main loop, or all at once by
+// __flashFlush(), which must be used under FreeRTOS.  cb, if given, is called from there
+// when the request is finished, and must not call __flashFlush() itself.  Reads of flash see
+// the old contents until then.
+typedef void (*FlashServiceCB)(void *arg, bool ok);
+extern bool __flashEraseAsync(uint32_t offset, size_t len, FlashServiceCB cb = nullptr, void *arg = nullptr);
+extern bool __flashProgramAsync(uint32_t offset, const void *data, size_t len, FlashServiceCB cb = nullptr, void *arg = nullptr);
+extern bool __flashBusy();
+extern void __flashFlush();
+
+// Does one queued command, called from the main loop
+extern void __flashService();
+
+// The QSPI flash clock is clk_sys divided by an even number, /2 or /4 as set by boot2.
+// __flashClockDivider() returns the one to use at sysHz: boot2's (or RP2040_QSPI_CLKDIV for
+// flash known to be good at /2) raised as far as needed to keep the flash clock under
+// RP2040_QSPI_MAX_HZ.  __flashSetClockDivider() reprograms it, and it is put back after every
+// flash write since those rerun boot2.
+extern uint32_t __flashClockDivider(uint32_t sysHz);
+extern void __flashSetClockDivider(uint32_t div);
@@ -0,0 +1,85 @@
+/*
+    Lets driver code wait for its IRQ handler without spinning under FreeRTOS
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+extern bool __isFreeRTOS;
+
+// Provided by the FreeRTOS library.  Waits use task notification index 1, so a sketch's own
+// notifications (index 0) aren't disturbed
+extern "C" {
+    extern void *__freertos_task_current() __attribute__((weak));
+    extern void __freertos_task_wait(uint32_t ms) __attribute__((weak));
+    extern void __freertos_task_notify(void *task) __attribute__((weak));
+}
+
+// Under FreeRTOS the waiting task blocks until the driver's IRQ handler calls notify(), so
+// other tasks get the CPU instead of it spinning for its whole time slice.  Without FreeRTOS
+// nothing changes: wait() returns at once and until() spins, just like the loops it replaces.
+// Only one task may wait on each IRQWait at a time.
+class IRQWait {
+public:
+    // Waits until done() returns true, sleeping at most maxMs between checks in case the
+    // condition changes without a notify()
+    template <typename F>
+    void until(F done, uint32_t maxMs = 1000) {
+        if (!__isFreeRTOS) {
+            while (!done()) {
+                /* noop busy wait */
+            }
+            return;
+        }
+        while (true) {
+            arm();
+            if (done()) {
+                break;
+            }
+            wait(maxMs);
+        }
+        _task = nullptr;
+    }
+
+    // For loops with their own exit conditions: arm() before checking the condition, and
+    // wait() if it isn't met.  Waits may also end early, so the condition must be checked again
+    void arm() {
+        if (__isFreeRTOS) {
+            _task = __freertos_task_current();
+        }
+    }
+
+    void wait(uint32_t ms) {
+        if (__isFreeRTOS && _task && ms) {
+            __freertos_task_wait(ms);
+        }
+    }
+
+    // From the IRQ handler (or another task) once the condition may have changed
+    inline void notify() {
+        void *t = _task;
+        if (t) {
+            __freertos_task_notify(t);
+        }
+    }
+
+private:
+    void * volatile _task = nullptr;
+};
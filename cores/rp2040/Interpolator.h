@@ -0,0 +1,118 @@
+/*
+    Interpolator - SIO interpolator access and IRQ-safe interpolator/divider context saves
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <hardware/interp.h>
+#include <hardware/divider.h>
+
+// One of the two interpolators in the calling core's SIO.  Each core has its own pair at
+// the same address, so an Interpolator always drives the hardware of whichever core uses
+// it.  Nothing is claimed: code which may interrupt other users (IRQs, or libraries called
+// from a sketch) should hold an InterpolatorSave while it works.
+class Interpolator {
+public:
+    Interpolator(int num) : _hw(num ? interp1 : interp0) {
+    }
+
+    // Lane setup, see the RP2040 datasheet section 2.3.1.6.  result = base + ((accum >> shift)
+    // & mask), with mask covering bits maskLSB...maskMSB.
+    void config(int lane, uint shift, uint maskLSB, uint maskMSB, bool isSigned = false, bool crossInput = false, bool crossResult = false, bool addRaw = false) {
+        interp_config c = interp_default_config();
+        interp_config_set_shift(&c, shift);
+        interp_config_set_mask(&c, maskLSB, maskMSB);
+        interp_config_set_signed(&c, isSigned);
+        interp_config_set_cross_input(&c, crossInput);
+        interp_config_set_cross_result(&c, crossResult);
+        interp_config_set_add_raw(&c, addRaw);
+        interp_set_config(_hw, lane, &c);
+    }
+    // Anything else (blend, clamp, force bits) through the SDK's interp_config_* calls
+    void config(int lane, interp_config *c) {
+        interp_set_config(_hw, lane, c);
+    }
+
+    void setAccumulator(int lane, uint32_t val) {
+        _hw->accum[lane] = val;
+    }
+    uint32_t accumulator(int lane) {
+        return _hw->accum[lane];
+    }
+    // Lane 2 is the base added to the full result
+    void setBase(int lane, uint32_t val) {
+        _hw->base[lane] = val;
+    }
+    uint32_t base(int lane) {
+        return _hw->base[lane];
+    }
+    // Adds to the accumulator without the read-modify-write a setAccumulator() would need
+    void add(int lane, uint32_t val) {
+        _hw->add_raw[lane] = val;
+    }
+
+    // Lane 0 or 1 result, or 2 for the full result.  pop() also writes both lane results
+    // back to their accumulators.
+    uint32_t peek(int lane) {
+        return _hw->peek[lane];
+    }
+    uint32_t pop(int lane) {
+        return _hw->pop[lane];
+    }
+
+    interp_hw_t *hw() {
+        return _hw;
+    }
+
+private:
+    interp_hw_t *_hw;
+};
+
+// Saves an interpolator's whole state on construction and puts it back when it goes
+// out of scope
+class InterpolatorSave {
+public:
+    InterpolatorSave(Interpolator &i) : _hw(i.hw()) {
+        interp_save(_hw, &_state);
+    }
+    ~InterpolatorSave() {
+        interp_restore(_hw, &_state);
+    }
+
+private:
+    interp_hw_t *_hw;
+    interp_hw_save_t _state;
+};
+
+// The same for the calling core's hardware divider, for IRQ code which starts divisions
+// with the hw_divider_*() calls directly.  Plain C "/" and "%" go through the SDK's
+// wrappers which already save the divider when it is busy, and don't need this.
+class DividerSave {
+public:
+    DividerSave() {
+        hw_divider_save_state(&_state);
+    }
+    ~DividerSave() {
+        hw_divider_restore_state(&_state);
+    }
+
+private:
+    hw_divider_state_t _state;
+};
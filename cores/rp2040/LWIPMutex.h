@@ -25,9 +25,15 @@
 
 extern "C" volatile bool __inLWIP;
 
+// Cross-core lock around the stack.  No-ops unless lwIP runs on the other core
+// (network_core1), where they take the CYW43 driver's recursive mutex.
+extern "C" void __lwipLock();
+extern "C" void __lwipUnlock();
+
 class LWIPMutex {
 public:
     LWIPMutex() {
+        __lwipLock();
         __inLWIP = true;
         _ref++;
     }
@@ -35,7 +41,28 @@ public:
         if (0 == --_ref) {
             __inLWIP = false;
         }
+        __lwipUnlock();
     }
 private:
+    friend class LWIPUnlock;
     static int _ref;
 };
+
+// Releases the lock for the lifetime of the object so the network core can run the
+// callbacks a blocking call is waiting on.  Timers stay blocked, as with LWIPMutex.
+class LWIPUnlock {
+public:
+    LWIPUnlock() {
+        _saved = LWIPMutex::_ref;
+        for (int i = 0; i < _saved; i++) {
+            __lwipUnlock();
+        }
+    }
+    ~LWIPUnlock() {
+        for (int i = 0; i < _saved; i++) {
+            __lwipLock();
+        }
+    }
+private:
+    int _saved;
+};
@@ -0,0 +1,138 @@
+/*
+    Per-core line buffered Print for sharing one port between the cores
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pico/mutex.h>
+#include "api/Print.h"
+#include "CoreMutex.h"
+#include "RingBufferSPSC.h"
+
+// Each core collects what it prints in its own buffer, and only goes to the port with a whole
+// line (at '\n', when LINE bytes have built up, or on flush()), in one write() under a lock.
+// Lines from the two cores never interleave, and a core only waits for the port once per line
+// instead of once per print() fragment.
+//
+// After handoff(core), lines printed on the other core go into a lockless ring instead, and
+// are written out by the given core from poll() or before its own next line, so the other core
+// never waits for the port at all.  A line which doesn't fit in the ring is dropped and counted.
+//
+// Not for use from IRQs, which would mix their output into the interrupted core's line.
+template<size_t LINE = 128, size_t RING = 1024>
+class LinePrint : public Print {
+    static_assert(LINE && (LINE < 65536), "LinePrint lines must be 1 to 65535 bytes");
+    static_assert(RING >= LINE + 2, "LinePrint ring must hold a full line");
+
+public:
+    LinePrint(Print &out) : _out(out) {
+        mutex_init(&_mutex);
+    }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buf, size_t len) override {
+        Line &l = _line[get_core_num()];
+        for (size_t i = 0; i < len; i++) {
+            l.buf[2 + l.len++] = buf[i];
+            if ((buf[i] == '\n') || (l.len == LINE)) {
+                _emit(l);
+            }
+        }
+        return len;
+    }
+
+    int availableForWrite() override {
+        return LINE - _line[get_core_num()].len;
+    }
+
+    // Sends this core's partial line, and on the handoff core everything queued
+    void flush() override {
+        _emit(_line[get_core_num()]);
+        poll();
+    }
+
+    // Lines from the other core are written out by this one (0 or 1), -1 to write them directly
+    void handoff(int core) {
+        _owner = core;
+    }
+
+    // On the handoff core, writes out the lines queued by the other one
+    void poll() {
+        if ((int)get_core_num() != _owner) {
+            return;
+        }
+        uint8_t hdr[2];
+        uint8_t data[LINE];
+        while (_ring.read(hdr, 2) == 2) {
+            size_t len = hdr[0] | (hdr[1] << 8);
+            _ring.read(data, len); // Always all there, it was queued in one piece
+            _put(data, len);
+        }
+    }
+
+    // Lines lost because the ring was full
+    uint32_t dropped() const {
+        return _dropped;
+    }
+
+private:
+    typedef struct {
+        uint8_t buf[2 + LINE]; // Length, then the line, so it's queued in one write
+        size_t  len;
+    } Line;
+
+    void _emit(Line &l) {
+        if (!l.len) {
+            return;
+        }
+        int core = get_core_num();
+        if ((_owner >= 0) && (core != _owner)) {
+            if (_ring.availableForStore() >= 2 + l.len) {
+                l.buf[0] = l.len & 0xff;
+                l.buf[1] = l.len >> 8;
+                _ring.write(l.buf, 2 + l.len);
+            } else {
+                _dropped = _dropped + 1;
+            }
+        } else {
+            poll(); // Keep the other core's earlier lines first
+            _put(l.buf + 2, l.len);
+        }
+        l.len = 0;
+    }
+
+    void _put(const uint8_t *buf, size_t len) {
+        CoreMutex m(&_mutex);
+        if (m) {
+            _out.write(buf, len);
+        }
+    }
+
+    Print &_out;
+    mutex_t _mutex;
+    Line _line[2] = { };
+    RingBufferSPSC<uint8_t, RING> _ring;
+    volatile int _owner = -1;
+    volatile uint32_t _dropped = 0; // Only written by the queueing core
+};
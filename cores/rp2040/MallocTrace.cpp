@@ -0,0 +1,350 @@
+/*
+    Heap allocation tracing and fragmentation statistics
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <math.h>
+#include <reent.h>
+#include <unistd.h>
+#include "MallocTrace.h"
+
+extern "C" {
+    void *__real_malloc(size_t size);
+    void __real_free(void *mem);
+    void __malloc_lock(struct _reent *r);
+    void __malloc_unlock(struct _reent *r);
+    extern char __end__;
+    extern char __StackLimit;
+}
+extern void (*__mallocTraceHook)(void *mem, void *old, size_t size, void *caller);
+
+typedef struct {
+    uintptr_t ptr; // 0 = empty
+    uint32_t size;
+    uint16_t site;
+} LiveBlock;
+
+static constexpr uint16_t OVERFLOW_SITE = 0xffff; // Callers beyond maxSites are lumped in here
+
+static spin_lock_t *_lock = nullptr;
+static LiveBlock *_live = nullptr;   // Open addressed, linear probing, power of 2 size
+static int _liveBits;
+static size_t _liveCount;
+static size_t _liveMax;
+static MallocTrace::Site *_sites = nullptr; // Likewise, keyed by caller
+static int _siteBits;
+static size_t _siteCount;
+static size_t _siteMax;
+static MallocTrace::Site _overflow;
+static uint32_t _dropped;
+
+static inline size_t _hash(uintptr_t v, int bits) {
+    return ((uint32_t)v * 2654435761u) >> (32 - bits);
+}
+
+static int _bitsFor(size_t n) {
+    int bits = 4;
+    while (((size_t)1 << bits) < n * 2) { // Keep the tables at most half full
+        bits++;
+    }
+    return bits;
+}
+
+static uint16_t _siteFor(void *caller) {
+    size_t mask = (1 << _siteBits) - 1;
+    for (size_t i = _hash((uintptr_t)caller, _siteBits); ; i = (i + 1) & mask) {
+        if (_sites[i].caller == caller) {
+            return i;
+        }
+        if (!_sites[i].caller) {
+            if (_siteCount >= _siteMax) {
+                return OVERFLOW_SITE;
+            }
+            _siteCount++;
+            _sites[i].caller = caller;
+            return i;
+        }
+    }
+}
+
+static inline MallocTrace::Site *_site(uint16_t idx) {
+    return (idx == OVERFLOW_SITE) ? &_overflow : &_sites[idx];
+}
+
+static LiveBlock *_liveFind(uintptr_t ptr) {
+    size_t mask = (1 << _liveBits) - 1;
+    for (size_t i = _hash(ptr, _liveBits); _live[i].ptr; i = (i + 1) & mask) {
+        if (_live[i].ptr == ptr) {
+            return &_live[i];
+        }
+    }
+    return nullptr;
+}
+
+static bool _liveInsert(uintptr_t ptr, uint32_t size, uint16_t site) {
+    if (_liveCount >= _liveMax) {
+        return false;
+    }
+    size_t mask = (1 << _liveBits) - 1;
+    size_t i = _hash(ptr, _liveBits);
+    while (_live[i].ptr) {
+        i = (i + 1) & mask;
+    }
+    _live[i] = { ptr, size, site };
+    _liveCount++;
+    return true;
+}
+
+// Backward shift deletion, so lookups never need tombstones
+static void _liveRemove(LiveBlock *b) {
+    size_t mask = (1 << _liveBits) - 1;
+    size_t i = b - _live;
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (!_live[j].ptr) {
+            break;
+        }
+        size_t home = _hash(_live[j].ptr, _liveBits);
+        bool stays = (i <= j) ? ((i < home) && (home <= j)) : ((i < home) || (home <= j));
+        if (!stays) {
+            _live[i] = _live[j];
+            i = j;
+        }
+    }
+    _live[i].ptr = 0;
+    _liveCount--;
+}
+
+static void _hook(void *mem, void *old, size_t size, void *caller) {
+    uint32_t irqs = spin_lock_blocking(_lock);
+    if (_live) {
+        if (old) {
+            LiveBlock *b = _liveFind((uintptr_t)old);
+            if (b) {
+                MallocTrace::Site *s = _site(b->site);
+                s->frees++;
+                s->liveBlocks--;
+                s->liveBytes -= b->size;
+                _liveRemove(b);
+            }
+        }
+        if (mem) {
+            uint16_t idx = _siteFor(caller);
+            MallocTrace::Site *s = _site(idx);
+            s->allocs++;
+            if (_liveInsert((uintptr_t)mem, size, idx)) {
+                s->liveBlocks++;
+                s->liveBytes += size;
+                if (s->liveBytes > s->peakBytes) {
+                    s->peakBytes = s->liveBytes;
+                }
+            } else {
+                _dropped++;
+            }
+        }
+    }
+    spin_unlock(_lock, irqs);
+}
+
+bool MallocTrace::begin(size_t maxLive, size_t maxSites) {
+    if (_live || !maxLive || !maxSites || (maxSites > 16384)) {
+        return false;
+    }
+    int liveBits = _bitsFor(maxLive);
+    int siteBits = _bitsFor(maxSites);
+    LiveBlock *live = (LiveBlock *)__real_malloc(sizeof(LiveBlock) << liveBits);
+    Site *sites = (Site *)__real_malloc(sizeof(Site) << siteBits);
+    if (!live || !sites) {
+        __real_free(live);
+        __real_free(sites);
+        return false;
+    }
+    memset(live, 0, sizeof(LiveBlock) << liveBits);
+    memset(sites, 0, sizeof(Site) << siteBits);
+    if (!_lock) {
+        _lock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+    uint32_t irqs = spin_lock_blocking(_lock);
+    _live = live;
+    _liveBits = liveBits;
+    _liveMax = maxLive;
+    _liveCount = 0;
+    _sites = sites;
+    _siteBits = siteBits;
+    _siteMax = maxSites;
+    _siteCount = 0;
+    memset(&_overflow, 0, sizeof(_overflow));
+    _dropped = 0;
+    spin_unlock(_lock, irqs);
+    __mallocTraceHook = _hook;
+    return true;
+}
+
+void MallocTrace::end() {
+    if (!_live) {
+        return;
+    }
+    __mallocTraceHook = nullptr;
+    uint32_t irqs = spin_lock_blocking(_lock);
+    LiveBlock *live = _live;
+    Site *sites = _sites;
+    _live = nullptr;
+    _sites = nullptr;
+    spin_unlock(_lock, irqs);
+    __real_free(live);
+    __real_free(sites);
+}
+
+// Forgets everything so far.  Blocks which are already allocated won't show up when freed
+void MallocTrace::reset() {
+    if (!_live) {
+        return;
+    }
+    uint32_t irqs = spin_lock_blocking(_lock);
+    memset(_live, 0, sizeof(LiveBlock) << _liveBits);
+    memset(_sites, 0, sizeof(Site) << _siteBits);
+    memset(&_overflow, 0, sizeof(_overflow));
+    _liveCount = 0;
+    _siteCount = 0;
+    _dropped = 0;
+    spin_unlock(_lock, irqs);
+}
+
+uint32_t MallocTrace::dropped() {
+    return _dropped;
+}
+
+size_t MallocTrace::sites(Site *out, size_t max) {
+    if (!_live) {
+        return 0;
+    }
+    size_t n = 0;
+    uint32_t irqs = spin_lock_blocking(_lock);
+    for (size_t i = 0; i < ((size_t)1 << _siteBits); i++) {
+        if (_sites[i].caller) {
+            if (n < max) {
+                out[n] = _sites[i];
+            }
+            n++;
+        }
+    }
+    if (_overflow.allocs) {
+        if (n < max) {
+            out[n] = _overflow;
+        }
+        n++;
+    }
+    spin_unlock(_lock, irqs);
+    return n;
+}
+
+// Walks newlib's malloc chunks (size word, with bit 0 set when the previous chunk is in
+// use) from the start of the heap to the current break.  The last chunk is the "top" one,
+// which can also grow into the space not yet taken from sbrk().
+MallocTrace::Heap MallocTrace::heap() {
+    Heap h = { 0, 0, 0, 0 };
+    uint64_t sumSq = 0;
+    auto add = [&](size_t bytes) {
+        h.freeBytes += bytes;
+        h.freeBlocks++;
+        if (bytes > h.largestFree) {
+            h.largestFree = bytes;
+        }
+        sumSq += (uint64_t)bytes * bytes;
+    };
+
+    __malloc_lock(_REENT);
+    uintptr_t brk = (uintptr_t)sbrk(0);
+    uintptr_t p = ((uintptr_t)&__end__ + 7) & ~7;
+    bool top = false;
+    while (p + 8 <= brk) {
+        size_t size = ((uint32_t *)p)[1] & ~3;
+        if ((size < 16) || (p + size > brk)) {
+            break; // Not a chunk we understand, stop rather than walk off into the weeds
+        }
+        uintptr_t next = p + size;
+        if (next + 8 > brk) {
+            add(size - 8 + ((uintptr_t)&__StackLimit - brk));
+            top = true;
+            break;
+        }
+        if (!(((uint32_t *)next)[1] & 1)) {
+            add(size - 8);
+        }
+        p = next;
+    }
+    if (!top) {
+        add((uintptr_t)&__StackLimit - brk);
+    }
+    __malloc_unlock(_REENT);
+
+    // The same measure as the ESP8266's ESP.getHeapFragmentation()
+    if (h.freeBytes) {
+        h.fragmentation = 100 - (uint8_t)(sqrtf((float)sumSq) * 100 / h.freeBytes);
+    }
+    return h;
+}
+
+extern "C" size_t __mallocLargestFree() {
+    return MallocTrace::heap().largestFree;
+}
+
+extern "C" uint8_t __mallocFragmentation() {
+    return MallocTrace::heap().fragmentation;
+}
+
+void MallocTrace::dump(Print &out) {
+    Heap h = heap();
+    out.printf("Heap: %u free in %u blocks, largest %u, fragmentation %u%%\n", h.freeBytes, h.freeBlocks,
+               h.largestFree, h.fragmentation);
+    if (!_live) {
+        return;
+    }
+    size_t n = sites(nullptr, 0);
+    Site *s = (Site *)__real_malloc(sizeof(Site) * n);
+    if (!s) {
+        return;
+    }
+    n = std::min(n, sites(s, n));
+    // Biggest holders first
+    for (size_t i = 1; i < n; i++) {
+        Site t = s[i];
+        size_t j = i;
+        while ((j > 0) && (s[j - 1].liveBytes < t.liveBytes)) {
+            s[j] = s[j - 1];
+            j--;
+        }
+        s[j] = t;
+    }
+    out.printf("%-10s %8s %8s %8s %10s %10s\n", "Caller", "Allocs", "Frees", "Live", "LiveBytes", "PeakBytes");
+    for (size_t i = 0; i < n; i++) {
+        if (s[i].caller) {
+            out.printf("0x%08x", (uint32_t)s[i].caller);
+        } else {
+            out.printf("%-10s", "(other)");
+        }
+        out.printf(" %8lu %8lu %8lu %10lu %10lu\n", s[i].allocs, s[i].frees, s[i].liveBlocks, s[i].liveBytes,
+                   s[i].peakBytes);
+    }
+    if (_dropped) {
+        out.printf("%lu allocations not tracked, the live block table was full\n", _dropped);
+    }
+    __real_free(s);
+}
@@ -0,0 +1,65 @@
+/*
+    Heap allocation tracing and fragmentation statistics
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Print;
+
+// Records every malloc/calloc/realloc/free/new by the address of the code which made it.
+// Off until begin(), and then costs a spinlock and two small hash lookups per call.  The
+// heap statistics work whether or not tracing is on.
+class MallocTrace {
+public:
+    typedef struct {
+        void *caller;        // Return address of the malloc/new call, look it up in the .map/.elf
+        uint32_t allocs;
+        uint32_t frees;      // Of blocks allocated here, wherever they were freed from
+        uint32_t liveBlocks;
+        uint32_t liveBytes;
+        uint32_t peakBytes;
+    } Site;
+
+    typedef struct {
+        size_t freeBytes;      // Including the space the heap can still grow into
+        size_t largestFree;    // The biggest block malloc() could return right now
+        size_t freeBlocks;
+        uint8_t fragmentation; // 0 = all free space in one block, towards 100 = many small ones
+    } Heap;
+
+    // Tracks up to maxLive outstanding blocks (for the live byte counts) and maxSites
+    // call sites, in tables taken from the heap
+    static bool begin(size_t maxLive = 512, size_t maxSites = 64);
+    static void end();
+    static void reset();
+
+    // Allocations made while the live block table was full, which aren't in the live counts
+    static uint32_t dropped();
+
+    // Copies out up to max sites, returning how many there are
+    static size_t sites(Site *out, size_t max);
+
+    static Heap heap();
+
+    // Heap statistics, then the sites sorted by live bytes
+    static void dump(Print &p);
+};
@@ -0,0 +1,148 @@
+/*
+    Fixed-block memory pool, safe to use from IRQs and from both cores
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <utility>
+#include <hardware/sync.h>
+
+// Pool of N blocks, each big enough to hold a T, kept on an intrusive free list.
+// The M0+ has no atomic read-modify-write instructions, so the list is guarded by
+// a (striped) hardware spinlock with interrupts masked.  That makes alloc() and
+// free() a handful of cycles, O(1), and safe from any IRQ on either core.
+template<typename T, size_t N>
+class MemoryPool {
+    static_assert(N > 0, "MemoryPool needs at least one block");
+
+public:
+    MemoryPool() {
+        _lock = spin_lock_instance(next_striped_spin_lock_num());
+        for (size_t i = 0; i < N - 1; i++) {
+            _slot[i].next = &_slot[i + 1];
+        }
+        _slot[N - 1].next = nullptr;
+        _free = &_slot[0];
+    }
+
+    ~MemoryPool() { /* noop */ }
+
+    // Raw, uninitialized storage for one T, or nullptr if the pool is empty
+    T *alloc() {
+        uint32_t irqs = spin_lock_blocking(_lock);
+        Slot *s = _free;
+        if (s) {
+            _free = s->next;
+            if (++_used > _highWater) {
+                _highWater = _used;
+            }
+        } else {
+            _failures++;
+        }
+        spin_unlock(_lock, irqs);
+        if (!s && _onEmpty) {
+            _onEmpty(_onEmptyArg);
+        }
+        return (T *)s;
+    }
+
+    // Return a block from alloc().  Any core or IRQ may free any block.
+    void free(T *p) {
+        if (!p) {
+            return;
+        }
+        Slot *s = (Slot *)p;
+        uint32_t irqs = spin_lock_blocking(_lock);
+        s->next = _free;
+        _free = s;
+        _used--;
+        spin_unlock(_lock, irqs);
+    }
+
+    // alloc() plus placement new
+    template<typename... Args>
+    T *create(Args&&... args) {
+        T *p = alloc();
+        return p ? new (p) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    // Run the destructor and free()
+    void destroy(T *p) {
+        if (p) {
+            p->~T();
+            free(p);
+        }
+    }
+
+    bool owns(const T *p) const {
+        return ((const Slot *)p >= &_slot[0]) && ((const Slot *)p < &_slot[N]);
+    }
+
+    // Statistics
+    size_t size() const {
+        return N;
+    }
+
+    size_t used() const {
+        return _used;
+    }
+
+    size_t available() const {
+        return N - _used;
+    }
+
+    // Largest number of blocks ever allocated at once
+    size_t highWater() const {
+        return _highWater;
+    }
+
+    // Number of alloc() calls which found the pool empty
+    uint32_t failures() const {
+        return _failures;
+    }
+
+    void resetStats() {
+        _highWater = _used;
+        _failures = 0;
+    }
+
+    // Called (outside the lock, possibly from an IRQ) whenever an alloc() fails
+    void onEmpty(void (*fn)(void *), void *arg = nullptr) {
+        _onEmptyArg = arg;
+        _onEmpty = fn;
+    }
+
+private:
+    union Slot {
+        Slot *next;
+        alignas(T) uint8_t data[sizeof(T)];
+    };
+
+    Slot _slot[N];
+    Slot *_free;
+    spin_lock_t *_lock;
+    volatile size_t _used = 0;
+    volatile size_t _highWater = 0;
+    volatile uint32_t _failures = 0;
+    void (*_onEmpty)(void *) = nullptr;
+    void *_onEmptyArg = nullptr;
+};
@@ -0,0 +1,122 @@
+/*
+    Lockless shared-memory queue for passing data between the RP2040 cores
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include "RingBufferSPSC.h"
+
+// Single-producer, single-consumer ring of any copyable type T.  One core
+// pushes and the other pops, so no locks are needed.  It is a RingBufferSPSC
+// (which handles the indices and barriers) with blocking calls added: SRAM
+// is coherent between the two M0+ cores, so a DMB before publishing an index
+// is enough.
+//
+// The hardware SIO FIFO belongs to _MFIFO's IRQ (idleOtherCore() and
+// runOnCore() requests), so instead of using it as a doorbell, blocking calls
+// sleep in WFE and every push/pop issues a SEV to wake up the other side.
+//
+// N must be a power of 2, and the queue holds up to N entries.
+template<typename T, size_t N>
+class MulticoreQueue {
+    static_assert(N && !(N & (N - 1)), "MulticoreQueue size must be a power of 2");
+
+public:
+    MulticoreQueue() { /* noop */ }
+    ~MulticoreQueue() { /* noop */ }
+
+    // Producer side, only call from one core
+    bool push_nb(const T &val) {
+        return push_nb(&val, 1) == 1;
+    }
+
+    void push(const T &val) {
+        while (!push_nb(val)) {
+            __wfe();
+        }
+    }
+
+    // Push up to cnt entries without blocking, returns # actually queued
+    size_t push_nb(const T *vals, size_t cnt) {
+        cnt = _ring.write(vals, cnt);
+        if (cnt) {
+            __sev();
+        }
+        return cnt;
+    }
+
+    // Push all entries, blocking as needed
+    void push(const T *vals, size_t cnt) {
+        while (cnt) {
+            size_t done = push_nb(vals, cnt);
+            vals += done;
+            cnt -= done;
+            if (cnt) {
+                __wfe();
+            }
+        }
+    }
+
+    // Consumer side, only call from the other core
+    bool pop_nb(T *val) {
+        return pop_nb(val, 1) == 1;
+    }
+
+    T pop() {
+        T ret;
+        while (!pop_nb(&ret)) {
+            __wfe();
+        }
+        return ret;
+    }
+
+    // Pop up to cnt entries without blocking, returns # actually read
+    size_t pop_nb(T *vals, size_t cnt) {
+        cnt = _ring.read(vals, cnt);
+        if (cnt) {
+            __sev();
+        }
+        return cnt;
+    }
+
+    // Pop exactly cnt entries, blocking as needed
+    void pop(T *vals, size_t cnt) {
+        while (cnt) {
+            size_t done = pop_nb(vals, cnt);
+            vals += done;
+            cnt -= done;
+            if (cnt) {
+                __wfe();
+            }
+        }
+    }
+
+    // Number of entries waiting to be popped
+    size_t available() const {
+        return _ring.available();
+    }
+
+    // Number of entries which can be pushed without blocking
+    size_t availableForWrite() const {
+        return _ring.availableForStore();
+    }
+
+private:
+    RingBufferSPSC<T, N> _ring;
+};
@@ -0,0 +1,283 @@
+/*
+    Statistical PC sampling profiler for both cores
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <hardware/irq.h>
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+#include "PCSampler.h"
+
+static constexpr int EXCEPTIONS = 16 + 32; // The M0+'s system exceptions and the RP2040's IRQs
+
+static spin_lock_t *_lock = nullptr;
+static PCSampler::Bucket *_table = nullptr; // Open addressed, linear probing, power of 2 size
+static int _bits;
+static size_t _count;
+static size_t _max;
+static uint32_t _periodUs;
+static int _alarm[2] = { -1, -1 };
+static uint32_t _next[2];
+static uint32_t _samples[2];
+static uint32_t _exceptions[2][EXCEPTIONS];
+static uint32_t _dropped;
+
+static inline size_t _hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - _bits);
+}
+
+static void __not_in_flash_func(_add)(uint32_t addr, int core) {
+    size_t mask = (1 << _bits) - 1;
+    for (size_t i = _hash(addr); ; i = (i + 1) & mask) {
+        if (_table[i].addr == addr) {
+            _table[i].count[core]++;
+            return;
+        }
+        if (!_table[i].addr) {
+            if (_count >= _max) {
+                _dropped++;
+                return;
+            }
+            _count++;
+            _table[i].addr = addr;
+            _table[i].count[core] = 1;
+            return;
+        }
+    }
+}
+
+// Called by __pcSampleIRQ with the interrupted code's exception frame (r0-r3, r12, lr, pc, xPSR)
+extern "C" __attribute__((used)) void __not_in_flash_func(__pcSample)(uint32_t *frame) {
+    int core = get_core_num();
+    int alarm = _alarm[core];
+    timer_hw->intr = 1u << alarm;
+    _next[core] += _periodUs;
+    if ((int32_t)(_next[core] - timer_hw->timerawl) <= 0) {
+        _next[core] = timer_hw->timerawl + _periodUs; // Fell behind, e.g. interrupts were off
+    }
+    timer_hw->alarm[alarm] = _next[core];
+
+    uint32_t pc = frame[6];
+    uint32_t lr = frame[5];
+    uint32_t exception = frame[7] & 0x3f;
+    spin_lock_unsafe_blocking(_lock);
+    if (_table) {
+        _samples[core]++;
+        if (exception < EXCEPTIONS) {
+            _exceptions[core][exception]++;
+        }
+        _add(pc & ~1, core);
+        // An EXC_RETURN value only says the interrupted code was itself an exception handler
+        if ((lr >> 28) != 0xf) {
+            _add(lr | 1, core);
+        }
+    }
+    spin_unlock_unsafe(_lock);
+}
+
+// EXC_RETURN bit 2 says whether the frame is on the process stack (a FreeRTOS task) or the
+// main stack.  The return goes through the pushed EXC_RETURN, keeping the stack 8 byte aligned.
+extern "C" void __attribute__((naked, section(".time_critical.__pcSampleIRQ"))) __pcSampleIRQ() {
+    asm volatile(
+        ".syntax unified\n"
+        "mov r1, lr\n"
+        "movs r2, #4\n"
+        "tst r1, r2\n"
+        "bne 1f\n"
+        "mrs r0, msp\n"
+        "b 2f\n"
+        "1:\n"
+        "mrs r0, psp\n"
+        "2:\n"
+        "push {r4, lr}\n"
+        "bl __pcSample\n"
+        "pop {r4, pc}\n"
+    );
+}
+
+// Run on each core, as the NVIC and so the IRQ enable is per core
+static uint32_t _arm(void *) {
+    int core = get_core_num();
+    int irq = TIMER_IRQ_0 + _alarm[core];
+    irq_set_exclusive_handler(irq, __pcSampleIRQ);
+    irq_set_priority(irq, PICO_HIGHEST_IRQ_PRIORITY);
+    hw_set_bits(&timer_hw->inte, 1u << _alarm[core]);
+    _next[core] = timer_hw->timerawl + _periodUs;
+    timer_hw->alarm[_alarm[core]] = _next[core];
+    irq_set_enabled(irq, true);
+    return 0;
+}
+
+static uint32_t _disarm(void *) {
+    int core = get_core_num();
+    int irq = TIMER_IRQ_0 + _alarm[core];
+    irq_set_enabled(irq, false);
+    hw_clear_bits(&timer_hw->inte, 1u << _alarm[core]);
+    timer_hw->armed = 1u << _alarm[core];
+    timer_hw->intr = 1u << _alarm[core];
+    irq_remove_handler(irq, __pcSampleIRQ);
+    return 0;
+}
+
+// The other core's part of begin()/end(), waiting for it so it's done before we go on
+static bool _onOtherCore(CoreJobFn fn) {
+    CoreJob job;
+    if (!rp2040.runOnCore(get_core_num() ^ 1, &job, fn, nullptr)) {
+        return false;
+    }
+    job.wait();
+    return true;
+}
+
+bool PCSampler::begin(uint32_t hz, size_t maxBuckets) {
+    if (_table || !hz || (hz > 100000) || !maxBuckets || (maxBuckets > 65536)) {
+        return false;
+    }
+    int bits = 4;
+    while (((size_t)1 << bits) < maxBuckets * 2) { // Keep the table at most half full
+        bits++;
+    }
+    Bucket *table = (Bucket *)calloc((size_t)1 << bits, sizeof(Bucket));
+    if (!table) {
+        return false;
+    }
+    int core = get_core_num();
+    _alarm[core] = hardware_alarm_claim_unused(false);
+    _alarm[core ^ 1] = hardware_alarm_claim_unused(false);
+    if (_alarm[core] < 0) {
+        if (_alarm[core ^ 1] >= 0) {
+            hardware_alarm_unclaim(_alarm[core ^ 1]);
+            _alarm[core ^ 1] = -1;
+        }
+        free(table);
+        return false;
+    }
+    if (!_lock) {
+        _lock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+    uint32_t irqs = spin_lock_blocking(_lock);
+    _table = table;
+    _bits = bits;
+    _max = maxBuckets;
+    _count = 0;
+    _dropped = 0;
+    memset(_samples, 0, sizeof(_samples));
+    memset(_exceptions, 0, sizeof(_exceptions));
+    spin_unlock(_lock, irqs);
+    _periodUs = 1000000 / hz;
+    _arm(nullptr);
+    if ((_alarm[core ^ 1] >= 0) && !_onOtherCore(_arm)) {
+        hardware_alarm_unclaim(_alarm[core ^ 1]);
+        _alarm[core ^ 1] = -1;
+    }
+    return true;
+}
+
+void PCSampler::end() {
+    if (!_table) {
+        return;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (_alarm[i] < 0) {
+            continue;
+        }
+        if (i == (int)get_core_num()) {
+            _disarm(nullptr);
+        } else if (!_onOtherCore(_disarm)) {
+            continue; // Can't reach it any more, so leave its alarm claimed
+        }
+        hardware_alarm_unclaim(_alarm[i]);
+        _alarm[i] = -1;
+    }
+    uint32_t irqs = spin_lock_blocking(_lock);
+    Bucket *table = _table;
+    _table = nullptr;
+    spin_unlock(_lock, irqs);
+    free(table);
+}
+
+void PCSampler::reset() {
+    if (!_table) {
+        return;
+    }
+    uint32_t irqs = spin_lock_blocking(_lock);
+    memset(_table, 0, sizeof(Bucket) << _bits);
+    _count = 0;
+    _dropped = 0;
+    memset(_samples, 0, sizeof(_samples));
+    memset(_exceptions, 0, sizeof(_exceptions));
+    spin_unlock(_lock, irqs);
+}
+
+uint32_t PCSampler::samples(int core) {
+    return _samples[core & 1];
+}
+
+uint32_t PCSampler::dropped() {
+    return _dropped;
+}
+
+uint32_t PCSampler::exceptionSamples(int core, int exception) {
+    if ((exception < 0) || (exception >= EXCEPTIONS)) {
+        return 0;
+    }
+    return _exceptions[core & 1][exception];
+}
+
+size_t PCSampler::buckets(Bucket *out, size_t max) {
+    if (!_table) {
+        return 0;
+    }
+    size_t n = 0;
+    uint32_t irqs = spin_lock_blocking(_lock);
+    for (size_t i = 0; i < ((size_t)1 << _bits); i++) {
+        if (_table[i].addr) {
+            if (n < max) {
+                out[n] = _table[i];
+            }
+            n++;
+        }
+    }
+    spin_unlock(_lock, irqs);
+    return n;
+}
+
+void PCSampler::dump(Print &out) {
+    if (!_table) {
+        return;
+    }
+    out.printf("pcsampler %lu %lu %lu %lu\n", 1000000 / _periodUs, _samples[0], _samples[1], _dropped);
+    for (int c = 0; c < 2; c++) {
+        for (int e = 0; e < EXCEPTIONS; e++) {
+            if (_exceptions[c][e]) {
+                out.printf("exc %d %d %lu\n", c, e, _exceptions[c][e]);
+            }
+        }
+    }
+    // A slot at a time, so the samplers aren't held off while printing
+    for (size_t i = 0; i < ((size_t)1 << _bits); i++) {
+        uint32_t irqs = spin_lock_blocking(_lock);
+        Bucket b = _table ? _table[i] : Bucket{ 0, { 0, 0 } };
+        spin_unlock(_lock, irqs);
+        if (b.addr) {
+            out.printf("%s 0x%08lx %lu %lu\n", (b.addr & 1) ? "lr" : "pc", b.addr & ~1, b.count[0], b.count[1]);
+        }
+    }
+    out.printf("end\n");
+}
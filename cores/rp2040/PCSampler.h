@@ -0,0 +1,59 @@
+/*
+    Statistical PC sampling profiler for both cores
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Print;
+
+// A timer alarm per core interrupts it hz times a second, at the highest IRQ priority, and
+// counts the PC (and LR) it interrupted in a RAM histogram.  Nothing needs instrumenting, and
+// IRQ handlers are sampled too.  Off until begin().  tools/pcsampler.py turns dump()'s output
+// into a report by function, library and memory region, using the sketch's .elf and .map.
+class PCSampler {
+public:
+    typedef struct {
+        uint32_t addr;      // Interrupted PC, or with bit 0 set the LR at that point (its caller)
+        uint32_t count[2];  // By core
+    } Bucket;
+
+    // Samples both cores (just the calling one without setup1/loop1, or under FreeRTOS) into
+    // a table of up to maxBuckets distinct addresses, taken from the heap
+    static bool begin(uint32_t hz = 1000, size_t maxBuckets = 512);
+    static void end();
+    static void reset();
+
+    static uint32_t samples(int core);
+
+    // Samples whose address didn't fit in the table
+    static uint32_t dropped();
+
+    // Samples taken while the core was running the given exception, 0 being thread mode and
+    // 16 + n the handler for IRQ n
+    static uint32_t exceptionSamples(int core, int exception);
+
+    // Copies out up to max buckets, returning how many there are
+    static size_t buckets(Bucket *out, size_t max);
+
+    // Everything, in the form tools/pcsampler.py reads
+    static void dump(Print &p);
+};
@@ -0,0 +1,150 @@
+/*
+    Hardware edge counters using PIO state machines
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "PIOCounter.h"
+#include <hardware/gpio.h>
+#include "pio_counter.pio.h"
+
+static PIOProgram _quadPgm(&quadrature_program);
+static PIOProgram _pulsePgm(&pulsecount_program);
+
+// Copies a scratch register out through the RX FIFO, which neither program uses
+static uint32_t _readScratch(PIO pio, int sm, enum pio_src_dest reg) {
+    pio_sm_exec(pio, sm, pio_encode_mov(pio_isr, reg));
+    pio_sm_exec(pio, sm, pio_encode_push(false, false));
+    return pio_sm_get_blocking(pio, sm);
+}
+
+// And back in through the TX FIFO
+static void _writeScratch(PIO pio, int sm, enum pio_src_dest reg, uint32_t val) {
+    pio_sm_put(pio, sm, val);
+    pio_sm_exec(pio, sm, pio_encode_pull(false, false));
+    pio_sm_exec(pio, sm, pio_encode_mov(reg, pio_osr));
+}
+
+QuadratureEncoder::QuadratureEncoder(pin_size_t pinA, pin_size_t pinB) {
+    _pinA = pinA;
+    _pinB = pinB;
+    _running = false;
+    _pio = nullptr;
+    _sm = -1;
+}
+
+QuadratureEncoder::~QuadratureEncoder() {
+    end();
+}
+
+bool QuadratureEncoder::begin() {
+    if (_running) {
+        return true;
+    }
+    if ((_pinA > 29) || (_pinB > 29)) {
+        DEBUGCORE("ERROR: Illegal QuadratureEncoder pins\n");
+        return false;
+    }
+    int off;
+    if (!_quadPgm.prepare(&_pio, &_sm, &off)) {
+        DEBUGCORE("ERROR: QuadratureEncoder unable to find PIO resources\n");
+        return false;
+    }
+    quadrature_program_init(_pio, _sm, off, _pinA, _pinB);
+    pio_sm_set_enabled(_pio, _sm, true);
+    _running = true;
+    return true;
+}
+
+void QuadratureEncoder::end() {
+    if (_running) {
+        pio_sm_set_enabled(_pio, _sm, false);
+        PIOProgram::unprepare(_pio, _sm);
+        _running = false;
+    }
+}
+
+int32_t QuadratureEncoder::read() {
+    if (!_running) {
+        return 0;
+    }
+    // Each scratch register only ever moves by one jmp, so reading them 2 cycles
+    // apart gives the position at one of those two instants
+    uint32_t x = _readScratch(_pio, _sm, pio_x);
+    uint32_t y = _readScratch(_pio, _sm, pio_y);
+    return (int32_t)(x - y);
+}
+
+void QuadratureEncoder::write(int32_t position) {
+    if (!_running) {
+        return;
+    }
+    _writeScratch(_pio, _sm, pio_x, (uint32_t)position);
+    pio_sm_exec(_pio, _sm, pio_encode_set(pio_y, 0));
+}
+
+PulseCounter::PulseCounter(pin_size_t pin) {
+    _pin = pin;
+    _running = false;
+    _pio = nullptr;
+    _sm = -1;
+}
+
+PulseCounter::~PulseCounter() {
+    end();
+}
+
+bool PulseCounter::begin() {
+    if (_running) {
+        return true;
+    }
+    if (_pin > 29) {
+        DEBUGCORE("ERROR: Illegal PulseCounter pin (%d)\n", _pin);
+        return false;
+    }
+    int off;
+    if (!_pulsePgm.prepare(&_pio, &_sm, &off)) {
+        DEBUGCORE("ERROR: PulseCounter unable to find PIO resources\n");
+        return false;
+    }
+    pulsecount_program_init(_pio, _sm, off, _pin);
+    pio_sm_set_enabled(_pio, _sm, true);
+    _running = true;
+    return true;
+}
+
+void PulseCounter::end() {
+    if (_running) {
+        pio_sm_set_enabled(_pio, _sm, false);
+        PIOProgram::unprepare(_pio, _sm);
+        _running = false;
+    }
+}
+
+uint32_t PulseCounter::read() {
+    if (!_running) {
+        return 0;
+    }
+    return -_readScratch(_pio, _sm, pio_x);
+}
+
+void PulseCounter::write(uint32_t count) {
+    if (!_running) {
+        return;
+    }
+    _writeScratch(_pio, _sm, pio_x, -count);
+}
@@ -0,0 +1,67 @@
+/*
+    Hardware edge counters using PIO state machines
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+
+// Both count entirely in a state machine's scratch registers, so no IRQs are taken
+// per edge.  Reading injects a few instructions and waits on the RX FIFO, so only
+// read an instance from one core at a time.
+
+// Counts both edges of A, 2 counts per full quadrature cycle, up when A leads B
+class QuadratureEncoder {
+public:
+    QuadratureEncoder(pin_size_t pinA, pin_size_t pinB);
+    ~QuadratureEncoder();
+
+    bool begin();
+    void end();
+
+    int32_t read();
+    void write(int32_t position);
+
+private:
+    pin_size_t _pinA;
+    pin_size_t _pinB;
+    bool _running;
+    PIO _pio;
+    int _sm;
+};
+
+// Counts rising edges on a pin
+class PulseCounter {
+public:
+    PulseCounter(pin_size_t pin);
+    ~PulseCounter();
+
+    bool begin();
+    void end();
+
+    uint32_t read();
+    void write(uint32_t count);
+
+private:
+    pin_size_t _pin;
+    bool _running;
+    PIO _pio;
+    int _sm;
+};
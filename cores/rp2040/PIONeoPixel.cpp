@@ -0,0 +1,217 @@
+/*
+    WS2812/SK6812 addressable LED strips driven by PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "PIONeoPixel.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/timer.h>
+#include "pio_neopixel.pio.h"
+
+static PIOProgram _neopixelPgm(&neopixel_program);
+static PIOProgram _neopixelParallelPgm(&neopixel_parallel_program);
+
+// Newer WS2812B parts need 280us low to latch, older ones 50us
+static const uint32_t _latchUs = 300;
+
+PIONeoPixel::PIONeoPixel(pin_size_t pin, size_t leds, int strips, bool rgbw, Order order) {
+    _pin = pin;
+    _leds = leds;
+    _strips = strips;
+    _rgbw = rgbw;
+    _order = order;
+    _running = false;
+    _pio = nullptr;
+    _sm = -1;
+    _offset = -1;
+    _dma = -1;
+    _pixels = nullptr;
+    _wire[0] = nullptr;
+    _wire[1] = nullptr;
+    _wireWords = 0;
+    _next = 0;
+    _frameEnd = 0;
+}
+
+PIONeoPixel::~PIONeoPixel() {
+    end();
+}
+
+bool PIONeoPixel::begin() {
+    if (_running) {
+        return false;
+    }
+    if (!_leds || (_strips < 1) || (_strips > 8) || (_pin + _strips > 30)) {
+        DEBUGCORE("ERROR: Illegal PIONeoPixel pins or size\n");
+        return false;
+    }
+    int bits = _rgbw ? 32 : 24;
+    // One word per LED for a single strip, otherwise one byte per bit for each LED index
+    _wireWords = (_strips == 1) ? _leds : _leds * bits / 4;
+    _pixels = (uint32_t *)calloc(_leds * _strips, sizeof(uint32_t));
+    _wire[0] = (uint32_t *)malloc(_wireWords * sizeof(uint32_t));
+    _wire[1] = (uint32_t *)malloc(_wireWords * sizeof(uint32_t));
+    if (!_pixels || !_wire[0] || !_wire[1]) {
+        DEBUGCORE("ERROR: PIONeoPixel unable to allocate buffers\n");
+        end();
+        return false;
+    }
+    PIOProgram *pgm = (_strips == 1) ? &_neopixelPgm : &_neopixelParallelPgm;
+    if (!pgm->prepare(&_pio, &_sm, &_offset)) {
+        DEBUGCORE("ERROR: PIONeoPixel unable to find PIO resources\n");
+        end();
+        return false;
+    }
+    _dma = dma_claim_unused_channel(false);
+    if (_dma < 0) {
+        DEBUGCORE("ERROR: PIONeoPixel unable to claim DMA channel\n");
+        end();
+        return false;
+    }
+    // 10 cycles per bit at 800Kbit/s
+    float div = clock_get_hz(clk_sys) / (800000.0f * 10);
+    if (_strips == 1) {
+        neopixel_program_init(_pio, _sm, _offset, _pin, bits, div);
+    } else {
+        neopixel_parallel_program_init(_pio, _sm, _offset, _pin, _strips, div);
+    }
+
+    dma_channel_config c = dma_channel_get_default_config(_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(_pio, _sm, true));
+    dma_channel_set_config(_dma, &c, false);
+    dma_channel_set_write_addr(_dma, &_pio->txf[_sm], false);
+
+    pio_sm_set_enabled(_pio, _sm, true);
+    _next = 0;
+    _frameEnd = 0;
+    _running = true;
+    return true;
+}
+
+void PIONeoPixel::end() {
+    if (_running) {
+        _waitFrame();
+        pio_sm_set_enabled(_pio, _sm, false);
+        _running = false;
+    }
+    if (_sm >= 0) {
+        PIOProgram::unprepare(_pio, _sm);
+        _sm = -1;
+    }
+    if (_dma >= 0) {
+        dma_channel_unclaim(_dma);
+        _dma = -1;
+    }
+    free(_pixels);
+    _pixels = nullptr;
+    free(_wire[0]);
+    _wire[0] = nullptr;
+    free(_wire[1]);
+    _wire[1] = nullptr;
+}
+
+void PIONeoPixel::setPixelColor(int strip, size_t n, uint32_t color) {
+    if (!_pixels || (strip < 0) || (strip >= _strips) || (n >= _leds)) {
+        return;
+    }
+    _pixels[strip * _leds + n] = color;
+}
+
+uint32_t PIONeoPixel::getPixelColor(int strip, size_t n) {
+    if (!_pixels || (strip < 0) || (strip >= _strips) || (n >= _leds)) {
+        return 0;
+    }
+    return _pixels[strip * _leds + n];
+}
+
+void PIONeoPixel::fill(uint32_t color) {
+    if (!_pixels) {
+        return;
+    }
+    for (size_t i = 0; i < _leds * _strips; i++) {
+        _pixels[i] = color;
+    }
+}
+
+// Left-justified in the order the bits go out on the wire
+static inline uint32_t _wireOrder(uint32_t color, bool rgbw, PIONeoPixel::Order order) {
+    uint32_t w = color >> 24;
+    uint32_t r = (color >> 16) & 0xff;
+    uint32_t g = (color >> 8) & 0xff;
+    uint32_t b = color & 0xff;
+    uint32_t v = (order == PIONeoPixel::GRB) ? (g << 24) | (r << 16) | (b << 8) : (r << 24) | (g << 16) | (b << 8);
+    return rgbw ? v | w : v;
+}
+
+void PIONeoPixel::_encode(uint32_t *dest) {
+    if (_strips == 1) {
+        for (size_t i = 0; i < _leds; i++) {
+            dest[i] = _wireOrder(_pixels[i], _rgbw, _order);
+        }
+        return;
+    }
+    // Transpose so each byte holds one bit of the same LED on every strip, MSB first
+    int bits = _rgbw ? 32 : 24;
+    uint8_t *out = (uint8_t *)dest;
+    uint32_t v[8];
+    for (size_t i = 0; i < _leds; i++) {
+        for (int s = 0; s < _strips; s++) {
+            v[s] = _wireOrder(_pixels[s * _leds + i], _rgbw, _order);
+        }
+        for (int bit = 31; bit >= 32 - bits; bit--) {
+            uint8_t plane = 0;
+            for (int s = 0; s < _strips; s++) {
+                plane |= ((v[s] >> bit) & 1) << s;
+            }
+            *out++ = plane;
+        }
+    }
+}
+
+void PIONeoPixel::_waitFrame() {
+    while (busy()) {
+        /* noop busy wait */
+    }
+}
+
+bool PIONeoPixel::busy() {
+    if (!_running) {
+        return false;
+    }
+    return dma_channel_is_busy(_dma) || (time_us_64() < _frameEnd);
+}
+
+bool PIONeoPixel::show() {
+    if (!_running) {
+        return false;
+    }
+    // The DMA can only be reading the other buffer, so encode before waiting on it
+    uint32_t *buff = _wire[_next];
+    _encode(buff);
+    _waitFrame();
+    dma_channel_transfer_from_buffer_now(_dma, buff, _wireWords);
+    // The DMA runs far ahead of the wire, so time the bits themselves (1.25us each)
+    uint64_t bitsOut = (uint64_t)_leds * (_rgbw ? 32 : 24);
+    _frameEnd = time_us_64() + (bitsOut * 5 + 3) / 4 + _latchUs;
+    _next ^= 1;
+    return true;
+}
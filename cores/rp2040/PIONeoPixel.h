@@ -0,0 +1,89 @@
+/*
+    WS2812/SK6812 addressable LED strips driven by PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+
+// Drives 1 to 8 equal length strips on consecutive pins from a single state machine.
+// Colors are drawn into a pixel buffer, and show() encodes it into whichever of two
+// wire buffers isn't going out, so drawing the next frame overlaps sending this one.
+// Interrupts are never disabled.
+class PIONeoPixel {
+public:
+    enum Order { GRB, RGB };
+
+    PIONeoPixel(pin_size_t pin, size_t leds, int strips = 1, bool rgbw = false, Order order = GRB);
+    ~PIONeoPixel();
+
+    bool begin();
+    void end();
+
+    // Colors are 0xWWRRGGBB
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) {
+        return ((uint32_t)w << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+    void setPixelColor(int strip, size_t n, uint32_t color);
+    void setPixelColor(size_t n, uint32_t color) {
+        setPixelColor(0, n, color);
+    }
+    void setPixelColor(size_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) {
+        setPixelColor(0, n, Color(r, g, b, w));
+    }
+    uint32_t getPixelColor(int strip, size_t n);
+    void fill(uint32_t color);
+    void clear() {
+        fill(0);
+    }
+
+    // Starts sending the current pixels.  Only waits for the frame before this one to be
+    // finished (and latched), returns false if not begun
+    bool show();
+    // True while a frame, or the latch time after it, is still going out
+    bool busy();
+
+    size_t numPixels() {
+        return _leds;
+    }
+    int strips() {
+        return _strips;
+    }
+
+private:
+    void _encode(uint32_t *dest);
+    void _waitFrame();
+
+    pin_size_t _pin;
+    size_t _leds;
+    int _strips;
+    bool _rgbw;
+    Order _order;
+    bool _running;
+    PIO _pio;
+    int _sm;
+    int _offset;
+    int _dma;
+    uint32_t *_pixels;   // Drawn colors, strip by strip
+    uint32_t *_wire[2];  // Encoded frames for the DMA
+    size_t _wireWords;
+    int _next;           // Wire buffer the next show() encodes into
+    uint64_t _frameEnd;  // When the last frame's bits and latch time are all out
+};
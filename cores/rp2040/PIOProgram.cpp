@@ -0,0 +1,148 @@
+/*
+    PIO program loading and state machine allocation shared by the core and libraries
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+#include "CoreMutex.h"
+
+extern mutex_t _pioMutex;
+
+// One slot per program loaded in a PIO, there can never be more than one per instruction
+typedef struct {
+    const pio_program_t *pgm;
+    uint8_t offset;
+    uint8_t refs; // SMs running it, 0 = free slot
+} PIOLoaded;
+
+static PIOLoaded _loaded[NUM_PIOS][PIO_INSTRUCTION_COUNT];
+// Slot each SM was prepared from, or -1
+static int8_t _smSlot[NUM_PIOS][NUM_PIO_STATE_MACHINES] = { { -1, -1, -1, -1 }, { -1, -1, -1, -1 } };
+
+static PIO _pioInstance(int idx) {
+    return idx ? pio1 : pio0;
+}
+
+static bool _same(const pio_program_t *a, const pio_program_t *b) {
+    return (a == b) || ((a->length == b->length) && (a->origin == b->origin) &&
+                        !memcmp(a->instructions, b->instructions, a->length * sizeof(uint16_t)));
+}
+
+static int _findLoaded(int idx, const pio_program_t *pgm) {
+    for (int i = 0; i < PIO_INSTRUCTION_COUNT; i++) {
+        if (_loaded[idx][i].refs && _same(_loaded[idx][i].pgm, pgm)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void _release(int idx, int sm) {
+    int slot = _smSlot[idx][sm];
+    _smSlot[idx][sm] = -1;
+    if ((slot < 0) || !_loaded[idx][slot].refs) {
+        return;
+    }
+    if (!--_loaded[idx][slot].refs) {
+        pio_remove_program(_pioInstance(idx), _loaded[idx][slot].pgm, _loaded[idx][slot].offset);
+    }
+}
+
+int PIOProgram::freeInstructions(PIO pio) {
+    static const uint16_t nop = 0xa042; // mov y, y
+    static const pio_program_t one = { &nop, 1, -1 };
+    int cnt = 0;
+    for (uint i = 0; i < PIO_INSTRUCTION_COUNT; i++) {
+        if (pio_can_add_program_at_offset(pio, &one, i)) {
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
+int PIOProgram::freeStateMachines(PIO pio) {
+    int cnt = 0;
+    for (uint i = 0; i < NUM_PIO_STATE_MACHINES; i++) {
+        if (!pio_sm_is_claimed(pio, i)) {
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
+bool PIOProgram::prepare(PIO *pio, int *sm, int *offset) {
+    CoreMutex m(&_pioMutex);
+    // Reuse a copy that's already loaded where there's a SM to run it.  Otherwise load into the
+    // PIO with the least room that still fits it, keeping big holes for big programs.
+    int best = -1;
+    int bestFree = PIO_INSTRUCTION_COUNT + 1;
+    for (int i = 0; i < NUM_PIOS; i++) {
+        PIO p = _pioInstance(i);
+        if (!freeStateMachines(p)) {
+            continue;
+        }
+        if (_findLoaded(i, _pgm) >= 0) {
+            best = i;
+            break;
+        }
+        if (!pio_can_add_program(p, _pgm)) {
+            continue;
+        }
+        int f = freeInstructions(p);
+        if (f < bestFree) {
+            best = i;
+            bestFree = f;
+        }
+    }
+    if (best < 0) {
+        DEBUGCORE("ERROR: No room for %d instruction PIO program, free insns %d/%d, free SMs %d/%d\n", _pgm->length,
+                  freeInstructions(pio0), freeInstructions(pio1), freeStateMachines(pio0), freeStateMachines(pio1));
+        return false;
+    }
+    PIO p = _pioInstance(best);
+    int idx = pio_claim_unused_sm(p, false);
+    if (idx < 0) {
+        return false;
+    }
+    // A SM unclaimed directly with pio_sm_unclaim() still holds its old reference
+    _release(best, idx);
+    int slot = _findLoaded(best, _pgm);
+    if (slot < 0) {
+        for (slot = 0; _loaded[best][slot].refs; slot++) {
+            /* Always finds one, there are fewer programs than instructions */
+        }
+        _loaded[best][slot].pgm = _pgm;
+        _loaded[best][slot].offset = pio_add_program(p, _pgm);
+    }
+    _loaded[best][slot].refs++;
+    _smSlot[best][idx] = slot;
+    *pio = p;
+    *sm = idx;
+    *offset = _loaded[best][slot].offset;
+    return true;
+}
+
+void PIOProgram::unprepare(PIO pio, int sm) {
+    if ((sm < 0) || (sm >= (int)NUM_PIO_STATE_MACHINES)) {
+        return;
+    }
+    CoreMutex m(&_pioMutex);
+    _release(pio_get_index(pio), sm);
+    pio_sm_unclaim(pio, sm);
+}
@@ -0,0 +1,168 @@
+/*
+    Shift register output using a PIO state machine and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "PIOShifter.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include "pio_shifter.pio.h"
+
+static PIOProgram _shifterPgm(&shifter_program);
+
+// Running shifters by data pin, so shiftOut() can find them
+static PIOShifter *_shifters[30];
+
+PIOShifter *__getPIOShifter(pin_size_t data, pin_size_t clock) {
+    if (data > 29) {
+        return nullptr;
+    }
+    auto s = _shifters[data];
+    return s && (s->clockPin() == clock) ? s : nullptr;
+}
+
+PIOShifter::PIOShifter(pin_size_t data, pin_size_t clock, pin_size_t latch) {
+    _data = data;
+    _clock = clock;
+    _latch = latch;
+    _running = false;
+    _order = MSBFIRST;
+    _bits = 8;
+    _pio = nullptr;
+    _sm = -1;
+    _offset = -1;
+    _dma = -1;
+}
+
+PIOShifter::~PIOShifter() {
+    end();
+}
+
+bool PIOShifter::begin(uint32_t hz, BitOrder order, int bits) {
+    if (_running) {
+        return false;
+    }
+    if ((_data > 29) || (_clock > 29) || ((_latch != NOPIN) && (_latch > 29))) {
+        DEBUGCORE("ERROR: Illegal PIOShifter pins\n");
+        return false;
+    }
+    if ((bits != 8) && (bits != 16) && (bits != 32)) {
+        DEBUGCORE("ERROR: PIOShifter bits must be 8, 16, or 32\n");
+        return false;
+    }
+    if (!_shifterPgm.prepare(&_pio, &_sm, &_offset)) {
+        DEBUGCORE("ERROR: PIOShifter unable to find PIO resources\n");
+        return false;
+    }
+    _dma = dma_claim_unused_channel(false);
+    if (_dma < 0) {
+        DEBUGCORE("ERROR: PIOShifter unable to claim DMA channel\n");
+        PIOProgram::unprepare(_pio, _sm);
+        return false;
+    }
+    _order = order;
+    _bits = bits;
+    // 2 PIO cycles per bit
+    float div = clock_get_hz(clk_sys) / (2.0f * hz);
+    shifter_program_init(_pio, _sm, _offset, _data, _clock, _latch, _latch != NOPIN, order == LSBFIRST, bits, div < 1.0f ? 1.0f : div);
+
+    // Narrow writes to the FIFO are replicated across all 32 bits, so 8 and 16 bit words
+    // land at the right end whichever way the OSR shifts
+    dma_channel_config c = dma_channel_get_default_config(_dma);
+    channel_config_set_transfer_data_size(&c, bits == 8 ? DMA_SIZE_8 : bits == 16 ? DMA_SIZE_16 : DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(_pio, _sm, true));
+    dma_channel_set_config(_dma, &c, false);
+    dma_channel_set_write_addr(_dma, &_pio->txf[_sm], false);
+
+    pio_sm_set_enabled(_pio, _sm, true);
+    _shifters[_data] = this;
+    _running = true;
+    return true;
+}
+
+void PIOShifter::end() {
+    if (!_running) {
+        return;
+    }
+    flush();
+    _shifters[_data] = nullptr;
+    pio_sm_set_enabled(_pio, _sm, false);
+    PIOProgram::unprepare(_pio, _sm);
+    dma_channel_unclaim(_dma);
+    _dma = -1;
+    _running = false;
+}
+
+bool PIOShifter::writeAsync(const void *buff, size_t words, bool latch) {
+    if (!_running || !buff || !words) {
+        return false;
+    }
+    while (dma_channel_is_busy(_dma)) {
+        /* noop busy wait */
+    }
+    // Frame header, then the data
+    pio_sm_put_blocking(_pio, _sm, words * _bits - 1);
+    pio_sm_put_blocking(_pio, _sm, latch ? 1 : 0);
+    dma_channel_transfer_from_buffer_now(_dma, buff, words);
+    return true;
+}
+
+bool PIOShifter::write(const void *buff, size_t words, bool latch) {
+    if (!writeAsync(buff, words, latch)) {
+        return false;
+    }
+    flush();
+    return true;
+}
+
+bool PIOShifter::write(uint32_t val, bool latch) {
+    if (!_running) {
+        return false;
+    }
+    while (dma_channel_is_busy(_dma)) {
+        /* noop busy wait */
+    }
+    // Left-justify for MSB first, the CPU's 32-bit write isn't replicated like DMA's
+    if ((_order == MSBFIRST) && (_bits < 32)) {
+        val <<= 32 - _bits;
+    }
+    pio_sm_put_blocking(_pio, _sm, _bits - 1);
+    pio_sm_put_blocking(_pio, _sm, latch ? 1 : 0);
+    pio_sm_put_blocking(_pio, _sm, val);
+    flush();
+    return true;
+}
+
+bool PIOShifter::finished() {
+    return !_running || !dma_channel_is_busy(_dma);
+}
+
+void PIOShifter::flush() {
+    if (!_running) {
+        return;
+    }
+    while (dma_channel_is_busy(_dma)) {
+        /* noop busy wait */
+    }
+    // Done once the SM is back waiting on the next frame header with nothing queued
+    while (!pio_sm_is_tx_fifo_empty(_pio, _sm) || (pio_sm_get_pc(_pio, _sm) != (uint)_offset)) {
+        /* noop busy wait */
+    }
+}
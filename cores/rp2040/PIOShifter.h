@@ -0,0 +1,75 @@
+/*
+    Shift register output using a PIO state machine and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+
+// Clocks words of 8, 16, or 32 bits out a data/clock pair, optionally pulsing a latch
+// pin after each buffer.  While begun, shiftOut() calls on the same data and clock pins
+// go through the state machine too.
+class PIOShifter {
+public:
+    static const pin_size_t NOPIN = 0xff;
+    PIOShifter(pin_size_t data, pin_size_t clock, pin_size_t latch = NOPIN);
+    ~PIOShifter();
+
+    bool begin(uint32_t hz = 10000000, BitOrder order = MSBFIRST, int bits = 8);
+    void end();
+
+    // Shifts out words of the begin() width and waits until the last bit is out
+    bool write(uint32_t val, bool latch = true);
+    bool write(const void *buff, size_t words, bool latch = true);
+    // Same, but returns as soon as the DMA is started.  The buffer must not change
+    // until finished() is true, and a new call waits for the previous one's DMA
+    bool writeAsync(const void *buff, size_t words, bool latch = true);
+    bool finished();
+    // Waits for the DMA and for the last bit (and latch) to leave the pins
+    void flush();
+
+    pin_size_t dataPin() {
+        return _data;
+    }
+    pin_size_t clockPin() {
+        return _clock;
+    }
+    BitOrder order() {
+        return _order;
+    }
+    int bits() {
+        return _bits;
+    }
+
+private:
+    pin_size_t _data;
+    pin_size_t _clock;
+    pin_size_t _latch;
+    bool _running;
+    BitOrder _order;
+    int _bits;
+    PIO _pio;
+    int _sm;
+    int _offset;
+    int _dma;
+};
+
+// Used by shiftOut() to find a running PIOShifter for a pin pair
+PIOShifter *__getPIOShifter(pin_size_t data, pin_size_t clock);
@@ -76,6 +76,18 @@ struct TimeSourceCycles {
     static constexpr timeType ticksPerSecondMax = F_CPU;
 };
 
+struct TimeSourceTimer {
+    // time policy in micro-seconds read straight from the 64-bit hardware timer
+    // cheaper than millis(), unaffected by CPU clock changes, and never wraps
+
+    using timeType = uint64_t;
+    static timeType time() {
+        return time_us_64();
+    }
+    static constexpr timeType ticksPerSecond    = 1000000;
+    static constexpr timeType ticksPerSecondMax = 1000000;
+};
+
 template <typename TimeSourceType, unsigned long long second_th>
 // "second_th" units of timeType for one second
 struct TimeUnit {
@@ -133,6 +145,8 @@ using TimeMillis     = TimeUnit< TimeSourceMillis,       1000 >;
 using TimeFastMillis = TimeUnit< TimeSourceCycles,       1000 >;
 using TimeFastMicros = TimeUnit< TimeSourceCycles,    1000000 >;
 using TimeFastNanos  = TimeUnit< TimeSourceCycles, 1000000000 >;
+using TimeTimerMillis = TimeUnit< TimeSourceTimer,       1000 >;
+using TimeTimerMicros = TimeUnit< TimeSourceTimer,    1000000 >;
 
 } //TimePolicy
 
@@ -210,6 +224,18 @@ public:
         return TimePolicyT::toUserUnit(_timeout);
     }
 
+    // Time left before expired() turns true, 0 if it already is, timeMax() if it never will
+    timeType remaining() const {
+        if (!canWait()) {
+            return 0;
+        }
+        if (_neverExpires) {
+            return timeMax();
+        }
+        timeType elapsed = TimePolicyT::time() - _start;
+        return (elapsed >= _timeout) ? 0 : TimePolicyT::toUserUnit(_timeout - elapsed);
+    }
+
     static constexpr timeType timeMax() {
         return TimePolicyT::timeMax;
     }
@@ -278,6 +304,14 @@ using periodicFastUs = polledTimeout::timeoutTemplate<true, YieldPolicy::DoNothi
 using oneShotFastNs = polledTimeout::timeoutTemplate<false, YieldPolicy::DoNothing, TimePolicy::TimeFastNanos>;
 using periodicFastNs = polledTimeout::timeoutTemplate<true, YieldPolicy::DoNothing, TimePolicy::TimeFastNanos>;
 
+// Time policy based on the 64-bit microsecond hardware timer (time_us_64()):
+// nearly as cheap as the cycle counter, exact whatever the CPU clock, and with no practical
+// limit on timeMax(), so it suits timeouts polled in tight loops which may be long
+using oneShotTimerMs = polledTimeout::timeoutTemplate<false, YieldPolicy::DoNothing, TimePolicy::TimeTimerMillis>;
+using periodicTimerMs = polledTimeout::timeoutTemplate<true, YieldPolicy::DoNothing, TimePolicy::TimeTimerMillis>;
+using oneShotTimerUs = polledTimeout::timeoutTemplate<false, YieldPolicy::DoNothing, TimePolicy::TimeTimerMicros>;
+using periodicTimerUs = polledTimeout::timeoutTemplate<true, YieldPolicy::DoNothing, TimePolicy::TimeTimerMicros>;
+
 } //polledTimeout
 
 
@@ -0,0 +1,93 @@
+/*
+    Lightweight cycle-count profiler with named probes
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include "Profiler.h"
+
+extern "C" {
+    // Head of the registered probe list, exported for debuggers
+    ProfileProbe * volatile __profileProbes = nullptr;
+}
+
+static spin_lock_t *_profileLock = spin_lock_instance(next_striped_spin_lock_num());
+
+void ProfileProbe::_register() {
+    uint32_t irqs = spin_lock_blocking(_profileLock);
+    if (!_registered) {
+        _next = __profileProbes;
+        __profileProbes = this;
+        _registered = true;
+    }
+    spin_unlock(_profileLock, irqs);
+}
+
+void __not_in_flash_func(ProfileProbe::record)(uint32_t cycles) {
+    if (!_registered) {
+        _register();
+    }
+    // Only this core writes its own stats, but an IRQ here may hit the same probe
+    Stats *s = &_stats[get_core_num()];
+    uint32_t irqs = save_and_disable_interrupts();
+    s->count++;
+    s->total += cycles;
+    if (cycles < s->min) {
+        s->min = cycles;
+    }
+    if (cycles > s->max) {
+        s->max = cycles;
+    }
+    restore_interrupts(irqs);
+}
+
+void ProfileProbe::reset() {
+    // A sample recorded concurrently from the other core may be lost, which is fine
+    uint32_t irqs = save_and_disable_interrupts();
+    for (int i = 0; i < 2; i++) {
+        _stats[i].count = 0;
+        _stats[i].min = UINT32_MAX;
+        _stats[i].max = 0;
+        _stats[i].total = 0;
+    }
+    restore_interrupts(irqs);
+}
+
+ProfileProbe *ProfileProbe::first() {
+    return __profileProbes;
+}
+
+void ProfileProbe::resetAll() {
+    for (ProfileProbe *p = first(); p; p = p->next()) {
+        p->reset();
+    }
+}
+
+void ProfileProbe::dump(Print &out) {
+    out.printf("%-24s %4s %10s %10s %10s %10s\n", "Probe", "Core", "Count", "Min", "Avg", "Max");
+    for (ProfileProbe *p = first(); p; p = p->next()) {
+        for (int i = 0; i < 2; i++) {
+            Stats s = p->stats(i);
+            if (!s.count) {
+                continue;
+            }
+            out.printf("%-24s %4d %10lu %10lu %10lu %10lu\n", p->name(), i, s.count, s.min,
+                       (uint32_t)(s.total / s.count), s.max);
+        }
+    }
+}
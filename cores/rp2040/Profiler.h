@@ -0,0 +1,102 @@
+/*
+    Lightweight cycle-count profiler with named probes
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+class Print;
+
+// A named measurement point with per-core count/min/max/total cycle statistics.
+// Probes are constant-initialized, so a function-local static probe has no guard
+// and costs nothing until its first sample, when it links itself into a global
+// list (headed by __profileProbes, so a debugger can walk it too).
+class ProfileProbe {
+public:
+    typedef struct {
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+        uint64_t total;
+    } Stats;
+
+    constexpr ProfileProbe(const char *name) : _name(name) { }
+
+    // Add one sample on the calling core
+    void record(uint32_t cycles);
+
+    const char *name() const {
+        return _name;
+    }
+
+    const Stats &stats(int core) const {
+        return _stats[core & 1];
+    }
+
+    ProfileProbe *next() const {
+        return _next;
+    }
+
+    void reset();
+
+    // Every probe which has recorded at least one sample
+    static ProfileProbe *first();
+    static void resetAll();
+    static void dump(Print &p);
+
+private:
+    void _register();
+
+    const char *_name;
+    ProfileProbe *_next = nullptr;
+    volatile bool _registered = false;
+    Stats _stats[2] = { { 0, UINT32_MAX, 0, 0 }, { 0, UINT32_MAX, 0, 0 } };
+};
+
+// Records the cycles between construction and destruction into a probe
+class ProfileScope {
+public:
+    ProfileScope(ProfileProbe &probe) : _probe(probe) {
+        _start = rp2040.getCycleCount();
+    }
+
+    ~ProfileScope() {
+        _probe.record(rp2040.getCycleCount() - _start);
+    }
+
+private:
+    ProfileProbe &_probe;
+    uint32_t _start;
+};
+
+#define __PROFILE_CAT2(a, b) a##b
+#define __PROFILE_CAT(a, b) __PROFILE_CAT2(a, b)
+
+// Time the rest of the enclosing block under the given name
+#define PROFILE_SCOPE(name) \
+    static ProfileProbe __PROFILE_CAT(__profileProbe, __LINE__)(name); \
+    ProfileScope __PROFILE_CAT(__profileScope, __LINE__)(__PROFILE_CAT(__profileProbe, __LINE__))
+
+// Probes built into the core and libraries, only compiled in with -DPROFILE_RP2040_CORE
+#ifdef PROFILE_RP2040_CORE
+#define PROFILE_CORE_SCOPE(name) PROFILE_SCOPE(name)
+#else
+#define PROFILE_CORE_SCOPE(name) do { } while (0)
+#endif
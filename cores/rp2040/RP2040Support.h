@@ -26,13 +26,21 @@
 #include <hardware/watchdog.h>
 #include <hardware/structs/rosc.h>
 #include <hardware/structs/systick.h>
+#include <hardware/sync.h>
 #include <pico/multicore.h>
 #include <pico/util/queue.h>
 #include "CoreMutex.h"
+#include "CoreLoad.h"
+#include "ClockNotifier.h"
 #include "ccount.pio.h"
 #include <malloc.h>
 
 extern "C" volatile bool __otherCoreIdled;
+extern "C" void __crashDumpStop();
+
+extern void __lightSleep(uint32_t ms);
+extern bool __sleep(uint32_t ms);
+extern bool __dormantUntilPin(pin_size_t pin, PinStatus mode);
 
 // Halt the FreeRTOS PendSV task switching magic
 extern "C" int __holdUpPendSV;
@@ -46,6 +54,57 @@ extern "C" {
     extern void vTaskPreemptionEnable(TaskHandle_t p) __attribute__((weak));
 }
 
+// A function call to be run on a specific core, with future-style completion.
+// The caller owns the storage, which must remain valid until done() is true.
+typedef uint32_t (*CoreJobFn)(void *arg);
+class CoreJob {
+public:
+    CoreJob() { /* noop */ }
+
+    bool done() const {
+        return _done;
+    }
+
+    uint32_t result() const {
+        return _result;
+    }
+
+    // Sleep until the job completes and return fn's return value
+    uint32_t wait() {
+        while (!_done) {
+            __wfe();
+        }
+        return _result;
+    }
+
+private:
+    friend class _MFIFO;
+    friend class RP2040;
+
+    void _prepare(CoreJobFn fn, void *arg) {
+        _fn = fn;
+        _arg = arg;
+        _result = 0;
+        _done = false;
+    }
+
+    void _run() {
+        _result = _fn(_arg);
+        __dmb(); // Result must be visible before done is
+        _done = true;
+        __sev(); // Wake anyone in wait()
+    }
+
+    CoreJobFn _fn = nullptr;
+    void *_arg = nullptr;
+    volatile uint32_t _result = 0;
+    volatile bool _done = true;
+};
+
+// The SIO hardware FIFO and its IRQ are owned here and carry only control words for the
+// other core: _GOTOSLEEP (idleOtherCore), _CRASHSTOP, or a CoreJob pointer (runOnCore).
+// Nothing else may write to it.  Data between the user's cores goes through the software
+// queues below (rp2040.fifo) or a MulticoreQueue instead.
 class _MFIFO {
 public:
     _MFIFO() { /* noop */ };
@@ -96,10 +155,41 @@ public:
         return queue_get_level(&_queue[get_core_num()]);
     }
 
+    // Send a job to the other core's FIFO IRQ handler.  Job pointers are SRAM addresses
+    // so they can never collide with the _GOTOSLEEP or _CRASHSTOP magic words.  A running
+    // job holds off that core's idle request, so a flash write waits for it to finish.
+    bool pushJob(CoreJob *job) {
+        if (!_multicore || __isFreeRTOS) {
+            return false;
+        }
+        multicore_fifo_push_blocking((uint32_t)job);
+        return true;
+    }
+
+    // Called from a core which promises to only execute from RAM (code, IRQ handlers, and
+    // data) until it calls setRAMOnly(false).  Flash operations started by the other core
+    // will then leave it running instead of parking it in the FIFO IRQ.  Any XIP access
+    // while a flash erase or program is underway will read garbage or fault.
+    void setRAMOnly(bool ramOnly) {
+        if (!_multicore) {
+            return;
+        }
+        // Never change state in the middle of the other core's flash operation
+        mutex_enter_blocking(&_idleMutex);
+        _ramOnly[get_core_num()] = ramOnly;
+        mutex_exit(&_idleMutex);
+    }
+
     void idleOtherCore() {
         if (!_multicore) {
             return;
         }
+        if (_ramOnly[get_core_num() ^ 1]) {
+            // Other core has nothing in flash, only need to exclude other flash writers
+            mutex_enter_blocking(&_idleMutex);
+            _idleSkipped = true;
+            return;
+        }
         __holdUpPendSV = 1;
         if (__isFreeRTOS) {
             vTaskPreemptionDisable(nullptr);
@@ -111,10 +201,35 @@ public:
         while (!__otherCoreIdled) { /* noop */ }
     }
 
+    // idleOtherCore() for IRQ handlers: returns false instead of waiting if the other core
+    // is already in a flash operation.  Not for use under FreeRTOS.
+    bool tryIdleOtherCore() {
+        if (!_multicore) {
+            return true;
+        }
+        if (!mutex_try_enter(&_idleMutex, nullptr)) {
+            return false;
+        }
+        if (_ramOnly[get_core_num() ^ 1]) {
+            _idleSkipped = true;
+            return true;
+        }
+        __holdUpPendSV = 1;
+        __otherCoreIdled = false;
+        multicore_fifo_push_blocking(_GOTOSLEEP);
+        while (!__otherCoreIdled) { /* noop */ }
+        return true;
+    }
+
     void resumeOtherCore() {
         if (!_multicore) {
             return;
         }
+        if (_idleSkipped) {
+            _idleSkipped = false;
+            mutex_exit(&_idleMutex);
+            return;
+        }
         mutex_exit(&_idleMutex);
         __otherCoreIdled = false;
         if (__isFreeRTOS) {
@@ -127,6 +242,15 @@ public:
         // once __otherCoreIdled == false.
     }
 
+    // From a fault handler, asks the other core's FIFO IRQ to park itself where the crash
+    // handler can record its stack.  Never waits, so the caller has to see if it happened.
+    void crashStopOtherCore() {
+        if (_multicore && !__isFreeRTOS && multicore_fifo_wready()) {
+            sio_hw->fifo_wr = _CRASHSTOP;
+            __sev();
+        }
+    }
+
     void clear() {
         uint32_t val;
 
@@ -142,23 +266,33 @@ public:
 private:
     static void __no_inline_not_in_flash_func(_irq)() {
         if (!__isFreeRTOS) {
+            CoreLoadScope load(CORELOAD_IRQ);
             multicore_fifo_clear_irq();
-            noInterrupts(); // We need total control, can't run anything
             while (multicore_fifo_rvalid()) {
-                if (_GOTOSLEEP == multicore_fifo_pop_blocking()) {
+                uint32_t val = multicore_fifo_pop_blocking();
+                if (_GOTOSLEEP == val) {
+                    noInterrupts(); // We need total control, can't run anything
                     __otherCoreIdled = true;
                     while (__otherCoreIdled) { /* noop */ }
+                    interrupts();
                     break;
+                } else if (_CRASHSTOP == val) {
+                    __crashDumpStop(); // Never returns
+                } else if (val) {
+                    // Jobs run with interrupts still enabled
+                    ((CoreJob *)val)->_run();
                 }
             }
-            interrupts();
         }
     }
 
     bool _multicore = false;
     mutex_t _idleMutex;
+    volatile bool _ramOnly[2] = { false, false };
+    bool _idleSkipped = false;
     queue_t _queue[2];
     static constexpr uint32_t _GOTOSLEEP = 0xC0DED02E;
+    static constexpr uint32_t _CRASHSTOP = 0xC0DEDEAD;
 };
 
 
@@ -169,9 +303,22 @@ class PIOProgram;
 
 extern "C" char __StackLimit;
 extern "C" char __bss_end__;
-
-// Wrapper class for PIO programs, abstracting common operations out
-// TODO - Add unload/destructor
+extern "C" bool __mallocArenaBegin(size_t perCore);
+extern "C" size_t __mallocArenaFree();
+extern "C" size_t __mallocLargestFree();
+extern "C" uint8_t __mallocFragmentation();
+extern "C" size_t __stackSize(int core);
+extern "C" size_t __stackHighWater(int core);
+extern "C" void *__sramBankAlloc(int bank, size_t size);
+extern "C" uint32_t __entropyRand32();
+extern "C" uint32_t __entropyFill(void *buf, size_t len);
+extern "C" uint32_t __dmaCRC32(const void *data, size_t len, uint32_t crc);
+extern "C" uint16_t __dmaCRC16(const void *data, size_t len, uint16_t crc);
+
+// Wrapper class for PIO programs, abstracting common operations out.  Loaded programs are
+// tracked for the whole core, so identical programs from different objects or libraries
+// share instruction memory and are unloaded once no state machine is running them.  The
+// pio_program_t must stay valid as long as any SM prepared from it is.
 class PIOProgram {
 public:
     PIOProgram(const pio_program_t *pgm) {
@@ -179,48 +326,16 @@ public:
     }
 
     // Possibly load into a PIO and allocate a SM
-    bool prepare(PIO *pio, int *sm, int *offset) {
-        extern mutex_t _pioMutex;
-        CoreMutex m(&_pioMutex);
-        // Is there an open slot to run in, first?
-        if (!_findFreeSM(pio, sm)) {
-            return false;
-        }
-        // Is it loaded on that PIO?
-        if (_offset[pio_get_index(*pio)] < 0) {
-            // Nope, need to load it
-            if (!pio_can_add_program(*pio, _pgm)) {
-                return false;
-            }
-            _offset[pio_get_index(*pio)] = pio_add_program(*pio, _pgm);
-        }
-        // Here it's guaranteed loaded, return values
-        // PIO and SM already set
-        *offset = _offset[pio_get_index(*pio)];
-        return true;
-    }
+    bool prepare(PIO *pio, int *sm, int *offset);
 
-private:
-    // Find an unused PIO state machine to grab, returns false when none available
-    static bool _findFreeSM(PIO *pio, int *sm) {
-        int idx = pio_claim_unused_sm(pio0, false);
-        if (idx >= 0) {
-            *pio = pio0;
-            *sm = idx;
-            return true;
-        }
-        idx = pio_claim_unused_sm(pio1, false);
-        if (idx >= 0) {
-            *pio = pio1;
-            *sm = idx;
-            return true;
-        }
-        return false;
-    }
+    // Unclaim a SM from prepare(), unloading its program if nothing else uses it
+    static void unprepare(PIO pio, int sm);
 
+    // Resources left for more programs, per PIO
+    static int freeInstructions(PIO pio);
+    static int freeStateMachines(PIO pio);
 
 private:
-    int _offset[2] = { -1, -1 };
     const pio_program_t *_pgm;
 };
 
@@ -230,12 +345,10 @@ public:
     ~RP2040() { /* noop */ }
 
     void begin() {
-        _epoch = 0;
         if (!__isFreeRTOS) {
             // Enable SYSTICK exception
             exception_set_exclusive_handler(SYSTICK_EXCEPTION, _SystickHandler);
-            systick_hw->csr = 0x7;
-            systick_hw->rvr = 0x00FFFFFF;
+            beginCore();
         } else {
             int off = 0;
             _ccountPgm = new PIOProgram(&ccount_program);
@@ -256,16 +369,32 @@ public:
         return clock_get_hz(clk_sys);
     }
 
+    // Change the system clock at runtime.  Running UARTs, SPI, I2C, PWM, tones, servos,
+    // SerialPIO and I2S ports are reprogrammed for the new clock.  False if hz is not reachable.
+    static bool setCPUFrequency(uint32_t hz) {
+        return __setSysClock(hz);
+    }
+
+    // Each core has its own SYSTICK, so the core 1 startup needs to start it too
+    void beginCore() {
+        if (!__isFreeRTOS) {
+            _epoch[get_core_num()] = 0;
+            systick_hw->csr = 0x7;
+            systick_hw->rvr = 0x00FFFFFF;
+        }
+    }
+
     // Get CPU cycle count.  Needs to do magic to extens 24b HW to something longer
-    volatile uint64_t _epoch = 0;
+    volatile uint64_t _epoch[2] = { 0, 0 };
     inline uint32_t getCycleCount() {
         if (!__isFreeRTOS) {
+            volatile uint64_t *e = &_epoch[get_core_num()];
             uint32_t epoch;
             uint32_t ctr;
             do {
-                epoch = (uint32_t)_epoch;
+                epoch = (uint32_t)*e;
                 ctr = systick_hw->cvr;
-            } while (epoch != (uint32_t)_epoch);
+            } while (epoch != (uint32_t)*e);
             return epoch + (1 << 24) - ctr; /* CTR counts down from 1<<24-1 */
         } else {
             return ccount_read(_pio, _sm);
@@ -274,12 +403,13 @@ public:
 
     inline uint64_t getCycleCount64() {
         if (!__isFreeRTOS) {
+            volatile uint64_t *e = &_epoch[get_core_num()];
             uint64_t epoch;
             uint64_t ctr;
             do {
-                epoch = _epoch;
+                epoch = *e;
                 ctr = systick_hw->cvr;
-            } while (epoch != _epoch);
+            } while (epoch != *e);
             return epoch + (1LL << 24) - ctr;
         } else {
             return ccount_read(_pio, _sm);
@@ -292,27 +422,146 @@ public:
 
     inline int getUsedHeap() {
         struct mallinfo m = mallinfo();
-        return m.uordblks;
+        // Unallocated space in the per-core arenas is still free to the app
+        return m.uordblks - __mallocArenaFree();
     }
 
     inline int getTotalHeap() {
         return &__StackLimit  - &__bss_end__;
     }
 
+    // The largest single block malloc() could return now, which may be far less than
+    // getFreeHeap() once the heap is fragmented.  Walks the heap, so not for tight loops
+    size_t getMaxFreeBlockSize() {
+        return __mallocLargestFree();
+    }
+
+    // 0 when all free heap is one block, approaching 100 as it is split into small pieces
+    uint8_t getHeapFragmentation() {
+        return __mallocFragmentation();
+    }
+
+    // The most stack the given core has used since boot, in bytes, out of getStackSize(core).
+    // Covers the bare-metal stacks only; FreeRTOS tasks have uxTaskGetStackHighWaterMark()
+    // and the BearSSL stack has stack_thunk_get_max_usage().
+    size_t getStackHighWater(int core) {
+        return __stackHighWater(core);
+    }
+
+    // Bytes available to the core's stack before it runs into other data
+    size_t getStackSize(int core) {
+        return __stackSize(core);
+    }
+
+    // Zeroed, word aligned memory in SRAM4 or SRAM5, which DMA and the other core can use
+    // without contending with the striped main RAM.  Comes from below the stack of core 1
+    // (bank 4) or core 0 (bank 5) and is never freed, so call from setup().  nullptr if the
+    // bank doesn't have room.
+    void *allocInBank(int bank, size_t size) {
+        return __sramBankAlloc(bank, size);
+    }
+
+    // Carve out a small-block arena of perCore bytes for each running core, so that
+    // allocations of up to 128 bytes don't contend on the global malloc lock.  Call once,
+    // early in setup().
+    bool enableMallocArenas(size_t perCore = 8192) {
+        return __mallocArenaBegin(perCore);
+    }
+
+    // CPU load accounting for setup()/loop() sketches, off by default.  Enabling also resets.
+    void enableCoreLoad(bool enable = true) {
+        __coreLoadEnable(enable);
+    }
+
+    void resetCoreLoad() {
+        __coreLoadReset();
+    }
+
+    void getCoreLoadStats(int core, CoreLoadStats *s) {
+        __coreLoadGet(core, s);
+    }
+
+    // Percentage of time since the last reset that the core was not idle in delay()
+    float getCoreLoad(int core) {
+        CoreLoadStats s;
+        __coreLoadGet(core, &s);
+        return s.total ? 100.0f * (float)(s.total - s.idle) / (float)s.total : 0.0f;
+    }
+
     void idleOtherCore() {
         fifo.idleOtherCore();
     }
 
+    bool tryIdleOtherCore() {
+        return fifo.tryIdleOtherCore();
+    }
+
     void resumeOtherCore() {
         fifo.resumeOtherCore();
     }
 
+    // Let flash writes from the other core proceed without stopping this one.  Only
+    // safe while this core runs exclusively from RAM (__not_in_flash_func code).
+    void setRAMOnly(bool ramOnly) {
+        fifo.setRAMOnly(ramOnly);
+    }
+
+    // Run fn(arg) on the given core.  When it's the calling core the job runs immediately,
+    // otherwise it is run from the other core's FIFO IRQ.  Returns false if that core is not
+    // running the Arduino multicore FIFO (i.e. no setup1/loop1, or FreeRTOS is in use).
+    bool runOnCore(int core, CoreJob *job, CoreJobFn fn, void *arg) {
+        job->_prepare(fn, arg);
+        if (core == (int)get_core_num()) {
+            job->_run();
+            return true;
+        }
+        return fifo.pushJob(job);
+    }
+
+    // Run fn(i, arg) for every i in [0, count), with both cores pulling indexes from a shared
+    // counter until all are taken.  Returns once every call has completed.
+    void parallelFor(uint32_t count, void (*fn)(uint32_t idx, void *arg), void *arg) {
+        _ParallelFor pf;
+        pf.fn = fn;
+        pf.arg = arg;
+        pf.next = 0;
+        pf.count = count;
+        if (!_parallelLock) {
+            _parallelLock = spin_lock_instance(spin_lock_claim_unused(true));
+        }
+        pf.lock = _parallelLock;
+        CoreJob other;
+        bool helper = runOnCore(get_core_num() ^ 1, &other, _parallelWorker, &pf);
+        _parallelWorker(&pf);
+        if (helper) {
+            other.wait();
+        }
+    }
+
     void restartCore1() {
         multicore_reset_core1();
         fifo.clear();
         multicore_launch_core1(main1);
     }
 
+    // Waits in WFI with the clocks of everything except the timer, GPIO, UARTs and USB
+    // gated.  The gating only takes effect while the other core is also in WFI.
+    void lightSleep(uint32_t ms) {
+        __lightSleep(ms);
+    }
+
+    // Stops both PLLs and runs from the crystal until ms have passed.  USB disconnects and
+    // reconnects, and running drivers are reprogrammed afterwards.  millis() keeps counting.
+    bool sleep(uint32_t ms) {
+        return __sleep(ms);
+    }
+
+    // Stops every oscillator until pin sees mode (LOW, HIGH, RISING, FALLING or CHANGE).
+    // The timer stops too, so millis() doesn't count the time spent dormant.
+    bool dormantUntilPin(pin_size_t pin, PinStatus mode) {
+        return __dormantUntilPin(pin, mode);
+    }
+
     void reboot() {
         watchdog_reboot(0, 0, 10);
         while (1) {
@@ -335,33 +584,60 @@ public:
     // Multicore comms FIFO
     _MFIFO fifo;
 
+    // CRC-32 as zlib's crc32(), continue a running CRC by passing the last result as crc
+    uint32_t crc32(const void *data, size_t len, uint32_t crc = 0) {
+        return __dmaCRC32(data, len, crc);
+    }
+
+    // CRC-16/CCITT, MSB first, with no final XOR (CRC-16/XMODEM for the default crc of 0)
+    uint16_t crc16(const void *data, size_t len, uint16_t crc = 0) {
+        return __dmaCRC16(data, len, crc);
+    }
+
 
-    // TODO - Not so great HW random generator.  32-bits wide.  Cryptographers somewhere are crying
+    // Fast, non-blocking random numbers from a generator kept reseeded in the background by
+    // ROSC random bits and timer jitter (Entropy.cpp).  Not a vetted cryptographic RNG.
     uint32_t hwrand32() {
-        // Try and whiten the HW ROSC bit
-        uint32_t r = 0;
-        for (int k = 0; k < 32; k++) {
-            unsigned long int b;
-            do {
-                b = rosc_hw->randombit & 1;
-                if (b != (rosc_hw->randombit & 1)) {
-                    break;
-                }
-            } while (true);
-            r <<= 1;
-            r |= b;
-        }
-        // Stir using the cycle count LSBs.  In any WiFi use case this will be a random # since the connection time is not cycle-accurate
-        uint64_t rr = (((uint64_t)~r) << 32LL) | r;
-        rr >>= rp2040.getCycleCount() & 32LL;
+        return __entropyRand32();
+    }
 
-        return (uint32_t)rr;
+    // Fills buf from the entropy pool, to seed a cryptographic generator such as BearSSL's
+    // HMAC-DRBG.  Returns the number of background samples taken since the last call.
+    uint32_t getEntropy(void *buf, size_t len) {
+        return __entropyFill(buf, len);
     }
 
 private:
     static void _SystickHandler() {
-        rp2040._epoch += 1LL << 24;
+        rp2040._epoch[get_core_num()] += 1LL << 24;
     }
+
+    typedef struct {
+        void (*fn)(uint32_t idx, void *arg);
+        void *arg;
+        volatile uint32_t next;
+        uint32_t count;
+        spin_lock_t *lock;
+    } _ParallelFor;
+
+    static uint32_t _parallelWorker(void *p) {
+        _ParallelFor *pf = (_ParallelFor *)p;
+        while (true) {
+            // No LDREX/STREX on the M0+, so a HW spinlock makes the claim atomic
+            uint32_t save = spin_lock_blocking(pf->lock);
+            uint32_t idx = pf->next;
+            if (idx < pf->count) {
+                pf->next = idx + 1;
+            }
+            spin_unlock(pf->lock, save);
+            if (idx >= pf->count) {
+                return 0;
+            }
+            pf->fn(idx, pf->arg);
+        }
+    }
+
+    spin_lock_t *_parallelLock = nullptr;
     PIO _pio;
     int _sm;
     PIOProgram *_ccountPgm;
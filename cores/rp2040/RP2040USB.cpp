@@ -26,6 +26,7 @@
 #include "RP2040USB.h"
 
 #include "tusb.h"
+#include "device/usbd_pvt.h"
 #include "class/hid/hid_device.h"
 #include "class/audio/audio.h"
 #include "class/midi/midi.h"
@@ -38,8 +39,11 @@
 // have multiple cores updating the TUSB state in parallel
 mutex_t __usb_mutex;
 
-// USB processing will be a periodic timer task
-#define USB_TASK_INTERVAL 1000
+// USB processing runs in a low priority user IRQ, raised by the USB controller IRQ
+// whenever TinyUSB has queued events.  The timer alarm is only a fallback.
+#ifndef USB_TASK_INTERVAL
+#define USB_TASK_INTERVAL 10000
+#endif
 static int __usb_task_irq;
 
 // USB VID/PID (note that PID can change depending on the add'l interfaces)
@@ -51,14 +55,12 @@ static int __usb_task_irq;
 #define USBD_PID (0x000a) // Raspberry Pi Pico SDK CDC
 #endif
 
-#define USBD_DESC_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN)
-
-#define USBD_ITF_CDC (0) // needs 2 interfaces
-#define USBD_ITF_MAX (2)
-
-#define USBD_CDC_EP_CMD (0x81)
-#define USBD_CDC_EP_OUT (0x02)
-#define USBD_CDC_EP_IN (0x82)
+// Notification, OUT and IN endpoints for each SerialUSB port, 0x83 is HID's
+static const uint8_t __cdc_ep[SERIALUSB_PORTS][3] = {
+    { 0x81, 0x02, 0x82 },
+    { 0x84, 0x05, 0x85 },
+    { 0x86, 0x07, 0x87 },
+};
 #define USBD_CDC_CMD_MAX_SIZE (8)
 #define USBD_CDC_IN_OUT_MAX_SIZE (64)
 
@@ -66,11 +68,39 @@ static int __usb_task_irq;
 #define USBD_STR_MANUF (0x01)
 #define USBD_STR_PRODUCT (0x02)
 #define USBD_STR_SERIAL (0x03)
-#define USBD_STR_CDC (0x04)
+#define USBD_STR_CDC (0x04) // One per SerialUSB port
+#define USBD_STR_BULK (0x07)
+#define USBD_STR_MSC (0x08)
 
 
 #define EPNUM_HID   0x83
 
+// HID interrupt endpoint polling interval, set from the "USB HID Polling" menu
+#ifndef USBD_HID_POLL_MS
+#define USBD_HID_POLL_MS 10
+#endif
+
+// Reports waiting for the HID endpoint
+#ifndef USBD_HID_QUEUE
+#define USBD_HID_QUEUE 16
+#endif
+
+#define EPNUM_BULK_OUT 0x08
+#define EPNUM_BULK_IN  0x88
+#define USBD_BULK_MAX_SIZE (64)
+
+#define EPNUM_MSC_OUT 0x09
+#define EPNUM_MSC_IN  0x89
+#define USBD_MSC_MAX_SIZE (64)
+
+// Vendor request the host uses to fetch the MS OS 2.0 descriptor set (any unused value works)
+#define USBD_VENDOR_REQUEST_MS (0x01)
+
+// DeviceInterfaceGUID Windows registers for the USBBulk interface, so WinUSB/libusb can open it without an INF
+#ifndef USBBULK_GUID
+#define USBBULK_GUID "{6E0C1C7A-3B52-4F3D-9C1E-2A5B8D40F7B1}"
+#endif
+
 
 const uint8_t *tud_descriptor_device_cb(void) {
     static tusb_desc_device_t usbd_desc_device = {
@@ -89,7 +119,12 @@ const uint8_t *tud_descriptor_device_cb(void) {
         .iSerialNumber = USBD_STR_SERIAL,
         .bNumConfigurations = 1
     };
-    if (__USBInstallSerial && !__USBInstallKeyboard && !__USBInstallMouse && !__USBInstallJoystick) {
+    bool multiSerial = __USBInstallSerial1 || __USBInstallSerial2;
+    if (__USBInstallBulk) {
+        // USB 2.1 so Windows asks for the BOS and binds WinUSB to the vendor interface
+        usbd_desc_device.bcdUSB = 0x0210;
+    }
+    if (__USBInstallSerial && !multiSerial && !__USBInstallBulk && !__USBInstallMassStorage && !__USBInstallKeyboard && !__USBInstallMouse && !__USBInstallJoystick) {
         // Can use as-is, this is the default USB case
         return (const uint8_t *)&usbd_desc_device;
     }
@@ -103,6 +138,23 @@ const uint8_t *tud_descriptor_device_cb(void) {
     if (__USBInstallJoystick) {
         usbd_desc_device.idProduct |= 0x0100;
     }
+    if (__USBInstallSerial1) {
+        usbd_desc_device.idProduct |= 0x0200;
+    }
+    if (__USBInstallSerial2) {
+        usbd_desc_device.idProduct |= 0x0400;
+    }
+    if (__USBInstallBulk) {
+        usbd_desc_device.idProduct |= 0x0800;
+    }
+    if (__USBInstallMassStorage) {
+        usbd_desc_device.idProduct |= 0x1000;
+    }
+    if (multiSerial) {
+        // Several CDC functions, each grouped by its IAD
+        usbd_desc_device.bDeviceClass = TUSB_CLASS_MISC;
+        return (const uint8_t *)&usbd_desc_device;
+    }
     // Set the device class to 0 to indicate multiple device classes
     usbd_desc_device.bDeviceClass = 0;
     usbd_desc_device.bDeviceSubClass = 0;
@@ -110,6 +162,81 @@ const uint8_t *tud_descriptor_device_cb(void) {
     return (const uint8_t *)&usbd_desc_device;
 }
 
+static bool __USBSerialInstalled(int port) {
+    switch (port) {
+    case 0:
+        return __USBInstallSerial;
+    case 1:
+        return __USBInstallSerial1;
+    case 2:
+        return __USBInstallSerial2;
+    default:
+        return false;
+    }
+}
+
+int __USBGetSerialInterface(int port) {
+    if (!__USBSerialInstalled(port)) {
+        return -1;
+    }
+    // Installed ports come first, two interfaces each, in port order
+    int itf = 0;
+    for (int i = 0; i < port; i++) {
+        if (__USBSerialInstalled(i)) {
+            itf += 2;
+        }
+    }
+    return itf;
+}
+
+static int __USBSerialCount() {
+    int cnt = 0;
+    for (int i = 0; i < SERIALUSB_PORTS; i++) {
+        cnt += __USBSerialInstalled(i) ? 1 : 0;
+    }
+    return cnt;
+}
+
+int __USBGetBulkInterface() {
+    if (!__USBInstallBulk) {
+        return -1;
+    }
+    // After the CDC interfaces and the HID one
+    bool hasHID = __USBInstallKeyboard || __USBInstallMouse || __USBInstallJoystick;
+    return __USBSerialCount() * 2 + (hasHID ? 1 : 0);
+}
+
+int __USBGetMassStorageInterface() {
+    if (!__USBInstallMassStorage) {
+        return -1;
+    }
+    // Last of all
+    bool hasHID = __USBInstallKeyboard || __USBInstallMouse || __USBInstallJoystick;
+    return __USBSerialCount() * 2 + (hasHID ? 1 : 0) + (__USBInstallBulk ? 1 : 0);
+}
+
+// SerialUSB.cpp's CDC class driver, used in place of TinyUSB's, and USBBulk.cpp's and
+// USBMassStorage.cpp's when they are linked in
+extern const usbd_class_driver_t __USBCDCDriver;
+extern const usbd_class_driver_t __USBBulkDriver __attribute__((weak));
+extern const usbd_class_driver_t __USBMassStorageDriver __attribute__((weak));
+
+usbd_class_driver_t const *usbd_app_driver_get_cb(uint8_t *driver_count) {
+    static usbd_class_driver_t drivers[3];
+    static uint8_t cnt = 0;
+    if (!cnt) {
+        drivers[cnt++] = __USBCDCDriver;
+        if (&__USBBulkDriver) {
+            drivers[cnt++] = __USBBulkDriver;
+        }
+        if (&__USBMassStorageDriver) {
+            drivers[cnt++] = __USBMassStorageDriver;
+        }
+    }
+    *driver_count = cnt;
+    return drivers;
+}
+
 int __USBGetKeyboardReportID() {
     return 1;
 }
@@ -205,6 +332,65 @@ void __SetupDescHIDReport() {
     }
 }
 
+// Reports are queued in order and the oldest goes out whenever the endpoint is free, either
+// straight away or from the USB task right after the previous one completes, so callers
+// never spin on tud_hid_ready().  All of it runs with __usb_mutex held
+typedef struct {
+    uint8_t id;
+    uint8_t len;
+    uint8_t data[CFG_TUD_HID_EP_BUFSIZE - 1]; // Report ID takes the first byte on the wire
+} HIDQueuedReport;
+
+static HIDQueuedReport __hid_queue[USBD_HID_QUEUE];
+static uint8_t __hid_queue_head = 0;
+static uint8_t __hid_queue_count = 0;
+
+static void __USBHIDSendQueued() {
+    while (__hid_queue_count && tud_hid_ready()) {
+        HIDQueuedReport *r = &__hid_queue[__hid_queue_head];
+        if (!tud_hid_report(r->id, r->data, r->len)) {
+            break;
+        }
+        __hid_queue_head = (__hid_queue_head + 1) % USBD_HID_QUEUE;
+        __hid_queue_count--;
+    }
+}
+
+bool __USBHIDQueueReport(uint8_t reportID, const void *report, uint8_t len, bool replace) {
+    if (len > sizeof(__hid_queue[0].data)) {
+        return false;
+    }
+    __USBStart();
+    CoreMutex m(&__usb_mutex, false);
+    if (!m) {
+        return false;
+    }
+    HIDQueuedReport *r = nullptr;
+    if (replace && __hid_queue_count) {
+        HIDQueuedReport *last = &__hid_queue[(__hid_queue_head + __hid_queue_count - 1) % USBD_HID_QUEUE];
+        if (last->id == reportID) {
+            r = last;
+        }
+    }
+    if (!r) {
+        if (__hid_queue_count == USBD_HID_QUEUE) {
+            return false;
+        }
+        r = &__hid_queue[(__hid_queue_head + __hid_queue_count) % USBD_HID_QUEUE];
+        __hid_queue_count++;
+    }
+    r->id = reportID;
+    r->len = len;
+    memcpy(r->data, report, len);
+    __USBHIDSendQueued();
+    return true;
+}
+
+int __USBHIDQueueAvailable() {
+    CoreMutex m(&__usb_mutex, false);
+    return m ? USBD_HID_QUEUE - __hid_queue_count : 0;
+}
+
 // Invoked when received GET HID REPORT DESCRIPTOR
 // Application return pointer to descriptor
 // Descriptor contents must exist long enough for transfer to complete
@@ -219,26 +405,35 @@ const uint8_t *tud_descriptor_configuration_cb(uint8_t index) {
     return usbd_desc_cfg;
 }
 
+static void __SetupMSOS20Descriptor();
+
 void __SetupUSBDescriptor() {
     if (!usbd_desc_cfg) {
         bool hasHID = __USBInstallKeyboard || __USBInstallMouse || __USBInstallJoystick;
 
-        uint8_t interface_count = (__USBInstallSerial ? 2 : 0) + (hasHID ? 1 : 0);
+        int cdc_count = __USBSerialCount();
 
-        uint8_t cdc_desc[TUD_CDC_DESC_LEN] = {
-            // Interface number, string index, protocol, report descriptor len, EP In & Out address, size & polling interval
-            TUD_CDC_DESCRIPTOR(USBD_ITF_CDC, USBD_STR_CDC, USBD_CDC_EP_CMD, USBD_CDC_CMD_MAX_SIZE, USBD_CDC_EP_OUT, USBD_CDC_EP_IN, USBD_CDC_IN_OUT_MAX_SIZE)
-        };
+        uint8_t interface_count = cdc_count * 2 + (hasHID ? 1 : 0) + (__USBInstallBulk ? 1 : 0) + (__USBInstallMassStorage ? 1 : 0);
 
         int hid_report_len;
         GetDescHIDReport(&hid_report_len);
-        uint8_t hid_itf = __USBInstallSerial ? 2 : 0;
+        uint8_t hid_itf = cdc_count * 2;
         uint8_t hid_desc[TUD_HID_DESC_LEN] = {
             // Interface number, string index, protocol, report descriptor len, EP In & Out address, size & polling interval
-            TUD_HID_DESCRIPTOR(hid_itf, 0, HID_ITF_PROTOCOL_NONE, hid_report_len, EPNUM_HID, CFG_TUD_HID_EP_BUFSIZE, 10)
+            TUD_HID_DESCRIPTOR(hid_itf, 0, HID_ITF_PROTOCOL_NONE, hid_report_len, EPNUM_HID, CFG_TUD_HID_EP_BUFSIZE, USBD_HID_POLL_MS)
         };
 
-        int usbd_desc_len = TUD_CONFIG_DESC_LEN + (__USBInstallSerial ? sizeof(cdc_desc) : 0) + (hasHID ? sizeof(hid_desc) : 0);
+        uint8_t bulk_desc[TUD_VENDOR_DESC_LEN] = {
+            // Interface number, string index, EP Out & In address, size
+            TUD_VENDOR_DESCRIPTOR((uint8_t)__USBGetBulkInterface(), USBD_STR_BULK, EPNUM_BULK_OUT, EPNUM_BULK_IN, USBD_BULK_MAX_SIZE)
+        };
+
+        uint8_t msc_desc[TUD_MSC_DESC_LEN] = {
+            // Interface number, string index, EP Out & In address, size
+            TUD_MSC_DESCRIPTOR((uint8_t)__USBGetMassStorageInterface(), USBD_STR_MSC, EPNUM_MSC_OUT, EPNUM_MSC_IN, USBD_MSC_MAX_SIZE)
+        };
+
+        int usbd_desc_len = TUD_CONFIG_DESC_LEN + cdc_count * TUD_CDC_DESC_LEN + (hasHID ? sizeof(hid_desc) : 0) + (__USBInstallBulk ? sizeof(bulk_desc) : 0) + (__USBInstallMassStorage ? sizeof(msc_desc) : 0);
 
         uint8_t tud_cfg_desc[TUD_CONFIG_DESC_LEN] = {
             // Config number, interface count, string index, total length, attribute, power in mA
@@ -252,7 +447,16 @@ void __SetupUSBDescriptor() {
             uint8_t *ptr = usbd_desc_cfg;
             memcpy(ptr, tud_cfg_desc, sizeof(tud_cfg_desc));
             ptr += sizeof(tud_cfg_desc);
-            if (__USBInstallSerial) {
+            for (int i = 0; i < SERIALUSB_PORTS; i++) {
+                if (!__USBSerialInstalled(i)) {
+                    continue;
+                }
+                uint8_t cdc_itf = __USBGetSerialInterface(i);
+                uint8_t cdc_str = USBD_STR_CDC + i;
+                uint8_t cdc_desc[TUD_CDC_DESC_LEN] = {
+                    // Interface number, string index, notification EP & size, EP Out & In address, size
+                    TUD_CDC_DESCRIPTOR(cdc_itf, cdc_str, __cdc_ep[i][0], USBD_CDC_CMD_MAX_SIZE, __cdc_ep[i][1], __cdc_ep[i][2], USBD_CDC_IN_OUT_MAX_SIZE)
+                };
                 memcpy(ptr, cdc_desc, sizeof(cdc_desc));
                 ptr += sizeof(cdc_desc);
             }
@@ -260,10 +464,77 @@ void __SetupUSBDescriptor() {
                 memcpy(ptr, hid_desc, sizeof(hid_desc));
                 ptr += sizeof(hid_desc);
             }
+            if (__USBInstallBulk) {
+                memcpy(ptr, bulk_desc, sizeof(bulk_desc));
+                ptr += sizeof(bulk_desc);
+            }
+            if (__USBInstallMassStorage) {
+                memcpy(ptr, msc_desc, sizeof(msc_desc));
+                ptr += sizeof(msc_desc);
+            }
+        }
+        if (__USBInstallBulk) {
+            __SetupMSOS20Descriptor();
         }
     }
 }
 
+// MS OS 2.0 descriptor set: the USBBulk function is WinUSB compatible and has a DeviceInterfaceGUID
+#define MS_OS_20_REG_LEN (2 + 2 + 2 + 2 + 42 + 2 + 80)
+#define MS_OS_20_DESC_LEN (10 + 8 + 8 + 20 + MS_OS_20_REG_LEN)
+static_assert(sizeof(USBBULK_GUID) == 39, "USBBULK_GUID must be a {XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX} string");
+static uint8_t __ms_os_20_desc[MS_OS_20_DESC_LEN];
+
+static void __SetupMSOS20Descriptor() {
+    uint8_t hdr[] = {
+        // Set header: length, type, Windows version, total length
+        U16_TO_U8S_LE(0x000A), U16_TO_U8S_LE(MS_OS_20_SET_HEADER_DESCRIPTOR), U32_TO_U8S_LE(0x06030000), U16_TO_U8S_LE(MS_OS_20_DESC_LEN),
+        // Configuration subset header: length, type, configuration index, reserved, subset length
+        U16_TO_U8S_LE(0x0008), U16_TO_U8S_LE(MS_OS_20_SUBSET_HEADER_CONFIGURATION), 0, 0, U16_TO_U8S_LE(MS_OS_20_DESC_LEN - 0x0A),
+        // Function subset header: length, type, first interface, reserved, subset length
+        U16_TO_U8S_LE(0x0008), U16_TO_U8S_LE(MS_OS_20_SUBSET_HEADER_FUNCTION), (uint8_t)__USBGetBulkInterface(), 0, U16_TO_U8S_LE(MS_OS_20_DESC_LEN - 0x0A - 0x08),
+        // Compatible ID: length, type, compatible ID, sub-compatible ID
+        U16_TO_U8S_LE(0x0014), U16_TO_U8S_LE(MS_OS_20_FEATURE_COMPATBLE_ID), 'W', 'I', 'N', 'U', 'S', 'B', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        // Registry property: length, type, REG_MULTI_SZ, name length
+        U16_TO_U8S_LE(MS_OS_20_REG_LEN), U16_TO_U8S_LE(MS_OS_20_FEATURE_REG_PROPERTY), U16_TO_U8S_LE(0x0007), U16_TO_U8S_LE(42)
+    };
+    uint8_t *ptr = __ms_os_20_desc;
+    memcpy(ptr, hdr, sizeof(hdr));
+    ptr += sizeof(hdr);
+    // Name and value are UTF-16LE, the value is doubly terminated
+    for (const char *c = "DeviceInterfaceGUIDs"; *c; c++) {
+        *ptr++ = *c;
+        *ptr++ = 0;
+    }
+    ptr += 2;
+    *ptr++ = 80;
+    *ptr++ = 0;
+    for (const char *c = USBBULK_GUID; *c; c++) {
+        *ptr++ = *c;
+        *ptr++ = 0;
+    }
+}
+
+const uint8_t *tud_descriptor_bos_cb(void) {
+    static const uint8_t bos_desc[] = {
+        // Total length, number of device capabilities
+        TUD_BOS_DESCRIPTOR(TUD_BOS_DESC_LEN + TUD_BOS_MICROSOFT_OS_DESC_LEN, 1),
+        // MS OS 2.0 descriptor set length, vendor request code
+        TUD_BOS_MS_OS_20_DESCRIPTOR(MS_OS_20_DESC_LEN, USBD_VENDOR_REQUEST_MS)
+    };
+    return __USBInstallBulk ? bos_desc : nullptr;
+}
+
+bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request) {
+    if (stage != CONTROL_STAGE_SETUP) {
+        return true;
+    }
+    if (__USBInstallBulk && (request->bRequest == USBD_VENDOR_REQUEST_MS) && (request->wIndex == 7)) {
+        return tud_control_xfer(rhport, request, __ms_os_20_desc, sizeof(__ms_os_20_desc));
+    }
+    return false;
+}
+
 const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
     (void) langid;
 #define DESC_STR_MAX (20)
@@ -277,6 +548,10 @@ const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
         [USBD_STR_PRODUCT] = "PicoArduino",
         [USBD_STR_SERIAL] = idString,
         [USBD_STR_CDC] = "Board CDC",
+        [USBD_STR_CDC + 1] = "Board CDC 1",
+        [USBD_STR_CDC + 2] = "Board CDC 2",
+        [USBD_STR_BULK] = "Board Bulk",
+        [USBD_STR_MSC] = "Board MSC",
     };
 
     if (!idString[0]) {
@@ -304,16 +579,60 @@ const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
 }
 
 
+static int64_t wake_task(__unused alarm_id_t id, __unused void *user_data) {
+    irq_set_pending(__usb_task_irq);
+    return 0;
+}
+
+void __USBWakeTask(uint32_t ms) __attribute__((weak));
+void __USBWakeTask(uint32_t ms) {
+    if (!ms) {
+        irq_set_pending(__usb_task_irq);
+    } else {
+        add_alarm_in_ms(ms, wake_task, NULL, true);
+    }
+}
+
+uint32_t __USBTaskHooks() {
+    if (__hid_queue_count) {
+        __USBHIDSendQueued();
+    }
+    uint32_t next = __USBSerialTask ? __USBSerialTask() : 0;
+    uint32_t mscNext = __USBMassStorageTask ? __USBMassStorageTask() : 0;
+    if (mscNext && (!next || (mscNext < next))) {
+        next = mscNext;
+    }
+    return next;
+}
+
 static void usb_irq() {
+    CoreLoadScope load(CORELOAD_IRQ);
     // if the mutex is already owned, then we are in user code
-    // in this file which will do a tud_task itself, so we'll just do nothing
-    // until the next tick; we won't starve
+    // in this file which will do a tud_task itself, so just check
+    // back in shortly; we won't starve
     if (mutex_try_enter(&__usb_mutex, NULL)) {
-        tud_task();
+        {
+            PROFILE_CORE_SCOPE("tud_task");
+            tud_task();
+        }
+        uint32_t next = __USBTaskHooks();
         mutex_exit(&__usb_mutex);
+        if (next) {
+            __USBWakeTask(next);
+        }
+    } else {
+        __USBWakeTask(1);
     }
 }
 
+IRQWait __usbIRQWait;
+
+static void usb_ctrl_irq() {
+    // Runs after TinyUSB's own handler, so any events are already queued
+    irq_set_pending(__usb_task_irq);
+    __usbIRQWait.notify();
+}
+
 static int64_t timer_task(__unused alarm_id_t id, __unused void *user_data) {
     irq_set_pending(__usb_task_irq);
     return USB_TASK_INTERVAL;
@@ -321,8 +640,11 @@ static int64_t timer_task(__unused alarm_id_t id, __unused void *user_data) {
 
 void __USBStart() __attribute__((weak));
 
+// __usb_mutex is initialized by main() before this is called, either at boot or, with
+// fast_boot, by the first begin() of a USB class from either core
 void __USBStart() {
-    if (tusb_inited()) {
+    CoreMutex m(&__usb_mutex, false);
+    if (!m || tud_inited()) {
         // Already called
         return;
     }
@@ -330,17 +652,36 @@ void __USBStart() {
     __SetupDescHIDReport();
     __SetupUSBDescriptor();
 
-    mutex_init(&__usb_mutex);
-
-    tusb_init();
+    // Only the device port, the PIO host port is started by USBHost.begin()
+    tud_init(TUD_OPT_RHPORT);
 
     __usb_task_irq = user_irq_claim_unused(true);
     irq_set_exclusive_handler(__usb_task_irq, usb_irq);
+    irq_set_priority(__usb_task_irq, PICO_LOWEST_IRQ_PRIORITY);
     irq_set_enabled(__usb_task_irq, true);
 
+    irq_add_shared_handler(USBCTRL_IRQ, usb_ctrl_irq, PICO_SHARED_IRQ_HANDLER_LOWEST_ORDER_PRIORITY);
+
     add_alarm_in_us(USB_TASK_INTERVAL, timer_task, NULL, true);
 }
 
+void __USBSuspend(bool suspend) {
+    if (!tud_inited()) {
+        return;
+    }
+    if (suspend) {
+        CoreMutex m(&__usb_mutex);
+        tud_disconnect();
+        irq_set_enabled(__usb_task_irq, false);
+        irq_set_enabled(USBCTRL_IRQ, false);
+    } else {
+        irq_set_enabled(USBCTRL_IRQ, true);
+        irq_set_enabled(__usb_task_irq, true);
+        CoreMutex m(&__usb_mutex);
+        tud_connect();
+    }
+}
+
 
 // Invoked when received GET_REPORT control request
 // Application must fill buffer report's content and return its length.
@@ -20,21 +20,62 @@
 */
 
 #include "pico/mutex.h"
+#include "IRQWait.h"
 
 // Weak function definitions for each type of endpoint
 extern void __USBInstallSerial() __attribute__((weak));
+extern void __USBInstallSerial1() __attribute__((weak));
+extern void __USBInstallSerial2() __attribute__((weak));
 extern void __USBInstallKeyboard() __attribute__((weak));
 extern void __USBInstallJoystick() __attribute__((weak));
 extern void __USBInstallMouse() __attribute__((weak));
+extern void __USBInstallBulk() __attribute__((weak));
+extern void __USBInstallMassStorage() __attribute__((weak));
+
+// Hooks run from the USB task (with __usb_mutex held) after tud_task().  Each returns the
+// number of ms until it needs to be called again, or 0 if it has nothing pending.
+extern uint32_t __USBSerialTask() __attribute__((weak));
+extern uint32_t __USBMassStorageTask() __attribute__((weak));
+// Runs all of the above and sends queued HID reports, returning the soonest time needed
+extern uint32_t __USBTaskHooks();
+
+// Ask for the USB task to run in ms milliseconds (0 = as soon as possible), from any context
+extern void __USBWakeTask(uint32_t ms);
 
 // Big, global USB mutex, shared with all USB devices to make sure we don't
 // have multiple cores updating the TUSB state in parallel
 extern mutex_t __usb_mutex;
 
+// Notified by every USB controller IRQ, for code holding __usb_mutex which needs the host to
+// take data before it can continue
+extern IRQWait __usbIRQWait;
+
+// Interface number of a SerialUSB port's CDC communication interface, -1 if it isn't installed
+int __USBGetSerialInterface(int port);
+
+// Interface number of the USBBulk vendor interface, -1 if it isn't installed
+int __USBGetBulkInterface();
+
+// Interface number of the USBMassStorage interface, -1 if it isn't installed
+int __USBGetMassStorageInterface();
+
 // HID report ID inquiry (report ID will vary depending on the number/type of other HID)
 int __USBGetKeyboardReportID();
 int __USBGetMouseReportID();
 int __USBGetJoystickReportID();
 
+// Queues a HID report (without its ID byte) to go out as soon as the endpoint is free, without
+// waiting for tud_hid_ready().  Reports are sent in order.  With replace, a report that describes
+// the whole device state (e.g. a gamepad) overwrites the newest queued one with the same ID
+// instead of adding to the queue; keyboard and relative mouse reports must not be replaced.
+// Returns false if the queue is full
+bool __USBHIDQueueReport(uint8_t reportID, const void *report, uint8_t len, bool replace = false);
+// Free entries in the HID report queue
+int __USBHIDQueueAvailable();
+
 // Called by main() to init the USB HW/SW.
 void __USBStart();
+
+// Drops off the bus and stops USB processing while the USB clock is stopped by sleep modes,
+// then reconnects.  Weak so sleeping doesn't pull in the USB stack.
+extern void __USBSuspend(bool suspend) __attribute__((weak));
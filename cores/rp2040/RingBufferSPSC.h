@@ -0,0 +1,219 @@
+/*
+    Lockless power-of-2 ring buffer for one writer and one reader
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <hardware/sync.h>
+
+// A drop-in for arduino::RingBufferN that is safe with the writer and reader
+// in different contexts (an IRQ and the main loop, or the two cores).  There
+// is no shared element count: the writer only ever updates _head and the
+// reader only ever updates _tail, both free-running and masked down to an
+// index, so all entries are usable and no locks or IRQ disabling are needed.
+//
+// Besides the single-element RingBufferN calls, write() and read() move a
+// block at a time, and the span calls hand out the largest contiguous piece
+// of the ring so it can be filled or drained in place (by memcpy or DMA)
+// before committing or consuming it.
+//
+// N must be a power of 2.  With N of 0 the ring is sized at runtime by
+// begin(), which holds exactly the number of entries asked for in storage
+// rounded up to a power of 2, for drivers with a user-set FIFO size.  Nothing
+// ever blocks and no SEV is sent, so it is cheap enough for per-byte use
+// inside an IRQ.  MulticoreQueue adds blocking on top of it.
+template<typename T, size_t N = 0>
+class RingBufferSPSC {
+    static_assert(!(N & (N - 1)), "RingBufferSPSC size must be a power of 2");
+
+public:
+    RingBufferSPSC() : _data(N ? _fixed : nullptr), _mask(N ? N - 1 : 0), _size(N) { }
+    ~RingBufferSPSC() {
+        end();
+    }
+    RingBufferSPSC(const RingBufferSPSC &) = delete;
+    RingBufferSPSC &operator=(const RingBufferSPSC &) = delete;
+
+    // Only for N of 0, before either side uses it.  Returns false if out of memory
+    bool begin(size_t size) {
+        if (N || !size) {
+            return false;
+        }
+        end();
+        size_t cap = 1;
+        while (cap < size) {
+            cap <<= 1;
+        }
+        _data = new (std::nothrow) T[cap];
+        if (!_data) {
+            return false;
+        }
+        _mask = cap - 1;
+        _size = size;
+        _head = 0;
+        _tail = 0;
+        return true;
+    }
+
+    void end() {
+        if (!N && _data) {
+            delete[] _data;
+            _data = nullptr;
+            _size = 0;
+        }
+    }
+
+    // Entries it holds when full
+    size_t size() const {
+        return _size;
+    }
+
+    // Producer side
+    bool store_char(T c) {
+        uint32_t head = _head;
+        if (head - _tail >= _size) {
+            return false;
+        }
+        _data[head & _mask] = c;
+        __dmb(); // Data must be visible before the new head
+        _head = head + 1;
+        return true;
+    }
+
+    // Store up to cnt entries, returns # actually stored
+    size_t write(const T *vals, size_t cnt) {
+        size_t space = availableForStore();
+        if (cnt > space) {
+            cnt = space;
+        }
+        uint32_t head = _head;
+        size_t idx = head & _mask;
+        size_t first = (cnt < _mask + 1 - idx) ? cnt : _mask + 1 - idx;
+        _copy(&_data[idx], vals, first);
+        _copy(&_data[0], vals + first, cnt - first);
+        __dmb();
+        _head = head + cnt;
+        return cnt;
+    }
+
+    // Where the next entries may be written in place, and how many fit there
+    // before the ring wraps or fills.  Follow with commit() of at most *cnt.
+    T *writeSpan(size_t *cnt) {
+        uint32_t head = _head;
+        size_t idx = head & _mask;
+        size_t space = _size - (head - _tail);
+        *cnt = (space < _mask + 1 - idx) ? space : _mask + 1 - idx;
+        return &_data[idx];
+    }
+
+    void commit(size_t cnt) {
+        __dmb(); // In-place writes must land before the new head
+        _head = _head + cnt;
+    }
+
+    size_t availableForStore() const {
+        return _size - (_head - _tail);
+    }
+
+    bool isFull() const {
+        return _head - _tail >= _size;
+    }
+
+    // Consumer side.  Like RingBufferN, returns -1 when empty.
+    int read_char() {
+        uint32_t tail = _tail;
+        if (_head == tail) {
+            return -1;
+        }
+        __dmb(); // Don't read data before we've seen the head that covers it
+        T c = _data[tail & _mask];
+        __dmb(); // The read must complete before the slot is handed back
+        _tail = tail + 1;
+        return c;
+    }
+
+    int peek() const {
+        uint32_t tail = _tail;
+        if (_head == tail) {
+            return -1;
+        }
+        __dmb();
+        return _data[tail & _mask];
+    }
+
+    // Read up to cnt entries, returns # actually read
+    size_t read(T *vals, size_t cnt) {
+        size_t avail = available();
+        if (cnt > avail) {
+            cnt = avail;
+        }
+        uint32_t tail = _tail;
+        size_t idx = tail & _mask;
+        size_t first = (cnt < _mask + 1 - idx) ? cnt : _mask + 1 - idx;
+        __dmb();
+        _copy(vals, &_data[idx], first);
+        _copy(vals + first, &_data[0], cnt - first);
+        __dmb();
+        _tail = tail + cnt;
+        return cnt;
+    }
+
+    // The oldest entries in place, and how many run contiguously from there.
+    // Follow with consume() of at most *cnt.
+    const T *readSpan(size_t *cnt) const {
+        uint32_t tail = _tail;
+        size_t idx = tail & _mask;
+        size_t avail = _head - tail;
+        *cnt = (avail < _mask + 1 - idx) ? avail : _mask + 1 - idx;
+        __dmb();
+        return &_data[idx];
+    }
+
+    void consume(size_t cnt) {
+        __dmb(); // In-place reads must complete before the slots are handed back
+        _tail = _tail + cnt;
+    }
+
+    size_t available() const {
+        return _head - _tail;
+    }
+
+    // Only safe when the writer is stopped, or from the reader to drop everything
+    // written so far
+    void clear() {
+        _tail = _head;
+    }
+
+private:
+    static void _copy(T *dst, const T *src, size_t cnt) {
+        for (size_t i = 0; i < cnt; i++) {
+            dst[i] = src[i];
+        }
+    }
+
+    T *_data;
+    size_t _mask;                // Storage size - 1, for indexing
+    size_t _size;                // Entries held when full, at most _mask + 1
+    volatile uint32_t _head = 0; // Only written by the producer
+    volatile uint32_t _tail = 0; // Only written by the consumer
+    T _fixed[N ? N : 1];
+};
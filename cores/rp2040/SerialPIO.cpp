@@ -20,7 +20,9 @@
 
 #include "SerialPIO.h"
 #include "CoreMutex.h"
+#include "DMAChannel.h"
 #include <hardware/gpio.h>
+#include <hardware/dma.h>
 #include <map>
 #include "pio_uart.pio.h"
 
@@ -80,12 +82,16 @@ static int _parity(int bits, int data) {
 // the shared handler
 static SerialPIO *_pioSP[2][4];
 static void __not_in_flash_func(_fifoIRQ)() {
+    CoreLoadScope load(CORELOAD_IRQ);
     for (int p = 0; p < 2; p++) {
-        for (int sm = 0; sm < 4; sm++) {
+        // Only walk the SMs which actually have RX data waiting (SMx_RXNEMPTY are bits 0..3)
+        uint32_t pending = ((p == 0) ? pio0 : pio1)->ints0 & 0x0f;
+        while (pending) {
+            int sm = __builtin_ctz(pending);
+            pending &= pending - 1;
             SerialPIO *s = _pioSP[p][sm];
             if (s) {
                 s->_handleIRQ();
-                pio_interrupt_clear((p == 0) ? pio0 : pio1, sm);
             }
         }
     }
@@ -96,53 +102,145 @@ void __not_in_flash_func(SerialPIO::_handleIRQ)() {
         return;
     }
     while (!pio_sm_is_rx_fifo_empty(_rxPIO, _rxSM)) {
-        uint32_t decode = _rxPIO->rxf[_rxSM];
-        decode >>= 33 - _rxBits;
-        uint32_t val = 0;
-        for (int b = 0; b < _bits + 1; b++) {
-            val |= (decode & (1 << (b * 2))) ? 1 << b : 0;
+        _decode(_rxPIO->rxf[_rxSM]);
+    }
+}
+
+void __not_in_flash_func(SerialPIO::_decode)(uint32_t decode) {
+    decode >>= 33 - _rxBits;
+    uint32_t val = 0;
+    for (int b = 0; b < _bits + 1; b++) {
+        val |= (decode & (1 << (b * 2))) ? 1 << b : 0;
+    }
+    if (_parity == UART_PARITY_EVEN) {
+        int p = ::_parity(_bits, val);
+        int r = (val & (1 << _bits)) ? 1 : 0;
+        if (p != r) {
+            // TODO - parity error
+            return;
         }
-        if (_parity == UART_PARITY_EVEN) {
-            int p = ::_parity(_bits, val);
-            int r = (val & (1 << _bits)) ? 1 : 0;
-            if (p != r) {
-                // TODO - parity error
-                continue;
-            }
-        } else if (_parity == UART_PARITY_ODD) {
-            int p = ::_parity(_bits, val);
-            int r = (val & (1 << _bits)) ? 1 : 0;
-            if (p == r) {
-                // TODO - parity error
-                continue;
-            }
+    } else if (_parity == UART_PARITY_ODD) {
+        int p = ::_parity(_bits, val);
+        int r = (val & (1 << _bits)) ? 1 : 0;
+        if (p == r) {
+            // TODO - parity error
+            return;
         }
+    }
 
-        auto next_writer = _writer + 1;
-        if (next_writer == _fifoSize) {
-            next_writer = 0;
+    if (!_rxRing.store_char(val & ((1 << _bits) -  1))) {
+        _overflow = true;
+    }
+}
+
+// Only called with _mutex held, and the DMA is the only writer so no IRQ games needed
+void SerialPIO::_pumpDMA() {
+    if (_rxDMAChannel < 0) {
+        return;
+    }
+    uint32_t remaining = dma_channel_hw_addr(_rxDMAChannel)->transfer_count;
+    uint32_t received = _rxDMACount - remaining;
+    if (received >= _rxDMAWords) {
+        // The DMA has lapped us, so throw away everything but the newest words
+        _overflow = true;
+        _rxDMAReader = (_rxDMAReader + received - (_rxDMAWords - 1)) & (_rxDMAWords - 1);
+        received = _rxDMAWords - 1;
+    }
+    while (received--) {
+        _decode(_rxDMABuff[_rxDMAReader]);
+        _rxDMAReader = (_rxDMAReader + 1) & (_rxDMAWords - 1);
+    }
+    if (!remaining) {
+        // Restart from wherever the ring write pointer was left
+        remaining = 0xffffffff;
+        dma_channel_set_trans_count(_rxDMAChannel, remaining, true);
+    }
+    _rxDMACount = remaining;
+}
+
+// Called with _txLock held.  A new transfer picks up everything queued since the last one
+// started, and the DMA's read ring wraps it around the end of the queue.
+void __not_in_flash_func(SerialPIO::_kickTX)() {
+    if (dma_channel_is_busy(_txDMAChannel)) {
+        return;
+    }
+    _txStart += _txCount;
+    _txCount = _txWriter - _txStart;
+    if (_txCount) {
+        dma_channel_transfer_from_buffer_now(_txDMAChannel, &_txQueue[_txStart & (_txFifoSize - 1)], _txCount);
+    }
+}
+
+void __not_in_flash_func(SerialPIO::_txDMADone)(int channel, void *param) {
+    (void) channel;
+    SerialPIO *s = (SerialPIO *)param;
+    uint32_t irqs = spin_lock_blocking(s->_txLock);
+    s->_kickTX();
+    spin_unlock(s->_txLock, irqs);
+    s->_txWait.notify();
+}
+
+// The transfer count runs down to 0 as the DMA reads, and is left there when it finishes
+size_t SerialPIO::_txRoom() {
+    uint32_t irqs = spin_lock_blocking(_txLock);
+    uint32_t reader = _txStart + _txCount - dma_channel_hw_addr(_txDMAChannel)->transfer_count;
+    size_t room = _txFifoSize - (_txWriter - reader);
+    spin_unlock(_txLock, irqs);
+    return room;
+}
+
+// Only called with _mutex held, so this is the only writer.  Words are filled in outside the
+// lock since the DMA never reads past _txWriter.
+void SerialPIO::_queueTX(const uint8_t *p, size_t len) {
+    while (len) {
+        _txWait.arm();
+        size_t n = std::min(_txRoom(), len);
+        if (!n) {
+            _txWait.wait(10);
+            continue;
         }
-        if (next_writer != _reader) {
-            _queue[_writer] = val & ((1 << _bits) -  1);
-            asm volatile("" ::: "memory"); // Ensure the queue is written before the written count advances
-            _writer = next_writer;
-        } else {
-            _overflow = true;
+        uint32_t w = _txWriter;
+        for (size_t i = 0; i < n; i++) {
+            _txQueue[(w + i) & (_txFifoSize - 1)] = _encode(*p++);
         }
+        len -= n;
+        uint32_t irqs = spin_lock_blocking(_txLock);
+        _txWriter = w + n;
+        _kickTX();
+        spin_unlock(_txLock, irqs);
     }
 }
 
 SerialPIO::SerialPIO(pin_size_t tx, pin_size_t rx, size_t fifoSize) {
     _tx = tx;
     _rx = rx;
-    _fifoSize = fifoSize + 1; // Always one unused entry
-    _queue = new uint8_t[_fifoSize];
+    _rxRing.begin(fifoSize);
     mutex_init(&_mutex);
 }
 
+bool SerialPIO::setRxDMA(bool mode) {
+    if (_running) {
+        return false;
+    }
+    _rxDMA = mode;
+    return true;
+}
+
+bool SerialPIO::setTxFIFOSize(size_t size) {
+    if (_running) {
+        return false;
+    }
+    // The DMA read ring can wrap at most 32KB
+    size_t n = 8;
+    while ((n < size) && (n < 8192)) {
+        n <<= 1;
+    }
+    _txFifoSize = size ? n : 0;
+    return true;
+}
+
 SerialPIO::~SerialPIO() {
     end();
-    delete[] _queue;
 }
 
 void SerialPIO::begin(unsigned long baud, uint16_t config) {
@@ -208,25 +306,47 @@ void SerialPIO::begin(unsigned long baud, uint16_t config) {
         pio_sm_exec(_txPIO, _txSM, pio_encode_pull(false, false));
         pio_sm_exec(_txPIO, _txSM, pio_encode_mov(pio_isr, pio_osr));
 
+        // The TX FIFO is already joined into a single 8-deep one by pio_tx_program_init
+        _txWriter = 0;
+        _txStart = 0;
+        _txCount = 0;
+        if (_txFifoSize) {
+            _txDMAChannel = dma_claim_unused_channel(false);
+        }
+        if (_txDMAChannel >= 0) {
+            _txQueue = (uint32_t *)aligned_alloc(_txFifoSize * 4, _txFifoSize * 4);
+            if (!_txQueue) {
+                dma_channel_unclaim(_txDMAChannel);
+                _txDMAChannel = -1;
+            }
+        }
+        if (_txDMAChannel >= 0) {
+            // Paced by the SM's TX DREQ, reading around the queue as a HW-wrapped ring
+            _txLock = spin_lock_instance(spin_lock_claim_unused(true));
+            dma_channel_config c = dma_channel_get_default_config(_txDMAChannel);
+            channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+            channel_config_set_read_increment(&c, true);
+            channel_config_set_write_increment(&c, false);
+            channel_config_set_ring(&c, false, __builtin_ctz(_txFifoSize * 4));
+            channel_config_set_dreq(&c, pio_get_dreq(_txPIO, _txSM, true));
+            dma_channel_configure(_txDMAChannel, &c, &_txPIO->txf[_txSM], _txQueue, 0, false);
+            DMAChannel::attachInterrupt(_txDMAChannel, _txDMADone, this);
+        }
+
         // Start running!
         pio_sm_set_enabled(_txPIO, _txSM, true);
     }
     if (_rx != NOPIN) {
-        _writer = 0;
-        _reader = 0;
+        _rxRing.clear();
 
         _rxBits = 2 * (_bits + _stop + (_parity != UART_PARITY_NONE ? 1 : 0) + 1) - 1;
         _rxPgm = _getRxProgram(_rxBits);
-        int off;
-        if (!_rxPgm->prepare(&_rxPIO, &_rxSM, &off)) {
+        if (!_rxPgm->prepare(&_rxPIO, &_rxSM, &_rxOffset)) {
             DEBUGCORE("ERROR: Unable to allocate PIO RX UART, out of PIO resources\n");
             return;
         }
-        // Stash away the created RX port for the IRQ handler
-        _pioSP[pio_get_index(_rxPIO)][_rxSM] = this;
-
         pinMode(_rx, INPUT);
-        pio_rx_program_init(_rxPIO, _rxSM, off, _rx);
+        pio_rx_program_init(_rxPIO, _rxSM, _rxOffset, _rx);
         pio_sm_clear_fifos(_rxPIO, _rxSM); // Remove any existing data
 
         // Put phase divider into OSR w/o using add'l program memory
@@ -236,32 +356,105 @@ void SerialPIO::begin(unsigned long baud, uint16_t config) {
         // Join the TX FIFO to the RX one now that we don't need it
         _rxPIO->sm[_rxSM].shiftctrl |= 0x80000000;
 
-        // Enable interrupts on rxfifo
-        switch (_rxSM) {
-        case 0: pio_set_irq0_source_enabled(_rxPIO, pis_sm0_rx_fifo_not_empty, true); break;
-        case 1: pio_set_irq0_source_enabled(_rxPIO, pis_sm1_rx_fifo_not_empty, true); break;
-        case 2: pio_set_irq0_source_enabled(_rxPIO, pis_sm2_rx_fifo_not_empty, true); break;
-        case 3: pio_set_irq0_source_enabled(_rxPIO, pis_sm3_rx_fifo_not_empty, true); break;
+        if (_rxDMA) {
+            _rxDMAChannel = dma_claim_unused_channel(false);
+        }
+        if (_rxDMAChannel >= 0) {
+            // Raw words go into a HW-wrapped ring, and are only decoded when the app reads
+            _rxDMABuff = (uint32_t *)aligned_alloc(_rxDMAWords * 4, _rxDMAWords * 4);
+            _rxDMAReader = 0;
+            _rxDMACount = 0xffffffff;
+            dma_channel_config c = dma_channel_get_default_config(_rxDMAChannel);
+            channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+            channel_config_set_read_increment(&c, false);
+            channel_config_set_write_increment(&c, true);
+            channel_config_set_ring(&c, true, __builtin_ctz(_rxDMAWords * 4));
+            channel_config_set_dreq(&c, pio_get_dreq(_rxPIO, _rxSM, false));
+            dma_channel_configure(_rxDMAChannel, &c, _rxDMABuff, &_rxPIO->rxf[_rxSM], _rxDMACount, true);
+        } else {
+            // Stash away the created RX port for the IRQ handler
+            _pioSP[pio_get_index(_rxPIO)][_rxSM] = this;
+
+            // Enable interrupts on rxfifo
+            switch (_rxSM) {
+            case 0: pio_set_irq0_source_enabled(_rxPIO, pis_sm0_rx_fifo_not_empty, true); break;
+            case 1: pio_set_irq0_source_enabled(_rxPIO, pis_sm1_rx_fifo_not_empty, true); break;
+            case 2: pio_set_irq0_source_enabled(_rxPIO, pis_sm2_rx_fifo_not_empty, true); break;
+            case 3: pio_set_irq0_source_enabled(_rxPIO, pis_sm3_rx_fifo_not_empty, true); break;
+            }
+            auto irqno = pio_get_index(_rxPIO) == 0 ? PIO0_IRQ_0 : PIO1_IRQ_0;
+            irq_set_exclusive_handler(irqno, _fifoIRQ);
+            irq_set_enabled(irqno, true);
         }
-        auto irqno = pio_get_index(_rxPIO) == 0 ? PIO0_IRQ_0 : PIO1_IRQ_0;
-        irq_set_exclusive_handler(irqno, _fifoIRQ);
-        irq_set_enabled(irqno, true);
 
         pio_sm_set_enabled(_rxPIO, _rxSM, true);
     }
 
     _running = true;
+    _clockNotifier.attach();
+}
+
+void SerialPIO::_clockChanged(void *arg, bool after) {
+    SerialPIO *s = (SerialPIO *)arg;
+    if (!after) {
+        if (s->_tx != NOPIN) {
+            // Wait for the TX SM to send everything and stall on its pull
+            s->flush();
+            uint32_t stall = 1u << (PIO_FDEBUG_TXSTALL_LSB + s->_txSM);
+            s->_txPIO->fdebug = stall;
+            while (!(s->_txPIO->fdebug & stall)) { /* noop */ }
+        }
+        return;
+    }
+    if (s->_tx != NOPIN) {
+        pio_sm_set_enabled(s->_txPIO, s->_txSM, false);
+        pio_sm_put(s->_txPIO, s->_txSM, clock_get_hz(clk_sys) / s->_baud - 2);
+        pio_sm_exec(s->_txPIO, s->_txSM, pio_encode_pull(false, false));
+        pio_sm_exec(s->_txPIO, s->_txSM, pio_encode_mov(pio_isr, pio_osr));
+        pio_sm_set_enabled(s->_txPIO, s->_txSM, true);
+    }
+    if (s->_rx != NOPIN) {
+        pio_sm_set_enabled(s->_rxPIO, s->_rxSM, false);
+        // Splitting the joined FIFO clears it, so let the IRQ or DMA take what's there first
+        while (!pio_sm_is_rx_fifo_empty(s->_rxPIO, s->_rxSM)) { /* noop */ }
+        s->_rxPIO->sm[s->_rxSM].shiftctrl &= ~0x80000000;
+        pio_sm_put(s->_rxPIO, s->_rxSM, clock_get_hz(clk_sys) / (s->_baud * 2) - 5 /* insns in PIO halfbit loop */);
+        pio_sm_exec(s->_rxPIO, s->_rxSM, pio_encode_pull(false, false));
+        s->_rxPIO->sm[s->_rxSM].shiftctrl |= 0x80000000;
+        // Any character caught halfway through was sampled at the old rate, drop it
+        pio_sm_restart(s->_rxPIO, s->_rxSM);
+        pio_sm_exec(s->_rxPIO, s->_rxSM, pio_encode_jmp(s->_rxOffset));
+        pio_sm_set_enabled(s->_rxPIO, s->_rxSM, true);
+    }
 }
 
 void SerialPIO::end() {
     if (!_running) {
         return;
     }
+    _clockNotifier.detach();
     if (_tx != NOPIN) {
+        if (_txDMAChannel >= 0) {
+            DMAChannel::detachInterrupt(_txDMAChannel);
+            dma_channel_abort(_txDMAChannel);
+            dma_channel_unclaim(_txDMAChannel);
+            _txDMAChannel = -1;
+            spin_lock_unclaim(spin_lock_get_num(_txLock));
+            free(_txQueue);
+            _txQueue = nullptr;
+        }
         pio_sm_set_enabled(_txPIO, _txSM, false);
+        PIOProgram::unprepare(_txPIO, _txSM);
     }
     if (_rx != NOPIN) {
         pio_sm_set_enabled(_rxPIO, _rxSM, false);
+        PIOProgram::unprepare(_rxPIO, _rxSM);
+        if (_rxDMAChannel >= 0) {
+            dma_channel_abort(_rxDMAChannel);
+            dma_channel_unclaim(_rxDMAChannel);
+            _rxDMAChannel = -1;
+            free(_rxDMABuff);
+        }
         _pioSP[pio_get_index(_rxPIO)][_rxSM] = nullptr;
         // If no more active, disable the IRQ
         auto pioNum = pio_get_index(_rxPIO);
@@ -282,11 +475,9 @@ int SerialPIO::peek() {
     if (!_running || !m || (_rx == NOPIN)) {
         return -1;
     }
+    _pumpDMA();
     // If there's something in the FIFO now, just peek at it
-    if (_writer != _reader) {
-        return _queue[_reader];
-    }
-    return -1;
+    return _rxRing.peek();
 }
 
 int SerialPIO::read() {
@@ -294,15 +485,57 @@ int SerialPIO::read() {
     if (!_running || !m || (_rx == NOPIN)) {
         return -1;
     }
-    if (_writer != _reader) {
-        auto ret = _queue[_reader];
-        asm volatile("" ::: "memory"); // Ensure the value is read before advancing
-        auto next_reader = (_reader + 1) % _fifoSize;
-        asm volatile("" ::: "memory"); // Ensure the reader value is only written once, correctly
-        _reader = next_reader;
-        return ret;
+    _pumpDMA();
+    return _rxRing.read_char();
+}
+
+size_t SerialPIO::readBytes(char *buffer, size_t length) {
+    size_t count = 0;
+    unsigned long start = millis();
+    while (count < length) {
+        size_t got = 0;
+        {
+            CoreMutex m(&_mutex);
+            if (!_running || !m || (_rx == NOPIN)) {
+                break;
+            }
+            _pumpDMA();
+            got = _rxRing.read((uint8_t *)buffer + count, length - count);
+        }
+        if (got) {
+            count += got;
+            start = millis();
+        } else if (millis() - start >= _timeout) {
+            break;
+        }
     }
-    return -1;
+    return count;
+}
+
+size_t SerialPIO::peekAvailable() {
+    CoreMutex m(&_mutex);
+    if (!_running || !m || (_rx == NOPIN)) {
+        return 0;
+    }
+    _pumpDMA();
+    size_t len;
+    _rxRing.readSpan(&len);
+    return len;
+}
+
+const char *SerialPIO::peekBuffer() {
+    size_t len;
+    return (const char *)_rxRing.readSpan(&len);
+}
+
+void SerialPIO::peekConsume(size_t consume) {
+    CoreMutex m(&_mutex);
+    if (!_running || !m || (_rx == NOPIN)) {
+        return;
+    }
+    size_t len;
+    _rxRing.readSpan(&len);
+    _rxRing.consume(std::min(consume, len));
 }
 
 bool SerialPIO::overflow() {
@@ -321,7 +554,8 @@ int SerialPIO::available() {
     if (!_running || !m || (_rx == NOPIN)) {
         return 0;
     }
-    return (_writer - _reader) % _fifoSize;
+    _pumpDMA();
+    return _rxRing.available();
 }
 
 int SerialPIO::availableForWrite() {
@@ -329,6 +563,9 @@ int SerialPIO::availableForWrite() {
     if (!_running || !m || (_tx == NOPIN)) {
         return 0;
     }
+    if (_txQueue) {
+        return _txRoom();
+    }
     return 8 - pio_sm_get_tx_fifo_level(_txPIO, _txSM);
 }
 
@@ -337,6 +574,12 @@ void SerialPIO::flush() {
     if (!_running || !m || (_tx == NOPIN)) {
         return;
     }
+    while (_txQueue && (_txRoom() != _txFifoSize)) {
+        _txWait.arm();
+        if (_txRoom() != _txFifoSize) {
+            _txWait.wait(10);
+        }
+    }
     while (!pio_sm_is_tx_fifo_empty(_txPIO, _txSM)) {
         delay(1); // Wait for all FIFO to be read
     }
@@ -344,12 +587,7 @@ void SerialPIO::flush() {
     delay((1000 * (_txBits + 1)) / _baud);
 }
 
-size_t SerialPIO::write(uint8_t c) {
-    CoreMutex m(&_mutex);
-    if (!_running || !m || (_tx == NOPIN)) {
-        return 0;
-    }
-
+uint32_t SerialPIO::_encode(uint8_t c) {
     uint32_t val = c;
     if (_parity == UART_PARITY_NONE) {
         val |= 7 << _bits; // Set 2 stop bits, the HW will only transmit the required number
@@ -361,12 +599,41 @@ size_t SerialPIO::write(uint8_t c) {
         val |= 7 << (_bits + 1);
     }
     val <<= 1;  // Start bit = low
+    return val;
+}
+
+size_t SerialPIO::write(uint8_t c) {
+    CoreMutex m(&_mutex);
+    if (!_running || !m || (_tx == NOPIN)) {
+        return 0;
+    }
 
-    pio_sm_put_blocking(_txPIO, _txSM, val);
+    if (_txQueue) {
+        _queueTX(&c, 1);
+    } else {
+        pio_sm_put_blocking(_txPIO, _txSM, _encode(c));
+    }
 
     return 1;
 }
 
+size_t SerialPIO::write(const uint8_t *p, size_t len) {
+    CoreMutex m(&_mutex);
+    if (!_running || !m || (_tx == NOPIN)) {
+        return 0;
+    }
+
+    if (_txQueue) {
+        _queueTX(p, len);
+    } else {
+        for (size_t i = 0; i < len; i++) {
+            pio_sm_put_blocking(_txPIO, _txSM, _encode(p[i]));
+        }
+    }
+
+    return len;
+}
+
 SerialPIO::operator bool() {
     return _running;
 }
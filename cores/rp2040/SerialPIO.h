@@ -26,6 +26,9 @@
 #include <queue>
 #include <hardware/uart.h>
 #include "CoreMutex.h"
+#include "ClockNotifier.h"
+#include "IRQWait.h"
+#include "RingBufferSPSC.h"
 
 extern "C" typedef struct uart_inst uart_inst_t;
 
@@ -35,6 +38,12 @@ public:
     SerialPIO(pin_size_t tx, pin_size_t rx, size_t fifoSize = 32);
     ~SerialPIO();
 
+    // Receive using DMA into a raw ring buffer, decoded when the app reads.  Call before begin()
+    bool setRxDMA(bool mode = true);
+    // Queue up to size characters in RAM for a DMA channel to feed to the PIO, so write() only
+    // blocks when the queue is full.  Rounded up to a power of 2, 0 turns it off.  Call before begin()
+    bool setTxFIFOSize(size_t size);
+
     void begin(unsigned long baud = 115200) override {
         begin(baud, SERIAL_8N1);
     };
@@ -47,6 +56,28 @@ public:
     virtual int availableForWrite() override;
     virtual void flush() override;
     virtual size_t write(uint8_t c) override;
+    virtual size_t write(const uint8_t *p, size_t len) override;
+    // Bulk read straight out of the receive queue, same timeout semantics as Stream::readBytes
+    size_t readBytes(char *buffer, size_t length) override;
+    size_t readBytes(uint8_t *buffer, size_t length) {
+        return readBytes((char *)buffer, length);
+    }
+
+    // peek buffer API is present
+    virtual bool hasPeekBufferAPI() const override {
+        return true;
+    }
+
+    // return number of bytes accessible by peekBuffer()
+    virtual size_t peekAvailable() override;
+
+    // return a pointer to available data buffer (size = peekAvailable())
+    // semantic forbids any kind of read() before calling peekConsume()
+    virtual const char *peekBuffer() override;
+
+    // consume bytes after use (see peekBuffer)
+    virtual void peekConsume(size_t consume) override;
+
     bool overflow();
     using Print::write;
     operator bool() override;
@@ -73,10 +104,38 @@ protected:
     PIO _rxPIO;
     int _rxSM;
     int _rxBits;
+    int _rxOffset;
 
     // Lockless, IRQ-handled circular queue
-    size_t   _fifoSize;
-    uint32_t _writer;
-    uint32_t _reader;
-    uint8_t  *_queue;
+    RingBufferSPSC<uint8_t> _rxRing;
+    void _decode(uint32_t raw); // Convert a raw oversampled PIO word into a char in _rxRing
+
+    // Optional DMA receive of the raw PIO words, decoded in app context by _pumpDMA
+    bool _rxDMA = false;
+    int _rxDMAChannel = -1;
+    uint32_t *_rxDMABuff;
+    uint32_t _rxDMAReader;
+    uint32_t _rxDMACount; // Transfer count at last _pumpDMA, difference is # of new words
+    static constexpr size_t _rxDMAWords = 64; // Power of 2, ring wrapped by the DMA HW
+    void _pumpDMA();
+
+    // Optional DMA-drained transmit queue of encoded PIO words.  The counts are free running,
+    // and transfers are only started by _kickTX under _txLock, from the app or the DMA IRQ
+    size_t _txFifoSize = 0;
+    uint32_t *_txQueue = nullptr;
+    int _txDMAChannel = -1;
+    spin_lock_t *_txLock;
+    volatile uint32_t _txWriter;
+    volatile uint32_t _txStart; // First word of the current (or last) DMA transfer
+    volatile uint32_t _txCount; // Its length
+    IRQWait _txWait; // Writers blocking on the DMA IRQ for room in the queue
+    uint32_t _encode(uint8_t c);
+    size_t _txRoom();
+    void _queueTX(const uint8_t *p, size_t len);
+    void _kickTX();
+    static void _txDMADone(int channel, void *param);
+
+    // Reloads the bit periods in the state machines when the system clock changes
+    ClockNotifier _clockNotifier{_clockChanged, this};
+    static void _clockChanged(void *arg, bool after);
 };
@@ -22,6 +22,7 @@
 #include "CoreMutex.h"
 #include <hardware/uart.h>
 #include <hardware/gpio.h>
+#include <hardware/dma.h>
 
 // SerialEvent functions are weak, so when the user doesn't define them,
 // the linker just sets their address to 0 (which is checked below).
@@ -106,6 +107,22 @@ bool SerialUART::setPollingMode(bool mode) {
     return true;
 }
 
+bool SerialUART::setRxDMA(bool mode) {
+    if (_running) {
+        return false;
+    }
+    _rxDMA = mode;
+    return true;
+}
+
+bool SerialUART::setTxFIFOSize(size_t size) {
+    if (_running) {
+        return false;
+    }
+    _txFifoSize = size ? size + 1 : 0; // Always 1 unused entry, 0 disables the TX queue
+    return true;
+}
+
 bool SerialUART::setFIFOSize(size_t size) {
     if (!size || _running) {
         return false;
@@ -132,7 +149,22 @@ void SerialUART::begin(unsigned long baud, uint16_t config) {
         end();
     }
     _overflow = false;
-    _queue = new uint8_t[_fifoSize];
+    if (_rxDMA) {
+        _rxDMAChannel = dma_claim_unused_channel(false);
+    }
+    if (_rxDMAChannel >= 0) {
+        // DMA ring wrapping needs a power-of-2 sized buffer aligned to its size, max 32KB
+        size_t ringBits = 5;
+        while (((1u << ringBits) < _fifoSize) && (ringBits < 15)) {
+            ringBits++;
+        }
+        _queueSize = 1u << ringBits;
+        _queueMask = _queueSize - 1;
+        _queue = (uint8_t *)aligned_alloc(_queueSize, _queueSize);
+    } else {
+        _queueSize = _fifoSize;
+        _queue = new uint8_t[_queueSize];
+    }
     _baud = baud;
     uart_init(_uart, baud);
     int bits, stop;
@@ -182,7 +214,23 @@ void SerialUART::begin(unsigned long baud, uint16_t config) {
     uart_set_hw_flow(_uart, _rts != UART_PIN_NOT_DEFINED, _cts != UART_PIN_NOT_DEFINED);
     _writer = 0;
     _reader = 0;
-
+    _txWriter = 0;
+    _txReader = 0;
+    if (_txFifoSize && !_polling) {
+        _txQueue = new uint8_t[_txFifoSize];
+    }
+
+    if (_rxDMAChannel >= 0) {
+        // DMA runs forever (or at least till 4G bytes have been received), writing into the ring
+        dma_channel_config c = dma_channel_get_default_config(_rxDMAChannel);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_read_increment(&c, false); // Always read the UART DR
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_ring(&c, true, __builtin_ctz(_queueSize)); // Wrap writes around the queue
+        channel_config_set_dreq(&c, uart_get_dreq(_uart, false));
+        _rxDMACount = 0xffffffff;
+        dma_channel_configure(_rxDMAChannel, &c, _queue, &uart_get_hw(_uart)->dr, _rxDMACount, true);
+    }
     if (!_polling) {
         if (_uart == uart0) {
             irq_set_exclusive_handler(UART0_IRQ, _uart0IRQ);
@@ -191,19 +239,33 @@ void SerialUART::begin(unsigned long baud, uint16_t config) {
             irq_set_exclusive_handler(UART1_IRQ, _uart1IRQ);
             irq_set_enabled(UART1_IRQ, true);
         }
-        // Set the IRQ enables and FIFO level to minimum
-        uart_set_irq_enables(_uart, true, false);
+        // Set the IRQ enables and FIFO level to minimum.  TX IRQ is only enabled when there is queued data
+        uart_set_irq_enables(_uart, _rxDMAChannel < 0, false);
     } else {
         // Polling mode has no IRQs used
     }
     _running = true;
+    _clockNotifier.attach();
+}
+
+void SerialUART::_clockChanged(void *arg, bool after) {
+    SerialUART *s = (SerialUART *)arg;
+    if (!after) {
+        s->flush();
+    } else {
+        uart_set_baudrate(s->_uart, s->_baud);
+    }
 }
 
 void SerialUART::end() {
     if (!_running) {
         return;
     }
+    _clockNotifier.detach();
     _running = false;
+    if (_rxDMAChannel >= 0) {
+        dma_channel_abort(_rxDMAChannel);
+    }
     if (!_polling) {
         if (_uart == uart0) {
             irq_set_enabled(UART0_IRQ, false);
@@ -215,7 +277,15 @@ void SerialUART::end() {
     mutex_enter_blocking(&_mutex);
     mutex_enter_blocking(&_fifoMutex);
     uart_deinit(_uart);
-    delete[] _queue;
+    if (_rxDMAChannel >= 0) {
+        dma_channel_unclaim(_rxDMAChannel);
+        _rxDMAChannel = -1;
+        free(_queue);
+    } else {
+        delete[] _queue;
+    }
+    delete[] _txQueue;
+    _txQueue = nullptr;
     // Reset the mutexes once all is off/cleaned up
     mutex_exit(&_fifoMutex);
     mutex_exit(&_mutex);
@@ -235,16 +305,44 @@ void SerialUART::_pumpFIFO() {
     irq_set_enabled(irqno, enabled);
 }
 
-int SerialUART::peek() {
-    CoreMutex m(&_mutex);
-    if (!_running || !m) {
-        return -1;
+void SerialUART::_pumpDMA() {
+    // Only called with _mutex held, and the DMA is the only writer so no IRQ games needed
+    uint32_t remaining = dma_channel_hw_addr(_rxDMAChannel)->transfer_count;
+    uint32_t received = _rxDMACount - remaining;
+    if (!received) {
+        return;
     }
-    if (_polling) {
+    uint32_t used = (_queueSize + _writer - _reader) % _queueSize;
+    _writer = (_writer + received) & _queueMask;
+    if (used + received >= _queueSize) {
+        // The DMA has lapped the reader, so only the last (_queueSize - 1) bytes are valid
+        _overflow = true;
+        _reader = (_writer + 1) & _queueMask;
+    }
+    if (!remaining) {
+        // Restart from wherever the ring write pointer was left
+        remaining = 0xffffffff;
+        dma_channel_set_trans_count(_rxDMAChannel, remaining, true);
+    }
+    _rxDMACount = remaining;
+}
+
+void SerialUART::_pumpRX() {
+    if (_rxDMAChannel >= 0) {
+        _pumpDMA();
+    } else if (_polling) {
         _handleIRQ(false);
     } else {
         _pumpFIFO();
     }
+}
+
+int SerialUART::peek() {
+    CoreMutex m(&_mutex);
+    if (!_running || !m) {
+        return -1;
+    }
+    _pumpRX();
     if (_writer != _reader) {
         return _queue[_reader];
     }
@@ -256,15 +354,11 @@ int SerialUART::read() {
     if (!_running || !m) {
         return -1;
     }
-    if (_polling) {
-        _handleIRQ(false);
-    } else {
-        _pumpFIFO();
-    }
+    _pumpRX();
     if (_writer != _reader) {
         auto ret = _queue[_reader];
         asm volatile("" ::: "memory"); // Ensure the value is read before advancing
-        auto next_reader = (_reader + 1) % _fifoSize;
+        auto next_reader = (_reader + 1) % _queueSize;
         asm volatile("" ::: "memory"); // Ensure the reader value is only written once, correctly
         _reader = next_reader;
         return ret;
@@ -272,6 +366,74 @@ int SerialUART::read() {
     return -1;
 }
 
+size_t SerialUART::readBytes(char *buffer, size_t length) {
+    size_t count = 0;
+    unsigned long start = millis();
+    while (count < length) {
+        size_t got = 0;
+        {
+            CoreMutex m(&_mutex);
+            if (!_running || !m) {
+                break;
+            }
+            _rxWait.arm();
+            _pumpRX();
+            // The queue is at most 2 contiguous spans, [_reader, end) and [0, _writer)
+            while ((count + got < length) && (_writer != _reader)) {
+                uint32_t writer = _writer;
+                size_t len = ((writer > _reader) ? writer : _queueSize) - _reader;
+                len = std::min(len, length - count - got);
+                memcpy(buffer + count + got, _queue + _reader, len);
+                asm volatile("" ::: "memory"); // Ensure the values are read before advancing
+                auto next_reader = _reader + len;
+                if (next_reader == _queueSize) {
+                    next_reader = 0;
+                }
+                _reader = next_reader;
+                got += len;
+            }
+        }
+        if (got) {
+            count += got;
+            start = millis();
+        } else if (millis() - start >= _timeout) {
+            break;
+        } else {
+            // Only the RX IRQ can wake us early, with DMA or polling just give up a tick
+            _rxWait.wait((_polling || (_rxDMAChannel >= 0)) ? 1 : _timeout - (millis() - start));
+        }
+    }
+    return count;
+}
+
+size_t SerialUART::peekAvailable() {
+    CoreMutex m(&_mutex);
+    if (!_running || !m) {
+        return 0;
+    }
+    _pumpRX();
+    uint32_t writer = _writer;
+    return ((writer >= _reader) ? writer : _queueSize) - _reader;
+}
+
+const char *SerialUART::peekBuffer() {
+    return (const char *)_queue + _reader;
+}
+
+void SerialUART::peekConsume(size_t consume) {
+    CoreMutex m(&_mutex);
+    if (!_running || !m) {
+        return;
+    }
+    uint32_t writer = _writer;
+    consume = std::min(consume, (size_t)(((writer >= _reader) ? writer : _queueSize) - _reader));
+    auto next_reader = _reader + consume;
+    if (next_reader == _queueSize) {
+        next_reader = 0;
+    }
+    _reader = next_reader;
+}
+
 bool SerialUART::overflow() {
     CoreMutex m(&_mutex);
     if (!_running || !m) {
@@ -287,12 +449,8 @@ int SerialUART::available() {
     if (!_running || !m) {
         return 0;
     }
-    if (_polling) {
-        _handleIRQ(false);
-    } else {
-        _pumpFIFO();
-    }
-    return (_fifoSize + _writer - _reader) % _fifoSize;
+    _pumpRX();
+    return (_queueSize + _writer - _reader) % _queueSize;
 }
 
 int SerialUART::availableForWrite() {
@@ -303,6 +461,9 @@ int SerialUART::availableForWrite() {
     if (_polling) {
         _handleIRQ(false);
     }
+    if (_txQueue) {
+        return (_txFifoSize - 1) - ((_txFifoSize + _txWriter - _txReader) % _txFifoSize);
+    }
     return (uart_is_writable(_uart)) ? 1 : 0;
 }
 
@@ -314,6 +475,13 @@ void SerialUART::flush() {
     if (_polling) {
         _handleIRQ(false);
     }
+    while (_txQueue && (_txReader != _txWriter)) {
+        _txWait.arm();
+        _pumpFIFO();
+        if (_txReader != _txWriter) {
+            _txWait.wait(10);
+        }
+    }
     uart_tx_wait_blocking(_uart);
 }
 
@@ -325,6 +493,10 @@ size_t SerialUART::write(uint8_t c) {
     if (_polling) {
         _handleIRQ(false);
     }
+    if (_txQueue) {
+        _queueTX(&c, 1);
+        return 1;
+    }
     uart_putc_raw(_uart, c);
     return 1;
 }
@@ -337,6 +509,10 @@ size_t SerialUART::write(const uint8_t *p, size_t len) {
     if (_polling) {
         _handleIRQ(false);
     }
+    if (_txQueue) {
+        _queueTX(p, len);
+        return len;
+    }
     size_t cnt = len;
     while (cnt) {
         uart_putc_raw(_uart, *p);
@@ -346,6 +522,30 @@ size_t SerialUART::write(const uint8_t *p, size_t len) {
     return len;
 }
 
+void SerialUART::_queueTX(const uint8_t *p, size_t len) {
+    while (len) {
+        auto next_writer = _txWriter + 1;
+        if (next_writer == _txFifoSize) {
+            next_writer = 0;
+        }
+        if (next_writer == _txReader) {
+            // Queue full, push what we can into the HW FIFO and try again
+            _txWait.arm();
+            _pumpFIFO();
+            if (next_writer == _txReader) {
+                _txWait.wait(10);
+            }
+            continue;
+        }
+        _txQueue[_txWriter] = *p++;
+        asm volatile("" ::: "memory"); // Ensure the queue is written before the written count advances
+        _txWriter = next_writer;
+        len--;
+    }
+    // Prime the HW FIFO ourselves because the PL011 TX IRQ only fires on crossing its trigger level
+    _pumpFIFO();
+}
+
 SerialUART::operator bool() {
     return _running;
 }
@@ -364,6 +564,7 @@ void arduino::serialEvent2Run(void) {
 
 // IRQ handler, called when FIFO > 1/8 full or when it had held unread data for >32 bit times
 void __not_in_flash_func(SerialUART::_handleIRQ)(bool inIRQ) {
+    PROFILE_CORE_SCOPE("SerialUART::_handleIRQ");
     if (inIRQ) {
         uint32_t owner;
         if (!mutex_try_enter(&_fifoMutex, &owner)) {
@@ -372,12 +573,17 @@ void __not_in_flash_func(SerialUART::_handleIRQ)(bool inIRQ) {
             return;
         }
     }
+    if (_txQueue) {
+        _handleTX();
+    }
     // ICR is write-to-clear
     uart_get_hw(_uart)->icr = UART_UARTICR_RTIC_BITS | UART_UARTICR_RXIC_BITS;
-    while (uart_is_readable(_uart)) {
+    bool received = false;
+    while ((_rxDMAChannel < 0) && uart_is_readable(_uart)) {
+        received = true;
         auto val = uart_getc(_uart);
         auto next_writer = _writer + 1;
-        if (next_writer == _fifoSize) {
+        if (next_writer == _queueSize) {
             next_writer = 0;
         }
         if (next_writer != _reader) {
@@ -391,6 +597,32 @@ void __not_in_flash_func(SerialUART::_handleIRQ)(bool inIRQ) {
     }
     if (inIRQ) {
         mutex_exit(&_fifoMutex);
+        if (received) {
+            _rxWait.notify();
+        }
+    }
+}
+
+// Called with the _fifoMutex held, either from the IRQ or from _pumpFIFO with the IRQ disabled
+void __not_in_flash_func(SerialUART::_handleTX)() {
+    bool sent = false;
+    while ((_txReader != _txWriter) && uart_is_writable(_uart)) {
+        sent = true;
+        uart_get_hw(_uart)->dr = _txQueue[_txReader];
+        auto next_reader = _txReader + 1;
+        if (next_reader == _txFifoSize) {
+            next_reader = 0;
+        }
+        asm volatile("" ::: "memory"); // Ensure the value is read before advancing
+        _txReader = next_reader;
+    }
+    if (_txReader != _txWriter) {
+        hw_set_bits(&uart_get_hw(_uart)->imsc, UART_UARTIMSC_TXIM_BITS);
+    } else {
+        hw_clear_bits(&uart_get_hw(_uart)->imsc, UART_UARTIMSC_TXIM_BITS);
+    }
+    if (sent) {
+        _txWait.notify();
     }
 }
 
@@ -415,6 +647,7 @@ SerialUART Serial2(__SERIAL2_DEVICE, PIN_SERIAL2_TX, PIN_SERIAL2_RX);
 
 
 static void __not_in_flash_func(_uart0IRQ)() {
+    CoreLoadScope load(CORELOAD_IRQ);
     if (__SERIAL1_DEVICE == uart0) {
         Serial1._handleIRQ();
     } else {
@@ -423,6 +656,7 @@ static void __not_in_flash_func(_uart0IRQ)() {
 }
 
 static void __not_in_flash_func(_uart1IRQ)() {
+    CoreLoadScope load(CORELOAD_IRQ);
     if (__SERIAL2_DEVICE == uart1) {
         Serial2._handleIRQ();
     } else {
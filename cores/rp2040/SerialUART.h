@@ -25,6 +25,8 @@
 #include <stdarg.h>
 #include <queue>
 #include "CoreMutex.h"
+#include "ClockNotifier.h"
+#include "IRQWait.h"
 
 extern "C" typedef struct uart_inst uart_inst_t;
 
@@ -45,6 +47,8 @@ public:
     }
     bool setFIFOSize(size_t size);
     bool setPollingMode(bool mode = true);
+    bool setRxDMA(bool mode = true);
+    bool setTxFIFOSize(size_t size);
 
     void begin(unsigned long baud = 115200) override {
         begin(baud, SERIAL_8N1);
@@ -60,6 +64,27 @@ public:
     virtual size_t write(uint8_t c) override;
     virtual size_t write(const uint8_t *p, size_t len) override;
     using Print::write;
+    // Bulk read straight out of the receive queue, same timeout semantics as Stream::readBytes
+    size_t readBytes(char *buffer, size_t length) override;
+    size_t readBytes(uint8_t *buffer, size_t length) {
+        return readBytes((char *)buffer, length);
+    }
+
+    // peek buffer API is present
+    virtual bool hasPeekBufferAPI() const override {
+        return true;
+    }
+
+    // return number of bytes accessible by peekBuffer()
+    virtual size_t peekAvailable() override;
+
+    // return a pointer to available data buffer (size = peekAvailable())
+    // semantic forbids any kind of read() before calling peekConsume()
+    virtual const char *peekBuffer() override;
+
+    // consume bytes after use (see peekBuffer)
+    virtual void peekConsume(size_t consume) override;
+
     bool overflow();
     operator bool() override;
 
@@ -79,10 +104,33 @@ private:
     // Lockless, IRQ-handled circular queue
     uint32_t _writer;
     uint32_t _reader;
-    size_t   _fifoSize = 32;
+    size_t   _fifoSize = 32; // As set by setFIFOSize(), plus the unused entry
+    size_t   _queueSize; // Allocated by begin(), rounded up to a power of 2 for DMA
+    size_t   _queueMask; // _queueSize - 1, only with DMA
     uint8_t *_queue;
     mutex_t  _fifoMutex; // Only needed when non-IRQ updates _writer
     void _pumpFIFO(); // User space FIFO transfer
+
+    // Optional DMA receive, writes directly into _queue as a HW ring buffer
+    bool _rxDMA = false;
+    int _rxDMAChannel = -1;
+    uint32_t _rxDMACount; // Transfer count at last _pumpDMA, difference is # of new bytes
+    void _pumpDMA(); // Advance _writer based on DMA progress
+    void _pumpRX(); // Call the appropriate FIFO/DMA pump routine
+    IRQWait _rxWait; // readBytes() blocking on the RX IRQ under FreeRTOS
+
+    // Optional IRQ-drained transmit queue, written only by the app and read only by the IRQ
+    uint32_t _txWriter;
+    uint32_t _txReader;
+    size_t   _txFifoSize = 0;
+    uint8_t *_txQueue = nullptr;
+    void _queueTX(const uint8_t *p, size_t len);
+    void _handleTX();
+    IRQWait _txWait; // Writers blocking on the TX IRQ for room in the queue
+
+    // Drains TX before a system clock change and reprograms the baud rate after it
+    ClockNotifier _clockNotifier{_clockChanged, this};
+    static void _clockChanged(void *arg, bool after);
 };
 
 extern SerialUART Serial1; // HW UART 0
@@ -24,8 +24,12 @@
 
 #include <Arduino.h>
 #include "CoreMutex.h"
+#include "RP2040USB.h"
+#include "PolledTimeout.h"
+#include <algorithm>
 
 #include "tusb.h"
+#include "device/usbd_pvt.h"
 #include "pico/time.h"
 #include "pico/binary_info.h"
 #include "pico/bootrom.h"
@@ -49,6 +53,304 @@ extern void serialEvent() __attribute__((weak));
 
 extern mutex_t __usb_mutex;
 
+// The CDC class driver lives here instead of using TinyUSB's, whose FIFO sizes and
+// port count are fixed when libpico is built.  TinyUSB asks application drivers
+// first, so this one claims the CDC interfaces from the core's descriptor and the
+// one inside libpico never sees them.  Everything below runs with __usb_mutex held,
+// either from the USB task or from the SerialUSB methods.
+
+#define CDC_PACKET (64)
+// IN transfers take up to this much of the TX FIFO, which the controller sends as
+// several packets without waiting for the USB task in between
+#define CDC_IN_XFER (256)
+
+class CDCFifo {
+public:
+    bool begin(size_t size) {
+        _buf = (uint8_t *)malloc(size);
+        _size = _buf ? size : 0;
+        return _buf;
+    }
+    void clear() {
+        _head = 0;
+        _count = 0;
+    }
+    size_t count() const {
+        return _count;
+    }
+    size_t room() const {
+        return _size - _count;
+    }
+    int peek() const {
+        return _count ? _buf[_head] : -1;
+    }
+    size_t write(const uint8_t *p, size_t n) {
+        n = std::min(n, room());
+        size_t tail = (_head + _count) % _size;
+        size_t first = std::min(n, _size - tail);
+        memcpy(_buf + tail, p, first);
+        memcpy(_buf, p + first, n - first);
+        _count += n;
+        return n;
+    }
+    size_t read(uint8_t *p, size_t n) {
+        n = std::min(n, _count);
+        size_t first = std::min(n, _size - _head);
+        memcpy(p, _buf + _head, first);
+        memcpy(p + first, _buf, n - first);
+        _head = (_head + n) % _size;
+        _count -= n;
+        return n;
+    }
+
+private:
+    uint8_t *_buf = nullptr;
+    size_t _size = 0;
+    size_t _head = 0;
+    size_t _count = 0;
+};
+
+typedef struct {
+    uint8_t itf;
+    uint8_t epNotif;
+    uint8_t epIn;
+    uint8_t epOut;
+    bool open;
+    bool outArmed;
+    bool dtr;
+    bool rts;
+    cdc_line_coding_t coding;
+    CDCFifo rx;
+    CDCFifo tx;
+    // millis() at which the USB task flushes a pending streaming-mode partial packet
+    bool flushPending;
+    uint32_t flushAt;
+    // Set while write() waits on a full TX FIFO, giving up after 1s without progress
+    bool txFull;
+    esp8266::polledTimeout::oneShotTimerMs txFullTimeout{1000};
+    CFG_TUSB_MEM_ALIGN uint8_t outBuf[CDC_PACKET];
+    CFG_TUSB_MEM_ALIGN uint8_t inBuf[CDC_IN_XFER];
+} CDCPort;
+
+static CDCPort *__cdc[SERIALUSB_PORTS];
+
+static CDCPort *cdcFromItf(uint8_t itf) {
+    for (auto c : __cdc) {
+        if (c && (c->itf == itf)) {
+            return c;
+        }
+    }
+    return nullptr;
+}
+
+static bool cdcConnected(CDCPort *c) {
+    return c && c->open && c->dtr && tud_ready();
+}
+
+// Waits for another packet from the host, once there's room for all of it
+static void cdcArmOut(CDCPort *c) {
+    if (c->open && !c->outArmed && (c->rx.room() >= CDC_PACKET)) {
+        c->outArmed = usbd_edpt_xfer(0, c->epOut, c->outBuf, CDC_PACKET);
+    }
+}
+
+// Starts the next IN transfer if the endpoint is free.  Returns false if there was nothing to send
+static bool cdcSend(CDCPort *c) {
+    if (!c->open) {
+        return false;
+    }
+    if (usbd_edpt_busy(0, c->epIn)) {
+        return true;
+    }
+    size_t n = c->tx.read(c->inBuf, sizeof(c->inBuf));
+    if (!n) {
+        return false;
+    }
+    usbd_edpt_xfer(0, c->epIn, c->inBuf, n);
+    return true;
+}
+
+static void cdcLineChanged(CDCPort *c) {
+    // The 1200bps touch reboots into the bootloader, only on the port the IDE uploads through
+    if ((c == __cdc[0]) && (c->coding.bit_rate == 1200) && !c->dtr) {
+        reset_usb_boot(0, 0);
+        while (1); // WDT will fire here
+    }
+}
+
+static void cdcInit() {
+    for (int i = 0; i < SERIALUSB_PORTS; i++) {
+        int itf = __USBGetSerialInterface(i);
+        if (__cdc[i] || (itf < 0)) {
+            continue;
+        }
+        CDCPort *c = new CDCPort();
+        if (!c->rx.begin(SERIALUSB_RX_FIFO) || !c->tx.begin(SERIALUSB_TX_FIFO)) {
+            DEBUGCORE("SerialUSB: no memory for port %d FIFOs\n", i);
+            delete c;
+            continue;
+        }
+        c->itf = itf;
+        c->coding.bit_rate = 115200;
+        c->coding.data_bits = 8;
+        __cdc[i] = c;
+    }
+}
+
+static void cdcReset(uint8_t rhport) {
+    (void) rhport;
+    for (auto c : __cdc) {
+        if (c) {
+            c->open = false;
+            c->outArmed = false;
+            c->dtr = false;
+            c->rts = false;
+            c->rx.clear();
+            c->tx.clear();
+        }
+    }
+}
+
+static uint16_t cdcOpen(uint8_t rhport, tusb_desc_interface_t const *desc, uint16_t max_len) {
+    if ((desc->bInterfaceClass != TUSB_CLASS_CDC) || (desc->bInterfaceSubClass != CDC_COMM_SUBCLASS_ABSTRACT_CONTROL_MODEL)) {
+        return 0;
+    }
+    CDCPort *c = cdcFromItf(desc->bInterfaceNumber);
+    if (!c) {
+        return 0;
+    }
+
+    // Communication interface, its functional descriptors and the notification endpoint
+    uint8_t const *p = (uint8_t const *)desc;
+    uint8_t const *end = p + max_len;
+    p = tu_desc_next(p);
+    while ((p < end) && (tu_desc_type(p) == TUSB_DESC_CS_INTERFACE)) {
+        p = tu_desc_next(p);
+    }
+    if ((p < end) && (tu_desc_type(p) == TUSB_DESC_ENDPOINT)) {
+        if (!usbd_edpt_open(rhport, (tusb_desc_endpoint_t const *)p)) {
+            return 0;
+        }
+        c->epNotif = ((tusb_desc_endpoint_t const *)p)->bEndpointAddress;
+        p = tu_desc_next(p);
+    }
+
+    // Data interface and its bulk pair
+    if ((p >= end) || (tu_desc_type(p) != TUSB_DESC_INTERFACE) || (((tusb_desc_interface_t const *)p)->bInterfaceClass != TUSB_CLASS_CDC_DATA)) {
+        return 0;
+    }
+    p = tu_desc_next(p);
+    if (!usbd_open_edpt_pair(rhport, p, 2, TUSB_XFER_BULK, &c->epOut, &c->epIn)) {
+        return 0;
+    }
+    p += 2 * sizeof(tusb_desc_endpoint_t);
+
+    c->open = true;
+    cdcArmOut(c);
+    return p - (uint8_t const *)desc;
+}
+
+static bool cdcControl(uint8_t rhport, uint8_t stage, tusb_control_request_t const *req) {
+    if (req->bmRequestType_bit.type != TUSB_REQ_TYPE_CLASS) {
+        return false;
+    }
+    CDCPort *c = cdcFromItf((uint8_t)req->wIndex);
+    if (!c) {
+        return false;
+    }
+    switch (req->bRequest) {
+    case CDC_REQUEST_SET_LINE_CODING:
+        if (stage == CONTROL_STAGE_SETUP) {
+            tud_control_xfer(rhport, req, &c->coding, sizeof(c->coding));
+        } else if (stage == CONTROL_STAGE_ACK) {
+            cdcLineChanged(c);
+        }
+        return true;
+    case CDC_REQUEST_GET_LINE_CODING:
+        if (stage == CONTROL_STAGE_SETUP) {
+            tud_control_xfer(rhport, req, &c->coding, sizeof(c->coding));
+        }
+        return true;
+    case CDC_REQUEST_SET_CONTROL_LINE_STATE:
+        if (stage == CONTROL_STAGE_SETUP) {
+            tud_control_status(rhport, req);
+        } else if (stage == CONTROL_STAGE_ACK) {
+            c->dtr = req->wValue & 1;
+            c->rts = req->wValue & 2;
+            cdcLineChanged(c);
+        }
+        return true;
+    case CDC_REQUEST_SEND_BREAK:
+        if (stage == CONTROL_STAGE_SETUP) {
+            tud_control_status(rhport, req);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool cdcXfer(uint8_t rhport, uint8_t ep, xfer_result_t result, uint32_t xferred) {
+    (void) result;
+    for (auto c : __cdc) {
+        if (!c || !c->open) {
+            continue;
+        }
+        if (ep == c->epOut) {
+            c->outArmed = false;
+            c->rx.write(c->outBuf, xferred);
+            cdcArmOut(c);
+            return true;
+        } else if (ep == c->epIn) {
+            // A transfer ending on a full packet needs a ZLP so the host hands the data over
+            if (!cdcSend(c) && xferred && !(xferred & (CDC_PACKET - 1))) {
+                usbd_edpt_xfer(rhport, c->epIn, nullptr, 0);
+            }
+            return true;
+        } else if (ep == c->epNotif) {
+            return true;
+        }
+    }
+    return false;
+}
+
+extern const usbd_class_driver_t __USBCDCDriver = {
+#if CFG_TUSB_DEBUG >= 2
+    .name = "SerialUSB",
+#endif
+    .init = cdcInit,
+    .reset = cdcReset,
+    .open = cdcOpen,
+    .control_xfer_cb = cdcControl,
+    .xfer_cb = cdcXfer,
+};
+
+// Called from the USB task with __usb_mutex held.  Returns ms until it needs to run again, 0 for never
+uint32_t __USBSerialTask() {
+    uint32_t next = 0;
+    for (auto c : __cdc) {
+        if (!c || !c->flushPending) {
+            continue;
+        }
+        int32_t left = (int32_t)(c->flushAt - millis());
+        if (left > 0) {
+            next = next ? std::min(next, (uint32_t)left) : left;
+        } else {
+            c->flushPending = false;
+            cdcSend(c);
+        }
+    }
+    return next;
+}
+
+void SerialUSB::setStreamingMode(bool mode) {
+    _streaming = mode;
+}
+
+void SerialUSB::setFlushLatency(uint32_t ms) {
+    _flushLatency = ms ? ms : 1;
+}
+
 void SerialUSB::begin(unsigned long baud) {
     (void) baud; //ignored
 
@@ -56,6 +358,7 @@ void SerialUSB::begin(unsigned long baud) {
         return;
     }
 
+    __USBStart(); // Only does anything the first time, with fast_boot
     _running = true;
 }
 
@@ -65,12 +368,11 @@ void SerialUSB::end() {
 
 int SerialUSB::peek() {
     CoreMutex m(&__usb_mutex, false);
-    if (!_running || !m) {
+    if (!_running || !m || !__cdc[_port]) {
         return 0;
     }
 
-    uint8_t c;
-    return tud_cdc_peek(&c) ? (int) c : -1;
+    return __cdc[_port]->rx.peek();
 }
 
 int SerialUSB::read() {
@@ -79,37 +381,41 @@ int SerialUSB::read() {
         return -1;
     }
 
-    if (tud_cdc_connected() && tud_cdc_available()) {
-        return tud_cdc_read_char();
+    CDCPort *c = __cdc[_port];
+    uint8_t ch;
+    if (cdcConnected(c) && c->rx.read(&ch, 1)) {
+        cdcArmOut(c);
+        return ch;
     }
     return -1;
 }
 
 int SerialUSB::available() {
     CoreMutex m(&__usb_mutex, false);
-    if (!_running || !m) {
+    if (!_running || !m || !__cdc[_port]) {
         return 0;
     }
 
-    return tud_cdc_available();
+    return __cdc[_port]->rx.count();
 }
 
 int SerialUSB::availableForWrite() {
     CoreMutex m(&__usb_mutex, false);
-    if (!_running || !m) {
+    if (!_running || !m || !__cdc[_port]) {
         return 0;
     }
 
-    return tud_cdc_write_available();
+    return __cdc[_port]->tx.room();
 }
 
 void SerialUSB::flush() {
     CoreMutex m(&__usb_mutex, false);
-    if (!_running || !m) {
+    if (!_running || !m || !__cdc[_port]) {
         return;
     }
 
-    tud_cdc_write_flush();
+    __cdc[_port]->flushPending = false;
+    cdcSend(__cdc[_port]);
 }
 
 size_t SerialUSB::write(uint8_t c) {
@@ -122,34 +428,50 @@ size_t SerialUSB::write(const uint8_t *buf, size_t length) {
         return 0;
     }
 
-    static uint64_t last_avail_time;
+    CDCPort *c = __cdc[_port];
     int written = 0;
-    if (tud_cdc_connected()) {
+    if (cdcConnected(c)) {
         for (size_t i = 0; i < length;) {
-            int n = length - i;
-            int avail = tud_cdc_write_available();
-            if (n > avail) {
-                n = avail;
-            }
+            int n = c->tx.write(buf + i, length - i);
             if (n) {
-                int n2 = tud_cdc_write(buf + i, n);
-                tud_task();
-                tud_cdc_write_flush();
-                i += n2;
-                written += n2;
-                last_avail_time = time_us_64();
+                if (!_streaming) {
+                    tud_task();
+                    cdcSend(c);
+                } else if (c->tx.count() >= CDC_PACKET) {
+                    cdcSend(c);
+                }
+                i += n;
+                written += n;
+                c->txFull = false;
             } else {
+                // FIFO is full, so we need to push data out to make progress
+                __usbIRQWait.arm();
                 tud_task();
-                tud_cdc_write_flush();
-                if (!tud_cdc_connected() ||
-                        (!tud_cdc_write_available() && time_us_64() > last_avail_time + 1000000 /* 1 second */)) {
+                cdcSend(c);
+                if (!cdcConnected(c)) {
                     break;
                 }
+                if (!c->tx.room()) {
+                    if (!c->txFull) {
+                        c->txFullTimeout.reset();
+                        c->txFull = true;
+                    } else if (c->txFullTimeout) {
+                        break;
+                    }
+                    // Under FreeRTOS, sleep until the host has taken a packet
+                    __usbIRQWait.wait(1);
+                }
             }
         }
-    } else {
+        if (_streaming && written && !c->flushPending) {
+            // Full packets are already on their way, the USB task will send any leftover partial one
+            c->flushAt = millis() + _flushLatency;
+            c->flushPending = true;
+            __USBWakeTask(_flushLatency);
+        }
+    } else if (c) {
         // reset our timeout
-        last_avail_time = 0;
+        c->txFull = false;
     }
     return written;
 }
@@ -161,31 +483,7 @@ SerialUSB::operator bool() {
     }
 
     tud_task();
-    return tud_cdc_connected();
-}
-
-
-static bool _dtr = false;
-static bool _rts = false;
-static int _bps = 115200;
-static void CheckSerialReset() {
-    if ((_bps == 1200) && (!_dtr)) {
-        reset_usb_boot(0, 0);
-        while (1); // WDT will fire here
-    }
-}
-
-extern "C" void tud_cdc_line_state_cb(uint8_t itf, bool dtr, bool rts) {
-    (void) itf;
-    _dtr = dtr ? true : false;
-    _rts = rts ? true : false;
-    CheckSerialReset();
-}
-
-extern "C" void tud_cdc_line_coding_cb(uint8_t itf, cdc_line_coding_t const* p_line_coding) {
-    (void) itf;
-    _bps = p_line_coding->bit_rate;
-    CheckSerialReset();
+    return cdcConnected(__cdc[_port]);
 }
 
 SerialUSB Serial;
@@ -24,9 +24,21 @@
 #include "api/HardwareSerial.h"
 #include <stdarg.h>
 
+// CDC ports the built-in USB stack can provide: Serial, SerialUSB1 and SerialUSB2.  Each
+// one only appears on the bus when the sketch refers to it
+#define SERIALUSB_PORTS 3
+
+// RX and TX FIFO bytes per port, set from the "USB CDC FIFO" menu
+#ifndef SERIALUSB_RX_FIFO
+#define SERIALUSB_RX_FIFO 256
+#endif
+#ifndef SERIALUSB_TX_FIFO
+#define SERIALUSB_TX_FIFO 256
+#endif
+
 class SerialUSB : public HardwareSerial {
 public:
-    SerialUSB() { }
+    SerialUSB(uint8_t port = 0) : _port(port) { }
     void begin(unsigned long baud = 115200) override;
     void begin(unsigned long baud, uint16_t config) override {
         (void) config;
@@ -44,11 +56,21 @@ public:
     using Print::write;
     operator bool() override;
 
+    // Streaming mode lets write() fill the CDC FIFO without forcing a short USB packet each call.
+    // Any partial packet is sent by the USB task after the flush latency, or by an explicit flush().
+    void setStreamingMode(bool mode = true);
+    void setFlushLatency(uint32_t ms);
+
 private:
+    uint8_t _port;
     bool _running = false;
+    bool _streaming = false;
+    uint32_t _flushLatency = 1; // ms
 };
 
 extern SerialUSB Serial;
+extern SerialUSB SerialUSB1;
+extern SerialUSB SerialUSB2;
 
 namespace arduino {
 extern void serialEventRun(void) __attribute__((weak));
@@ -0,0 +1,30 @@
+/*
+    Additional Serial-Over-USB port, only added to the USB configuration when used
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#if !defined(USE_TINYUSB) && !defined(NO_USB)
+
+#include <Arduino.h>
+
+// Referring to SerialUSB2 links in this file, which installs the port in the USB chain
+void __USBInstallSerial2() { /* noop */ }
+
+SerialUSB SerialUSB2(2);
+
+#endif
@@ -0,0 +1,155 @@
+/*
+    Low power sleep and dormant modes
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <hardware/clocks.h>
+#include <hardware/pll.h>
+#include <hardware/xosc.h>
+#include <hardware/structs/rosc.h>
+#include <hardware/structs/scb.h>
+#include <hardware/sync.h>
+#include <pico/time.h>
+#include "ClockNotifier.h"
+#include "RP2040USB.h"
+
+#ifndef XOSC_MHZ
+#define XOSC_MHZ 12
+#endif
+
+static int64_t _wake(__unused alarm_id_t id, __unused void *user_data) {
+    return 0; // Only here to raise the timer IRQ
+}
+
+static void _sleepUntil(absolute_time_t until) {
+    alarm_id_t a = add_alarm_at(until, _wake, nullptr, false);
+    while (!time_reached(until)) {
+        __wfi();
+    }
+    if (a > 0) {
+        cancel_alarm(a);
+    }
+}
+
+// Clocks left running by lightSleep once both cores are in WFI: the timer (and the
+// watchdog tick feeding it), GPIO for pin interrupts, the UARTs so received data still
+// arrives, and USB so the host doesn't drop the device
+void __lightSleep(uint32_t ms) {
+    if (__isFreeRTOS) {
+        delay(ms); // The FreeRTOS tick comes from SysTick, which stops in deep sleep
+        return;
+    }
+    uint32_t en0 = clocks_hw->sleep_en0;
+    uint32_t en1 = clocks_hw->sleep_en1;
+    clocks_hw->sleep_en0 = CLOCKS_SLEEP_EN0_CLK_SYS_PLL_USB_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_PLL_SYS_BITS |
+                           CLOCKS_SLEEP_EN0_CLK_SYS_PADS_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_IO_BITS |
+                           CLOCKS_SLEEP_EN0_CLK_SYS_CLOCKS_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_BUSFABRIC_BITS;
+    clocks_hw->sleep_en1 = CLOCKS_SLEEP_EN1_CLK_SYS_XOSC_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_TIMER_BITS |
+                           CLOCKS_SLEEP_EN1_CLK_SYS_WATCHDOG_BITS |
+                           CLOCKS_SLEEP_EN1_CLK_SYS_UART0_BITS | CLOCKS_SLEEP_EN1_CLK_PERI_UART0_BITS |
+                           CLOCKS_SLEEP_EN1_CLK_SYS_UART1_BITS | CLOCKS_SLEEP_EN1_CLK_PERI_UART1_BITS |
+                           CLOCKS_SLEEP_EN1_CLK_SYS_USBCTRL_BITS | CLOCKS_SLEEP_EN1_CLK_USB_USBCTRL_BITS |
+                           CLOCKS_SLEEP_EN1_CLK_SYS_SRAM0_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_SRAM1_BITS |
+                           CLOCKS_SLEEP_EN1_CLK_SYS_SRAM2_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_SRAM3_BITS |
+                           CLOCKS_SLEEP_EN1_CLK_SYS_SRAM4_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_SRAM5_BITS;
+    uint32_t scr = scb_hw->scr;
+    scb_hw->scr = scr | M0PLUS_SCR_SLEEPDEEP_BITS;
+    _sleepUntil(make_timeout_time_ms(ms));
+    scb_hw->scr = scr;
+    clocks_hw->sleep_en0 = en0;
+    clocks_hw->sleep_en1 = en1;
+}
+
+static void _rosc(bool on) {
+    hw_write_masked(&rosc_hw->ctrl, (on ? ROSC_CTRL_ENABLE_VALUE_ENABLE : ROSC_CTRL_ENABLE_VALUE_DISABLE) << ROSC_CTRL_ENABLE_LSB,
+                    ROSC_CTRL_ENABLE_BITS);
+}
+
+// Everything onto the crystal and both PLLs off.  clk_ref stays at the same rate, so the
+// timer (and millis()) keeps counting correctly
+static void _runFromXOSC() {
+    clock_configure(clk_ref, CLOCKS_CLK_REF_CTRL_SRC_VALUE_XOSC_CLKSRC, 0, XOSC_MHZ * MHZ, XOSC_MHZ * MHZ);
+    clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLK_REF, 0, XOSC_MHZ * MHZ, XOSC_MHZ * MHZ);
+    clock_stop(clk_usb);
+    clock_stop(clk_adc);
+    clock_configure(clk_rtc, 0, CLOCKS_CLK_RTC_CTRL_AUXSRC_VALUE_XOSC_CLKSRC, XOSC_MHZ * MHZ, 46875);
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS, XOSC_MHZ * MHZ, XOSC_MHZ * MHZ);
+    pll_deinit(pll_sys);
+    pll_deinit(pll_usb);
+    _rosc(false);
+}
+
+static void _sleep(void *arg) {
+    absolute_time_t until = *(absolute_time_t *)arg;
+    _runFromXOSC();
+    _sleepUntil(until);
+    _rosc(true);
+}
+
+bool __sleep(uint32_t ms) {
+    if (__isFreeRTOS) {
+        return false;
+    }
+    absolute_time_t until = make_timeout_time_ms(ms);
+    if (__USBSuspend) {
+        __USBSuspend(true);
+    }
+    bool ret = __sysClockStop(_sleep, &until);
+    if (__USBSuspend) {
+        __USBSuspend(false);
+    }
+    return ret;
+}
+
+static void _dormant(void *arg) {
+    uint pin = *(uint *)arg >> 8;
+    uint32_t events = *(uint *)arg & 0xff;
+    uint32_t irqs = save_and_disable_interrupts();
+    _runFromXOSC();
+    gpio_set_dormant_irq_enabled(pin, events, true);
+    xosc_dormant(); // Execution stops here until the pin event
+    gpio_acknowledge_irq(pin, events);
+    gpio_set_dormant_irq_enabled(pin, events, false);
+    _rosc(true);
+    restore_interrupts(irqs);
+}
+
+bool __dormantUntilPin(pin_size_t pin, PinStatus mode) {
+    uint32_t events;
+    switch (mode) {
+    case LOW:     events = 1; break;
+    case HIGH:    events = 2; break;
+    case FALLING: events = 4; break;
+    case RISING:  events = 8; break;
+    case CHANGE:  events = 4 | 8; break;
+    default:      return false;
+    }
+    if (__isFreeRTOS || (pin >= NUM_BANK0_GPIOS)) {
+        return false;
+    }
+    uint arg = (pin << 8) | events;
+    if (__USBSuspend) {
+        __USBSuspend(true);
+    }
+    bool ret = __sysClockStop(_dormant, &arg);
+    if (__USBSuspend) {
+        __USBSuspend(false);
+    }
+    return ret;
+}
@@ -110,26 +110,17 @@ public:
         // nothing to do
     }
 
-#if 0
-    virtual bool inputCanTimeout() override {
-        return false;
-    }
-
-    virtual bool outputCanTimeout() override {
-        return false;
-    }
-
     //// Stream's peekBufferAPI
 
     virtual bool hasPeekBufferAPI() const override {
         return true;
     }
 
-    virtual size_t peekAvailable() {
+    virtual size_t peekAvailable() override {
         if (peekPointer < 0) {
             return string->length();
         }
-        return string->length() - peekPointer;
+        return peekPointer < (int)string->length() ? string->length() - peekPointer : 0;
     }
 
     virtual const char* peekBuffer() override {
@@ -152,6 +143,15 @@ public:
         }
     }
 
+#if 0
+    virtual bool inputCanTimeout() override {
+        return false;
+    }
+
+    virtual bool outputCanTimeout() override {
+        return false;
+    }
+
     virtual ssize_t streamRemaining() override {
         return peekPointer < 0 ? string->length() : string->length() - peekPointer;
     }
@@ -0,0 +1,287 @@
+/*
+    Hierarchical timer wheel for large numbers of microsecond software timers
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <hardware/irq.h>
+#include <hardware/timer.h>
+#include <pico/time.h>
+#include "TimerWheel.h"
+
+// Timers further out than this are filed at the top level and re-filed when it comes round
+static constexpr uint64_t _maxDelta = (1ULL << (6 * TIMERWHEEL_LEVELS)) - 1;
+
+TimerWheelClass TimerWheel;
+
+void SoftTimer::start(uint64_t us, uint64_t periodUs) {
+    TimerWheel._start(this, time_us_64() + us, periodUs);
+}
+
+void SoftTimer::startAt(uint64_t timeUs, uint64_t periodUs) {
+    TimerWheel._start(this, timeUs, periodUs);
+}
+
+void SoftTimer::stop() {
+    if (active()) {
+        TimerWheel._stop(this);
+    }
+}
+
+TimerWheelClass::TimerWheelClass() {
+    _lock = spin_lock_instance(next_striped_spin_lock_num());
+}
+
+bool TimerWheelClass::begin(bool fromIRQ) {
+    if (fromIRQ == _fromIRQ) {
+        return true;
+    }
+    if (!fromIRQ) {
+        end();
+        return true;
+    }
+    _alarm = hardware_alarm_claim_unused(false);
+    if (_alarm < 0) {
+        return false;
+    }
+    _irqNum = user_irq_claim_unused(false);
+    if (_irqNum < 0) {
+        hardware_alarm_unclaim(_alarm);
+        _alarm = -1;
+        return false;
+    }
+    irq_set_exclusive_handler(_irqNum, _irq);
+    irq_set_priority(_irqNum, PICO_LOWEST_IRQ_PRIORITY);
+    irq_set_enabled(_irqNum, true);
+    hardware_alarm_set_callback(_alarm, _alarmCB);
+    uint32_t irqs = spin_lock_blocking(_lock);
+    _fromIRQ = true;
+    _armedAt = UINT64_MAX;
+    _rearm();
+    spin_unlock(_lock, irqs);
+    return true;
+}
+
+// Back to running the callbacks from the main loop, the timers themselves keep going
+void TimerWheelClass::end() {
+    if (!_fromIRQ) {
+        return;
+    }
+    uint32_t irqs = spin_lock_blocking(_lock);
+    _fromIRQ = false;
+    spin_unlock(_lock, irqs);
+    hardware_alarm_set_callback(_alarm, nullptr);
+    hardware_alarm_unclaim(_alarm);
+    _alarm = -1;
+    irq_set_enabled(_irqNum, false);
+    irq_remove_handler(_irqNum, _irq);
+    user_irq_unclaim(_irqNum);
+    _irqNum = -1;
+}
+
+void TimerWheelClass::service() {
+    if (_fromIRQ || (time_us_64() < _nextAt)) {
+        return;
+    }
+    _run(time_us_64());
+}
+
+void TimerWheelClass::_start(SoftTimer *t, uint64_t expires, uint64_t period) {
+    uint32_t irqs = spin_lock_blocking(_lock);
+    if (t->active()) {
+        _remove(t);
+    }
+    if (!_count) {
+        // Nothing to catch up on, so skip straight to the present
+        uint64_t now = time_us_64();
+        if (now > _now) {
+            _now = now;
+        }
+    }
+    t->_expires = expires;
+    t->_period = period;
+    _insert(t);
+    _nextAt = _nextEvent();
+    _rearm();
+    spin_unlock(_lock, irqs);
+}
+
+void TimerWheelClass::_stop(SoftTimer *t) {
+    uint32_t irqs = spin_lock_blocking(_lock);
+    if (t->active()) {
+        _remove(t);
+    }
+    // _nextAt is left alone, at worst there is one early wake-up with nothing to do
+    spin_unlock(_lock, irqs);
+}
+
+// Level L holds timers due in [64^L, 64^(L+1)) us, in the slot of their 64^L us window.  A
+// slot is moved down a level (cascaded) when the wheel reaches its window
+void TimerWheelClass::_insert(SoftTimer *t) {
+    uint64_t delta = (t->_expires > _now) ? t->_expires - _now : 0;
+    if (delta > _maxDelta) {
+        delta = _maxDelta;
+    }
+    uint64_t when = _now + delta;
+    int level = 0;
+    while ((level < TIMERWHEEL_LEVELS - 1) && (delta >> (6 * (level + 1)))) {
+        level++;
+    }
+    int slot = (when >> (6 * level)) & 63;
+    SoftTimer **head = &_slots[level][slot];
+    t->_next = *head;
+    if (t->_next) {
+        t->_next->_pprev = &t->_next;
+    }
+    *head = t;
+    t->_pprev = head;
+    t->_level = level;
+    t->_slot = slot;
+    _used[level] |= 1ULL << slot;
+    _count = _count + 1;
+}
+
+void TimerWheelClass::_remove(SoftTimer *t) {
+    *t->_pprev = t->_next;
+    if (t->_next) {
+        t->_next->_pprev = t->_pprev;
+    }
+    if (!_slots[t->_level][t->_slot]) {
+        _used[t->_level] &= ~(1ULL << t->_slot);
+    }
+    t->_next = nullptr;
+    t->_pprev = nullptr;
+    _count = _count - 1;
+}
+
+// _now has just reached a 64us boundary.  Each level whose index is 0 there has wrapped, so
+// the level above it has reached a new window too
+void TimerWheelClass::_cascade() {
+    for (int level = 1; level < TIMERWHEEL_LEVELS; level++) {
+        int idx = (_now >> (6 * level)) & 63;
+        SoftTimer *t = _slots[level][idx];
+        _slots[level][idx] = nullptr;
+        _used[level] &= ~(1ULL << idx);
+        while (t) {
+            SoftTimer *next = t->_next;
+            _count = _count - 1;
+            _insert(t);
+            t = next;
+        }
+        if (idx) {
+            break;
+        }
+    }
+}
+
+// The earliest time anything happens: a level 0 slot coming due, or a higher level slot
+// being cascaded.  O(levels), using the slot bitmaps
+uint64_t TimerWheelClass::_nextEvent() {
+    if (_slots[0][_now & 63]) {
+        return _now;
+    }
+    uint64_t best = UINT64_MAX;
+    for (int level = 0; level < TIMERWHEEL_LEVELS; level++) {
+        if (!_used[level]) {
+            continue;
+        }
+        int shift = 6 * level;
+        int rot = (((_now >> shift) & 63) + 1) & 63;
+        uint64_t r = rot ? ((_used[level] >> rot) | (_used[level] << (64 - rot))) : _used[level];
+        uint64_t d = __builtin_ctzll(r) + 1; // Slots ahead of the current one, 64 = full turn
+        uint64_t when = level ? (((_now >> shift) + d) << shift) : _now + d;
+        if (when < best) {
+            best = when;
+        }
+    }
+    return best;
+}
+
+void TimerWheelClass::_run(uint64_t until) {
+    uint32_t irqs = spin_lock_blocking(_lock);
+    while (true) {
+        SoftTimer *t = _slots[0][_now & 63];
+        if (t) {
+            _remove(t);
+            if (t->_period) {
+                uint64_t next = t->_expires + t->_period;
+                if (next <= _now) {
+                    // Fell behind, skip the missed periods instead of running them all
+                    next += ((_now - next) / t->_period + 1) * t->_period;
+                }
+                t->_expires = next;
+                _insert(t);
+            }
+            SoftTimer::Callback cb = t->_cb;
+            void *arg = t->_arg;
+            spin_unlock(_lock, irqs);
+            if (cb) {
+                cb(arg);
+            }
+            irqs = spin_lock_blocking(_lock);
+            continue;
+        }
+        uint64_t next = _nextEvent();
+        if (next > until) {
+            // Nothing due in between, so no cascades are skipped
+            if (until > _now) {
+                _now = until;
+            }
+            break;
+        }
+        _now = next;
+        if (!(_now & 63)) {
+            _cascade();
+        }
+    }
+    _nextAt = _nextEvent();
+    spin_unlock(_lock, irqs);
+}
+
+// Called with _lock held.  The alarm may be reprogrammed from either core, but its IRQ
+// stays on the core which called begin()
+void TimerWheelClass::_rearm() {
+    if (!_fromIRQ || (_nextAt == _armedAt)) {
+        return;
+    }
+    _armedAt = _nextAt;
+    if (_nextAt == UINT64_MAX) {
+        hardware_alarm_cancel(_alarm);
+    } else if (hardware_alarm_set_target(_alarm, from_us_since_boot(_nextAt))) {
+        // Already passed
+        hardware_alarm_force_irq(_alarm);
+    }
+}
+
+void __not_in_flash_func(TimerWheelClass::_alarmCB)(unsigned alarm) {
+    (void) alarm;
+    irq_set_pending(TimerWheel._irqNum);
+}
+
+void TimerWheelClass::_irq() {
+    CoreLoadScope load(CORELOAD_IRQ);
+    TimerWheel._run(time_us_64());
+    uint32_t irqs = spin_lock_blocking(TimerWheel._lock);
+    TimerWheel._armedAt = UINT64_MAX;
+    TimerWheel._rearm();
+    spin_unlock(TimerWheel._lock, irqs);
+}
+
+void __timerService() {
+    TimerWheel.service();
+}
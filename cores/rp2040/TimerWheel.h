@@ -0,0 +1,120 @@
+/*
+    Hierarchical timer wheel for large numbers of microsecond software timers
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <hardware/sync.h>
+
+// Each level has 64 slots of 64x the previous level's span, starting at 1us.  Five levels
+// cover 2^30us (about 18 minutes); longer timers are simply re-filed when they get there
+#ifndef TIMERWHEEL_LEVELS
+#define TIMERWHEEL_LEVELS 5
+#endif
+
+// One timer, owned by the caller and linked into the wheel while running, so there is no
+// limit on how many can be used and nothing is allocated.  start() and stop() are O(1) and
+// may be called from any core or IRQ, including from the timer's own callback.
+class SoftTimer {
+public:
+    typedef void (*Callback)(void *arg);
+
+    SoftTimer(Callback cb = nullptr, void *arg = nullptr) : _cb(cb), _arg(arg) { }
+    ~SoftTimer() {
+        stop();
+    }
+    SoftTimer(const SoftTimer &) = delete;
+    SoftTimer &operator=(const SoftTimer &) = delete;
+
+    // Only while stopped
+    void attach(Callback cb, void *arg) {
+        _cb = cb;
+        _arg = arg;
+    }
+
+    // Fires once us microseconds from now, then every periodUs if that isn't 0.  Restarts
+    // the timer if it is already running
+    void start(uint64_t us, uint64_t periodUs = 0);
+    // The same, at an absolute time_us_64() value
+    void startAt(uint64_t timeUs, uint64_t periodUs = 0);
+    // The callback may still be running (from an IRQ or the other core) when this returns
+    void stop();
+
+    bool active() const {
+        return _pprev != nullptr;
+    }
+
+private:
+    friend class TimerWheelClass;
+    Callback _cb;
+    void *_arg;
+    uint64_t _expires = 0;
+    uint64_t _period = 0;
+    SoftTimer *_next = nullptr;
+    SoftTimer **_pprev = nullptr; // The pointer to us, in a slot or the previous timer
+    uint8_t _level;
+    uint8_t _slot;
+};
+
+// Runs the callbacks of every started SoftTimer.  By default they're called from the main
+// loop, between loop() iterations, so they need no locking against the sketch.  begin(true)
+// calls them from a lowest priority IRQ on the calling core instead, woken by one hardware
+// alarm at the earliest expiry, so they're on time even when loop() is slow
+class TimerWheelClass {
+public:
+    TimerWheelClass();
+
+    bool begin(bool fromIRQ = false);
+    void end();
+
+    // Timers currently running
+    uint32_t count() {
+        return _count;
+    }
+
+    // Called from __loop()
+    void service();
+
+private:
+    friend class SoftTimer;
+    void _start(SoftTimer *t, uint64_t expires, uint64_t period);
+    void _stop(SoftTimer *t);
+    void _insert(SoftTimer *t);
+    void _remove(SoftTimer *t);
+    void _cascade();
+    uint64_t _nextEvent();
+    void _run(uint64_t until);
+    void _rearm();
+    static void _alarmCB(unsigned alarm);
+    static void _irq();
+
+    spin_lock_t *_lock;
+    SoftTimer *_slots[TIMERWHEEL_LEVELS][64] = {};
+    uint64_t _used[TIMERWHEEL_LEVELS] = {}; // Bit per non-empty slot
+    uint64_t _now = 0; // Everything due up to here has been run
+    volatile uint64_t _nextAt = UINT64_MAX;
+    uint64_t _armedAt = UINT64_MAX;
+    volatile uint32_t _count = 0;
+    bool _fromIRQ = false;
+    int _alarm = -1;
+    int _irqNum = -1;
+};
+
+extern TimerWheelClass TimerWheel;
@@ -28,6 +28,7 @@ typedef struct {
     pin_size_t pin;
     PIO pio;
     int sm;
+    int us;
     alarm_id_t alarm;
 } Tone;
 
@@ -38,6 +39,23 @@ auto_init_mutex(_toneMutex);
 static PIOProgram _tone2Pgm(&tone2_program);
 static std::map<pin_size_t, Tone *> _toneMap;
 
+// Running tones get their half-period recomputed on a system clock change
+static void _toneClockChanged(void *arg, bool after) {
+    (void) arg;
+    if (!after) {
+        return;
+    }
+    CoreMutex m(&_toneMutex);
+    if (!m) {
+        return;
+    }
+    for (auto &t : _toneMap) {
+        pio_sm_clear_fifos(t.second->pio, t.second->sm);
+        pio_sm_put(t.second->pio, t.second->sm, RP2040::usToPIOCycles(t.second->us));
+    }
+}
+static ClockNotifier _toneClock(_toneClockChanged, nullptr);
+
 int64_t _stopTonePIO(alarm_id_t id, void *user_data) {
     (void) id;
     Tone *tone = (Tone *)user_data;
@@ -56,6 +74,8 @@ void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
         return;
     }
 
+    _toneClock.attach();
+
     // Ensure only 1 core can start or stop at a time
     CoreMutex m(&_toneMutex);
     if (!m) {
@@ -88,6 +108,7 @@ void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
             newTone->alarm = 0;
         }
     }
+    newTone->us = us;
     pio_sm_clear_fifos(newTone->pio, newTone->sm); // Remove any old updates that haven't yet taken effect
     pio_sm_put_blocking(newTone->pio, newTone->sm, RP2040::usToPIOCycles(us));
     pio_sm_set_enabled(newTone->pio, newTone->sm, true);
@@ -119,7 +140,7 @@ void noTone(uint8_t pin) {
             entry->second->alarm = 0;
         }
         pio_sm_set_enabled(entry->second->pio, entry->second->sm, false);
-        pio_sm_unclaim(entry->second->pio, entry->second->sm);
+        PIOProgram::unprepare(entry->second->pio, entry->second->sm);
         delete entry->second;
         _toneMap.erase(entry);
         pinMode(pin, OUTPUT);
@@ -0,0 +1,279 @@
+/*
+    High-rate vendor-class bulk endpoints for the built-in USB stack
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#if !defined(USE_TINYUSB) && !defined(NO_USB)
+
+#include <Arduino.h>
+#include "CoreMutex.h"
+#include "RP2040USB.h"
+#include "USBBulk.h"
+#include <algorithm>
+
+#include "tusb.h"
+#include "device/usbd_pvt.h"
+
+// Referring to USBBulk links in this file, which installs the interface in the USB chain
+void __USBInstallBulk() { /* noop */ }
+
+// Each direction has two buffers used in turn.  "count" buffers starting at "head" belong
+// to the controller/host side (IN: queued, the head one in flight; OUT: received, waiting
+// for the application) and the one after them is the application's.  Completions only
+// advance head and count together, so the application's buffer never moves under it.
+// Everything here runs with __usb_mutex held, either from the USB task or from USBBulk.
+typedef struct {
+    uint8_t epOut;
+    uint8_t epIn;
+    bool open;
+
+    uint8_t rxHead;
+    uint8_t rxCount;
+    bool rxArmed;
+    size_t rxPos; // Bytes already read() from the head OUT buffer
+    uint16_t rxLen[2];
+
+    uint8_t txHead;
+    uint8_t txCount;
+    uint16_t txLen[2];
+
+    CFG_TUSB_MEM_ALIGN uint8_t rxBuf[2][USBBULK_BUFSIZE];
+    CFG_TUSB_MEM_ALIGN uint8_t txBuf[2][USBBULK_BUFSIZE];
+} BulkState;
+
+static_assert(USBBULK_BUFSIZE <= 65535, "USBBULK_BUFSIZE must fit a single USB transfer");
+
+static BulkState __bulk;
+
+// Waits for another transfer from the host, once the application has a free buffer for it
+static void bulkArmOut() {
+    if (__bulk.open && !__bulk.rxArmed && (__bulk.rxCount < 2)) {
+        uint8_t idx = (__bulk.rxHead + __bulk.rxCount) & 1;
+        __bulk.rxArmed = usbd_edpt_xfer(0, __bulk.epOut, __bulk.rxBuf[idx], USBBULK_BUFSIZE);
+    }
+}
+
+static void bulkSendHead() {
+    usbd_edpt_xfer(0, __bulk.epIn, __bulk.txBuf[__bulk.txHead], __bulk.txLen[__bulk.txHead]);
+}
+
+static void bulkInit() {
+}
+
+static void bulkReset(uint8_t rhport) {
+    (void) rhport;
+    __bulk.open = false;
+    __bulk.rxArmed = false;
+    __bulk.rxHead = 0;
+    __bulk.rxCount = 0;
+    __bulk.rxPos = 0;
+    __bulk.txHead = 0;
+    __bulk.txCount = 0;
+}
+
+static uint16_t bulkOpen(uint8_t rhport, tusb_desc_interface_t const *desc, uint16_t max_len) {
+    if ((desc->bInterfaceClass != TUSB_CLASS_VENDOR_SPECIFIC) || (desc->bInterfaceNumber != __USBGetBulkInterface())) {
+        return 0;
+    }
+    uint16_t len = sizeof(tusb_desc_interface_t) + 2 * sizeof(tusb_desc_endpoint_t);
+    if (max_len < len) {
+        return 0;
+    }
+    if (!usbd_open_edpt_pair(rhport, tu_desc_next(desc), 2, TUSB_XFER_BULK, &__bulk.epOut, &__bulk.epIn)) {
+        return 0;
+    }
+    __bulk.open = true;
+    bulkArmOut();
+    return len;
+}
+
+static bool bulkControl(uint8_t rhport, uint8_t stage, tusb_control_request_t const *req) {
+    // No class requests, the MS OS 2.0 vendor request is answered by RP2040USB.cpp
+    (void) rhport;
+    (void) stage;
+    (void) req;
+    return false;
+}
+
+static bool bulkXfer(uint8_t rhport, uint8_t ep, xfer_result_t result, uint32_t xferred) {
+    (void) rhport;
+    (void) result;
+    if (!__bulk.open) {
+        return false;
+    }
+    if (ep == __bulk.epOut) {
+        __bulk.rxArmed = false;
+        if (xferred) {
+            __bulk.rxLen[(__bulk.rxHead + __bulk.rxCount) & 1] = xferred;
+            __bulk.rxCount++;
+        }
+        bulkArmOut();
+        return true;
+    } else if (ep == __bulk.epIn) {
+        __bulk.txHead ^= 1;
+        __bulk.txCount--;
+        if (__bulk.txCount) {
+            bulkSendHead();
+        }
+        return true;
+    }
+    return false;
+}
+
+extern const usbd_class_driver_t __USBBulkDriver = {
+#if CFG_TUSB_DEBUG >= 2
+    .name = "USBBulk",
+#endif
+    .init = bulkInit,
+    .reset = bulkReset,
+    .open = bulkOpen,
+    .control_xfer_cb = bulkControl,
+    .xfer_cb = bulkXfer,
+};
+
+bool USBBulkClass::begin() {
+    __USBStart();
+    _running = true;
+    return true;
+}
+
+void USBBulkClass::end() {
+    _running = false;
+}
+
+bool USBBulkClass::connected() {
+    CoreMutex m(&__usb_mutex, false);
+    return _running && m && __bulk.open && tud_ready();
+}
+
+uint8_t *USBBulkClass::getWriteBuffer() {
+    CoreMutex m(&__usb_mutex, false);
+    if (!_running || !m || !__bulk.open || (__bulk.txCount == 2)) {
+        return nullptr;
+    }
+    return __bulk.txBuf[(__bulk.txHead + __bulk.txCount) & 1];
+}
+
+bool USBBulkClass::sendWriteBuffer(size_t len) {
+    CoreMutex m(&__usb_mutex, false);
+    if (!_running || !m || !__bulk.open || (__bulk.txCount == 2) || (len > USBBULK_BUFSIZE)) {
+        return false;
+    }
+    __bulk.txLen[(__bulk.txHead + __bulk.txCount) & 1] = len;
+    if (!__bulk.txCount++) {
+        bulkSendHead();
+    }
+    return true;
+}
+
+size_t USBBulkClass::write(const uint8_t *buf, size_t len) {
+    size_t written = 0;
+    uint64_t start = time_us_64();
+    while (written < len) {
+        uint8_t *b = getWriteBuffer();
+        if (!b) {
+            // Both buffers are queued, so push the USB stack along until one comes back
+            {
+                CoreMutex m(&__usb_mutex, false);
+                if (m) {
+                    tud_task();
+                }
+            }
+            if (!connected() || (time_us_64() - start > 1000000 /* 1 second */)) {
+                break;
+            }
+            continue;
+        }
+        size_t n = std::min(len - written, (size_t)USBBULK_BUFSIZE);
+        memcpy(b, buf + written, n);
+        if (!sendWriteBuffer(n)) {
+            break;
+        }
+        written += n;
+        start = time_us_64();
+    }
+    return written;
+}
+
+void USBBulkClass::flush() {
+    uint64_t start = time_us_64();
+    while (time_us_64() - start < 1000000 /* 1 second */) {
+        CoreMutex m(&__usb_mutex, false);
+        if (!_running || !m || !__bulk.open || !__bulk.txCount) {
+            return;
+        }
+        tud_task();
+    }
+}
+
+const uint8_t *USBBulkClass::getReadBuffer(size_t *len) {
+    CoreMutex m(&__usb_mutex, false);
+    if (!_running || !m || !__bulk.rxCount) {
+        return nullptr;
+    }
+    *len = __bulk.rxLen[__bulk.rxHead] - __bulk.rxPos;
+    return __bulk.rxBuf[__bulk.rxHead] + __bulk.rxPos;
+}
+
+void USBBulkClass::releaseReadBuffer() {
+    CoreMutex m(&__usb_mutex, false);
+    if (!_running || !m || !__bulk.rxCount) {
+        return;
+    }
+    __bulk.rxPos = 0;
+    __bulk.rxHead ^= 1;
+    __bulk.rxCount--;
+    bulkArmOut();
+}
+
+size_t USBBulkClass::read(uint8_t *buf, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+        size_t avail;
+        const uint8_t *b = getReadBuffer(&avail);
+        if (!b) {
+            break;
+        }
+        size_t n = std::min(len - got, avail);
+        memcpy(buf + got, b, n);
+        got += n;
+        if (n == avail) {
+            releaseReadBuffer();
+        } else {
+            CoreMutex m(&__usb_mutex, false);
+            __bulk.rxPos += n;
+        }
+    }
+    return got;
+}
+
+size_t USBBulkClass::available() {
+    CoreMutex m(&__usb_mutex, false);
+    if (!_running || !m) {
+        return 0;
+    }
+    size_t n = 0;
+    for (int i = 0; i < __bulk.rxCount; i++) {
+        n += __bulk.rxLen[(__bulk.rxHead + i) & 1];
+    }
+    return n - (__bulk.rxCount ? __bulk.rxPos : 0);
+}
+
+USBBulkClass USBBulk;
+
+#endif
@@ -0,0 +1,67 @@
+/*
+    High-rate vendor-class bulk endpoints for the built-in USB stack
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes in each of the two IN and two OUT buffers.  A whole buffer goes out as one
+// transfer, so the controller streams it without waiting on the application
+#ifndef USBBULK_BUFSIZE
+#define USBBULK_BUFSIZE 4096
+#endif
+
+// A WinUSB-compatible vendor interface with double-buffered bulk IN and OUT endpoints,
+// only added to the USB configuration when the sketch uses it.  Buffers are handed to
+// and from the controller directly, the copying read() and write() are conveniences.
+class USBBulkClass {
+public:
+    bool begin();
+    void end();
+
+    // Host has configured the device and begin() was called
+    bool connected();
+
+    // Free IN buffer of bufferSize() bytes to fill, nullptr while both are queued
+    uint8_t *getWriteBuffer();
+    // Queue the buffer from getWriteBuffer(), len bytes of it, for the host
+    bool sendWriteBuffer(size_t len);
+    // Copies into IN buffers and queues them, waiting for free ones for up to a second
+    size_t write(const uint8_t *buf, size_t len);
+    // Wait (up to a second) until everything queued has been taken by the host
+    void flush();
+
+    // Oldest received OUT transfer, nullptr if none.  Valid until releaseReadBuffer()
+    const uint8_t *getReadBuffer(size_t *len);
+    void releaseReadBuffer();
+    // Copies out of the received transfers, never blocks
+    size_t read(uint8_t *buf, size_t len);
+    size_t available();
+
+    size_t bufferSize() const {
+        return USBBULK_BUFSIZE;
+    }
+
+private:
+    bool _running = false;
+};
+
+extern USBBulkClass USBBulk;
@@ -0,0 +1,848 @@
+/*
+    Full and low speed USB host port on two GPIOs, using PIO, for TinyUSB's host classes
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "USBHost.h"
+
+#if USBHOST_PIO
+
+#include <Arduino.h>
+#include <hardware/clocks.h>
+#include <hardware/irq.h>
+#include <hardware/pio.h>
+#include <hardware/timer.h>
+
+#include "tusb.h"
+#include "host/hcd.h"
+#include "usb_host.pio.h"
+
+USBHostPIO USBHost;
+
+enum : uint8_t {
+    pidOut = 0xe1, pidIn = 0x69, pidSOF = 0xa5, pidSetup = 0x2d,
+    pidData0 = 0xc3, pidData1 = 0x4b, pidAck = 0xd2, pidNak = 0x5a, pidStall = 0x1e
+};
+
+// Transactions aren't started past this point in the frame, leaving room for the longest
+// one at each speed to finish before the next SOF
+#define FRAME_BUDGET_FS_US 850
+#define FRAME_BUDGET_LS_US 750
+// How long a device may take to start replying once tx is done, including the SYNC
+#define TURNAROUND_FS_US 3
+#define TURNAROUND_LS_US 20
+// Frames the line has to be steady for before an attach is reported
+#define ATTACH_DEBOUNCE 100
+// Frames of SE0 driven for a bus reset
+#define RESET_FRAMES 50
+
+typedef struct {
+    bool open;
+    volatile bool active;
+    uint8_t dev;
+    uint8_t num;
+    uint8_t type;
+    bool in;            // Direction of the current transfer, which for ep0 changes per stage
+    bool setup;         // ep0's next transaction is the SETUP
+    uint8_t toggle;
+    uint8_t errors;
+    uint8_t interval;
+    uint8_t countdown;  // Frames until an interrupt endpoint is due
+    bool due;
+    uint16_t maxPacket;
+    uint8_t *buf;
+    uint16_t len;
+    uint16_t done;
+    uint8_t setupData[8];
+} HostEndpoint;
+
+static HostEndpoint _ep[USBHOST_ENDPOINTS];
+
+static PIOProgram _rxProgram(&usb_host_program);
+static PIOProgram _txProgram(&usb_host_program);
+static PIO _pio;
+static int _rxSM = -1;
+static int _txSM = -1;
+static int _offset;
+static pin_size_t _dp;
+static uint32_t _fsDiv;
+static int _alarm = -1;
+static bool _running;
+static uint64_t _nextFrame;
+
+static volatile bool _attached;
+static volatile bool _low;
+static volatile int _resetFrames;
+static volatile uint32_t _frames;
+static volatile uint32_t _errors;
+static uint32_t _lastLine;
+static int _steady;
+static int _se0Frames;
+
+// Line state at the current speed: J as a tx symbol and as the level on D+, and the time
+// a reply may take to arrive
+static uint32_t _symJ;
+static uint32_t _dpJ;
+static uint32_t _turnaround;
+
+// Decoding tables, kept in RAM for the frame interrupt: the D+ levels out of 4 samples,
+// the result of unstuffing 8 bits after a given number of 1s (data, bit count << 8 and
+// 1s after << 12), and the CRC16
+static uint8_t _even[256];
+static uint16_t _unstuff[7][256];
+static uint16_t _crc16[256];
+
+static uint32_t _tokBuf[4];
+static uint32_t _dataBuf[48];
+static uint32_t _ackBuf[2];
+static int _ackSymbols;
+static uint8_t _pkt[68];
+static uint8_t _rx[68];
+
+static void _buildTables() {
+    for (int b = 0; b < 256; b++) {
+        _even[b] = (b & 1) | ((b >> 1) & 2) | ((b >> 2) & 4) | ((b >> 3) & 8);
+        uint16_t c = b;
+        for (int i = 0; i < 8; i++) {
+            c = (c & 1) ? (c >> 1) ^ 0xa001 : c >> 1;
+        }
+        _crc16[b] = c;
+        for (int ones = 0; ones < 7; ones++) {
+            uint32_t o = ones, out = 0, cnt = 0;
+            for (int i = 0; i < 8; i++) {
+                uint32_t bit = (b >> i) & 1;
+                if (o == 6) {
+                    // A stuffed 0 (or a stuffing error the CRC will catch)
+                    o = 0;
+                    continue;
+                }
+                out |= bit << cnt++;
+                o = bit ? o + 1 : 0;
+            }
+            _unstuff[ones][b] = out | (cnt << 8) | (o << 12);
+        }
+    }
+}
+
+static uint32_t __not_in_flash_func(_crc5)(uint32_t v) {
+    uint32_t crc = 0x1f;
+    for (int i = 0; i < 11; i++) {
+        crc = ((crc ^ (v >> i)) & 1) ? (crc >> 1) ^ 0x14 : crc >> 1;
+    }
+    return ~crc & 0x1f;
+}
+
+static inline __attribute__((always_inline)) void _put(uint32_t *&out, uint32_t &word, int &n, uint32_t sym) {
+    word |= sym << ((n & 15) * 2);
+    if (!(++n & 15)) {
+        *out++ = word;
+        word = 0;
+    }
+}
+
+// Turns a packet, PID first, into tx's pin values from SYNC through EOP with the bits
+// stuffed and NRZI encoded, returning the number of symbols
+static int __not_in_flash_func(_encode)(uint32_t *out, const uint8_t *data, int len) {
+    uint32_t sym = _symJ;
+    uint32_t word = 0;
+    int n = 0;
+    // SYNC is KJKJKJKK, and its last 1 counts towards stuffing
+    for (int i = 0; i < 7; i++) {
+        sym ^= 3;
+        _put(out, word, n, sym);
+    }
+    _put(out, word, n, sym);
+    int ones = 1;
+    for (int i = 0; i < len; i++) {
+        uint32_t b = data[i];
+        for (int j = 0; j < 8; j++, b >>= 1) {
+            if (b & 1) {
+                _put(out, word, n, sym);
+                if (++ones == 6) {
+                    sym ^= 3;
+                    _put(out, word, n, sym);
+                    ones = 0;
+                }
+            } else {
+                sym ^= 3;
+                _put(out, word, n, sym);
+                ones = 0;
+            }
+        }
+    }
+    _put(out, word, n, 0);
+    _put(out, word, n, 0);
+    _put(out, word, n, _symJ);
+    if (n & 15) {
+        *out = word;
+    }
+    return n;
+}
+
+static int __not_in_flash_func(_encodeToken)(uint32_t *out, uint8_t pid, uint32_t v) {
+    v |= _crc5(v) << 11;
+    uint8_t b[3] = { pid, (uint8_t)v, (uint8_t)(v >> 8) };
+    return _encode(out, b, 3);
+}
+
+static int __not_in_flash_func(_encodeData)(uint32_t *out, uint8_t pid, const uint8_t *data, int len) {
+    uint32_t crc = 0xffff;
+    _pkt[0] = pid;
+    for (int i = 0; i < len; i++) {
+        _pkt[i + 1] = data[i];
+        crc = (crc >> 8) ^ _crc16[(crc ^ data[i]) & 0xff];
+    }
+    crc = ~crc;
+    _pkt[len + 1] = crc;
+    _pkt[len + 2] = crc >> 8;
+    return _encode(out, _pkt, len + 3);
+}
+
+// Queues a packet for tx.  With listen set rx starts looking for the reply once it's sent
+static void __not_in_flash_func(_send)(const uint32_t *buf, int symbols, bool listen) {
+    pio_sm_put_blocking(_pio, _txSM, (symbols - 1) | (listen ? 0x10000 : 0));
+    for (int i = 0; i < (symbols + 15) / 16; i++) {
+        pio_sm_put_blocking(_pio, _txSM, buf[i]);
+    }
+}
+
+static void __not_in_flash_func(_rxRestart)() {
+    pio_sm_set_enabled(_pio, _rxSM, false);
+    pio_sm_clear_fifos(_pio, _rxSM);
+    pio_sm_restart(_pio, _rxSM);
+    pio_sm_exec(_pio, _rxSM, pio_encode_jmp(_offset + usb_host_offset_rx));
+    _pio->irq = 1u << 4;
+    pio_sm_set_enabled(_pio, _rxSM, true);
+}
+
+typedef struct {
+    uint32_t acc;
+    uint32_t nacc;
+    uint32_t ones;
+    uint32_t crc;
+    int n;
+} RxState;
+
+// Stores any whole byte, with the CRC of all but the PID
+static inline __attribute__((always_inline)) bool _rxByte(RxState &r) {
+    if (r.nacc >= 8) {
+        if (r.n >= (int)sizeof(_rx)) {
+            return false;
+        }
+        uint8_t b = r.acc;
+        _rx[r.n++] = b;
+        r.crc = (r.n == 1) ? 0xffff : (r.crc >> 8) ^ _crc16[(r.crc ^ b) & 0xff];
+        r.acc >>= 8;
+        r.nacc -= 8;
+    }
+    return true;
+}
+
+static inline __attribute__((always_inline)) bool _rxBit(RxState &r, uint32_t bit) {
+    if (r.ones == 6) {
+        r.ones = 0;
+        return true;
+    }
+    r.acc |= bit << r.nacc++;
+    r.ones = bit ? r.ones + 1 : 0;
+    return _rxByte(r);
+}
+
+// Decodes the reply to what tx is sending into _rx, as the samples arrive, returning its
+// length with the PID, 0 if nothing came in time, or -1 if it was garbled.  A data packet
+// with a good CRC is ACKed straight after its EOP, as it has to be within 16 bit times
+static int __not_in_flash_func(_receive)(bool ack) {
+    const uint32_t empty = 1u << (PIO_FSTAT_RXEMPTY_LSB + _rxSM);
+    io_ro_32 *rxf = &_pio->rxf[_rxSM];
+    // The reply can only start once tx is finished and back waiting for a header
+    uint32_t t0 = time_us_32();
+    while (!pio_sm_is_tx_fifo_empty(_pio, _txSM) || (pio_sm_get_pc(_pio, _txSM) != _offset + usb_host_offset_tx)) {
+        if (time_us_32() - t0 > 1000) {
+            return 0;
+        }
+    }
+    t0 = time_us_32();
+    while (_pio->fstat & empty) {
+        if (time_us_32() - t0 > _turnaround) {
+            return 0;
+        }
+    }
+
+    RxState r = { 0, 0, 0, 0, 0 };
+    uint32_t prev = _dpJ;
+    bool sync = false;
+    uint32_t s, se0;
+    for (int words = 0; ; words++) {
+        if (words > (int)sizeof(_rx) * 10 / 8) {
+            return -1;
+        }
+        // Never waits long, rx samples continuously until it's restarted
+        while (_pio->fstat & empty) {
+            /* Spin */
+        }
+        s = *rxf >> 16;
+        se0 = ~(s | (s >> 1)) & 0x5555;
+        if (se0) {
+            break;
+        }
+        uint32_t l = _even[s & 0xff] | (_even[s >> 8] << 4);
+        uint32_t bits = ~(l ^ ((l << 1) | prev)) & 0xff;
+        prev = l >> 7;
+        if (!sync) {
+            if (!bits) {
+                continue;
+            }
+            // SYNC ends at the first 1
+            sync = true;
+            r.ones = 1;
+            int i = __builtin_ctz(bits);
+            for (bits >>= i + 1; i < 7; i++, bits >>= 1) {
+                if (!_rxBit(r, bits & 1)) {
+                    return -1;
+                }
+            }
+            continue;
+        }
+        uint32_t e = _unstuff[r.ones][bits];
+        r.acc |= (e & 0xff) << r.nacc;
+        r.nacc += (e >> 8) & 0x0f;
+        r.ones = e >> 12;
+        if (!_rxByte(r)) {
+            return -1;
+        }
+    }
+    if (!sync) {
+        return -1;
+    }
+    // Whatever came before the EOP's SE0 in the last 8 samples.  A dribble bit is dropped
+    int k = __builtin_ctz(se0) >> 1;
+    for (int i = 0; i < k; i++) {
+        uint32_t l = (s >> (i * 2)) & 1;
+        if (!_rxBit(r, (~(l ^ prev)) & 1)) {
+            return -1;
+        }
+        prev = l;
+    }
+    if (!r.n) {
+        return -1;
+    }
+    uint8_t pid = _rx[0];
+    if ((pid & 0x0f) != ((~pid >> 4) & 0x0f)) {
+        return -1;
+    }
+    if ((pid == pidData0) || (pid == pidData1)) {
+        if ((r.n < 3) || (r.crc != 0xb001)) {
+            return -1;
+        }
+        if (ack) {
+            _send(_ackBuf, _ackSymbols, false);
+        }
+    }
+    return r.n;
+}
+
+// Sets the PIO up for the speed of the device
+static void _configure(bool low) {
+    pio_sm_set_enabled(_pio, _rxSM, false);
+    pio_sm_set_enabled(_pio, _txSM, false);
+    _low = low;
+    // J is D+ high at full speed and D- high at low speed
+    _symJ = low ? 2 : 1;
+    _dpJ = low ? 0 : 1;
+    _turnaround = low ? TURNAROUND_LS_US : TURNAROUND_FS_US;
+    float div = _fsDiv * (low ? 8 : 1);
+    usb_host_rx_program_init(_pio, _rxSM, _offset, _dp, low ? _dp + 1 : _dp, div);
+    usb_host_tx_program_init(_pio, _txSM, _offset, _dp, _symJ, div);
+    uint8_t ack = pidAck;
+    _ackSymbols = _encode(_ackBuf, &ack, 1);
+    pio_sm_set_enabled(_pio, _rxSM, true);
+    pio_sm_set_enabled(_pio, _txSM, true);
+}
+
+static void __not_in_flash_func(_complete)(HostEndpoint *ep, xfer_result_t result) {
+    ep->active = false;
+    uint8_t addr = ep->num | ((ep->in && !ep->setup) ? 0x80 : 0);
+    uint32_t len = ep->setup ? 8 : ep->done;
+    if (ep->setup) {
+        ep->setup = false;
+        ep->toggle = 1;
+    }
+    hcd_event_xfer_complete(ep->dev, addr, len, result, true);
+}
+
+static bool __not_in_flash_func(_failed)(HostEndpoint *ep) {
+    _errors++;
+    if (++ep->errors >= 3) {
+        _complete(ep, XFER_RESULT_FAILED);
+    }
+    return false;
+}
+
+// Runs one transaction on the endpoint, returning whether it can have another this frame
+static bool __not_in_flash_func(_transact)(HostEndpoint *ep) {
+    uint32_t addr = ep->dev | (ep->num << 7);
+    if (ep->in && !ep->setup) {
+        _send(_tokBuf, _encodeToken(_tokBuf, pidIn, addr), true);
+        int n = _receive(true);
+        _rxRestart();
+        if (n <= 0) {
+            return _failed(ep);
+        }
+        if (_rx[0] == pidNak) {
+            return false;
+        } else if (_rx[0] == pidStall) {
+            _complete(ep, XFER_RESULT_STALLED);
+            return false;
+        } else if ((_rx[0] != pidData0) && (_rx[0] != pidData1)) {
+            return _failed(ep);
+        }
+        ep->errors = 0;
+        if ((_rx[0] == pidData1) != (ep->toggle == 1)) {
+            // Our ACK of the last one was lost, it's been ACKed again so now it's dropped
+            return true;
+        }
+        n -= 3;
+        ep->toggle ^= 1;
+        if ((n > ep->maxPacket) || (n > ep->len - ep->done)) {
+            _complete(ep, XFER_RESULT_FAILED);
+            return false;
+        }
+        if (n) {
+            memcpy(ep->buf + ep->done, _rx + 1, n);
+            ep->done += n;
+        }
+        if ((n < ep->maxPacket) || (ep->done == ep->len)) {
+            _complete(ep, XFER_RESULT_SUCCESS);
+            return false;
+        }
+        return true;
+    }
+
+    // SETUP or OUT, the data has to follow the token without a gap so it's encoded first
+    int n, symbols;
+    if (ep->setup) {
+        n = 8;
+        symbols = _encodeData(_dataBuf, pidData0, ep->setupData, 8);
+        _send(_tokBuf, _encodeToken(_tokBuf, pidSetup, addr), false);
+    } else {
+        n = ep->len - ep->done;
+        if (n > ep->maxPacket) {
+            n = ep->maxPacket;
+        }
+        symbols = _encodeData(_dataBuf, ep->toggle ? pidData1 : pidData0, ep->buf + ep->done, n);
+        _send(_tokBuf, _encodeToken(_tokBuf, pidOut, addr), false);
+    }
+    _send(_dataBuf, symbols, true);
+    int r = _receive(false);
+    _rxRestart();
+    if (r != 1) {
+        return _failed(ep);
+    }
+    if (_rx[0] == pidNak) {
+        return false;
+    } else if (_rx[0] == pidStall) {
+        _complete(ep, XFER_RESULT_STALLED);
+        return false;
+    } else if (_rx[0] != pidAck) {
+        return _failed(ep);
+    }
+    ep->errors = 0;
+    if (ep->setup) {
+        _complete(ep, XFER_RESULT_SUCCESS);
+        return false;
+    }
+    ep->toggle ^= 1;
+    ep->done += n;
+    if (ep->done >= ep->len) {
+        _complete(ep, XFER_RESULT_SUCCESS);
+        return false;
+    }
+    return true;
+}
+
+// Watches for attach and detach while idle
+static void __not_in_flash_func(_checkLine)() {
+    uint32_t line = (gpio_get_all() >> _dp) & 3;
+    if (!_attached) {
+        if ((line == 1) || (line == 2)) {
+            if ((line == _lastLine) && (++_steady >= ATTACH_DEBOUNCE)) {
+                _configure(line == 2);
+                _attached = true;
+                _se0Frames = 0;
+                hcd_event_device_attach(TUH_OPT_RHPORT, true);
+            }
+        } else {
+            _steady = 0;
+        }
+        _lastLine = line;
+        return;
+    }
+    if (line) {
+        _se0Frames = 0;
+    } else if (++_se0Frames >= 3) {
+        _attached = false;
+        _steady = 0;
+        _lastLine = 0;
+        for (int i = 0; i < USBHOST_ENDPOINTS; i++) {
+            _ep[i].active = false;
+        }
+        hcd_event_device_remove(TUH_OPT_RHPORT, true);
+    }
+}
+
+static void __not_in_flash_func(_frameIRQ)(uint alarm) {
+    uint32_t start = (uint32_t)_nextFrame;
+    _nextFrame += 1000;
+    if (hardware_alarm_set_target(alarm, from_us_since_boot(_nextFrame))) {
+        // Missed, e.g. while flash was being written, so start afresh
+        _nextFrame = time_us_64() + 1000;
+        hardware_alarm_set_target(alarm, from_us_since_boot(_nextFrame));
+    }
+    _frames++;
+
+    if (_resetFrames) {
+        if (!--_resetFrames) {
+            pio_sm_set_pins_with_mask(_pio, _txSM, _symJ << _dp, 3u << _dp);
+            pio_sm_set_pindirs_with_mask(_pio, _txSM, 0, 3u << _dp);
+            pio_sm_set_enabled(_pio, _txSM, true);
+        }
+        return;
+    }
+    _checkLine();
+    if (!_attached) {
+        return;
+    }
+
+    // SOF at full speed, a bare EOP keep-alive at low speed
+    if (_low) {
+        _tokBuf[0] = _symJ << 4;
+        _send(_tokBuf, 3, false);
+    } else {
+        _send(_tokBuf, _encodeToken(_tokBuf, pidSOF, _frames & 0x7ff), false);
+    }
+
+    for (int i = 0; i < USBHOST_ENDPOINTS; i++) {
+        HostEndpoint *ep = &_ep[i];
+        ep->due = ep->active;
+        if (ep->active && (ep->type == TUSB_XFER_INTERRUPT)) {
+            if (ep->countdown > 1) {
+                ep->countdown--;
+                ep->due = false;
+            } else {
+                ep->countdown = ep->interval;
+            }
+        }
+    }
+    uint32_t budget = _low ? FRAME_BUDGET_LS_US : FRAME_BUDGET_FS_US;
+    bool more = true;
+    while (more && (time_us_32() - start < budget)) {
+        more = false;
+        for (int i = 0; (i < USBHOST_ENDPOINTS) && (time_us_32() - start < budget); i++) {
+            HostEndpoint *ep = &_ep[i];
+            if (!ep->due || !ep->active) {
+                continue;
+            }
+            // Interrupt endpoints get one try per interval
+            ep->due = _transact(ep) && (ep->type != TUSB_XFER_INTERRUPT);
+            more |= ep->due;
+        }
+    }
+}
+
+static HostEndpoint *_find(uint8_t dev, uint8_t num) {
+    for (int i = 0; i < USBHOST_ENDPOINTS; i++) {
+        if (_ep[i].open && (_ep[i].dev == dev) && (_ep[i].num == num)) {
+            return &_ep[i];
+        }
+    }
+    return nullptr;
+}
+
+static HostEndpoint *_open(uint8_t dev, uint8_t num) {
+    HostEndpoint *ep = _find(dev, num);
+    for (int i = 0; !ep && (i < USBHOST_ENDPOINTS); i++) {
+        if (!_ep[i].open) {
+            ep = &_ep[i];
+        }
+    }
+    if (ep) {
+        memset(ep, 0, sizeof(*ep));
+        ep->open = true;
+        ep->dev = dev;
+        ep->num = num;
+        ep->type = TUSB_XFER_CONTROL;
+        ep->maxPacket = 8;
+    }
+    return ep;
+}
+
+// TinyUSB host controller driver, all called on core 1
+extern "C" {
+
+    bool hcd_init(uint8_t rhport) {
+        (void) rhport;
+        return true;
+    }
+
+    void hcd_int_enable(uint8_t rhport) {
+        (void) rhport;
+        irq_set_enabled(TIMER_IRQ_0 + _alarm, true);
+    }
+
+    void hcd_int_disable(uint8_t rhport) {
+        (void) rhport;
+        irq_set_enabled(TIMER_IRQ_0 + _alarm, false);
+    }
+
+    uint32_t hcd_frame_number(uint8_t rhport) {
+        (void) rhport;
+        return _frames;
+    }
+
+    bool hcd_port_connect_status(uint8_t rhport) {
+        (void) rhport;
+        return _attached;
+    }
+
+    void hcd_port_reset(uint8_t rhport) {
+        (void) rhport;
+        noInterrupts();
+        pio_sm_set_enabled(_pio, _txSM, false);
+        pio_sm_set_pins_with_mask(_pio, _txSM, 0, 3u << _dp);
+        pio_sm_set_pindirs_with_mask(_pio, _txSM, 3u << _dp, 3u << _dp);
+        _resetFrames = RESET_FRAMES;
+        interrupts();
+    }
+
+    void hcd_port_reset_end(uint8_t rhport) {
+        // The frame interrupt ends the reset by itself
+        (void) rhport;
+    }
+
+    tusb_speed_t hcd_port_speed_get(uint8_t rhport) {
+        (void) rhport;
+        return _low ? TUSB_SPEED_LOW : TUSB_SPEED_FULL;
+    }
+
+    void hcd_device_close(uint8_t rhport, uint8_t dev_addr) {
+        (void) rhport;
+        noInterrupts();
+        for (int i = 0; i < USBHOST_ENDPOINTS; i++) {
+            if (_ep[i].dev == dev_addr) {
+                _ep[i].active = false;
+                _ep[i].open = false;
+            }
+        }
+        interrupts();
+    }
+
+    bool hcd_edpt_open(uint8_t rhport, uint8_t dev_addr, tusb_desc_endpoint_t const *ep_desc) {
+        (void) rhport;
+        if (ep_desc->bmAttributes.xfer == TUSB_XFER_ISOCHRONOUS) {
+            return false;
+        }
+        noInterrupts();
+        HostEndpoint *ep = _open(dev_addr, tu_edpt_number(ep_desc->bEndpointAddress));
+        if (ep) {
+            ep->type = ep_desc->bmAttributes.xfer;
+            ep->maxPacket = tu_edpt_packet_size(ep_desc);
+            ep->interval = ep_desc->bInterval ? ep_desc->bInterval : 1;
+            ep->countdown = 1;
+        }
+        interrupts();
+        return ep != nullptr;
+    }
+
+    bool hcd_setup_send(uint8_t rhport, uint8_t dev_addr, uint8_t const setup_packet[8]) {
+        (void) rhport;
+        noInterrupts();
+        HostEndpoint *ep = _find(dev_addr, 0);
+        if (!ep) {
+            ep = _open(dev_addr, 0);
+        }
+        if (ep) {
+            memcpy(ep->setupData, setup_packet, 8);
+            ep->setup = true;
+            ep->in = false;
+            ep->toggle = 0;
+            ep->errors = 0;
+            ep->done = 0;
+            ep->active = true;
+        }
+        interrupts();
+        return ep != nullptr;
+    }
+
+    bool hcd_edpt_xfer(uint8_t rhport, uint8_t dev_addr, uint8_t ep_addr, uint8_t *buffer, uint16_t buflen) {
+        (void) rhport;
+        noInterrupts();
+        HostEndpoint *ep = _find(dev_addr, tu_edpt_number(ep_addr));
+        bool ok = ep && !ep->active;
+        if (ok) {
+            ep->in = tu_edpt_dir(ep_addr) == TUSB_DIR_IN;
+            if (ep->type == TUSB_XFER_CONTROL) {
+                // Data and status stages always start with DATA1
+                ep->toggle = 1;
+                ep->setup = false;
+            }
+            ep->buf = buffer;
+            ep->len = buflen;
+            ep->done = 0;
+            ep->errors = 0;
+            ep->active = true;
+        }
+        interrupts();
+        return ok;
+    }
+
+    bool hcd_edpt_clear_stall(uint8_t dev_addr, uint8_t ep_addr) {
+        noInterrupts();
+        HostEndpoint *ep = _find(dev_addr, tu_edpt_number(ep_addr));
+        if (ep) {
+            ep->toggle = 0;
+        }
+        interrupts();
+        return true;
+    }
+
+    // HID reports are only delivered to sketches which ask for them
+    void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *report, uint16_t len) __attribute__((weak));
+    void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *report, uint16_t len) {
+        (void) dev_addr;
+        (void) instance;
+        (void) report;
+        (void) len;
+    }
+
+} // extern "C"
+
+bool USBHostPIO::begin(pin_size_t dp) {
+    if (_running) {
+        return false;
+    }
+    if (get_core_num() != 1) {
+        DEBUGV("USBHost: begin() must be called from core 1\n");
+        return false;
+    }
+    uint32_t sys = clock_get_hz(clk_sys);
+    if ((dp > 28) || (sys % 120000000)) {
+        DEBUGV("USBHost: Illegal pin or clk_sys not a multiple of 120MHz\n");
+        return false;
+    }
+    // rx and tx share IRQ 4, so have to be in the same PIO
+    PIO txPIO;
+    int txOffset;
+    if (!_rxProgram.prepare(&_pio, &_rxSM, &_offset)) {
+        DEBUGV("USBHost: No free PIO state machine\n");
+        return false;
+    }
+    if (!_txProgram.prepare(&txPIO, &_txSM, &txOffset) || (txPIO != _pio)) {
+        DEBUGV("USBHost: Need two free state machines in one PIO\n");
+        if (_txSM >= 0) {
+            PIOProgram::unprepare(txPIO, _txSM);
+        }
+        PIOProgram::unprepare(_pio, _rxSM);
+        _rxSM = _txSM = -1;
+        return false;
+    }
+    _alarm = hardware_alarm_claim_unused(false);
+    if (_alarm < 0) {
+        DEBUGV("USBHost: No free timer alarm\n");
+        PIOProgram::unprepare(_pio, _txSM);
+        PIOProgram::unprepare(_pio, _rxSM);
+        _rxSM = _txSM = -1;
+        return false;
+    }
+
+    static bool tables = false;
+    if (!tables) {
+        _buildTables();
+        tables = true;
+    }
+    _dp = dp;
+    _fsDiv = sys / 120000000;
+    memset(_ep, 0, sizeof(_ep));
+    _attached = false;
+    _resetFrames = 0;
+    _frames = 0;
+    _errors = 0;
+    _lastLine = 0;
+    _steady = 0;
+    // The device's pull-up on D+ or D- shows it's there, and its speed
+    gpio_pull_down(dp);
+    gpio_pull_down(dp + 1);
+    _configure(false);
+
+    // The frame interrupt runs on this core, above everything else
+    hardware_alarm_set_callback(_alarm, _frameIRQ);
+    irq_set_priority(TIMER_IRQ_0 + _alarm, PICO_HIGHEST_IRQ_PRIORITY);
+    if (!tuh_inited()) {
+        tuh_init(TUH_OPT_RHPORT);
+    }
+    _running = true;
+    _nextFrame = time_us_64() + 1000;
+    hardware_alarm_set_target(_alarm, from_us_since_boot(_nextFrame));
+    return true;
+}
+
+void USBHostPIO::end() {
+    if (!_running) {
+        return;
+    }
+    hardware_alarm_cancel(_alarm);
+    hardware_alarm_set_callback(_alarm, nullptr);
+    hardware_alarm_unclaim(_alarm);
+    _alarm = -1;
+    _running = false;
+    if (_attached) {
+        // Lets TinyUSB unmount the device's classes on the next task()
+        _attached = false;
+        hcd_event_device_remove(TUH_OPT_RHPORT, false);
+    }
+    pio_sm_set_enabled(_pio, _rxSM, false);
+    pio_sm_set_enabled(_pio, _txSM, false);
+    PIOProgram::unprepare(_pio, _txSM);
+    PIOProgram::unprepare(_pio, _rxSM);
+    _rxSM = _txSM = -1;
+    pinMode(_dp, INPUT);
+    pinMode(_dp + 1, INPUT);
+}
+
+void USBHostPIO::task() {
+    if (tuh_inited()) {
+        tuh_task();
+    }
+}
+
+bool USBHostPIO::connected() {
+    return _attached;
+}
+
+bool USBHostPIO::lowSpeed() {
+    return _low;
+}
+
+uint32_t USBHostPIO::frameNumber() {
+    return _frames;
+}
+
+uint32_t USBHostPIO::errors() {
+    return _errors;
+}
+
+#endif
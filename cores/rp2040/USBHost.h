@@ -0,0 +1,61 @@
+/*
+    Full and low speed USB host port on two GPIOs, using PIO, for TinyUSB's host classes
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#if !defined(USE_TINYUSB) && !defined(NO_USB)
+#include <tusb_config.h>
+#endif
+
+#if USBHOST_PIO
+
+// Endpoints, over all devices, which can be open at once
+#ifndef USBHOST_ENDPOINTS
+#define USBHOST_ENDPOINTS 8
+#endif
+
+// A second USB port, in host mode, for a keyboard, mouse or flash drive plugged straight
+// into it (no hubs).  Two PIO SMs send and sample the bits and the rest is done on core 1:
+// every millisecond a timer interrupt sends the SOF and runs that frame's transactions,
+// and task() runs TinyUSB's host stack, whose HID and MSC class callbacks (tuh_hid_*,
+// tuh_msc_*) the sketch implements.  The native USB port carries on as a device.
+class USBHostPIO {
+public:
+    // D+ on dp and D- on dp + 1, each through a 22 ohm resistor.  Call from setup1(), with
+    // clk_sys a multiple of 120MHz
+    bool begin(pin_size_t dp);
+    void end();
+
+    // Runs tuh_task(), call from loop1()
+    void task();
+
+    // A device is attached (it may not be enumerated yet)
+    bool connected();
+    bool lowSpeed();
+    // Frames sent since begin()
+    uint32_t frameNumber();
+    // Transactions which timed out or came back garbled
+    uint32_t errors();
+};
+
+extern USBHostPIO USBHost;
+
+#endif
@@ -0,0 +1,713 @@
+/*
+    USB Mass Storage (bulk-only SCSI disk) for the built-in USB stack
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#if !defined(USE_TINYUSB) && !defined(NO_USB)
+
+#include <Arduino.h>
+#include "CoreMutex.h"
+#include "FlashService.h"
+#include "RP2040USB.h"
+#include "USBMassStorage.h"
+#include <algorithm>
+
+#include "tusb.h"
+#include "device/usbd_pvt.h"
+#include "class/msc/msc.h"
+#include "hardware/regs/addressmap.h"
+
+// Referring to USBMassStorage links in this file, which installs the interface in the USB chain
+void __USBInstallMassStorage() { /* noop */ }
+
+#define MSC_SECTOR (512)
+#define MSC_LINE_SECTORS (8)
+#define MSC_CHUNK (MSC_SECTOR * MSC_LINE_SECTORS)
+
+#define SCSI_CMD_SYNCHRONIZE_CACHE_10 (0x35)
+
+#define SENSE_NOT_READY       (0x02)
+#define SENSE_MEDIUM_ERROR    (0x03)
+#define SENSE_ILLEGAL_REQUEST (0x05)
+#define SENSE_UNIT_ATTENTION  (0x06)
+#define SENSE_DATA_PROTECT    (0x07)
+
+typedef struct {
+    uint32_t tag;     // First sector of the line
+    uint32_t lastUse;
+    uint8_t valid;    // One bit per sector
+    uint8_t dirty;
+    uint8_t data[MSC_CHUNK];
+} MSCLine;
+
+typedef enum {
+    MSC_CMD,         // Waiting for a CBW
+    MSC_DATA_IN,     // Sending a small response
+    MSC_READ,        // READ(10) pipeline
+    MSC_WRITE,       // WRITE(10) pipeline
+    MSC_STATUS,      // IN is stalled, CSW goes out when the host clears it
+    MSC_STATUS_SENT,
+    MSC_NEED_RESET   // Bad CBW, until the host does a bulk-only reset
+} MSCStage;
+
+// Everything here runs with __usb_mutex held, either from the USB task or from USBMassStorage
+typedef struct {
+    USBMSCDisk *disk;
+    bool readOnly;
+    bool ejected;
+    bool changed;     // Report UNIT ATTENTION once so the host rereads the media
+    bool open;
+    uint8_t epOut;
+    uint8_t epIn;
+    MSCStage stage;
+    uint8_t status;
+    uint32_t moved;   // Data bytes transferred for this command
+    uint8_t senseKey;
+    uint8_t asc;
+
+    // READ(10)/WRITE(10): the next sector to read from or write to the cache, the sectors still
+    // to read or receive, and the two buffers the disk and the USB controller take turns on
+    uint32_t lba;
+    uint32_t left;
+    bool failed;
+    uint8_t busy;     // Buffer the controller is using
+    bool ready[2];
+    uint16_t bufLen[2];
+
+    bool flushPending;
+    uint32_t flushAt;
+    uint32_t useCount;
+
+    CFG_TUSB_MEM_ALIGN msc_cbw_t cbw;
+    CFG_TUSB_MEM_ALIGN msc_csw_t csw;
+    CFG_TUSB_MEM_ALIGN uint8_t buf[2][MSC_CHUNK];
+    MSCLine line[USBMSC_CACHE_LINES];
+} MSCState;
+
+static MSCState __msc;
+
+
+// Write-back cache of aligned 8 sector lines
+static MSCLine *cacheFind(uint32_t sector) {
+    uint32_t tag = sector & ~(MSC_LINE_SECTORS - 1);
+    for (auto &l : __msc.line) {
+        if ((l.tag == tag) && (l.valid || l.dirty)) {
+            return &l;
+        }
+    }
+    return nullptr;
+}
+
+static bool cacheWriteBack(MSCLine *l) {
+    if (!l->dirty) {
+        return true;
+    }
+    bool ok = __msc.disk;
+    if (ok && __msc.disk->wholeLines()) {
+        // Fill in what the host didn't write so the whole block can be rewritten
+        for (int i = 0; ok && (i < MSC_LINE_SECTORS); i++) {
+            if (!(l->valid & (1 << i))) {
+                ok = __msc.disk->read(l->tag + i, l->data + i * MSC_SECTOR, 1);
+            }
+        }
+        ok = ok && __msc.disk->write(l->tag, l->data, MSC_LINE_SECTORS);
+        l->valid = ok ? 0xff : 0;
+    } else {
+        // One write per run of dirty sectors
+        for (int i = 0; ok && (i < MSC_LINE_SECTORS);) {
+            if (!(l->dirty & (1 << i))) {
+                i++;
+                continue;
+            }
+            int j = i;
+            while ((j < MSC_LINE_SECTORS) && (l->dirty & (1 << j))) {
+                j++;
+            }
+            ok = __msc.disk->write(l->tag + i, l->data + i * MSC_SECTOR, j - i);
+            i = j;
+        }
+    }
+    // A failed line is dropped rather than retried forever, the host sees the error
+    l->dirty = 0;
+    return ok;
+}
+
+// Frees the least recently used line for sector, writing it back first if needed
+static MSCLine *cacheAlloc(uint32_t sector, bool *ok) {
+    MSCLine *lru = &__msc.line[0];
+    for (auto &l : __msc.line) {
+        if (!l.valid && !l.dirty) {
+            lru = &l;
+            break;
+        }
+        if (l.lastUse < lru->lastUse) {
+            lru = &l;
+        }
+    }
+    if (!cacheWriteBack(lru)) {
+        *ok = false;
+    }
+    lru->tag = sector & ~(MSC_LINE_SECTORS - 1);
+    lru->valid = 0;
+    lru->dirty = 0;
+    return lru;
+}
+
+static bool cacheFlush() {
+    bool ok = true;
+    for (auto &l : __msc.line) {
+        ok = cacheWriteBack(&l) && ok;
+    }
+    return __msc.disk && __msc.disk->sync() && ok;
+}
+
+static bool cacheRead(uint32_t sector, uint8_t *buf, uint32_t count) {
+    if (!__msc.disk) {
+        return false;
+    }
+    // Anything not wholly cached comes from the disk in one go, then newer cached sectors go over it
+    bool cached = true;
+    for (uint32_t i = 0; cached && (i < count); i++) {
+        MSCLine *l = cacheFind(sector + i);
+        cached = l && (l->valid & (1 << ((sector + i) % MSC_LINE_SECTORS)));
+    }
+    if (!cached && !__msc.disk->read(sector, buf, count)) {
+        return false;
+    }
+    bool ok = true;
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t bit = 1 << ((sector + i) % MSC_LINE_SECTORS);
+        uint8_t *p = buf + i * MSC_SECTOR;
+        MSCLine *l = cacheFind(sector + i);
+        if (!l && (count < MSC_LINE_SECTORS)) {
+            // Small reads are the FAT and directories, which are worth keeping
+            l = cacheAlloc(sector + i, &ok);
+        }
+        if (!l) {
+            continue;
+        }
+        uint8_t *c = l->data + ((sector + i) % MSC_LINE_SECTORS) * MSC_SECTOR;
+        if (l->valid & bit) {
+            if (cached || (l->dirty & bit)) {
+                memcpy(p, c, MSC_SECTOR);
+            }
+        } else {
+            memcpy(c, p, MSC_SECTOR);
+            l->valid |= bit;
+        }
+        l->lastUse = ++__msc.useCount;
+    }
+    return ok;
+}
+
+static bool cacheWrite(uint32_t sector, const uint8_t *buf, uint32_t count) {
+    if (!__msc.disk) {
+        return false;
+    }
+    bool ok = true;
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t bit = 1 << ((sector + i) % MSC_LINE_SECTORS);
+        MSCLine *l = cacheFind(sector + i);
+        if (!l) {
+            l = cacheAlloc(sector + i, &ok);
+        }
+        memcpy(l->data + ((sector + i) % MSC_LINE_SECTORS) * MSC_SECTOR, buf + i * MSC_SECTOR, MSC_SECTOR);
+        l->valid |= bit;
+        l->dirty |= bit;
+        l->lastUse = ++__msc.useCount;
+    }
+    return ok;
+}
+
+static void cacheInvalidate() {
+    for (auto &l : __msc.line) {
+        l.valid = 0;
+        l.dirty = 0;
+    }
+}
+
+
+// Bulk-only transport
+static void mscSense(uint8_t key, uint8_t asc) {
+    __msc.senseKey = key;
+    __msc.asc = asc;
+}
+
+static void mscArmCBW() {
+    __msc.stage = MSC_CMD;
+    usbd_edpt_xfer(0, __msc.epOut, (uint8_t *)&__msc.cbw, sizeof(msc_cbw_t));
+}
+
+static void mscSendCSW() {
+    __msc.csw.signature = MSC_CSW_SIGNATURE;
+    __msc.csw.tag = __msc.cbw.tag;
+    __msc.csw.data_residue = __msc.cbw.total_bytes - std::min(__msc.moved, __msc.cbw.total_bytes);
+    __msc.csw.status = __msc.status;
+    __msc.stage = MSC_STATUS_SENT;
+    usbd_edpt_xfer(0, __msc.epIn, (uint8_t *)&__msc.csw, sizeof(msc_csw_t));
+}
+
+// Ends the command.  If the host is still waiting for IN data it gets a stall first, and the
+// CSW once it clears it.  Unwanted OUT data is refused with a stall
+static void mscFinish(uint8_t status) {
+    __msc.status = status;
+    if (__msc.moved < __msc.cbw.total_bytes) {
+        if (__msc.cbw.dir & TUSB_DIR_IN_MASK) {
+            if (!__msc.moved || (status != MSC_CSW_STATUS_PASSED)) {
+                usbd_edpt_stall(0, __msc.epIn);
+                __msc.stage = MSC_STATUS;
+                return;
+            }
+        } else {
+            usbd_edpt_stall(0, __msc.epOut);
+        }
+    }
+    mscSendCSW();
+}
+
+static void mscRespond(const uint8_t *data, uint32_t len) {
+    len = std::min(len, __msc.cbw.total_bytes);
+    if (!len || !(__msc.cbw.dir & TUSB_DIR_IN_MASK)) {
+        mscFinish(MSC_CSW_STATUS_PASSED);
+        return;
+    }
+    memcpy(__msc.buf[0], data, len);
+    __msc.stage = MSC_DATA_IN;
+    usbd_edpt_xfer(0, __msc.epIn, __msc.buf[0], len);
+}
+
+static bool mscReady() {
+    if (!__msc.disk || __msc.ejected) {
+        mscSense(SENSE_NOT_READY, 0x3a); // Medium not present
+        return false;
+    }
+    if (__msc.changed) {
+        __msc.changed = false;
+        mscSense(SENSE_UNIT_ATTENTION, 0x28); // Medium may have changed
+        return false;
+    }
+    return true;
+}
+
+static void mscScheduleFlush() {
+    __msc.flushAt = millis() + USBMSC_FLUSH_MS;
+    __msc.flushPending = true;
+    __USBWakeTask(USBMSC_FLUSH_MS);
+}
+
+static bool mscFill(int i) {
+    uint32_t n = std::min(__msc.left, (uint32_t)MSC_LINE_SECTORS);
+    if (!cacheRead(__msc.lba, __msc.buf[i], n)) {
+        mscSense(SENSE_MEDIUM_ERROR, 0x11); // Unrecovered read error
+        __msc.failed = true;
+        return false;
+    }
+    __msc.lba += n;
+    __msc.left -= n;
+    __msc.bufLen[i] = n * MSC_SECTOR;
+    __msc.ready[i] = true;
+    return true;
+}
+
+// The next disk read happens while the controller sends the previous buffer
+static void mscReadStart() {
+    __msc.stage = MSC_READ;
+    __msc.ready[0] = false;
+    __msc.ready[1] = false;
+    if (!mscFill(0)) {
+        mscFinish(MSC_CSW_STATUS_FAILED);
+        return;
+    }
+    __msc.busy = 0;
+    usbd_edpt_xfer(0, __msc.epIn, __msc.buf[0], __msc.bufLen[0]);
+    if (__msc.left) {
+        mscFill(1);
+    }
+}
+
+static void mscReadDone(uint32_t xferred) {
+    int i = __msc.busy;
+    __msc.moved += xferred;
+    __msc.ready[i] = false;
+    if (__msc.ready[i ^ 1]) {
+        __msc.busy = i ^ 1;
+        usbd_edpt_xfer(0, __msc.epIn, __msc.buf[i ^ 1], __msc.bufLen[i ^ 1]);
+        if (__msc.left && !__msc.failed) {
+            mscFill(i);
+        }
+    } else {
+        mscFinish(__msc.failed ? MSC_CSW_STATUS_FAILED : MSC_CSW_STATUS_PASSED);
+    }
+}
+
+static void mscWriteArm(int i) {
+    uint32_t n = std::min(__msc.left, (uint32_t)MSC_LINE_SECTORS);
+    __msc.left -= n;
+    __msc.bufLen[i] = n * MSC_SECTOR;
+    __msc.busy = i;
+    usbd_edpt_xfer(0, __msc.epOut, __msc.buf[i], __msc.bufLen[i]);
+}
+
+// The host sends the next buffer while this one goes into the cache
+static void mscWriteDone(uint32_t xferred) {
+    int i = __msc.busy;
+    __msc.moved += xferred;
+    if (__msc.left) {
+        mscWriteArm(i ^ 1);
+    }
+    if (!__msc.failed && !cacheWrite(__msc.lba, __msc.buf[i], xferred / MSC_SECTOR)) {
+        mscSense(SENSE_MEDIUM_ERROR, 0x0c); // Write error
+        __msc.failed = true;
+    }
+    __msc.lba += xferred / MSC_SECTOR;
+    if (!__msc.left) {
+        mscScheduleFlush();
+        mscFinish(__msc.failed ? MSC_CSW_STATUS_FAILED : MSC_CSW_STATUS_PASSED);
+    }
+}
+
+// READ(10) and WRITE(10) range checks, leaves the sectors to move in __msc.lba and __msc.left
+static bool mscRange() {
+    uint8_t const *cmd = __msc.cbw.command;
+    uint32_t lba = ((uint32_t)cmd[2] << 24) | ((uint32_t)cmd[3] << 16) | ((uint32_t)cmd[4] << 8) | cmd[5];
+    uint32_t count = ((uint32_t)cmd[7] << 8) | cmd[8];
+    if (((uint64_t)lba + count) > __msc.disk->sectors()) {
+        mscSense(SENSE_ILLEGAL_REQUEST, 0x21); // LBA out of range
+        return false;
+    }
+    __msc.lba = lba;
+    __msc.left = std::min(count, __msc.cbw.total_bytes / MSC_SECTOR);
+    __msc.failed = false;
+    return true;
+}
+
+static void mscCommand() {
+    uint8_t const *cmd = __msc.cbw.command;
+    __msc.moved = 0;
+
+    switch (cmd[0]) {
+    case SCSI_CMD_TEST_UNIT_READY:
+        mscFinish(mscReady() ? MSC_CSW_STATUS_PASSED : MSC_CSW_STATUS_FAILED);
+        return;
+
+    case SCSI_CMD_INQUIRY: {
+        static const uint8_t inquiry[36] = {
+            0x00, 0x80, 0x04, 0x02, 31, 0, 0, 0, // Removable direct access device, SPC-2
+            'R', 'P', 'i', ' ', ' ', ' ', ' ', ' ',
+            'P', 'i', 'c', 'o', 'A', 'r', 'd', 'u', 'i', 'n', 'o', ' ', 'D', 'i', 's', 'k',
+            '1', '.', '0', ' '
+        };
+        mscRespond(inquiry, sizeof(inquiry));
+        return;
+    }
+
+    case SCSI_CMD_REQUEST_SENSE: {
+        uint8_t sense[18] = { 0x70, 0, __msc.senseKey, 0, 0, 0, 0, 10, 0, 0, 0, 0, __msc.asc, 0, 0, 0, 0, 0 };
+        mscSense(0, 0);
+        mscRespond(sense, sizeof(sense));
+        return;
+    }
+
+    case SCSI_CMD_MODE_SENSE_6: {
+        uint8_t mode[4] = { 3, 0, (uint8_t)(__msc.readOnly ? 0x80 : 0), 0 };
+        mscRespond(mode, sizeof(mode));
+        return;
+    }
+
+    case SCSI_CMD_READ_CAPACITY_10:
+    case SCSI_CMD_READ_FORMAT_CAPACITY: {
+        if (!mscReady()) {
+            mscFinish(MSC_CSW_STATUS_FAILED);
+            return;
+        }
+        uint32_t n = __msc.disk->sectors();
+        if (cmd[0] == SCSI_CMD_READ_CAPACITY_10) {
+            uint8_t cap[8] = { (uint8_t)((n - 1) >> 24), (uint8_t)((n - 1) >> 16), (uint8_t)((n - 1) >> 8), (uint8_t)(n - 1), 0, 0, MSC_SECTOR >> 8, 0 };
+            mscRespond(cap, sizeof(cap));
+        } else {
+            uint8_t cap[12] = { 0, 0, 0, 8, (uint8_t)(n >> 24), (uint8_t)(n >> 16), (uint8_t)(n >> 8), (uint8_t)n, 0x02, 0, MSC_SECTOR >> 8, 0 };
+            mscRespond(cap, sizeof(cap));
+        }
+        return;
+    }
+
+    case SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL:
+        // Removal being allowed is the host's hint that it's about to go away
+        if (!(cmd[4] & 1) && __msc.disk) {
+            cacheFlush();
+        }
+        mscFinish(MSC_CSW_STATUS_PASSED);
+        return;
+
+    case SCSI_CMD_START_STOP_UNIT:
+        if (__msc.disk) {
+            cacheFlush();
+            if (cmd[4] & 2) {
+                // Load/eject
+                __msc.ejected = !(cmd[4] & 1);
+            }
+        }
+        mscFinish(MSC_CSW_STATUS_PASSED);
+        return;
+
+    case SCSI_CMD_SYNCHRONIZE_CACHE_10:
+        if (!mscReady()) {
+            mscFinish(MSC_CSW_STATUS_FAILED);
+            return;
+        }
+        __msc.flushPending = false;
+        if (!cacheFlush()) {
+            mscSense(SENSE_MEDIUM_ERROR, 0x0c);
+            mscFinish(MSC_CSW_STATUS_FAILED);
+            return;
+        }
+        mscFinish(MSC_CSW_STATUS_PASSED);
+        return;
+
+    case SCSI_CMD_READ_10:
+        if (!mscReady() || !mscRange()) {
+            mscFinish(MSC_CSW_STATUS_FAILED);
+        } else if (!__msc.left) {
+            mscFinish(MSC_CSW_STATUS_PASSED);
+        } else {
+            mscReadStart();
+        }
+        return;
+
+    case SCSI_CMD_WRITE_10:
+        if (!mscReady()) {
+            mscFinish(MSC_CSW_STATUS_FAILED);
+        } else if (__msc.readOnly) {
+            mscSense(SENSE_DATA_PROTECT, 0x27); // Write protected
+            mscFinish(MSC_CSW_STATUS_FAILED);
+        } else if (!mscRange()) {
+            mscFinish(MSC_CSW_STATUS_FAILED);
+        } else if (!__msc.left) {
+            mscFinish(MSC_CSW_STATUS_PASSED);
+        } else {
+            __msc.stage = MSC_WRITE;
+            mscWriteArm(0);
+        }
+        return;
+
+    default:
+        mscSense(SENSE_ILLEGAL_REQUEST, 0x20); // Invalid command
+        mscFinish(MSC_CSW_STATUS_FAILED);
+        return;
+    }
+}
+
+static void mscInit() {
+}
+
+static void mscReset(uint8_t rhport) {
+    (void) rhport;
+    // The cache survives, it is written back by the USB task or USBMassStorage.end()
+    __msc.open = false;
+    __msc.stage = MSC_CMD;
+}
+
+static uint16_t mscOpen(uint8_t rhport, tusb_desc_interface_t const *desc, uint16_t max_len) {
+    if ((desc->bInterfaceClass != TUSB_CLASS_MSC) || (desc->bInterfaceNumber != __USBGetMassStorageInterface())) {
+        return 0;
+    }
+    uint16_t len = sizeof(tusb_desc_interface_t) + 2 * sizeof(tusb_desc_endpoint_t);
+    if (max_len < len) {
+        return 0;
+    }
+    if (!usbd_open_edpt_pair(rhport, tu_desc_next(desc), 2, TUSB_XFER_BULK, &__msc.epOut, &__msc.epIn)) {
+        return 0;
+    }
+    __msc.open = true;
+    mscArmCBW();
+    return len;
+}
+
+static bool mscControl(uint8_t rhport, uint8_t stage, tusb_control_request_t const *req) {
+    if (stage != CONTROL_STAGE_SETUP) {
+        return true;
+    }
+
+    // Clearing a halt is how the host moves on after a stalled data phase or a reset
+    if ((req->bmRequestType_bit.type == TUSB_REQ_TYPE_STANDARD) && (req->bmRequestType_bit.recipient == TUSB_REQ_RCPT_ENDPOINT) &&
+            (req->bRequest == TUSB_REQ_CLEAR_FEATURE) && (req->wValue == TUSB_REQ_FEATURE_EDPT_HALT)) {
+        uint8_t ep = tu_u16_low(req->wIndex);
+        if (__msc.stage == MSC_NEED_RESET) {
+            usbd_edpt_stall(rhport, ep);
+        } else if ((ep == __msc.epIn) && (__msc.stage == MSC_STATUS)) {
+            mscSendCSW();
+        } else if ((ep == __msc.epOut) && (__msc.stage == MSC_CMD) && !usbd_edpt_busy(rhport, ep)) {
+            mscArmCBW();
+        }
+        return true;
+    }
+
+    if ((req->bmRequestType_bit.type != TUSB_REQ_TYPE_CLASS) || ((uint8_t)req->wIndex != __USBGetMassStorageInterface())) {
+        return false;
+    }
+    switch (req->bRequest) {
+    case MSC_REQ_RESET:
+        __msc.stage = MSC_CMD;
+        return tud_control_status(rhport, req);
+    case MSC_REQ_GET_MAX_LUN: {
+        static uint8_t maxLUN = 0;
+        return tud_control_xfer(rhport, req, &maxLUN, 1);
+    }
+    default:
+        return false;
+    }
+}
+
+static bool mscXfer(uint8_t rhport, uint8_t ep, xfer_result_t result, uint32_t xferred) {
+    (void) result;
+    if (!__msc.open) {
+        return false;
+    }
+    if (ep == __msc.epOut) {
+        if (__msc.stage == MSC_CMD) {
+            if ((xferred != sizeof(msc_cbw_t)) || (__msc.cbw.signature != MSC_CBW_SIGNATURE)) {
+                // Not a valid CBW, the host has to do a reset recovery
+                __msc.stage = MSC_NEED_RESET;
+                usbd_edpt_stall(rhport, __msc.epIn);
+                usbd_edpt_stall(rhport, __msc.epOut);
+            } else {
+                mscCommand();
+            }
+        } else if (__msc.stage == MSC_WRITE) {
+            mscWriteDone(xferred);
+        }
+        return true;
+    } else if (ep == __msc.epIn) {
+        if (__msc.stage == MSC_DATA_IN) {
+            __msc.moved = xferred;
+            mscFinish(MSC_CSW_STATUS_PASSED);
+        } else if (__msc.stage == MSC_READ) {
+            mscReadDone(xferred);
+        } else if (__msc.stage == MSC_STATUS_SENT) {
+            // A stalled OUT gets the next CBW armed once the host clears it
+            if (usbd_edpt_stalled(rhport, __msc.epOut)) {
+                __msc.stage = MSC_CMD;
+            } else {
+                mscArmCBW();
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+extern const usbd_class_driver_t __USBMassStorageDriver = {
+#if CFG_TUSB_DEBUG >= 2
+    .name = "USBMassStorage",
+#endif
+    .init = mscInit,
+    .reset = mscReset,
+    .open = mscOpen,
+    .control_xfer_cb = mscControl,
+    .xfer_cb = mscXfer,
+};
+
+// Called from the USB task with __usb_mutex held.  Returns ms until it needs to run again, 0 for never
+uint32_t __USBMassStorageTask() {
+    if (!__msc.flushPending) {
+        return 0;
+    }
+    int32_t left = (int32_t)(__msc.flushAt - millis());
+    if ((left <= 0) && (__msc.stage != MSC_CMD)) {
+        // Mid-command, try again after it
+        left = 10;
+    }
+    if (left > 0) {
+        return left;
+    }
+    __msc.flushPending = false;
+    cacheFlush();
+    return 0;
+}
+
+
+bool USBMassStorageClass::begin(USBMSCDisk *disk, bool readOnly) {
+    __USBStart();
+    CoreMutex m(&__usb_mutex, false);
+    if (!m || !disk) {
+        return false;
+    }
+    if (__msc.disk) {
+        cacheFlush();
+    }
+    cacheInvalidate();
+    __msc.disk = disk;
+    __msc.readOnly = readOnly;
+    __msc.ejected = false;
+    __msc.changed = true;
+    _running = true;
+    return true;
+}
+
+void USBMassStorageClass::end() {
+    CoreMutex m(&__usb_mutex, false);
+    if (!_running || !m) {
+        return;
+    }
+    cacheFlush();
+    cacheInvalidate();
+    __msc.flushPending = false;
+    __msc.disk = nullptr;
+    __msc.changed = true;
+    _running = false;
+}
+
+void USBMassStorageClass::flush() {
+    CoreMutex m(&__usb_mutex, false);
+    if (!_running || !m) {
+        return;
+    }
+    __msc.flushPending = false;
+    cacheFlush();
+}
+
+USBMassStorageClass USBMassStorage;
+
+
+extern uint8_t _FS_start;
+extern uint8_t _FS_end;
+
+USBMSCFlashDisk::USBMSCFlashDisk() : _offset((uint32_t)&_FS_start - XIP_BASE), _len(&_FS_end - &_FS_start) {
+}
+
+USBMSCFlashDisk::USBMSCFlashDisk(uint32_t offset, uint32_t len) : _offset(offset), _len(len) {
+}
+
+bool USBMSCFlashDisk::read(uint32_t sector, uint8_t *buf, uint32_t count) {
+    if ((uint64_t)(sector + count) * MSC_SECTOR > _len) {
+        return false;
+    }
+    // Bypass the XIP cache so a whole-disk copy doesn't evict the running code
+    memcpy(buf, (const uint8_t *)(XIP_NOCACHE_NOALLOC_BASE + _offset + sector * MSC_SECTOR), count * MSC_SECTOR);
+    return true;
+}
+
+bool USBMSCFlashDisk::write(uint32_t sector, const uint8_t *buf, uint32_t count) {
+    if ((sector % MSC_LINE_SECTORS) || (count % MSC_LINE_SECTORS) || ((uint64_t)(sector + count) * MSC_SECTOR > _len)) {
+        return false;
+    }
+    uint32_t off = _offset + sector * MSC_SECTOR;
+    return __flashErase(off, count * MSC_SECTOR) && __flashProgram(off, buf, count * MSC_SECTOR);
+}
+
+#endif
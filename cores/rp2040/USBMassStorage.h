@@ -0,0 +1,91 @@
+/*
+    USB Mass Storage (bulk-only SCSI disk) for the built-in USB stack
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Write-back cache lines of 8 sectors (4KB) each, in front of the exported disk
+#ifndef USBMSC_CACHE_LINES
+#define USBMSC_CACHE_LINES 4
+#endif
+
+// Dirty cache lines are written back once the host has been quiet for this long
+#ifndef USBMSC_FLUSH_MS
+#define USBMSC_FLUSH_MS 500
+#endif
+
+// Storage behind USBMassStorage, in 512 byte sectors.  Called from the USB task with
+// __usb_mutex held, so the sketch must not use the same medium while it is exported
+class USBMSCDisk {
+public:
+    virtual ~USBMSCDisk() { }
+    virtual uint32_t sectors() = 0;
+    virtual bool read(uint32_t sector, uint8_t *buf, uint32_t count) = 0;
+    virtual bool write(uint32_t sector, const uint8_t *buf, uint32_t count) = 0;
+    virtual bool sync() {
+        return true;
+    }
+    // Media that erase in 4KB blocks only get whole, aligned cache lines written
+    virtual bool wholeLines() {
+        return false;
+    }
+};
+
+// A region of the onboard flash, by default the one reserved for the filesystem by the
+// Tools->Flash Size menu.  The host sees an unformatted disk the first time and can put
+// FAT on it, this is not a way to read a LittleFS filesystem
+class USBMSCFlashDisk : public USBMSCDisk {
+public:
+    USBMSCFlashDisk();
+    USBMSCFlashDisk(uint32_t offset, uint32_t len); // Offset from the start of flash, 4KB aligned
+
+    uint32_t sectors() override {
+        return _len / 512;
+    }
+    bool read(uint32_t sector, uint8_t *buf, uint32_t count) override;
+    bool write(uint32_t sector, const uint8_t *buf, uint32_t count) override;
+    bool wholeLines() override {
+        return true;
+    }
+
+private:
+    uint32_t _offset;
+    uint32_t _len;
+};
+
+// Exports a USBMSCDisk to the host as a removable SCSI disk, only added to the USB
+// configuration when the sketch uses it.  Sector reads and writes are pipelined against
+// the USB transfers and go through a write-back cache of USBMSC_CACHE_LINES lines.
+class USBMassStorageClass {
+public:
+    // The disk appears to the host as newly inserted media
+    bool begin(USBMSCDisk *disk, bool readOnly = false);
+    // Writes back the cache and ejects the media
+    void end();
+    // Writes back any dirty cache lines
+    void flush();
+
+private:
+    bool _running = false;
+};
+
+extern USBMassStorageClass USBMassStorage;
@@ -126,16 +126,28 @@ bool IPAddress::operator==(const uint8_t* addr) const {
 }
 
 size_t IPAddress::printTo(Print& p) const {
-    String s = toString();
-    return p.print(s);
+    char buf[STRING_LEN];
+    size_t len = toString(buf, sizeof(buf));
+    return p.write(buf, len);
 }
 
 String IPAddress::toString() const
 {
-    String s;
+    char buf[STRING_LEN];
+    toString(buf, sizeof(buf));
+    return String(buf);
+}
 
+size_t IPAddress::toString(char* buf, size_t len) const
+{
     if (!isSet())
-        return "(IP unset)";
+        return snprintf(buf, len, "(IP unset)");
+
+    size_t pos = 0;
+    // Appends while there's room, but keeps counting so the full length is returned
+    auto add = [&](const char *fmt, unsigned v) {
+        pos += snprintf(pos < len ? buf + pos : nullptr, pos < len ? len - pos : 0, fmt, v);
+    };
 
 #if LWIP_IPV6
     if (isV6()) {
@@ -143,32 +155,23 @@ String IPAddress::toString() const
         for (int i = 0; i < 8; i++) {
             uint16_t bit = PP_NTOHS(raw6()[i]);
             if (bit || count0 < 0) {
-                char buff[64];
-                snprintf(buff, 64, "%x", bit);
-                buff[63] = 0;
-                s += buff;
+                add("%x", bit);
                 if (count0 > 0)
                     // no more hiding 0
                     count0 = -8;
             } else
                 count0++;
             if ((i != 7 && count0 < 2) || count0 == 7)
-                s += ':';
+                add(":", 0);
         }
-        return s;
+        return pos;
     }
 #endif
 
     for(int i = 0; i < 4; i++) {
-        char buff[16];
-        snprintf(buff, 16, "%d", (*this)[i]);
-        buff[15] = 0;
-        s += buff;
-        if (i != 3)
-            s += '.';
+        add(i != 3 ? "%u." : "%u", (*this)[i]);
     }
-    return s;
-
+    return pos;
 }
 
 bool IPAddress::isValid(const String& arg) {
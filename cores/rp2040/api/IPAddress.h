@@ -144,6 +144,10 @@ class IPAddress: public Printable {
 
         virtual size_t printTo(Print& p) const;
         String toString() const;
+        // Formats into buf without allocating, truncated to len - 1 characters.  Returns the
+        // full length, and any address fits in STRING_LEN bytes.
+        size_t toString(char* buf, size_t len) const;
+        static constexpr size_t STRING_LEN = 40;
 
         void clear();
 
@@ -230,6 +234,21 @@ class IPAddress: public Printable {
 
 };
 
+// An address formatted on the stack, for printf()-style calls:
+//    printf("%s\n", IPAddressString(ip).c_str());
+class IPAddressString {
+    public:
+        IPAddressString(const IPAddress& ip) {
+            ip.toString(_str, sizeof(_str));
+        }
+        const char* c_str() const {
+            return _str;
+        }
+
+    private:
+        char _str[IPAddress::STRING_LEN];
+};
+
 extern const IPAddress INADDR_ANY;
 extern const IPAddress INADDR_NONE;
 
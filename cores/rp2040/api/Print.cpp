@@ -29,7 +29,7 @@ using namespace arduino;
 // Public Methods //////////////////////////////////////////////////////////////
 
 /* default implementation: may be overridden */
-size_t Print::write(const uint8_t *buffer, size_t size)
+size_t __hot_code_func(Print::write)(const uint8_t *buffer, size_t size)
 {
   size_t n = 0;
   while (size--) {
@@ -61,12 +61,12 @@ size_t Print::print(const String &s)
   return write(s.c_str(), s.length());
 }
 
-size_t Print::print(const char str[])
+size_t __hot_code_func(Print::print)(const char str[])
 {
   return write(str);
 }
 
-size_t Print::print(char c)
+size_t __hot_code_func(Print::print)(char c)
 {
   return write(c);
 }
@@ -86,7 +86,7 @@ size_t Print::print(unsigned int n, int base)
   return print((unsigned long) n, base);
 }
 
-size_t Print::print(long n, int base)
+size_t __hot_code_func(Print::print)(long n, int base)
 {
   if (base == 0) {
     return write(n);
@@ -102,7 +102,7 @@ size_t Print::print(long n, int base)
   }
 }
 
-size_t Print::print(unsigned long n, int base)
+size_t __hot_code_func(Print::print)(unsigned long n, int base)
 {
   if (base == 0) return write(n);
   else return printNumber(n, base);
@@ -130,7 +130,7 @@ size_t Print::print(unsigned long long n, int base)
   else return printULLNumber(n, base);
 }
 
-size_t Print::print(double n, int digits)
+size_t __hot_code_func(Print::print)(double n, int digits)
 {
   return printFloat(n, digits);
 }
@@ -147,7 +147,7 @@ size_t Print::print(const Printable& x)
   return x.printTo(*this);
 }
 
-size_t Print::println(void)
+size_t __hot_code_func(Print::println)(void)
 {
   return write("\r\n");
 }
@@ -159,7 +159,7 @@ size_t Print::println(const String &s)
   return n;
 }
 
-size_t Print::println(const char c[])
+size_t __hot_code_func(Print::println)(const char c[])
 {
   size_t n = print(c);
   n += println();
@@ -236,194 +236,890 @@ size_t Print::println(const Printable& x)
   return n;
 }
 
-size_t Print::printf(const char *format, ...) {
-    va_list arg;
-    va_start(arg, format);
-    char temp[64];
-    char* buffer = temp;
-    size_t len = vsnprintf(temp, sizeof(temp), format, arg);
-    va_end(arg);
-    if (len > sizeof(temp) - 1) {
-        buffer = new char[len + 1];
-        if (!buffer) {
-            return 0;
+// Streaming printf engine -- output is formatted straight into a small stack
+// buffer that is handed to write() in chunks, so nothing is allocated and the
+// format string is only walked once.  Floats are converted here as well so
+// Print doesn't depend on newlib's _printf_float.
+
+namespace {
+
+class PrintfSink {
+public:
+    PrintfSink(Print *p) : _p(p), _used(0), _count(0), _written(0) { }
+
+    void put(char c) {
+        _buf[_used++] = c;
+        _count++;
+        if (_used == sizeof(_buf)) {
+            flush();
         }
-        va_start(arg, format);
-        vsnprintf(buffer, len + 1, format, arg);
-        va_end(arg);
     }
-    len = write((const uint8_t*) buffer, len);
-    if (buffer != temp) {
-        delete[] buffer;
+
+    void put(const char *s, size_t n) {
+        if (n >= sizeof(_buf)) {
+            // Long strings go straight through instead of being copied
+            flush();
+            _written += _p->write((const uint8_t *)s, n);
+            _count += n;
+            return;
+        }
+        while (n--) {
+            put(*s++);
+        }
     }
-    return len;
+
+    void pad(char c, int n) {
+        while (n-- > 0) {
+            put(c);
+        }
+    }
+
+    void flush() {
+        if (_used) {
+            _written += _p->write((const uint8_t *)_buf, _used);
+            _used = 0;
+        }
+    }
+
+    // Characters generated so far, for %n
+    size_t count() const {
+        return _count;
+    }
+
+    size_t written() const {
+        return _written;
+    }
+
+private:
+    Print *_p;
+    char _buf[32];
+    size_t _used;
+    size_t _count;
+    size_t _written;
+};
+
+enum {
+    F_LEFT  = 1,
+    F_PLUS  = 2,
+    F_SPACE = 4,
+    F_ALT   = 8,
+    F_ZERO  = 16,
+    F_UPPER = 32,
+};
+
+const char digitPairs[] =
+    "00010203040506070809" "10111213141516171819" "20212223242526272829" "30313233343536373839"
+    "40414243444546474849" "50515253545556575859" "60616263646566676869" "70717273747576777879"
+    "80818283848586878889" "90919293949596979899";
+
+// Writes v in decimal backwards from end, returning the digit count.  Each group of four
+// digits costs one (SIO hardware) division, and is split into pairs for the lookup table by
+// a reciprocal multiply that stays within the M0+'s 32-bit MULS: (r * 5243) >> 19 == r / 100
+// for every r < 10000.
+int formatDecimal32(char *end, uint32_t v) {
+    char *p = end;
+    while (v >= 10000) {
+        uint32_t q = v / 10000;
+        uint32_t r = v - q * 10000;
+        v = q;
+        uint32_t hi = (r * 5243) >> 19;
+        uint32_t lo = r - hi * 100;
+        p -= 4;
+        memcpy(p, digitPairs + 2 * hi, 2);
+        memcpy(p + 2, digitPairs + 2 * lo, 2);
+    }
+    if (v >= 100) {
+        uint32_t hi = (v * 5243) >> 19;
+        uint32_t lo = v - hi * 100;
+        p -= 2;
+        memcpy(p, digitPairs + 2 * lo, 2);
+        v = hi;
+    }
+    if (v >= 10) {
+        p -= 2;
+        memcpy(p, digitPairs + 2 * v, 2);
+    } else {
+        *--p = '0' + v;
+    }
+    return end - p;
 }
 
-// TODO - must be better way than cut-n-paste!
-size_t Print::printf_P(const char *format, ...) {
-    va_list arg;
-    va_start(arg, format);
-    char temp[64];
-    char* buffer = temp;
-    size_t len = vsnprintf(temp, sizeof(temp), format, arg);
-    va_end(arg);
-    if (len > sizeof(temp) - 1) {
-        buffer = new char[len + 1];
-        if (!buffer) {
-            return 0;
+// 64-bit values are split into 9-digit pieces so only the top needs 64-bit division
+int formatDecimal(char *end, unsigned long long v) {
+    char *p = end;
+    while (v >> 32) {
+        unsigned long long q = v / 1000000000;
+        uint32_t r = v - q * 1000000000;
+        v = q;
+        int n = formatDecimal32(p, r);
+        p -= n;
+        while (n++ < 9) {
+            *--p = '0';
         }
-        va_start(arg, format);
-        vsnprintf(buffer, len + 1, format, arg);
-        va_end(arg);
     }
-    len = write((const uint8_t*) buffer, len);
-    if (buffer != temp) {
-        delete[] buffer;
+    p -= formatDecimal32(p, (uint32_t)v);
+    return end - p;
+}
+
+// Writes the digits of v in any base from 2 to 36 backwards from end, returning how many were written
+int formatUnsigned(char *end, unsigned long long v, unsigned base, bool upper) {
+    if (base == 10) {
+        return formatDecimal(end, v);
     }
-    return len;
+    const char *xdig = upper ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" : "0123456789abcdefghijklmnopqrstuvwxyz";
+    char *p = end;
+    if (!(base & (base - 1))) {
+        // Powers of two are just shifts
+        int shift = __builtin_ctz(base);
+        unsigned mask = base - 1;
+        do {
+            *--p = xdig[v & mask];
+            v >>= shift;
+        } while (v);
+        return end - p;
+    }
+    // Stay in 32 bits whenever possible, 64-bit division is a library call
+    while (v > 0xffffffffULL) {
+        *--p = xdig[v % base];
+        v /= base;
+    }
+    uint32_t v32 = (uint32_t)v;
+    do {
+        *--p = xdig[v32 % base];
+        v32 /= base;
+    } while (v32);
+    return end - p;
 }
 
-// Private Methods /////////////////////////////////////////////////////////////
+// Emits prefix/zeros/body with the field width applied around them
+void emitField(PrintfSink &out, const char *prefix, int prefixLen, int zeros, const char *body, int bodyLen, int width, int flags) {
+    int len = prefixLen + zeros + bodyLen;
+    int padLen = width > len ? width - len : 0;
+    if (!(flags & F_LEFT) && !(flags & F_ZERO)) {
+        out.pad(' ', padLen);
+    }
+    out.put(prefix, prefixLen);
+    if (!(flags & F_LEFT) && (flags & F_ZERO)) {
+        out.pad('0', padLen);
+    }
+    out.pad('0', zeros);
+    out.put(body, bodyLen);
+    if (flags & F_LEFT) {
+        out.pad(' ', padLen);
+    }
+}
 
-size_t Print::printNumber(unsigned long n, uint8_t base)
-{
-  char buf[8 * sizeof(long) + 1]; // Assumes 8-bit chars plus zero byte.
-  char *str = &buf[sizeof(buf) - 1];
+const uint32_t pow10u32[10] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+#define PRINTF_CHUNKS 40 // Base-1e9 chunks, enough for the 309 integer digits of DBL_MAX plus fraction
+
+// Exact, correctly rounded (half to even) decimal digits of a finite double >= 0.  The value is
+// expanded in base 1e9 using only integer math, as musl does, so nothing is lost to float scaling.
+// Either prec significant digits are kept (sig) or every digit down to 10^-prec.
+class FloatDigits {
+public:
+    FloatDigits(double v, bool sig, int prec) {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        int be = (bits >> 52) & 0x7ff;
+        uint64_t m = bits & ((1ULL << 52) - 1);
+        if (be) {
+            m |= 1ULL << 52;
+        } else {
+            be = 1;
+        }
+        int e2 = be - 1075; // v = m * 2^e2
+
+        // A spare chunk ahead of the digits takes any carry out of the top when rounding
+        _chunk[0] = 0;
+        uint32_t *ch = _chunk + 1;
+        int n = 0;
+
+        // Integer part, produced least significant chunk first and reversed after
+        uint64_t frac = 0;
+        uint64_t ip;
+        if (e2 >= 0) {
+            frac = 0;
+            if (e2 <= 11) {
+                ip = m << e2;
+            } else {
+                uint32_t w[34] = { 0 };
+                int ws = e2 / 32;
+                int bs = e2 % 32;
+                w[ws] = (uint32_t)(m << bs);
+                w[ws + 1] = (uint32_t)((m << bs) >> 32);
+                w[ws + 2] = bs ? (uint32_t)(m >> (64 - bs)) : 0;
+                int nw = ws + 3;
+                while (nw && !w[nw - 1]) {
+                    nw--;
+                }
+                while (nw) {
+                    uint64_t rem = 0;
+                    for (int i = nw - 1; i >= 0; i--) {
+                        uint64_t cur = (rem << 32) | w[i];
+                        w[i] = cur / 1000000000;
+                        rem = cur % 1000000000;
+                    }
+                    ch[n++] = rem;
+                    while (nw && !w[nw - 1]) {
+                        nw--;
+                    }
+                }
+                ip = 0;
+            }
+        } else if (e2 > -64) {
+            ip = m >> -e2;
+            frac = m & ((1ULL << -e2) - 1);
+        } else {
+            ip = 0;
+            frac = m;
+        }
+        while (ip) {
+            if (ip >> 32) {
+                ch[n++] = ip % 1000000000;
+                ip /= 1000000000;
+            } else {
+                // 32-bit division is far cheaper, so switch as soon as it fits
+                uint32_t ip32 = ip;
+                ch[n++] = ip32 % 1000000000;
+                ip = ip32 / 1000000000;
+            }
+        }
+        for (int i = 0; i < n / 2; i++) {
+            uint32_t t = ch[i];
+            ch[i] = ch[n - 1 - i];
+            ch[n - 1 - i] = t;
+        }
+        int topExp = 9 * n - 1; // Exponent of the first digit of ch[0] when padded to 9 digits
+
+        // The fraction is frac / 2^-e2, scaled up to a whole number of 32-bit words so each
+        // multiply by 1e9 carries the next 9 digits out of the top
+        uint32_t fw[34];
+        int fwn = 0;
+        int lo = 0;
+        if (frac) {
+            fwn = (-e2 + 31) / 32;
+            int s = 32 * fwn + e2;
+            memset(fw, 0, fwn * sizeof(uint32_t));
+            uint64_t l = frac << s;
+            fw[0] = (uint32_t)l;
+            if (fwn > 1) {
+                fw[1] = (uint32_t)(l >> 32);
+            }
+            if (fwn > 2) {
+                fw[2] = s ? (uint32_t)(frac >> (64 - s)) : 0;
+            }
+            while (!fw[lo]) {
+                lo++;
+            }
+        }
+        auto nextFrac = [&]() -> uint32_t {
+            uint64_t carry = 0;
+            for (int i = lo; i < fwn; i++) {
+                uint64_t t = (uint64_t)fw[i] * 1000000000 + carry;
+                fw[i] = (uint32_t)t;
+                carry = t >> 32;
+            }
+            while ((lo < fwn) && !fw[lo]) {
+                lo++;
+            }
+            return carry;
+        };
+
+        // Work out how many digits are kept, counting from the padded start of ch[0]
+        int keep;
+        if (sig) {
+            if (!n) {
+                topExp = -1;
+                while (lo < fwn) {
+                    uint32_t c = nextFrac();
+                    if (c) {
+                        ch[n++] = c;
+                        break;
+                    }
+                    topExp -= 9;
+                }
+            }
+            int lz = 9;
+            if (n) {
+                while ((lz > 0) && (ch[0] >= pow10u32[9 - lz])) {
+                    lz--;
+                }
+            }
+            keep = lz + prec;
+        } else {
+            if (!n) {
+                topExp = -1;
+            }
+            keep = topExp + 1 + prec;
+        }
+        if (keep > 9 * PRINTF_CHUNKS - 1) {
+            keep = 9 * PRINTF_CHUNKS - 1;
+        }
+        while ((n * 9 < keep + 1) && (lo < fwn)) {
+            ch[n++] = nextFrac();
+        }
 
-  *str = '\0';
+        // Round at digit keep, using everything past it to break ties
+        bool sticky = lo < fwn;
+        int kc = keep / 9;
+        int kw = keep % 9;
+        int roundDigit = 0;
+        if (kc < n) {
+            roundDigit = (ch[kc] / pow10u32[8 - kw]) % 10;
+            if (ch[kc] % pow10u32[8 - kw]) {
+                sticky = true;
+            }
+            for (int i = kc + 1; i < n; i++) {
+                if (ch[i]) {
+                    sticky = true;
+                }
+            }
+            ch[kc] -= ch[kc] % pow10u32[9 - kw];
+            n = kw ? kc + 1 : kc;
+        }
+        // Chunks past n are zero, so reading the digit before keep only needs it in range
+        int pc = (keep - 1 + 9) / 9 - 1; // floor((keep - 1) / 9), keep may be 0
+        int pw = (keep - 1) - 9 * pc;
+        bool odd = false;
+        if ((pc >= 0) && (pc < n)) {
+            odd = (ch[pc] / pow10u32[8 - pw]) & 1;
+        }
+        if ((roundDigit > 5) || ((roundDigit == 5) && (sticky || odd))) {
+            while (n <= pc) {
+                ch[n++] = 0;
+            }
+            ch[pc] += pow10u32[8 - pw];
+            while ((pc >= 0) && (ch[pc] >= 1000000000)) {
+                ch[pc] -= 1000000000;
+                ch[--pc]++;
+            }
+            if (pc < 0) {
+                // Carried into the spare chunk, which now leads
+                ch--;
+                n++;
+                topExp += 9;
+                keep += 9;
+            }
+        }
+        _ch = ch;
+        _n = n;
 
-  // prevent crash if called with base == 1
-  if (base < 2) base = 10;
+        // Leading zeros are skipped, trailing ones are left implicit
+        int first = 0;
+        while ((first < n) && !ch[first]) {
+            first++;
+        }
+        if (first == n) {
+            exp = 0;
+            count = 0;
+            _first = 0;
+            return;
+        }
+        int lead = 9;
+        while ((lead > 0) && (ch[first] >= pow10u32[9 - lead])) {
+            lead--;
+        }
+        _first = 9 * first + lead;
+        exp = topExp - _first;
+        int last = n - 1;
+        while (!ch[last]) {
+            last--;
+        }
+        int tz = 0;
+        while ((ch[last] % pow10u32[tz + 1]) == 0) {
+            tz++;
+        }
+        count = 9 * last + 9 - tz - _first;
+    }
 
-  do {
-    char c = n % base;
-    n /= base;
+    // Digit i counting from the first significant one, which is at 10^exp.  Digits are read
+    // in order, so each chunk is converted to text once when first touched.
+    char digit(int i) {
+        if ((i < 0) || (i >= count)) {
+            return '0';
+        }
+        int j = _first + i;
+        int c = j / 9;
+        if (c != _cached) {
+            char *end = _text + 9;
+            int n = formatDecimal32(end, _ch[c]);
+            memset(_text, '0', 9 - n);
+            _cached = c;
+        }
+        return _text[j % 9];
+    }
 
-    *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  } while(n);
+    int exp;    // Decimal exponent of the first significant digit
+    int count;  // Significant digits up to the last non-zero one, 0 when the value rounded to zero
+
+private:
+    uint32_t _chunk[PRINTF_CHUNKS + 1];
+    uint32_t *_ch;
+    int _n;
+    int _first;
+    int _cached = -1;
+    char _text[9];
+};
+
+void formatFloat(PrintfSink &out, double v, char conv, int prec, int width, int flags) {
+    char sign = 0;
+    if (signbit(v)) {
+        sign = '-';
+        v = -v;
+    } else if (flags & F_PLUS) {
+        sign = '+';
+    } else if (flags & F_SPACE) {
+        sign = ' ';
+    }
+    bool upper = (conv == 'F') || (conv == 'E') || (conv == 'G');
+    if (!isfinite(v)) {
+        const char *txt = isnan(v) ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf");
+        emitField(out, &sign, sign ? 1 : 0, 0, txt, 3, width, flags & ~F_ZERO);
+        return;
+    }
+    if (prec < 0) {
+        prec = 6;
+    }
 
-  return write(str);
+    bool expStyle = (conv == 'e') || (conv == 'E');
+    bool gStyle = (conv == 'g') || (conv == 'G');
+    int P = prec ? prec : 1;
+    FloatDigits d(v, expStyle || gStyle, expStyle ? prec + 1 : gStyle ? P : prec);
+    int e = d.count ? d.exp : 0;
+    if (gStyle) {
+        expStyle = !((P > e) && (e >= -4));
+        prec = expStyle ? P - 1 : P - 1 - e;
+        if (!(flags & F_ALT)) {
+            // Trailing zeros are dropped, along with the point if nothing is left after it
+            int keep = d.count - 1 - (expStyle ? 0 : e);
+            if (keep < 0) {
+                keep = 0;
+            }
+            if (prec > keep) {
+                prec = keep;
+            }
+        }
+    }
+    bool point = prec || (flags & F_ALT);
+
+    // Everything is sized up front so the width padding can go out before the number
+    char expBuf[8];
+    int expLen = 0;
+    int len;
+    if (expStyle) {
+        char *end = expBuf + sizeof(expBuf);
+        int n = formatUnsigned(end, e < 0 ? -e : e, 10, false);
+        if (n < 2) {
+            *(end - ++n) = '0';
+        }
+        *(end - ++n) = e < 0 ? '-' : '+';
+        *(end - ++n) = upper ? 'E' : 'e';
+        memmove(expBuf, end - n, n);
+        expLen = n;
+        len = 1 + (point ? 1 + prec : 0) + expLen;
+    } else {
+        len = (e >= 0 ? e + 1 : 1) + (point ? 1 + prec : 0);
+    }
+    int total = len + (sign ? 1 : 0);
+    int padLen = width > total ? width - total : 0;
+    if (!(flags & (F_LEFT | F_ZERO))) {
+        out.pad(' ', padLen);
+    }
+    if (sign) {
+        out.put(sign);
+    }
+    if (!(flags & F_LEFT) && (flags & F_ZERO)) {
+        out.pad('0', padLen);
+    }
+    if (expStyle) {
+        out.put(d.digit(0));
+        if (point) {
+            out.put('.');
+        }
+        for (int i = 1; i <= prec; i++) {
+            out.put(d.digit(i));
+        }
+        out.put(expBuf, expLen);
+    } else {
+        if (e >= 0) {
+            for (int i = 0; i <= e; i++) {
+                out.put(d.digit(i));
+            }
+        } else {
+            out.put('0');
+        }
+        if (point) {
+            out.put('.');
+        }
+        for (int i = 1; i <= prec; i++) {
+            out.put(d.digit(e + i));
+        }
+    }
+    if (flags & F_LEFT) {
+        out.pad(' ', padLen);
+    }
 }
 
-// REFERENCE IMPLEMENTATION FOR ULL
-// size_t Print::printULLNumber(unsigned long long n, uint8_t base)
-// {
-  // // if limited to base 10 and 16 the bufsize can be smaller
-  // char buf[65];
-  // char *str = &buf[64];
 
-  // *str = '\0';
+// %a: a leading 1 (0 for zero and subnormals), the 52 fraction bits as 13 hex digits with
+// trailing zeros dropped unless a precision asks for them, and a binary exponent
+void formatHexFloat(PrintfSink &out, double v, bool upper, int prec, int width, int flags) {
+    char sign = 0;
+    if (signbit(v)) {
+        sign = '-';
+        v = -v;
+    } else if (flags & F_PLUS) {
+        sign = '+';
+    } else if (flags & F_SPACE) {
+        sign = ' ';
+    }
+    if (!isfinite(v)) {
+        const char *txt = isnan(v) ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf");
+        emitField(out, &sign, sign ? 1 : 0, 0, txt, 3, width, flags & ~F_ZERO);
+        return;
+    }
 
-  // // prevent crash if called with base == 1
-  // if (base < 2) base = 10;
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    int bexp = (bits >> 52) & 0x7ff;
+    uint64_t frac = bits & ((1ULL << 52) - 1);
+    int lead = bexp ? 1 : 0;
+    int e = bexp ? bexp - 1023 : (frac ? -1022 : 0);
+    int digits = 13; // Hex digits held in frac
+    if (prec < 0) {
+        while (digits && !(frac & 0xf)) {
+            frac >>= 4;
+            digits--;
+        }
+        prec = digits;
+    } else if (prec < digits) {
+        // Round half to even, a carry out of the fraction goes into the leading digit
+        int drop = 4 * (digits - prec);
+        uint64_t rem = frac & ((1ULL << drop) - 1);
+        uint64_t half = 1ULL << (drop - 1);
+        frac >>= drop;
+        digits = prec;
+        bool odd = digits ? (frac & 1) : (lead & 1);
+        if ((rem > half) || ((rem == half) && odd)) {
+            frac++;
+            if (frac >> (4 * digits)) {
+                frac = 0;
+                lead++;
+            }
+        }
+    }
 
-    // do {
-      // unsigned long long t = n / base;
-      // char c = n - t * base;  // faster than c = n%base;
-      // n = t;
-      // *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  // } while(n);
+    const char *hex = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char expBuf[8];
+    char *end = expBuf + sizeof(expBuf);
+    int expLen = formatDecimal(end, e < 0 ? -e : e);
+    *(end - ++expLen) = e < 0 ? '-' : '+';
+    *(end - ++expLen) = upper ? 'P' : 'p';
+    bool point = prec || (flags & F_ALT);
+    int total = (sign ? 1 : 0) + 2 + 1 + (point ? 1 + prec : 0) + expLen;
+    int padLen = width > total ? width - total : 0;
+    if (!(flags & (F_LEFT | F_ZERO))) {
+        out.pad(' ', padLen);
+    }
+    if (sign) {
+        out.put(sign);
+    }
+    out.put('0');
+    out.put(upper ? 'X' : 'x');
+    if (!(flags & F_LEFT) && (flags & F_ZERO)) {
+        out.pad('0', padLen);
+    }
+    out.put(hex[lead]);
+    if (point) {
+        out.put('.');
+    }
+    for (int i = 0; i < digits; i++) {
+        out.put(hex[(frac >> (4 * (digits - 1 - i))) & 0xf]);
+    }
+    out.pad('0', prec - digits);
+    out.put(end - expLen, expLen);
+    if (flags & F_LEFT) {
+        out.pad(' ', padLen);
+    }
+}
 
-  // return write(str);
-// }
+} // namespace
+
+size_t __hot_code_func(Print::vprintf)(const char *format, va_list arg) {
+    PrintfSink out(this);
+    const char *f = format;
+    while (*f) {
+        if (*f != '%') {
+            // Copy literal runs in one go
+            const char *start = f;
+            while (*f && (*f != '%')) {
+                f++;
+            }
+            out.put(start, f - start);
+            continue;
+        }
+        f++;
+
+        int flags = 0;
+        for (;; f++) {
+            if (*f == '-') {
+                flags |= F_LEFT;
+            } else if (*f == '+') {
+                flags |= F_PLUS;
+            } else if (*f == ' ') {
+                flags |= F_SPACE;
+            } else if (*f == '#') {
+                flags |= F_ALT;
+            } else if (*f == '0') {
+                flags |= F_ZERO;
+            } else {
+                break;
+            }
+        }
+        int width = 0;
+        if (*f == '*') {
+            width = va_arg(arg, int);
+            if (width < 0) {
+                flags |= F_LEFT;
+                width = -width;
+            }
+            f++;
+        } else {
+            while ((*f >= '0') && (*f <= '9')) {
+                width = width * 10 + (*f++ - '0');
+            }
+        }
+        int prec = -1;
+        if (*f == '.') {
+            f++;
+            prec = 0;
+            if (*f == '*') {
+                prec = va_arg(arg, int);
+                f++;
+            } else {
+                while ((*f >= '0') && (*f <= '9')) {
+                    prec = prec * 10 + (*f++ - '0');
+                }
+            }
+        }
+        if (flags & F_LEFT) {
+            flags &= ~F_ZERO;
+        }
+
+        // Length modifiers, counted in "l"s with "h"s as negatives
+        int size = 0;
+        for (;; f++) {
+            if (*f == 'l') {
+                size++;
+            } else if (*f == 'h') {
+                size--;
+            } else if ((*f == 'z') || (*f == 't')) {
+                size = sizeof(size_t) == sizeof(long long) ? 2 : 1;
+            } else if (*f == 'j') {
+                size = 2;
+            } else if (*f == 'L') {
+                // long double is just double here
+            } else {
+                break;
+            }
+        }
+
+        char conv = *f;
+        if (!conv) {
+            break;
+        }
+        f++;
+        char num[24];
+        char *end = num + sizeof(num);
+        switch (conv) {
+        case 'd':
+        case 'i': {
+            long long v;
+            if (size >= 2) {
+                v = va_arg(arg, long long);
+            } else if (size == 1) {
+                v = va_arg(arg, long);
+            } else {
+                v = va_arg(arg, int);
+                if (size == -1) {
+                    v = (short)v;
+                } else if (size <= -2) {
+                    v = (signed char)v;
+                }
+            }
+            char sign = 0;
+            unsigned long long u = v;
+            if (v < 0) {
+                sign = '-';
+                u = -u;
+            } else if (flags & F_PLUS) {
+                sign = '+';
+            } else if (flags & F_SPACE) {
+                sign = ' ';
+            }
+            int n = ((prec == 0) && !u) ? 0 : formatUnsigned(end, u, 10, false);
+            if (prec >= 0) {
+                flags &= ~F_ZERO;
+            }
+            emitField(out, &sign, sign ? 1 : 0, prec > n ? prec - n : 0, end - n, n, width, flags);
+            break;
+        }
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'p': {
+            unsigned long long u;
+            if (conv == 'p') {
+                u = (uintptr_t)va_arg(arg, void *);
+                flags |= F_ALT;
+            } else if (size >= 2) {
+                u = va_arg(arg, unsigned long long);
+            } else if (size == 1) {
+                u = va_arg(arg, unsigned long);
+            } else {
+                u = va_arg(arg, unsigned int);
+                if (size == -1) {
+                    u = (unsigned short)u;
+                } else if (size <= -2) {
+                    u = (unsigned char)u;
+                }
+            }
+            unsigned base = (conv == 'u') ? 10 : (conv == 'o') ? 8 : 16;
+            int n = ((prec == 0) && !u) ? 0 : formatUnsigned(end, u, base, conv == 'X');
+            const char *prefix = "";
+            int prefixLen = 0;
+            if (flags & F_ALT) {
+                if ((base == 8) && ((n == 0) || (*(end - n) != '0')) && (prec <= n)) {
+                    prefix = "0";
+                    prefixLen = 1;
+                } else if ((base == 16) && u) {
+                    prefix = (conv == 'X') ? "0X" : "0x";
+                    prefixLen = 2;
+                }
+            }
+            if (prec >= 0) {
+                flags &= ~F_ZERO;
+            }
+            emitField(out, prefix, prefixLen, prec > n ? prec - n : 0, end - n, n, width, flags);
+            break;
+        }
+        case 'c': {
+            char c = (char)va_arg(arg, int);
+            emitField(out, "", 0, 0, &c, 1, width, flags & ~F_ZERO);
+            break;
+        }
+        case 's': {
+            const char *str = va_arg(arg, const char *);
+            if (!str) {
+                str = "(null)";
+            }
+            int n = (prec >= 0) ? strnlen(str, prec) : strlen(str);
+            emitField(out, "", 0, 0, str, n, width, flags & ~F_ZERO);
+            break;
+        }
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            formatFloat(out, va_arg(arg, double), conv, prec, width, flags);
+            break;
+        case 'a':
+        case 'A':
+            formatHexFloat(out, va_arg(arg, double), conv == 'A', prec, width, flags);
+            break;
+        case 'n': {
+            void *dest = va_arg(arg, void *);
+            if (size >= 2) {
+                *(long long *)dest = out.count();
+            } else if (size == 1) {
+                *(long *)dest = out.count();
+            } else if (size == -1) {
+                *(short *)dest = out.count();
+            } else if (size <= -2) {
+                *(signed char *)dest = out.count();
+            } else {
+                *(int *)dest = out.count();
+            }
+            break;
+        }
+        case '%':
+            out.put('%');
+            break;
+        default:
+            // Unknown conversions are passed through untouched
+            out.put('%');
+            out.put(conv);
+            break;
+        }
+    }
+    out.flush();
+    return out.written();
+}
 
-// FAST IMPLEMENTATION FOR ULL
-size_t Print::printULLNumber(unsigned long long n64, uint8_t base)
+size_t Print::printf(const char *format, ...) {
+    va_list arg;
+    va_start(arg, format);
+    size_t len = vprintf(format, arg);
+    va_end(arg);
+    return len;
+}
+
+// PROGMEM is plain memory on the RP2040, so the format can be read directly
+size_t Print::printf_P(const char *format, ...) {
+    va_list arg;
+    va_start(arg, format);
+    size_t len = vprintf(format, arg);
+    va_end(arg);
+    return len;
+}
+
+// Private Methods /////////////////////////////////////////////////////////////
+
+size_t __hot_code_func(Print::printNumber)(unsigned long n, uint8_t base)
 {
-  // if limited to base 10 and 16 the bufsize can be 20
-  char buf[64];
-  uint8_t i = 0;
-  uint8_t innerLoops = 0;
+  char buf[8 * sizeof(long)]; // Assumes 8-bit chars.
+  char *end = &buf[sizeof(buf)];
 
   // prevent crash if called with base == 1
   if (base < 2) base = 10;
 
-  // process chunks that fit in "16 bit math".
-  uint16_t top = 0xFFFF / base;
-  uint16_t th16 = 1;
-  while (th16 < top)
-  {
-    th16 *= base;
-    innerLoops++;
-  }
-
-  while (n64 > th16)
-  {
-    // 64 bit math part
-    uint64_t q = n64 / th16;
-    uint16_t r = n64 - q*th16;
-    n64 = q;
-
-    // 16 bit math loop to do remainder. (note buffer is filled reverse)
-    for (uint8_t j=0; j < innerLoops; j++)
-    {
-      uint16_t qq = r/base;
-      buf[i++] = r - qq*base;
-      r = qq;
-    }
-  }
+  int len = formatUnsigned(end, n, base, true);
+  return write(end - len, len);
+}
 
-  uint16_t n16 = n64;
-  while (n16 > 0)
-  {
-    uint16_t qq = n16/base;
-    buf[i++] = n16 - qq*base;
-    n16 = qq;
-  }
+size_t __hot_code_func(Print::printULLNumber)(unsigned long long n64, uint8_t base)
+{
+  char buf[8 * sizeof(long long)]; // Assumes 8-bit chars.
+  char *end = &buf[sizeof(buf)];
 
-  size_t bytes = i;
-  for (; i > 0; i--)
-    write((char) (buf[i - 1] < 10 ?
-    '0' + buf[i - 1] :
-    'A' + buf[i - 1] - 10));
+  // prevent crash if called with base == 1
+  if (base < 2) base = 10;
 
-  return bytes;
+  int len = formatUnsigned(end, n64, base, true);
+  return write(end - len, len);
 }
 
-size_t Print::printFloat(double number, int digits)
+size_t __hot_code_func(Print::printFloat)(double number, int digits)
 {
   if (digits < 0)
     digits = 2;
 
-  size_t n = 0;
-
   if (isnan(number)) return print("nan");
   if (isinf(number)) return print("inf");
   if (number > 4294967040.0) return print ("ovf");  // constant determined empirically
   if (number <-4294967040.0) return print ("ovf");  // constant determined empirically
 
-  // Handle negative numbers
-  if (number < 0.0)
-  {
-     n += print('-');
-     number = -number;
-  }
-
-  // Round correctly so that print(1.999, 2) prints as "2.00"
-  double rounding = 0.5;
-  for (uint8_t i=0; i<digits; ++i)
-    rounding /= 10.0;
-
-  number += rounding;
+  // -0.0 has always printed without a sign
+  if (number == 0.0)
+    number = 0.0;
 
-  // Extract the integer part of the number and print it
-  unsigned long int_part = (unsigned long)number;
-  double remainder = number - (double)int_part;
-  n += print(int_part);
-
-  // Print the decimal point, but only if there are digits beyond
-  if (digits > 0) {
-    n += print(".");
-  }
-
-  // Extract digits from the remainder one at a time
-  while (digits-- > 0)
-  {
-    remainder *= 10.0;
-    unsigned int toPrint = (unsigned int)remainder;
-    n += print(toPrint);
-    remainder -= toPrint;
-  }
-
-  return n;
+  // Exact and correctly rounded, the same digits printf("%.*f") gives
+  PrintfSink out(this);
+  formatFloat(out, number, 'f', digits, 0, 0);
+  out.flush();
+  return out.written();
 }
@@ -19,11 +19,21 @@
 #pragma once
 
 #include <inttypes.h>
+#include <stdarg.h>
 #include <stdio.h> // for size_t
 
 #include "String.h"
 #include "Printable.h"
 
+// The Hot Code menu's RAM option moves Print.cpp and Stream.cpp to RAM by object name, which
+// the linker can't match once LTO has merged the objects, so their hot methods are also put
+// in RAM by section.
+#ifdef RP2040_HOT_CODE_RAM
+#define __hot_code_func(func_name) __attribute__((section(".time_critical." #func_name))) func_name
+#else
+#define __hot_code_func(func_name) func_name
+#endif
+
 #define DEC 10
 #define HEX 16
 #define OCT 8
@@ -90,8 +100,10 @@ class Print
     size_t println(void);
 
     // EFP3 - Add printf() to make life so much easier...
+    // Formats straight into write() in small chunks, without allocating or newlib's printf
     size_t printf(const char *format, ...);
     size_t printf_P(const char *format, ...);
+    size_t vprintf(const char *format, va_list arg);
 
     virtual void flush() { /* Empty implementation for backward compatibility */ }
 };
@@ -30,7 +30,7 @@
 using namespace arduino;
 
 // private method to read stream with timeout
-int Stream::timedRead()
+int __hot_code_func(Stream::timedRead)()
 {
   int c;
   _startMillis = millis();
@@ -42,7 +42,7 @@ int Stream::timedRead()
 }
 
 // private method to peek stream with timeout
-int Stream::timedPeek()
+int __hot_code_func(Stream::timedPeek)()
 {
   int c;
   _startMillis = millis();
@@ -55,10 +55,27 @@ int Stream::timedPeek()
 
 // returns peek of the next digit in the stream or -1 if timeout
 // discards non-numeric characters
-int Stream::peekNextDigit(LookaheadMode lookahead, bool detectDecimal)
+int __hot_code_func(Stream::peekNextDigit)(LookaheadMode lookahead, bool detectDecimal)
 {
   int c;
   while (1) {
+    // skip over whatever is already buffered without a read() per byte
+    size_t avail = hasPeekBufferAPI() ? peekAvailable() : 0;
+    if (avail) {
+      const char *buf = peekBuffer();
+      size_t i;
+      for (i = 0; i < avail; i++) {
+        c = (unsigned char)buf[i];
+        if (c == '-' || (c >= '0' && c <= '9') || (detectDecimal && c == '.')) break;
+        if (lookahead == SKIP_NONE) break;
+        if (lookahead == SKIP_WHITESPACE && c != ' ' && c != '\t' && c != '\r' && c != '\n') break;
+      }
+      peekConsume(i);
+      if (i == avail) continue;
+      if (c == '-' || (c >= '0' && c <= '9') || (detectDecimal && c == '.')) return c;
+      return -1; // Fail code.
+    }
+
     c = timedPeek();
 
     if( c < 0 ||
@@ -148,6 +165,24 @@ long Stream::parseInt(LookaheadMode lookahead, char ignore)
     else if(c >= '0' && c <= '9')        // is c a digit?
       value = value * 10 + c - '0';
     read();  // consume the character we got with peek
+
+    // take any buffered digits in one pass
+    size_t avail = hasPeekBufferAPI() ? peekAvailable() : 0;
+    if (avail) {
+      const char *buf = peekBuffer();
+      size_t i;
+      for (i = 0; i < avail; i++) {
+        char d = buf[i];
+        if (d == ignore)
+          continue;
+        if (d < '0' || d > '9')
+          break;
+        value = value * 10 + d - '0';
+      }
+      peekConsume(i);
+      if (i < avail)
+        break;
+    }
     c = timedPeek();
   }
   while( (c >= '0' && c <= '9') || (char)c == ignore );
@@ -187,6 +222,33 @@ float Stream::parseFloat(LookaheadMode lookahead, char ignore)
       }
     }
     read();  // consume the character we got with peek
+
+    // take any buffered digits in one pass
+    size_t avail = hasPeekBufferAPI() ? peekAvailable() : 0;
+    if (avail) {
+      const char *buf = peekBuffer();
+      size_t i;
+      for (i = 0; i < avail; i++) {
+        char d = buf[i];
+        if (d == ignore)
+          continue;
+        if (d == '.' && !isFraction) {
+          isFraction = true;
+          continue;
+        }
+        if (d < '0' || d > '9')
+          break;
+        if(isFraction) {
+          fraction *= 0.1;
+          value = value + fraction * (d - '0');
+        } else {
+          value = value * 10 + d - '0';
+        }
+      }
+      peekConsume(i);
+      if (i < avail)
+        break;
+    }
     c = timedPeek();
   }
   while( (c >= '0' && c <= '9')  || (c == '.' && !isFraction) || (char)c == ignore );
@@ -202,10 +264,19 @@ float Stream::parseFloat(LookaheadMode lookahead, char ignore)
 // returns the number of characters placed in the buffer
 // the buffer is NOT null terminated.
 //
-size_t Stream::readBytes(char *buffer, size_t length)
+size_t __hot_code_func(Stream::readBytes)(char *buffer, size_t length)
 {
   size_t count = 0;
   while (count < length) {
+    size_t avail = hasPeekBufferAPI() ? peekAvailable() : 0;
+    if (avail) {
+      if (avail > length - count) avail = length - count;
+      memcpy(buffer, peekBuffer(), avail);
+      peekConsume(avail);
+      buffer += avail;
+      count += avail;
+      continue;
+    }
     int c = timedRead();
     if (c < 0) break;
     *buffer++ = (char)c;
@@ -219,10 +290,24 @@ size_t Stream::readBytes(char *buffer, size_t length)
 // terminates if length characters have been read, timeout, or if the terminator character  detected
 // returns the number of characters placed in the buffer (0 means no valid data found)
 
-size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
+size_t __hot_code_func(Stream::readBytesUntil)(char terminator, char *buffer, size_t length)
 {
   size_t index = 0;
   while (index < length) {
+    size_t avail = hasPeekBufferAPI() ? peekAvailable() : 0;
+    if (avail) {
+      // copy up to the terminator straight out of the stream's buffer
+      const char *buf = peekBuffer();
+      if (avail > length - index) avail = length - index;
+      const char *term = (const char *)memchr(buf, terminator, avail);
+      size_t n = term ? term - buf : avail;
+      memcpy(buffer, buf, n);
+      buffer += n;
+      index += n;
+      peekConsume(term ? n + 1 : n);
+      if (term) break;
+      continue;
+    }
     int c = timedRead();
     if (c < 0 || (char)c == terminator) break;
     *buffer++ = (char)c;
@@ -234,11 +319,17 @@ size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
 String Stream::readString()
 {
   String ret;
-  int c = timedRead();
-  while (c >= 0)
+  while (1)
   {
+    size_t avail = hasPeekBufferAPI() ? peekAvailable() : 0;
+    if (avail) {
+      ret.concat(peekBuffer(), avail);
+      peekConsume(avail);
+      continue;
+    }
+    int c = timedRead();
+    if (c < 0) break;
     ret += (char)c;
-    c = timedRead();
   }
   return ret;
 }
@@ -246,16 +337,70 @@ String Stream::readString()
 String Stream::readStringUntil(char terminator)
 {
   String ret;
-  int c = timedRead();
-  while (c >= 0 && (char)c != terminator)
+  while (1)
   {
+    size_t avail = hasPeekBufferAPI() ? peekAvailable() : 0;
+    if (avail) {
+      // append everything up to the terminator in one go
+      const char *buf = peekBuffer();
+      const char *term = (const char *)memchr(buf, terminator, avail);
+      size_t n = term ? term - buf : avail;
+      ret.concat(buf, n);
+      peekConsume(term ? n + 1 : n);
+      if (term) break;
+      continue;
+    }
+    int c = timedRead();
+    if (c < 0 || (char)c == terminator) break;
     ret += (char)c;
-    c = timedRead();
   }
   return ret;
 }
 
-int Stream::findMulti( struct Stream::MultiTarget *targets, int tCount) {
+#define STREAM_SEND_BUFFER 256 // bounce buffer for streams without a peek buffer
+
+size_t __hot_code_func(Stream::sendAll)(Print &to, size_t maxLen, unsigned long timeoutMs)
+{
+  size_t sent = 0;
+  unsigned long start = millis();
+  while (sent < maxLen) {
+    size_t want = maxLen - sent;
+    int room = to.availableForWrite();
+    if (room > 0 && (size_t)room < want) want = room;
+
+    size_t w = 0;
+    size_t avail = hasPeekBufferAPI() ? peekAvailable() : 0;
+    int ready = avail;
+    if (avail) {
+      // no intermediate copy, and only what was accepted is consumed
+      if (avail > want) avail = want;
+      w = to.write((const uint8_t *)peekBuffer(), avail);
+      peekConsume(w);
+    } else if ((ready = available()) > 0) {
+      uint8_t buf[STREAM_SEND_BUFFER];
+      size_t n = (size_t)ready;
+      if (n > sizeof(buf)) n = sizeof(buf);
+      if (n > want) n = want;
+      n = readBytes((char *)buf, n);
+      w = to.write(buf, n);
+      if (w != n) {
+        // what didn't fit is already gone from the stream
+        sent += w;
+        break;
+      }
+    }
+    if (w) {
+      sent += w;
+      start = millis();
+      continue;
+    }
+    if ((ready <= 0 && !inputCanTimeout()) || (millis() - start >= timeoutMs)) break;
+    delay(1);
+  }
+  return sent;
+}
+
+int __hot_code_func(Stream::findMulti)( struct Stream::MultiTarget *targets, int tCount) {
   // any zero length target string automatically matches and would make
   // a mess of the rest of the algorithm.
   for (struct MultiTarget *t = targets; t < targets+tCount; ++t) {
@@ -264,58 +409,88 @@ int Stream::findMulti( struct Stream::MultiTarget *targets, int tCount) {
   }
 
   while (1) {
+    size_t avail = hasPeekBufferAPI() ? peekAvailable() : 0;
+    if (avail) {
+      // run buffered bytes through the matcher below without a read() each
+      const char *buf = peekBuffer();
+      for (size_t i = 0; i < avail; i++) {
+        if (tCount == 1 && targets[0].index == 0) {
+          // nothing partially matched, so jump straight to the next candidate
+          const char *p = (const char *)memchr(buf + i, targets[0].str[0], avail - i);
+          if (!p) break;
+          i = p - buf;
+        }
+        int found = findMultiStep(targets, tCount, buf[i]);
+        if (found >= 0) {
+          peekConsume(i + 1);
+          return found;
+        }
+      }
+      peekConsume(avail);
+      continue;
+    }
+
     int c = timedRead();
     if (c < 0)
       return -1;
 
-    for (struct MultiTarget *t = targets; t < targets+tCount; ++t) {
-      // the simple case is if we match, deal with that first.
-      if ((char)c == t->str[t->index]) {
-        if (++t->index == t->len)
-          return t - targets;
-        else
-          continue;
-      }
+    int found = findMultiStep(targets, tCount, (char)c);
+    if (found >= 0)
+      return found;
+  }
+  // unreachable
+  return -1;
+}
 
-      // if not we need to walk back and see if we could have matched further
-      // down the stream (ie '1112' doesn't match the first position in '11112'
-      // but it will match the second position so we can't just reset the current
-      // index to 0 when we find a mismatch.
-      if (t->index == 0)
+// feeds one character to every target's matcher, returns the index of the
+// target it completes or -1
+int __hot_code_func(Stream::findMultiStep)(struct Stream::MultiTarget *targets, int tCount, char c) {
+  for (struct MultiTarget *t = targets; t < targets+tCount; ++t) {
+    // the simple case is if we match, deal with that first.
+    if ((char)c == t->str[t->index]) {
+      if (++t->index == t->len)
+        return t - targets;
+      else
         continue;
+    }
 
-      int origIndex = t->index;
-      do {
-        --t->index;
-        // first check if current char works against the new current index
-        if ((char)c != t->str[t->index])
-          continue;
-
-        // if it's the only char then we're good, nothing more to check
-        if (t->index == 0) {
-          t->index++;
-          break;
-        }
+    // if not we need to walk back and see if we could have matched further
+    // down the stream (ie '1112' doesn't match the first position in '11112'
+    // but it will match the second position so we can't just reset the current
+    // index to 0 when we find a mismatch.
+    if (t->index == 0)
+      continue;
+
+    int origIndex = t->index;
+    do {
+      --t->index;
+      // first check if current char works against the new current index
+      if ((char)c != t->str[t->index])
+        continue;
 
-        // otherwise we need to check the rest of the found string
-        int diff = origIndex - t->index;
-        size_t i;
-        for (i = 0; i < t->index; ++i) {
-          if (t->str[i] != t->str[i + diff])
-            break;
-        }
+      // if it's the only char then we're good, nothing more to check
+      if (t->index == 0) {
+        t->index++;
+        break;
+      }
 
-        // if we successfully got through the previous loop then our current
-        // index is good.
-        if (i == t->index) {
-          t->index++;
+      // otherwise we need to check the rest of the found string
+      int diff = origIndex - t->index;
+      size_t i;
+      for (i = 0; i < t->index; ++i) {
+        if (t->str[i] != t->str[i + diff])
           break;
-        }
+      }
 
-        // otherwise we just try the next index
-      } while (t->index);
-    }
+      // if we successfully got through the previous loop then our current
+      // index is good.
+      if (i == t->index) {
+        t->index++;
+        break;
+      }
+
+      // otherwise we just try the next index
+    } while (t->index);
   }
-  // unreachable
   return -1;
 }
@@ -63,6 +63,25 @@ class Stream : public Print
 
     Stream() {_timeout=1000;}
 
+// optional direct access to the receive buffer, which lets the parsing
+// methods below scan whole runs of bytes instead of going one at a time
+
+  virtual bool hasPeekBufferAPI() const { return false; }
+  // true if peekBuffer()/peekAvailable()/peekConsume() are implemented
+
+  virtual size_t peekAvailable() { return 0; }
+  // returns the number of bytes accessible through peekBuffer()
+
+  virtual const char* peekBuffer() { return nullptr; }
+  // returns a pointer to peekAvailable() contiguous received bytes
+  // semantic forbids any kind of read() before calling peekConsume()
+
+  virtual void peekConsume(size_t consume) { (void)consume; }
+  // marks bytes from peekBuffer() as read
+
+  virtual bool inputCanTimeout() { return true; }
+  // false when waiting can't bring in more data, e.g. at the end of a file
+
 // parsing methods
 
   void setTimeout(unsigned long timeout);  // sets maximum milliseconds to wait for stream data, default is 1 second
@@ -94,7 +113,7 @@ class Stream : public Print
   float parseFloat(LookaheadMode lookahead = SKIP_ALL, char ignore = NO_IGNORE_CHAR);
   // float version of parseInt
 
-  size_t readBytes( char *buffer, size_t length); // read chars from stream into buffer
+  virtual size_t readBytes( char *buffer, size_t length); // read chars from stream into buffer
   size_t readBytes( uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
   // terminates if length characters have been read or timeout (see setTimeout)
   // returns the number of characters placed in the buffer (0 means no valid data found)
@@ -108,6 +127,13 @@ class Stream : public Print
   String readString();
   String readStringUntil(char terminator);
 
+  size_t sendAll(Print &to, size_t maxLen, unsigned long timeoutMs);
+  size_t sendAll(Print &to, size_t maxLen = (size_t)-1) { return sendAll(to, maxLen, _timeout); }
+  // copies up to maxLen bytes to another Print, straight out of peekBuffer() when
+  // there is one, and honors to.availableForWrite().  Stops early once nothing has
+  // moved for timeoutMs, or as soon as the stream is dry and can't time out.
+  // returns the number of bytes written to to
+
   protected:
   long parseInt(char ignore) { return parseInt(SKIP_ALL, ignore); }
   float parseFloat(char ignore) { return parseFloat(SKIP_ALL, ignore); }
@@ -124,6 +150,7 @@ class Stream : public Print
   // This allows you to search for an arbitrary number of strings.
   // Returns index of the target that is found first or -1 if timeout occurs.
   int findMulti(struct MultiTarget *targets, int tCount);
+  int findMultiStep(struct MultiTarget *targets, int tCount, char c);
 };
 
 #undef NO_IGNORE_CHAR
@@ -43,12 +43,14 @@ String::String(const char *cstr)
 {
 	init();
 	if (cstr) copy(cstr, strlen(cstr));
+	else invalidate();
 }
 
 String::String(const char *cstr, unsigned int length)
 {
 	init();
 	if (cstr) copy(cstr, length);
+	else invalidate();
 }
 
 String::String(const String &value)
@@ -145,7 +147,7 @@ String::String(double value, unsigned char decimalPlaces)
 
 String::~String()
 {
-	if (buffer) free(buffer);
+	if (!isSSO()) free(ptr.buff);
 }
 
 /*********************************************/
@@ -154,23 +156,25 @@ String::~String()
 
 inline void String::init(void)
 {
-	buffer = NULL;
-	capacity = 0;
-	len = 0;
+	setSSO(true);
+	sso.len = 0;
+	sso.buff[0] = 0;
 }
 
 void String::invalidate(void)
 {
-	if (buffer) free(buffer);
-	buffer = NULL;
-	capacity = len = 0;
+	if (!isSSO()) free(ptr.buff);
+	setSSO(false);
+	ptr.buff = NULL;
+	ptr.cap = 0;
+	ptr.len = 0;
 }
 
 unsigned char String::reserve(unsigned int size)
 {
-	if (buffer && capacity >= size) return 1;
+	if (buffer() && capacity() >= size) return 1;
 	if (changeBuffer(size)) {
-		if (len == 0) buffer[0] = 0;
+		if (len() == 0) wbuffer()[0] = 0;
 		return 1;
 	}
 	return 0;
@@ -178,10 +182,29 @@ unsigned char String::reserve(unsigned int size)
 
 unsigned char String::changeBuffer(unsigned int maxStrLen)
 {
-	char *newbuffer = (char *)realloc(buffer, maxStrLen + 1);
+	// Short enough to live inline.  A string already on the heap keeps its
+	// buffer, but an invalid one can be revived without allocating.
+	if (maxStrLen < SSOSIZE && (isSSO() || !ptr.buff)) {
+		if (!isSSO()) {
+			setSSO(true);
+			sso.len = 0;
+			sso.buff[0] = 0;
+		}
+		return 1;
+	}
+	// Round up so strings built a character at a time don't realloc on every append
+	unsigned int newSize = (maxStrLen + 16) & ~0xf;
+	char *newbuffer = (char *)realloc(isSSO() ? NULL : ptr.buff, newSize);
 	if (newbuffer) {
-		buffer = newbuffer;
-		capacity = maxStrLen;
+		if (isSSO()) {
+			// The heap fields overlay the inline text, so save it off first
+			unsigned int oldLen = sso.len;
+			memcpy(newbuffer, sso.buff, oldLen + 1);
+			setSSO(false);
+			ptr.len = oldLen;
+		}
+		ptr.buff = newbuffer;
+		ptr.cap = newSize - 1;
 		return 1;
 	}
 	return 0;
@@ -197,9 +220,9 @@ String & String::copy(const char *cstr, unsigned int length)
 		invalidate();
 		return *this;
 	}
-	len = length;
-	memcpy(buffer, cstr, length);
-	buffer[len] = '\0';
+	memmove(wbuffer(), cstr, length);
+	setLen(length);
+	wbuffer()[length] = '\0';
 	return *this;
 }
 
@@ -209,31 +232,18 @@ String & String::copy(const __FlashStringHelper *pstr, unsigned int length)
 		invalidate();
 		return *this;
 	}
-	len = length;
-	strcpy_P(buffer, (PGM_P)pstr);
+	setLen(length);
+	strcpy_P(wbuffer(), (PGM_P)pstr);
 	return *this;
 }
 
 #if __cplusplus >= 201103L || defined(__GXX_EXPERIMENTAL_CXX0X__)
 void String::move(String &rhs)
 {
-	if (buffer) {
-		if (rhs && capacity >= rhs.len) {
-			memcpy(buffer, rhs.buffer, rhs.len);
-			len = rhs.len;
-			buffer[len] = '\0';
-			rhs.len = 0;
-			return;
-		} else {
-			free(buffer);
-		}
-	}
-	buffer = rhs.buffer;
-	capacity = rhs.capacity;
-	len = rhs.len;
-	rhs.buffer = NULL;
-	rhs.capacity = 0;
-	rhs.len = 0;
+	// Inline strings are copied, heap ones have their buffer stolen outright
+	invalidate();
+	memcpy((void *)&sso, (const void *)&rhs.sso, sizeof(sso));
+	rhs.init();
 }
 #endif
 
@@ -241,7 +251,7 @@ String & String::operator = (const String &rhs)
 {
 	if (this == &rhs) return *this;
 	
-	if (rhs.buffer) copy(rhs.buffer, rhs.len);
+	if (rhs.buffer()) copy(rhs.buffer(), rhs.len());
 	else invalidate();
 	
 	return *this;
@@ -283,18 +293,29 @@ String & String::operator = (const __FlashStringHelper *pstr)
 
 unsigned char String::concat(const String &s)
 {
-	return concat(s.buffer, s.len);
+	// s += s may move our buffer while reserving, so re-read it afterwards
+	if (&s == this) {
+		unsigned int oldlen = len();
+		if (!buffer()) return 0;
+		if (oldlen == 0) return 1;
+		if (!reserve(2 * oldlen)) return 0;
+		memcpy(wbuffer() + oldlen, buffer(), oldlen);
+		setLen(2 * oldlen);
+		wbuffer()[2 * oldlen] = '\0';
+		return 1;
+	}
+	return concat(s.buffer(), s.len());
 }
 
 unsigned char String::concat(const char *cstr, unsigned int length)
 {
-	unsigned int newlen = len + length;
+	unsigned int newlen = len() + length;
 	if (!cstr) return 0;
 	if (length == 0) return 1;
 	if (!reserve(newlen)) return 0;
-	memcpy(buffer + len, cstr, length);
-	len = newlen;
-	buffer[len] = '\0';
+	memcpy(wbuffer() + len(), cstr, length);
+	setLen(newlen);
+	wbuffer()[newlen] = '\0';
 	return 1;
 }
 
@@ -363,10 +384,10 @@ unsigned char String::concat(const __FlashStringHelper * str)
 	if (!str) return 0;
 	int length = strlen_P((const char *) str);
 	if (length == 0) return 1;
-	unsigned int newlen = len + length;
+	unsigned int newlen = len() + length;
 	if (!reserve(newlen)) return 0;
-	strcpy_P(buffer + len, (const char *) str);
-	len = newlen;
+	strcpy_P(wbuffer() + len(), (const char *) str);
+	setLen(newlen);
 	return 1;
 }
 
@@ -377,7 +398,7 @@ unsigned char String::concat(const __FlashStringHelper * str)
 StringSumHelper & operator + (const StringSumHelper &lhs, const String &rhs)
 {
 	StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
-	if (!a.concat(rhs.buffer, rhs.len)) a.invalidate();
+	if (!a.concat(rhs.buffer(), rhs.len())) a.invalidate();
 	return a;
 }
 
@@ -457,43 +478,43 @@ StringSumHelper & operator + (const StringSumHelper &lhs, const __FlashStringHel
 
 int String::compareTo(const String &s) const
 {
-	if (!buffer || !s.buffer) {
-		if (s.buffer && s.len > 0) return 0 - *(unsigned char *)s.buffer;
-		if (buffer && len > 0) return *(unsigned char *)buffer;
+	if (!buffer() || !s.buffer()) {
+		if (s.buffer() && s.len() > 0) return 0 - *(unsigned char *)s.buffer();
+		if (buffer() && len() > 0) return *(unsigned char *)buffer();
 		return 0;
 	}
-	return strcmp(buffer, s.buffer);
+	return strcmp(buffer(), s.buffer());
 }
 
 int String::compareTo(const char *cstr) const
 {
-	if (!buffer || !cstr) {
+	if (!buffer() || !cstr) {
 		if (cstr && *cstr) return 0 - *(unsigned char *)cstr;
-		if (buffer && len > 0) return *(unsigned char *)buffer;
+		if (buffer() && len() > 0) return *(unsigned char *)buffer();
 		return 0;
 	}
-	return strcmp(buffer, cstr);
+	return strcmp(buffer(), cstr);
 }
 
 unsigned char String::equals(const String &s2) const
 {
-	return (len == s2.len && compareTo(s2) == 0);
+	return (len() == s2.len() && compareTo(s2) == 0);
 }
 
 unsigned char String::equals(const char *cstr) const
 {
-	if (len == 0) return (cstr == NULL || *cstr == 0);
-	if (cstr == NULL) return buffer[0] == 0;
-	return strcmp(buffer, cstr) == 0;
+	if (len() == 0) return (cstr == NULL || *cstr == 0);
+	if (cstr == NULL) return buffer()[0] == 0;
+	return strcmp(buffer(), cstr) == 0;
 }
 
 unsigned char String::equalsIgnoreCase( const String &s2 ) const
 {
 	if (this == &s2) return 1;
-	if (len != s2.len) return 0;
-	if (len == 0) return 1;
-	const char *p1 = buffer;
-	const char *p2 = s2.buffer;
+	if (len() != s2.len()) return 0;
+	if (len() == 0) return 1;
+	const char *p1 = buffer();
+	const char *p2 = s2.buffer();
 	while (*p1) {
 		if (tolower(*p1++) != tolower(*p2++)) return 0;
 	} 
@@ -502,20 +523,20 @@ unsigned char String::equalsIgnoreCase( const String &s2 ) const
 
 unsigned char String::startsWith( const String &s2 ) const
 {
-	if (len < s2.len) return 0;
+	if (len() < s2.len()) return 0;
 	return startsWith(s2, 0);
 }
 
 unsigned char String::startsWith( const String &s2, unsigned int offset ) const
 {
-	if (offset > len - s2.len || !buffer || !s2.buffer) return 0;
-	return strncmp( &buffer[offset], s2.buffer, s2.len ) == 0;
+	if (offset > len() - s2.len() || !buffer() || !s2.buffer()) return 0;
+	return strncmp( &buffer()[offset], s2.buffer(), s2.len() ) == 0;
 }
 
 unsigned char String::endsWith( const String &s2 ) const
 {
-	if ( len < s2.len || !buffer || !s2.buffer) return 0;
-	return strcmp(&buffer[len - s2.len], s2.buffer) == 0;
+	if ( len() < s2.len() || !buffer() || !s2.buffer()) return 0;
+	return strcmp(&buffer()[len() - s2.len()], s2.buffer()) == 0;
 }
 
 /*********************************************/
@@ -529,35 +550,35 @@ char String::charAt(unsigned int loc) const
 
 void String::setCharAt(unsigned int loc, char c) 
 {
-	if (loc < len) buffer[loc] = c;
+	if (loc < len()) wbuffer()[loc] = c;
 }
 
 char & String::operator[](unsigned int index)
 {
 	static char dummy_writable_char;
-	if (index >= len || !buffer) {
+	if (index >= len() || !wbuffer()) {
 		dummy_writable_char = 0;
 		return dummy_writable_char;
 	}
-	return buffer[index];
+	return wbuffer()[index];
 }
 
 char String::operator[]( unsigned int index ) const
 {
-	if (index >= len || !buffer) return 0;
-	return buffer[index];
+	if (index >= len() || !buffer()) return 0;
+	return buffer()[index];
 }
 
 void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index) const
 {
 	if (!bufsize || !buf) return;
-	if (index >= len) {
+	if (index >= len()) {
 		buf[0] = 0;
 		return;
 	}
 	unsigned int n = bufsize - 1;
-	if (n > len - index) n = len - index;
-	strncpy((char *)buf, buffer + index, n);
+	if (n > len() - index) n = len() - index;
+	strncpy((char *)buf, buffer() + index, n);
 	buf[n] = 0;
 }
 
@@ -572,10 +593,10 @@ int String::indexOf(char c) const
 
 int String::indexOf( char ch, unsigned int fromIndex ) const
 {
-	if (fromIndex >= len) return -1;
-	const char* temp = strchr(buffer + fromIndex, ch);
+	if (fromIndex >= len()) return -1;
+	const char* temp = strchr(buffer() + fromIndex, ch);
 	if (temp == NULL) return -1;
-	return temp - buffer;
+	return temp - buffer();
 }
 
 int String::indexOf(const String &s2) const
@@ -585,42 +606,43 @@ int String::indexOf(const String &s2) const
 
 int String::indexOf(const String &s2, unsigned int fromIndex) const
 {
-	if (fromIndex >= len) return -1;
-	const char *found = strstr(buffer + fromIndex, s2.buffer);
+	if (fromIndex >= len()) return -1;
+	const char *found = strstr(buffer() + fromIndex, s2.buffer());
 	if (found == NULL) return -1;
-	return found - buffer;
+	return found - buffer();
 }
 
 int String::lastIndexOf( char theChar ) const
 {
-	return lastIndexOf(theChar, len - 1);
+	return lastIndexOf(theChar, len() - 1);
 }
 
 int String::lastIndexOf(char ch, unsigned int fromIndex) const
 {
-	if (fromIndex >= len) return -1;
-	char tempchar = buffer[fromIndex + 1];
-	buffer[fromIndex + 1] = '\0';
-	char* temp = strrchr( buffer, ch );
-	buffer[fromIndex + 1] = tempchar;
+	if (fromIndex >= len()) return -1;
+	char *buf = const_cast<char *>(buffer());
+	char tempchar = buf[fromIndex + 1];
+	buf[fromIndex + 1] = '\0';
+	char* temp = strrchr( buf, ch );
+	buf[fromIndex + 1] = tempchar;
 	if (temp == NULL) return -1;
-	return temp - buffer;
+	return temp - buf;
 }
 
 int String::lastIndexOf(const String &s2) const
 {
-	return lastIndexOf(s2, len - s2.len);
+	return lastIndexOf(s2, len() - s2.len());
 }
 
 int String::lastIndexOf(const String &s2, unsigned int fromIndex) const
 {
-	if (s2.len == 0 || len == 0 || s2.len > len) return -1;
-	if (fromIndex >= len) fromIndex = len - 1;
+	if (s2.len() == 0 || len() == 0 || s2.len() > len()) return -1;
+	if (fromIndex >= len()) fromIndex = len() - 1;
 	int found = -1;
-	for (char *p = buffer; p <= buffer + fromIndex; p++) {
-		p = strstr(p, s2.buffer);
+	for (const char *p = buffer(); p <= buffer() + fromIndex; p++) {
+		p = strstr(p, s2.buffer());
 		if (!p) break;
-		if ((unsigned int)(p - buffer) <= fromIndex) found = p - buffer;
+		if ((unsigned int)(p - buffer()) <= fromIndex) found = p - buffer();
 	}
 	return found;
 }
@@ -633,9 +655,9 @@ String String::substring(unsigned int left, unsigned int right) const
 		left = temp;
 	}
 	String out;
-	if (left >= len) return out;
-	if (right > len) right = len;
-	out.copy(buffer + left, right - left);
+	if (left >= len()) return out;
+	if (right > len()) right = len();
+	out.copy(buffer() + left, right - left);
 	return out;
 }
 
@@ -645,55 +667,55 @@ String String::substring(unsigned int left, unsigned int right) const
 
 void String::replace(char find, char replace)
 {
-	if (!buffer) return;
-	for (char *p = buffer; *p; p++) {
+	if (!wbuffer()) return;
+	for (char *p = wbuffer(); *p; p++) {
 		if (*p == find) *p = replace;
 	}
 }
 
 void String::replace(const String& find, const String& replace)
 {
-	if (len == 0 || find.len == 0) return;
-	int diff = replace.len - find.len;
-	char *readFrom = buffer;
+	if (len() == 0 || find.len() == 0) return;
+	int diff = replace.len() - find.len();
+	char *readFrom = wbuffer();
 	char *foundAt;
 	if (diff == 0) {
-		while ((foundAt = strstr(readFrom, find.buffer)) != NULL) {
-			memcpy(foundAt, replace.buffer, replace.len);
-			readFrom = foundAt + replace.len;
+		while ((foundAt = strstr(readFrom, find.buffer())) != NULL) {
+			memcpy(foundAt, replace.buffer(), replace.len());
+			readFrom = foundAt + replace.len();
 		}
 	} else if (diff < 0) {
-		unsigned int size = len; // compute size needed for result
-		while ((foundAt = strstr(readFrom, find.buffer)) != NULL) {
-			readFrom = foundAt + find.len;
+		unsigned int size = len(); // compute size needed for result
+		while ((foundAt = strstr(readFrom, find.buffer())) != NULL) {
+			readFrom = foundAt + find.len();
 			diff = 0 - diff;
 			size -= diff;
 		}
-		if (size == len) return;
-		int index = len - 1;
+		if (size == len()) return;
+		int index = len() - 1;
 		while (index >= 0 && (index = lastIndexOf(find, index)) >= 0) {
-			readFrom = buffer + index + find.len;
-			memmove(readFrom - diff, readFrom, len - (readFrom - buffer));
-			len -= diff;
-			buffer[len] = 0;
-			memcpy(buffer + index, replace.buffer, replace.len);
+			readFrom = wbuffer() + index + find.len();
+			memmove(readFrom - diff, readFrom, len() - (readFrom - wbuffer()));
+			setLen(len() - diff);
+			wbuffer()[len()] = 0;
+			memcpy(wbuffer() + index, replace.buffer(), replace.len());
 			index--;
 		}
 	} else {
-		unsigned int size = len; // compute size needed for result
-		while ((foundAt = strstr(readFrom, find.buffer)) != NULL) {
-			readFrom = foundAt + find.len;
+		unsigned int size = len(); // compute size needed for result
+		while ((foundAt = strstr(readFrom, find.buffer())) != NULL) {
+			readFrom = foundAt + find.len();
 			size += diff;
 		}
-		if (size == len) return;
-		if (size > capacity && !changeBuffer(size)) return; // XXX: tell user!
-		int index = len - 1;
+		if (size == len()) return;
+		if (size > capacity() && !changeBuffer(size)) return; // XXX: tell user!
+		int index = len() - 1;
 		while (index >= 0 && (index = lastIndexOf(find, index)) >= 0) {
-			readFrom = buffer + index + find.len;
-			memmove(readFrom + diff, readFrom, len - (readFrom - buffer));
-			len += diff;
-			buffer[len] = 0;
-			memcpy(buffer + index, replace.buffer, replace.len);
+			readFrom = wbuffer() + index + find.len();
+			memmove(readFrom + diff, readFrom, len() - (readFrom - wbuffer()));
+			setLen(len() + diff);
+			wbuffer()[len()] = 0;
+			memcpy(wbuffer() + index, replace.buffer(), replace.len());
 			index--;
 		}
 	}
@@ -707,41 +729,41 @@ void String::remove(unsigned int index){
 }
 
 void String::remove(unsigned int index, unsigned int count){
-	if (index >= len) { return; }
+	if (index >= len()) { return; }
 	if (count <= 0) { return; }
-	if (count > len - index) { count = len - index; }
-	char *writeTo = buffer + index;
-	len = len - count;
-	memmove(writeTo, buffer + index + count,len - index);
-	buffer[len] = 0;
+	if (count > len() - index) { count = len() - index; }
+	char *writeTo = wbuffer() + index;
+	setLen(len() - count);
+	memmove(writeTo, wbuffer() + index + count,len() - index);
+	wbuffer()[len()] = 0;
 }
 
 void String::toLowerCase(void)
 {
-	if (!buffer) return;
-	for (char *p = buffer; *p; p++) {
+	if (!wbuffer()) return;
+	for (char *p = wbuffer(); *p; p++) {
 		*p = tolower(*p);
 	}
 }
 
 void String::toUpperCase(void)
 {
-	if (!buffer) return;
-	for (char *p = buffer; *p; p++) {
+	if (!wbuffer()) return;
+	for (char *p = wbuffer(); *p; p++) {
 		*p = toupper(*p);
 	}
 }
 
 void String::trim(void)
 {
-	if (!buffer || len == 0) return;
-	char *begin = buffer;
+	if (!wbuffer() || len() == 0) return;
+	char *begin = wbuffer();
 	while (isspace(*begin)) begin++;
-	char *end = buffer + len - 1;
+	char *end = wbuffer() + len() - 1;
 	while (isspace(*end) && end >= begin) end--;
-	len = end + 1 - begin;
-	if (begin > buffer) memmove(buffer, begin, len);
-	buffer[len] = 0;
+	setLen(end + 1 - begin);
+	if (begin > wbuffer()) memmove(wbuffer(), begin, len());
+	wbuffer()[len()] = 0;
 }
 
 /*********************************************/
@@ -750,7 +772,7 @@ void String::trim(void)
 
 long String::toInt(void) const
 {
-	if (buffer) return atol(buffer);
+	if (buffer()) return atol(buffer());
 	return 0;
 }
 
@@ -761,7 +783,7 @@ float String::toFloat(void) const
 
 double String::toDouble(void) const
 {
-	if (buffer) return atof(buffer);
+	if (buffer()) return atof(buffer());
 	return 0;
 }
 
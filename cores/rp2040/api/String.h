@@ -91,7 +91,7 @@ public:
 	// is left unchanged).  reserve(0), if successful, will validate an
 	// invalid string (i.e., "if (s)" will be true afterwards)
 	unsigned char reserve(unsigned int size);
-	inline unsigned int length(void) const {return len;}
+	inline unsigned int length(void) const {return len();}
 
 	// creates a copy of the assigned value.  if the value is null or
 	// invalid, or if the memory allocation fails, the string will be
@@ -150,7 +150,7 @@ public:
 	friend StringSumHelper & operator + (const StringSumHelper &lhs, const __FlashStringHelper *rhs);
 
 	// comparison (only works w/ Strings and "strings")
-	operator StringIfHelperType() const { return buffer ? &String::StringIfHelper : 0; }
+	operator StringIfHelperType() const { return buffer() ? &String::StringIfHelper : 0; }
 	int compareTo(const String &s) const;
 	int compareTo(const char *cstr) const;
 	unsigned char equals(const String &s) const;
@@ -189,9 +189,9 @@ public:
 	void getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index=0) const;
 	void toCharArray(char *buf, unsigned int bufsize, unsigned int index=0) const
 		{ getBytes((unsigned char *)buf, bufsize, index); }
-	const char* c_str() const { return buffer; }
-	char* begin() { return buffer; }
-	char* end() { return buffer + length(); }
+	const char* c_str() const { return buffer(); }
+	char* begin() { return wbuffer(); }
+	char* end() { return wbuffer() + length(); }
 	const char* begin() const { return c_str(); }
 	const char* end() const { return c_str() + length(); }
 
@@ -204,7 +204,7 @@ public:
 	int lastIndexOf( char ch, unsigned int fromIndex ) const;
 	int lastIndexOf( const String &str ) const;
 	int lastIndexOf( const String &str, unsigned int fromIndex ) const;
-	String substring( unsigned int beginIndex ) const { return substring(beginIndex, len); };
+	String substring( unsigned int beginIndex ) const { return substring(beginIndex, len()); };
 	String substring( unsigned int beginIndex, unsigned int endIndex ) const;
 
 	// modification
@@ -222,9 +222,33 @@ public:
 	double toDouble(void) const;
 
 protected:
-	char *buffer;	        // the actual char array
-	unsigned int capacity;  // the array length minus one (for the '\0')
-	unsigned int len;       // the String length (not counting the '\0')
+	// Strings of up to SSOSIZE - 1 characters are stored inline in the
+	// object itself (small-string optimization) and only move to the heap
+	// once they outgrow it.  The last byte of the union holds the inline
+	// length and the heap flag, and lies past the end of the heap layout.
+	struct _ptr {
+		char *buff;	        // the actual char array
+		unsigned int cap;       // the array length minus one (for the '\0')
+		unsigned int len;       // the String length (not counting the '\0')
+	};
+	enum e { SSOSIZE = sizeof(struct _ptr) + 4 - 1 }; // inline chars, including the '\0'
+	struct _sso {
+		char buff[SSOSIZE];
+		unsigned char len:7;
+		unsigned char isHeap:1;
+	} __attribute__((packed));
+	union {
+		struct _ptr ptr;
+		struct _sso sso;
+	};
+	// An invalid string is a heap string with no buffer
+	inline bool isSSO() const { return !sso.isHeap; }
+	inline unsigned int len() const { return isSSO() ? sso.len : ptr.len; }
+	inline unsigned int capacity() const { return isSSO() ? (unsigned int)SSOSIZE - 1 : ptr.cap; }
+	inline void setSSO(bool set) { sso.isHeap = !set; }
+	inline void setLen(unsigned int newLen) { if (isSSO()) sso.len = newLen; else ptr.len = newLen; }
+	inline const char *buffer() const { return isSSO() ? sso.buff : ptr.buff; }
+	inline char *wbuffer() { return isSSO() ? sso.buff : ptr.buff; }
 protected:
 	void init(void);
 	void invalidate(void);
@@ -24,22 +24,113 @@
 #define DEBUGWIRE(...) do { } while(0)
 #define DEBUGSPI(...) do { } while(0)
 #else
-#define DEBUGV(fmt, ...) do { DEBUG_RP2040_PORT.printf(fmt, ## __VA_ARGS__); DEBUG_RP2040_PORT.flush(); } while (0)
+
+#if defined(DEBUG_RP2040_DEFERRED) && defined(__cplusplus)
+// Instead of printing (and flushing) in place, each message is recorded as its format pointer
+// and raw arguments in a RAM ring, from any core or IRQ, in a few hundred cycles.  The ring is
+// printed between loop()s, or by calling __debugLogDrain(), and can also be read with a
+// debugger from __debugLogRing.  Strings passed for %s are copied, up to what fits in str[].
+// When the ring is full new messages are dropped and counted.
+#include <type_traits>
+
+#ifndef DEBUG_RP2040_DEFERRED_ENTRIES
+#define DEBUG_RP2040_DEFERRED_ENTRIES 64
+#endif
+
+typedef struct {
+    const char *fmt;
+    uint32_t time;        // Microseconds since boot, low 32 bits
+    uint8_t core;
+    uint8_t nargs;        // Words used in args[]
+    uint8_t strLen;       // Bytes used in str[]
+    uint32_t args[8];     // 64-bit and double arguments take two words, strings their str[] offset
+    char str[32];
+} __DebugLogEntry;
+
+extern "C" void __debugLogPush(__DebugLogEntry *e);
+extern "C" void __debugLogDrain();
+class Print;
+extern void __debugLogPrint(Print &p, const __DebugLogEntry &e);
+
+class __DebugLogBuilder {
+public:
+    __DebugLogBuilder(const char *fmt) {
+        e.fmt = fmt;
+        e.nargs = 0;
+        e.strLen = 0;
+    }
+
+    void add(const char *s) {
+        uint32_t off = e.strLen;
+        while (s && *s && (e.strLen < sizeof(e.str) - 1)) {
+            e.str[e.strLen++] = *s++;
+        }
+        if (e.strLen < sizeof(e.str)) {
+            e.str[e.strLen++] = 0;
+        }
+        word(off);
+    }
+
+    void add(char *s) {
+        add((const char *)s);
+    }
+
+    template<typename T> void add(T v) {
+        if constexpr(std::is_floating_point<T>::value) {
+            double d = v;
+            uint32_t w[2];
+            memcpy(w, &d, sizeof(d));
+            word(w[0]);
+            word(w[1]);
+        } else if constexpr(std::is_null_pointer<T>::value) {
+            word(0);
+        } else if constexpr(std::is_pointer<T>::value) {
+            word((uint32_t)(uintptr_t)v);
+        } else if constexpr(sizeof(T) > 4) {
+            word((uint32_t)(uint64_t)v);
+            word((uint32_t)((uint64_t)v >> 32));
+        } else {
+            word((uint32_t)v);
+        }
+    }
+
+    __DebugLogEntry e;
+
+private:
+    void word(uint32_t w) {
+        if (e.nargs < sizeof(e.args) / sizeof(e.args[0])) {
+            e.args[e.nargs++] = w;
+        }
+    }
+};
+
+template<typename... Args> static inline void __debugLogf(const char *fmt, Args... args) {
+    __DebugLogBuilder b(fmt);
+    (b.add(args), ...);
+    __debugLogPush(&b.e);
+}
+
+#define __DEBUGOUT(fmt, ...) __debugLogf(fmt, ## __VA_ARGS__)
+#else
+#define __DEBUGOUT(fmt, ...) do { DEBUG_RP2040_PORT.printf(fmt, ## __VA_ARGS__); DEBUG_RP2040_PORT.flush(); } while (0)
+#endif
+
+#define DEBUGV(fmt, ...) __DEBUGOUT(fmt, ## __VA_ARGS__)
 
 #if defined(DEBUG_RP2040_CORE)
-#define DEBUGCORE(fmt, ...) do { DEBUG_RP2040_PORT.printf(fmt, ## __VA_ARGS__); DEBUG_RP2040_PORT.flush(); } while (0)
+#define DEBUGCORE(fmt, ...) __DEBUGOUT(fmt, ## __VA_ARGS__)
 #else
 #define DEBUGCORE(...) do { } while(0)
 #endif
 
 #if defined(DEBUG_RP2040_WIRE)
-#define DEBUGWIRE(fmt, ...) do { DEBUG_RP2040_PORT.printf(fmt, ## __VA_ARGS__); DEBUG_RP2040_PORT.flush(); } while (0)
+#define DEBUGWIRE(fmt, ...) __DEBUGOUT(fmt, ## __VA_ARGS__)
 #else
 #define DEBUGWIRE(...) do { } while(0)
 #endif
 
 #if defined(DEBUG_RP2040_SPI)
-#define DEBUGSPI(fmt, ...) do { DEBUG_RP2040_PORT.printf(fmt, ## __VA_ARGS__); DEBUG_RP2040_PORT.flush(); } while (0)
+#define DEBUGSPI(fmt, ...) __DEBUGOUT(fmt, ## __VA_ARGS__)
 #else
 #define DEBUGSPI(...) do { } while(0)
 #endif
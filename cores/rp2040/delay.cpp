@@ -20,6 +20,8 @@
 
 #include <pico.h>
 #include <pico/time.h>
+#include <hardware/sync.h>
+#include "CoreLoad.h"
 
 #ifdef USE_TINYUSB
 #include "Adafruit_TinyUSB_API.h"
@@ -28,15 +30,38 @@
 extern "C" void delay(unsigned long ms) __attribute__((weak));
 extern "C" void yield() __attribute__((weak));
 
+static int64_t _delayDone(__unused alarm_id_t id, __unused void *user_data) {
+    __sev();
+    return 0;
+}
+
 extern "C"
 {
 
+    // One alarm for the whole delay and WFE until it passes.  sleep_ms() would add and remove
+    // an alarm every time the core is woken early (by an IRQ, or by the other core's SEVs from
+    // mutexes and the FIFO), while this only rechecks the time
     void delay(unsigned long ms) {
         if (!ms) {
             return;
         }
 
-        sleep_ms(ms);
+        CoreLoadScope idle(CORELOAD_IDLE);
+        if (__get_current_exception()) {
+            // The alarm IRQ may not be able to preempt us here
+            busy_wait_ms(ms);
+            return;
+        }
+        absolute_time_t until = make_timeout_time_ms(ms);
+        alarm_id_t alarm = add_alarm_at(until, _delayDone, nullptr, false);
+        if (alarm < 0) {
+            // No free alarm slot
+            sleep_until(until);
+            return;
+        }
+        while (!time_reached(until)) {
+            __wfe();
+        }
     }
 
     void delayMicroseconds(unsigned int usec) {
@@ -0,0 +1,140 @@
+/*
+    DMA sniffer sharing and hardware CRC32/CRC16
+
+    The RP2040 DMA sniffer can run a CRC (or a sum) over everything one channel
+    moves.  Only one sniffer exists, so its users take it here and anyone finding
+    it busy (the other core, or an IRQ interrupting a CRC) just computes in
+    software.  Buffers too small to be worth a DMA setup are also done in software.
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <string.h>
+#include <stdint.h>
+#include <hardware/dma.h>
+#include <hardware/sync.h>
+
+// Below this the channel setup costs more than the table lookups
+#define DMA_CRC_MIN 16
+
+static int _chan = -1;
+static bool _noChan = false;
+static volatile bool _busy = false;
+static spin_lock_t *_lock = spin_lock_instance(next_striped_spin_lock_num());
+
+// Returns the channel to run the sniffer on, or -1 if it's in use or there are no free
+// channels.  The channel is claimed on first use and kept.
+extern "C" int __dmaSnifferClaim() {
+    uint32_t irqs = spin_lock_blocking(_lock);
+    int ret = -1;
+    if (!_busy && !_noChan) {
+        if (_chan < 0) {
+            _chan = dma_claim_unused_channel(false);
+            _noChan = _chan < 0;
+        }
+        if (_chan >= 0) {
+            _busy = true;
+            ret = _chan;
+        }
+    }
+    spin_unlock(_lock, irqs);
+    return ret;
+}
+
+extern "C" void __dmaSnifferRelease() {
+    dma_sniffer_disable();
+    _busy = false;
+}
+
+// Feeds len bytes through the sniffer starting from seed, returns the final sniff_data
+static uint32_t _sniffBytes(int ch, uint32_t mode, uint32_t seed, const void *data, size_t len) {
+    static uint8_t sink;
+    dma_channel_config c = dma_channel_get_default_config(ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_sniff_enable(&c, true);
+    dma_sniffer_enable(ch, mode, false);
+    dma_hw->sniff_data = seed;
+    dma_channel_configure(ch, &c, &sink, data, len, true);
+    dma_channel_wait_for_finish_blocking(ch);
+    return dma_hw->sniff_data;
+}
+
+static uint32_t _bitrev32(uint32_t x) {
+    x = ((x >> 1) & 0x55555555) | ((x & 0x55555555) << 1);
+    x = ((x >> 2) & 0x33333333) | ((x & 0x33333333) << 2);
+    x = ((x >> 4) & 0x0f0f0f0f) | ((x & 0x0f0f0f0f) << 4);
+    return __builtin_bswap32(x);
+}
+
+// Reflected CRC-32 (poly 0xedb88320), same as zlib's crc32() and littlefs' lfs_crc()
+static uint32_t _crc32Soft(uint32_t crc, const uint8_t *p, size_t len) {
+    static const uint32_t rtable[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+        0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+        0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+    };
+    while (len--) {
+        crc = (crc >> 4) ^ rtable[(crc ^ *p) & 0xf];
+        crc = (crc >> 4) ^ rtable[(crc ^ (*p >> 4)) & 0xf];
+        p++;
+    }
+    return crc;
+}
+
+// CRC-16/CCITT (poly 0x1021, MSB first), what the sniffer's CRC16 mode computes
+static uint16_t _crc16Soft(uint16_t crc, const uint8_t *p, size_t len) {
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+        0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+    };
+    while (len--) {
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (*p >> 4)];
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (*p & 0xf)];
+        p++;
+    }
+    return crc;
+}
+
+// The CRC register without the pre/post inversion, for littlefs and for chaining.  The
+// sniffer's CRC32R mode keeps the register in non-reflected form, so the running value
+// is bit-reversed going in and coming back out.
+extern "C" uint32_t __dmaCRC32Raw(uint32_t crc, const void *data, size_t len) {
+    int ch;
+    if ((len < DMA_CRC_MIN) || ((ch = __dmaSnifferClaim()) < 0)) {
+        return _crc32Soft(crc, (const uint8_t *)data, len);
+    }
+    crc = _bitrev32(_sniffBytes(ch, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, _bitrev32(crc), data, len));
+    __dmaSnifferRelease();
+    return crc;
+}
+
+extern "C" uint32_t __dmaCRC32(const void *data, size_t len, uint32_t crc) {
+    return ~__dmaCRC32Raw(~crc, data, len);
+}
+
+extern "C" uint16_t __dmaCRC16(const void *data, size_t len, uint16_t crc) {
+    int ch;
+    if ((len < DMA_CRC_MIN) || ((ch = __dmaSnifferClaim()) < 0)) {
+        return _crc16Soft(crc, (const uint8_t *)data, len);
+    }
+    crc = _sniffBytes(ch, DMA_SNIFF_CTRL_CALC_VALUE_CRC16, crc, data, len) & 0xffff;
+    __dmaSnifferRelease();
+    return crc;
+}
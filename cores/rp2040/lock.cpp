@@ -28,9 +28,11 @@
 // HACK ALERT
 // Pico-SDK defines mutex which can be at global scope, but when the auto_init_
 // macros are used they are defined as static.  Newlib needs global access to
-// these mutextes, so instead of hacking pico-sdk just make "static" a no-op.
+// these mutextes, so instead of hacking pico-sdk just make "static" go away.
+// Nothing here refers to them, only the prebuilt Newlib does, so they're also
+// marked used to keep LTO from discarding them.
 
-#define static
+#define static __attribute__((used))
 auto_init_recursive_mutex(__lock___sinit_recursive_mutex);
 auto_init_recursive_mutex(__lock___sfp_recursive_mutex);
 auto_init_recursive_mutex(__lock___atexit_recursive_mutex);
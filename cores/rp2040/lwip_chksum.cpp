@@ -0,0 +1,154 @@
+/*
+    lwIP Internet checksum using the DMA sniffer for large buffers
+
+    The RP2040 DMA sniffer can add up every value a channel moves, which is the
+    bulk of the ones' complement checksum.  lwIP calls LWIP_CHKSUM (and, for TCP
+    writes, LWIP_CHKSUM_COPY) through these functions; big, 16-bit aligned
+    buffers go through a DMA channel while small or odd ones use lwIP's own code.
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <lwip/opt.h>
+
+#if LWIP_PICO_DMA_CHKSUM
+
+#include <string.h>
+#include <stdint.h>
+#include <hardware/dma.h>
+
+extern "C" uint16_t lwip_standard_chksum(const void *dataptr, int len);
+extern "C" int __dmaSnifferClaim();
+extern "C" void __dmaSnifferRelease();
+
+// Below this the channel setup costs more than the software sum
+#define DMA_CHKSUM_MIN 128
+
+#define DMA_SNIFF_SUM 0xf
+
+typedef enum {
+    DMA_CHKSUM_UNKNOWN,    // Not tried yet
+    DMA_CHKSUM_OFF,        // No free channel, or the sniffer didn't behave as expected
+    DMA_CHKSUM_PLAIN,      // Each halfword is added as-is
+    DMA_CHKSUM_REPLICATED  // Each halfword is added replicated into both bus halves
+} DMAChksumMode;
+
+static DMAChksumMode _mode = DMA_CHKSUM_UNKNOWN;
+static int _chan = -1;
+static uint16_t _sink;
+
+// There is only one sniffer, so concurrent callers (the other core, an IRQ
+// interrupting a checksum, or a CRC) just take the software path
+static bool _claim() {
+    if (_mode == DMA_CHKSUM_OFF) {
+        return false;
+    }
+    _chan = __dmaSnifferClaim();
+    return _chan >= 0;
+}
+
+static void _release() {
+    __dmaSnifferRelease();
+}
+
+static uint32_t _sniff(void *dst, const void *src, size_t halfwords) {
+    dma_channel_config c = dma_channel_get_default_config(_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, dst != nullptr);
+    channel_config_set_sniff_enable(&c, true);
+    dma_sniffer_enable(_chan, DMA_SNIFF_SUM, false);
+    dma_hw->sniff_data = 0;
+    dma_channel_configure(_chan, &c, dst ? dst : &_sink, src, halfwords, true);
+    dma_channel_wait_for_finish_blocking(_chan);
+    return dma_hw->sniff_data;
+}
+
+// Recover the plain 32-bit sum of all halfwords from the sniffer's accumulator
+static uint32_t _decode(uint32_t s) {
+    if (_mode == DMA_CHKSUM_REPLICATED) {
+        // Accumulated sum*0x10001: the low half is sum[15:0], the high half sum[15:0]+sum[31:16]
+        uint32_t lo = s & 0xffff;
+        uint32_t hi = ((s >> 16) - lo) & 0xffff;
+        return (hi << 16) | lo;
+    }
+    return s;
+}
+
+// Work out how the sniffer sees 16-bit transfers using a known pattern
+static void _calibrate() {
+    static const uint16_t pattern[2] __attribute__((aligned(4))) = { 0x1234, 0x00ff };
+    uint32_t s = _sniff(nullptr, pattern, 2);
+    if (s == 0x1333) {
+        _mode = DMA_CHKSUM_PLAIN;
+    } else if (s == 0x13331333) {
+        _mode = DMA_CHKSUM_REPLICATED;
+    } else {
+        _mode = DMA_CHKSUM_OFF;
+    }
+}
+
+// Same result as lwip_standard_chksum() for an even start address
+static uint16_t _dmaChksum(void *dst, const void *src, int len) {
+    uint32_t sum = _decode(_sniff(dst, src, len / 2));
+    if (len & 1) {
+        uint8_t last = ((const uint8_t *)src)[len - 1];
+        if (dst) {
+            ((uint8_t *)dst)[len - 1] = last;
+        }
+        sum += last; // Lands in the low byte, as on any little-endian host
+    }
+    sum = (sum >> 16) + (sum & 0xffff);
+    sum = (sum >> 16) + (sum & 0xffff);
+    return (uint16_t)sum;
+}
+
+extern "C" uint16_t __lwipChksum(const void *dataptr, int len) {
+    if ((len < DMA_CHKSUM_MIN) || ((intptr_t)dataptr & 1) || !_claim()) {
+        return lwip_standard_chksum(dataptr, len);
+    }
+    if (_mode == DMA_CHKSUM_UNKNOWN) {
+        _calibrate();
+        if (_mode == DMA_CHKSUM_OFF) {
+            _release();
+            return lwip_standard_chksum(dataptr, len);
+        }
+    }
+    uint16_t ret = _dmaChksum(nullptr, dataptr, len);
+    _release();
+    return ret;
+}
+
+extern "C" uint16_t __lwipChksumCopy(void *dst, const void *src, uint16_t len) {
+    if ((len < DMA_CHKSUM_MIN) || (((intptr_t)dst | (intptr_t)src) & 1) || !_claim()) {
+        memcpy(dst, src, len);
+        return lwip_standard_chksum(dst, len);
+    }
+    if (_mode == DMA_CHKSUM_UNKNOWN) {
+        _calibrate();
+        if (_mode == DMA_CHKSUM_OFF) {
+            _release();
+            memcpy(dst, src, len);
+            return lwip_standard_chksum(dst, len);
+        }
+    }
+    uint16_t ret = _dmaChksum(dst, src, len);
+    _release();
+    return ret;
+}
+
+#endif // LWIP_PICO_DMA_CHKSUM
@@ -0,0 +1,36 @@
+/*
+    lwIP IPv4 routing hook, for LwipIntf's policy routing
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <lwip/netif.h>
+#include <lwip/ip4_addr.h>
+
+#if LWIP_PICO_ROUTE_HOOK
+
+// Installed by LwipIntf once any routing policy is set, until then lwIP routes as usual
+extern "C" {
+    struct netif *(*__lwipRouteHook)(const ip4_addr_t *src, const ip4_addr_t *dest) = nullptr;
+}
+
+// Called by ip4_route_src() with the packet's source address, and again by ip4_route() with
+// none when no interface's subnet holds the destination.  nullptr leaves it to lwIP.
+extern "C" struct netif *__lwipRouteSrc(const ip4_addr_t *src, const ip4_addr_t *dest) {
+    return __lwipRouteHook ? __lwipRouteHook(src, dest) : nullptr;
+}
+#endif
@@ -0,0 +1,42 @@
+/*
+    lwIP TCP input hook, counting what lwIP's own statistics don't
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <stdint.h>
+#include <lwip/tcp.h>
+#include <lwip/prot/tcp.h>
+
+#if LWIP_PICO_STATS
+
+// Read (and cleared) by LwipIntf::stats()/resetStats()
+extern "C" {
+    uint32_t __lwipTcpOutOfOrder = 0;
+}
+
+// Called by tcp_input() for every segment matched to a PCB, with the header already in host
+// order.  Anything starting past the next byte we expect arrived out of order, and lwIP
+// will queue it (TCP_QUEUE_OOSEQ) or drop it.
+extern "C" err_t __lwipTcpInPacket(struct tcp_pcb *pcb, struct tcp_hdr *hdr, struct pbuf *p) {
+    (void) p;
+    if ((pcb->state >= ESTABLISHED) && ((int32_t)(hdr->seqno - pcb->rcv_nxt) > 0)) {
+        __lwipTcpOutOfOrder++;
+    }
+    return ERR_OK;
+}
+#endif
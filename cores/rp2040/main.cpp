@@ -47,17 +47,56 @@ bool __isFreeRTOS;
 void initVariant() __attribute__((weak));
 void initVariant() { }
 
+// Optional network stack initialization on core 1, for the variants which have one
+void initVariantCore1() __attribute__((weak));
+void initVariantCore1() { }
+
+// Placeholder lwIP lock, replaced by variants able to run the stack on core 1
+extern "C" void __lwipLock() __attribute__((weak));
+extern "C" void __lwipLock() { }
+extern "C" void __lwipUnlock() __attribute__((weak));
+extern "C" void __lwipUnlock() { }
+
+// Background work for the WiFi library (scan callbacks), run between loop()s
+void __wifiService() __attribute__((weak));
+void __wifiService() { }
+
+// Software timers (TimerWheel.cpp), only linked in when a sketch uses them
+void __timerService() __attribute__((weak));
+void __timerService() { }
+
+// Sketches may define "bool network_core1 = true;" to run lwIP and the WiFi driver on core 1
+extern bool network_core1 __attribute__((weak));
+bool __networkCore1 = false;
+static volatile bool _networkCore1Ready = false;
+
+// Sketches may define "bool fast_boot = true;" to reach setup() as quickly as possible.  USB is
+// then only started by the first begin() of Serial or another USB class, and there is no delay
+// before starting core 1.
+extern bool fast_boot __attribute__((weak));
+
 // Optional 2nd core setup and loop
 extern void setup1() __attribute__((weak));
 extern void loop1() __attribute__((weak));
 extern "C" void main1() {
+    rp2040.beginCore();
     rp2040.fifo.registerCore();
+    if (__networkCore1) {
+        initVariantCore1();
+        _networkCore1Ready = true;
+    }
+    __coreLoadSwitch(CORELOAD_LOOP);
     if (setup1) {
         setup1();
     }
     while (true) {
         if (loop1) {
             loop1();
+        } else {
+            // Only here to service the network IRQs
+            __coreLoadSwitch(CORELOAD_IDLE);
+            __wfi();
+            __coreLoadSwitch(CORELOAD_LOOP);
         }
     }
 }
@@ -76,25 +115,55 @@ extern void __loop() {
     if (arduino::serialEvent2Run) {
         arduino::serialEvent2Run();
     }
+    __flashService();
+    __wifiService();
+    __timerService();
+#if defined(DEBUG_RP2040_PORT) && defined(DEBUG_RP2040_DEFERRED)
+    __debugLogDrain();
+#endif
 }
 static struct _reent *_impure_ptr1 = nullptr;
 
+extern "C" void __stackPaint0();
+extern "C" void __stackPaint1();
+extern "C" void __entropyInit();
+extern "C" void __crashDumpInit();
+#if defined(DEBUG_RP2040_PORT) && defined(DEBUG_RP2040_DEFERRED)
+extern "C" void __debugLogInit();
+#endif
+
 extern "C" int main() {
-#if F_CPU != 125000000
-    set_sys_clock_khz(F_CPU / 1000, true);
+    // For rp2040.getStackHighWater(), before the stacks see any real use
+    __stackPaint0();
+    __stackPaint1();
+
+    // Picks up the record of the crash before this boot, if any, and installs the fault handler
+    __crashDumpInit();
+
+#if defined(DEBUG_RP2040_PORT) && defined(DEBUG_RP2040_DEFERRED)
+    __debugLogInit();
 #endif
 
+    // Also sets the core voltage and flash clock divider F_CPU needs
+    __initSysClock(F_CPU);
+
     // Let rest of core know if we're using FreeRTOS
     __isFreeRTOS = initFreeRTOS ? true : false;
+    __networkCore1 = !__isFreeRTOS && &network_core1 && network_core1;
+    bool core1 = setup1 || loop1 || __networkCore1;
+    bool fastBoot = !__isFreeRTOS && &fast_boot && fast_boot;
 
     // Allocate impure_ptr (newlib temps) if there is a 2nd core running
-    if (!__isFreeRTOS && (setup1 || loop1)) {
+    if (!__isFreeRTOS && core1) {
         _impure_ptr1 = (struct _reent*)calloc(sizeof(struct _reent), 1);
         _REENT_INIT_PTR(_impure_ptr1);
     }
 
     mutex_init(&_pioMutex);
 
+    // Seeds rp2040.hwrand32(), whose background sampler only starts on first use
+    __entropyInit();
+
     rp2040.begin();
 
     initVariant();
@@ -108,15 +177,19 @@ extern "C" int main() {
     TinyUSB_Device_Init(0);
 
 #else
-    __USBStart();
+    mutex_init(&__usb_mutex);
+
+    if (!fastBoot) {
+        __USBStart();
 
 #ifndef DISABLE_USB_SERIAL
 
-    if (!__isFreeRTOS) {
-        // Enable serial port for reset/upload always
-        Serial.begin(115200);
-    }
+        if (!__isFreeRTOS) {
+            // Enable serial port for reset/upload always
+            Serial.begin(115200);
+        }
 #endif
+    }
 #endif
 #endif
 
@@ -128,7 +201,7 @@ extern "C" int main() {
 
 #ifndef NO_USB
     if (!__isFreeRTOS) {
-        if (setup1 || loop1) {
+        if (core1) {
             rp2040.fifo.begin(2);
         } else {
             rp2040.fifo.begin(1);
@@ -138,14 +211,21 @@ extern "C" int main() {
 #endif
 
     if (!__isFreeRTOS) {
-        if (setup1 || loop1) {
-            delay(1); // Needed to make Picoprobe upload start 2nd core
+        if (core1) {
+            if (!fastBoot) {
+                delay(1); // Needed to make Picoprobe upload start 2nd core
+            }
             multicore_launch_core1(main1);
         }
+        while (!_networkCore1Ready && __networkCore1) {
+            /* wait for the WiFi driver to come up on core 1 */
+        }
         setup();
         while (true) {
             loop();
+            __coreLoadSwitch(CORELOAD_EVENTS);
             __loop();
+            __coreLoadSwitch(CORELOAD_LOOP);
         }
     } else {
         rp2040.fifo.begin(2);
@@ -158,6 +238,8 @@ extern "C" unsigned long ulMainGetRunTimeCounterValue() {
     return rp2040.getCycleCount64();
 }
 
+// Called by the FreeRTOS scheduler (portSET_IMPURE_PTR) on every context switch with the
+// incoming task's own struct _reent, so each task gets private newlib state
 extern "C" void __register_impure_ptr(struct _reent *p) {
     if (get_core_num() == 0) {
         _impure_ptr = p;
@@ -166,9 +248,16 @@ extern "C" void __register_impure_ptr(struct _reent *p) {
     }
 }
 
-
-// TODO:  FreeRTOS should implement this based on thread ID (and each thread should have its own struct _reent
-extern "C" struct _reent *__wrap___getreent() {
+// Only called from Newlib through --wrap, so marked used to keep LTO from dropping it
+extern "C" __attribute__((used)) struct _reent *__wrap___getreent() {
+    if (__isFreeRTOS) {
+        // SMP tasks can migrate between cores, so a reschedule between reading the core
+        // number and the pointer would hand back another task's _reent.
+        uint32_t irqs = save_and_disable_interrupts();
+        struct _reent *r = get_core_num() == 0 ? _impure_ptr : _impure_ptr1;
+        restore_interrupts(irqs);
+        return r;
+    }
     if (get_core_num() == 0) {
         return _impure_ptr;
     } else {
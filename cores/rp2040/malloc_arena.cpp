@@ -0,0 +1,308 @@
+/*
+    Optional per-core small block allocator layered on top of newlib malloc
+
+    Each core gets its own arena, split into 512 byte pages which are handed
+    out on demand to one size class each.  Small allocations are satisfied
+    from the calling core's arena without touching the global malloc lock,
+    and anything else (or any request once the arena is full) falls through
+    to the normal heap.
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <hardware/sync.h>
+#include <pico/platform.h>
+
+extern "C" {
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t count, size_t size);
+    void *__real_realloc(void *mem, size_t size);
+    void __real_free(void *mem);
+}
+
+extern void setup1() __attribute__((weak));
+extern void loop1() __attribute__((weak));
+extern bool __isFreeRTOS;
+extern bool __networkCore1;
+
+static constexpr size_t ARENA_PAGE = 512;
+static constexpr int ARENA_CLASSES = 5; // 8, 16, 32, 64, 128 bytes
+static constexpr size_t ARENA_MAX = 8 << (ARENA_CLASSES - 1);
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+} ArenaBlock;
+
+typedef struct {
+    uint8_t *base;      // nullptr when this core has no arena
+    uint8_t *end;
+    uint8_t *bump;      // Next page not yet assigned to a class
+    uint8_t *pageClass; // Size class of each assigned page
+    ArenaBlock *freeList[ARENA_CLASSES];
+    ArenaBlock *remote; // Blocks freed by the other core, under _arenaLock
+    size_t used;        // Bytes in blocks currently handed out (or pending in remote)
+} Arena;
+
+static Arena _arena[2];
+static spin_lock_t *_arenaLock = nullptr;
+
+static inline int _arenaClass(size_t size) {
+    int c = 0;
+    size_t s = 8;
+    while (s < size) {
+        s <<= 1;
+        c++;
+    }
+    return c;
+}
+
+static inline size_t _arenaClassSize(int c) {
+    return 8 << c;
+}
+
+static inline int _arenaOwner(const void *mem) {
+    const uint8_t *p = (const uint8_t *)mem;
+    for (int i = 0; i < 2; i++) {
+        if (_arena[i].base && (p >= _arena[i].base) && (p < _arena[i].end)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static inline int _arenaPageClass(const Arena *a, const void *mem) {
+    return a->pageClass[((const uint8_t *)mem - a->base) / ARENA_PAGE];
+}
+
+// Called with interrupts disabled on the owning core
+static void *_arenaAlloc(Arena *a, int c) {
+    if (!a->freeList[c] && a->remote) {
+        // Reclaim everything the other core gave back
+        uint32_t irqs = spin_lock_blocking(_arenaLock);
+        ArenaBlock *r = a->remote;
+        a->remote = nullptr;
+        spin_unlock(_arenaLock, irqs);
+        while (r) {
+            ArenaBlock *next = r->next;
+            int rc = _arenaPageClass(a, r);
+            r->next = a->freeList[rc];
+            a->freeList[rc] = r;
+            a->used -= _arenaClassSize(rc);
+            r = next;
+        }
+    }
+    if (!a->freeList[c] && (a->bump < a->end)) {
+        // Carve a fresh page into blocks of this class
+        uint8_t *page = a->bump;
+        a->bump += ARENA_PAGE;
+        a->pageClass[(page - a->base) / ARENA_PAGE] = c;
+        size_t sz = _arenaClassSize(c);
+        for (size_t off = 0; off < ARENA_PAGE; off += sz) {
+            ArenaBlock *b = (ArenaBlock *)(page + off);
+            b->next = a->freeList[c];
+            a->freeList[c] = b;
+        }
+    }
+    ArenaBlock *b = a->freeList[c];
+    if (b) {
+        a->freeList[c] = b->next;
+        a->used += _arenaClassSize(c);
+    }
+    return b;
+}
+
+static void _arenaFree(int owner, void *mem) {
+    Arena *a = &_arena[owner];
+    ArenaBlock *b = (ArenaBlock *)mem;
+    // Interrupts go off before the core is read, so a FreeRTOS SMP task can't be moved to the
+    // other core in between
+    uint32_t irqs = save_and_disable_interrupts();
+    if (owner == (int)get_core_num()) {
+        int c = _arenaPageClass(a, mem);
+        b->next = a->freeList[c];
+        a->freeList[c] = b;
+        a->used -= _arenaClassSize(c);
+    } else {
+        spin_lock_unsafe_blocking(_arenaLock);
+        b->next = a->remote;
+        a->remote = b;
+        spin_unlock_unsafe(_arenaLock);
+    }
+    restore_interrupts(irqs);
+}
+
+static void *_arenaTryAlloc(size_t size) {
+    if (!size || (size > ARENA_MAX)) {
+        return nullptr;
+    }
+    uint32_t irqs = save_and_disable_interrupts();
+    Arena *a = &_arena[get_core_num()];
+    void *ret = a->base ? _arenaAlloc(a, _arenaClass(size)) : nullptr;
+    restore_interrupts(irqs);
+    return ret;
+}
+
+extern "C" bool __mallocArenaBegin(size_t perCore) {
+    if (_arena[0].base || !perCore) {
+        return false;
+    }
+    int cores = (__isFreeRTOS || setup1 || loop1 || __networkCore1) ? 2 : 1;
+    size_t pages = (perCore + ARENA_PAGE - 1) / ARENA_PAGE;
+    _arenaLock = spin_lock_instance(spin_lock_claim_unused(true));
+    for (int i = 0; i < cores; i++) {
+        uint8_t *mem = (uint8_t *)__real_malloc(pages * ARENA_PAGE);
+        uint8_t *cls = (uint8_t *)__real_malloc(pages);
+        if (!mem || !cls) {
+            __real_free(mem);
+            __real_free(cls);
+            return i > 0;
+        }
+        Arena *a = &_arena[i];
+        memset(a, 0, sizeof(*a));
+        a->pageClass = cls;
+        a->bump = mem;
+        a->end = mem + pages * ARENA_PAGE;
+        __dmb();
+        a->base = mem; // Publish last, the wrappers key off of this
+    }
+    return true;
+}
+
+// Bytes reserved for the arenas but not handed out, which mallinfo() counts as used
+extern "C" size_t __mallocArenaFree() {
+    size_t ret = 0;
+    for (int i = 0; i < 2; i++) {
+        if (_arena[i].base) {
+            ret += (_arena[i].end - _arena[i].base) - _arena[i].used;
+        }
+    }
+    return ret;
+}
+
+// Set by MallocTrace::begin().  Called after every heap operation with the new block (or
+// nullptr), the block it replaced or freed (or nullptr), and the code which asked for it
+void (*__mallocTraceHook)(void *mem, void *old, size_t size, void *caller) = nullptr;
+
+static void *_malloc(size_t size) {
+    void *ret = _arenaTryAlloc(size);
+    return ret ? ret : __real_malloc(size);
+}
+
+static void *_calloc(size_t count, size_t size) {
+    size_t total;
+    if (__builtin_mul_overflow(count, size, &total) || (total > ARENA_MAX)) {
+        return __real_calloc(count, size);
+    }
+    void *ret = _arenaTryAlloc(total);
+    if (!ret) {
+        return __real_calloc(count, size);
+    }
+    memset(ret, 0, total);
+    return ret;
+}
+
+static void *_realloc(void *mem, size_t size) {
+    int owner = mem ? _arenaOwner(mem) : -1;
+    if (owner < 0) {
+        return __real_realloc(mem, size);
+    }
+    if (!size) {
+        _arenaFree(owner, mem);
+        return nullptr;
+    }
+    size_t have = _arenaClassSize(_arenaPageClass(&_arena[owner], mem));
+    if (size <= have) {
+        return mem;
+    }
+    void *ret = _malloc(size);
+    if (ret) {
+        memcpy(ret, mem, have);
+        _arenaFree(owner, mem);
+    }
+    return ret;
+}
+
+static void _free(void *mem) {
+    int owner = _arenaOwner(mem);
+    if (owner < 0) {
+        __real_free(mem);
+    } else {
+        _arenaFree(owner, mem);
+    }
+}
+
+// The __wrap_ functions are only reached through --wrap, so they're marked used to keep LTO
+// from dropping them as unreferenced
+extern "C" __attribute__((used)) void *__wrap_malloc(size_t size) {
+    void *ret = _malloc(size);
+    if (__mallocTraceHook) {
+        __mallocTraceHook(ret, nullptr, size, __builtin_return_address(0));
+    }
+    return ret;
+}
+
+extern "C" __attribute__((used)) void *__wrap_calloc(size_t count, size_t size) {
+    void *ret = _calloc(count, size);
+    if (__mallocTraceHook) {
+        __mallocTraceHook(ret, nullptr, count * size, __builtin_return_address(0));
+    }
+    return ret;
+}
+
+extern "C" __attribute__((used)) void *__wrap_realloc(void *mem, size_t size) {
+    void *ret = _realloc(mem, size);
+    if (__mallocTraceHook && (ret || !size)) { // A failed realloc leaves the old block alone
+        __mallocTraceHook(ret, mem, size, __builtin_return_address(0));
+    }
+    return ret;
+}
+
+extern "C" __attribute__((used)) void __wrap_free(void *mem) {
+    if (!mem) {
+        return;
+    }
+    if (__mallocTraceHook) {
+        __mallocTraceHook(nullptr, mem, 0, __builtin_return_address(0));
+    }
+    _free(mem);
+}
+
+// operator new and new[], so traced C++ allocations are charged to the code using new
+// rather than to libstdc++.  Failures go to the real ones for the new_handler/abort
+extern "C" void *__real__Znwj(size_t size);
+extern "C" void *__real__Znaj(size_t size);
+
+extern "C" __attribute__((used)) void *__wrap__Znwj(size_t size) {
+    void *ret = __mallocTraceHook ? _malloc(size) : nullptr;
+    if (!ret) {
+        return __real__Znwj(size);
+    }
+    __mallocTraceHook(ret, nullptr, size, __builtin_return_address(0));
+    return ret;
+}
+
+extern "C" __attribute__((used)) void *__wrap__Znaj(size_t size) {
+    void *ret = __mallocTraceHook ? _malloc(size) : nullptr;
+    if (!ret) {
+        return __real__Znaj(size);
+    }
+    __mallocTraceHook(ret, nullptr, size, __builtin_return_address(0));
+    return ret;
+}
@@ -0,0 +1,148 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// ---------- //
+// quadrature //
+// ---------- //
+
+#define quadrature_wrap_target 1
+#define quadrature_wrap 6
+
+#define quadrature_offset_fup 0u
+#define quadrature_offset_rise 1u
+#define quadrature_offset_fall 4u
+#define quadrature_offset_rdown 7u
+
+static const uint16_t quadrature_program_instructions[] = {
+    0x0081, //  0: jmp    y--, 1
+    //     .wrap_target
+    0x20a0, //  1: wait   1 pin, 0
+    0x00c7, //  2: jmp    pin, 7
+    0x0084, //  3: jmp    y--, 4
+    0x2020, //  4: wait   0 pin, 0
+    0x00c0, //  5: jmp    pin, 0
+    0x0041, //  6: jmp    x--, 1
+    //     .wrap
+    0x0044, //  7: jmp    x--, 4
+    0x0004, //  8: jmp    4
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program quadrature_program = {
+    .instructions = quadrature_program_instructions,
+    .length = 9,
+    .origin = -1,
+};
+
+static inline pio_sm_config quadrature_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + quadrature_wrap_target, offset + quadrature_wrap);
+    return c;
+}
+
+static inline void quadrature_program_init(PIO pio, uint sm, uint offset, uint pinA, uint pinB) {
+    pio_sm_config c = quadrature_program_get_default_config(offset);
+    sm_config_set_in_pins(&c, pinA);
+    sm_config_set_jmp_pin(&c, pinB);
+    pio_sm_init(pio, sm, offset + (gpio_get(pinA) ? quadrature_offset_fall : quadrature_offset_rise), &c);
+    pio_sm_exec(pio, sm, pio_encode_set(pio_x, 0));
+    pio_sm_exec(pio, sm, pio_encode_set(pio_y, 0));
+}
+
+#endif
+
+// ---------- //
+// pulsecount //
+// ---------- //
+
+#define pulsecount_wrap_target 0
+#define pulsecount_wrap 2
+
+static const uint16_t pulsecount_program_instructions[] = {
+    //     .wrap_target
+    0x2020, //  0: wait   0 pin, 0
+    0x20a0, //  1: wait   1 pin, 0
+    0x0040, //  2: jmp    x--, 0
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program pulsecount_program = {
+    .instructions = pulsecount_program_instructions,
+    .length = 3,
+    .origin = -1,
+};
+
+static inline pio_sm_config pulsecount_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + pulsecount_wrap_target, offset + pulsecount_wrap);
+    return c;
+}
+
+static inline void pulsecount_program_init(PIO pio, uint sm, uint offset, uint pin) {
+    pio_sm_config c = pulsecount_program_get_default_config(offset);
+    sm_config_set_in_pins(&c, pin);
+    pio_sm_init(pio, sm, offset, &c);
+    pio_sm_exec(pio, sm, pio_encode_set(pio_x, 0));
+}
+
+#endif
+
+// ----------- //
+// edgecapture //
+// ----------- //
+
+#define edgecapture_wrap_target 0
+#define edgecapture_wrap 7
+
+#define edgecapture_offset_low 0u
+#define edgecapture_offset_rose 3u
+#define edgecapture_offset_high 5u
+#define edgecapture_offset_fell 6u
+#define edgecapture_offset_hdec 8u
+
+static const uint16_t edgecapture_program_instructions[] = {
+    //     .wrap_target
+    0x00c3, //  0: jmp    pin, 3
+    0x0040, //  1: jmp    x--, 0
+    0x0000, //  2: jmp    0
+    0xa0c1, //  3: mov    isr, x
+    0x8000, //  4: push   noblock
+    0x00c8, //  5: jmp    pin, 8
+    0xa0c1, //  6: mov    isr, x
+    0x8000, //  7: push   noblock
+    //     .wrap
+    0x0045, //  8: jmp    x--, 5
+    0x0005, //  9: jmp    5
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program edgecapture_program = {
+    .instructions = edgecapture_program_instructions,
+    .length = 10,
+    .origin = -1,
+};
+
+static inline pio_sm_config edgecapture_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + edgecapture_wrap_target, offset + edgecapture_wrap);
+    return c;
+}
+
+static inline void edgecapture_program_init(PIO pio, uint sm, uint offset, uint pin, bool high) {
+    pio_sm_config c = edgecapture_program_get_default_config(offset);
+    sm_config_set_jmp_pin(&c, pin);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    pio_sm_init(pio, sm, offset + (high ? edgecapture_offset_high : edgecapture_offset_low), &c);
+    pio_sm_exec(pio, sm, pio_encode_set(pio_x, 0));
+}
+
+#endif
+
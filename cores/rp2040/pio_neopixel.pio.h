@@ -0,0 +1,103 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// -------- //
+// neopixel //
+// -------- //
+
+#define neopixel_wrap_target 0
+#define neopixel_wrap 3
+
+#define neopixel_offset_bitloop 0u
+#define neopixel_offset_do_one 2u
+#define neopixel_offset_do_zero 3u
+
+static const uint16_t neopixel_program_instructions[] = {
+    //     .wrap_target
+    0x6221, //  0: out    x, 1            side 0 [2]
+    0x1123, //  1: jmp    !x, 3           side 1 [1]
+    0x1400, //  2: jmp    0               side 1 [4]
+    0xa442, //  3: nop                    side 0 [4]
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program neopixel_program = {
+    .instructions = neopixel_program_instructions,
+    .length = 4,
+    .origin = -1,
+};
+
+static inline pio_sm_config neopixel_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + neopixel_wrap_target, offset + neopixel_wrap);
+    sm_config_set_sideset(&c, 1, false, false);
+    return c;
+}
+
+static inline void neopixel_program_init(PIO pio, uint sm, uint offset, uint pin, uint bits, float div) {
+    pio_gpio_init(pio, pin);
+    pio_sm_set_pins_with_mask(pio, sm, 0, 1u << pin);
+    pio_sm_set_consecutive_pindirs(pio, sm, pin, 1, true);
+    pio_sm_config c = neopixel_program_get_default_config(offset);
+    sm_config_set_sideset_pins(&c, pin);
+    sm_config_set_out_shift(&c, false, true, bits);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv(&c, div);
+    pio_sm_init(pio, sm, offset, &c);
+}
+
+#endif
+
+// ----------------- //
+// neopixel_parallel //
+// ----------------- //
+
+#define neopixel_parallel_wrap_target 0
+#define neopixel_parallel_wrap 3
+
+static const uint16_t neopixel_parallel_program_instructions[] = {
+    //     .wrap_target
+    0x6028, //  0: out    x, 8
+    0xa10b, //  1: mov    pins, !null            [1]
+    0xa401, //  2: mov    pins, x                [4]
+    0xa103, //  3: mov    pins, null             [1]
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program neopixel_parallel_program = {
+    .instructions = neopixel_parallel_program_instructions,
+    .length = 4,
+    .origin = -1,
+};
+
+static inline pio_sm_config neopixel_parallel_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + neopixel_parallel_wrap_target, offset + neopixel_parallel_wrap);
+    return c;
+}
+
+static inline void neopixel_parallel_program_init(PIO pio, uint sm, uint offset, uint pin, uint count, float div) {
+    for (uint i = 0; i < count; i++) {
+        pio_gpio_init(pio, pin + i);
+    }
+    pio_sm_set_pins_with_mask(pio, sm, 0, ((1u << count) - 1) << pin);
+    pio_sm_set_consecutive_pindirs(pio, sm, pin, count, true);
+    pio_sm_config c = neopixel_parallel_program_get_default_config(offset);
+    sm_config_set_out_pins(&c, pin, count);
+    sm_config_set_out_shift(&c, true, true, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv(&c, div);
+    pio_sm_init(pio, sm, offset, &c);
+}
+
+#endif
+
@@ -0,0 +1,71 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// ------- //
+// shifter //
+// ------- //
+
+#define shifter_wrap_target 0
+#define shifter_wrap 10
+
+static const uint16_t shifter_program_instructions[] = {
+    //     .wrap_target
+    0x90a0, //  0: pull   block           side 0
+    0xa047, //  1: mov    y, osr
+    0x6060, //  2: out    null, 32
+    0x80a0, //  3: pull   block
+    0xa027, //  4: mov    x, osr
+    0x6060, //  5: out    null, 32
+    0x7001, //  6: out    pins, 1         side 0
+    0x1886, //  7: jmp    y--, 6          side 1
+    0x1020, //  8: jmp    !x, 0           side 0
+    0xe101, //  9: set    pins, 1                [1]
+    0xe000, // 10: set    pins, 0
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program shifter_program = {
+    .instructions = shifter_program_instructions,
+    .length = 11,
+    .origin = -1,
+};
+
+static inline pio_sm_config shifter_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + shifter_wrap_target, offset + shifter_wrap);
+    sm_config_set_sideset(&c, 2, true, false);
+    return c;
+}
+
+static inline void shifter_program_init(PIO pio, uint sm, uint offset, uint data, uint clock, uint latch, bool hasLatch, bool lsbFirst, uint bits, float div) {
+    pio_gpio_init(pio, data);
+    pio_gpio_init(pio, clock);
+    pio_sm_set_pins_with_mask(pio, sm, 0, (1u << data) | (1u << clock) | (hasLatch ? (1u << latch) : 0));
+    pio_sm_set_consecutive_pindirs(pio, sm, data, 1, true);
+    pio_sm_set_consecutive_pindirs(pio, sm, clock, 1, true);
+    pio_sm_config c = shifter_program_get_default_config(offset);
+    sm_config_set_out_pins(&c, data, 1);
+    sm_config_set_sideset_pins(&c, clock);
+    if (hasLatch) {
+        pio_gpio_init(pio, latch);
+        pio_sm_set_consecutive_pindirs(pio, sm, latch, 1, true);
+        sm_config_set_set_pins(&c, latch, 1);
+    } else {
+        sm_config_set_set_pins(&c, data, 0);
+    }
+    sm_config_set_out_shift(&c, lsbFirst, true, bits);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv(&c, div);
+    pio_sm_init(pio, sm, offset, &c);
+}
+
+#endif
+
@@ -25,6 +25,7 @@
 #include <sys/times.h>
 #include <pico/stdlib.h>
 #include <pico/multicore.h>
+#include "CoreMutex.h"
 
 #undef errno
 
@@ -84,11 +85,71 @@ extern "C" int _getpid(void) {
     return -1;
 }
 
-static int64_t __timedelta_us = 0.0;
+// The system time is disciplined instead of just being offset from the boot timer.
+// It is kept as a base (the raw timer and real time at the last adjustment) plus the
+// raw time elapsed since then, corrected for the estimated crystal frequency error and
+// for any NTP offset still being slewed in.  Small NTP offsets are slewed at a limited
+// rate so the clock never jumps or runs backwards, large ones are stepped.
+#define TIME_STEP_US      128000   // NTP offsets beyond this are stepped
+#define TIME_SLEW_PPM     500      // Rate at which smaller offsets are slewed in
+#define TIME_MAX_FREQ_PPB 500000   // Largest crystal error that will be corrected
+#define TIME_MIN_FLL_US   16000000 // Shortest NTP interval used to estimate the drift
+
+auto_init_mutex(__timeMutex);
+static volatile uint32_t __timeSeq = 0; // Odd while being updated
+static uint64_t __timeBaseRaw = 0;      // Raw timer at the last adjustment
+static int64_t __timeBaseReal = 0;      // Real time at __timeBaseRaw, us since the epoch
+static int64_t __timeSlew = 0;          // Offset to slew in, starting from __timeBaseRaw
+static int32_t __timeFreqPPB = 0;       // Estimated crystal error, positive when slow
+static uint64_t __timeSyncRaw = 0;      // Raw timer at the last NTP sample, 0 for none
+static int64_t __timeLastOffset = 0;
+static uint32_t __timeSyncs = 0;
+
+// Part of __timeSlew applied el microseconds after the base
+static int64_t __timeSlewed(int64_t el) {
+    int64_t lim = el * TIME_SLEW_PPM / 1000000;
+    if (__timeSlew >= 0) {
+        return (__timeSlew < lim) ? __timeSlew : lim;
+    }
+    return (__timeSlew > -lim) ? __timeSlew : -lim;
+}
+
+static int64_t __timeReal(uint64_t raw) {
+    int64_t el = raw - __timeBaseRaw;
+    int64_t freq = (el / 1000000) * __timeFreqPPB / 1000 + (el % 1000000) * __timeFreqPPB / 1000000000;
+    return __timeBaseReal + el + freq + __timeSlewed(el);
+}
+
+// Writers hold __timeMutex and keep IRQs off, so a reader never spins on its own core
+static uint32_t __timeBegin() {
+    uint32_t irq = save_and_disable_interrupts();
+    __timeSeq++;
+    __sync_synchronize();
+    return irq;
+}
+
+static void __timeEnd(uint32_t irq) {
+    __sync_synchronize();
+    __timeSeq++;
+    restore_interrupts(irq);
+}
+
+static void __timeStep(uint64_t raw, int64_t real) {
+    __timeBaseRaw = raw;
+    __timeBaseReal = real;
+    __timeSlew = 0;
+}
 
 extern "C" int _gettimeofday(struct timeval *tv, void *tz) {
     (void) tz;
-    uint64_t now_us = to_us_since_boot(get_absolute_time()) + __timedelta_us;
+    int64_t now_us;
+    uint32_t seq;
+    do {
+        seq = __timeSeq;
+        __sync_synchronize();
+        now_us = __timeReal(to_us_since_boot(get_absolute_time()));
+        __sync_synchronize();
+    } while ((seq & 1) || (seq != __timeSeq));
     if (tv) {
         tv->tv_sec = now_us / 1000000L;
         tv->tv_usec = now_us % 1000000L;
@@ -98,21 +159,62 @@ extern "C" int _gettimeofday(struct timeval *tv, void *tz) {
 
 extern "C" int settimeofday(const struct timeval *tv, const struct timezone *tz) {
     (void) tz;
-    uint64_t now_us = to_us_since_boot(get_absolute_time());
     if (tv) {
-        uint64_t newnow_us;
-        newnow_us = tv->tv_sec * 1000000L;
-        newnow_us += tv->tv_usec;
-        __timedelta_us = newnow_us - now_us;
+        CoreMutex m(&__timeMutex);
+        uint32_t irq = __timeBegin();
+        __timeStep(to_us_since_boot(get_absolute_time()), tv->tv_sec * 1000000LL + tv->tv_usec);
+        __timeSyncRaw = 0; // The next NTP sample steps to the server's time again
+        __timeEnd(irq);
     }
     return 0;
 }
 
 // For NTP
 extern "C" void __setSystemTime(unsigned long long sec, unsigned long usec) {
-    uint64_t now_us = to_us_since_boot(get_absolute_time());
-    uint64_t newnow_us = sec * 1000000LL + usec;
-    __timedelta_us = newnow_us - now_us;
+    CoreMutex m(&__timeMutex);
+    uint32_t irq = __timeBegin();
+    uint64_t raw = to_us_since_boot(get_absolute_time());
+    int64_t ntp = sec * 1000000LL + usec;
+    int64_t local = __timeReal(raw);
+    int64_t offset = ntp - local;
+    int64_t dt = raw - __timeSyncRaw;
+    if (__timeSyncRaw && (dt >= TIME_MIN_FLL_US)) {
+        // Whatever is left after the last slew finished has built up from the frequency error
+        int64_t pending = __timeSlew - __timeSlewed(raw - __timeBaseRaw);
+        int64_t err = (offset - pending) * 1000000000LL / dt;
+        if ((err <= TIME_MAX_FREQ_PPB) && (err >= -TIME_MAX_FREQ_PPB)) { // Otherwise the time jumped
+            int64_t freq = __timeFreqPPB + err / 2;
+            if (freq > TIME_MAX_FREQ_PPB) {
+                freq = TIME_MAX_FREQ_PPB;
+            } else if (freq < -TIME_MAX_FREQ_PPB) {
+                freq = -TIME_MAX_FREQ_PPB;
+            }
+            __timeFreqPPB = freq;
+        }
+    }
+    if (!__timeSyncRaw || (offset > TIME_STEP_US) || (offset < -TIME_STEP_US)) {
+        __timeStep(raw, ntp);
+    } else {
+        __timeBaseRaw = raw;
+        __timeBaseReal = local;
+        __timeSlew = offset;
+    }
+    __timeSyncRaw = raw;
+    __timeLastOffset = offset;
+    __timeSyncs++;
+    __timeEnd(irq);
+}
+
+// Number of NTP samples applied so far, with the last measured offset and the drift estimate
+extern "C" uint32_t __getTimeSync(int64_t *offsetUs, int32_t *driftPPB) {
+    CoreMutex m(&__timeMutex);
+    if (offsetUs) {
+        *offsetUs = __timeLastOffset;
+    }
+    if (driftPPB) {
+        *driftPPB = __timeFreqPPB;
+    }
+    return __timeSyncs;
 }
 
 extern "C" int _isatty(int file) {
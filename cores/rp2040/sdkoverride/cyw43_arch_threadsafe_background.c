@@ -37,6 +37,8 @@
 #endif
 
 volatile bool __inLWIP = false;
+// Set once lwip_init() has run and something calls sys_check_timeouts()
+volatile bool __lwipStarted = false;
 
 // note same code
 #if PICO_CYW43_ARCH_THREADSAFE_BACKGROUND
@@ -211,6 +213,7 @@ int cyw43_arch_init(void) {
     irq_set_enabled(IO_IRQ_BANK0, true);
 
     lwip_init();
+    __lwipStarted = true;
 
     // start low priority handler (no background work is done before this)
     bool ok = low_prio_irq_init(PICO_LOWEST_IRQ_PRIORITY);
@@ -0,0 +1,106 @@
+/*
+    Stack painting and high water marks for the core 0 and core 1 stacks, and
+    buffers carved out of the bottom of their SRAM banks
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Core 0 runs on the top of SCRATCH_Y and core 1 on the top of SCRATCH_X (memmap_default.ld).
+// Whatever the .scratch_* sections leave free below the reserved stacks can also be overrun
+// without a fault, so the whole space from the end of those sections up is painted.
+extern "C" {
+    extern uint32_t __scratch_x_end__;
+    extern uint32_t __scratch_y_end__;
+    extern uint32_t __StackOneTop;
+    extern uint32_t __StackTop;
+}
+
+static constexpr uint32_t STACK_PAINT = 0xdeadc0de;
+
+// Raised by __sramBankAlloc(), the stack can never grow below this
+static uint32_t *_stackBottom[2] = { &__scratch_y_end__, &__scratch_x_end__ };
+
+// Never hand out so much of a bank that its core is left with less stack than this
+static constexpr size_t BANK_MIN_STACK = 2048;
+
+static inline uint32_t *_bottom(int core) {
+    return _stackBottom[core];
+}
+
+static inline uint32_t *_top(int core) {
+    return core ? &__StackOneTop : &__StackTop;
+}
+
+// Core 0 is already running on its stack, so only the part below the current SP is painted.
+// Call first thing in main(), before anything deeper has run.
+extern "C" void __attribute__((noinline)) __stackPaint0() {
+    uint32_t *sp;
+    asm volatile("mov %0, sp" : "=r"(sp));
+    for (uint32_t *p = _bottom(0); p < sp; p++) {
+        *p = STACK_PAINT;
+    }
+}
+
+// Must be done before multicore_launch_core1(), which builds core 1's first frame there
+extern "C" void __stackPaint1() {
+    for (uint32_t *p = _bottom(1); p < _top(1); p++) {
+        *p = STACK_PAINT;
+    }
+}
+
+extern "C" size_t __stackSize(int core) {
+    return (_top(core) - _bottom(core)) * sizeof(uint32_t);
+}
+
+// The deepest the stack has ever been, found as the lowest word no longer holding the paint
+extern "C" size_t __stackHighWater(int core) {
+    uint32_t *p = _bottom(core);
+    uint32_t *top = _top(core);
+    while ((p < top) && (*p == STACK_PAINT)) {
+        p++;
+    }
+    return (top - p) * sizeof(uint32_t);
+}
+
+// SRAM4 (SCRATCH_X) holds core 1's stack and SRAM5 (SCRATCH_Y) core 0's.  Buffers come off
+// the bottom of the bank, below anything the stack has reached so far, and are never freed.
+extern "C" void *__sramBankAlloc(int bank, size_t size) {
+    int core;
+    if (bank == 4) {
+        core = 1;
+    } else if (bank == 5) {
+        core = 0;
+    } else {
+        return nullptr; // SRAM0-3 are striped word by word, nothing can live in just one
+    }
+    uint32_t *p = _bottom(core);
+    uint32_t *newBottom = p + (size + 3) / 4;
+    if (!size || (newBottom > _top(core))) {
+        return nullptr;
+    }
+    size_t left = (_top(core) - newBottom) * sizeof(uint32_t);
+    if ((left < BANK_MIN_STACK) || (left < __stackHighWater(core) + 256)) {
+        return nullptr;
+    }
+    _stackBottom[core] = newBottom;
+    memset(p, 0, size);
+    return p;
+}
@@ -0,0 +1,89 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// -------- //
+// usb_host //
+// -------- //
+
+#define usb_host_wrap_target 8
+#define usb_host_wrap 13
+
+#define usb_host_offset_rx 0u
+#define usb_host_offset_tx 14u
+
+static const uint16_t usb_host_program_instructions[] = {
+    0x20c4, //  0: wait   1 irq, 4
+    0x00c1, //  1: jmp    pin, 1
+    0x0208, //  2: jmp    8               [2]
+    0x0046, //  3: jmp    x--, 6
+    0x00c8, //  4: jmp    pin, 8
+    0x0208, //  5: jmp    8               [2]
+    0x00c3, //  6: jmp    pin, 3
+    0x0208, //  7: jmp    8               [2]
+    //     .wrap_target
+    0x4002, //  8: in     pins, 2
+    0xe022, //  9: set    x, 2
+    0x00c6, // 10: jmp    pin, 6
+    0x00c2, // 11: jmp    pin, 2
+    0x004b, // 12: jmp    x--, 11
+    0x00c2, // 13: jmp    pin, 2
+    //     .wrap
+    0x80a0, // 14: pull   block
+    0x6030, // 15: out    x, 16
+    0x6050, // 16: out    y, 16
+    0xe083, // 17: set    pindirs, 3
+    0x80e0, // 18: pull   ifempty block
+    0x6702, // 19: out    pins, 2         [7]
+    0x0052, // 20: jmp    x--, 18
+    0xe080, // 21: set    pindirs, 0
+    0x0078, // 22: jmp    !y, 24
+    0xc004, // 23: irq    4
+    0x0f0e, // 24: jmp    14              [15]
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program usb_host_program = {
+    .instructions = usb_host_program_instructions,
+    .length = 25,
+    .origin = -1,
+};
+
+static inline pio_sm_config usb_host_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + usb_host_wrap_target, offset + usb_host_wrap);
+    return c;
+}
+
+static inline void usb_host_rx_program_init(PIO pio, uint sm, uint offset, uint dp, uint jpin, float div) {
+    pio_sm_set_consecutive_pindirs(pio, sm, dp, 2, false);
+    pio_sm_config c = usb_host_program_get_default_config(offset);
+    sm_config_set_in_pins(&c, dp);
+    sm_config_set_jmp_pin(&c, jpin);
+    sm_config_set_in_shift(&c, true, true, 16);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    sm_config_set_clkdiv(&c, div);
+    pio_sm_init(pio, sm, offset + usb_host_offset_rx, &c);
+}
+
+static inline void usb_host_tx_program_init(PIO pio, uint sm, uint offset, uint dp, uint idle, float div) {
+    pio_sm_set_pins_with_mask(pio, sm, idle << dp, 3u << dp);
+    pio_sm_set_consecutive_pindirs(pio, sm, dp, 2, false);
+    pio_gpio_init(pio, dp);
+    pio_gpio_init(pio, dp + 1);
+    pio_sm_config c = usb_host_program_get_default_config(offset);
+    sm_config_set_out_pins(&c, dp, 2);
+    sm_config_set_set_pins(&c, dp, 2);
+    sm_config_set_out_shift(&c, true, false, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv(&c, div);
+    pio_sm_init(pio, sm, offset + usb_host_offset_tx, &c);
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include <hardware/clocks.h>
 #include <hardware/pll.h>
 #include <hardware/adc.h>
+#include <hardware/dma.h>
 
 static uint32_t analogScale = 255;
 static uint32_t analogFreq = 1000;
@@ -71,6 +72,70 @@ extern "C" void analogWriteResolution(int res) {
     }
 }
 
+// Keeps the PWM frequency when the system clock changes, dividers out of range are clamped
+static void _analogWriteClockChanged(void *arg, bool after) {
+    (void) arg;
+    if (!after || !pwmInitted) {
+        return;
+    }
+    float div = clock_get_hz(clk_sys) / (float)(analogScale * analogFreq);
+    div = constrain(div, 1.0f, 255.9375f);
+    for (uint slice = 0; slice < NUM_PWM_SLICES; slice++) {
+        pwm_set_clkdiv(slice, div);
+    }
+}
+static ClockNotifier _analogWriteClock(_analogWriteClockChanged, nullptr);
+
+static void _analogWriteInit() {
+    // For low frequencies, we need to scale the output max value up to achieve lower periods
+    analogWritePseudoScale = 1;
+    while (((clock_get_hz(clk_sys) / (float)(analogScale * analogFreq)) > 255.0) && (analogScale < 32678)) {
+        analogWritePseudoScale++;
+        analogScale *= 2;
+        DEBUGCORE("Adjusting analogWrite values PS=%d, scale=%d\n", analogWritePseudoScale, analogScale);
+    }
+    // For high frequencies, we need to scale the output max value down to actually hit the frequency target
+    analogWriteSlowScale = 1;
+    while (((clock_get_hz(clk_sys) / (float)(analogScale * analogFreq)) < 2.0) && (analogScale > 32)) {
+        analogWriteSlowScale++;
+        analogScale /= 2;
+        DEBUGCORE("Adjusting analogWrite values SS=%d, scale=%d\n", analogWriteSlowScale, analogScale);
+    }
+
+    pwm_config c = pwm_get_default_config();
+    pwm_config_set_clkdiv(&c, clock_get_hz(clk_sys) / (float)(analogScale * analogFreq));
+    pwm_config_set_wrap(&c, analogScale);
+    for (int i = 0; i < 30; i++) {
+        pwm_init(pwm_gpio_to_slice_num(i), &c, true);
+    }
+    pwmInitted = true;
+    _analogWriteClock.attach();
+}
+
+// Streaming state per PWM slice.  The control channel re-arms the data channel from
+// _streamAddr when looping, the same trick as a ring but without any alignment needs
+static int _streamData[NUM_PWM_SLICES] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+static int _streamCtrl[NUM_PWM_SLICES] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+static const uint16_t *_streamAddr[NUM_PWM_SLICES];
+
+static void _analogWriteStreamStop(uint slice) {
+    if (_streamData[slice] < 0) {
+        return;
+    }
+    // Unchain before aborting so the abort can't restart the loop
+    dma_channel_config c = dma_get_channel_config(_streamData[slice]);
+    channel_config_set_chain_to(&c, _streamData[slice]);
+    dma_channel_set_config(_streamData[slice], &c, false);
+    if (_streamCtrl[slice] >= 0) {
+        dma_channel_abort(_streamCtrl[slice]);
+        dma_channel_unclaim(_streamCtrl[slice]);
+        _streamCtrl[slice] = -1;
+    }
+    dma_channel_abort(_streamData[slice]);
+    dma_channel_unclaim(_streamData[slice]);
+    _streamData[slice] = -1;
+}
+
 extern "C" void analogWrite(pin_size_t pin, int val) {
     CoreMutex m(&_dacMutex);
 
@@ -79,30 +144,12 @@ extern "C" void analogWrite(pin_size_t pin, int val) {
         return;
     }
     if (!pwmInitted) {
-        // For low frequencies, we need to scale the output max value up to achieve lower periods
-        analogWritePseudoScale = 1;
-        while (((clock_get_hz(clk_sys) / (float)(analogScale * analogFreq)) > 255.0) && (analogScale < 32678)) {
-            analogWritePseudoScale++;
-            analogScale *= 2;
-            DEBUGCORE("Adjusting analogWrite values PS=%d, scale=%d\n", analogWritePseudoScale, analogScale);
-        }
-        // For high frequencies, we need to scale the output max value down to actually hit the frequency target
-        analogWriteSlowScale = 1;
-        while (((clock_get_hz(clk_sys) / (float)(analogScale * analogFreq)) < 2.0) && (analogScale > 32)) {
-            analogWriteSlowScale++;
-            analogScale /= 2;
-            DEBUGCORE("Adjusting analogWrite values SS=%d, scale=%d\n", analogWriteSlowScale, analogScale);
-        }
-
-        pwm_config c = pwm_get_default_config();
-        pwm_config_set_clkdiv(&c, clock_get_hz(clk_sys) / (float)(analogScale * analogFreq));
-        pwm_config_set_wrap(&c, analogScale);
-        for (int i = 0; i < 30; i++) {
-            pwm_init(pwm_gpio_to_slice_num(i), &c, true);
-        }
-        pwmInitted = true;
+        _analogWriteInit();
     }
 
+    // A static level replaces any waveform on this slice
+    _analogWriteStreamStop(pwm_gpio_to_slice_num(pin));
+
     val <<= analogWritePseudoScale;
     val >>= analogWriteSlowScale;
 
@@ -116,6 +163,75 @@ extern "C" void analogWrite(pin_size_t pin, int val) {
     pwm_set_gpio_level(pin, val);
 }
 
+extern "C" bool analogWriteStream(pin_size_t pin, const uint16_t *samples, size_t count, bool loop) {
+    CoreMutex m(&_dacMutex);
+
+    if ((pin > 29) || !m || !samples || !count) {
+        DEBUGCORE("ERROR: Illegal analogWriteStream pin (%d)\n", pin);
+        return false;
+    }
+    if (!pwmInitted) {
+        _analogWriteInit();
+    }
+    uint slice = pwm_gpio_to_slice_num(pin);
+    _analogWriteStreamStop(slice);
+
+    int data = dma_claim_unused_channel(false);
+    int ctrl = loop ? dma_claim_unused_channel(false) : -1;
+    if ((data < 0) || (loop && (ctrl < 0))) {
+        DEBUGCORE("ERROR: analogWriteStream unable to claim DMA channels\n");
+        if (data >= 0) {
+            dma_channel_unclaim(data);
+        }
+        if (ctrl >= 0) {
+            dma_channel_unclaim(ctrl);
+        }
+        return false;
+    }
+    _streamData[slice] = data;
+    _streamCtrl[slice] = ctrl;
+    _streamAddr[slice] = samples;
+
+    // 16-bit writes to PWM registers are replicated to both halves, so CC A and B both
+    // follow the stream.  Only one compare register update per wrap, paced by the slice
+    dma_channel_config c = dma_channel_get_default_config(data);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, DREQ_PWM_WRAP0 + slice);
+    if (loop) {
+        channel_config_set_chain_to(&c, ctrl);
+    }
+    dma_channel_configure(data, &c, &pwm_hw->slice[slice].cc, samples, count, false);
+    if (loop) {
+        c = dma_channel_get_default_config(ctrl);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, false);
+        dma_channel_configure(ctrl, &c, &dma_hw->ch[data].al3_read_addr_trig, &_streamAddr[slice], 1, false);
+    }
+    gpio_set_function(pin, GPIO_FUNC_PWM);
+    dma_channel_start(data);
+    return true;
+}
+
+extern "C" void analogWriteStreamStop(pin_size_t pin) {
+    CoreMutex m(&_dacMutex);
+
+    if ((pin > 29) || !m) {
+        return;
+    }
+    _analogWriteStreamStop(pwm_gpio_to_slice_num(pin));
+}
+
+extern "C" bool analogWriteStreamBusy(pin_size_t pin) {
+    if (pin > 29) {
+        return false;
+    }
+    int ch = _streamData[pwm_gpio_to_slice_num(pin)];
+    return (ch >= 0) && ((_streamCtrl[pwm_gpio_to_slice_num(pin)] >= 0) || dma_channel_is_busy(ch));
+}
+
 auto_init_mutex(_adcMutex);
 static int _readBits = 10;
 
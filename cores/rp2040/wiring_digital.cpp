@@ -22,6 +22,9 @@
 #include <hardware/gpio.h>
 
 static PinMode _pm[30];
+// Pins whose writes drive the output enable instead of the level, see digitalWrite
+static uint32_t _pullupMask = 0;
+static uint32_t _pulldownMask = 0;
 
 extern "C" void pinMode(pin_size_t ulPin, PinMode ulMode) __attribute__((weak, alias("__pinMode")));
 extern "C" void __pinMode(pin_size_t ulPin, PinMode ulMode) {
@@ -75,6 +78,8 @@ extern "C" void __pinMode(pin_size_t ulPin, PinMode ulMode) {
         return;
     }
     _pm[ulPin] = ulMode;
+    _pullupMask = (_pullupMask & ~(1 << ulPin)) | ((ulMode == INPUT_PULLUP) ? 1 << ulPin : 0);
+    _pulldownMask = (_pulldownMask & ~(1 << ulPin)) | ((ulMode == INPUT_PULLDOWN) ? 1 << ulPin : 0);
 }
 
 extern "C" void digitalWrite(pin_size_t ulPin, PinStatus ulVal) __attribute__((weak, alias("__digitalWrite")));
@@ -109,3 +114,20 @@ extern "C" PinStatus __digitalRead(pin_size_t ulPin) {
     }
     return gpio_get(ulPin) ? HIGH : LOW;
 }
+
+extern "C" void digitalWriteMask(uint32_t mask, uint32_t values) {
+    mask &= (1 << 30) - 1;
+    // Open-drain emulation: a pulled-up pin is driven only when LOW, a pulled-down one only when HIGH
+    uint32_t up = mask & _pullupMask;
+    uint32_t down = mask & _pulldownMask;
+    if (up | down) {
+        sio_hw->gpio_oe_set = (up & ~values) | (down & values);
+        sio_hw->gpio_oe_clr = (up & values) | (down & ~values);
+        mask &= ~(up | down);
+    }
+    gpio_put_masked(mask, values);
+}
+
+extern "C" uint32_t digitalReadAll() {
+    return sio_hw->gpio_in & ((1 << 30) - 1);
+}
@@ -23,7 +23,6 @@
 #include <hardware/gpio.h>
 #include <hardware/sync.h>
 #include <stack>
-#include <map>
 
 // Support nested IRQ disable/re-enable
 static std::stack<uint32_t> _irqStack[2];
@@ -43,70 +42,52 @@ extern "C" void noInterrupts() {
 }
 
 // Only 1 GPIO IRQ callback for all pins, so we need to look at the pin it's for and
-// dispatch to the real callback manually
+// dispatch to the real callback manually.  A fixed table indexed by GPIO keeps that to
+// a couple of loads, and the mutex only serializes attach/detach against each other.
 auto_init_mutex(_irqMutex);
-class CBInfo {
-public:
-    CBInfo(voidFuncPtr cb) : _cb(cb), _useParam(false), _param(nullptr) { };
-    CBInfo(voidFuncPtrParam cbParam, void *param) : _cbParam(cbParam), _useParam(true), _param(param) { };
-    void callback() {
-        if (_useParam && _cbParam) {
-            _cbParam(_param);
-        } else if (_cb) {
-            _cb();
-        }
-    }
-private:
-    union {
-        voidFuncPtr _cb;
-        voidFuncPtrParam _cbParam;
-    };
-    bool _useParam;
-    void *_param;
-};
 
+typedef struct {
+    voidFuncPtrParam volatile cb;
+    void * volatile param;
+} IRQEntry;
 
-static std::map<pin_size_t, CBInfo> _map;
+static IRQEntry _irqTable[30];
 
-void _gpioInterruptDispatcher(uint gpio, uint32_t events) {
-    (void) events;
-    // Only need to lock around the std::map check, not the whole IRQ callback
-    CoreMutex m(&_irqMutex);
-    if (m) {
-        auto irq = _map.find(gpio);
-        if (irq != _map.end()) {
-            auto cb = irq->second;
-            cb.callback();
-        }
+// Plain callbacks are stored as the parameter to this, so every entry has the same shape
+static void __not_in_flash_func(_callNoParam)(void *cb) {
+    if (cb) {
+        ((voidFuncPtr)cb)();
     }
 }
 
-extern "C" void attachInterrupt(pin_size_t pin, voidFuncPtr callback, PinStatus mode) {
-    CoreMutex m(&_irqMutex);
-    if (!m) {
+void __not_in_flash_func(_gpioInterruptDispatcher)(uint gpio, uint32_t events) {
+    (void) events;
+    if (gpio >= 30) {
         return;
     }
-
-    uint32_t events;
-    switch (mode) {
-    case LOW:     events = 1; break;
-    case HIGH:    events = 2; break;
-    case FALLING: events = 4; break;
-    case RISING:  events = 8; break;
-    case CHANGE:  events = 4 | 8; break;
-    default:      return;  // ERROR
+    // Writers always clear cb before changing param, so cb reading the same before and
+    // after param means the pair is consistent even if the other core is updating it
+    voidFuncPtrParam cb;
+    void *param;
+    do {
+        cb = _irqTable[gpio].cb;
+        param = _irqTable[gpio].param;
+    } while (cb != _irqTable[gpio].cb);
+    if (cb) {
+        cb(param);
     }
-    noInterrupts();
-    detachInterrupt(pin);
-    CBInfo cb(callback);
-    _map.insert({pin, cb});
-    gpio_set_irq_enabled_with_callback(pin, events, true, _gpioInterruptDispatcher);
-    interrupts();
 }
 
-void attachInterruptParam(pin_size_t pin, voidFuncPtrParam callback, PinStatus mode, void *param) {
+// Caller holds _irqMutex
+static void _detachInterrupt(pin_size_t pin) {
+    gpio_set_irq_enabled(pin, 0x0f /* all */, false);
+    _irqTable[pin].cb = nullptr;
+    __dmb();
+}
+
+static void _attachInterrupt(pin_size_t pin, voidFuncPtrParam callback, void *param, PinStatus mode) {
     CoreMutex m(&_irqMutex);
-    if (!m) {
+    if (!m || (pin >= 30)) {
         return;
     }
 
@@ -120,24 +101,29 @@ void attachInterruptParam(pin_size_t pin, voidFuncPtrParam callback, PinStatus m
     default:      return;  // ERROR
     }
     noInterrupts();
-    detachInterrupt(pin);
-    CBInfo cb(callback, param);
-    _map.insert({pin, cb});
+    _detachInterrupt(pin);
+    _irqTable[pin].param = param;
+    __dmb();
+    _irqTable[pin].cb = callback;
     gpio_set_irq_enabled_with_callback(pin, events, true, _gpioInterruptDispatcher);
     interrupts();
 }
 
+extern "C" void attachInterrupt(pin_size_t pin, voidFuncPtr callback, PinStatus mode) {
+    _attachInterrupt(pin, _callNoParam, (void *)callback, mode);
+}
+
+void attachInterruptParam(pin_size_t pin, voidFuncPtrParam callback, PinStatus mode, void *param) {
+    _attachInterrupt(pin, callback, param, mode);
+}
+
 extern "C" void detachInterrupt(pin_size_t pin) {
     CoreMutex m(&_irqMutex);
-    if (!m) {
+    if (!m || (pin >= 30)) {
         return;
     }
 
     noInterrupts();
-    auto irq = _map.find(pin);
-    if (irq != _map.end()) {
-        gpio_set_irq_enabled(pin, 0x0f /* all */, false);
-        _map.erase(pin);
-    }
+    _detachInterrupt(pin);
     interrupts();
 }
@@ -54,6 +54,15 @@ extern "C" void shiftOut(pin_size_t dataPin, pin_size_t clockPin, BitOrder bitOr
         DEBUGCORE("ERROR: Illegal clockPin in shiftOut (%d)\n", clockPin);
         return;
     }
+    // A running PIOShifter owns these pins, so hand the byte to it
+    PIOShifter *s = __getPIOShifter(dataPin, clockPin);
+    if (s && (s->bits() == 8)) {
+        if (bitOrder != s->order()) {
+            val = ((val * 0x0802LU & 0x22110LU) | (val * 0x8020LU & 0x88440LU)) * 0x10101LU >> 16;
+        }
+        s->write(val, false);
+        return;
+    }
     for (i = 0; i < 8; i++)  {
         if (bitOrder == LSBFIRST) {
             digitalWrite(dataPin, !!(val & (1 << i)));
@@ -20,29 +20,102 @@ extern void interrupts();
 #define LWIP_SOCKET                 0
 #define MEM_LIBC_MALLOC             0
 
+// Buffer sizing profile.  The sizes are compiled into libpico and the prebuilt
+// libraries use the default, so any other needs libpico rebuilt with the same
+// MEMPROFILE (see tools/libpico/CMakeLists.txt).
+//   0 = Low memory:      ~20KB, 4*MSS windows
+//   1 = Default:         ~53KB, 8*MSS windows
+//   2 = High throughput: ~110KB, 48*MSS receive window with window scaling
+#ifndef LWIP_MEM_PROFILE
+#define LWIP_MEM_PROFILE            1
+#endif
+
 #define MEM_ALIGNMENT               4
-#define MEM_SIZE                    16384
-#define MEMP_NUM_TCP_SEG            32
 #define MEMP_NUM_ARP_QUEUE          10
-#define PBUF_POOL_SIZE              24
 #define LWIP_ARP                    1
 #define LWIP_ETHERNET               1
 #define LWIP_ICMP                   1
 #define LWIP_RAW                    1
-#define TCP_WND                     (8 * TCP_MSS)
 #define TCP_MSS                     1460
+#if LWIP_MEM_PROFILE == 0
+#define MEM_SIZE                    8192
+#define MEMP_NUM_TCP_SEG            16
+#define PBUF_POOL_SIZE              8
+#define TCP_WND                     (4 * TCP_MSS)
+#define TCP_SND_BUF                 (4 * TCP_MSS)
+#elif LWIP_MEM_PROFILE == 2
+#define MEM_SIZE                    32768
+#define MEMP_NUM_TCP_SEG            64
+#define PBUF_POOL_SIZE              48
+#define LWIP_WND_SCALE              1
+#define TCP_RCV_SCALE               1
+#define TCP_WND                     (48 * TCP_MSS)
+#define TCP_SND_BUF                 (16 * TCP_MSS)
+#else
+#define MEM_SIZE                    16384
+#define MEMP_NUM_TCP_SEG            32
+#define PBUF_POOL_SIZE              24
+#define TCP_WND                     (8 * TCP_MSS)
 #define TCP_SND_BUF                 (8 * TCP_MSS)
+#endif
 #define TCP_SND_QUEUELEN            ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
 #define LWIP_NETIF_STATUS_CALLBACK  1
 #define LWIP_NETIF_LINK_CALLBACK    1
 #define LWIP_NETIF_HOSTNAME         1
 #define LWIP_NETCONN                0
+// Counters for LwipIntf::stats(), kept in every build when on.  They change struct netif and
+// need lwIP's own statistics compiled in, so libpico has to be rebuilt (make-libpico.sh) with
+// the same setting.  The prebuilt libraries are built without them.
+#ifndef LWIP_PICO_STATS
+#define LWIP_PICO_STATS             0
+#endif
+#if LWIP_PICO_STATS
+#define LWIP_STATS                  1
+#define MEM_STATS                   1
+#define SYS_STATS                   0
+#define MEMP_STATS                  1
+#define LINK_STATS                  1
+#define MIB2_STATS                  1
+// lwIP doesn't count out-of-order TCP segments itself
+struct tcp_pcb;
+struct tcp_hdr;
+struct pbuf;
+extern signed char __lwipTcpInPacket(struct tcp_pcb *pcb, struct tcp_hdr *hdr, struct pbuf *p);
+#define LWIP_HOOK_TCP_INPACKET_PCB(pcb, hdr, optlen, opt1len, opt2, p) __lwipTcpInPacket(pcb, hdr, p)
+#else
 #define MEM_STATS                   0
 #define SYS_STATS                   0
 #define MEMP_STATS                  0
 #define LINK_STATS                  0
+#endif
+// Policy routing between interfaces, see LwipIntf::addRoute().  lwIP calls the hook from
+// inside libpico, so it needs libpico rebuilt (make-libpico.sh) with the same setting.  The
+// prebuilt libraries are built without it.
+#ifndef LWIP_PICO_ROUTE_HOOK
+#define LWIP_PICO_ROUTE_HOOK        0
+#endif
+#if LWIP_PICO_ROUTE_HOOK
+struct netif;
+struct ip4_addr;
+extern struct netif *__lwipRouteSrc(const struct ip4_addr *src, const struct ip4_addr *dest);
+#define LWIP_HOOK_IP4_ROUTE_SRC(src, dest) __lwipRouteSrc(src, dest)
+#endif
 // #define ETH_PAD_SIZE                2
 #define LWIP_CHKSUM_ALGORITHM       3
+// Large buffers are summed by the DMA sniffer, falling back to the algorithm above.  The
+// checksums are done inside libpico and TCP_CHECKSUM_ON_COPY changes struct tcp_seg, so this
+// only works with libpico rebuilt (make-libpico.sh) with the same setting.  The prebuilt
+// libraries are built without it.
+#ifndef LWIP_PICO_DMA_CHKSUM
+#define LWIP_PICO_DMA_CHKSUM        0
+#endif
+#if LWIP_PICO_DMA_CHKSUM
+extern unsigned short __lwipChksum(const void *dataptr, int len);
+extern unsigned short __lwipChksumCopy(void *dst, const void *src, unsigned short len);
+#define LWIP_CHKSUM                 __lwipChksum
+#define TCP_CHECKSUM_ON_COPY        1
+#define LWIP_CHKSUM_COPY(dst, src, len) __lwipChksumCopy(dst, src, len)
+#endif
 #define LWIP_DHCP                   1
 #define LWIP_IPV4                   1
 #define LWIP_TCP                    1
@@ -66,7 +139,9 @@ extern void __setSystemTime(unsigned long long sec, unsigned long us);
 
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
+#ifndef LWIP_STATS
 #define LWIP_STATS                  1
+#endif
 #define LWIP_STATS_DISPLAY          1
 #endif
 
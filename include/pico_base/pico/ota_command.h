@@ -23,6 +23,8 @@
 
 #define _OTA_WRITE 1
 #define _OTA_VERIFY 1
+#define _OTA_DELTA 2
+#define _OTA_CHECK 3     // Check flash against a CRC32 after the commands before it, writes nothing
 
 typedef struct {
     uint32_t command;
@@ -33,18 +35,82 @@ typedef struct {
             uint32_t fileLength;
             uint32_t flashAddress;   // Normally XIP_BASE
         } write;
+        struct {
+            char filename[64];
+            uint32_t flashAddress;   // Base image the patch applies to, normally XIP_BASE
+        } delta;
+        struct {
+            uint32_t flashAddress;
+            uint32_t length;
+            uint32_t crc32;
+        } check;
     };
 } commandEntry;
 
-// Must fit within 4K page
+#define _OTA_MAX_COMMANDS 8
+
+// Must fit within 4K page.  This layout is what every OTA bootloader reads, and must not change.
 typedef struct {
-    uint8_t sign[8]; // "Pico OTA"
+    uint8_t sign[8]; // "Pico OTA", or _OTA_SIGN_EXT
 
     // List of operations
     uint32_t count;
-    commandEntry cmd[8];
+    commandEntry cmd[_OTA_MAX_COMMANDS];
 
     uint32_t crc32; // CRC32 over just the contents of this struct, up until just before this value
 } OTACmdPage;
 
+// Version 2 extension, stored in the same file straight after the OTACmdPage.  Bootloaders from
+// before it only read the OTACmdPage, so a page needing none of it is still signed "Pico OTA"
+// and works with them.  A page which does need it (write CRCs, _OTA_CHECK or a chained page) is
+// signed _OTA_SIGN_EXT instead, which older bootloaders skip as a whole rather than do in part.
+#define _OTA_SIGN_EXT "PicoOTA2"
+#define _OTA_EXT_SIGN "OTA Ext "
+#define _OTA_EXT_VERSION 2
+
+typedef struct {
+    uint8_t sign[8];     // _OTA_EXT_SIGN
+    uint32_t version;    // _OTA_EXT_VERSION
+
+    // Bit i set when crc32[i] is the CRC32 of the data cmd[i] writes.  Every such file is read
+    // and checked before anything is written, and the flash is checked afterwards.
+    uint32_t crcMask;
+    uint32_t crc32[_OTA_MAX_COMMANDS];
+
+    // Command file with the operations following these, in this same format, or "" for none
+    char next[64];
+
+    uint32_t extCRC32;   // CRC32 over this struct, up until just before this value
+} OTACmdExt;
+
 #define _OTA_COMMAND_FILE "otacommand.bin"
+#define _OTA_CHAIN_FILE "otacommand%u.bin" // Pages after the first, numbered from 1
+#define _OTA_MAX_PAGES 128
+
+// Consecutive writes from the same file at increasing offsets are read in one pass, so one
+// image file (compressed or not) can be scattered over several flash regions cheaply.
+
+// Delta patch file, rebuilding the new image in place from the one already in flash.
+// After the header come blockCount records, each a uint32_t 4K block number followed by
+// copy/insert operations producing exactly that block (the last one may be short):
+//   uint32_t len, uint32_t src   - copy len bytes from the base image at offset src
+//   uint32_t len | 0x80000000    - insert the len bytes that follow
+// Blocks are rebuilt in patch order, so a copy may only read blocks not yet rewritten
+// (or the block being rebuilt).  Blocks left out of the patch are unchanged.
+#define _OTA_DELTA_SIGN "PicoDiff"
+// Built into bootloaders which can apply _OTA_DELTA.  Older ones (including the prebuilt
+// lib/ota.o until it is rebuilt from ota/) drop the command and boot the old image, so
+// PicoOTA looks for this in the running bootloader before staging a delta.
+#define _OTA_DELTA_CAPABLE "PicoOTA:delta1"
+#define _OTA_DELTA_INSERT 0x80000000
+#define _OTA_DELTA_BLOCK 4096
+
+typedef struct {
+    uint8_t sign[8]; // "PicoDiff"
+    uint32_t baseLength;
+    uint32_t baseCRC;    // CRC32 of the image the patch was made against
+    uint32_t newLength;
+    uint32_t newCRC;     // CRC32 of the resulting image
+    uint32_t blockCount;
+    uint32_t patchCRC;   // CRC32 of the rebuilt blocks, in patch order
+} OTADeltaHeader;
@@ -0,0 +1,45 @@
+/*
+  Captures A0 and A1 at 100K samples per second each with no CPU polling,
+  and prints the average and peak-to-peak of each channel once a second.
+
+  Released to the public domain by Earle F. Philhower, III <earlephilhower@yahoo.com>
+*/
+
+#include <ADCInput.h>
+
+ADCInput adc(A0, A1);
+
+void setup() {
+  Serial.begin(115200);
+  adc.setBuffers(8, 1024);
+  adc.begin(100000);
+}
+
+void loop() {
+  static uint32_t sum[2], count = 0;
+  static uint16_t lo[2] = { 4095, 4095 }, hi[2] = { 0, 0 };
+
+  // Samples alternate A0, A1, A0, A1...
+  const uint32_t *buff = adc.getReadBuffer();
+  for (size_t i = 0; i < adc.getBufferWords(); i += 2) {
+    for (int c = 0; c < 2; c++) {
+      uint16_t v = buff[i + c];
+      sum[c] += v;
+      lo[c] = min(lo[c], v);
+      hi[c] = max(hi[c], v);
+    }
+  }
+  adc.releaseReadBuffer();
+  count += adc.getBufferWords() / 2;
+
+  if (count >= 100000) {
+    for (int c = 0; c < 2; c++) {
+      Serial.printf("A%d: avg %lu, p-p %d   ", c, sum[c] / count, hi[c] - lo[c]);
+      sum[c] = 0;
+      lo[c] = 4095;
+      hi[c] = 0;
+    }
+    Serial.printf("%s\n", adc.getOverflow() ? "OVERFLOW" : "");
+    count = 0;
+  }
+}
@@ -0,0 +1,196 @@
+/*
+    ADCInput - Free-running ADC sampling into a DMA ring buffer
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <hardware/adc.h>
+#include <hardware/dma.h>
+#include "ADCInput.h"
+
+ADCInput::ADCInput(pin_size_t p0, pin_size_t p1, pin_size_t p2, pin_size_t p3) {
+    _running = false;
+    _mask = 0;
+    _channels = 0;
+    setPins(p0, p1, p2, p3);
+    _freq = 48000;
+    _buffers = 8;
+    _bufferWords = 256;
+    _hasPeeked = false;
+    _peekSaved = 0;
+    _cb = nullptr;
+    _arb = nullptr;
+}
+
+ADCInput::~ADCInput() {
+    end();
+}
+
+bool ADCInput::setPins(pin_size_t p0, pin_size_t p1, pin_size_t p2, pin_size_t p3) {
+    if (_running) {
+        return false;
+    }
+    pin_size_t pins[4] = { p0, p1, p2, p3 };
+    uint8_t mask = 0;
+    for (auto p : pins) {
+        if (p == 255) {
+            continue;
+        }
+        if ((p < A0) || (p > A3)) {
+            DEBUGV("ADCInput: Illegal pin %d\n", p);
+            return false;
+        }
+        mask |= 1 << (p - A0);
+    }
+    if (!mask) {
+        return false;
+    }
+    _mask = mask;
+    _channels = __builtin_popcount(mask);
+    return true;
+}
+
+bool ADCInput::setBuffers(size_t buffers, size_t bufferWords) {
+    if (_running || (buffers < 3) || (bufferWords < 8)) {
+        return false;
+    }
+    _buffers = buffers;
+    _bufferWords = bufferWords;
+    return true;
+}
+
+bool ADCInput::setFrequency(int newFreq) {
+    if (_running || (newFreq <= 0) || (newFreq * _channels > 500000)) {
+        return false;
+    }
+    _freq = newFreq;
+    return true;
+}
+
+void ADCInput::onReceive(void(*fn)(void)) {
+    _cb = fn;
+    if (_running) {
+        _arb->setCallback(_cb);
+    }
+}
+
+bool ADCInput::begin() {
+    if (_running || (_freq * _channels > 500000)) {
+        return false;
+    }
+    _hasPeeked = false;
+    // Whole frames per buffer keep every buffer starting on the lowest channel
+    _bufferWords -= _bufferWords % _channels;
+
+    adc_init();
+    int first = -1;
+    for (int i = 0; i < 4; i++) {
+        if (_mask & (1 << i)) {
+            adc_gpio_init(A0 + i);
+            if (first < 0) {
+                first = i;
+            }
+        }
+    }
+    adc_select_input(first);
+    adc_set_round_robin(_channels > 1 ? _mask : 0);
+    // One 12-bit sample per DREQ, no error bit or byte shift
+    adc_fifo_setup(true, true, 1, false, false);
+    // A conversion takes 1 + div cycles of the 48MHz ADC clock, 96 at the fastest
+    float div = 48000000.0f / (_freq * _channels) - 1.0f;
+    adc_set_clkdiv(div < 0.0f ? 0.0f : div);
+    adc_fifo_drain();
+
+    _arb = new AudioRingBuffer(_buffers, _bufferWords, 0, INPUT);
+    _arb->setCallback(_cb);
+    if (!_arb->begin(DREQ_ADC, &adc_hw->fifo)) {
+        delete _arb;
+        _arb = nullptr;
+        return false;
+    }
+    _running = true;
+    adc_run(true);
+    return true;
+}
+
+void ADCInput::end() {
+    if (_running) {
+        adc_run(false);
+        // Let any conversion in flight finish before emptying the FIFO
+        while (!(adc_hw->cs & ADC_CS_READY_BITS)) {
+            /* noop busy wait */
+        }
+        adc_fifo_setup(false, false, 1, false, false);
+        adc_fifo_drain();
+        adc_set_round_robin(0);
+    }
+    _running = false;
+    delete _arb;
+    _arb = nullptr;
+}
+
+int ADCInput::available() {
+    if (!_running) {
+        return 0;
+    }
+    return _arb->available();
+}
+
+int ADCInput::read() {
+    if (!_running) {
+        return -1;
+    }
+    if (_hasPeeked) {
+        _hasPeeked = false;
+        return _peekSaved;
+    }
+    uint32_t v;
+    _arb->read(&v, true);
+    return v & 0xfff;
+}
+
+int ADCInput::peek() {
+    if (!_running) {
+        return -1;
+    }
+    if (!_hasPeeked) {
+        _peekSaved = read();
+        _hasPeeked = true;
+    }
+    return _peekSaved;
+}
+
+const uint32_t *ADCInput::getReadBuffer(bool sync) {
+    if (!_running) {
+        return nullptr;
+    }
+    return _arb->getReadBuffer(sync);
+}
+
+void ADCInput::releaseReadBuffer() {
+    if (_running) {
+        _arb->releaseReadBuffer();
+    }
+}
+
+bool ADCInput::getOverflow() {
+    if (!_running) {
+        return false;
+    }
+    return _arb->getOverUnderflow();
+}
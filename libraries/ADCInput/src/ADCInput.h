@@ -0,0 +1,81 @@
+/*
+    ADCInput - Free-running ADC sampling into a DMA ring buffer
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+#include <Arduino.h>
+#include <AudioRingBuffer.h>
+
+class ADCInput : public Stream {
+public:
+    // Up to 4 of A0..A3, sampled round-robin in ascending pin order
+    ADCInput(pin_size_t p0 = A0, pin_size_t p1 = 255, pin_size_t p2 = 255, pin_size_t p3 = 255);
+    virtual ~ADCInput();
+
+    bool setPins(pin_size_t p0, pin_size_t p1 = 255, pin_size_t p2 = 255, pin_size_t p3 = 255);
+    bool setBuffers(size_t buffers, size_t bufferWords);
+    // Samples per second per channel, the ADC itself tops out at 500K total
+    bool setFrequency(int newFreq);
+
+    bool begin(int sampleRate) {
+        setFrequency(sampleRate);
+        return begin();
+    }
+    bool begin();
+    void end();
+
+    int channels() {
+        return _channels;
+    }
+
+    // from Stream, one 12-bit sample at a time
+    virtual int available() override;
+    virtual int read() override;
+    virtual int peek() override;
+    virtual void flush() override { }
+    virtual size_t write(uint8_t s) override {
+        (void) s;
+        return 0;
+    }
+
+    // Whole DMA buffers of getBufferWords() samples, one per 32-bit word
+    const uint32_t *getReadBuffer(bool sync = true);
+    void releaseReadBuffer();
+    size_t getBufferWords() {
+        return _bufferWords;
+    }
+
+    // True if a buffer was overwritten before it was read since the last call
+    bool getOverflow();
+
+    // Called from **INTERRUPT CONTEXT** for every buffer filled, should be quick and in RAM
+    void onReceive(void(*fn)(void));
+
+private:
+    uint8_t _mask;
+    int _channels;
+    int _freq;
+    size_t _buffers;
+    size_t _bufferWords;
+    bool _running;
+    bool _hasPeeked;
+    int _peekSaved;
+    void (*_cb)();
+    AudioRingBuffer *_arb;
+};
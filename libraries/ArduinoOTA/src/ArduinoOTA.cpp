@@ -319,17 +319,22 @@ void ArduinoOTAClass::_runUpdate() {
             _error_callback(OTA_CONNECT_ERROR);
         }
         _state = OTA_IDLE;
+        return;
     }
     // OTA sends little packets
     client.setNoDelay(true);
 
-    uint32_t written, total = 0;
+    // Older espota.py versions wait for a reply to every packet, newer ones stream the image
+    // and let the TCP window pace them.  Either way only reply once everything received so far
+    // has been handed to the Updater, so a streaming upload gets one reply per burst instead of
+    // one per packet, while lwIP keeps filling the window in the background
+    uint32_t written, total = 0, acked = 0;
     while (!Update.isFinished() && (client.connected() || client.available())) {
-        int waited = 1000;
-        while (!client.available() && waited--) {
+        uint32_t start = millis();
+        while (!client.available() && (client.connected()) && (millis() - start < 1000)) {
             delay(1);
         }
-        if (!waited) {
+        if (!client.available()) {
 #ifdef OTA_DEBUG
             OTA_DEBUG.printf("Receive Failed\n");
 #endif
@@ -338,14 +343,20 @@ void ArduinoOTAClass::_runUpdate() {
                 _error_callback(OTA_RECEIVE_ERROR);
             }
             _state = OTA_IDLE;
+            break;
         }
         written = Update.write(client);
         if (written > 0) {
-            client.print(written, DEC);
             total += written;
+            if (!client.available()) {
+                client.print(total - acked, DEC);
+                acked = total;
+            }
             if (_progress_callback) {
                 _progress_callback(total, _size);
             }
+        } else if (Update.hasError()) {
+            break;
         }
     }
 
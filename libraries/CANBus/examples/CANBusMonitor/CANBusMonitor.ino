@@ -0,0 +1,45 @@
+// Prints every frame seen on a 500kbit/s CAN bus and sends a counter as ID 0x123 once
+// a second.  Another node (any ordinary CAN controller) needs to be on the bus to ACK.
+//
+// Transceiver (e.g. SN65HVD230) TXD on GPIO 4, RXD on GPIO 5
+//
+// Released to the public domain by Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+#include <CANBus.h>
+
+CANBus can(4, 5);
+
+void setup() {
+  Serial.begin(115200);
+  if (!can.begin(500000)) {
+    Serial.println("Unable to start CAN");
+  }
+}
+
+uint32_t counter = 0;
+uint32_t last = 0;
+
+void loop() {
+  CANFrame f;
+  while (can.read(f)) {
+    Serial.printf("%s %08lx %s [%d]", f.extended ? "EXT" : "STD", f.id, f.rtr ? "RTR" : "   ", f.len);
+    for (int i = 0; !f.rtr && (i < f.len); i++) {
+      Serial.printf(" %02x", f.data[i]);
+    }
+    Serial.println();
+  }
+
+  if (millis() - last > 1000) {
+    last = millis();
+    f.id = 0x123;
+    f.extended = false;
+    f.rtr = false;
+    f.len = 4;
+    memcpy(f.data, &counter, 4);
+    counter++;
+    if (!can.write(f)) {
+      Serial.println("TX queue full");
+    }
+    Serial.printf("rxErrors %lu, rxOverruns %lu, txErrors %lu\n", can.rxErrors(), can.rxOverruns(), can.txErrors());
+  }
+}
@@ -0,0 +1,568 @@
+/*
+    CANBus.cpp - CAN 2.0B controller using PIO for bit timing and DMA for reception
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "CANBus.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include "can_bus.pio.h"
+
+static PIOProgram _canRxPgm(&can_rx_program);
+static PIOProgram _canTxPgm(&can_tx_program);
+
+// Both SMs take 16 cycles per bit
+#define CAN_CYCLES 16
+// The bus is idle after 11 recessive bits, which can_tx polls every 2 cycles
+#define CAN_IDLE_POLLS (11 * CAN_CYCLES / 2 - 1)
+
+enum { RX_WAIT, RX_IDLE, RX_FRAME };
+
+CANBus::CANBus(pin_size_t tx, pin_size_t rx) {
+    _tx = tx;
+    _rx = rx;
+    _bitrate = 0;
+    _running = false;
+    _rxPIO = nullptr;
+    _txPIO = nullptr;
+    _rxSM = -1;
+    _txSM = -1;
+    _rxOffset = -1;
+    _txOffset = -1;
+    _rxRing = nullptr;
+    _rxPos = 0;
+    _rxState = RX_WAIT;
+    _rxRun = 0;
+    _echoHead = 0;
+    _echoTail = 0;
+    clearFilters();
+    _txBusy = false;
+    _txTries = 0;
+    _txResult = 0;
+    _rxErrors = 0;
+    _rxOverruns = 0;
+    _txErrors = 0;
+}
+
+CANBus::~CANBus() {
+    end();
+}
+
+bool CANBus::begin(uint32_t bitrate) {
+    if (_running) {
+        return false;
+    }
+    if ((_tx > 29) || (_rx > 29) || (_tx == _rx) || (bitrate < 10000) || (bitrate > 1000000)) {
+        DEBUGV("CANBus: Illegal pins or bitrate\n");
+        return false;
+    }
+    if (!_canRxPgm.prepare(&_rxPIO, &_rxSM, &_rxOffset)) {
+        DEBUGV("CANBus: No free PIO state machine\n");
+        return false;
+    }
+    if (!_canTxPgm.prepare(&_txPIO, &_txSM, &_txOffset)) {
+        DEBUGV("CANBus: No free PIO state machine\n");
+        PIOProgram::unprepare(_rxPIO, _rxSM);
+        return false;
+    }
+    if (!_rxDMA[0].claim() || !_rxDMA[1].claim() || !_txDMA.claim() || !_resultDMA.claim()) {
+        DEBUGV("CANBus: No free DMA channels\n");
+        _rxDMA[0].unclaim();
+        _rxDMA[1].unclaim();
+        _txDMA.unclaim();
+        _resultDMA.unclaim();
+        PIOProgram::unprepare(_rxPIO, _rxSM);
+        PIOProgram::unprepare(_txPIO, _txSM);
+        return false;
+    }
+    _bitrate = bitrate;
+    _rxRing = (uint32_t *)aligned_alloc(CANBUS_RX_RING * 4, CANBUS_RX_RING * 4);
+    _rxQueue.clear();
+    _txQueue.clear();
+    _echoHead = _echoTail = 0;
+    _txBusy = false;
+    _txTries = 0;
+
+    pinMode(_rx, INPUT_PULLUP);
+    float div = clock_get_hz(clk_sys) / (float)(CAN_CYCLES * _bitrate);
+    can_rx_program_init(_rxPIO, _rxSM, _rxOffset, _rx, div);
+    can_tx_program_init(_txPIO, _txSM, _txOffset, _tx, _rx, div);
+
+    // Each half of the ring has its own channel, wrapping on itself, and the two trigger each
+    // other so sampling never stops.  Decoding is done as each one completes
+    for (int i = 0; i < 2; i++) {
+        _rxDMA[i].setSize(DMA_SIZE_32);
+        _rxDMA[i].setIncrement(false, true);
+        _rxDMA[i].setDREQ(pio_get_dreq(_rxPIO, _rxSM, false));
+        _rxDMA[i].setRing(true, __builtin_ctz(_half * 4));
+        _rxDMA[i].chainTo(_rxDMA[i ^ 1]);
+        _rxDMA[i].onComplete(_rxIRQ, this);
+    }
+    _rxDMA[1].prepare(_rxRing + _half, &_rxPIO->rxf[_rxSM], _half);
+    _rxDMA[0].start(_rxRing, &_rxPIO->rxf[_rxSM], _half);
+    _rxPos = 0;
+    _rxState = RX_WAIT;
+    _rxRun = 0;
+
+    _txDMA.setSize(DMA_SIZE_32);
+    _txDMA.setIncrement(true, false);
+    _txDMA.setDREQ(pio_get_dreq(_txPIO, _txSM, true));
+    // The result word can_tx pushes at the end of each attempt lands in _txResult
+    _resultDMA.setSize(DMA_SIZE_32);
+    _resultDMA.setIncrement(false, false);
+    _resultDMA.setDREQ(pio_get_dreq(_txPIO, _txSM, false));
+    _resultDMA.onComplete(_txIRQ, this);
+
+    pio_sm_set_enabled(_rxPIO, _rxSM, true);
+    pio_sm_set_enabled(_txPIO, _txSM, true);
+    _clockNotifier.attach();
+    _running = true;
+    return true;
+}
+
+void CANBus::end() {
+    if (!_running) {
+        return;
+    }
+    _clockNotifier.detach();
+    // With the SMs stopped nothing paces the DMAs, so the RX pair can't trigger each other
+    pio_sm_set_enabled(_rxPIO, _rxSM, false);
+    pio_sm_set_enabled(_txPIO, _txSM, false);
+    _rxDMA[0].unclaim();
+    _rxDMA[1].unclaim();
+    _txDMA.unclaim();
+    _resultDMA.unclaim();
+    PIOProgram::unprepare(_rxPIO, _rxSM);
+    PIOProgram::unprepare(_txPIO, _txSM);
+    _rxSM = -1;
+    _txSM = -1;
+    // Recessive as far as the transceiver's concerned
+    pinMode(_tx, INPUT_PULLUP);
+    free(_rxRing);
+    _rxRing = nullptr;
+    _txBusy = false;
+    _running = false;
+}
+
+void CANBus::_setClock() {
+    float div = clock_get_hz(clk_sys) / (float)(CAN_CYCLES * _bitrate);
+    pio_sm_set_clkdiv(_rxPIO, _rxSM, div);
+    pio_sm_set_clkdiv(_txPIO, _txSM, div);
+}
+
+void CANBus::_clockChanged(void *arg, bool after) {
+    CANBus *c = (CANBus *)arg;
+    if (!after) {
+        pio_sm_set_enabled(c->_rxPIO, c->_rxSM, false);
+        pio_sm_set_enabled(c->_txPIO, c->_txSM, false);
+        // Don't leave the bus held dominant
+        pio_sm_exec(c->_txPIO, c->_txSM, pio_encode_set(pio_pins, 1));
+        return;
+    }
+    c->_setClock();
+    noInterrupts();
+    // Anything caught halfway was sampled at the old rate, so resync from scratch
+    c->_rxRestart();
+    pio_sm_set_enabled(c->_rxPIO, c->_rxSM, true);
+    // A frame cut off mid-send goes again, otherwise can_tx is idle or waiting for the bus
+    if (c->_txBusy) {
+        c->_txSend();
+    } else {
+        pio_sm_set_enabled(c->_txPIO, c->_txSM, true);
+    }
+    interrupts();
+}
+
+void CANBus::_rxRestart() {
+    pio_sm_restart(_rxPIO, _rxSM);
+    pio_sm_clkdiv_restart(_rxPIO, _rxSM);
+    pio_sm_exec(_rxPIO, _rxSM, pio_encode_jmp(_rxOffset + can_rx_offset_start));
+    _rxState = RX_WAIT;
+    _rxRun = 0;
+}
+
+void __not_in_flash_func(CANBus::_rxIRQ)(int channel, void *param) {
+    CANBus *c = (CANBus *)param;
+    int half = (channel == c->_rxDMA[0].channel()) ? 0 : 1;
+    int end = (half + 1) * _half;
+    if (c->_rxPos / _half == half) {
+        c->_decode(c->_rxRing + c->_rxPos, end - c->_rxPos);
+    } else {
+        // The IRQ was held off so long the other half was overwritten, start again
+        c->_rxState = RX_WAIT;
+        c->_rxRun = 0;
+    }
+    c->_rxPos = end % CANBUS_RX_RING;
+}
+
+// Catches up with the half being filled now, so frames don't wait on the IRQ.  A half
+// which just finished is left to its IRQ, which will run once interrupts are back on
+void CANBus::_poll() {
+    if (!_running) {
+        return;
+    }
+    noInterrupts();
+    int half = _rxDMA[0].busy() ? 0 : _rxDMA[1].busy() ? 1 : -1;
+    if ((half >= 0) && (_rxPos / _half == half)) {
+        int live = (dma_channel_hw_addr(_rxDMA[half].channel())->write_addr - (uint32_t)_rxRing) / 4;
+        if (live > _rxPos) {
+            _decode(_rxRing + _rxPos, live - _rxPos);
+            _rxPos = live;
+        }
+    }
+    interrupts();
+}
+
+// Samples come 32 to a word, earliest in the MSB.  Bits are destuffed, run through the
+// CRC, and sorted into fields by their position in the frame, counting SOF as bit 0:
+//   Standard  ID 1-11, RTR 12, IDE 13, r0 14, DLC 15-18, data from 19
+//   Extended  ID 1-11, SRR 12, IDE 13, ID 14-31, RTR 32, r1 33, r0 34, DLC 35-38, data from 39
+// then the 15 bit CRC and its delimiter.  Stuffing covers everything before the delimiter.
+void __not_in_flash_func(CANBus::_decode)(const uint32_t *words, size_t count) {
+    while (count--) {
+        uint32_t w = *words++;
+        // An idle bus is all recessive, skip it a word at a time
+        if ((w == 0xffffffff) && (_rxState != RX_FRAME)) {
+            _rxState = RX_IDLE;
+            continue;
+        }
+        for (int i = 31; i >= 0; i--) {
+            int b = (w >> i) & 1;
+            int n;
+            if (_rxState == RX_WAIT) {
+                // Bus integration, 11 recessive bits before any SOF counts
+                _rxRun = b ? _rxRun + 1 : 0;
+                if (_rxRun >= 11) {
+                    _rxState = RX_IDLE;
+                }
+                continue;
+            } else if (_rxState == RX_IDLE) {
+                if (!b) {
+                    _rxState = RX_FRAME;
+                    _rxRun = 1;
+                    _rxLast = 0;
+                    _rxBit = 1;
+                    _rxCRC = 0;
+                    _rxDLC = 0;
+                    _rxDLCStart = _rxDataStart = _rxCRCStart = _rxCRCEnd = 0xffff;
+                    _rxF.id = 0;
+                    _rxF.extended = false;
+                    _rxF.rtr = false;
+                    _rxF.len = 0;
+                    memset(_rxF.data, 0, sizeof(_rxF.data));
+                }
+                continue;
+            }
+            if (_rxBit <= _rxCRCEnd) {
+                if (_rxRun == 5) {
+                    // A stuff bit, which must differ and is otherwise ignored
+                    if (b == _rxLast) {
+                        goto error;
+                    }
+                    _rxLast = b;
+                    _rxRun = 1;
+                    continue;
+                }
+                if (b == _rxLast) {
+                    _rxRun++;
+                } else {
+                    _rxLast = b;
+                    _rxRun = 1;
+                }
+            }
+            if (_rxBit == _rxCRCEnd) {
+                // CRC delimiter, the frame's good if it's recessive and the CRC checks out
+                if (!b || _rxCRC) {
+                    goto error;
+                }
+                _rxFrame();
+                _rxState = RX_WAIT;
+                _rxRun = 1;
+                continue;
+            }
+            if (b ^ (_rxCRC >> 14)) {
+                _rxCRC = ((_rxCRC << 1) ^ 0x4599) & 0x7fff;
+            } else {
+                _rxCRC = (_rxCRC << 1) & 0x7fff;
+            }
+            n = _rxBit++;
+            if (n <= 11) {
+                _rxF.id = (_rxF.id << 1) | b;
+            } else if (n == 12) {
+                // RTR, or SRR for an extended frame whose RTR comes later
+                _rxF.rtr = b;
+            } else if (n == 13) {
+                _rxF.extended = b;
+                _rxDLCStart = b ? 35 : 15;
+            } else if (n < _rxDLCStart) {
+                // Rest of an extended ID and its RTR, the reserved bits are ignored
+                if (_rxF.extended && (n <= 31)) {
+                    _rxF.id = (_rxF.id << 1) | b;
+                } else if (_rxF.extended && (n == 32)) {
+                    _rxF.rtr = b;
+                }
+            } else if (n < _rxDLCStart + 4) {
+                _rxDLC = (_rxDLC << 1) | b;
+                if (n == _rxDLCStart + 3) {
+                    _rxF.len = _rxDLC > 8 ? 8 : _rxDLC;
+                    _rxDataStart = n + 1;
+                    _rxCRCStart = _rxDataStart + (_rxF.rtr ? 0 : _rxF.len * 8);
+                    _rxCRCEnd = _rxCRCStart + 15;
+                }
+            } else if (n < _rxCRCStart) {
+                int d = (n - _rxDataStart) >> 3;
+                _rxF.data[d] = (_rxF.data[d] << 1) | b;
+            }
+            continue;
+error:
+            // Stuff and form errors, error frames (6 dominant bits), and collisions
+            _rxErrors++;
+            _rxState = RX_WAIT;
+            _rxRun = b;
+        }
+    }
+}
+
+void __not_in_flash_func(CANBus::_rxFrame)() {
+    if (_echoMatch(_rxF) || !_accept(_rxF)) {
+        return;
+    }
+    if (!_rxQueue.store_char(_rxF)) {
+        _rxOverruns++;
+    }
+}
+
+bool __not_in_flash_func(CANBus::_accept)(const CANFrame &f) {
+    bool any = false;
+    for (int i = 0; i < CANBUS_FILTERS; i++) {
+        if (_filter[i].used) {
+            if ((_filter[i].extended == f.extended) && !((f.id ^ _filter[i].id) & _filter[i].mask)) {
+                return true;
+            }
+            any = true;
+        }
+    }
+    return !any;
+}
+
+static bool _sameFrame(const CANFrame &a, const CANFrame &b) {
+    return (a.id == b.id) && (a.extended == b.extended) && (a.rtr == b.rtr) && (a.len == b.len) &&
+           (a.rtr || !memcmp(a.data, b.data, a.len));
+}
+
+void CANBus::_echoPush(const CANFrame &f) {
+    if (_echoHead - _echoTail == _echoSize) {
+        _echoTail++;
+    }
+    _echo[_echoHead++ % _echoSize] = f;
+}
+
+// Own frames come back in the order they went out, but any which never made it onto the
+// bus intact are skipped over, and eventually pushed out of the list
+bool __not_in_flash_func(CANBus::_echoMatch)(const CANFrame &f) {
+    for (uint32_t i = _echoTail; i != _echoHead; i++) {
+        if (_sameFrame(_echo[i % _echoSize], f)) {
+            _echoTail = i + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+int CANBus::available() {
+    _poll();
+    return _rxQueue.available();
+}
+
+bool CANBus::read(CANFrame &frame) {
+    _poll();
+    return _rxQueue.read(&frame, 1) == 1;
+}
+
+bool CANBus::setFilter(int n, uint32_t id, uint32_t mask, bool extended) {
+    if ((n < 0) || (n >= CANBUS_FILTERS)) {
+        return false;
+    }
+    noInterrupts();
+    _filter[n].id = id;
+    _filter[n].mask = mask;
+    _filter[n].extended = extended;
+    _filter[n].used = true;
+    interrupts();
+    return true;
+}
+
+void CANBus::clearFilters() {
+    noInterrupts();
+    for (int i = 0; i < CANBUS_FILTERS; i++) {
+        _filter[i].used = false;
+    }
+    interrupts();
+}
+
+// Bits go into _txBuf after the header word MSB first, with a stuff bit after every 5 equal
+// ones up to the end of the CRC.  Returns the number of words to send
+int CANBus::_encode(const CANFrame &f) {
+    uint32_t *buf = _txBuf + 1;
+    int bits = 0;
+    int run = 0;
+    int last = -1;
+    uint16_t crc = 0;
+    memset(buf, 0, sizeof(_txBuf) - sizeof(_txBuf[0]));
+    auto raw = [&](int b) {
+        if (b) {
+            buf[bits >> 5] |= 0x80000000 >> (bits & 31);
+        }
+        bits++;
+    };
+    auto stuffed = [&](int b) {
+        raw(b);
+        run = (b == last) ? run + 1 : 1;
+        last = b;
+        if (run == 5) {
+            raw(!b);
+            last = !b;
+            run = 1;
+        }
+    };
+    auto field = [&](uint32_t v, int len) {
+        while (len--) {
+            int b = (v >> len) & 1;
+            if (b ^ (crc >> 14)) {
+                crc = ((crc << 1) ^ 0x4599) & 0x7fff;
+            } else {
+                crc = (crc << 1) & 0x7fff;
+            }
+            stuffed(b);
+        }
+    };
+    field(0, 1); // SOF
+    if (f.extended) {
+        field(f.id >> 18, 11);
+        field(3, 2); // SRR and IDE recessive
+        field(f.id & 0x3ffff, 18);
+        field(f.rtr, 1);
+        _txArb = bits;
+        field(0, 2); // r1, r0
+    } else {
+        field(f.id, 11);
+        field(f.rtr, 1);
+        field(0, 1); // IDE
+        _txArb = bits;
+        field(0, 1); // r0
+    }
+    field(f.len, 4);
+    if (!f.rtr) {
+        for (int i = 0; i < f.len; i++) {
+            field(f.data[i], 8);
+        }
+    }
+    uint16_t c = crc;
+    for (int i = 14; i >= 0; i--) {
+        stuffed((c >> i) & 1);
+    }
+    raw(1); // CRC delimiter
+    raw(1); // ACK slot, someone else will pull it dominant
+    _txBits = bits;
+    _txBuf[0] = (CAN_IDLE_POLLS << 16) | (bits - 1);
+    return 1 + (bits + 31) / 32;
+}
+
+// Only called with interrupts off or from the DMA IRQ
+void CANBus::_txSend() {
+    size_t n;
+    const CANFrame *f = _txQueue.readSpan(&n);
+    if (!n) {
+        _txBusy = false;
+        return;
+    }
+    _txBusy = true;
+    int words = _encode(*f);
+    _echoPush(*f);
+    _txDMA.abort();
+    _resultDMA.abort();
+    pio_sm_set_enabled(_txPIO, _txSM, false);
+    pio_sm_clear_fifos(_txPIO, _txSM);
+    pio_sm_restart(_txPIO, _txSM);
+    pio_sm_clkdiv_restart(_txPIO, _txSM);
+    pio_sm_exec(_txPIO, _txSM, pio_encode_jmp(_txOffset + can_tx_offset_start));
+    _resultDMA.start(&_txResult, &_txPIO->rxf[_txSM], 1);
+    _txDMA.start(&_txPIO->txf[_txSM], _txBuf, words);
+    pio_sm_set_enabled(_txPIO, _txSM, true);
+}
+
+void __not_in_flash_func(CANBus::_txIRQ)(int channel, void *param) {
+    (void) channel;
+    ((CANBus *)param)->_txDone();
+}
+
+void CANBus::_txDone() {
+    uint32_t after = _txResult >> 2;
+    bool lostRecessive = _txResult & 1;
+    if (after == 0x3fffffff) {
+        // No ACK.  The frame still went out whole, so its echo stays
+        _txErrors++;
+    } else {
+        int bit = _txBits - 1 - after;
+        if (bit == _txBits - 1) {
+            // ACKed
+            _txQueue.consume(1);
+            _txTries = 0;
+            _txSend();
+            return;
+        }
+        // This attempt will never be decoded, forget it
+        _echoHead--;
+        if (lostRecessive && (bit < _txArb)) {
+            // Lost arbitration, try again once the winner's done
+            _txSend();
+            return;
+        }
+        _txErrors++;
+    }
+    if (++_txTries > CANBUS_TX_RETRIES) {
+        _txQueue.consume(1);
+        _txTries = 0;
+    }
+    _txSend();
+}
+
+bool CANBus::write(const CANFrame &frame) {
+    if (!_running || (frame.len > 8) || (frame.id > (frame.extended ? 0x1fffffffu : 0x7ffu))) {
+        return false;
+    }
+    if (!_txQueue.store_char(frame)) {
+        return false;
+    }
+    noInterrupts();
+    if (!_txBusy) {
+        _txSend();
+    }
+    interrupts();
+    return true;
+}
+
+int CANBus::availableForWrite() {
+    return _running ? _txQueue.availableForStore() : 0;
+}
+
+void CANBus::flush() {
+    while (_running && _txBusy) {
+        /* noop busy wait */
+    }
+}
@@ -0,0 +1,164 @@
+/*
+    CANBus.h - CAN 2.0B controller using PIO for bit timing and DMA for reception
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+
+// Received frames waiting for read(), and frames waiting to be sent.  Powers of 2
+#ifndef CANBUS_RX_FRAMES
+#define CANBUS_RX_FRAMES 16
+#endif
+#ifndef CANBUS_TX_FRAMES
+#define CANBUS_TX_FRAMES 8
+#endif
+
+// Words of raw bus samples, split in two halves which are decoded as each one fills.  At
+// 1Mbit/s the default is decoded every 512us
+#ifndef CANBUS_RX_RING
+#define CANBUS_RX_RING 32
+#endif
+
+// Errors or missing ACKs before a frame is given up on.  Lost arbitrations don't count
+#ifndef CANBUS_TX_RETRIES
+#define CANBUS_TX_RETRIES 16
+#endif
+
+#define CANBUS_FILTERS 4
+
+typedef struct {
+    uint32_t id;        // 11 bits, or 29 if extended
+    bool extended;
+    bool rtr;           // Remote request, len is the length asked for and no data is sent
+    uint8_t len;        // 0...8
+    uint8_t data[8];
+} CANFrame;
+
+// A CAN controller needing only a 3.3V transceiver (e.g. SN65HVD230) on two GPIOs.  One
+// state machine samples the bus into a DMA ring, which the CPU destuffs, CRC checks, and
+// filters a half at a time from the DMA interrupt.  A second one sends frames the CPU has
+// stuffed, checking every bit it sends to handle arbitration, and reads back the ACK.
+//
+// Frames from other nodes are not ACKed, since they're only decoded well after the ACK
+// slot has passed, so at least one other node on the bus must be a full controller.
+// Error frames are not sent either.  Frames sent by this node are not received.
+class CANBus {
+public:
+    CANBus(pin_size_t tx, pin_size_t rx);
+    ~CANBus();
+
+    // Bit rates from 10kbit/s to 1Mbit/s
+    bool begin(uint32_t bitrate = 500000);
+    void end();
+
+    // Received frames which passed the filters
+    int available();
+    bool read(CANFrame &frame);
+
+    // Queues a frame to be sent, returning false if the queue is full or it's malformed
+    bool write(const CANFrame &frame);
+    int availableForWrite();
+    // Waits until every queued frame has been ACKed or given up on
+    void flush();
+
+    // Hardware style acceptance filters.  With none set every frame is received, otherwise
+    // only those with (id & mask) == (filter id & mask) for a filter of the same ID type
+    bool setFilter(int n, uint32_t id, uint32_t mask, bool extended = false);
+    void clearFilters();
+
+    // Frames received with stuff, CRC, or form errors
+    uint32_t rxErrors() {
+        return _rxErrors;
+    }
+    // Good frames lost because the receive queue was full
+    uint32_t rxOverruns() {
+        return _rxOverruns;
+    }
+    // Sent frames which hit bit errors or went unACKed
+    uint32_t txErrors() {
+        return _txErrors;
+    }
+
+private:
+    static void _rxIRQ(int channel, void *param);
+    static void _txIRQ(int channel, void *param);
+    static void _clockChanged(void *arg, bool after);
+    void _setClock();
+    void _rxRestart();
+    void _poll();
+    void _decode(const uint32_t *words, size_t count);
+    void _rxFrame();
+    bool _accept(const CANFrame &f);
+    void _txSend();
+    void _txDone();
+    int _encode(const CANFrame &f);
+    void _echoPush(const CANFrame &f);
+    bool _echoMatch(const CANFrame &f);
+
+    pin_size_t _tx, _rx;
+    uint32_t _bitrate;
+    bool _running;
+    PIO _rxPIO, _txPIO;
+    int _rxSM, _txSM;
+    int _rxOffset, _txOffset;
+    DMAChannel _rxDMA[2];
+    DMAChannel _txDMA;
+    DMAChannel _resultDMA;
+    ClockNotifier _clockNotifier{_clockChanged, this};
+
+    // Receive side, only touched from the DMA IRQ or with interrupts off
+    static constexpr int _half = CANBUS_RX_RING / 2;
+    uint32_t *_rxRing;
+    int _rxPos;             // Next word to decode
+    uint8_t _rxState;
+    uint8_t _rxRun;         // Equal bits in a row, or recessive ones while waiting for idle
+    uint8_t _rxLast;
+    uint8_t _rxDLC;
+    uint16_t _rxBit;        // Destuffed bits so far, including SOF
+    uint16_t _rxCRC;
+    uint16_t _rxDLCStart, _rxDataStart, _rxCRCStart, _rxCRCEnd;
+    CANFrame _rxF;
+    RingBufferSPSC<CANFrame, CANBUS_RX_FRAMES> _rxQueue;
+
+    // Own frames as sent, to drop them when they're decoded
+    static constexpr uint32_t _echoSize = 8;
+    CANFrame _echo[_echoSize];
+    uint32_t _echoHead, _echoTail;
+
+    typedef struct {
+        uint32_t id;
+        uint32_t mask;
+        bool extended;
+        bool used;
+    } Filter;
+    Filter _filter[CANBUS_FILTERS];
+
+    // Transmit side
+    RingBufferSPSC<CANFrame, CANBUS_TX_FRAMES> _txQueue;
+    volatile bool _txBusy;
+    uint32_t _txBuf[8];     // Poll count and bit count, then the stuffed frame
+    int _txBits;
+    int _txArb;             // Stuffed bits through the end of arbitration
+    int _txTries;
+    volatile uint32_t _txResult;
+
+    volatile uint32_t _rxErrors, _rxOverruns, _txErrors;
+};
@@ -0,0 +1,124 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// ------ //
+// can_rx //
+// ------ //
+
+#define can_rx_wrap_target 0
+#define can_rx_wrap 10
+
+#define can_rx_offset_start 5u
+
+static const uint16_t can_rx_program_instructions[] = {
+    //     .wrap_target
+    0xa842, //  0: nop                    [8]
+    0x4001, //  1: in     pins, 1
+    0x00c5, //  2: jmp    pin, 5
+    0x0d01, //  3: jmp    1               [13]
+    0x4141, //  4: in     y, 1            [1]
+    0xe025, //  5: set    x, 5
+    0x00c8, //  6: jmp    pin, 8
+    0x0000, //  7: jmp    0
+    0x0046, //  8: jmp    x--, 6
+    0x00c4, //  9: jmp    pin, 4
+    0x0000, // 10: jmp    0
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program can_rx_program = {
+    .instructions = can_rx_program_instructions,
+    .length = 11,
+    .origin = -1,
+};
+
+static inline pio_sm_config can_rx_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + can_rx_wrap_target, offset + can_rx_wrap);
+    return c;
+}
+#endif
+
+// ------ //
+// can_tx //
+// ------ //
+
+#define can_tx_wrap_target 0
+#define can_tx_wrap 19
+
+#define can_tx_offset_start 0u
+
+static const uint16_t can_tx_program_instructions[] = {
+    //     .wrap_target
+    0x80a0, //  0: pull   block
+    0x60d0, //  1: out    isr, 16
+    0x6050, //  2: out    y, 16
+    0xa026, //  3: mov    x, isr
+    0x00c6, //  4: jmp    pin, 6
+    0x0003, //  5: jmp    3
+    0x0044, //  6: jmp    x--, 4
+    0x80e0, //  7: pull   ifempty block
+    0x6021, //  8: out    x, 1
+    0xaa01, //  9: mov    pins, x         [10]
+    0x00cd, // 10: jmp    pin, 13
+    0x002e, // 11: jmp    !x, 14
+    0x000f, // 12: jmp    15
+    0x002f, // 13: jmp    !x, 15
+    0x0087, // 14: jmp    y--, 7
+    0xe001, // 15: set    pins, 1
+    0x405e, // 16: in     y, 30
+    0x4022, // 17: in     x, 2
+    0x8020, // 18: push   block
+    0x0013, // 19: jmp    19
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program can_tx_program = {
+    .instructions = can_tx_program_instructions,
+    .length = 20,
+    .origin = -1,
+};
+
+static inline pio_sm_config can_tx_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + can_tx_wrap_target, offset + can_tx_wrap);
+    return c;
+}
+
+static inline void can_rx_program_init(PIO pio, uint sm, uint offset, uint rx, float div) {
+    pio_sm_set_consecutive_pindirs(pio, sm, rx, 1, false);
+    pio_sm_config c = can_rx_program_get_default_config(offset);
+    sm_config_set_in_pins(&c, rx);
+    sm_config_set_jmp_pin(&c, rx);
+    sm_config_set_in_shift(&c, false, true, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    sm_config_set_clkdiv(&c, div);
+    pio_sm_init(pio, sm, offset + can_rx_offset_start, &c);
+    pio_sm_exec(pio, sm, pio_encode_set(pio_y, 1));
+}
+
+static inline void can_tx_program_init(PIO pio, uint sm, uint offset, uint tx, uint rx, float div) {
+    pio_sm_set_pins_with_mask(pio, sm, 1u << tx, 1u << tx);
+    pio_sm_set_consecutive_pindirs(pio, sm, tx, 1, true);
+    pio_gpio_init(pio, tx);
+    pio_sm_config c = can_tx_program_get_default_config(offset);
+    sm_config_set_out_pins(&c, tx, 1);
+    sm_config_set_set_pins(&c, tx, 1);
+    sm_config_set_in_pins(&c, rx);
+    sm_config_set_jmp_pin(&c, rx);
+    sm_config_set_out_shift(&c, false, false, 32);
+    sm_config_set_in_shift(&c, false, false, 32);
+    sm_config_set_clkdiv(&c, div);
+    pio_sm_init(pio, sm, offset + can_tx_offset_start, &c);
+}
+
+#endif
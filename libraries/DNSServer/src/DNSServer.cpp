@@ -64,6 +64,8 @@
 #endif
 
 #define DNS_HEADER_SIZE sizeof(DNSHeader)
+// Each buffer holds the largest legal query plus the answer appended to it
+#define DNS_SLOT_SIZE (MAX_DNS_PACKETSIZE + DNS_ANSWER_SIZE)
 
 // Want to keep IDs unique across restarts and continquious
 static uint32_t _ids __attribute__((section(".noinit")));
@@ -142,7 +144,19 @@ bool DNSServer::start(const uint16_t &port, const String &domainName,
         return false;
     }
 
-    return _udp.begin(_port) == 1;
+    if (!_pkt) {
+        _pkt = std::unique_ptr<uint8_t[]> (new (std::nothrow) uint8_t[DNS_BATCH_SIZE * DNS_SLOT_SIZE]);
+        if (!_pkt) {
+            return false;
+        }
+    }
+
+    if (_udp.begin(_port) != 1) {
+        return false;
+    }
+    // Let a whole batch of clients (re)connecting at once queue up between calls
+    _udp.setRxBufferDepth(DNS_BATCH_SIZE * DNS_MAX_BATCHES);
+    return true;
 }
 
 void DNSServer::setErrorReplyCode(const DNSReplyCode &replyCode) {
@@ -160,6 +174,7 @@ uint32_t DNSServer::getTTL() {
 void DNSServer::stop() {
     _udp.stop();
     disableForwarder("", true);
+    _pkt = nullptr;
 }
 
 void DNSServer::downcaseAndRemoveWwwPrefix(String &domainName) {
@@ -169,38 +184,38 @@ void DNSServer::downcaseAndRemoveWwwPrefix(String &domainName) {
     }
 }
 
-void DNSServer::forwardReply(uint8_t *buffer, size_t length) {
+bool DNSServer::forwardReply(WiFiUDP::Packet &pkt) {
     if (!_forwarder || !_que) {
-        return;
+        return false;
     }
-    DNSHeader *dnsHeader = (DNSHeader *)buffer;
+    DNSHeader *dnsHeader = (DNSHeader *)pkt.data;
     uint16_t id = dnsHeader->ID;
     // if (kDNSSQueSize <= (uint16_t)((uint16_t)_ids - id)) {
     if ((uint16_t)kDNSSQueSize <= (uint16_t)_ids - id) {
         DEBUG_((++_que_drop));
         DEBUG_PRINTLN2("Forward reply ID: 0x", (String(id, HEX) + F(" dropped!")));
-        return;
+        return false;
     }
     size_t i = id & (kDNSSQueSize - 1);
 
     // Drop duplicate packets
     if (0 == _que[i].ip) {
         DEBUG_PRINTLN2("Duplicate reply dropped ID: 0x", String(id, HEX));
-        return;
+        return false;
     }
     dnsHeader->ID = _que[i].id;
-    _udp.beginPacket(_que[i].ip, _que[i].port);
-    _udp.write(buffer, length);
-    _udp.endPacket();
-    DEBUG_PRINTLN2("Forward reply ID: 0x", (String(id, HEX) + F(" to ") + IPAddress(_que[i].ip).toString()));
+    pkt.ip = _que[i].ip;
+    pkt.port = _que[i].port;
+    DEBUG_PRINTLN2("Forward reply ID: 0x", (String(id, HEX) + F(" to ") + IPAddressString(IPAddress(_que[i].ip)).c_str()));
     _que[i].ip = 0; // This gets used to detect duplicate packets and overflow
+    return true;
 }
 
-void DNSServer::forwardRequest(uint8_t *buffer, size_t length) {
+bool DNSServer::forwardRequest(WiFiUDP::Packet &pkt) {
     if (!_forwarder || !_dns.isSet() || !_que) {
-        return;
+        return false;
     }
-    DNSHeader *dnsHeader = (DNSHeader *)buffer;
+    DNSHeader *dnsHeader = (DNSHeader *)pkt.data;
     ++_ids;
     size_t i = _ids & (kDNSSQueSize - 1);
     DEBUG_(({
@@ -208,17 +223,17 @@ void DNSServer::forwardRequest(uint8_t *buffer, size_t length) {
             ++_que_ov;
         }
     }));
-    _que[i].ip = _udp.remoteIP();
-    _que[i].port = _udp.remotePort();
+    _que[i].ip = pkt.ip;
+    _que[i].port = pkt.port;
     _que[i].id = dnsHeader->ID;
     dnsHeader->ID = (uint16_t)_ids;
-    _udp.beginPacket(_dns, IANA_DNS_PORT);
-    _udp.write(buffer, length);
-    _udp.endPacket();
-    DEBUG_PRINTLN2("Forward request ID: 0x", (String(dnsHeader->ID, HEX) + F(" to ") + _dns.toString()));
+    pkt.ip = _dns;
+    pkt.port = IANA_DNS_PORT;
+    DEBUG_PRINTLN2("Forward request ID: 0x", (String(dnsHeader->ID, HEX) + F(" to ") + IPAddressString(_dns).c_str()));
+    return true;
 }
 
-bool DNSServer::respondToRequest(uint8_t *buffer, size_t length) {
+size_t DNSServer::respondToRequest(uint8_t *buffer, size_t length, bool &forward) {
     DNSHeader *dnsHeader;
     uint8_t *query, *start;
     const char *matchString;
@@ -226,31 +241,29 @@ bool DNSServer::respondToRequest(uint8_t *buffer, size_t length) {
     uint16_t qtype, qclass;
 
     dnsHeader = (DNSHeader *)buffer;
+    forward = false;
 
     // Must be a query for us to do anything with it
     if (dnsHeader->QR != DNS_QR_QUERY) {
-        return false;
+        return 0;
     }
 
     // If operation is anything other than query, we don't do it
     if (dnsHeader->OPCode != DNS_OPCODE_QUERY) {
-        replyWithError(dnsHeader, DNSReplyCode::NotImplemented);
-        return false;
+        return replyWithError(dnsHeader, DNSReplyCode::NotImplemented);
     }
 
     // Only support requests containing single queries - everything else
     // is badly defined
     if (dnsHeader->QDCount != lwip_htons(1)) {
-        replyWithError(dnsHeader, DNSReplyCode::FormError);
-        return false;
+        return replyWithError(dnsHeader, DNSReplyCode::FormError);
     }
 
     // We must return a FormError in the case of a non-zero ARCount to
     // be minimally compatible with EDNS resolvers
     if (dnsHeader->ANCount != 0 || dnsHeader->NSCount != 0
             || dnsHeader->ARCount != 0) {
-        replyWithError(dnsHeader, DNSReplyCode::FormError);
-        return false;
+        return replyWithError(dnsHeader, DNSReplyCode::FormError);
     }
 
     // Even if we're not going to use the query, we need to parse it
@@ -261,8 +274,7 @@ bool DNSServer::respondToRequest(uint8_t *buffer, size_t length) {
     while (remaining != 0 && *start != 0) {
         labelLength = *start;
         if (labelLength + 1 > remaining) {
-            replyWithError(dnsHeader, DNSReplyCode::FormError);
-            return false;
+            return replyWithError(dnsHeader, DNSReplyCode::FormError);
         }
         remaining -= (labelLength + 1);
         start += (labelLength + 1);
@@ -270,8 +282,7 @@ bool DNSServer::respondToRequest(uint8_t *buffer, size_t length) {
 
     // 1 octet labelLength, 2 octet qtype, 2 octet qclass
     if (remaining < 5)  {
-        replyWithError(dnsHeader, DNSReplyCode::FormError);
-        return false;
+        return replyWithError(dnsHeader, DNSReplyCode::FormError);
     }
 
     start += 1; // Skip the 0 length label that we found above
@@ -285,35 +296,32 @@ bool DNSServer::respondToRequest(uint8_t *buffer, size_t length) {
 
     if (qclass != lwip_htons(DNS_QCLASS_ANY)
             && qclass != lwip_htons(DNS_QCLASS_IN)) {
-        replyWithError(dnsHeader, DNSReplyCode::NonExistentDomain, query, queryLength);
-        return false;
+        return replyWithError(dnsHeader, DNSReplyCode::NonExistentDomain, query, queryLength);
     }
 
     if (qtype != lwip_htons(DNS_QTYPE_A)
             && qtype != lwip_htons(DNS_QTYPE_ANY)) {
-        replyWithError(dnsHeader, DNSReplyCode::NonExistentDomain, query, queryLength);
-        return false;
+        return replyWithError(dnsHeader, DNSReplyCode::NonExistentDomain, query, queryLength);
     }
 
+    matchString = _domainName.c_str();
+
     // If we have no domain name configured, just return an error
-    if (_domainName == "") {
+    if (!*matchString) {
         if (_forwarder) {
-            return true;
+            forward = true;
+            return 0;
         } else {
-            replyWithError(dnsHeader, _errorReplyCode, query, queryLength);
-            return false;
+            return replyWithError(dnsHeader, _errorReplyCode, query, queryLength);
         }
     }
 
     // If we're running with a wildcard we can just return a result now
-    if (_domainName == "*") {
+    if (!strcmp(matchString, "*")) {
         DEBUG_PRINTF("dnsServer - replyWithIP\r\n");
-        replyWithIP(dnsHeader, query, queryLength);
-        return false;
+        return replyWithIP(dnsHeader, query, queryLength);
     }
 
-    matchString = _domainName.c_str();
-
     start = query;
 
     // If there's a leading 'www', skip it
@@ -327,10 +335,10 @@ bool DNSServer::respondToRequest(uint8_t *buffer, size_t length) {
         while (labelLength > 0) {
             if (tolower(*start) != *matchString) {
                 if (_forwarder) {
-                    return true;
+                    forward = true;
+                    return 0;
                 } else {
-                    replyWithError(dnsHeader, _errorReplyCode, query, queryLength);
-                    return false;
+                    return replyWithError(dnsHeader, _errorReplyCode, query, queryLength);
                 }
             }
             ++start;
@@ -338,119 +346,120 @@ bool DNSServer::respondToRequest(uint8_t *buffer, size_t length) {
             --labelLength;
         }
         if (*start == 0 && *matchString == '\0') {
-            replyWithIP(dnsHeader, query, queryLength);
-            return false;
+            return replyWithIP(dnsHeader, query, queryLength);
         }
 
         if (*matchString != '.') {
-            replyWithError(dnsHeader, _errorReplyCode, query, queryLength);
-            return false;
+            return replyWithError(dnsHeader, _errorReplyCode, query, queryLength);
         }
         ++matchString;
     }
 
-    replyWithError(dnsHeader, _errorReplyCode, query, queryLength);
-    return false;
+    return replyWithError(dnsHeader, _errorReplyCode, query, queryLength);
 }
 
 void DNSServer::processNextRequest() {
-    size_t currentPacketSize;
-
-    currentPacketSize = _udp.parsePacket();
-    if (currentPacketSize == 0) {
-        return;
-    }
-
-    // The DNS RFC requires that DNS packets be less than 512 bytes in size,
-    // so just discard them if they are larger
-    if (currentPacketSize > MAX_DNS_PACKETSIZE) {
-        return;
-    }
-
-    // If the packet size is smaller than the DNS header, then someone is
-    // messing with us
-    if (currentPacketSize < DNS_HEADER_SIZE) {
-        return;
-    }
-
-    std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[currentPacketSize]);
-    if (buffer == nullptr) {
+    if (!_pkt) {
         return;
     }
 
-    _udp.read(buffer.get(), currentPacketSize);
-    if (_dns.isSet() && _udp.remoteIP() == _dns) {
-        // _forwarder may have been set to false; however, for now allow in-flight
-        // replies to finish. //??
-        forwardReply(buffer.get(), currentPacketSize);
-    } else if (respondToRequest(buffer.get(), currentPacketSize)) {
-        forwardRequest(buffer.get(), currentPacketSize);
+    WiFiUDP::Packet in[DNS_BATCH_SIZE], out[DNS_BATCH_SIZE];
+    for (int batch = 0; batch < DNS_MAX_BATCHES; batch++) {
+        for (size_t i = 0; i < DNS_BATCH_SIZE; i++) {
+            in[i].data = _pkt.get() + i * DNS_SLOT_SIZE;
+            // One byte over the limit shows which packets were truncated
+            in[i].len = MAX_DNS_PACKETSIZE + 1;
+        }
+        size_t got = _udp.recvBatch(in, DNS_BATCH_SIZE);
+        size_t replies = 0;
+        for (size_t i = 0; i < got; i++) {
+            WiFiUDP::Packet &pkt = in[i];
+            // The DNS RFC requires that DNS packets be less than 512 bytes in size,
+            // so just discard them if they are larger.  If the packet size is smaller
+            // than the DNS header, then someone is messing with us
+            if ((pkt.len > MAX_DNS_PACKETSIZE) || (pkt.len < DNS_HEADER_SIZE)) {
+                continue;
+            }
+            bool forward = false;
+            if (_dns.isSet() && pkt.ip == _dns) {
+                // _forwarder may have been set to false; however, for now allow in-flight
+                // replies to finish. //??
+                forward = forwardReply(pkt);
+            } else {
+                size_t len = respondToRequest(pkt.data, pkt.len, forward);
+                if (forward) {
+                    forward = forwardRequest(pkt);
+                } else if (len) {
+                    pkt.len = len;
+                    forward = true;
+                }
+            }
+            if (forward) {
+                out[replies++] = pkt;
+            }
+        }
+        _udp.sendBatch(out, replies);
+        if (got < DNS_BATCH_SIZE) {
+            break;
+        }
     }
 }
 
-void DNSServer::writeNBOShort(uint16_t value) {
-    _udp.write((unsigned char *)&value, 2);
-}
-
-void DNSServer::replyWithIP(DNSHeader *dnsHeader,
-                            unsigned char * query,
-                            size_t queryLength) {
-    uint16_t value;
-
+size_t DNSServer::replyWithIP(DNSHeader *dnsHeader,
+                              unsigned char * query,
+                              size_t queryLength) {
     dnsHeader->QR = DNS_QR_RESPONSE;
     dnsHeader->QDCount = lwip_htons(1);
     dnsHeader->ANCount = lwip_htons(1);
     dnsHeader->NSCount = 0;
     dnsHeader->ARCount = 0;
 
-    _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
-    _udp.write((unsigned char *) dnsHeader, sizeof(DNSHeader));
-    _udp.write(query, queryLength);
+    // The answer goes straight after the question, overwriting anything else sent
+    uint8_t *ans = query + queryLength;
 
     // Rather than restate the name here, we use a pointer to the name contained
     // in the query section. Pointers have the top two bits set.
-    value = 0xC000 | DNS_HEADER_SIZE;
-    writeNBOShort(lwip_htons(value));
+    ans[0] = 0xC0;
+    ans[1] = DNS_HEADER_SIZE;
 
-    // Answer is type A (an IPv4 address)
-    writeNBOShort(lwip_htons(DNS_QTYPE_A));
-
-    // Answer is in the Internet Class
-    writeNBOShort(lwip_htons(DNS_QCLASS_IN));
+    // Answer is type A (an IPv4 address) in the Internet Class
+    ans[2] = 0;
+    ans[3] = DNS_QTYPE_A;
+    ans[4] = 0;
+    ans[5] = DNS_QCLASS_IN;
 
     // Output TTL (already NBO)
-    _udp.write((unsigned char*)&_ttl, 4);
+    memcpy(ans + 6, &_ttl, 4);
 
     // Length of RData is 4 bytes (because, in this case, RData is IPv4)
-    writeNBOShort(lwip_htons(sizeof(_resolvedIP)));
-    _udp.write(_resolvedIP, sizeof(_resolvedIP));
-    _udp.endPacket();
+    ans[10] = 0;
+    ans[11] = sizeof(_resolvedIP);
+    memcpy(ans + 12, _resolvedIP, sizeof(_resolvedIP));
+
+    return DNS_HEADER_SIZE + queryLength + DNS_ANSWER_SIZE;
 }
 
-void DNSServer::replyWithError(DNSHeader *dnsHeader,
-                               DNSReplyCode rcode,
-                               unsigned char *query,
-                               size_t queryLength) {
+size_t DNSServer::replyWithError(DNSHeader *dnsHeader,
+                                 DNSReplyCode rcode,
+                                 unsigned char *query,
+                                 size_t queryLength) {
     dnsHeader->QR = DNS_QR_RESPONSE;
     dnsHeader->RCode = (unsigned char) rcode;
     if (query) {
         dnsHeader->QDCount = lwip_htons(1);
     } else {
         dnsHeader->QDCount = 0;
+        queryLength = 0;
     }
     dnsHeader->ANCount = 0;
     dnsHeader->NSCount = 0;
     dnsHeader->ARCount = 0;
 
-    _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
-    _udp.write((unsigned char *)dnsHeader, sizeof(DNSHeader));
-    if (query != NULL) {
-        _udp.write(query, queryLength);
-    }
-    _udp.endPacket();
+    // The question is already in place after the header
+    return DNS_HEADER_SIZE + queryLength;
 }
 
-void DNSServer::replyWithError(DNSHeader *dnsHeader,
-                               DNSReplyCode rcode) {
-    replyWithError(dnsHeader, rcode, NULL, 0);
+size_t DNSServer::replyWithError(DNSHeader *dnsHeader,
+                                 DNSReplyCode rcode) {
+    return replyWithError(dnsHeader, rcode, NULL, 0);
 }
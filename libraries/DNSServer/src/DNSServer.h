@@ -45,6 +45,17 @@ constexpr inline uint16_t kIanaDnsPort = IANA_DNS_PORT;
 #define MAX_DNSNAME_LENGTH 253
 #define MAX_DNS_PACKETSIZE 512
 
+// Queries received (and replies sent) per lwIP lock in processNextRequest()
+#ifndef DNS_BATCH_SIZE
+#define DNS_BATCH_SIZE 8
+#endif
+// Most batches handled per processNextRequest() call, so a flood can't stall loop()
+#ifndef DNS_MAX_BATCHES
+#define DNS_MAX_BATCHES 4
+#endif
+// Room after a query for the A record appended to answer it
+#define DNS_ANSWER_SIZE 16
+
 enum class DNSReplyCode {
     NoError = 0,
     FormError = 1,
@@ -73,7 +84,7 @@ struct DNSHeader {
     uint16_t ARCount;          // number of resource entries
 };
 
-constexpr inline size_t kDNSSQueSizeAddrBits = 3; // The number of bits used to address que entries
+constexpr inline size_t kDNSSQueSizeAddrBits = 5; // The number of bits used to address que entries
 constexpr inline size_t kDNSSQueSize = (1UL << (kDNSSQueSizeAddrBits));
 
 struct DNSS_REQUESTER {
@@ -119,6 +130,8 @@ public:
         return _dns.isSet();
     }
 
+    // Answers every waiting query (up to DNS_BATCH_SIZE * DNS_MAX_BATCHES), building
+    // each reply in place in the buffer it was received into
     void processNextRequest();
     void setErrorReplyCode(const DNSReplyCode &replyCode);
     void setTTL(const uint32_t &ttl);
@@ -140,6 +153,7 @@ private:
     String _domainName;
     IPAddress _dns;
     std::unique_ptr<DNSS_REQUESTER[]> _que;
+    std::unique_ptr<uint8_t[]> _pkt; // DNS_BATCH_SIZE receive/reply buffers
     uint32_t _ttl;
 #ifdef DEBUG_DNSSERVER
     // There are 2 possibilities for overflow:
@@ -154,17 +168,19 @@ private:
     uint16_t _port;
 
     void downcaseAndRemoveWwwPrefix(String &domainName);
-    void replyWithIP(DNSHeader *dnsHeader,
-                     unsigned char * query,
-                     size_t queryLength);
-    void replyWithError(DNSHeader *dnsHeader,
-                        DNSReplyCode rcode,
-                        unsigned char *query,
-                        size_t queryLength);
-    void replyWithError(DNSHeader *dnsHeader,
-                        DNSReplyCode rcode);
-    bool respondToRequest(uint8_t *buffer, size_t length);
-    void forwardRequest(uint8_t *buffer, size_t length);
-    void forwardReply(uint8_t *buffer, size_t length);
-    void writeNBOShort(uint16_t value);
+    // The reply builders rewrite the query in place and return the reply length
+    size_t replyWithIP(DNSHeader *dnsHeader,
+                       unsigned char * query,
+                       size_t queryLength);
+    size_t replyWithError(DNSHeader *dnsHeader,
+                          DNSReplyCode rcode,
+                          unsigned char *query,
+                          size_t queryLength);
+    size_t replyWithError(DNSHeader *dnsHeader,
+                          DNSReplyCode rcode);
+    // Returns the reply length (0 for none), or sets forward if it should go upstream
+    size_t respondToRequest(uint8_t *buffer, size_t length, bool &forward);
+    // These readdress pkt for sending on, returning false if it should be dropped
+    bool forwardRequest(WiFiUDP::Packet &pkt);
+    bool forwardReply(WiFiUDP::Packet &pkt);
 };
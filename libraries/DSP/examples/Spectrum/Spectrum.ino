@@ -0,0 +1,45 @@
+/*
+  Samples A0 at 16K samples per second, runs a 512 point FFT on each block with
+  a Hann window, and prints the strongest frequency and its level.
+
+  Released to the public domain by Earle F. Philhower, III <earlephilhower@yahoo.com>
+*/
+
+#include <ADCInput.h>
+#include <DSP.h>
+
+#define RATE 16000
+#define POINTS 512
+
+ADCInput adc(A0);
+FFTQ15 fft;
+int16_t window[POINTS];
+int16_t data[POINTS + 2];
+uint16_t mag[POINTS / 2 + 1];
+
+void setup() {
+  Serial.begin(115200);
+  fft.begin(POINTS);
+  FFTQ15::hann(window, POINTS);
+  adc.setBuffers(4, POINTS);
+  adc.begin(RATE);
+}
+
+void loop() {
+  const uint32_t *buff = adc.getReadBuffer();
+  dspFromADC(buff, POINTS, 1, 0, data);
+  adc.releaseReadBuffer();
+
+  FFTQ15::applyWindow(data, window, POINTS);
+  fft.forwardReal(data, data);
+  FFTQ15::magnitude(data, mag, POINTS / 2 + 1);
+
+  // Skip DC, the ADC's offset lands there
+  int peak = 1;
+  for (int i = 2; i <= POINTS / 2; i++) {
+    if (mag[i] > mag[peak]) {
+      peak = i;
+    }
+  }
+  Serial.printf("Peak %d Hz, level %d\n", peak * RATE / POINTS, mag[peak]);
+}
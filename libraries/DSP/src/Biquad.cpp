@@ -0,0 +1,227 @@
+/*
+    Fixed-point biquad (second order IIR) filter cascades for the Cortex-M0+
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Biquad.h"
+#include <math.h>
+#include <stdlib.h>
+
+// The smallest power of 2 which brings every coefficient of a stage under 1.0
+static int _stageShift(const double *c, int maxShift) {
+    double m = 0;
+    for (int i = 0; i < 5; i++) {
+        m = fabs(c[i]) > m ? fabs(c[i]) : m;
+    }
+    int shift = 0;
+    while ((m >= 1.0) && (shift <= maxShift)) {
+        m *= 0.5;
+        shift++;
+    }
+    return shift;
+}
+
+BiquadQ15::BiquadQ15() : _stage(nullptr), _stages(0) {
+}
+
+BiquadQ15::~BiquadQ15() {
+    end();
+}
+
+bool BiquadQ15::begin(const double *coeffs, int stages) {
+    if (!coeffs || (stages < 1)) {
+        return false;
+    }
+    end();
+    _stage = (Stage *)calloc(stages, sizeof(Stage));
+    if (!_stage) {
+        return false;
+    }
+    for (int i = 0; i < stages; i++, coeffs += 5) {
+        int shift = _stageShift(coeffs, 14);
+        if (shift > 14) {
+            end();
+            return false;
+        }
+        double scale = 1.0 / (1 << shift);
+        _stage[i].b0 = dspFloatToQ15(coeffs[0] * scale);
+        _stage[i].b1 = dspFloatToQ15(coeffs[1] * scale);
+        _stage[i].b2 = dspFloatToQ15(coeffs[2] * scale);
+        _stage[i].a1 = dspFloatToQ15(-coeffs[3] * scale);
+        _stage[i].a2 = dspFloatToQ15(-coeffs[4] * scale);
+        _stage[i].shift = shift;
+    }
+    _stages = stages;
+    return true;
+}
+
+void BiquadQ15::end() {
+    free(_stage);
+    _stage = nullptr;
+    _stages = 0;
+}
+
+void BiquadQ15::reset() {
+    for (int i = 0; i < _stages; i++) {
+        _stage[i].x1 = _stage[i].x2 = _stage[i].y1 = _stage[i].y2 = 0;
+    }
+}
+
+// Direct form I, so the state is just past samples and every stage's input and output
+// are plain saturated Q15
+void BiquadQ15::process(const int16_t *in, int16_t *out, size_t cnt) {
+    for (int s = 0; s < _stages; s++) {
+        Stage *st = &_stage[s];
+        int rshift = 15 - st->shift;
+        int32_t x1 = st->x1, x2 = st->x2, y1 = st->y1, y2 = st->y2;
+        for (size_t i = 0; i < cnt; i++) {
+            int32_t x = in[i];
+            int64_t acc = (int32_t)st->b0 * x;
+            acc += (int32_t)st->b1 * x1;
+            acc += (int32_t)st->b2 * x2;
+            acc += (int32_t)st->a1 * y1;
+            acc += (int32_t)st->a2 * y2;
+            int16_t y = dspSat16(dspSat32((acc + (1 << (rshift - 1))) >> rshift));
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            out[i] = y;
+        }
+        st->x1 = x1;
+        st->x2 = x2;
+        st->y1 = y1;
+        st->y2 = y2;
+        in = out; // Later stages work on the previous one's output in place
+    }
+}
+
+BiquadQ31::BiquadQ31() : _stage(nullptr), _stages(0) {
+}
+
+BiquadQ31::~BiquadQ31() {
+    end();
+}
+
+bool BiquadQ31::begin(const double *coeffs, int stages) {
+    if (!coeffs || (stages < 1)) {
+        return false;
+    }
+    end();
+    _stage = (Stage *)calloc(stages, sizeof(Stage));
+    if (!_stage) {
+        return false;
+    }
+    for (int i = 0; i < stages; i++, coeffs += 5) {
+        int shift = _stageShift(coeffs, 30);
+        if (shift > 30) {
+            end();
+            return false;
+        }
+        double scale = 1.0 / (1 << shift);
+        _stage[i].b0 = dspDoubleToQ31(coeffs[0] * scale);
+        _stage[i].b1 = dspDoubleToQ31(coeffs[1] * scale);
+        _stage[i].b2 = dspDoubleToQ31(coeffs[2] * scale);
+        _stage[i].a1 = dspDoubleToQ31(-coeffs[3] * scale);
+        _stage[i].a2 = dspDoubleToQ31(-coeffs[4] * scale);
+        _stage[i].shift = shift;
+    }
+    _stages = stages;
+    return true;
+}
+
+void BiquadQ31::end() {
+    free(_stage);
+    _stage = nullptr;
+    _stages = 0;
+}
+
+void BiquadQ31::reset() {
+    for (int i = 0; i < _stages; i++) {
+        _stage[i].x1 = _stage[i].x2 = _stage[i].y1 = _stage[i].y2 = 0;
+    }
+}
+
+// The five Q62 products can overflow 64 bits part way through the sum even when the
+// result fits, so it is summed unsigned (wrapping, not undefined) and only the result
+// is taken as signed
+void BiquadQ31::process(const int32_t *in, int32_t *out, size_t cnt) {
+    for (int s = 0; s < _stages; s++) {
+        Stage *st = &_stage[s];
+        int rshift = 31 - st->shift;
+        int32_t x1 = st->x1, x2 = st->x2, y1 = st->y1, y2 = st->y2;
+        for (size_t i = 0; i < cnt; i++) {
+            int32_t x = in[i];
+            uint64_t acc = (uint64_t)((int64_t)st->b0 * x);
+            acc += (uint64_t)((int64_t)st->b1 * x1);
+            acc += (uint64_t)((int64_t)st->b2 * x2);
+            acc += (uint64_t)((int64_t)st->a1 * y1);
+            acc += (uint64_t)((int64_t)st->a2 * y2);
+            acc += 1ULL << (rshift - 1);
+            int32_t y = dspSat32((int64_t)acc >> rshift);
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            out[i] = y;
+        }
+        st->x1 = x1;
+        st->x2 = x2;
+        st->y1 = y1;
+        st->y2 = y2;
+        in = out;
+    }
+}
+
+// Cookbook designs, all divided through by a0.  1 - cos(w) is worked out as 2 * sin(w / 2)^2,
+// which keeps its precision when w is small.
+static void _store(double *c, double b0, double b1, double b2, double a0, double a1, double a2) {
+    c[0] = b0 / a0;
+    c[1] = b1 / a0;
+    c[2] = b2 / a0;
+    c[3] = a1 / a0;
+    c[4] = a2 / a0;
+}
+
+void BiquadDesign::lowpass(double *coeffs, float fs, float f0, float q) {
+    double w = 2.0 * M_PI * f0 / fs;
+    double omc = 2.0 * sin(w / 2.0) * sin(w / 2.0);
+    double alpha = sin(w) / (2.0 * q);
+    _store(coeffs, omc / 2.0, omc, omc / 2.0, 1.0 + alpha, -2.0 * cos(w), 1.0 - alpha);
+}
+
+void BiquadDesign::highpass(double *coeffs, float fs, float f0, float q) {
+    double w = 2.0 * M_PI * f0 / fs;
+    double cw = cos(w);
+    double alpha = sin(w) / (2.0 * q);
+    _store(coeffs, (1.0 + cw) / 2.0, -(1.0 + cw), (1.0 + cw) / 2.0, 1.0 + alpha, -2.0 * cw, 1.0 - alpha);
+}
+
+// Constant 0dB peak gain
+void BiquadDesign::bandpass(double *coeffs, float fs, float f0, float q) {
+    double w = 2.0 * M_PI * f0 / fs;
+    double alpha = sin(w) / (2.0 * q);
+    _store(coeffs, alpha, 0.0, -alpha, 1.0 + alpha, -2.0 * cos(w), 1.0 - alpha);
+}
+
+void BiquadDesign::notch(double *coeffs, float fs, float f0, float q) {
+    double w = 2.0 * M_PI * f0 / fs;
+    double cw = cos(w);
+    double alpha = sin(w) / (2.0 * q);
+    _store(coeffs, 1.0, -2.0 * cw, 1.0, 1.0 + alpha, -2.0 * cw, 1.0 - alpha);
+}
@@ -0,0 +1,84 @@
+/*
+    Fixed-point biquad (second order IIR) filter cascades for the Cortex-M0+
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include "DSPMath.h"
+
+// Each stage is given as 5 doubles { b0, b1, b2, a1, a2 }, normalized so a0 = 1, and computes
+//     y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] - a1 * y[n-1] - a2 * y[n-2]
+// Coefficients of 1 or more (a1 usually is) are scaled down by a power of 2 to fit, and the
+// sum scaled back up, per stage.  Doubles, because at low cutoffs 1 + a1 + a2 is tiny and a
+// float's 24 bits can't hold it; conversion only happens in begin().
+class BiquadQ15 {
+public:
+    BiquadQ15();
+    ~BiquadQ15();
+
+    bool begin(const double *coeffs, int stages);
+    void end();
+
+    // in and out may be the same buffer
+    void process(const int16_t *in, int16_t *out, size_t cnt);
+    void reset();
+
+private:
+    typedef struct {
+        int16_t b0, b1, b2, a1, a2;    // a1, a2 negated
+        int16_t x1, x2, y1, y2;
+        uint8_t shift;
+    } Stage;
+    Stage *_stage;
+    int _stages;
+};
+
+// The same with Q31 coefficients and samples, for filters whose poles sit so close to
+// the unit circle (low cutoffs at high sample rates) that Q15 coefficients can't place
+// them.  Several times slower, as the M0+ has no 32x32->64 multiply.
+class BiquadQ31 {
+public:
+    BiquadQ31();
+    ~BiquadQ31();
+
+    bool begin(const double *coeffs, int stages);
+    void end();
+
+    void process(const int32_t *in, int32_t *out, size_t cnt);
+    void reset();
+
+private:
+    typedef struct {
+        int32_t b0, b1, b2, a1, a2;    // a1, a2 negated
+        int32_t x1, x2, y1, y2;
+        uint8_t shift;
+    } Stage;
+    Stage *_stage;
+    int _stages;
+};
+
+// Coefficients for one stage from the Audio EQ Cookbook (R. Bristow-Johnson), for a sample
+// rate fs, corner or center frequency f0, and quality q (0.7071 for Butterworth)
+class BiquadDesign {
+public:
+    static void lowpass(double *coeffs, float fs, float f0, float q = 0.7071f);
+    static void highpass(double *coeffs, float fs, float f0, float q = 0.7071f);
+    static void bandpass(double *coeffs, float fs, float f0, float q);
+    static void notch(double *coeffs, float fs, float f0, float q);
+};
@@ -0,0 +1,84 @@
+/*
+    Fixed-point signal processing for the RP2040's Cortex-M0+ cores
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "DSP.h"
+
+uint16_t dspSqrt32(uint32_t v) {
+    uint32_t r = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return r;
+}
+
+void dspFromI2S16(const int32_t *words, size_t frames, int16_t *left, int16_t *right) {
+    for (size_t i = 0; i < frames; i++) {
+        if (left) {
+            left[i] = (int16_t)(words[i] >> 16);
+        }
+        if (right) {
+            right[i] = (int16_t)(words[i] & 0xffff);
+        }
+    }
+}
+
+void dspToI2S16(const int16_t *left, const int16_t *right, size_t frames, int32_t *words) {
+    if (!right) {
+        right = left;
+    }
+    for (size_t i = 0; i < frames; i++) {
+        words[i] = (int32_t)(((uint32_t)(uint16_t)left[i] << 16) | (uint16_t)right[i]);
+    }
+}
+
+void dspFromI2S32(const int32_t *words, size_t frames, int32_t *left, int32_t *right) {
+    for (size_t i = 0; i < frames; i++) {
+        if (left) {
+            left[i] = words[2 * i];
+        }
+        if (right) {
+            right[i] = words[2 * i + 1];
+        }
+    }
+}
+
+size_t dspFromADC(const uint32_t *words, size_t cnt, int channels, int channel, int16_t *out) {
+    size_t n = 0;
+    for (size_t i = channel; i < cnt; i += channels) {
+        out[n++] = (int16_t)(((int32_t)(words[i] & 0xfff) - 2048) << 4);
+    }
+    return n;
+}
+
+void dspDeinterleave16(const int16_t *in, size_t frames, int channels, int channel, int16_t *out) {
+    for (size_t i = 0; i < frames; i++) {
+        out[i] = in[i * channels + channel];
+    }
+}
@@ -0,0 +1,44 @@
+/*
+    Fixed-point signal processing for the RP2040's Cortex-M0+ cores
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include "DSPMath.h"
+#include "FFTQ15.h"
+#include "FIRQ15.h"
+#include "Biquad.h"
+
+// Converters from the block buffers the audio libraries hand out to plain Q15/Q31 arrays,
+// and back.  Any of the per-channel output pointers may be nullptr to skip that channel.
+
+// I2S::getReadBuffer() with 16 bit samples, one left/right pair per word (left high)
+void dspFromI2S16(const int32_t *words, size_t frames, int16_t *left, int16_t *right);
+// I2S::getWriteBuffer() with 16 bit samples.  right may be nullptr to send left to both.
+void dspToI2S16(const int16_t *left, const int16_t *right, size_t frames, int32_t *words);
+// I2S::getReadBuffer() with 24 or 32 bit samples, left and right in alternate words
+void dspFromI2S32(const int32_t *words, size_t frames, int32_t *left, int32_t *right);
+
+// ADCInput::getReadBuffer(), one 12-bit sample per word with channels interleaved.  Takes
+// channel (0 for the lowest pin) out of cnt words, centered on mid scale.  Returns the
+// number of samples written.
+size_t dspFromADC(const uint32_t *words, size_t cnt, int channels, int channel, int16_t *out);
+
+// PDM::read() data, int16_t samples with channels interleaved
+void dspDeinterleave16(const int16_t *in, size_t frames, int channels, int channel, int16_t *out);
@@ -0,0 +1,79 @@
+/*
+    Fixed-point helpers for the DSP library
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Q15 values are int16_t with 15 fractional bits (-1.0...0.99997), Q31 values are int32_t
+// with 31.  The M0+ has no saturating or DSP instructions, so these are plain C which
+// GCC turns into a compare or two.
+
+static inline int16_t dspSat16(int32_t v) {
+    if (v > 32767) {
+        return 32767;
+    } else if (v < -32768) {
+        return -32768;
+    }
+    return (int16_t)v;
+}
+
+static inline int32_t dspSat32(int64_t v) {
+    if (v > INT32_MAX) {
+        return INT32_MAX;
+    } else if (v < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)v;
+}
+
+// One 16x16 MULS, rounded
+static inline int16_t dspMulQ15(int16_t a, int16_t b) {
+    return dspSat16(((int32_t)a * b + (1 << 14)) >> 15);
+}
+
+// A 32x32->64 multiply is a libgcc call on the M0+, so Q31 math costs several times Q15
+static inline int32_t dspMulQ31(int32_t a, int32_t b) {
+    return dspSat32(((int64_t)a * b + (1LL << 30)) >> 31);
+}
+
+static inline int16_t dspFloatToQ15(float f) {
+    return dspSat16((int32_t)(f * 32768.0f + (f < 0 ? -0.5f : 0.5f)));
+}
+
+static inline float dspQ15ToFloat(int16_t q) {
+    return q / 32768.0f;
+}
+
+static inline int32_t dspFloatToQ31(float f) {
+    return dspSat32((int64_t)(f * 2147483648.0f + (f < 0 ? -0.5f : 0.5f)));
+}
+
+static inline int32_t dspDoubleToQ31(double d) {
+    return dspSat32((int64_t)(d * 2147483648.0 + (d < 0 ? -0.5 : 0.5)));
+}
+
+static inline float dspQ31ToFloat(int32_t q) {
+    return q / 2147483648.0f;
+}
+
+// Integer square root, floor(sqrt(v)), for magnitudes
+uint16_t dspSqrt32(uint32_t v);
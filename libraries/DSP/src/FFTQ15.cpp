@@ -0,0 +1,168 @@
+/*
+    Fixed-point radix-2 FFT for the Cortex-M0+
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "FFTQ15.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+FFTQ15::FFTQ15() : _n(0), _tw(nullptr) {
+}
+
+FFTQ15::~FFTQ15() {
+    end();
+}
+
+bool FFTQ15::begin(size_t n) {
+    if ((n < 16) || (n > 4096) || (n & (n - 1))) {
+        return false;
+    }
+    end();
+    _tw = (int16_t *)malloc(n * sizeof(int16_t));
+    if (!_tw) {
+        return false;
+    }
+    // Only done once, so the ROM float routines are quick enough
+    for (size_t k = 0; k < n / 2; k++) {
+        float a = 2.0f * (float)M_PI * k / n;
+        _tw[2 * k] = dspFloatToQ15(cosf(a));
+        _tw[2 * k + 1] = dspFloatToQ15(sinf(a));
+    }
+    _n = n;
+    return true;
+}
+
+void FFTQ15::end() {
+    free(_tw);
+    _tw = nullptr;
+    _n = 0;
+}
+
+// Decimation in time over n points, with the twiddles for an n * stride point transform
+void FFTQ15::_transform(int16_t *data, size_t n, size_t stride, bool inverse) {
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            int16_t t = data[2 * i];
+            data[2 * i] = data[2 * j];
+            data[2 * j] = t;
+            t = data[2 * i + 1];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j + 1] = t;
+        }
+    }
+
+    // One twiddle is loaded and then used for every group in the stage.  Each sum of two
+    // Q15 products still fits in 32 bits, so no 64-bit math is needed.
+    for (size_t m = 2; m <= n; m <<= 1) {
+        size_t half = m >> 1;
+        size_t step = (n / m) * stride;
+        for (size_t k = 0; k < half; k++) {
+            int32_t c = _tw[2 * k * step];
+            int32_t s = inverse ? _tw[2 * k * step + 1] : -_tw[2 * k * step + 1];
+            for (size_t j = k; j < n; j += m) {
+                int16_t *a = &data[2 * j];
+                int16_t *b = &data[2 * (j + half)];
+                int32_t tr = (c * b[0] - s * b[1]) >> 15;
+                int32_t ti = (c * b[1] + s * b[0]) >> 15;
+                int32_t ar = a[0];
+                int32_t ai = a[1];
+                a[0] = dspSat16((ar + tr) >> 1);
+                a[1] = dspSat16((ai + ti) >> 1);
+                b[0] = dspSat16((ar - tr) >> 1);
+                b[1] = dspSat16((ai - ti) >> 1);
+            }
+        }
+    }
+}
+
+void FFTQ15::forward(int16_t *data) {
+    _transform(data, _n, 1, false);
+}
+
+void FFTQ15::inverse(int16_t *data) {
+    _transform(data, _n, 1, true);
+}
+
+// Bin k of the real transform from bins k and n/2 - k of the half size complex one
+static inline void _split(int32_t ar, int32_t ai, int32_t br, int32_t bi, int32_t c, int32_t s, int16_t *x) {
+    int32_t hr = (ar + br) >> 1;
+    int32_t hi = (ai - bi) >> 1;
+    int32_t pr = (ai + bi) >> 1;
+    int32_t mr = (br - ar) >> 1;
+    x[0] = dspSat16((hr + ((c * pr + s * mr) >> 15)) >> 1);
+    x[1] = dspSat16((hi + ((c * mr - s * pr) >> 15)) >> 1);
+}
+
+// The even samples go in as the real parts and the odd ones as the imaginary parts,
+// which is just how they already lie in memory
+void FFTQ15::forwardReal(const int16_t *in, int16_t *out) {
+    size_t m = _n / 2;
+    if (in != out) {
+        memmove(out, in, _n * sizeof(int16_t));
+    }
+    _transform(out, m, 2, false);
+
+    int32_t z0r = out[0];
+    int32_t z0i = out[1];
+    out[0] = dspSat16((z0r + z0i) >> 1);
+    out[1] = 0;
+    out[2 * m] = dspSat16((z0r - z0i) >> 1);
+    out[2 * m + 1] = 0;
+    for (size_t k = 1; k <= m / 2; k++) {
+        size_t kk = m - k;
+        int32_t ar = out[2 * k];
+        int32_t ai = out[2 * k + 1];
+        int32_t br = out[2 * kk];
+        int32_t bi = out[2 * kk + 1];
+        int32_t c = _tw[2 * k];
+        int32_t s = _tw[2 * k + 1];
+        _split(ar, ai, br, bi, c, s, &out[2 * k]);
+        if (kk != k) {
+            // cos(pi - a) = -cos(a), sin(pi - a) = sin(a)
+            _split(br, bi, ar, ai, -c, s, &out[2 * kk]);
+        }
+    }
+}
+
+void FFTQ15::magnitude(const int16_t *bins, uint16_t *mag, size_t cnt) {
+    for (size_t i = 0; i < cnt; i++) {
+        int32_t re = bins[2 * i];
+        int32_t im = bins[2 * i + 1];
+        mag[i] = dspSqrt32((uint32_t)(re * re) + (uint32_t)(im * im));
+    }
+}
+
+// The periodic form, which is what spectral analysis wants
+void FFTQ15::hann(int16_t *window, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        window[i] = dspFloatToQ15(0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / n));
+    }
+}
+
+void FFTQ15::applyWindow(int16_t *data, const int16_t *window, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        data[i] = dspMulQ15(data[i], window[i]);
+    }
+}
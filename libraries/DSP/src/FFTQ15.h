@@ -0,0 +1,62 @@
+/*
+    Fixed-point radix-2 FFT for the Cortex-M0+
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include "DSPMath.h"
+
+// Complex data is interleaved re, im pairs of Q15.  Every butterfly stage halves its output,
+// so the result can never overflow and comes out as the true transform divided by the
+// size, in both directions.
+class FFTQ15 {
+public:
+    FFTQ15();
+    ~FFTQ15();
+
+    // Transforms of n points, a power of 2 from 16 to 4096.  Builds the twiddle table.
+    bool begin(size_t n);
+    void end();
+
+    size_t size() const {
+        return _n;
+    }
+
+    // In place on n complex points (2n int16_t)
+    void forward(int16_t *data);
+    void inverse(int16_t *data);
+
+    // n real points in, the n/2 + 1 bins from DC to Nyquist out as complex pairs (n + 2
+    // int16_t).  Done as one n/2 point complex FFT, so about half the work of forward().
+    // in and out may be the same buffer if it holds n + 2 entries.
+    void forwardReal(const int16_t *in, int16_t *out);
+
+    // The magnitude of each of cnt complex bins
+    static void magnitude(const int16_t *bins, uint16_t *mag, size_t cnt);
+
+    // Fills window with n points of a Hann window, and multiplies a block by one
+    static void hann(int16_t *window, size_t n);
+    static void applyWindow(int16_t *data, const int16_t *window, size_t n);
+
+private:
+    void _transform(int16_t *data, size_t n, size_t stride, bool inverse);
+
+    size_t _n;
+    int16_t *_tw;   // cos, sin of 2*pi*k/n for k < n/2
+};
@@ -0,0 +1,83 @@
+/*
+    Fixed-point FIR filter for the Cortex-M0+
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "FIRQ15.h"
+#include <stdlib.h>
+#include <string.h>
+
+FIRQ15::FIRQ15() : _coeffs(nullptr), _taps(0), _block(0), _state(nullptr) {
+}
+
+FIRQ15::~FIRQ15() {
+    end();
+}
+
+bool FIRQ15::begin(const int16_t *coeffs, size_t taps, size_t blockSize) {
+    if (!coeffs || !taps || !blockSize) {
+        return false;
+    }
+    end();
+    _state = (int16_t *)calloc(taps - 1 + blockSize, sizeof(int16_t));
+    if (!_state) {
+        return false;
+    }
+    _coeffs = coeffs;
+    _taps = taps;
+    _block = blockSize;
+    return true;
+}
+
+void FIRQ15::end() {
+    free(_state);
+    _state = nullptr;
+    _coeffs = nullptr;
+    _taps = 0;
+}
+
+void FIRQ15::reset() {
+    if (_state) {
+        memset(_state, 0, (_taps - 1) * sizeof(int16_t));
+    }
+}
+
+// The history sits in a straight line in front of each block, so the inner loop never
+// wraps and only the last taps - 1 samples are moved back once per block
+void FIRQ15::process(const int16_t *in, int16_t *out, size_t cnt) {
+    if (!_state) {
+        return;
+    }
+    int16_t *hist = _state + _taps - 1;
+    while (cnt) {
+        size_t len = cnt < _block ? cnt : _block;
+        memcpy(hist, in, len * sizeof(int16_t));
+        for (size_t i = 0; i < len; i++) {
+            const int16_t *x = &hist[i];
+            int64_t acc = 0;
+            for (size_t k = 0; k < _taps; k++) {
+                acc += (int32_t)_coeffs[k] * x[-(int)k];
+            }
+            out[i] = dspSat16(dspSat32((acc + (1 << 14)) >> 15));
+        }
+        memmove(_state, _state + len, (_taps - 1) * sizeof(int16_t));
+        in += len;
+        out += len;
+        cnt -= len;
+    }
+}
@@ -0,0 +1,48 @@
+/*
+    Fixed-point FIR filter for the Cortex-M0+
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include "DSPMath.h"
+
+// y[n] = sum(coeffs[k] * x[n - k]), with Q15 coefficients and samples.  The sum is kept in
+// 64 bits so long filters can't overflow part way through, and saturated once at the end.
+class FIRQ15 {
+public:
+    FIRQ15();
+    ~FIRQ15();
+
+    // coeffs must stay valid while the filter is in use.  blockSize is the most samples
+    // worked on per pass, process() takes any count.
+    bool begin(const int16_t *coeffs, size_t taps, size_t blockSize = 64);
+    void end();
+
+    // in and out may be the same buffer
+    void process(const int16_t *in, int16_t *out, size_t cnt);
+
+    // Forget the past samples
+    void reset();
+
+private:
+    const int16_t *_coeffs;
+    size_t _taps;
+    size_t _block;
+    int16_t *_state;    // taps - 1 past samples, then room for a block
+};
@@ -21,6 +21,7 @@
 */
 
 #include <Arduino.h>
+#include <algorithm>
 #include "EEPROM.h"
 #include <hardware/flash.h>
 #include <hardware/sync.h>
@@ -36,30 +37,98 @@
 
 extern "C" uint8_t _EEPROM_start;
 
+// Journal sector layout: header, a snapshot of the whole EEPROM, and then records of the
+// byte ranges changed by each commit, appended until the sector fills up
+#define JOURNAL_MAGIC 0x314a4545 // "EEJ1"
+#define JOURNAL_HEADER 8         // uint32_t magic, uint32_t size
+#define JOURNAL_MIN_LOG 256      // Below this there's no point journaling
+#define JOURNAL_RECORD 4         // uint16_t addr, uint8_t len - 1, uint8_t crc8, then data
+#define JOURNAL_MAX_RUN 256
+#define JOURNAL_EMPTY 0xffffffff
+
 EEPROMClass::EEPROMClass(void)
     : _sector(&_EEPROM_start) {
 }
 
-void EEPROMClass::begin(size_t size) {
+void EEPROMClass::begin(size_t size, bool journal) {
     if ((size <= 0) || (size > 4096)) {
         size = 4096;
     }
 
+    size_t oldSize = _size;
     _size = (size + 255) & (~255);  // Flash writes limited to 256 byte boundaries
 
     // In case begin() is called a 2nd+ time, don't reallocate if size is the same
-    if (_data && size != _size) {
+    if (_data && oldSize != _size) {
         delete[] _data;
-        _data = new uint8_t[size];
+        _data = new uint8_t[_size];
     } else if (!_data) {
-        _data = new uint8_t[size];
+        _data = new uint8_t[_size];
     }
+    delete[] _shadow;
+    _shadow = nullptr;
 
-    memcpy(_data, _sector, _size);
+    _journal = journal && (_logStart() + JOURNAL_MIN_LOG <= 4096);
+    if (_journal) {
+        _shadow = new uint8_t[_size];
+        _loadJournal();
+        memcpy(_shadow, _data, _size);
+    } else {
+        memcpy(_data, _sector, _size);
+    }
 
     _dirty = false; //make sure dirty is cleared in case begin() is called 2nd+ time
 }
 
+size_t EEPROMClass::_logStart() const {
+    return JOURNAL_HEADER + _size;
+}
+
+static uint8_t crc8(uint8_t crc, const uint8_t *data, size_t len) {
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+void EEPROMClass::_loadJournal() {
+    const uint32_t *hdr = (const uint32_t *)_sector;
+    _compact = true;
+    if (hdr[0] != JOURNAL_MAGIC) {
+        // A plain image, written without the journal, becomes the first snapshot
+        memcpy(_data, _sector, _size);
+        return;
+    }
+    size_t stored = std::min((size_t)hdr[1], (size_t)4096 - JOURNAL_HEADER);
+    memset(_data, 0xff, _size);
+    memcpy(_data, _sector + JOURNAL_HEADER, std::min(stored, _size));
+    size_t pos = JOURNAL_HEADER + stored;
+    // Replay until the erased end of the log.  A damaged record (power lost mid-commit) ends
+    // the replay there, and the next commit starts a fresh snapshot.
+    bool damaged = false;
+    while (pos + JOURNAL_RECORD <= 4096) {
+        const uint8_t *r = _sector + pos;
+        if (*(const uint32_t *)r == JOURNAL_EMPTY) {
+            break;
+        }
+        size_t addr = r[0] | (r[1] << 8);
+        size_t len = r[2] + 1;
+        if ((pos + JOURNAL_RECORD + len > 4096) || (crc8(crc8(0, r, 3), r + JOURNAL_RECORD, len) != r[3])) {
+            damaged = true;
+            break;
+        }
+        if (addr + len <= _size) {
+            memcpy(_data + addr, r + JOURNAL_RECORD, len);
+        }
+        pos += (JOURNAL_RECORD + len + 3) & ~3;
+    }
+    _logPos = pos;
+    _compact = damaged || (stored != _size);
+}
+
 bool EEPROMClass::end() {
     bool retval;
 
@@ -71,6 +140,8 @@ bool EEPROMClass::end() {
     if (_data) {
         delete[] _data;
     }
+    delete[] _shadow;
+    _shadow = nullptr;
     _data = 0;
     _size = 0;
     _dirty = false;
@@ -115,14 +186,94 @@ bool EEPROMClass::commit() {
     if (!_data) {
         return false;
     }
+    if (_journal) {
+        return _commitJournal();
+    }
+
+    PROFILE_CORE_SCOPE("EEPROM flash");
+    __flashErase((intptr_t)_sector - (intptr_t)XIP_BASE, 4096);
+    __flashProgram((intptr_t)_sector - (intptr_t)XIP_BASE, _data, _size);
+
+    return true;
+}
+
+// Programs part of the sector, which must still be erased there.  Whole pages are written,
+// but the bytes around the data are left as 0xff, which doesn't change what's in flash.
+void EEPROMClass::_program(size_t offset, const void *src, size_t len) {
+    const uint8_t *data = (const uint8_t *)src;
+    uint8_t page[FLASH_PAGE_SIZE];
+    PROFILE_CORE_SCOPE("EEPROM flash");
+    while (len) {
+        size_t pageStart = offset & ~(FLASH_PAGE_SIZE - 1);
+        size_t skip = offset - pageStart;
+        size_t n = std::min(len, FLASH_PAGE_SIZE - skip);
+        memset(page, 0xff, sizeof(page));
+        memcpy(page + skip, data, n);
+        __flashProgram((intptr_t)_sector + pageStart - (intptr_t)XIP_BASE, page, FLASH_PAGE_SIZE);
+        offset += n;
+        data += n;
+        len -= n;
+    }
+}
 
-    noInterrupts();
-    rp2040.idleOtherCore();
-    flash_range_erase((intptr_t)_sector - (intptr_t)XIP_BASE, 4096);
-    flash_range_program((intptr_t)_sector - (intptr_t)XIP_BASE, _data, _size);
-    rp2040.resumeOtherCore();
-    interrupts();
+// Erase the sector and write a fresh snapshot with an empty log
+void EEPROMClass::_compactJournal() {
+    uint32_t hdr[2] = { JOURNAL_MAGIC, (uint32_t)_size };
+    {
+        PROFILE_CORE_SCOPE("EEPROM flash");
+        __flashErase((intptr_t)_sector - (intptr_t)XIP_BASE, 4096);
+    }
+    _program(sizeof(hdr[0]), &hdr[1], sizeof(hdr[1]));
+    _program(JOURNAL_HEADER, _data, _size);
+    // The magic goes in last, so a half-written snapshot is never replayed as a journal
+    _program(0, &hdr[0], sizeof(hdr[0]));
+    _logPos = _logStart();
+    _compact = false;
+}
 
+// Append a record for each changed run of bytes, only erasing once the sector is full
+bool EEPROMClass::_commitJournal() {
+    size_t room = 4096 - _logPos;
+    uint8_t *log = _compact ? nullptr : new uint8_t[room];
+    size_t used = 0;
+    bool fits = !_compact;
+    for (size_t i = 0; fits && (i < _size); i++) {
+        if (_data[i] == _shadow[i]) {
+            continue;
+        }
+        // Runs separated by less than a record header are cheaper written as one
+        size_t last = i;
+        for (size_t j = i + 1; (j < _size) && (j - i < JOURNAL_MAX_RUN) && (j - last <= JOURNAL_RECORD); j++) {
+            if (_data[j] != _shadow[j]) {
+                last = j;
+            }
+        }
+        size_t len = last - i + 1;
+        size_t rec = (JOURNAL_RECORD + len + 3) & ~3;
+        if (used + rec > room) {
+            fits = false;
+            break;
+        }
+        uint8_t *r = log + used;
+        memset(r, 0xff, rec);
+        r[0] = i & 0xff;
+        r[1] = i >> 8;
+        r[2] = len - 1;
+        memcpy(r + JOURNAL_RECORD, _data + i, len);
+        r[3] = crc8(crc8(0, r, 3), r + JOURNAL_RECORD, len);
+        used += rec;
+        i = last;
+    }
+    if (fits) {
+        if (used) {
+            _program(_logPos, log, used);
+            _logPos += used;
+        }
+    } else {
+        _compactJournal();
+    }
+    delete[] log;
+    memcpy(_shadow, _data, _size);
     return true;
 }
 
@@ -29,7 +29,9 @@ class EEPROMClass {
 public:
     EEPROMClass(void);
 
-    void begin(size_t size);
+    // With journal set, commits append just the changed bytes to the sector and it is only
+    // erased when full.  Needs a size of 3584 or less, leaving room for the log.
+    void begin(size_t size, bool journal = false);
     uint8_t read(int const address);
     void write(int const address, uint8_t const val);
     bool commit();
@@ -77,10 +79,22 @@ public:
     }
 
 protected:
+    size_t _logStart() const;
+    void _loadJournal();
+    bool _commitJournal();
+    void _compactJournal();
+    void _program(size_t offset, const void *data, size_t len);
+
     uint8_t* _sector;
     uint8_t* _data = nullptr;
     size_t _size = 0;
     bool _dirty = false;
+
+    // Journal mode
+    bool _journal = false;
+    bool _compact = false;     // Next commit starts a fresh snapshot
+    uint8_t* _shadow = nullptr; // What's in flash, to find the changes
+    size_t _logPos = 0;        // Where the next record goes
 };
 
 extern EEPROMClass EEPROM;
@@ -9,9 +9,52 @@
 #define configUSE_TICK_HOOK				1
 #define configCPU_CLOCK_HZ				( ( unsigned long ) F_CPU  )
 #define configTICK_RATE_HZ				( ( TickType_t ) 1000 )
+
+/* Tickless idle, with the sleep implemented in variantHooks.cpp using a HW timer alarm */
+#define configUSE_TICKLESS_IDLE			2
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
+extern void __suppressTicksAndSleep(uint32_t xExpectedIdleTime);
+#define portSUPPRESS_TICKS_AND_SLEEP(x) __suppressTicksAndSleep(x)
 #define configMAX_PRIORITIES			( 8 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 256 )
-#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 164 * 1024 ) )
+/* FreeRTOS objects come from newlib malloc (heap_3) unless configFREERTOS_HEAP is 4, when
+   they come from a configTOTAL_HEAP_SIZE pool of their own in uninitialized RAM. */
+#ifndef configFREERTOS_HEAP
+#define configFREERTOS_HEAP				3
+#endif
+#ifndef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 64 * 1024 ) )
+#endif
+#define configAPPLICATION_ALLOCATED_HEAP 1
+/* Stack depths, in words, of the tasks created by the core */
+#ifndef configCORE0_STACK_SIZE
+#define configCORE0_STACK_SIZE			1024
+#endif
+#ifndef configCORE1_STACK_SIZE
+#define configCORE1_STACK_SIZE			1024
+#endif
+#ifndef configUSB_STACK_SIZE
+#define configUSB_STACK_SIZE			256
+#endif
+/* Their priorities and core affinity masks, see also freertosTaskConfig() below */
+#ifndef configCORE0_PRIORITY
+#define configCORE0_PRIORITY			( configMAX_PRIORITIES / 2 )
+#endif
+#ifndef configCORE0_AFFINITY
+#define configCORE0_AFFINITY			( 1 << 0 )
+#endif
+#ifndef configCORE1_PRIORITY
+#define configCORE1_PRIORITY			( configMAX_PRIORITIES / 2 )
+#endif
+#ifndef configCORE1_AFFINITY
+#define configCORE1_AFFINITY			( 1 << 1 )
+#endif
+#ifndef configUSB_PRIORITY
+#define configUSB_PRIORITY				( configMAX_PRIORITIES - 1 )
+#endif
+#ifndef configUSB_AFFINITY
+#define configUSB_AFFINITY				( 1 << 0 )
+#endif
 #define configMAX_TASK_NAME_LEN			( 10 )
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
@@ -24,9 +67,11 @@
 #define configUSE_COUNTING_SEMAPHORES	1
 #define configUSE_QUEUE_SETS			1
 #define configSUPPORT_DYNAMIC_ALLOCATION 1
-#define configSUPPORT_STATIC_ALLOCATION 0
+#define configSUPPORT_STATIC_ALLOCATION 1
 #define configSTACK_DEPTH_TYPE			uint32_t
 #define configUSE_TASK_PREEMPTION_DISABLE 1
+/* Index 1 is used by the core's drivers to block on their IRQs, see IRQWait.h */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2
 
 #define configUSE_NEWLIB_REENTRANT 1
 #define configNEWLIB_REENTRANT_IS_DYNAMIC 0 /* Note that we have a different config option, portSET_IMPURE_PTR */
@@ -126,5 +171,12 @@ extern void rtosFatalError(void);
 #define configSUPPORT_PICO_TIME_INTEROP 1
 
 
+/* Sketches may define this to change the priority and core affinity mask of each task the
+   core creates ("CORE0", "CORE1" or "USB") just before it is started */
+#ifdef __cplusplus
+extern "C"
+#endif
+void freertosTaskConfig(const char *name, uint32_t *priority, uint32_t *affinity) __attribute__((weak));
+
 #include "rp2040_config.h"
 //#include "task.h"
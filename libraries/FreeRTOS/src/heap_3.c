@@ -1 +1,4 @@
+#include "FreeRTOS.h"
+#if configFREERTOS_HEAP == 3
 #include "../lib/FreeRTOS-Kernel/portable/MemMang/heap_3.c"
+#endif
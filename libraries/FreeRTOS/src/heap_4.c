@@ -0,0 +1,6 @@
+#include "FreeRTOS.h"
+#if configFREERTOS_HEAP == 4
+/* Not zeroed at boot, heap_4 initializes its own free list */
+uint8_t ucHeap[configTOTAL_HEAP_SIZE] __attribute__((section(".uninitialized_data.ucHeap"), aligned(8)));
+#include "../lib/FreeRTOS-Kernel/portable/MemMang/heap_4.c"
+#endif
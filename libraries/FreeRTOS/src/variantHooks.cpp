@@ -34,6 +34,9 @@
 /* Raspberry PI Pico includes */
 #include <pico.h>
 #include <pico/time.h>
+#include <hardware/timer.h>
+#include <hardware/irq.h>
+#include <hardware/structs/systick.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
@@ -108,16 +111,37 @@ extern mutex_t __usb_mutex;
 static TaskHandle_t __usbTask;
 static void __usb(void *param);
 
-void startFreeRTOS(void) {
+// Gives the sketch its say on a core task's priority and affinity, and keeps them in range
+static void __taskConfig(const char *name, uint32_t *priority, uint32_t *affinity) {
+    if (freertosTaskConfig) {
+        freertosTaskConfig(name, priority, affinity);
+    }
+    if (*priority >= configMAX_PRIORITIES) {
+        *priority = configMAX_PRIORITIES - 1;
+    }
+    *affinity &= (1 << configNUM_CORES) - 1;
+    if (!*affinity) {
+        *affinity = tskNO_AFFINITY;
+    }
+}
 
-    TaskHandle_t c0;
-    xTaskCreate(__core0, "CORE0", 1024, 0, configMAX_PRIORITIES / 2, &c0);
-    vTaskCoreAffinitySet(c0, 1 << 0);
+void startFreeRTOS(void) {
+    uint32_t prio = configCORE0_PRIORITY;
+    uint32_t affinity = configCORE0_AFFINITY;
+    __taskConfig("CORE0", &prio, &affinity);
+    static StaticTask_t c0TCB;
+    static StackType_t c0Stack[configCORE0_STACK_SIZE];
+    TaskHandle_t c0 = xTaskCreateStatic(__core0, "CORE0", configCORE0_STACK_SIZE, 0, prio, c0Stack, &c0TCB);
+    vTaskCoreAffinitySet(c0, affinity);
 
     if (setup1 || loop1) {
+        // Only allocated when there is a core 1 sketch, so single core ones don't pay for the stack
+        prio = configCORE1_PRIORITY;
+        affinity = configCORE1_AFFINITY;
+        __taskConfig("CORE1", &prio, &affinity);
         TaskHandle_t c1;
-        xTaskCreate(__core1, "CORE1", 1024, 0, configMAX_PRIORITIES / 2, &c1);
-        vTaskCoreAffinitySet(c1, 1 << 1);
+        xTaskCreate(__core1, "CORE1", configCORE1_STACK_SIZE, 0, prio, &c1);
+        vTaskCoreAffinitySet(c1, affinity);
     }
 
     // Initialise and run the freeRTOS scheduler. Execution should never return here.
@@ -225,12 +249,17 @@ void prvBlinkMainLed(void) {
 
 #endif
 
+extern "C" void __crashDumpFatal(uint32_t reason, uint32_t code, void *caller);
+
 /*  ---------------------------------------------------------------------------*\
     Usage:
 	called on fatal error (interrupts disabled already)
     \*---------------------------------------------------------------------------*/
 extern "C"
 void rtosFatalError(void) {
+    // Reboots, leaving a CrashDump record, unless CrashDump::rebootOnFault(false)
+    __crashDumpFatal(CrashDump::FreeRTOSFatal, 0, __builtin_return_address(0));
+
     prvSetMainLedOn(); // Main LED on.
 
     for (;;) {
@@ -361,21 +390,135 @@ void vApplicationAssertHook() {
 #endif
 
 
+/*-----------------------------------------------------------*/
+#if ( configUSE_TICKLESS_IDLE == 2 )
+/*
+    Tickless idle using a hardware timer alarm.  Only the tick core ever stops SysTick,
+    the other core's idle task just sleeps in the idle hook.  Any interrupt (USB, GPIO,
+    the other core's FIFO) will wake us early, at which point the kernel tick count is
+    stepped forward by however long we actually slept.
+*/
+static int __tickAlarm = -1;
+static uint32_t __tickRemainder = 0; // us of partial ticks carried between sleeps
+
+static void __tickAlarmCB(uint alarm) {
+    (void) alarm; // Just here to wake us up
+}
+
+extern "C" void __suppressTicksAndSleep(TickType_t xExpectedIdleTime) {
+    const uint32_t usPerTick = 1000000 / configTICK_RATE_HZ;
+
+    if (get_core_num() != 0) {
+        return;
+    }
+    if (__tickAlarm < 0) {
+        __tickAlarm = hardware_alarm_claim_unused(true);
+        hardware_alarm_set_callback(__tickAlarm, __tickAlarmCB);
+    }
+
+    uint32_t irqs = save_and_disable_interrupts();
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        restore_interrupts(irqs);
+        return;
+    }
+
+    // Stop SysTick, everything from here on is timed by the 1MHz system timer
+    systick_hw->csr &= ~1;
+    uint64_t start = time_us_64();
+    uint64_t wake = start + (uint64_t)xExpectedIdleTime * usPerTick - __tickRemainder;
+    if (!hardware_alarm_set_target(__tickAlarm, from_us_since_boot(wake))) {
+        // WFI will still wake on a pending IRQ with interrupts disabled
+        __dsb();
+        __wfi();
+    }
+    hardware_alarm_cancel(__tickAlarm);
+
+    uint64_t slept = time_us_64() - start + __tickRemainder;
+    TickType_t ticks = slept / usPerTick;
+    if (ticks > xExpectedIdleTime) {
+        ticks = xExpectedIdleTime;
+        __tickRemainder = 0;
+    } else {
+        __tickRemainder = slept - ticks * usPerTick;
+    }
+    vTaskStepTick(ticks);
+
+    // Restart SysTick from a full period
+    systick_hw->cvr = 0;
+    systick_hw->csr |= 1;
+    restore_interrupts(irqs);
+}
+
+#endif /* configUSE_TICKLESS_IDLE == 2 */
+/*-----------------------------------------------------------*/
+
+// Blocking for the core's IRQWait, on a notification index of its own
+extern "C" void *__freertos_task_current() {
+    return xTaskGetCurrentTaskHandle();
+}
+
+extern "C" void __freertos_task_wait(uint32_t ms) {
+    TickType_t ticks = pdMS_TO_TICKS(ms);
+    ulTaskNotifyTakeIndexed(1, pdTRUE, ticks ? ticks : 1);
+}
+
+extern "C" void __freertos_task_notify(void *task) {
+    if (__get_IPSR()) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveIndexedFromISR((TaskHandle_t)task, 1, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotifyGiveIndexed((TaskHandle_t)task, 1);
+    }
+}
+
+
+// With no USB activity the task only wakes this often, normally the USB IRQ wakes it
+#define USB_TASK_FALLBACK_MS 100
+
+void __USBWakeTask(uint32_t ms) {
+    // The task works out for itself how long to sleep once woken
+    (void) ms;
+    if (__get_IPSR()) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(__usbTask, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotifyGive(__usbTask);
+    }
+}
+
+static void __usbIRQ() {
+    // Runs after TinyUSB's own handler has queued its events
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(__usbTask, &woken);
+    portYIELD_FROM_ISR(woken);
+    __usbIRQWait.notify();
+}
+
 static void __usb(void *param) {
     (void) param;
 
-    tusb_init();
+    tud_init(TUD_OPT_RHPORT);
+    irq_add_shared_handler(USBCTRL_IRQ, __usbIRQ, PICO_SHARED_IRQ_HANDLER_LOWEST_ORDER_PRIORITY);
 
     Serial.begin(115200);
 
     __usbInitted = true;
 
     while (true) {
+        uint32_t wait = USB_TASK_FALLBACK_MS;
         if (mutex_try_enter(&__usb_mutex, NULL)) {
             tud_task();
+            uint32_t next = __USBTaskHooks();
+            if (next && (next < wait)) {
+                wait = next;
+            }
             mutex_exit(&__usb_mutex);
+        } else {
+            wait = 1; // App is using USB, check back shortly
         }
-        vTaskDelay(1 / portTICK_PERIOD_MS);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
     }
 }
 
@@ -383,12 +526,21 @@ extern void __SetupDescHIDReport();
 extern void __SetupUSBDescriptor();
 
 void __USBStart() {
-    mutex_init(&__usb_mutex);
+    if (__usbTask) {
+        // Already called
+        return;
+    }
 
     __SetupDescHIDReport();
     __SetupUSBDescriptor();
 
-    // Make highest prio and locked to core 0
-    xTaskCreate(__usb, "USB", 256, 0, configMAX_PRIORITIES - 1, &__usbTask);
-    vTaskCoreAffinitySet(__usbTask, 1 << 0);
+    // Highest prio and locked to core 0 unless the sketch says otherwise.  The USB IRQ is
+    // handled on whichever core the task first runs on
+    uint32_t prio = configUSB_PRIORITY;
+    uint32_t affinity = configUSB_AFFINITY;
+    __taskConfig("USB", &prio, &affinity);
+    static StaticTask_t usbTCB;
+    static StackType_t usbStack[configUSB_STACK_SIZE];
+    __usbTask = xTaskCreateStatic(__usb, "USB", configUSB_STACK_SIZE, 0, prio, usbStack, &usbTCB);
+    vTaskCoreAffinitySet(__usbTask, affinity);
 }
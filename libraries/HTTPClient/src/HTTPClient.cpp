@@ -28,6 +28,7 @@
 #include "HTTPClient.h"
 #include <WiFi.h>
 #include "base64.h"
+#include <vector>
 
 // per https://github.com/esp8266/Arduino/issues/8231
 // make sure HTTPClient can be utilized as a movable class member
@@ -52,26 +53,6 @@ const String HTTPClient::defaultUserAgent = defaultUserAgentPstr;
 //    return 0; // never reached, keep gcc quiet
 //}
 
-// Wrappers for ESP8266-specific Arduino API changes
-static size_t StreamSendSize(Stream *s, Print *c, int size) {
-    int sent = 0;
-    if (size < 0) {
-        size = 999999; // Transfer until read fails
-    }
-    uint32_t start = millis();
-    while ((sent < size) && (millis() - start < 5000)) {
-        int x = s->read();
-        if (x < 0) {
-            break;
-        } else if (c->write(x)) {
-            sent++;
-        } else {
-            break;
-        }
-    }
-    return sent;
-}
-
 class StreamConstPtr {
 public:
     StreamConstPtr(const uint8_t *payload, size_t size) {
@@ -101,6 +82,74 @@ public:
 };
 
 
+// Idle keep-alive connections handed back by end(), shared by every HTTPClient
+typedef struct {
+    WiFiClient *client;
+    String host;
+    uint16_t port;
+    bool tls;
+    uint32_t idleSince;
+} PooledConnection;
+
+static std::vector<PooledConnection> _pool;
+static size_t _poolMax = 0;
+static uint32_t _poolIdleTimeout = HTTPCLIENT_POOL_IDLE_TIMEOUT;
+
+// Close whatever has timed out or been dropped by the server
+static void _poolExpire() {
+    for (auto it = _pool.begin(); it != _pool.end();) {
+        if (!it->client->connected() || (millis() - it->idleSince > _poolIdleTimeout)) {
+            DEBUG_HTTPCLIENT("[HTTP-Client][pool] closing %s:%u\n", it->host.c_str(), it->port);
+            delete it->client;
+            it = _pool.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+static WiFiClient *_poolTake(const String &host, uint16_t port, bool tls) {
+    _poolExpire();
+    for (auto it = _pool.begin(); it != _pool.end(); ++it) {
+        if ((it->port == port) && (it->tls == tls) && it->host.equalsIgnoreCase(host)) {
+            WiFiClient *c = it->client;
+            _pool.erase(it);
+            return c;
+        }
+    }
+    return nullptr;
+}
+
+static bool _poolPut(WiFiClient *client, const String &host, uint16_t port, bool tls) {
+    if (!_poolMax) {
+        return false;
+    }
+    _poolExpire();
+    if (_pool.size() >= _poolMax) {
+        // Make room by closing the one idle the longest
+        delete _pool.front().client;
+        _pool.erase(_pool.begin());
+    }
+    _pool.push_back({ client, host, port, tls, millis() });
+    return true;
+}
+
+void HTTPClient::setConnectionPool(size_t maxIdle, uint32_t idleTimeout) {
+    _poolMax = maxIdle;
+    _poolIdleTimeout = idleTimeout;
+    while (_pool.size() > _poolMax) {
+        delete _pool.front().client;
+        _pool.erase(_pool.begin());
+    }
+}
+
+void HTTPClient::clearConnectionPool() {
+    for (auto &p : _pool) {
+        delete p.client;
+    }
+    _pool.clear();
+}
+
 void HTTPClient::clear() {
     _returnCode = 0;
     _size = -1;
@@ -329,6 +378,10 @@ bool HTTPClient::beginInternal(const String& __url, const char* expectedProtocol
 */
 void HTTPClient::end(void) {
     disconnect(false);
+    if (_clientMade && _reuse && _canReuse && _clientMade->connected() && _poolPut(_clientMade, _host, _port, _clientTLS)) {
+        DEBUG_HTTPCLIENT("[HTTP-Client][end] tcp kept in pool\n");
+        _clientMade = nullptr;
+    }
     clear();
     if (_clientMade) {
         delete _clientMade;
@@ -697,7 +750,7 @@ int HTTPClient::sendRequest(const char * type, Stream * stream, size_t size) {
     }
 
     // transfer all of it, with timeout
-    size_t transferred = StreamSendSize(stream, _client(), size);
+    size_t transferred = stream->sendAll(*_client(), size, _tcpTimeout);
     if (transferred != size) {
         DEBUG_HTTPCLIENT("[HTTP-Client][sendRequest] short write, asked for %zu but got %zu failed.\n", size, transferred);
         return returnError(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
@@ -782,7 +835,7 @@ int HTTPClient::writeToPrint(Print * print) {
     if (_transferEncoding == HTTPC_TE_IDENTITY) {
         // len < 0: transfer all of it, with timeout
         // len >= 0: max:len, with timeout
-        ret = StreamSendSize(_client(), print, len);
+        ret = _client()->sendAll(*print, len < 0 ? (size_t) -1 : (size_t)len, _tcpTimeout);
 
         if (len > 0 && ret != len) {
             return HTTPC_ERROR_NO_STREAM;
@@ -797,24 +850,21 @@ int HTTPClient::writeToPrint(Print * print) {
             if (!connected()) {
                 return returnError(HTTPC_ERROR_CONNECTION_LOST);
             }
-            String chunkHeader = _client()->readStringUntil('\n');
-
-            if (chunkHeader.length() <= 0) {
+            char chunkHeader[24];
+            if (readLine(chunkHeader, sizeof(chunkHeader)) <= 0) {
                 return returnError(HTTPC_ERROR_READ_TIMEOUT);
             }
+            DEBUG_HTTPCLIENT("[HTTP-Client] chunk header: '%s'\n", chunkHeader);
 
-            chunkHeader.trim(); // remove \r
-            DEBUG_HTTPCLIENT("[HTTP-Client] chunk header: '%s'\n", chunkHeader.c_str());
-
-            // read size of chunk
-            len = (uint32_t) strtol((const char *) chunkHeader.c_str(), NULL, 16);
+            // read size of chunk, any chunk extension after it is ignored
+            len = (uint32_t) strtol(chunkHeader, NULL, 16);
             size += len;
             DEBUG_HTTPCLIENT("[HTTP-Client] read chunk len: %d\n", len);
 
             // data left?
             if (len > 0) {
                 // read len bytes with timeout
-                int r = StreamSendSize(_client(), print, len);
+                int r = _client()->sendAll(*print, len, _tcpTimeout);
                 if (r != len) {
                     return HTTPC_ERROR_NO_STREAM;
                 }
@@ -931,7 +981,7 @@ void HTTPClient::addHeader(const String& name, const String& value, bool first,
             int headerStart = _headers.indexOf(headerLine);
             if (headerStart != -1) {
                 int headerEnd = _headers.indexOf('\n', headerStart);
-                _headers = _headers.substring(0, headerStart) + _headers.substring(headerEnd + 1);
+                _headers.remove(headerStart, headerEnd + 1 - headerStart);
             }
         }
 
@@ -950,6 +1000,7 @@ void HTTPClient::collectHeaders(const char* headerKeys[], const size_t headerKey
     _currentHeaders = std::make_unique<RequestArgument[]>(_headerKeysCount);
     for (size_t i = 0; i < _headerKeysCount; i++) {
         _currentHeaders[i].key = headerKeys[i];
+        _currentHeaders[i].hash = headerHash(headerKeys[i]);
     }
 }
 
@@ -1008,6 +1059,21 @@ bool HTTPClient::connect(void) {
         return false;
     }
 
+    if (_reuse && !_clientGiven) {
+        WiFiClient *pooled = _poolTake(_host, _port, _clientTLS);
+        if (pooled) {
+            // The pooled connection replaces the fresh client, including any TLS settings on it
+            DEBUG_HTTPCLIENT("[HTTP-Client] connect: reusing pooled connection to %s:%u\n", _host.c_str(), _port);
+            delete _clientMade;
+            _clientMade = pooled;
+            _clientMade->setTimeout(_tcpTimeout);
+            while (_clientMade->available()) {
+                _clientMade->read();
+            }
+            return true;
+        }
+    }
+
     _client()->setTimeout(_tcpTimeout);
 
     if (!_client()->connect(_host.c_str(), _port)) {
@@ -1096,55 +1162,65 @@ int HTTPClient::handleHeaderResponse() {
 
     _canReuse = _reuse;
 
-    String transferEncoding;
+    // Lines are parsed in place in a stack buffer, only Location and collected values are copied out
+    char line[HTTPCLIENT_MAX_LINE];
+    bool chunked = false;
+    bool unknownEncoding = false;
 
     _transferEncoding = HTTPC_TE_IDENTITY;
-    unsigned long lastDataTime = millis();
 
-    while (connected()) {
-        size_t len = _client()->available();
-        if (len > 0) {
-            int headerSeparator = -1;
-            String headerLine = _client()->readStringUntil('\n');
-
-            lastDataTime = millis();
+    while (true) {
+        int len = readLine(line, sizeof(line));
+        if (len < 0) {
+            return connected() ? HTTPC_ERROR_READ_TIMEOUT : HTTPC_ERROR_CONNECTION_LOST;
+        }
 
-            DEBUG_HTTPCLIENT("[HTTP-Client][handleHeaderResponse] RX: '%s'\n", headerLine.c_str());
+        DEBUG_HTTPCLIENT("[HTTP-Client][handleHeaderResponse] RX: '%s'\n", line);
 
-            if (headerLine.startsWith(F("HTTP/1."))) {
+        char *headerSeparator;
+        if (!strncmp(line, "HTTP/1.", 7)) {
 
-                constexpr auto httpVersionIdx = sizeof "HTTP/1." - 1;
-                _canReuse = _canReuse && (headerLine[httpVersionIdx] != '0');
-                _returnCode = headerLine.substring(httpVersionIdx + 2, headerLine.indexOf(' ', httpVersionIdx + 2)).toInt();
-                _canReuse = _canReuse && (_returnCode > 0) && (_returnCode < 500);
+            constexpr auto httpVersionIdx = sizeof "HTTP/1." - 1;
+            _canReuse = _canReuse && (line[httpVersionIdx] != '0');
+            _returnCode = (len > (int)httpVersionIdx + 2) ? atoi(line + httpVersionIdx + 2) : 0;
+            _canReuse = _canReuse && (_returnCode > 0) && (_returnCode < 500);
 
-            } else if ((headerSeparator = headerLine.indexOf(':')) > 0) {
-                String headerName = headerLine.substring(0, headerSeparator);
-                String headerValue = headerLine.substring(headerSeparator + 1);
-                headerValue.trim();
+        } else if ((headerSeparator = strchr(line, ':')) && (headerSeparator != line)) {
+            const char *headerName = line;
+            char *headerValue = headerSeparator + 1;
+            *headerSeparator = 0;
+            while (isspace(*headerValue)) {
+                headerValue++;
+            }
+            char *end = headerValue + strlen(headerValue);
+            while ((end > headerValue) && isspace(end[-1])) {
+                *--end = 0;
+            }
 
-                if (headerName.equalsIgnoreCase(F("Content-Length"))) {
-                    _size = headerValue.toInt();
-                }
+            if (!strcasecmp(headerName, "Content-Length")) {
+                _size = atoi(headerValue);
+            }
 
-                if (_canReuse && headerName.equalsIgnoreCase(F("Connection"))) {
-                    if (headerValue.indexOf(F("close")) >= 0 &&
-                            headerValue.indexOf(F("keep-alive")) < 0) {
-                        _canReuse = false;
-                    }
+            if (_canReuse && !strcasecmp(headerName, "Connection")) {
+                if (strstr(headerValue, "close") && !strstr(headerValue, "keep-alive")) {
+                    _canReuse = false;
                 }
+            }
 
-                if (headerName.equalsIgnoreCase(F("Transfer-Encoding"))) {
-                    transferEncoding = headerValue;
-                }
+            if (!strcasecmp(headerName, "Transfer-Encoding")) {
+                chunked = !strcasecmp(headerValue, "chunked");
+                unknownEncoding = !chunked;
+            }
 
-                if (headerName.equalsIgnoreCase(F("Location"))) {
-                    _location = headerValue;
-                }
+            if (!strcasecmp(headerName, "Location")) {
+                _location = headerValue;
+            }
 
+            if (_headerKeysCount) {
+                uint32_t hash = headerHash(headerName);
                 for (size_t i = 0; i < _headerKeysCount; i++) {
-                    if (_currentHeaders[i].key.equalsIgnoreCase(headerName)) {
-                        if (_currentHeaders[i].value != "") {
+                    if ((_currentHeaders[i].hash == hash) && _currentHeaders[i].key.equalsIgnoreCase(headerName)) {
+                        if (_currentHeaders[i].value.length()) {
                             // Existing value, append this one with a comma
                             _currentHeaders[i].value += ',';
                             _currentHeaders[i].value += headerValue;
@@ -1154,45 +1230,92 @@ int HTTPClient::handleHeaderResponse() {
                         break; // We found a match, stop looking
                     }
                 }
-                continue;
             }
 
-            headerLine.trim(); // remove \r
-
-            if (headerLine == "") {
-                DEBUG_HTTPCLIENT("[HTTP-Client][handleHeaderResponse] code: %d\n", _returnCode);
-
-                if (_size > 0) {
-                    DEBUG_HTTPCLIENT("[HTTP-Client][handleHeaderResponse] size: %d\n", _size);
-                }
+        } else if (len == 0) {
+            DEBUG_HTTPCLIENT("[HTTP-Client][handleHeaderResponse] code: %d\n", _returnCode);
 
-                if (transferEncoding.length() > 0) {
-                    DEBUG_HTTPCLIENT("[HTTP-Client][handleHeaderResponse] Transfer-Encoding: %s\n", transferEncoding.c_str());
-                    if (transferEncoding.equalsIgnoreCase(F("chunked"))) {
-                        _transferEncoding = HTTPC_TE_CHUNKED;
-                    } else {
-                        _returnCode = HTTPC_ERROR_ENCODING;
-                        return _returnCode;
-                    }
-                } else {
-                    _transferEncoding = HTTPC_TE_IDENTITY;
-                }
+            if (_size > 0) {
+                DEBUG_HTTPCLIENT("[HTTP-Client][handleHeaderResponse] size: %d\n", _size);
+            }
 
-                if (_returnCode <= 0) {
-                    DEBUG_HTTPCLIENT("[HTTP-Client][handleHeaderResponse] Remote host is not an HTTP Server!");
-                    _returnCode = HTTPC_ERROR_NO_HTTP_SERVER;
-                }
+            if (unknownEncoding) {
+                _returnCode = HTTPC_ERROR_ENCODING;
                 return _returnCode;
             }
+            _transferEncoding = chunked ? HTTPC_TE_CHUNKED : HTTPC_TE_IDENTITY;
 
-        } else {
-            if ((millis() - lastDataTime) > _tcpTimeout) {
-                return HTTPC_ERROR_READ_TIMEOUT;
+            if (_returnCode <= 0) {
+                DEBUG_HTTPCLIENT("[HTTP-Client][handleHeaderResponse] Remote host is not an HTTP Server!");
+                _returnCode = HTTPC_ERROR_NO_HTTP_SERVER;
             }
+            return _returnCode;
         }
     }
+}
+
+/**
+    case-insensitive FNV-1a hash of a header name, so collected headers only need a full
+    compare when the hash matches
+    @param name const char *
+    @return uint32_t
+*/
+uint32_t HTTPClient::headerHash(const char *name) {
+    uint32_t hash = 2166136261U;
+    while (*name) {
+        hash = (hash ^ (uint8_t)tolower(*name++)) * 16777619U;
+    }
+    return hash;
+}
+
+/**
+    reads one line straight out of the client's receive buffer, without its CR LF
+    @param buf char *  NUL terminated, truncated to size - 1 characters
+    @param size size_t
+    @return int length of the whole line, or -1 on timeout or a lost connection
+*/
+int HTTPClient::readLine(char *buf, size_t size) {
+    WiFiClient *client = _client();
+    size_t len = 0;
+    size_t kept = 0;
+    char last = 0;
+    unsigned long lastDataTime = millis();
+
+    while (true) {
+        size_t avail = client->peekAvailable();
+        if (!avail) {
+            if (!client->connected() || ((millis() - lastDataTime) > _tcpTimeout)) {
+                buf[kept] = 0;
+                return -1;
+            }
+            yield();
+            continue;
+        }
+        const char *data = client->peekBuffer();
+        const char *nl = (const char *)memchr(data, '\n', avail);
+        size_t n = nl ? nl - data : avail;
+        size_t copy = std::min(n, size - 1 - kept);
+        memcpy(buf + kept, data, copy);
+        kept += copy;
+        len += n;
+        if (n) {
+            last = data[n - 1];
+        }
+        client->peekConsume(nl ? n + 1 : n);
+        if (nl) {
+            break;
+        }
+        lastDataTime = millis();
+    }
 
-    return HTTPC_ERROR_CONNECTION_LOST;
+    if (last == '\r') {
+        len--;
+        if (kept > len) {
+            kept = len;
+        }
+    }
+    buf[kept] = 0;
+    return len;
 }
 
 /**
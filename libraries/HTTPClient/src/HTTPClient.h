@@ -48,6 +48,16 @@
 
 #define HTTPCLIENT_DEFAULT_TCP_TIMEOUT (5000)
 
+// How long a pooled connection may sit unused before it's closed
+#ifndef HTTPCLIENT_POOL_IDLE_TIMEOUT
+#define HTTPCLIENT_POOL_IDLE_TIMEOUT (30000)
+#endif
+
+// Longest response header or chunk size line kept, the rest of a longer line is dropped
+#ifndef HTTPCLIENT_MAX_LINE
+#define HTTPCLIENT_MAX_LINE (1024)
+#endif
+
 /// HTTP client errors
 #define HTTPC_ERROR_CONNECTION_FAILED   (-1)
 #define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
@@ -182,6 +192,12 @@ public:
     bool connected(void);
 
     void setReuse(bool reuse); /// keep-alive
+
+    // Shared by all HTTPClients: end() parks up to maxIdle kept-alive connections, and a
+    // later request to the same host, port and protocol picks one up instead of connecting.
+    // 0 (the default) disables pooling.
+    static void setConnectionPool(size_t maxIdle, uint32_t idleTimeout = HTTPCLIENT_POOL_IDLE_TIMEOUT);
+    static void clearConnectionPool();
     void setUserAgent(const String& userAgent);
     void setAuthorization(const char * user, const char * password);
     void setAuthorization(const char * auth);
@@ -316,8 +332,12 @@ protected:
     struct RequestArgument {
         String key;
         String value;
+        uint32_t hash; // headerHash() of key
     };
 
+    static uint32_t headerHash(const char *name);
+    int readLine(char *buf, size_t size);
+
     bool beginInternal(const String& url, const char* expectedProtocol);
     void disconnect(bool preserveClient = false);
     void clear();
@@ -25,6 +25,8 @@
 
 #include "HTTPUpdate.h"
 #include <StreamString.h>
+#include <LittleFS.h>
+#include <algorithm>
 
 extern uint8_t _FS_start;
 extern uint8_t _FS_end;
@@ -61,12 +63,14 @@ void HTTPUpdate::setAuthorization(const String &auth) {
 HTTPUpdateResult HTTPUpdate::update(WiFiClient& client, const String& url, const String& currentVersion) {
     HTTPClient http;
     http.begin(client, url);
+    _url = url;
     return handleUpdate(http, currentVersion, false);
 }
 
 HTTPUpdateResult HTTPUpdate::updateFS(WiFiClient& client, const String& url, const String& currentVersion) {
     HTTPClient http;
     http.begin(client, url);
+    _url = url;
     return handleUpdate(http, currentVersion, true);
 }
 
@@ -74,24 +78,34 @@ HTTPUpdateResult HTTPUpdate::update(WiFiClient& client, const String& host, uint
                                     const String& currentVersion) {
     HTTPClient http;
     http.begin(client, host, port, uri);
+    _url = String();
+    _host = host;
+    _port = port;
+    _uri = uri;
     return handleUpdate(http, currentVersion, false);
 }
 
 HTTPUpdateResult HTTPUpdate::update(const String& url, const String& currentVersion) {
     HTTPClient http;
     http.begin(url);
+    _url = url;
     return handleUpdate(http, currentVersion, false);
 }
 
 HTTPUpdateResult HTTPUpdate::update(const String& host, uint16_t port, const String& uri, const String& currentVersion) {
     HTTPClient http;
     http.begin(host, port, uri);
+    _url = String();
+    _host = host;
+    _port = port;
+    _uri = uri;
     return handleUpdate(http, currentVersion, false);
 }
 
 HTTPUpdateResult HTTPUpdate::updateFS(const String& url, const String& currentVersion) {
     HTTPClient http;
     http.begin(url);
+    _url = url;
     return handleUpdate(http, currentVersion, true);
 }
 
@@ -161,42 +175,47 @@ HTTPUpdateResult HTTPUpdate::handleUpdate(HTTPClient& http, const String& curren
 
     HTTPUpdateResult ret = HTTP_UPDATE_FAILED;
 
-    // use HTTP/1.0 for update since the update handler not support any transfer Encoding
-    http.useHTTP10(true);
-    http.setTimeout(_httpClientTimeout);
-    http.setFollowRedirects(_followRedirects);
-    http.setUserAgent(F("Pico-HTTP-Update"));
-    http.addHeader(F("x-Pico-Chip-ID"), String(rp2040.getChipID()));
-    http.addHeader(F("x-Pico-STA-MAC"), WiFi.macAddress());
-    http.addHeader(F("x-Pico-AP-MAC"), WiFi.softAPmacAddress());
+    _setup(http);
 
-    if (spiffs) {
-        http.addHeader(F("x-Pico-Mode"), F("spiffs"));
-    } else {
-        http.addHeader(F("x-Pico-Mode"), F("sketch"));
+    // Only ask for what's missing when an earlier download of this image was cut short
+    uint32_t start = 0;
+    uint32_t total = 0;
+    _validator = String();
+    _md5Resume = String();
+    if (_resume && !spiffs && _loadResume(_target(), &total)) {
+        start = std::min((uint32_t)Update.staged(), total - 1) & ~4095;
     }
 
-    if (currentVersion && currentVersion[0] != 0x00) {
-        http.addHeader(F("x-Pico-Version"), currentVersion);
-    }
-
-    if (_user != "" && _password != "") {
-        http.setAuthorization(_user.c_str(), _password.c_str());
+    int code = 0;
+    if (start) {
+        uint32_t all = 0;
+        code = _get(http, currentVersion, start, 0, &all);
+        if ((code != HTTP_CODE_PARTIAL_CONTENT) || (all != total)) {
+            DEBUG_HTTP_UPDATE("[httpUpdate] Can't resume (%d), starting over\n", code);
+            start = 0;
+            _md5Resume = String();
+            // A 200 is a new image, coming whole, anything else needs asking again
+            if (code != HTTP_CODE_OK) {
+                WiFiClient *tcp = http.getStreamPtr();
+                if (tcp) {
+                    tcp->stop();
+                }
+                code = 0;
+            }
+        }
     }
-
-    if (_auth != "") {
-        http.setAuthorization(_auth.c_str());
+    if (!start) {
+        if (!code) {
+            _addHeaders(http, currentVersion, spiffs);
+            code = http.GET();
+        }
+        // Strong validators only, If-Range can't use a weak ETag
+        _validator = http.header("ETag");
+        if (!_validator.length() || _validator.startsWith("W/")) {
+            _validator = http.header("Last-Modified");
+        }
     }
-
-    const char * headerkeys[] = { "x-MD5" };
-    size_t headerkeyssize = sizeof(headerkeys) / sizeof(char*);
-
-    // track these headers
-    http.collectHeaders(headerkeys, headerkeyssize);
-
-
-    int code = http.GET();
-    int len = http.getSize();
+    int len = start ? (int)total : http.getSize();
 
     if (code <= 0) {
         DEBUG_HTTP_UPDATE("[httpUpdate] HTTP error: %s\n", http.errorToString(code).c_str());
@@ -216,6 +235,8 @@ HTTPUpdateResult HTTPUpdate::handleUpdate(HTTPClient& http, const String& curren
         md5 = _md5Sum;
     } else if (http.hasHeader("x-MD5")) {
         md5 = http.header("x-MD5");
+    } else {
+        md5 = _md5Resume;
     }
     if (md5.length()) {
         DEBUG_HTTP_UPDATE("[httpUpdate]  - MD5: %s\n", md5.c_str());
@@ -228,6 +249,7 @@ HTTPUpdateResult HTTPUpdate::handleUpdate(HTTPClient& http, const String& curren
     }
 
     switch (code) {
+    case HTTP_CODE_PARTIAL_CONTENT:  ///< The rest of a resumed image
     case HTTP_CODE_OK:  ///< OK (Start Update)
         if (len > 0) {
             bool startUpdate = true;
@@ -273,7 +295,13 @@ HTTPUpdateResult HTTPUpdate::handleUpdate(HTTPClient& http, const String& curren
                     DEBUG_HTTP_UPDATE("[httpUpdate] runUpdate flash...\n");
                 }
 
-                if (runUpdate(*tcp, len, md5, command)) {
+                bool ok;
+                if (_resume && !spiffs) {
+                    ok = runResumable(http, currentVersion, len, start, md5);
+                } else {
+                    ok = runUpdate(*tcp, len, md5, command, tcp);
+                }
+                if (ok) {
                     ret = HTTP_UPDATE_OK;
                     DEBUG_HTTP_UPDATE("[httpUpdate] Update ok\n");
                     http.end();
@@ -329,14 +357,185 @@ HTTPUpdateResult HTTPUpdate::handleUpdate(HTTPClient& http, const String& curren
     return ret;
 }
 
+/**
+    request settings which last across requests
+    @param http HTTPClient&
+*/
+void HTTPUpdate::_setup(HTTPClient& http) {
+    // use HTTP/1.0 for update since the update handler not support any transfer Encoding
+    http.useHTTP10(true);
+    http.setTimeout(_httpClientTimeout);
+    http.setFollowRedirects(_followRedirects);
+    http.setUserAgent(F("Pico-HTTP-Update"));
+
+    if (_user != "" && _password != "") {
+        http.setAuthorization(_user.c_str(), _password.c_str());
+    }
+
+    if (_auth != "") {
+        http.setAuthorization(_auth.c_str());
+    }
+
+    static const char * headerkeys[] = { "x-MD5", "ETag", "Last-Modified", "Content-Range" };
+    size_t headerkeyssize = sizeof(headerkeys) / sizeof(char*);
+
+    // track these headers
+    http.collectHeaders(headerkeys, headerkeyssize);
+}
+
+/**
+    headers for the next request, the response clears them
+    @param http HTTPClient&
+    @param currentVersion const String&
+    @param spiffs bool
+    @param from uint32_t  first byte wanted, with to
+    @param to uint32_t  last byte wanted, 0 for the end
+*/
+void HTTPUpdate::_addHeaders(HTTPClient& http, const String& currentVersion, bool spiffs, uint32_t from, uint32_t to) {
+    http.addHeader(F("x-Pico-Chip-ID"), String(rp2040.getChipID()));
+    http.addHeader(F("x-Pico-STA-MAC"), WiFi.macAddress());
+    http.addHeader(F("x-Pico-AP-MAC"), WiFi.softAPmacAddress());
+
+    if (spiffs) {
+        http.addHeader(F("x-Pico-Mode"), F("spiffs"));
+    } else {
+        http.addHeader(F("x-Pico-Mode"), F("sketch"));
+    }
+
+    if (currentVersion && currentVersion[0] != 0x00) {
+        http.addHeader(F("x-Pico-Version"), currentVersion);
+    }
+
+    if (from || to) {
+        String range = String(F("bytes=")) + String(from) + '-';
+        if (to) {
+            range += String(to);
+        }
+        http.addHeader(F("Range"), range);
+        // Anything but the same image comes back whole, and is refused
+        if (_validator.length()) {
+            http.addHeader(F("If-Range"), _validator);
+        }
+    }
+}
+
+/**
+    GET bytes from..to (to 0 for the rest) of the firmware image
+    @param http HTTPClient&
+    @param currentVersion const String&
+    @param from uint32_t
+    @param to uint32_t
+    @param total uint32_t*  set to the whole image's size
+    @return HTTP_CODE_PARTIAL_CONTENT when exactly that range is coming
+*/
+int HTTPUpdate::_get(HTTPClient& http, const String& currentVersion, uint32_t from, uint32_t to, uint32_t *total) {
+    _addHeaders(http, currentVersion, false, from, to);
+    int code = http.GET();
+    if (code != HTTP_CODE_PARTIAL_CONTENT) {
+        return code;
+    }
+    // bytes first-last/size
+    String range = http.header("Content-Range");
+    unsigned long first, last, size;
+    if ((sscanf(range.c_str(), "bytes %lu-%lu/%lu", &first, &last, &size) != 3) || (first != from) || (to && (last != to))) {
+        DEBUG_HTTP_UPDATE("[httpUpdate] Unexpected Content-Range: %s\n", range.c_str());
+        return HTTP_UE_SERVER_WRONG_HTTP_CODE;
+    }
+    if (total) {
+        *total = size;
+    }
+    return code;
+}
+
+/**
+    what the resume file records the staged image as coming from
+    @return String
+*/
+String HTTPUpdate::_target() {
+    return _url.length() ? _url : _host + ':' + String(_port) + _uri;
+}
+
+/**
+    read back the resume file, if it's for target, into _validator and _md5Resume
+    @param target const String&
+    @param size uint32_t*  the image's size
+    @return true if an image from target was being staged
+*/
+bool HTTPUpdate::_loadResume(const String& target, uint32_t *size) {
+    LittleFS.begin();
+    File f = LittleFS.open(HTTP_UPDATE_RESUME_FILE, "r");
+    if (!f) {
+        return false;
+    }
+    String t = f.readStringUntil('\n');
+    String v = f.readStringUntil('\n');
+    int s = f.readStringUntil('\n').toInt();
+    String m = f.readStringUntil('\n');
+    if ((t != target) || !v.length() || (s <= 0)) {
+        return false;
+    }
+    _validator = v;
+    _md5Resume = m;
+    *size = s;
+    return true;
+}
+
+/**
+    note which image the staged firmware belongs to.  Without a validator there's no
+    telling whether the server's image has changed, so nothing is kept
+    @param target const String&
+    @param size uint32_t
+    @param md5 const String&
+*/
+void HTTPUpdate::_saveResume(const String& target, uint32_t size, const String& md5) {
+    LittleFS.begin();
+    if (!_validator.length()) {
+        LittleFS.remove(HTTP_UPDATE_RESUME_FILE);
+        return;
+    }
+    File f = LittleFS.open(HTTP_UPDATE_RESUME_FILE, "w");
+    if (f) {
+        f.printf("%s\n%s\n%lu\n%s\n", target.c_str(), _validator.c_str(), (unsigned long)size, md5.c_str());
+    }
+}
+
+// Lets HTTPClient hand the firmware to Update straight from the receive buffers
+class UpdaterPrint : public Print {
+public:
+    UpdaterPrint(HTTPUpdateProgressCB cb, uint32_t size) : _cb(cb), _size(size) { }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *data, size_t len) override {
+        size_t ret = Update.write((uint8_t *)data, len);
+        _failed |= ret != len;
+        if (_cb) {
+            _cb(Update.progress(), _size);
+        }
+        return ret;
+    }
+
+    bool failed() const {
+        return _failed;
+    }
+
+private:
+    HTTPUpdateProgressCB _cb;
+    uint32_t _size;
+    bool _failed = false;
+};
+
 /**
     write Update to flash
     @param in Stream&
     @param size uint32_t
     @param md5 String
+    @param client WiFiClient* set when in is the network connection itself
     @return true if Update ok
 */
-bool HTTPUpdate::runUpdate(Stream& in, uint32_t size, const String& md5, int command) {
+bool HTTPUpdate::runUpdate(Stream& in, uint32_t size, const String& md5, int command, WiFiClient *client) {
 
     StreamString error;
 
@@ -364,7 +563,14 @@ bool HTTPUpdate::runUpdate(Stream& in, uint32_t size, const String& md5, int com
         }
     }
 
-    if (Update.writeStream(in) != size) {
+    size_t written;
+    if (client) {
+        UpdaterPrint sink(_cbProgress, size);
+        written = client->sendAll(sink, size, _httpClientTimeout);
+    } else {
+        written = Update.writeStream(in);
+    }
+    if (written != size) {
         _setLastError(Update.getError());
         Update.printError(error);
         error.trim(); // remove line ending
@@ -387,6 +593,204 @@ bool HTTPUpdate::runUpdate(Stream& in, uint32_t size, const String& md5, int com
     return true;
 }
 
+/**
+    write the firmware image to flash, asking for the rest again whenever the download
+    stops short
+    @param http HTTPClient&  with the response to the first request coming in
+    @param currentVersion const String&
+    @param size uint32_t  the whole image
+    @param start uint32_t  where the response starts, the part before it is staged already
+    @param md5 String
+    @return true if Update ok
+*/
+bool HTTPUpdate::runResumable(HTTPClient& http, const String& currentVersion, uint32_t size, uint32_t start, const String& md5) {
+
+    StreamString error;
+
+    if (!(start ? Update.resume(size, start) : Update.begin(size, U_FLASH))) {
+        _setLastError(Update.getError());
+        Update.printError(error);
+        error.trim(); // remove line ending
+        DEBUG_HTTP_UPDATE("[httpUpdate] Update.begin failed! (%s)\n", error.c_str());
+        return false;
+    }
+    _saveResume(_target(), size, md5);
+
+    if (_cbProgress) {
+        _cbProgress(start, size);
+    }
+
+    if (md5.length()) {
+        if (!Update.setMD5(md5.c_str())) {
+            _setLastError(HTTP_UE_SERVER_FAULTY_MD5);
+            DEBUG_HTTP_UPDATE("[httpUpdate] Update.setMD5 failed! (%s)\n", md5.c_str());
+            Update.end();
+            return false;
+        }
+    }
+
+    uint32_t done = start;
+    int retries = _resumeRetries;
+    bool parallel = _parallel && (size - done >= HTTP_UPDATE_PARALLEL_MIN);
+    bool failed = false;
+    while (true) {
+        if (parallel) {
+            // Only the once, the rest comes over one connection if it breaks
+            parallel = false;
+            _fetchParallel(http, currentVersion, size, done);
+        }
+        WiFiClient *tcp = http.getStreamPtr();
+        if (tcp && (done < size)) {
+            UpdaterPrint sink(_cbProgress, size);
+            done += tcp->sendAll(sink, size - done, _httpClientTimeout);
+            failed = sink.failed();
+        }
+        if ((done == size) || failed || Update.hasError() || !retries--) {
+            break;
+        }
+        DEBUG_HTTP_UPDATE("[httpUpdate] Download stopped at %u of %u, resuming\n", done, size);
+        delay(1000);
+        int code = _get(http, currentVersion, done, 0, nullptr);
+        if ((code != HTTP_CODE_PARTIAL_CONTENT) && (code > 0)) {
+            // The server answered, but not with the rest of this image
+            DEBUG_HTTP_UPDATE("[httpUpdate] Can't resume (%d)\n", code);
+            _setLastError(HTTP_UE_SERVER_WRONG_HTTP_CODE);
+            Update.end();
+            return false;
+        }
+    }
+
+    if (done != size) {
+        if (failed || Update.hasError()) {
+            _setLastError(Update.getError() ? Update.getError() : UPDATE_ERROR_WRITE);
+        } else {
+            _setLastError(HTTPC_ERROR_CONNECTION_LOST);
+        }
+        DEBUG_HTTP_UPDATE("[httpUpdate] Download failed at %u of %u\n", done, size);
+        Update.end(); // Keeps what's staged for next time
+        return false;
+    }
+
+    if (_cbProgress) {
+        _cbProgress(size, size);
+    }
+
+    // Whatever happens now the next try has to start over
+    LittleFS.remove(HTTP_UPDATE_RESUME_FILE);
+    if (!Update.end()) {
+        _setLastError(Update.getError());
+        Update.printError(error);
+        error.trim(); // remove line ending
+        DEBUG_HTTP_UPDATE("[httpUpdate] Update.end failed! (%s)\n", error.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+    download the back half of the image over a second connection, into a spool file,
+    while the front half is flashed from http.  Then flash the spooled part and stream
+    the rest from the second connection.  If the front half doesn't make it http is
+    left where it got to, so it can carry on alone
+    @param http HTTPClient&
+    @param currentVersion const String&
+    @param size uint32_t
+    @param done uint32_t&  bytes of the image written so far
+    @return true if the whole image is in
+*/
+bool HTTPUpdate::_fetchParallel(HTTPClient& http, const String& currentVersion, uint32_t size, uint32_t& done) {
+    WiFiClient *front = http.getStreamPtr();
+    if (!front) {
+        return false;
+    }
+    uint32_t split = done + (((size - done) / 2) & ~4095);
+
+    HTTPClient back;
+    if (_url.length() ? !back.begin(*_parallel, _url) : !back.begin(*_parallel, _host, _port, _uri)) {
+        return false;
+    }
+    _setup(back);
+    uint32_t total = 0;
+    if ((_get(back, currentVersion, split, size - 1, &total) != HTTP_CODE_PARTIAL_CONTENT) || (total != size)) {
+        DEBUG_HTTP_UPDATE("[httpUpdate] No second connection, fetching in one piece\n");
+        back.end();
+        return false;
+    }
+    WiFiClient *rear = back.getStreamPtr();
+    File spool = LittleFS.open(HTTP_UPDATE_SPOOL_FILE, "w+");
+    if (!rear || !spool) {
+        back.end();
+        return false;
+    }
+    DEBUG_HTTP_UPDATE("[httpUpdate] Fetching from %u in parallel\n", split);
+
+    uint8_t buf[1024];
+    uint32_t spooled = 0;
+    uint32_t lastData = millis();
+    while (done < split) {
+        bool idle = true;
+        size_t n = std::min({(size_t)front->available(), sizeof(buf), (size_t)(split - done)});
+        if (n) {
+            n = front->read(buf, n);
+            if (Update.write(buf, n) != n) {
+                break;
+            }
+            done += n;
+            lastData = millis();
+            idle = false;
+            if (_cbProgress) {
+                _cbProgress(done, size);
+            }
+        } else if (!front->connected() || (millis() - lastData > (uint32_t)_httpClientTimeout)) {
+            break;
+        }
+        // The second connection is simply given up on if it drops, what it got still counts
+        n = rear ? std::min({(size_t)rear->available(), sizeof(buf), (size_t)(size - split - spooled)}) : 0;
+        if (n) {
+            n = rear->read(buf, n);
+            size_t w = spool.write(buf, n);
+            spooled += w;
+            idle = false;
+            if (w != n) {
+                rear = nullptr; // Out of space
+            }
+        }
+        if (idle) {
+            delay(1);
+        }
+    }
+    if (done < split) {
+        spool.close();
+        LittleFS.remove(HTTP_UPDATE_SPOOL_FILE);
+        back.end();
+        return false;
+    }
+
+    // Or it would carry on into the back half
+    front->stop();
+
+    spool.seek(0);
+    while (done < split + spooled) {
+        size_t n = spool.read(buf, std::min(sizeof(buf), (size_t)(split + spooled - done)));
+        if (!n || (Update.write(buf, n) != n)) {
+            break;
+        }
+        done += n;
+        if (_cbProgress) {
+            _cbProgress(done, size);
+        }
+    }
+    spool.close();
+    LittleFS.remove(HTTP_UPDATE_SPOOL_FILE);
+    if (rear && (done == split + spooled) && (done < size)) {
+        UpdaterPrint sink(_cbProgress, size);
+        done += rear->sendAll(sink, size - done, _httpClientTimeout);
+    }
+    back.end();
+    return done == size;
+}
+
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_HTTPUPDATE)
 HTTPUpdate httpUpdate;
 #endif
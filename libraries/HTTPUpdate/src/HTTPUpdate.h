@@ -41,6 +41,21 @@
 #define DEBUG_HTTP_UPDATE(...) do { (void)0; } while(0)
 #endif
 
+// Remembers which image the firmware staged in LittleFS belongs to, see setResume()
+#ifndef HTTP_UPDATE_RESUME_FILE
+#define HTTP_UPDATE_RESUME_FILE "firmware.resume"
+#endif
+
+// Holds the back half of the image while the front half is flashed, see setParallelFetch()
+#ifndef HTTP_UPDATE_SPOOL_FILE
+#define HTTP_UPDATE_SPOOL_FILE "firmware.spool"
+#endif
+
+// Images smaller than this aren't worth a second connection
+#ifndef HTTP_UPDATE_PARALLEL_MIN
+#define HTTP_UPDATE_PARALLEL_MIN 65536
+#endif
+
 /// note we use HTTP client errors too so we start at 100
 //TODO - in v3.0.0 make this an enum
 constexpr int HTTP_UE_TOO_LESS_SPACE            = (-100);
@@ -103,6 +118,33 @@ public:
     void setAuthorization(const String& user, const String& password);
     void setAuthorization(const String& auth);
 
+    /**
+        make firmware downloads resumable.  A connection which drops is picked up again
+        with a Range request from where it stopped, up to retries times per update() call.
+        The image being staged is also remembered in LittleFS, so an update() of the same
+        URL after a failure or reset only fetches the part which didn't make it.  The
+        server has to honor Range requests, and send an ETag or Last-Modified header for
+        the image to be resumed across calls.  Filesystem updates always start over.
+        @param resume bool
+        @param retries uint8_t
+    */
+    void setResume(bool resume, uint8_t retries = 5) {
+        _resumeRetries = resume ? retries : 0;
+        _resume = resume;
+    }
+
+    /**
+        fetch the back half of a firmware image over a second connection, made with
+        client, while the front half is downloaded and flashed.  The back half waits in
+        LittleFS until its turn, so there has to be room for half an image more.  For
+        TLS, client has to be a second WiFiClientSecure set up like the first.  Pass
+        nullptr to turn it off.  Needs setResume(true).
+        @param client WiFiClient*
+    */
+    void setParallelFetch(WiFiClient *client) {
+        _parallel = client;
+    }
+
     t_httpUpdate_return update(WiFiClient& client, const String& url, const String& currentVersion = "");
     t_httpUpdate_return update(WiFiClient& client, const String& host, uint16_t port, const String& uri = "/",
                                const String& currentVersion = "");
@@ -131,7 +173,8 @@ public:
 
 protected:
     t_httpUpdate_return handleUpdate(HTTPClient& http, const String& currentVersion, bool spiffs = false);
-    bool runUpdate(Stream& in, uint32_t size, const String& md5, int command = U_FLASH);
+    bool runUpdate(Stream& in, uint32_t size, const String& md5, int command = U_FLASH, WiFiClient *client = nullptr);
+    bool runResumable(HTTPClient& http, const String& currentVersion, uint32_t size, uint32_t start, const String& md5);
 
     // Set the error and potentially use a CB to notify the application
     void _setLastError(int err) {
@@ -148,9 +191,29 @@ protected:
     String _auth;
     String _md5Sum;
 private:
+    void _setup(HTTPClient& http);
+    void _addHeaders(HTTPClient& http, const String& currentVersion, bool spiffs, uint32_t from = 0, uint32_t to = 0);
+    int _get(HTTPClient& http, const String& currentVersion, uint32_t from, uint32_t to, uint32_t *total);
+    bool _fetchParallel(HTTPClient& http, const String& currentVersion, uint32_t size, uint32_t& done);
+    String _target();
+    bool _loadResume(const String& target, uint32_t *size);
+    void _saveResume(const String& target, uint32_t size, const String& md5);
+
     int _httpClientTimeout;
     followRedirects_t _followRedirects = HTTPC_DISABLE_FOLLOW_REDIRECTS;
 
+    // Where the image comes from, a URL or else host, port and URI
+    String _url;
+    String _host;
+    uint16_t _port = 0;
+    String _uri;
+
+    bool _resume = false;
+    uint8_t _resumeRetries = 0;
+    String _validator; // ETag or Last-Modified of the image being fetched, for If-Range
+    String _md5Resume; // x-MD5 of the image being resumed
+    WiFiClient *_parallel = nullptr;
+
     // Callbacks
     HTTPUpdateStartCB    _cbStart;
     HTTPUpdateEndCB      _cbEnd;
@@ -27,9 +27,6 @@
 #include "pio_i2s.pio.h"
 #include "AudioRingBuffer.h"
 
-static int              __channelCount = 0;    // # of channels left.  When we hit 0, then remove our handler
-static AudioRingBuffer* __channelMap[12];      // Lets the IRQ handler figure out where to dispatch to
-
 AudioRingBuffer::AudioRingBuffer(size_t bufferCount, size_t bufferWords, int32_t silenceSample, PinMode direction) {
     _running = false;
     _silenceSample = silenceSample;
@@ -40,20 +37,22 @@ AudioRingBuffer::AudioRingBuffer(size_t bufferCount, size_t bufferWords, int32_t
     _callback = nullptr;
     _userBuffer = -1;
     _userOff = 0;
+    _userHeld = false;
     for (size_t i = 0; i < bufferCount; i++) {
         auto ab = new AudioBuffer;
         ab->buff = new uint32_t[_wordsPerBuffer];
         ab->empty = true;
         _buffers.push_back(ab);
     }
+    // Played in place of any buffer the application hasn't filled in time
+    _silenceBuffer = _isOutput ? new uint32_t[_wordsPerBuffer] : nullptr;
 }
 
 AudioRingBuffer::~AudioRingBuffer() {
     if (_running) {
         for (auto i = 0; i < 2; i++) {
-            dma_channel_set_irq0_enabled(_channelDMA[i], false);
+            DMAChannel::detachInterrupt(_channelDMA[i]);
             dma_channel_unclaim(_channelDMA[i]);
-            __channelMap[_channelDMA[i]] = nullptr;
         }
         while (_buffers.size()) {
             auto ab = _buffers.back();
@@ -61,12 +60,7 @@ AudioRingBuffer::~AudioRingBuffer() {
             delete[] ab->buff;
             delete ab;
         }
-        __channelCount--;
-        if (!__channelCount) {
-            irq_set_enabled(DMA_IRQ_0, false);
-            // TODO - how can we know if there are no other parts of the core using DMA0 IRQ??
-            irq_remove_handler(DMA_IRQ_0, _irq);
-        }
+        delete[] _silenceBuffer;
     }
 }
 
@@ -77,6 +71,11 @@ void AudioRingBuffer::setCallback(void (*fn)()) {
 bool AudioRingBuffer::begin(int dreq, volatile void *pioFIFOAddr) {
     _running = true;
     // Set all buffers to silence, empty
+    if (_isOutput) {
+        for (uint32_t x = 0; x < _wordsPerBuffer; x++) {
+            _silenceBuffer[x] = _silenceSample;
+        }
+    }
     for (auto buff : _buffers) {
         buff->empty = true;
         if (_isOutput) {
@@ -95,7 +94,6 @@ bool AudioRingBuffer::begin(int dreq, volatile void *pioFIFOAddr) {
             return false;
         }
     }
-    bool needSetIRQ = __channelCount == 0;
     // Need to know both channels to set up ping-pong, so do in 2 stages
     for (auto i = 0; i < 2; i++) {
         dma_channel_config c = dma_channel_get_default_config(_channelDMA[i]);
@@ -116,13 +114,7 @@ bool AudioRingBuffer::begin(int dreq, volatile void *pioFIFOAddr) {
         } else {
             dma_channel_configure(_channelDMA[i], &c, _buffers[i]->buff, pioFIFOAddr, _wordsPerBuffer, false);
         }
-        dma_channel_set_irq0_enabled(_channelDMA[i], true);
-        __channelMap[_channelDMA[i]] = this;
-        __channelCount++;
-    }
-    if (needSetIRQ) {
-        irq_add_shared_handler(DMA_IRQ_0, _irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
-        irq_set_enabled(DMA_IRQ_0, true);
+        DMAChannel::attachInterrupt(_channelDMA[i], _irq, this);
     }
     _curBuffer = 0;
     _nextBuffer = 2 % _bufferCount;
@@ -143,18 +135,14 @@ bool AudioRingBuffer::write(uint32_t v, bool sync) {
         if (!sync) {
             return false;
         } else {
-            while (!_buffers[_userBuffer]->empty) {
-                /* noop busy wait */
-            }
+            _wait.until([this] { return _buffers[_userBuffer]->empty; });
         }
     }
     if (_userBuffer == _curBuffer) {
         if (!sync) {
             return false;
         } else {
-            while (_userBuffer == _curBuffer) {
-                /* noop busy wait */
-            }
+            _wait.until([this] { return _userBuffer != _curBuffer; });
         }
     }
     _buffers[_userBuffer]->buff[_userOff++] = v;
@@ -179,18 +167,14 @@ bool AudioRingBuffer::read(uint32_t *v, bool sync) {
         if (!sync) {
             return false;
         } else {
-            while (_buffers[_userBuffer]->empty) {
-                /* noop busy wait */
-            }
+            _wait.until([this] { return !_buffers[_userBuffer]->empty; });
         }
     }
     if (_userBuffer == _curBuffer) {
         if (!sync) {
             return false;
         } else {
-            while (_userBuffer == _curBuffer) {
-                /* noop busy wait */
-            }
+            _wait.until([this] { return _userBuffer != _curBuffer; });
         }
     }
     auto ret = _buffers[_userBuffer]->buff[_userOff++];
@@ -203,6 +187,68 @@ bool AudioRingBuffer::read(uint32_t *v, bool sync) {
     return true;
 }
 
+// Waits for the user buffer to be free for the application, empty for output or full for input
+bool AudioRingBuffer::_waitUserBuffer(bool sync) {
+    auto ready = [this] {
+        return (_buffers[_userBuffer]->empty == _isOutput) && (_userBuffer != _curBuffer);
+    };
+    if (!sync) {
+        return ready();
+    }
+    _wait.until(ready);
+    return true;
+}
+
+uint32_t *AudioRingBuffer::getWriteBuffer(bool sync) {
+    if (!_running || !_isOutput || _userHeld) {
+        return nullptr;
+    }
+    if (_userBuffer == -1) {
+        // First write or overflow, pick spot 2 buffers out
+        _userBuffer = (_nextBuffer + 2) % _bufferCount;
+        _userOff = 0;
+    }
+    if (_userOff || !_waitUserBuffer(sync)) {
+        return nullptr;
+    }
+    _userHeld = true;
+    return _buffers[_userBuffer]->buff;
+}
+
+void AudioRingBuffer::commitWriteBuffer() {
+    if (!_userHeld || !_isOutput) {
+        return;
+    }
+    _userHeld = false;
+    _buffers[_userBuffer]->empty = false;
+    _userBuffer = (_userBuffer + 1) % _bufferCount;
+}
+
+const uint32_t *AudioRingBuffer::getReadBuffer(bool sync) {
+    if (!_running || _isOutput || _userHeld) {
+        return nullptr;
+    }
+    if (_userBuffer == -1) {
+        // First read or overflow, pick last filled buffer
+        _userBuffer = (_curBuffer - 1 + _bufferCount) % _bufferCount;
+        _userOff = 0;
+    }
+    if (_userOff || !_waitUserBuffer(sync)) {
+        return nullptr;
+    }
+    _userHeld = true;
+    return _buffers[_userBuffer]->buff;
+}
+
+void AudioRingBuffer::releaseReadBuffer() {
+    if (!_userHeld || _isOutput) {
+        return;
+    }
+    _userHeld = false;
+    _buffers[_userBuffer]->empty = true;
+    _userBuffer = (_userBuffer + 1) % _bufferCount;
+}
+
 bool AudioRingBuffer::getOverUnderflow() {
     bool hold = _overunderflow;
     _overunderflow = false;
@@ -220,19 +266,17 @@ int AudioRingBuffer::available() {
 }
 
 void AudioRingBuffer::flush() {
-    while (_curBuffer != _userBuffer) {
-        // busy wait
-    }
+    _wait.until([this] { return _curBuffer == _userBuffer; });
 }
 
 void __not_in_flash_func(AudioRingBuffer::_dmaIRQ)(int channel) {
     if (_isOutput) {
-        for (uint32_t x = 0; x < _wordsPerBuffer; x++) {
-            _buffers[_curBuffer]->buff[x] = _silenceSample;
-        }
+        // Instead of refilling each finished buffer with silence here, a buffer still not
+        // filled when it's queued is swapped for the shared silence one
+        bool underflow = _buffers[_nextBuffer]->empty;
         _buffers[_curBuffer]-> empty = true;
-        _overunderflow = _overunderflow | _buffers[_nextBuffer]->empty;
-        dma_channel_set_read_addr(channel, _buffers[_nextBuffer]->buff, false);
+        _overunderflow = _overunderflow | underflow;
+        dma_channel_set_read_addr(channel, underflow ? _silenceBuffer : _buffers[_nextBuffer]->buff, false);
     } else {
         _buffers[_curBuffer]-> empty = false;
         _overunderflow = _overunderflow | !_buffers[_nextBuffer]->empty;
@@ -241,16 +285,12 @@ void __not_in_flash_func(AudioRingBuffer::_dmaIRQ)(int channel) {
     dma_channel_set_trans_count(channel, _wordsPerBuffer, false);
     _curBuffer = (_curBuffer + 1) % _bufferCount;
     _nextBuffer = (_nextBuffer + 1) % _bufferCount;
-    dma_channel_acknowledge_irq0(channel);
+    _wait.notify();
     if (_callback) {
         _callback();
     }
 }
 
-void __not_in_flash_func(AudioRingBuffer::_irq)() {
-    for (size_t i = 0; i < sizeof(__channelMap); i++) {
-        if (dma_channel_get_irq0_status(i) && __channelMap[i]) {
-            __channelMap[i]->_dmaIRQ(i);
-        }
-    }
+void __not_in_flash_func(AudioRingBuffer::_irq)(int channel, void *param) {
+    ((AudioRingBuffer *)param)->_dmaIRQ(channel);
 }
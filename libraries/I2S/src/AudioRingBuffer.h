@@ -22,6 +22,7 @@
 #pragma once
 #include <Arduino.h>
 #include <vector>
+#include <IRQWait.h>
 
 class AudioRingBuffer {
 public:
@@ -39,9 +40,21 @@ public:
     bool getOverUnderflow();
     int available();
 
+    // Whole buffer access, for filling or draining a DMA buffer in place.  Only valid on a
+    // buffer boundary (not part way through a buffer using write()/read()), and each get
+    // must be followed by its commit or release before the next get
+    uint32_t *getWriteBuffer(bool sync = true);
+    void commitWriteBuffer();
+    const uint32_t *getReadBuffer(bool sync = true);
+    void releaseReadBuffer();
+    size_t getBufferWords() {
+        return _wordsPerBuffer;
+    }
+
 private:
     void _dmaIRQ(int channel);
-    static void _irq();
+    bool _waitUserBuffer(bool sync);
+    static void _irq(int channel, void *param);
 
     typedef struct {
         uint32_t *buff;
@@ -58,12 +71,15 @@ private:
     size_t _bufferCount;
     bool _isOutput;
     int32_t _silenceSample;
+    uint32_t *_silenceBuffer;
     int _channelDMA[2];
     void (*_callback)();
 
     bool _overunderflow;
+    IRQWait _wait; // Blocking calls sleep until the next DMA IRQ under FreeRTOS
 
     // User buffer pointer
     int _userBuffer = -1;
     size_t _userOff = 0;
+    bool _userHeld = false;
 };
@@ -29,10 +29,20 @@ I2S::I2S(PinMode direction) {
     _writtenHalf = false;
     _pinBCLK = 26;
     _pinDOUT = 28;
+    _pinDIN = 27;
+    _pinMCLK = 25;
+    _mclkEnabled = false;
+    _mclkMult = 256;
+    _tdmChannels = 0;
+    _i2s = nullptr;
+    _mclk = nullptr;
     _freq = 48000;
-    _arb = nullptr;
-    _isOutput = direction == OUTPUT;
-    _cb = nullptr;
+    _arbOutput = nullptr;
+    _arbInput = nullptr;
+    _isOutput = (direction == OUTPUT) || (direction == INPUT_PULLUP);
+    _isInput = (direction == INPUT) || (direction == INPUT_PULLUP);
+    _cbOutput = nullptr;
+    _cbInput = nullptr;
     _buffers = 8;
     _bufferWords = 16;
     _silenceSample = 0;
@@ -57,6 +67,25 @@ bool I2S::setDATA(pin_size_t pin) {
     return true;
 }
 
+bool I2S::setDOUT(pin_size_t pin) {
+    if (!_isOutput || !_isInput) {
+        return false;
+    }
+    return setDATA(pin);
+}
+
+bool I2S::setDIN(pin_size_t pin) {
+    if (_running || (pin > 29) || !_isInput) {
+        return false;
+    }
+    if (_isOutput) {
+        _pinDIN = pin;
+    } else {
+        _pinDOUT = pin;
+    }
+    return true;
+}
+
 bool I2S::setBitsPerSample(int bps) {
     if (_running || ((bps != 8) && (bps != 16) && (bps != 24) && (bps != 32))) {
         return false;
@@ -75,29 +104,63 @@ bool I2S::setBuffers(size_t buffers, size_t bufferWords, int32_t silenceSample)
     return true;
 }
 
+bool I2S::setMCLK(pin_size_t pin) {
+    if (_running || (pin > 29)) {
+        return false;
+    }
+    _pinMCLK = pin;
+    _mclkEnabled = true;
+    return true;
+}
+
+bool I2S::setMCLKmult(int mult) {
+    if (_running || (mult <= 0) || (mult & 1)) {
+        return false;
+    }
+    _mclkMult = mult;
+    return true;
+}
+
+// 0 for normal stereo I2S, or the number of slots in each TDM frame
+bool I2S::setTDMChannels(int channels) {
+    if (_running || (channels && ((channels < 2) || (channels > 16) || (channels & 1))) || (channels && _isOutput && _isInput)) {
+        return false;
+    }
+    _tdmChannels = channels;
+    return true;
+}
+
 bool I2S::setFrequency(int newFreq) {
     _freq = newFreq;
     if (_running) {
-        float bitClk = _freq * _bps * 2.0 /* channels */ * 2.0 /* edges per clock */;
+        float channels = _tdmChannels ? _tdmChannels : 2.0;
+        float bitClk = _freq * _bps * channels * 2.0 /* edges per clock */;
+        if (_isOutput && _isInput) {
+            bitClk *= 2.0; // Full duplex takes 4 cycles per bit
+        }
         pio_sm_set_clkdiv(_pio, _sm, (float)clock_get_hz(clk_sys) / bitClk);
+        if (_mclkEnabled) {
+            // Two instructions per MCLK cycle
+            pio_sm_set_clkdiv(_mclkPIO, _mclkSM, (float)clock_get_hz(clk_sys) / (2.0 * _freq * _mclkMult));
+        }
     }
     return true;
 }
 
 void I2S::onTransmit(void(*fn)(void)) {
     if (_isOutput) {
-        _cb = fn;
+        _cbOutput = fn;
         if (_running) {
-            _arb->setCallback(_cb);
+            _arbOutput->setCallback(_cbOutput);
         }
     }
 }
 
 void I2S::onReceive(void(*fn)(void)) {
-    if (!_isOutput) {
-        _cb = fn;
+    if (_isInput) {
+        _cbInput = fn;
         if (_running) {
-            _arb->setCallback(_cb);
+            _arbInput->setCallback(_cbInput);
         }
     }
 }
@@ -106,9 +169,26 @@ bool I2S::begin() {
     _running = true;
     _hasPeeked = false;
     int off = 0;
-    _i2s = new PIOProgram(_isOutput ? &pio_i2s_out_program : &pio_i2s_in_program);
+    if (_mclkEnabled) {
+        _mclk = new PIOProgram(&pio_i2s_mclk_program);
+        _mclk->prepare(&_mclkPIO, &_mclkSM, &off);
+        pio_i2s_mclk_program_init(_mclkPIO, _mclkSM, off, _pinMCLK);
+    }
+    if (_isOutput && _isInput) {
+        _i2s = new PIOProgram(&pio_i2s_inout_program);
+    } else if (_tdmChannels) {
+        _i2s = new PIOProgram(_isOutput ? &pio_tdm_out_program : &pio_tdm_in_program);
+    } else {
+        _i2s = new PIOProgram(_isOutput ? &pio_i2s_out_program : &pio_i2s_in_program);
+    }
     _i2s->prepare(&_pio, &_sm, &off);
-    if (_isOutput) {
+    if (_isOutput && _isInput) {
+        pio_i2s_inout_program_init(_pio, _sm, off, _pinDOUT, _pinDIN, _pinBCLK, _bps);
+    } else if (_tdmChannels && _isOutput) {
+        pio_tdm_out_program_init(_pio, _sm, off, _pinDOUT, _pinBCLK, _bps, _tdmChannels);
+    } else if (_tdmChannels) {
+        pio_tdm_in_program_init(_pio, _sm, off, _pinDOUT, _pinBCLK, _bps, _tdmChannels);
+    } else if (_isOutput) {
         pio_i2s_out_program_init(_pio, _sm, off, _pinDOUT, _pinBCLK, _bps);
     } else {
         pio_i2s_in_program_init(_pio, _sm, off, _pinDOUT, _pinBCLK, _bps);
@@ -121,31 +201,64 @@ bool I2S::begin() {
         uint16_t a = _silenceSample & 0xffff;
         _silenceSample = (a << 16) | a;
     }
-    _arb = new AudioRingBuffer(_buffers, _bufferWords, _silenceSample, _isOutput ? OUTPUT : INPUT);
-    _arb->begin(pio_get_dreq(_pio, _sm, _isOutput), _isOutput ? &_pio->txf[_sm] : (volatile void*)&_pio->rxf[_sm]);
-    _arb->setCallback(_cb);
+    // In full duplex both rings are set up before the SM starts, so TX and RX buffer N
+    // always cover the same frames
+    if (_isOutput) {
+        _arbOutput = new AudioRingBuffer(_buffers, _bufferWords, _silenceSample, OUTPUT);
+        _arbOutput->begin(pio_get_dreq(_pio, _sm, true), &_pio->txf[_sm]);
+        _arbOutput->setCallback(_cbOutput);
+    }
+    if (_isInput) {
+        _arbInput = new AudioRingBuffer(_buffers, _bufferWords, _silenceSample, INPUT);
+        _arbInput->begin(pio_get_dreq(_pio, _sm, false), (volatile void*)&_pio->rxf[_sm]);
+        _arbInput->setCallback(_cbInput);
+    }
+    if (_mclkEnabled) {
+        pio_sm_set_enabled(_mclkPIO, _mclkSM, true);
+    }
     pio_sm_set_enabled(_pio, _sm, true);
+    _clockNotifier.attach();
 
     return true;
 }
 
+void I2S::_clockChanged(void *arg, bool after) {
+    I2S *i = (I2S *)arg;
+    if (after) {
+        i->setFrequency(i->_freq);
+    }
+}
+
 void I2S::end() {
+    if (_running) {
+        _clockNotifier.detach();
+        pio_sm_set_enabled(_pio, _sm, false);
+        PIOProgram::unprepare(_pio, _sm);
+        if (_mclkEnabled) {
+            pio_sm_set_enabled(_mclkPIO, _mclkSM, false);
+            PIOProgram::unprepare(_mclkPIO, _mclkSM);
+        }
+    }
     _running = false;
-    delete _arb;
-    _arb = nullptr;
+    delete _arbOutput;
+    _arbOutput = nullptr;
+    delete _arbInput;
+    _arbInput = nullptr;
     delete _i2s;
     _i2s = nullptr;
+    delete _mclk;
+    _mclk = nullptr;
 }
 
 int I2S::available() {
-    if (!_running || _isOutput) {
+    if (!_running || !_isInput) {
         return 0;
     }
-    return _arb->available();
+    return _arbInput->available();
 }
 
 int I2S::read() {
-    if (!_running || _isOutput) {
+    if (!_running || !_isInput) {
         return 0;
     }
 
@@ -154,34 +267,34 @@ int I2S::read() {
         return _peekSaved;
     }
 
-    if (_wasHolding <= 0) {
-        read(&_holdWord, true);
-        _wasHolding = 32;
+    if (_readWasHolding <= 0) {
+        read(&_readHoldWord, true);
+        _readWasHolding = 32;
     }
 
     int ret;
     switch (_bps) {
     case 8:
-        ret = _holdWord >> 24;
-        _holdWord <<= 8;
-        _wasHolding -= 8;
+        ret = _readHoldWord >> 24;
+        _readHoldWord <<= 8;
+        _readWasHolding -= 8;
         return ret;
     case 16:
-        ret = _holdWord >> 16;
-        _holdWord <<=  16;
-        _wasHolding -= 32;
+        ret = _readHoldWord >> 16;
+        _readHoldWord <<=  16;
+        _readWasHolding -= 32;
         return ret;
     case 24:
     case 32:
     default:
-        ret = _holdWord;
-        _wasHolding = 0;
+        ret = _readHoldWord;
+        _readWasHolding = 0;
         return ret;
     }
 }
 
 int I2S::peek() {
-    if (!_running || _isOutput) {
+    if (!_running || !_isInput) {
         return 0;
     }
     if (!_hasPeeked) {
@@ -192,8 +305,8 @@ int I2S::peek() {
 }
 
 void I2S::flush() {
-    if (_running) {
-        _arb->flush();
+    if (_running && _isOutput) {
+        _arbOutput->flush();
     }
 }
 
@@ -237,7 +350,7 @@ size_t I2S::write(int32_t val, bool sync) {
     if (!_running || !_isOutput) {
         return 0;
     }
-    return _arb->write(val, sync);
+    return _arbOutput->write(val, sync);
 }
 
 size_t I2S::write8(int8_t l, int8_t r) {
@@ -270,31 +383,31 @@ size_t I2S::write32(int32_t l, int32_t r) {
 }
 
 size_t I2S::read(int32_t *val, bool sync) {
-    if (!_running || _isOutput) {
+    if (!_running || !_isInput) {
         return 0;
     }
-    return _arb->read((uint32_t *)val, sync);
+    return _arbInput->read((uint32_t *)val, sync);
 }
 
 bool I2S::read8(int8_t *l, int8_t *r) {
-    if (!_running || _isOutput) {
+    if (!_running || !_isInput) {
         return false;
     }
-    if (_wasHolding) {
-        *l = (_holdWord >> 8) & 0xff;
-        *r = (_holdWord >> 0) & 0xff;
-        _wasHolding = 0;
+    if (_readWasHolding) {
+        *l = (_readHoldWord >> 8) & 0xff;
+        *r = (_readHoldWord >> 0) & 0xff;
+        _readWasHolding = 0;
     } else {
-        read(&_holdWord, true);
-        _wasHolding = 16;
-        *l = (_holdWord >> 24) & 0xff;
-        *r = (_holdWord >> 16) & 0xff;
+        read(&_readHoldWord, true);
+        _readWasHolding = 16;
+        *l = (_readHoldWord >> 24) & 0xff;
+        *r = (_readHoldWord >> 16) & 0xff;
     }
     return true;
 }
 
 bool I2S::read16(int16_t *l, int16_t *r) {
-    if (!_running || _isOutput) {
+    if (!_running || !_isInput) {
         return false;
     }
     int32_t o;
@@ -305,7 +418,7 @@ bool I2S::read16(int16_t *l, int16_t *r) {
 }
 
 bool I2S::read24(int32_t *l, int32_t *r) {
-    if (!_running || _isOutput) {
+    if (!_running || !_isInput) {
         return false;
     }
     read32(l, r);
@@ -316,7 +429,7 @@ bool I2S::read24(int32_t *l, int32_t *r) {
 }
 
 bool I2S::read32(int32_t *l, int32_t *r) {
-    if (!_running || _isOutput) {
+    if (!_running || !_isInput) {
         return false;
     }
     read(l, true);
@@ -324,6 +437,32 @@ bool I2S::read32(int32_t *l, int32_t *r) {
     return true;
 }
 
+int32_t *I2S::getWriteBuffer(bool sync) {
+    if (!_running || !_isOutput) {
+        return nullptr;
+    }
+    return (int32_t *)_arbOutput->getWriteBuffer(sync);
+}
+
+void I2S::commitWriteBuffer() {
+    if (_running && _isOutput) {
+        _arbOutput->commitWriteBuffer();
+    }
+}
+
+const int32_t *I2S::getReadBuffer(bool sync) {
+    if (!_running || !_isInput) {
+        return nullptr;
+    }
+    return (const int32_t *)_arbInput->getReadBuffer(sync);
+}
+
+void I2S::releaseReadBuffer() {
+    if (_running && _isInput) {
+        _arbInput->releaseReadBuffer();
+    }
+}
+
 size_t I2S::write(const uint8_t *buffer, size_t size) {
     // We can only write 32-bit chunks here
     if (size & 0x3) {
@@ -348,5 +487,5 @@ int I2S::availableForWrite() {
     if (!_running || !_isOutput) {
         return 0;
     }
-    return _arb->available();
+    return _arbOutput->available();
 }
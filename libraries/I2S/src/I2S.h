@@ -26,14 +26,20 @@
 
 class I2S : public Stream {
 public:
+    // OUTPUT, INPUT, or INPUT_PULLUP for full duplex (input and output on the same clocks)
     I2S(PinMode direction = OUTPUT);
     virtual ~I2S();
 
     bool setBCLK(pin_size_t pin);
     bool setDATA(pin_size_t pin);
+    bool setDOUT(pin_size_t pin); // Full duplex only, setDATA() in other modes
+    bool setDIN(pin_size_t pin);
     bool setBitsPerSample(int bps);
     bool setBuffers(size_t buffers, size_t bufferWords, int32_t silenceSample = 0);
     bool setFrequency(int newFreq);
+    bool setMCLK(pin_size_t pin);
+    bool setMCLKmult(int mult);
+    bool setTDMChannels(int channels);
 
     bool begin(long sampleRate) {
         setFrequency(sampleRate);
@@ -92,6 +98,16 @@ public:
     bool read24(int32_t *l, int32_t *r); // Note that 24b reads will be left-aligned (see above)
     bool read32(int32_t *l, int32_t *r);
 
+    // Hand out a whole DMA buffer of getBufferWords() 32-bit words to fill or drain in place,
+    // instead of copying a word at a time.  Returns nullptr if none is ready and sync is false
+    int32_t *getWriteBuffer(bool sync = true);
+    void commitWriteBuffer();
+    const int32_t *getReadBuffer(bool sync = true);
+    void releaseReadBuffer();
+    size_t getBufferWords() {
+        return _bufferWords;
+    }
+
     // Note that these callback are called from **INTERRUPT CONTEXT** and hence
     // should be in RAM, not FLASH, and should be quick to execute.
     void onTransmit(void(*)(void));
@@ -100,15 +116,25 @@ public:
 private:
     pin_size_t _pinBCLK;
     pin_size_t _pinDOUT;
+    pin_size_t _pinDIN;
+    pin_size_t _pinMCLK;
+    bool _mclkEnabled;
+    int _mclkMult;
+    int _tdmChannels;
     int _bps;
     int _freq;
     size_t _buffers;
     size_t _bufferWords;
     int32_t _silenceSample;
     bool _isOutput;
+    bool _isInput;
 
     bool _running;
 
+    // Recomputes the PIO dividers when the system clock changes
+    ClockNotifier _clockNotifier{_clockChanged, this};
+    static void _clockChanged(void *arg, bool after);
+
     bool _hasPeeked;
     int32_t _peekSaved;
 
@@ -118,11 +144,19 @@ private:
 
     int32_t _holdWord = 0;
     int _wasHolding = 0;
+    int32_t _readHoldWord = 0;
+    int _readWasHolding = 0;
 
-    void (*_cb)();
+    void (*_cbOutput)();
+    void (*_cbInput)();
 
-    AudioRingBuffer *_arb;
+    AudioRingBuffer *_arbOutput;
+    AudioRingBuffer *_arbInput;
     PIOProgram *_i2s;
     PIO _pio;
     int _sm;
+
+    PIOProgram *_mclk;
+    PIO _mclkPIO;
+    int _mclkSM;
 };
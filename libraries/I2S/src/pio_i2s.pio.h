@@ -77,6 +77,139 @@ static inline pio_sm_config pio_i2s_in_program_get_default_config(uint offset) {
     return c;
 }
 
+#endif
+
+// ------------- //
+// pio_i2s_inout //
+// ------------- //
+
+#define pio_i2s_inout_wrap_target 0
+#define pio_i2s_inout_wrap 11
+
+static const uint16_t pio_i2s_inout_program_instructions[] = {
+    //     .wrap_target
+    0xa822, //  0: mov    x, y            side 1
+    0x6101, //  1: out    pins, 1         side 0 [1]
+    0x4801, //  2: in     pins, 1         side 1
+    0x0841, //  3: jmp    x--, 1          side 1
+    0x7101, //  4: out    pins, 1         side 2 [1]
+    0x5801, //  5: in     pins, 1         side 3
+    0xb822, //  6: mov    x, y            side 3
+    0x7101, //  7: out    pins, 1         side 2 [1]
+    0x5801, //  8: in     pins, 1         side 3
+    0x1847, //  9: jmp    x--, 7          side 3
+    0x6101, // 10: out    pins, 1         side 0 [1]
+    0x4801, // 11: in     pins, 1         side 1
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program pio_i2s_inout_program = {
+    .instructions = pio_i2s_inout_program_instructions,
+    .length = 12,
+    .origin = -1,
+};
+
+static inline pio_sm_config pio_i2s_inout_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + pio_i2s_inout_wrap_target, offset + pio_i2s_inout_wrap);
+    sm_config_set_sideset(&c, 2, false, false);
+    return c;
+}
+
+#endif
+
+// ----------- //
+// pio_tdm_out //
+// ----------- //
+
+#define pio_tdm_out_wrap_target 0
+#define pio_tdm_out_wrap 3
+
+static const uint16_t pio_tdm_out_program_instructions[] = {
+    //     .wrap_target
+    0x6001, //  0: out    pins, 1         side 0
+    0x0840, //  1: jmp    x--, 0          side 1
+    0x7001, //  2: out    pins, 1         side 2
+    0xb822, //  3: mov    x, y            side 3
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program pio_tdm_out_program = {
+    .instructions = pio_tdm_out_program_instructions,
+    .length = 4,
+    .origin = -1,
+};
+
+static inline pio_sm_config pio_tdm_out_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + pio_tdm_out_wrap_target, offset + pio_tdm_out_wrap);
+    sm_config_set_sideset(&c, 2, false, false);
+    return c;
+}
+#endif
+
+// ---------- //
+// pio_tdm_in //
+// ---------- //
+
+#define pio_tdm_in_wrap_target 0
+#define pio_tdm_in_wrap 5
+
+static const uint16_t pio_tdm_in_program_instructions[] = {
+    //     .wrap_target
+    0x4801, //  0: in     pins, 1         side 1
+    0x0040, //  1: jmp    x--, 0          side 0
+    0x4801, //  2: in     pins, 1         side 1
+    0xb022, //  3: mov    x, y            side 2
+    0x5801, //  4: in     pins, 1         side 3
+    0xa042, //  5: nop                    side 0
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program pio_tdm_in_program = {
+    .instructions = pio_tdm_in_program_instructions,
+    .length = 6,
+    .origin = -1,
+};
+
+static inline pio_sm_config pio_tdm_in_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + pio_tdm_in_wrap_target, offset + pio_tdm_in_wrap);
+    sm_config_set_sideset(&c, 2, false, false);
+    return c;
+}
+#endif
+
+// ------------ //
+// pio_i2s_mclk //
+// ------------ //
+
+#define pio_i2s_mclk_wrap_target 0
+#define pio_i2s_mclk_wrap 1
+
+static const uint16_t pio_i2s_mclk_program_instructions[] = {
+    //     .wrap_target
+    0xe001, //  0: set    pins, 1
+    0xe000, //  1: set    pins, 0
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program pio_i2s_mclk_program = {
+    .instructions = pio_i2s_mclk_program_instructions,
+    .length = 2,
+    .origin = -1,
+};
+
+static inline pio_sm_config pio_i2s_mclk_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + pio_i2s_mclk_wrap_target, offset + pio_i2s_mclk_wrap);
+    return c;
+}
+
 static inline void pio_i2s_out_program_init(PIO pio, uint sm, uint offset, uint data_pin, uint clock_pin_base, uint bits) {
     pio_gpio_init(pio, data_pin);
     pio_gpio_init(pio, clock_pin_base);
@@ -107,6 +240,69 @@ static inline void pio_i2s_in_program_init(PIO pio, uint sm, uint offset, uint d
     pio_sm_set_pins(pio, sm, 0); // clear pins
     pio_sm_exec(pio, sm, pio_encode_set(pio_y, bits - 2));
 }
+static inline void pio_i2s_inout_program_init(PIO pio, uint sm, uint offset, uint data_out_pin, uint data_in_pin, uint clock_pin_base, uint bits) {
+    pio_gpio_init(pio, data_out_pin);
+    pio_gpio_init(pio, data_in_pin);
+    pio_gpio_init(pio, clock_pin_base);
+    pio_gpio_init(pio, clock_pin_base + 1);
+    pio_sm_config sm_config = pio_i2s_inout_program_get_default_config(offset);
+    sm_config_set_out_pins(&sm_config, data_out_pin, 1);
+    sm_config_set_in_pins(&sm_config, data_in_pin);
+    sm_config_set_sideset_pins(&sm_config, clock_pin_base);
+    sm_config_set_out_shift(&sm_config, false, true, (bits <= 16) ? 2 * bits : bits);
+    sm_config_set_in_shift(&sm_config, false, true, (bits <= 16) ? 2 * bits : bits);
+    pio_sm_init(pio, sm, offset, &sm_config);
+    uint pin_mask = (1u << data_out_pin) | (3u << clock_pin_base);
+    pio_sm_set_pindirs_with_mask(pio, sm, pin_mask, pin_mask | (1u << data_in_pin));
+    pio_sm_set_pins(pio, sm, 0); // clear pins
+    pio_sm_exec(pio, sm, pio_encode_set(pio_y, bits - 2));
+}
+// TDM frames are up to 16 slots of 32 bits, so Y is loaded through the FIFO
+static inline void pio_tdm_set_y(PIO pio, uint sm, uint32_t y) {
+    pio_sm_put_blocking(pio, sm, y);
+    pio_sm_exec(pio, sm, pio_encode_pull(false, true));
+    pio_sm_exec(pio, sm, pio_encode_out(pio_y, 32));
+    pio_sm_exec(pio, sm, pio_encode_mov(pio_x, pio_y));
+}
+static inline void pio_tdm_out_program_init(PIO pio, uint sm, uint offset, uint data_pin, uint clock_pin_base, uint bits, uint slots) {
+    pio_gpio_init(pio, data_pin);
+    pio_gpio_init(pio, clock_pin_base);
+    pio_gpio_init(pio, clock_pin_base + 1);
+    pio_sm_config sm_config = pio_tdm_out_program_get_default_config(offset);
+    sm_config_set_out_pins(&sm_config, data_pin, 1);
+    sm_config_set_sideset_pins(&sm_config, clock_pin_base);
+    sm_config_set_out_shift(&sm_config, false, true, (bits == 24) ? 24 : 32);
+    sm_config_set_fifo_join(&sm_config, PIO_FIFO_JOIN_TX);
+    pio_sm_init(pio, sm, offset, &sm_config);
+    uint pin_mask = (1u << data_pin) | (3u << clock_pin_base);
+    pio_sm_set_pindirs_with_mask(pio, sm, pin_mask, pin_mask);
+    pio_sm_set_pins(pio, sm, 0); // clear pins
+    pio_tdm_set_y(pio, sm, bits * slots - 2);
+}
+static inline void pio_tdm_in_program_init(PIO pio, uint sm, uint offset, uint data_pin, uint clock_pin_base, uint bits, uint slots) {
+    pio_gpio_init(pio, data_pin);
+    pio_gpio_init(pio, clock_pin_base);
+    pio_gpio_init(pio, clock_pin_base + 1);
+    pio_sm_config sm_config = pio_tdm_in_program_get_default_config(offset);
+    sm_config_set_in_pins(&sm_config, data_pin);
+    sm_config_set_sideset_pins(&sm_config, clock_pin_base);
+    sm_config_set_in_shift(&sm_config, false, true, (bits == 24) ? 24 : 32);
+    pio_sm_init(pio, sm, offset, &sm_config);
+    uint pin_mask = 3u << clock_pin_base;
+    pio_sm_set_pindirs_with_mask(pio, sm, pin_mask, pin_mask);
+    pio_sm_set_pins(pio, sm, 0); // clear pins
+    pio_tdm_set_y(pio, sm, bits * slots - 3);
+    // Y went through the RX side's TX FIFO, join only now that it's been pulled
+    hw_set_bits(&pio->sm[sm].shiftctrl, PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS);
+}
+static inline void pio_i2s_mclk_program_init(PIO pio, uint sm, uint offset, uint mclk_pin) {
+    pio_gpio_init(pio, mclk_pin);
+    pio_sm_config sm_config = pio_i2s_mclk_program_get_default_config(offset);
+    sm_config_set_set_pins(&sm_config, mclk_pin, 1);
+    pio_sm_init(pio, sm, offset, &sm_config);
+    pio_sm_set_consecutive_pindirs(pio, sm, mclk_pin, 1, true);
+    pio_sm_set_pins(pio, sm, 0); // clear pins
+}
 
 #endif
 
@@ -58,18 +58,20 @@ namespace MDNSImplementation {
 */
 MDNSResponder::MDNSResponder(void) :
     m_pServices(0), m_pUDPContext(0), m_pcHostname(0), m_pServiceQueries(0),
-    m_fnServiceTxtCallback(0) {
+    m_fnServiceTxtCallback(0), m_pResponseCache(0), m_Timer(_timerCB, this) {
 }
 
 /*
     MDNSResponder::~MDNSResponder
 */
 MDNSResponder::~MDNSResponder(void) {
+    m_Timer.stop();
     _resetProbeStatus(false);
     _releaseServiceQueries();
     _releaseHostname();
     _releaseUDPContext();
     _releaseServices();
+    _clearResponseCache();
 }
 
 /*
@@ -116,6 +118,7 @@ bool MDNSResponder::close(void) {
     bool bResult = false;
 
     if (0 != m_pUDPContext) {
+        m_Timer.stop();
         _announce(false, true);
         _resetProbeStatus(false);  // Stop probing
         _releaseServiceQueries();
@@ -166,6 +169,7 @@ bool MDNSResponder::setHostname(const char* p_pcHostname) {
                 pService->m_ProbeInformation.m_ProbingStatus = ProbingStatus_ReadyToStart;
             }
         }
+        _schedule();
     }
     DEBUG_EX_ERR(if (!bResult) {
     DEBUG_OUTPUT.printf_P(PSTR("[MDNSResponder] setHostname: FAILED for '%s'!\n"),
@@ -212,6 +216,7 @@ MDNSResponder::hMDNSService MDNSResponder::addService(const char* p_pcName,
                 // Start probing
                 ((stcMDNSService*)hResult)->m_ProbeInformation.m_ProbingStatus
                     = ProbingStatus_ReadyToStart;
+                _schedule();
             }
         }
     }  // else: bad arguments
@@ -268,8 +273,10 @@ bool MDNSResponder::setServiceName(const MDNSResponder::hMDNSService p_hService,
     stcMDNSService* pService = 0;
     bool            bResult
         = (((!p_pcInstanceName) || (MDNS_DOMAIN_LABEL_MAXLENGTH >= strlen(p_pcInstanceName)))
-           && ((pService = _findService(p_hService))) && (pService->setName(p_pcInstanceName))
-           && ((pService->m_ProbeInformation.m_ProbingStatus = ProbingStatus_ReadyToStart)));
+           && ((pService = _findService(p_hService))) && (_clearResponseCache())
+           && (pService->setName(p_pcInstanceName))
+           && ((pService->m_ProbeInformation.m_ProbingStatus = ProbingStatus_ReadyToStart))
+           && (_schedule()));
     DEBUG_EX_ERR(if (!bResult) {
     DEBUG_OUTPUT.printf_P(PSTR("[MDNSResponder] setServiceName: FAILED for '%s'!\n"),
                           (p_pcInstanceName ? : "-"));
@@ -630,7 +637,20 @@ MDNSResponder::queryService(const char* p_pcService, const char* p_pcProtocol,
 
     uint32_t u32Result = 0;
 
-    stcMDNSServiceQuery* pServiceQuery = 0;
+    // Answer from the last query for this service while all its answers are still fresh
+    stcMDNSServiceQuery* pServiceQuery = _findLegacyServiceQuery();
+    stcMDNS_RRDomain     serviceDomain;
+    if ((pServiceQuery) && (p_pcService) && (p_pcProtocol)
+            && (_buildDomainForService(p_pcService, p_pcProtocol, serviceDomain))
+            && (serviceDomain == pServiceQuery->m_ServiceTypeDomain)
+            && (_hasFreshAnswers(*pServiceQuery))) {
+        DEBUG_EX_INFO(DEBUG_OUTPUT.printf_P(
+                          PSTR("[MDNSResponder] queryService: Using %u cached answers\n"),
+                          (unsigned)pServiceQuery->answerCount()););
+        return pServiceQuery->answerCount();
+    }
+
+    pServiceQuery = 0;
     if ((p_pcService) && (strlen(p_pcService)) && (p_pcProtocol) && (strlen(p_pcProtocol))
             && (p_u16Timeout) && (_removeLegacyServiceQuery())
             && ((pServiceQuery = _allocServiceQuery()))
@@ -785,6 +805,7 @@ MDNSResponder::installServiceQuery(const char* p_pcService, const char* p_pcProt
         if (_sendMDNSServiceQuery(*pServiceQuery)) {
             pServiceQuery->m_u8SentCount = 1;
             pServiceQuery->m_ResendTimeout.reset(MDNS_DYNAMIC_QUERY_RESEND_DELAY);
+            _schedule();
 
             hResult = (hMDNSServiceQuery)pServiceQuery;
         } else {
@@ -1116,11 +1137,12 @@ bool MDNSResponder::notifyAPChange(void) {
 /*
     MDNSResponder::update
 
-    Should be called in every 'loop'.
+    Used to be called in every 'loop'. Probing, announcing and the query cache now run from
+    'm_Timer', and received packets from the UDP context's callback, so there's nothing to do.
 
 */
 bool MDNSResponder::update(void) {
-    return _process(true);
+    return true;
 }
 
 /*
@@ -1188,7 +1210,7 @@ bool MDNSResponder::_joinMulticastGroups(void) {
                 DEBUG_EX_ERR(DEBUG_OUTPUT.printf_P(
                                  PSTR("[MDNSResponder] _createHost: igmp_joingroup_netif(" NETIFID_STR
                                       ": %s) FAILED!\n"),
-                                 NETIFID_VAL(pNetIf), IPAddress(multicast_addr_V4).toString().c_str()););
+                                 NETIFID_VAL(pNetIf), IPAddressString(IPAddress(multicast_addr_V4)).c_str()););
             }
 #endif
 
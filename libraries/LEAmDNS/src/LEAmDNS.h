@@ -52,8 +52,8 @@
     void* p_pUserdata)': Add dynamic TXT items by calling 'MDNS.addDynamicServiceTxt(p_hService,
     "c#", "1");'
 
-    In loop():
-      Call 'MDNS.update();'
+    Probing, announcing and answering run on their own, from a core SoftTimer and from the
+    UDP receive callback; 'MDNS.update();' in loop() is no longer needed (but harmless).
 
 
     For querying services:
@@ -118,6 +118,7 @@
 #include "include/UdpContext.h"
 #include <limits>
 #include <PolledTimeout.h>
+#include <TimerWheel.h>
 #include <map>
 #include <pico/time.h>
 #include "ESP8266WiFi.h"
@@ -175,6 +176,20 @@ namespace MDNSImplementation {
 */
 #define MDNS_UDPCONTEXT_TIMEOUT 50
 
+/*
+    Number of fully serialized responses (announcements, answers) kept for resending
+*/
+#ifndef MDNS_RESPONSE_CACHE_SIZE
+#define MDNS_RESPONSE_CACHE_SIZE 4
+#endif
+
+/*
+    Shortest delay between two timer driven process runs, so a failing send can't spin
+*/
+#ifndef MDNS_TIMER_MIN_DELAY
+#define MDNS_TIMER_MIN_DELAY 10
+#endif
+
 /**
     MDNSResponder
 */
@@ -186,8 +201,7 @@ public:
     virtual ~MDNSResponder(void);
 
     // Start the MDNS responder by setting the default hostname
-    // Later call MDNS::update() in every 'loop' to run the process loop
-    // (probing, announcing, responding, ...)
+    // Probing, announcing and responding then run from a timer and on packet arrival
     // if interfaceAddress is not specified, default interface is STA, or AP when STA is not set
     bool begin(const char* p_pcHostname, const IPAddress& p_IPAddress = INADDR_ANY,
                uint32_t p_u32TTL = 120 /*ignored*/);
@@ -310,6 +324,9 @@ public:
                                   int8_t p_i8Value);
 
     // Perform a (static) service query. The function returns after p_u16Timeout milliseconds
+    // If the last query was for the same service and none of its answers has reached 80% of
+    // its TTL yet, those answers are kept and returned at once (call removeQuery() first to
+    // force a new query)
     // The answers (the number of received answers is returned) can be retrieved by calling
     // - answerHostname (or hostname)
     // - answerIP (or IP)
@@ -463,7 +480,7 @@ public:
     // Application should call this whenever AP is configured/disabled
     bool notifyAPChange(void);
 
-    // 'update' should be called in every 'loop' to run the MDNS processing
+    // No longer needed, processing is timer and packet driven.  Kept for old sketches
     bool update(void);
 
     // 'announce' can be called every time, the configuration of some service
@@ -1126,6 +1143,24 @@ protected:
                                         bool        p_bAdditionalData) const;
     };
 
+    /**
+        stcMDNSResponseCacheItem
+    */
+    struct stcMDNSResponseCacheItem {
+        stcMDNSResponseCacheItem* m_pNext;
+        IPAddress                 m_IPAddress;        // Interface address the message was built for
+        uint8_t*                  m_pu8Key;           // Send flags, host and service reply masks
+        size_t                    m_stKeyLength;
+        uint8_t*                  m_pu8Message;       // The complete message, header included
+        size_t                    m_stMessageLength;
+
+        stcMDNSResponseCacheItem(IPAddress p_IPAddress, uint8_t* p_pu8Key, size_t p_stKeyLength,
+                                 uint8_t* p_pu8Message, size_t p_stMessageLength);
+        ~stcMDNSResponseCacheItem(void);
+
+        bool matches(IPAddress p_IPAddress, const uint8_t* p_pu8Key, size_t p_stKeyLength) const;
+    };
+
     // Instance variables
     stcMDNSService*                   m_pServices;
     UdpContext*                       m_pUDPContext;
@@ -1133,11 +1168,16 @@ protected:
     stcMDNSServiceQuery*              m_pServiceQueries;
     MDNSDynamicServiceTxtCallbackFunc m_fnServiceTxtCallback;
     stcProbeInformation               m_HostProbeInformation;
+    stcMDNSResponseCacheItem*         m_pResponseCache;  // Most recently used first
+    SoftTimer                         m_Timer;           // Next probe, announcement or cache check
 
     /** CONTROL **/
     /* MAINTENANCE */
     bool _process(bool p_bUserContext);
     bool _restart(void);
+    static void _timerCB(void* p_pArg);
+    bool _schedule(void);
+    uint32_t _nextTimeout(void) const;
 
     /* RECEIVING */
     bool _parseMessage(void);
@@ -1179,6 +1219,7 @@ protected:
     bool _sendMDNSMessage(stcMDNSSendParameter& p_SendParameter);
     bool _sendMDNSMessage_Multicast(MDNSResponder::stcMDNSSendParameter& p_rSendParameter);
     bool _prepareMDNSMessage(stcMDNSSendParameter& p_SendParameter, IPAddress p_IPAddress);
+    bool _composeMDNSMessage(stcMDNSSendParameter& p_SendParameter, IPAddress p_IPAddress);
     bool _sendMDNSServiceQuery(const stcMDNSServiceQuery& p_ServiceQuery);
     bool _sendMDNSQuery(const stcMDNS_RRDomain& p_QueryDomain, uint16_t p_u16QueryType,
                         stcMDNSServiceQuery::stcAnswer* p_pKnownAnswers = 0);
@@ -1294,11 +1335,18 @@ protected:
     bool                 _removeLegacyServiceQuery(void);
     stcMDNSServiceQuery* _findServiceQuery(hMDNSServiceQuery p_hServiceQuery);
     stcMDNSServiceQuery* _findLegacyServiceQuery(void);
+    bool                 _hasFreshAnswers(stcMDNSServiceQuery& p_rServiceQuery);
     bool                 _releaseServiceQueries(void);
     stcMDNSServiceQuery*
     _findNextServiceQueryByServiceType(const stcMDNS_RRDomain&    p_ServiceDomain,
                                        const stcMDNSServiceQuery* p_pPrevServiceQuery);
 
+    /* RESPONSE CACHE */
+    bool   _isCacheableMDNSMessage(const stcMDNSSendParameter& p_SendParameter) const;
+    size_t _responseCacheKey(const stcMDNSSendParameter& p_SendParameter,
+                             uint8_t*                    p_pu8Key) const;
+    bool   _clearResponseCache(void);
+
     /* HOSTNAME */
     bool _setHostname(const char* p_pcHostname);
     bool _releaseHostname(void);
@@ -28,6 +28,7 @@
 #include <lwip/ip_addr.h>
 #include <api/String.h>
 #include <cstdint>
+#include <algorithm>
 
 /*
     ESP8266mDNS Control.cpp
@@ -61,7 +62,7 @@ namespace MDNSImplementation {
 
     Run the MDNS process.
     Is called, every time the UDPContext receives data AND
-    should be called in every 'loop' by calling 'MDNS::update()'.
+    from 'm_Timer' whenever a probe, announcement or cache check is due.
 
 */
 bool MDNSResponder::_process(bool p_bUserContext) {
@@ -88,7 +89,104 @@ bool MDNSResponder::_process(bool p_bUserContext) {
 */
 bool MDNSResponder::_restart(void) {
     return ((_resetProbeStatus(true /*restart*/)) &&  // Stop and restart probing
-            (_allocUDPContext()));                    // Restart UDP
+            (_allocUDPContext()) &&                   // Restart UDP
+            (_schedule()));                           // Start probing
+}
+
+/*
+    MDNSResponder::_timerCB
+
+    'm_Timer' callback, run from the main loop between 'loop' iterations (or from the
+    TimerWheel IRQ after 'TimerWheel.begin(true)')
+*/
+void MDNSResponder::_timerCB(void* p_pArg) {
+    MDNSResponder* pThis = (MDNSResponder*)p_pArg;
+    pThis->_process(true);
+    pThis->_schedule();
+}
+
+/*
+    MDNSResponder::_schedule
+
+    (Re-)Starts 'm_Timer' for the earliest of all pending probe, announce and query
+    timeouts, or stops it when nothing is pending.
+    Must be called after anything which may have started or moved one of these timeouts.
+*/
+bool MDNSResponder::_schedule(void) {
+    uint32_t u32Timeout = _nextTimeout();
+
+    if ((!m_pUDPContext) || (esp8266::polledTimeout::oneShotMs::neverExpires == u32Timeout)) {
+        m_Timer.stop();
+    } else {
+        if (MDNS_TIMER_MIN_DELAY > u32Timeout) {
+            u32Timeout = MDNS_TIMER_MIN_DELAY;
+        }
+        m_Timer.start((uint64_t)u32Timeout * 1000);
+    }
+    return true;
+}
+
+/*
+    MDNSResponder::_nextTimeout
+
+    Milliseconds until '_updateProbeStatus' or '_checkServiceQueryCache' will have something
+    to do, or 'neverExpires'.  Mirrors the conditions checked there.
+*/
+uint32_t MDNSResponder::_nextTimeout(void) const {
+    using timeout = esp8266::polledTimeout::oneShotMs;
+    uint32_t u32Result = timeout::neverExpires;
+
+    auto probe = [&u32Result](const stcProbeInformation & p_ProbeInformation) {
+        if (ProbingStatus_ReadyToStart == p_ProbeInformation.m_ProbingStatus) {
+            u32Result = 0;
+        } else if (((ProbingStatus_InProgress == p_ProbeInformation.m_ProbingStatus)
+                    || (ProbingStatus_Done == p_ProbeInformation.m_ProbingStatus))
+                   && (p_ProbeInformation.m_Timeout.canExpire())) {
+            u32Result = std::min(u32Result, (uint32_t)p_ProbeInformation.m_Timeout.remaining());
+        }
+    };
+    auto ttl = [&u32Result](const stcMDNSServiceQuery::stcAnswer::stcTTL & p_TTL) {
+        if ((p_TTL.m_u32TTL) && (p_TTL.TIMEOUTLEVEL_UNSET != p_TTL.m_timeoutLevel)
+                && (p_TTL.m_TTLTimeout.canExpire())) {
+            u32Result = std::min(u32Result, (uint32_t)p_TTL.m_TTLTimeout.remaining());
+        }
+    };
+
+    probe(m_HostProbeInformation);
+    for (stcMDNSService* pService = m_pServices; pService; pService = pService->m_pNext) {
+        probe(pService->m_ProbeInformation);
+    }
+    for (stcMDNSServiceQuery* pServiceQuery = m_pServiceQueries; pServiceQuery;
+            pServiceQuery                      = pServiceQuery->m_pNext) {
+        if ((!pServiceQuery->m_bLegacyQuery)
+                && (MDNS_DYNAMIC_QUERY_RESEND_COUNT > pServiceQuery->m_u8SentCount)
+                && (pServiceQuery->m_ResendTimeout.canExpire())) {
+            u32Result = std::min(u32Result, (uint32_t)pServiceQuery->m_ResendTimeout.remaining());
+        }
+        if (pServiceQuery->m_bAwaitingAnswers) {
+            for (const stcMDNSServiceQuery::stcAnswer* pSQAnswer = pServiceQuery->m_pAnswers;
+                    pSQAnswer; pSQAnswer = pSQAnswer->m_pNext) {
+                ttl(pSQAnswer->m_TTLServiceDomain);
+                ttl(pSQAnswer->m_TTLHostDomainAndPort);
+                ttl(pSQAnswer->m_TTLTxts);
+#ifdef MDNS_IP4_SUPPORT
+                for (const stcMDNSServiceQuery::stcAnswer::stcIP4Address* pIP4Address
+                        = pSQAnswer->m_pIP4Addresses;
+                        pIP4Address; pIP4Address = pIP4Address->m_pNext) {
+                    ttl(pIP4Address->m_TTL);
+                }
+#endif
+#ifdef MDNS_IP6_SUPPORT
+                for (const stcMDNSServiceQuery::stcAnswer::stcIP6Address* pIP6Address
+                        = pSQAnswer->m_pIP6Addresses;
+                        pIP6Address; pIP6Address = pIP6Address->m_pNext) {
+                    ttl(pIP6Address->m_TTL);
+                }
+#endif
+            }
+        }
+    }
+    return u32Result;
 }
 
 /**
@@ -104,9 +202,9 @@ bool MDNSResponder::_parseMessage(void) {
         DEBUG_OUTPUT.printf_P(PSTR("[MDNSResponder] _parseMessage (Time: %lu ms, heap: %u "
                                    "bytes, from %s(%u), to %s(%u))\n"),
                               ulStartTime, uStartMemory,
-                              IPAddress(m_pUDPContext->getRemoteAddress()).toString().c_str(),
+                              IPAddressString(IPAddress(m_pUDPContext->getRemoteAddress())).c_str(),
                               m_pUDPContext->getRemotePort(),
-                              IPAddress(m_pUDPContext->getDestAddress()).toString().c_str(),
+                              IPAddressString(IPAddress(m_pUDPContext->getDestAddress())).c_str(),
                               m_pUDPContext->getLocalPort()););
     // DEBUG_EX_INFO(_udpDump(););
 
@@ -217,7 +315,7 @@ bool MDNSResponder::_parseQuery(const MDNSResponder::stcMDNS_MsgHeader& p_MsgHea
                          "(%s.%s.%s): 0x%X (%s)\n"),
                     (pService->m_pcName ? : m_pcHostname), pService->m_pcService,
                     pService->m_pcProtocol, u8ReplyMaskForQuestion,
-                    IPAddress(m_pUDPContext->getRemoteAddress()).toString().c_str());
+                    IPAddressString(IPAddress(m_pUDPContext->getRemoteAddress())).c_str());
                 });
 
                 // Check tiebreak need for service domain
@@ -253,7 +351,7 @@ bool MDNSResponder::_parseQuery(const MDNSResponder::stcMDNS_MsgHeader& p_MsgHea
                 sendParameter.m_bCacheFlush = false;
                 DEBUG_EX_INFO(DEBUG_OUTPUT.printf_P(
                                   PSTR("[MDNSResponder] _parseQuery: Unicast response for %s!\n"),
-                                  IPAddress(m_pUDPContext->getRemoteAddress()).toString().c_str()););
+                                  IPAddressString(IPAddress(m_pUDPContext->getRemoteAddress())).c_str()););
 
                 if ((DNS_MQUERY_PORT != m_pUDPContext->getRemotePort())
                         &&                                     // Unicast (maybe legacy) query AND
@@ -284,7 +382,7 @@ bool MDNSResponder::_parseQuery(const MDNSResponder::stcMDNS_MsgHeader& p_MsgHea
                         DEBUG_EX_RX(DEBUG_OUTPUT.printf_P(
                                         PSTR("[MDNSResponder] _parseQuery: Legacy query from local host "
                                              "%s, id %u!\n"),
-                                        IPAddress(m_pUDPContext->getRemoteAddress()).toString().c_str(),
+                                        IPAddressString(IPAddress(m_pUDPContext->getRemoteAddress())).c_str(),
                                         p_MsgHeader.m_u16ID););
 
                         sendParameter.m_u16ID        = p_MsgHeader.m_u16ID;
@@ -319,8 +417,8 @@ bool MDNSResponder::_parseQuery(const MDNSResponder::stcMDNS_MsgHeader& p_MsgHea
     // DEBUG_EX_INFO(if (u8HostOrServiceReplies) { DEBUG_OUTPUT.printf_P(PSTR("[MDNSResponder]
     // _parseQuery: Reply needed: %u (%s: %s->%s)\n"), u8HostOrServiceReplies,
     // clsTimeSyncer::timestr(),
-    // IPAddress(m_pUDPContext->getRemoteAddress()).toString().c_str(),
-    // IPAddress(m_pUDPContext->getDestAddress()).toString().c_str()); } );
+    // IPAddressString(IPAddress(m_pUDPContext->getRemoteAddress())).c_str(),
+    // IPAddressString(IPAddress(m_pUDPContext->getDestAddress())).c_str()); } );
 
     // Handle known answers
     uint32_t u32Answers
@@ -1071,7 +1169,7 @@ bool MDNSResponder::_processAAnswer(const MDNSResponder::stcMDNS_RRAnswerA* p_pA
                                       _printRRDomain(pSQAnswer->m_ServiceDomain);
                                       DEBUG_OUTPUT.printf_P(
                                           PSTR(" IP4Address (%s)\n"),
-                                          pIP4Address->m_IPAddress.toString().c_str()););
+                                          IPAddressString(pIP4Address->m_IPAddress).c_str()););
                     } else { // 'Goodbye' message for known IP4 address
                         pIP4Address->m_TTL.prepareDeletion();  // Prepare answer deletion
                         // according to RFC 6762, 10.1
@@ -1080,7 +1178,7 @@ bool MDNSResponder::_processAAnswer(const MDNSResponder::stcMDNS_RRAnswerA* p_pA
                                       _printRRDomain(pSQAnswer->m_ServiceDomain);
                                       DEBUG_OUTPUT.printf_P(
                                           PSTR(" IP4 address (%s)\n"),
-                                          pIP4Address->m_IPAddress.toString().c_str()););
+                                          IPAddressString(pIP4Address->m_IPAddress).c_str()););
                     }
                 } else {
                     // Until now unknown IP4 address -> Add (if the message isn't just a
@@ -1103,7 +1201,7 @@ bool MDNSResponder::_processAAnswer(const MDNSResponder::stcMDNS_RRAnswerA* p_pA
                             DEBUG_EX_ERR(DEBUG_OUTPUT.printf_P(
                                              PSTR("[MDNSResponder] _processAAnswer: FAILED to add IP4 "
                                                   "address (%s)!\n"),
-                                             p_pAAnswer->m_IPAddress.toString().c_str()););
+                                             IPAddressString(p_pAAnswer->m_IPAddress).c_str()););
                         }
                     }
                 }
@@ -1145,7 +1243,7 @@ bool MDNSResponder::_processAAAAAnswer(const MDNSResponder::stcMDNS_RRAnswerAAAA
                                       _printRRDomain(pSQAnswer->m_ServiceDomain);
                                       DEBUG_OUTPUT.printf_P(
                                           PSTR(" IP6 address (%s)\n"),
-                                          pIP6Address->m_IPAddress.toString().c_str()););
+                                          IPAddressString(pIP6Address->m_IPAddress).c_str()););
                     } else { // 'Goodbye' message for known IP6 address
                         pIP6Address->m_TTL.prepareDeletion();  // Prepare answer deletion
                         // according to RFC 6762, 10.1
@@ -1154,7 +1252,7 @@ bool MDNSResponder::_processAAAAAnswer(const MDNSResponder::stcMDNS_RRAnswerAAAA
                                       _printRRDomain(pSQAnswer->m_ServiceDomain);
                                       DEBUG_OUTPUT.printf_P(
                                           PSTR(" IP6 address (%s)\n"),
-                                          pIP6Address->m_IPAddress.toString().c_str()););
+                                          IPAddressString(pIP6Address->m_IPAddress).c_str()););
                     }
                 } else {
                     // Until now unknown IP6 address -> Add (if the message isn't just a
@@ -1176,7 +1274,7 @@ bool MDNSResponder::_processAAAAAnswer(const MDNSResponder::stcMDNS_RRAnswerAAAA
                             DEBUG_EX_ERR(DEBUG_OUTPUT.printf_P(
                                              PSTR("[MDNSResponder] _processAAnswer: FAILED to add IP6 "
                                                   "address (%s)!\n"),
-                                             p_pAAAAAnswer->m_IPAddress.toString().c_str()););
+                                             IPAddressString(p_pAAAAAnswer->m_IPAddress).c_str()););
                         }
                     }
                 }
@@ -1838,7 +1936,7 @@ bool MDNSResponder::_checkServiceQueryCache(void) {
                                     _printRRDomain(pSQAnswer->m_ServiceDomain);
                                     DEBUG_OUTPUT.printf_P(
                                         PSTR(" IP4 address (%s)\n"),
-                                        (pIP4Address->m_IPAddress.toString().c_str()));
+                                        (IPAddressString(pIP4Address->m_IPAddress).c_str()));
                                     printedInfo = true;);
                             }
                         } else {
@@ -1897,7 +1995,7 @@ bool MDNSResponder::_checkServiceQueryCache(void) {
                                     _printRRDomain(pSQAnswer->m_ServiceDomain);
                                     DEBUG_OUTPUT.printf_P(
                                         PSTR(" IP6 address (%s)\n"),
-                                        (pIP6Address->m_IPAddress.toString().c_str()));
+                                        (IPAddressString(pIP6Address->m_IPAddress).c_str()));
                                     printedInfo = true;);
                             }
                         } else {
@@ -135,9 +135,11 @@ namespace MDNSImplementation {
 bool MDNSResponder::_callProcess(void) {
     DEBUG_EX_INFO(
         DEBUG_OUTPUT.printf("[MDNSResponder] _callProcess (%lu, triggered by: %s)\n", millis(),
-                            IPAddress(m_pUDPContext->getRemoteAddress()).toString().c_str()););
+                            IPAddressString(IPAddress(m_pUDPContext->getRemoteAddress())).c_str()););
 
-    return _process(false);
+    bool bResult = _process(false);
+    _schedule();  // The packet may have restarted probing or refreshed some answers
+    return bResult;
 }
 
 /*
@@ -267,6 +269,23 @@ MDNSResponder::stcMDNSServiceQuery* MDNSResponder::_findLegacyServiceQuery(void)
     return pServiceQuery;
 }
 
+/*
+    MDNSResponder::_hasFreshAnswers
+
+    True, if the service query has answers and none of them has reached 80% of its TTL
+    (the point where the query cache would ask for an update).
+*/
+bool MDNSResponder::_hasFreshAnswers(MDNSResponder::stcMDNSServiceQuery& p_rServiceQuery) {
+    bool bResult = (0 != p_rServiceQuery.m_pAnswers);
+    for (stcMDNSServiceQuery::stcAnswer* pSQAnswer = p_rServiceQuery.m_pAnswers;
+            ((bResult) && (pSQAnswer)); pSQAnswer     = pSQAnswer->m_pNext) {
+        bResult = ((!pSQAnswer->m_TTLServiceDomain.flagged())
+                   && (!pSQAnswer->m_TTLHostDomainAndPort.flagged())
+                   && (!pSQAnswer->m_TTLTxts.flagged()));
+    }
+    return bResult;
+}
+
 /*
     MDNSResponder::_releaseServiceQueries
 */
@@ -298,6 +317,71 @@ MDNSResponder::stcMDNSServiceQuery* MDNSResponder::_findNextServiceQueryByServic
     return pMatchingServiceQuery;
 }
 
+/*
+    RESPONSE CACHE
+*/
+
+/*
+    MDNSResponder::_isCacheableMDNSMessage
+
+    Only responses without questions (and so without a legacy query ID) and without
+    dynamic TXT items are the same every time they are composed.
+*/
+bool MDNSResponder::_isCacheableMDNSMessage(
+    const MDNSResponder::stcMDNSSendParameter& p_SendParameter) const {
+    bool bResult = ((p_SendParameter.m_bResponse) && (!p_SendParameter.m_pQuestions)
+                    && (!p_SendParameter.m_bLegacyQuery) && (!p_SendParameter.m_u16ID)
+                    && (!m_fnServiceTxtCallback));
+    for (const stcMDNSService* pService = m_pServices; ((bResult) && (pService));
+            pService                       = pService->m_pNext) {
+        bResult = (!pService->m_fnTxtCallback);
+    }
+    return bResult;
+}
+
+/*
+    MDNSResponder::_responseCacheKey
+
+    Writes the send flags, the host reply mask and the reply mask of every service
+    (in list order) to p_pu8Key and returns the key length.
+    If p_pu8Key is 0, just the needed length is returned.
+*/
+size_t
+MDNSResponder::_responseCacheKey(const MDNSResponder::stcMDNSSendParameter& p_SendParameter,
+                                 uint8_t*                                   p_pu8Key) const {
+    size_t stLength = 2;
+    for (const stcMDNSService* pService = m_pServices; pService; pService = pService->m_pNext) {
+        ++stLength;
+    }
+    if (p_pu8Key) {
+        *p_pu8Key++ = ((p_SendParameter.m_bAuthorative ? 0x01 : 0)
+                       | (p_SendParameter.m_bCacheFlush ? 0x02 : 0)
+                       | (p_SendParameter.m_bUnicast ? 0x04 : 0)
+                       | (p_SendParameter.m_bUnannounce ? 0x08 : 0));
+        *p_pu8Key++ = p_SendParameter.m_u8HostReplyMask;
+        for (const stcMDNSService* pService = m_pServices; pService;
+                pService                       = pService->m_pNext) {
+            *p_pu8Key++ = pService->m_u8ReplyMask;
+        }
+    }
+    return stLength;
+}
+
+/*
+    MDNSResponder::_clearResponseCache
+
+    Needs to be called whenever anything a response is built from (host name, services,
+    service names or static TXT items) is changed.
+*/
+bool MDNSResponder::_clearResponseCache(void) {
+    while (m_pResponseCache) {
+        stcMDNSResponseCacheItem* pNext = m_pResponseCache->m_pNext;
+        delete m_pResponseCache;
+        m_pResponseCache = pNext;
+    }
+    return true;
+}
+
 /*
     HOSTNAME
 */
@@ -338,6 +422,7 @@ bool MDNSResponder::_setHostname(const char* p_pcHostname) {
     MDNSResponder::_releaseHostname
 */
 bool MDNSResponder::_releaseHostname(void) {
+    _clearResponseCache();
     if (m_pcHostname) {
         delete[] m_pcHostname;
         m_pcHostname = 0;
@@ -369,6 +454,7 @@ MDNSResponder::stcMDNSService* MDNSResponder::_allocService(const char* p_pcName
         // Add to list (or start list)
         pService->m_pNext = m_pServices;
         m_pServices       = pService;
+        _clearResponseCache();
     }
     return pService;
 }
@@ -380,6 +466,7 @@ bool MDNSResponder::_releaseService(MDNSResponder::stcMDNSService* p_pService) {
     bool bResult = false;
 
     if (p_pService) {
+        _clearResponseCache();
         stcMDNSService* pPred = m_pServices;
         while ((pPred) && (pPred->m_pNext != p_pService)) {
             pPred = pPred->m_pNext;
@@ -484,6 +571,9 @@ MDNSResponder::_allocServiceTxt(MDNSResponder::stcMDNSService* p_pService, const
 
             // Add to list (or start list)
             p_pService->m_Txts.add(pTxt);
+            if (!p_bTemp) {
+                _clearResponseCache();
+            }
         }
     }
     return pTxt;
@@ -494,7 +584,8 @@ MDNSResponder::_allocServiceTxt(MDNSResponder::stcMDNSService* p_pService, const
 */
 bool MDNSResponder::_releaseServiceTxt(MDNSResponder::stcMDNSService*    p_pService,
                                        MDNSResponder::stcMDNSServiceTxt* p_pTxt) {
-    return ((p_pService) && (p_pTxt) && (p_pService->m_Txts.remove(p_pTxt)));
+    return ((p_pService) && (p_pTxt) && (_clearResponseCache())
+            && (p_pService->m_Txts.remove(p_pTxt)));
 }
 
 /*
@@ -508,6 +599,9 @@ MDNSResponder::_updateServiceTxt(MDNSResponder::stcMDNSService*    p_pService,
             && (MDNS_SERVICE_TXT_MAXLENGTH
                 > (p_pService->m_Txts.length() - (p_pTxt->m_pcValue ? strlen(p_pTxt->m_pcValue) : 0)
                    + (p_pcValue ? strlen(p_pcValue) : 0)))) {
+        if ((!p_bTemp) || (!p_pTxt->m_bTemp)) {
+            _clearResponseCache();
+        }
         p_pTxt->update(p_pcValue);
         p_pTxt->m_bTemp = p_bTemp;
     }
@@ -627,7 +721,7 @@ bool MDNSResponder::_printRRAnswer(const MDNSResponder::stcMDNS_RRAnswer& p_RRAn
     case DNS_RRTYPE_A:
         DEBUG_OUTPUT.printf_P(
             PSTR("A IP:%s"),
-            ((const stcMDNS_RRAnswerA*)&p_RRAnswer)->m_IPAddress.toString().c_str());
+            IPAddressString(((const stcMDNS_RRAnswerA*)&p_RRAnswer)->m_IPAddress).c_str());
         break;
 #endif
     case DNS_RRTYPE_PTR:
@@ -648,7 +742,7 @@ bool MDNSResponder::_printRRAnswer(const MDNSResponder::stcMDNS_RRAnswer& p_RRAn
     case DNS_RRTYPE_AAAA:
         DEBUG_OUTPUT.printf_P(
             PSTR("AAAA IP:%s"),
-            ((stcMDNS_RRAnswerA*&)p_rpRRAnswer)->m_IPAddress.toString().c_str());
+            IPAddressString(((stcMDNS_RRAnswerA*&)p_rpRRAnswer)->m_IPAddress).c_str());
         break;
 #endif
     case DNS_RRTYPE_SRV:
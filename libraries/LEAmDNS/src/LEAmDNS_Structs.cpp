@@ -2026,6 +2026,47 @@ MDNSResponder::stcMDNSSendParameter::findCachedDomainOffset(const void* p_pHostn
     return (pCacheItem ? pCacheItem->m_u16Offset : 0);
 }
 
+/**
+    MDNSResponder::stcMDNSResponseCacheItem
+
+    A complete, serialized response message as it was written to the UDP output buffer.
+    It is identified by the interface address it was built for and a key made of the send
+    flags and all reply masks (see _responseCacheKey). The key and message buffers are
+    owned by the item.
+
+*/
+
+/*
+    MDNSResponder::stcMDNSResponseCacheItem::stcMDNSResponseCacheItem constructor
+*/
+MDNSResponder::stcMDNSResponseCacheItem::stcMDNSResponseCacheItem(IPAddress p_IPAddress,
+        uint8_t*  p_pu8Key,
+        size_t    p_stKeyLength,
+        uint8_t*  p_pu8Message,
+        size_t    p_stMessageLength) :
+    m_pNext(0),
+    m_IPAddress(p_IPAddress), m_pu8Key(p_pu8Key), m_stKeyLength(p_stKeyLength),
+    m_pu8Message(p_pu8Message), m_stMessageLength(p_stMessageLength) {
+}
+
+/*
+    MDNSResponder::stcMDNSResponseCacheItem::~stcMDNSResponseCacheItem destructor
+*/
+MDNSResponder::stcMDNSResponseCacheItem::~stcMDNSResponseCacheItem(void) {
+    delete[] m_pu8Key;
+    delete[] m_pu8Message;
+}
+
+/*
+    MDNSResponder::stcMDNSResponseCacheItem::matches
+*/
+bool MDNSResponder::stcMDNSResponseCacheItem::matches(IPAddress      p_IPAddress,
+        const uint8_t* p_pu8Key,
+        size_t         p_stKeyLength) const {
+    return ((m_IPAddress == p_IPAddress) && (m_stKeyLength == p_stKeyLength)
+            && (0 == memcmp(m_pu8Key, p_pu8Key, p_stKeyLength)));
+}
+
 }  // namespace MDNSImplementation
 
 }  // namespace esp8266
@@ -128,7 +128,7 @@ MDNSResponder::_sendMDNSMessage_Multicast(MDNSResponder::stcMDNSSendParameter& p
 #endif
             DEBUG_EX_INFO(DEBUG_OUTPUT.printf_P(
                               PSTR("[MDNSResponder] _sendMDNSMessage_Multicast: Will send to '%s'.\n"),
-                              toMulticastAddress.toString().c_str()););
+                              IPAddressString(toMulticastAddress).c_str()););
             bResult = ((_prepareMDNSMessage(p_rSendParameter, fromIPAddress))
                        && (m_pUDPContext->sendTimeout(toMulticastAddress, DNS_MQUERY_PORT,
                                MDNS_UDPCONTEXT_TIMEOUT)));
@@ -145,15 +145,87 @@ MDNSResponder::_sendMDNSMessage_Multicast(MDNSResponder::stcMDNSSendParameter& p
 /*
     MDNSResponder::_prepareMDNSMessage
 
+    Fills the UDP output buffer with the message described by p_rSendParameter.
+    Plain multicast responses (announcements and answers without questions) only depend
+    on the reply masks, the send flags and the interface address, so they are kept fully
+    serialized and simply copied into the output buffer the next time the same message
+    is needed. The cache is cleared whenever the host or service setup changes
+    (see _clearResponseCache).
+
+*/
+bool MDNSResponder::_prepareMDNSMessage(MDNSResponder::stcMDNSSendParameter& p_rSendParameter,
+                                        IPAddress                            p_IPAddress) {
+    uint8_t* pu8Key      = 0;
+    size_t   stKeyLength = 0;
+    if ((!_isCacheableMDNSMessage(p_rSendParameter)) || (m_pUDPContext->getTxSize())
+            || (!(stKeyLength = _responseCacheKey(p_rSendParameter, 0)))
+            || (0 == (pu8Key = new uint8_t[stKeyLength]))) {
+        return _composeMDNSMessage(p_rSendParameter, p_IPAddress);
+    }
+    _responseCacheKey(p_rSendParameter, pu8Key);
+
+    stcMDNSResponseCacheItem* pPred = 0;
+    stcMDNSResponseCacheItem* pItem = m_pResponseCache;
+    while ((pItem) && (!pItem->matches(p_IPAddress, pu8Key, stKeyLength))) {
+        pPred = pItem;
+        pItem = pItem->m_pNext;
+    }
+    if (pItem) {  // Cache hit -> move to front and resend
+        delete[] pu8Key;
+        if (pPred) {
+            pPred->m_pNext   = pItem->m_pNext;
+            pItem->m_pNext   = m_pResponseCache;
+            m_pResponseCache = pItem;
+        }
+        p_rSendParameter.clearCachedNames();
+        bool bResult = _udpAppendBuffer(pItem->m_pu8Message, pItem->m_stMessageLength);
+        p_rSendParameter.m_u16Offset = (bResult ? pItem->m_stMessageLength : 0);
+        DEBUG_EX_INFO(DEBUG_OUTPUT.printf_P(
+                          PSTR("[MDNSResponder] _prepareMDNSMessage: Reused %u cached bytes\n"),
+                          (unsigned)pItem->m_stMessageLength););
+        return bResult;
+    }
+
+    bool     bResult    = _composeMDNSMessage(p_rSendParameter, p_IPAddress);
+    size_t   stLength   = m_pUDPContext->getTxSize();
+    uint8_t* pu8Message = 0;
+    if ((bResult) && (stLength) && (0 != (pu8Message = new uint8_t[stLength]))
+            && (stLength == m_pUDPContext->copyTxBuffer(pu8Message, stLength))
+            && (0 != (pItem = new stcMDNSResponseCacheItem(p_IPAddress, pu8Key, stKeyLength,
+                              pu8Message, stLength)))) {
+        pItem->m_pNext   = m_pResponseCache;
+        m_pResponseCache = pItem;
+
+        // Drop the least recently used ones
+        size_t stCount = 1;
+        while ((pItem->m_pNext) && (MDNS_RESPONSE_CACHE_SIZE > stCount)) {
+            pItem = pItem->m_pNext;
+            ++stCount;
+        }
+        while (pItem->m_pNext) {
+            stcMDNSResponseCacheItem* pNext = pItem->m_pNext->m_pNext;
+            delete pItem->m_pNext;
+            pItem->m_pNext = pNext;
+        }
+    } else {
+        delete[] pu8Message;
+        delete[] pu8Key;
+    }
+    return bResult;
+}
+
+/*
+    MDNSResponder::_composeMDNSMessage
+
     The MDNS message is composed in a two-step process.
     In the first loop 'only' the header information (mainly number of answers) are collected,
     while in the seconds loop, the header and all queries and answers are written to the UDP
     output buffer.
 
 */
-bool MDNSResponder::_prepareMDNSMessage(MDNSResponder::stcMDNSSendParameter& p_rSendParameter,
+bool MDNSResponder::_composeMDNSMessage(MDNSResponder::stcMDNSSendParameter& p_rSendParameter,
                                         IPAddress                            p_IPAddress) {
-    DEBUG_EX_INFO(DEBUG_OUTPUT.printf_P(PSTR("[MDNSResponder] _prepareMDNSMessage\n")););
+    DEBUG_EX_INFO(DEBUG_OUTPUT.printf_P(PSTR("[MDNSResponder] _composeMDNSMessage\n")););
     bool bResult = true;
     p_rSendParameter.clearCachedNames();  // Need to remove cached names, p_SendParameter might
     // have been used before on other interface
@@ -508,7 +580,7 @@ bool MDNSResponder::_readRRAnswer(MDNSResponder::stcMDNS_RRAnswer*& p_rpRRAnswer
             case DNS_RRTYPE_A:
                 DEBUG_OUTPUT.printf_P(
                     PSTR("A IP:%s"),
-                    ((stcMDNS_RRAnswerA*&)p_rpRRAnswer)->m_IPAddress.toString().c_str());
+                    IPAddressString(((stcMDNS_RRAnswerA*&)p_rpRRAnswer)->m_IPAddress).c_str());
                 break;
 #endif
             case DNS_RRTYPE_PTR:
@@ -530,7 +602,7 @@ bool MDNSResponder::_readRRAnswer(MDNSResponder::stcMDNS_RRAnswer*& p_rpRRAnswer
             case DNS_RRTYPE_AAAA:
                 DEBUG_OUTPUT.printf_P(
                     PSTR("AAAA IP:%s"),
-                    ((stcMDNS_RRAnswerA*&)p_rpRRAnswer)->m_IPAddress.toString().c_str());
+                    IPAddressString(((stcMDNS_RRAnswerA*&)p_rpRRAnswer)->m_IPAddress).c_str());
                 break;
 #endif
             case DNS_RRTYPE_SRV:
@@ -1419,7 +1491,7 @@ bool MDNSResponder::_writeMDNSQuestion(MDNSResponder::stcMDNS_RRQuestion&   p_Qu
 bool MDNSResponder::_writeMDNSAnswer_A(IPAddress                            p_IPAddress,
                                        MDNSResponder::stcMDNSSendParameter& p_rSendParameter) {
     DEBUG_EX_INFO(DEBUG_OUTPUT.printf_P(PSTR("[MDNSResponder] _writeMDNSAnswer_A (%s)\n"),
-                                        p_IPAddress.toString().c_str()););
+                                        IPAddressString(p_IPAddress).c_str()););
 
     stcMDNS_RRAttributes attributes(DNS_RRTYPE_A,
                                     ((p_rSendParameter.m_bCacheFlush ? 0x8000 : 0)
@@ -1454,7 +1526,7 @@ bool
 MDNSResponder::_writeMDNSAnswer_PTR_IP4(IPAddress                            p_IPAddress,
                                         MDNSResponder::stcMDNSSendParameter& p_rSendParameter) {
     DEBUG_EX_INFO(DEBUG_OUTPUT.printf_P(PSTR("[MDNSResponder] _writeMDNSAnswer_PTR_IP4 (%s)\n"),
-                                        p_IPAddress.toString().c_str()););
+                                        IPAddressString(p_IPAddress).c_str()););
 
     stcMDNS_RRDomain     reverseIP4Domain;
     stcMDNS_RRAttributes attributes(DNS_RRTYPE_PTR,
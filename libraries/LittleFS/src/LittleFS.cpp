@@ -26,6 +26,8 @@
 #include "LittleFS.h"
 #include <hardware/flash.h>
 #include <hardware/sync.h>
+#include <hardware/dma.h>
+#include <hardware/structs/xip_ctrl.h>
 
 #ifdef USE_TINYUSB
 // For Serial when selecting TinyUSB.  Can't include in the core because Arduino IDE
@@ -57,6 +59,7 @@ FileImplPtr LittleFSImpl::open(const char* path, OpenMode openMode, AccessMode a
 
     int flags = _getFlags(openMode, accessMode);
     auto fd = std::make_shared<lfs_file_t>();
+    lfs_info info;
 
     if ((openMode & OM_CREATE) && strchr(path, '/')) {
         // For file creation, silently make subdirs as needed.  If any fail,
@@ -75,11 +78,27 @@ FileImplPtr LittleFSImpl::open(const char* path, OpenMode openMode, AccessMode a
         free(pathStr);
     }
 
+    // Compression is chosen when a file is created or truncated, and otherwise follows
+    // the file.  A compressed file can be read or written, but not both at once.
+    uint32_t zsize = 0;
+    bool exists = lfs_stat(&_lfs, path, &info) == 0;
+    bool wasCompressed = exists && (lfs_getattr(&_lfs, path, LFSZ_ATTR, &zsize, sizeof(zsize)) == sizeof(zsize));
+    bool fresh = !exists || (openMode & OM_TRUNCATE);
+    bool compressed = fresh ? (openMode & OM_COMPRESS) : wasCompressed;
+    if (compressed && (accessMode == AM_RW)) {
+        DEBUGV("LittleFSImpl::open() compressed files can't be opened read/write\n");
+        return FileImplPtr();
+    }
+    if (compressed && (openMode & OM_APPEND)) {
+        flags |= LFS_O_RDONLY; // To reload the last block
+    }
+
+    int slot = _takeFileBuffer();
     time_t creation = 0;
     if (_timeCallback && (openMode & OM_CREATE)) {
         // O_CREATE means we *may* make the file, but not if it already exists.
         // See if it exists, and only if not update the creation time
-        int rc = lfs_file_open(&_lfs, fd.get(), path, LFS_O_RDONLY);
+        int rc = _fileOpen(fd.get(), path, LFS_O_RDONLY, slot);
         if (rc == 0) {
             lfs_file_close(&_lfs, fd.get()); // It exists, don't update create time
         } else {
@@ -87,15 +106,33 @@ FileImplPtr LittleFSImpl::open(const char* path, OpenMode openMode, AccessMode a
         }
     }
 
-    int rc = lfs_file_open(&_lfs, fd.get(), path, flags);
+    int rc = _fileOpen(fd.get(), path, flags, slot);
     if (rc == LFS_ERR_ISDIR) {
         // To support the SD.openNextFile, a null FD indicates to the LittleFSFile this is just
         // a directory whose name we are carrying around but which cannot be read or written
+        _releaseFileBuffer(slot);
         return std::make_shared<LittleFSFileImpl>(this, path, nullptr, flags, creation);
     } else if (rc == 0) {
         lfs_file_sync(&_lfs, fd.get());
-        return std::make_shared<LittleFSFileImpl>(this, path, fd, flags, creation);
+        std::shared_ptr<LittleFSZFile> z;
+        if (compressed) {
+            if (fresh) {
+                zsize = 0;
+                lfs_setattr(&_lfs, path, LFSZ_ATTR, &zsize, sizeof(zsize));
+            }
+            z = std::make_shared<LittleFSZFile>(&_lfs, fd.get(), accessMode & AM_WRITE, zsize);
+            if (!z->begin(openMode & OM_APPEND)) {
+                DEBUGV("LittleFSImpl::open() unable to start compressed file `%s`\n", path);
+                lfs_file_close(&_lfs, fd.get());
+                _releaseFileBuffer(slot);
+                return FileImplPtr();
+            }
+        } else if (wasCompressed && fresh) {
+            lfs_removeattr(&_lfs, path, LFSZ_ATTR); // Rewritten uncompressed
+        }
+        return std::make_shared<LittleFSFileImpl>(this, path, fd, flags, creation, slot, z);
     } else {
+        _releaseFileBuffer(slot);
         DEBUGV("LittleFSDirImpl::openFile: rc=%d fd=%p path=`%s` openMode=%d accessMode=%d err=%d\n",
                rc, fd.get(), path, openMode, accessMode, rc);
         return FileImplPtr();
@@ -170,11 +207,252 @@ DirImplPtr LittleFSImpl::openDir(const char *path) {
     return ret;
 }
 
+// Reads at least this large skip the XIP cache, so streaming a big file doesn't evict the
+// code that's running.  Smaller ones are mostly metadata, which is worth caching.
+#ifndef LITTLEFS_UNCACHED_READ
+#define LITTLEFS_UNCACHED_READ 1024
+#endif
+
+// The allocation hint is an attribute on the root directory: this header, then a bitmap of
+// the blocks in use covering the first lookahead window.  It's removed again as soon as it
+// has been read at mount, so it can't go stale however the filesystem is changed after that.
+#define LFS_ALLOC_HINT_ATTR 'a'
+#define LFS_ALLOC_HINT_MAGIC 0x4841464c // LFAH
+
+// The hint is loaded straight into the allocator's private lookahead state, which littlefs
+// 2.9 renamed (free to lookahead, and off/i/ack to start/next/ckpoint).  Anything newer
+// must be checked by hand before these are extended to it.
+#if LFS_VERSION < 0x00020009
+static inline uint8_t *_laBuffer(lfs_t *lfs) {
+    return (uint8_t *)lfs->free.buffer;
+}
+static inline lfs_block_t &_laStart(lfs_t *lfs) {
+    return lfs->free.off;
+}
+static inline lfs_block_t &_laSize(lfs_t *lfs) {
+    return lfs->free.size;
+}
+static inline lfs_block_t &_laNext(lfs_t *lfs) {
+    return lfs->free.i;
+}
+static inline lfs_block_t &_laCkpoint(lfs_t *lfs) {
+    return lfs->free.ack;
+}
+#elif LFS_VERSION < 0x0002000a
+static inline uint8_t *_laBuffer(lfs_t *lfs) {
+    return (uint8_t *)lfs->lookahead.buffer;
+}
+static inline lfs_block_t &_laStart(lfs_t *lfs) {
+    return lfs->lookahead.start;
+}
+static inline lfs_block_t &_laSize(lfs_t *lfs) {
+    return lfs->lookahead.size;
+}
+static inline lfs_block_t &_laNext(lfs_t *lfs) {
+    return lfs->lookahead.next;
+}
+static inline lfs_block_t &_laCkpoint(lfs_t *lfs) {
+    return lfs->lookahead.ckpoint;
+}
+#else
+#error "Unknown littlefs lookahead layout, update the _la*() accessors in LittleFS.cpp"
+#endif
+
+typedef struct {
+    uint32_t magic;
+    uint32_t blockCount;
+    uint32_t lookaheadSize;
+    uint32_t crc;
+} LFSAllocHint;
+
+typedef struct {
+    uint8_t *map;
+    uint32_t bits;
+} LFSAllocMap;
+
+static int _allocMark(void *data, lfs_block_t block) {
+    LFSAllocMap *m = (LFSAllocMap *)data;
+    if (block < m->bits) {
+        m->map[block / 8] |= 1 << (block % 8);
+    }
+    return 0;
+}
+
+// Walks every file for the blocks in use, just like the allocator's own scan
+bool LittleFSImpl::_allocMap(uint8_t *map) {
+    LFSAllocMap m = { map, std::min(8 * _lfs_cfg.lookahead_size, _lfs_cfg.block_count) };
+    memset(map, 0, _lfs_cfg.lookahead_size);
+    return lfs_fs_traverse(&_lfs, _allocMark, &m) >= 0;
+}
+
+void LittleFSImpl::_saveAllocHint() {
+    size_t len = sizeof(LFSAllocHint) + _lfs_cfg.lookahead_size;
+    uint8_t *buf = (uint8_t *)malloc(len);
+    uint8_t *check = (uint8_t *)malloc(_lfs_cfg.lookahead_size);
+    bool ok = buf && check && _allocMap(buf + sizeof(LFSAllocHint));
+    LFSAllocHint *h = (LFSAllocHint *)buf;
+    uint8_t *map = buf + sizeof(LFSAllocHint);
+    // Storing the hint can itself take a block, if the root directory has to be split
+    for (int tries = 0; ok && (tries < 3); tries++) {
+        h->magic = LFS_ALLOC_HINT_MAGIC;
+        h->blockCount = _lfs_cfg.block_count;
+        h->lookaheadSize = _lfs_cfg.lookahead_size;
+        h->crc = lfs_crc(0xffffffff, map, _lfs_cfg.lookahead_size);
+        ok = (lfs_setattr(&_lfs, "/", LFS_ALLOC_HINT_ATTR, buf, len) == 0) && _allocMap(check);
+        if (ok && !memcmp(map, check, _lfs_cfg.lookahead_size)) {
+            free(check);
+            free(buf);
+            return;
+        }
+        memcpy(map, check, _lfs_cfg.lookahead_size);
+    }
+    DEBUGV("LittleFS: Unable to save allocation hint\n");
+    lfs_removeattr(&_lfs, "/", LFS_ALLOC_HINT_ATTR);
+    free(check);
+    free(buf);
+}
+
+// Loads the allocator's lookahead state directly instead of letting the first allocation
+// scan for it, through the _la*() accessors above.
+void LittleFSImpl::_loadAllocHint() {
+    size_t len = sizeof(LFSAllocHint) + _lfs_cfg.lookahead_size;
+    uint8_t *buf = (uint8_t *)malloc(len);
+    if (!buf) {
+        return;
+    }
+    LFSAllocHint *h = (LFSAllocHint *)buf;
+    const uint8_t *map = buf + sizeof(LFSAllocHint);
+    lfs_ssize_t r = lfs_getattr(&_lfs, "/", LFS_ALLOC_HINT_ATTR, buf, len);
+    if ((r == (lfs_ssize_t)len) && (h->magic == LFS_ALLOC_HINT_MAGIC) && (h->blockCount == _lfs_cfg.block_count) &&
+            (h->lookaheadSize == _lfs_cfg.lookahead_size) && (h->crc == lfs_crc(0xffffffff, map, _lfs_cfg.lookahead_size))) {
+        uint32_t bits = std::min(8 * _lfs_cfg.lookahead_size, _lfs_cfg.block_count);
+        uint8_t *la = _laBuffer(&_lfs);
+        memset(la, 0, _lfs_cfg.lookahead_size);
+        if (bits == _lfs_cfg.block_count) {
+            // The bitmap covers everything, so keep the randomized starting point littlefs
+            // picked at mount to spread wear, rotating the bitmap to match
+            for (uint32_t i = 0; i < bits; i++) {
+                uint32_t b = (_laStart(&_lfs) + i) % bits;
+                if (map[b / 8] & (1 << (b % 8))) {
+                    la[i / 8] |= 1 << (i % 8);
+                }
+            }
+        } else {
+            _laStart(&_lfs) = 0;
+            memcpy(la, map, _lfs_cfg.lookahead_size);
+        }
+        _laSize(&_lfs) = bits;
+        _laNext(&_lfs) = 0;
+        _laCkpoint(&_lfs) = _lfs_cfg.block_count;
+    }
+    if (r >= 0) {
+        // Used up either way, nothing after this point is reflected in it
+        lfs_removeattr(&_lfs, "/", LFS_ALLOC_HINT_ATTR);
+    }
+    free(buf);
+}
+
+// Erases free blocks in the order the allocator will hand them out, so the next writes find
+// them ready and lfs_flash_erase has nothing to do.  Finds that order with the same
+// version-checked _la*() accessors as the allocation hint.
+bool LittleFSImpl::gc(uint32_t budgetUs) {
+    if (!_mounted) {
+        return false;
+    }
+    uint64_t start = time_us_64();
+#if defined(LFS_VERSION) && (LFS_VERSION >= 0x00020008)
+    // Fills the lookahead buffer, and compacts metadata pairs where littlefs supports it
+    int rc = lfs_fs_gc(&_lfs);
+    if (rc < 0) {
+        DEBUGV("lfs_fs_gc: rc=%d\n", rc);
+        return false;
+    }
+#endif
+    uint32_t mapSize = (_lfs_cfg.block_count + 7) / 8;
+    if (!_erased) {
+        _erased = (uint8_t *)calloc(mapSize, 1);
+    }
+    uint8_t *used = (uint8_t *)calloc(mapSize, 1);
+    LFSAllocMap m = { used, _lfs_cfg.block_count };
+    if (!_erased || !used || (lfs_fs_traverse(&_lfs, _allocMark, &m) < 0)) {
+        free(used);
+        return false;
+    }
+    lfs_block_t first = (_laStart(&_lfs) + _laNext(&_lfs)) % _lfs_cfg.block_count;
+    bool ok = true;
+    for (lfs_block_t i = 0; ok && (i < _lfs_cfg.block_count); i++) {
+        lfs_block_t block = (first + i) % _lfs_cfg.block_count;
+        if ((used[block / 8] & (1 << (block % 8))) || _isErased(block)) {
+            continue;
+        }
+        uint64_t now = time_us_64();
+        if (budgetUs && ((now - start) + _eraseUs > budgetUs)) {
+            break;
+        }
+        uint8_t *addr = _start + (block * _blockSize);
+        PROFILE_CORE_SCOPE("LittleFS gc erase");
+        ok = __flashErase((intptr_t)addr - (intptr_t)XIP_BASE, _blockSize);
+        _eraseUs = time_us_64() - now;
+        _setErased(block, ok);
+    }
+    free(used);
+    return ok;
+}
+
+static int _streamChan = -2; // Not claimed yet
+static volatile bool _streamBusy = false;
+static spin_lock_t *_streamLock = spin_lock_instance(next_striped_spin_lock_num());
+
+// There is only one XIP stream, so concurrent readers (the other core, or a sketch's IRQ)
+// fall back to the uncached alias
+static bool _streamClaim() {
+    uint32_t irqs = spin_lock_blocking(_streamLock);
+    bool ok = !_streamBusy && (_streamChan != -1);
+    if (ok) {
+        _streamBusy = true;
+    }
+    spin_unlock(_streamLock, irqs);
+    if (ok && (_streamChan == -2)) {
+        _streamChan = dma_claim_unused_channel(false);
+        if (_streamChan < 0) {
+            _streamChan = -1;
+            _streamBusy = false;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// The XIP stream fetches flash in the background, without touching the cache, and DMA
+// drains its FIFO into the destination
+static void _streamRead(void *dst, const uint8_t *src, size_t words) {
+    while (!(xip_ctrl_hw->stat & XIP_STAT_FIFO_EMPTY_BITS)) {
+        (void) xip_ctrl_hw->stream_fifo;
+    }
+    xip_ctrl_hw->stream_addr = (uint32_t)src;
+    xip_ctrl_hw->stream_ctr = words;
+    dma_channel_config c = dma_channel_get_default_config(_streamChan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, DREQ_XIP_STREAM);
+    dma_channel_configure(_streamChan, &c, dst, (const void *)XIP_AUX_BASE, words, true);
+    dma_channel_wait_for_finish_blocking(_streamChan);
+    _streamBusy = false;
+}
+
 int LittleFSImpl::lfs_flash_read(const struct lfs_config *c,
                                  lfs_block_t block, lfs_off_t off, void *dst, lfs_size_t size) {
     LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
-    //    Serial.printf(" READ: %p, %d\n", me->_start + (block * me->_blockSize) + off, size);
-    memcpy(dst, me->_start + (block * me->_blockSize) + off, size);
+    const uint8_t *src = me->_start + (block * me->_blockSize) + off;
+    //    Serial.printf(" READ: %p, %d\n", src, size);
+    if (size < LITTLEFS_UNCACHED_READ) {
+        memcpy(dst, src, size);
+    } else if (!(((intptr_t)src | (intptr_t)dst | size) & 3) && _streamClaim()) {
+        _streamRead(dst, src, size / 4);
+    } else {
+        memcpy(dst, src - XIP_BASE + XIP_NOCACHE_NOALLOC_BASE, size);
+    }
     return 0;
 }
 
@@ -182,25 +460,22 @@ int LittleFSImpl::lfs_flash_prog(const struct lfs_config *c,
                                  lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size) {
     LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
     uint8_t *addr = me->_start + (block * me->_blockSize) + off;
-    noInterrupts();
-    rp2040.idleOtherCore();
+    PROFILE_CORE_SCOPE("LittleFS flash program");
+    me->_setErased(block, false);
     //    Serial.printf("WRITE: %p, $d\n", (intptr_t)addr - (intptr_t)XIP_BASE, size);
-    flash_range_program((intptr_t)addr - (intptr_t)XIP_BASE, (const uint8_t *)buffer, size);
-    rp2040.resumeOtherCore();
-    interrupts();
-    return 0;
+    return __flashProgram((intptr_t)addr - (intptr_t)XIP_BASE, buffer, size) ? 0 : LFS_ERR_IO;
 }
 
 int LittleFSImpl::lfs_flash_erase(const struct lfs_config *c, lfs_block_t block) {
     LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
+    if (me->_isErased(block)) {
+        me->_setErased(block, false); // Done ahead of time by gc()
+        return 0;
+    }
     uint8_t *addr = me->_start + (block * me->_blockSize);
     //    Serial.printf("ERASE: %p, %d\n", (intptr_t)addr - (intptr_t)XIP_BASE, me->_blockSize);
-    noInterrupts();
-    rp2040.idleOtherCore();
-    flash_range_erase((intptr_t)addr - (intptr_t)XIP_BASE, me->_blockSize);
-    rp2040.resumeOtherCore();
-    interrupts();
-    return 0;
+    PROFILE_CORE_SCOPE("LittleFS flash erase");
+    return __flashErase((intptr_t)addr - (intptr_t)XIP_BASE, me->_blockSize) ? 0 : LFS_ERR_IO;
 }
 
 int LittleFSImpl::lfs_flash_sync(const struct lfs_config *c) {
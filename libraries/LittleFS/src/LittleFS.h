@@ -31,6 +31,15 @@
 
 #define LFS_NAME_MAX 32
 #include "../lib/littlefs/lfs.h"
+#include "LittleFSZ.h"
+
+// In lfs.c
+extern "C" lfs_ssize_t lfs_dir_lastattr(lfs_t *lfs, lfs_dir_t *dir, uint8_t type, void *buffer, lfs_size_t size);
+
+// Expected time for one 4K erase, until gc() has timed a real one
+#ifndef LITTLEFS_ERASE_US
+#define LITTLEFS_ERASE_US 50000
+#endif
 
 using namespace fs;
 
@@ -42,7 +51,42 @@ class LittleFSDirImpl;
 class LittleFSConfig : public FSConfig {
 public:
     static constexpr uint32_t FSId = 0x4c495454;
-    LittleFSConfig(bool autoFormat = true) : FSConfig(FSId, autoFormat) { }
+    LittleFSConfig(bool autoFormat = true) : FSConfig(FSId, autoFormat), _cacheSize(256), _lookaheadSize(0), _staticFileBuffers(false), _allocHint(false) { }
+
+    LittleFSConfig setAutoFormat(bool val = true) {
+        _autoFormat = val;
+        return *this;
+    }
+    // Read and program caches, and the per-file cache, in bytes.  A multiple of 256 up to the
+    // 4K erase block.  Larger caches turn sequential writes into fewer, larger programs.
+    LittleFSConfig setCacheSize(uint32_t size) {
+        _cacheSize = size;
+        return *this;
+    }
+    // Free block bitmap, in bytes (a multiple of 8).  0 sizes it to cover every block.
+    LittleFSConfig setLookaheadSize(uint32_t size) {
+        _lookaheadSize = size;
+        return *this;
+    }
+    // Allocate a cache for each of the maximum open files at mount time, instead of
+    // from the heap in every open()
+    LittleFSConfig setStaticFileBuffers(bool val = true) {
+        _staticFileBuffers = val;
+        return *this;
+    }
+
+    // Save the free block bitmap on end() and use it on the next begin(), so the first write
+    // after mounting doesn't have to walk every file to find free blocks
+    LittleFSConfig setAllocHint(bool val = true) {
+        _allocHint = val;
+        return *this;
+    }
+
+    // Inherit _type and _autoFormat
+    uint32_t _cacheSize;
+    uint32_t _lookaheadSize;
+    bool     _staticFileBuffers;
+    bool     _allocHint;
 };
 
 class LittleFSImpl : public FSImpl {
@@ -70,12 +114,19 @@ public:
         _lfs_cfg.name_max = 0;
         _lfs_cfg.file_max = 0;
         _lfs_cfg.attr_max = 0;
+        _fileBuffers = nullptr;
+        _fileConfigs = nullptr;
+        _fileBuffersUsed = 0;
+        _erased = nullptr;
+        _eraseUs = LITTLEFS_ERASE_US;
     }
 
     ~LittleFSImpl() {
         if (_mounted) {
             lfs_unmount(&_lfs);
         }
+        _freeFileBuffers();
+        free(_erased);
     }
 
     FileImplPtr open(const char* path, OpenMode openMode, AccessMode accessMode) override;
@@ -181,6 +232,7 @@ public:
             DEBUGV("LittleFS size is <= zero");
             return false;
         }
+        _applyConfig();
         if (_tryMount()) {
             return true;
         }
@@ -194,10 +246,19 @@ public:
         if (!_mounted) {
             return;
         }
+        if (_cfg._allocHint) {
+            _saveAllocHint();
+        }
         lfs_unmount(&_lfs);
         _mounted = false;
+        _freeFileBuffers();
+        // The flash may be used some other way (USBMSCFlashDisk) until the next begin()
+        free(_erased);
+        _erased = nullptr;
     }
 
+    bool gc(uint32_t budgetUs) override;
+
     bool format() override {
         if (_size == 0) {
             DEBUGV("lfs size is zero\n");
@@ -275,10 +336,92 @@ protected:
         int rc = lfs_mount(&_lfs, &_lfs_cfg);
         if (rc == 0) {
             _mounted = true;
+            if (_cfg._allocHint) {
+                _loadAllocHint();
+            }
         }
         return _mounted;
     }
 
+    bool _allocMap(uint8_t *map);
+    void _saveAllocHint();
+    void _loadAllocHint();
+
+    bool _isErased(lfs_block_t block) const {
+        return _erased && (_erased[block / 8] & (1 << (block % 8)));
+    }
+    void _setErased(lfs_block_t block, bool erased) {
+        if (!_erased) {
+            return;
+        } else if (erased) {
+            _erased[block / 8] |= 1 << (block % 8);
+        } else {
+            _erased[block / 8] &= ~(1 << (block % 8));
+        }
+    }
+
+    // Called before mounting, to size the caches from the LittleFSConfig
+    void _applyConfig() {
+        uint32_t cache = _cfg._cacheSize;
+        if (!cache || (cache % _lfs_cfg.prog_size) || (_blockSize % cache)) {
+            DEBUGV("LittleFS cache size %u invalid, using %u\n", cache, _lfs_cfg.prog_size);
+            cache = _lfs_cfg.prog_size;
+        }
+        uint32_t lookahead = _cfg._lookaheadSize;
+        if (!lookahead) {
+            lookahead = (_lfs_cfg.block_count + 7) / 8;
+        }
+        lookahead = std::max((lookahead + 7) & ~7, (uint32_t)8);
+        _lfs_cfg.cache_size = cache;
+        _lfs_cfg.lookahead_size = lookahead;
+
+        _freeFileBuffers();
+        if (_cfg._staticFileBuffers && _maxOpenFds) {
+            _fileBuffers = (uint8_t *)malloc(_maxOpenFds * cache);
+            _fileConfigs = (lfs_file_config *)calloc(_maxOpenFds, sizeof(lfs_file_config));
+            if (!_fileBuffers || !_fileConfigs) {
+                _freeFileBuffers(); // Just use the heap on every open()
+            }
+        }
+    }
+
+    // Returns a preallocated file cache slot, or -1 to have LittleFS allocate one
+    int _takeFileBuffer() {
+        if (!_fileBuffers) {
+            return -1;
+        }
+        for (uint32_t i = 0; (i < _maxOpenFds) && (i < 32); i++) {
+            if (!(_fileBuffersUsed & (1UL << i))) {
+                _fileBuffersUsed |= 1UL << i;
+                memset(&_fileConfigs[i], 0, sizeof(_fileConfigs[i]));
+                _fileConfigs[i].buffer = _fileBuffers + i * _lfs_cfg.cache_size;
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void _releaseFileBuffer(int slot) {
+        if (slot >= 0) {
+            _fileBuffersUsed &= ~(1UL << slot);
+        }
+    }
+
+    int _fileOpen(lfs_file_t *fd, const char *path, int flags, int slot) {
+        if (slot < 0) {
+            return lfs_file_open(&_lfs, fd, path, flags);
+        }
+        return lfs_file_opencfg(&_lfs, fd, path, flags, &_fileConfigs[slot]);
+    }
+
+    void _freeFileBuffers() {
+        free(_fileBuffers);
+        free(_fileConfigs);
+        _fileBuffers = nullptr;
+        _fileConfigs = nullptr;
+        _fileBuffersUsed = 0;
+    }
+
     int _getUsedBlocks() {
         if (!_mounted) {
             return 0;
@@ -345,13 +488,22 @@ protected:
     uint32_t _blockSize;
     uint32_t _maxOpenFds;
 
+    // Optional preallocated per-file caches
+    uint8_t         *_fileBuffers;
+    lfs_file_config *_fileConfigs;
+    uint32_t         _fileBuffersUsed;
+
+    // Blocks gc() has erased ahead of time, one bit each, so lfs_flash_erase can skip them
+    uint8_t *_erased;
+    uint32_t _eraseUs;  // Time the last erase took, to fit gc() into its budget
+
     bool     _mounted;
 };
 
 
 class LittleFSFileImpl : public FileImpl {
 public:
-    LittleFSFileImpl(LittleFSImpl* fs, const char *name, std::shared_ptr<lfs_file_t> fd, int flags, time_t creation) : _fs(fs), _fd(fd), _opened(true), _flags(flags), _creation(creation) {
+    LittleFSFileImpl(LittleFSImpl* fs, const char *name, std::shared_ptr<lfs_file_t> fd, int flags, time_t creation, int bufferSlot = -1, std::shared_ptr<LittleFSZFile> z = nullptr) : _fs(fs), _fd(fd), _opened(true), _flags(flags), _creation(creation), _bufferSlot(bufferSlot), _z(z) {
         _name = std::shared_ptr<char>(new char[strlen(name) + 1], std::default_delete<char[]>());
         strcpy(_name.get(), name);
     }
@@ -366,6 +518,9 @@ public:
         if (!_opened || !_fd || !buf) {
             return 0;
         }
+        if (_z) {
+            return _z->write(buf, size);
+        }
         int result = lfs_file_write(_fs->getFS(), _getFD(), (void*) buf, size);
         if (result < 0) {
             DEBUGV("lfs_write rc=%d\n", result);
@@ -378,6 +533,9 @@ public:
         if (!_opened || !_fd | !buf) {
             return 0;
         }
+        if (_z) {
+            return _z->read(buf, size);
+        }
         int result = lfs_file_read(_fs->getFS(), _getFD(), (void*) buf, size);
         if (result < 0) {
             DEBUGV("lfs_read rc=%d\n", result);
@@ -391,16 +549,29 @@ public:
         if (!_opened || !_fd) {
             return;
         }
+        if (_z) {
+            _z->flush();
+        }
         int rc = lfs_file_sync(_fs->getFS(), _getFD());
         if (rc < 0) {
             DEBUGV("lfs_file_sync rc=%d\n", rc);
         }
+        _saveZSize();
     }
 
     bool seek(uint32_t pos, SeekMode mode) override {
         if (!_opened || !_fd) {
             return false;
         }
+        if (_z) {
+            uint32_t target = pos;
+            if (mode == SeekCur) {
+                target = _z->position() + pos;
+            } else if (mode == SeekEnd) {
+                target = _z->size() - pos;
+            }
+            return _z->seek(target);
+        }
         int32_t offset = static_cast<int32_t>(pos);
         if (mode == SeekEnd) {
             offset = -offset; // TODO - this seems like its plain wrong vs. POSIX
@@ -422,6 +593,9 @@ public:
         if (!_opened || !_fd) {
             return 0;
         }
+        if (_z) {
+            return _z->position();
+        }
         int result = lfs_file_tell(_fs->getFS(), _getFD());
         if (result < 0) {
             DEBUGV("lfs_file_tell rc=%d\n", result);
@@ -432,6 +606,9 @@ public:
     }
 
     size_t size() const override {
+        if (_z) {
+            return _opened ? _z->size() : 0;
+        }
         return (_opened && _fd) ? lfs_file_size(_fs->getFS(), _getFD()) : 0;
     }
 
@@ -439,6 +616,9 @@ public:
         if (!_opened || !_fd) {
             return false;
         }
+        if (_z) {
+            return _z->truncate(size);
+        }
         int rc = lfs_file_truncate(_fs->getFS(), _getFD(), size);
         if (rc < 0) {
             DEBUGV("lfs_file_truncate rc=%d\n", rc);
@@ -447,9 +627,29 @@ public:
         return true;
     }
 
+    // A CTZ file's later blocks start with skip-list pointers, so only a file held in its
+    // first block is one contiguous run of flash
+    const void *mmap() override {
+        if (!_opened || !_fd || _z) {
+            return nullptr;
+        }
+        lfs_file_t *f = _getFD();
+        if ((f->flags & (LFS_F_INLINE | LFS_F_DIRTY | LFS_F_WRITING)) || !f->ctz.size || (f->ctz.size > _fs->_blockSize)) {
+            return nullptr;
+        }
+        return _fs->_start + f->ctz.head * _fs->_blockSize;
+    }
+
     void close() override {
         if (_opened && _fd) {
+            if (_z) {
+                _z->flush();
+            }
             lfs_file_close(_fs->getFS(), _getFD());
+            _saveZSize();
+            _z = nullptr;
+            _fs->_releaseFileBuffer(_bufferSlot);
+            _bufferSlot = -1;
             _opened = false;
             DEBUGV("lfs_file_close: fd=%p\n", _getFD());
             if (_timeCallback && (_flags & LFS_O_WRONLY)) {
@@ -531,12 +731,25 @@ protected:
         return _fd.get();
     }
 
+    // The decompressed size of a compressed file being written, after its data is stored
+    void _saveZSize() {
+        if (_z && (_flags & LFS_O_WRONLY)) {
+            uint32_t zsize = _z->size();
+            int rc = lfs_setattr(_fs->getFS(), _name.get(), LFSZ_ATTR, &zsize, sizeof(zsize));
+            if (rc < 0) {
+                DEBUGV("Unable to set compressed size on '%s'\n", _name.get());
+            }
+        }
+    }
+
     LittleFSImpl                *_fs;
     std::shared_ptr<lfs_file_t>  _fd;
     std::shared_ptr<char>        _name;
     bool                         _opened;
     int                          _flags;
     time_t                       _creation;
+    int                          _bufferSlot; // Preallocated cache in use, or -1
+    std::shared_ptr<LittleFSZFile> _z;        // Compressed file contents, or nullptr
 };
 
 class LittleFSDirImpl : public DirImpl {
@@ -580,39 +793,19 @@ public:
         if (!_valid) {
             return 0;
         }
+        uint32_t zsize;
+        if (_getAttr(LFSZ_ATTR, sizeof(zsize), &zsize) == sizeof(zsize)) {
+            return zsize;
+        }
         return _dirent.size;
     }
 
     time_t fileTime() override {
-        time_t t;
-        int32_t t32b;
-
-        // If the attribute is 8-bytes, we're all set
-        if (_getAttr('t', 8, &t)) {
-            return t;
-        } else if (_getAttr('t', 4, &t32b)) {
-            // If it's 4 bytes silently promote to 64b
-            return (time_t)t32b;
-        } else {
-            // OTW, none present
-            return 0;
-        }
+        return _getTime('t');
     }
 
     time_t fileCreationTime() override {
-        time_t t;
-        int32_t t32b;
-
-        // If the attribute is 8-bytes, we're all set
-        if (_getAttr('c', 8, &t)) {
-            return t;
-        } else if (_getAttr('c', 4, &t32b)) {
-            // If it's 4 bytes silently promote to 64b
-            return (time_t)t32b;
-        } else {
-            // OTW, none present
-            return 0;
-        }
+        return _getTime('c');
     }
 
 
@@ -651,17 +844,39 @@ protected:
         return _dir.get();
     }
 
-    bool _getAttr(char attr, int len, void *dest) {
+    // Returns the attribute's stored size, which may be less than len
+    int _getAttr(char attr, int len, void *dest) {
         if (!_valid || !len || !dest) {
-            return false;
+            return 0;
+        }
+        // Straight from the directory block the entry was just read from
+        int rc = lfs_dir_lastattr(_fs->getFS(), _getDir(), attr, dest, len);
+        if (rc != LFS_ERR_NOENT) {
+            return std::max(rc, 0);
         }
         int nameLen = 3; // Slashes, terminator
         nameLen += _dirPath.get() ? strlen(_dirPath.get()) : 0;
         nameLen += strlen(_dirent.name);
         char tmpName[nameLen];
         snprintf(tmpName, nameLen, "%s%s%s", _dirPath.get() ? _dirPath.get() : "", _dirPath.get() && _dirPath.get()[0] ? "/" : "", _dirent.name);
-        int rc = lfs_getattr(_fs->getFS(), tmpName, attr, dest, len);
-        return (rc == len);
+        rc = lfs_getattr(_fs->getFS(), tmpName, attr, dest, len);
+        return std::max(rc, 0);
+    }
+
+    time_t _getTime(char attr) {
+        union {
+            time_t  t;
+            int32_t t32b;
+        } u;
+        switch (_getAttr(attr, sizeof(u.t), &u)) {
+        case 8:
+            return u.t;
+        case 4:
+            // Older 4 byte times are silently promoted to 64b
+            return (time_t)u.t32b;
+        default:
+            return 0; // None present
+        }
     }
 
     String                      _pattern;
@@ -0,0 +1,402 @@
+/*
+    LittleFSZ.cpp - Block compressed file contents for LittleFS
+    Copyright (c) 2022 Earle F. Philhower, III.  All rights reserved.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "LittleFSZ.h"
+
+namespace littlefs_impl {
+
+#define LFSZ_HASH_BITS 10
+#define LFSZ_HEADER 4
+#define LFSZ_RAW 0x8000
+
+// LZ4's end of block rules: the last match starts at least 12 bytes from the end and the
+// last 5 bytes are always literals
+#define LZ_MFLIMIT 12
+#define LZ_LASTLITERALS 5
+
+static inline uint32_t _read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint32_t _hash(uint32_t v) {
+    return (uint32_t)(v * 2654435761U) >> (32 - LFSZ_HASH_BITS);
+}
+
+static size_t _putLength(uint8_t *dst, size_t len) {
+    size_t n = 0;
+    while (len >= 255) {
+        dst[n++] = 255;
+        len -= 255;
+    }
+    dst[n++] = len;
+    return n;
+}
+
+// Greedy single-probe LZ4, the table holds (1 << LFSZ_HASH_BITS) positions.  Returns the
+// compressed length, or 0 if it wouldn't fit in cap.
+size_t lfszCompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap, uint16_t *table) {
+    size_t ip = 0, anchor = 0, op = 0;
+    memset(table, 0, sizeof(uint16_t) << LFSZ_HASH_BITS);
+    if (len > LZ_MFLIMIT) {
+        size_t limit = len - LZ_MFLIMIT;
+        ip = 1;
+        while (ip < limit) {
+            uint32_t seq = _read32(src + ip);
+            uint32_t h = _hash(seq);
+            size_t ref = table[h];
+            table[h] = ip;
+            if ((ref >= ip) || (_read32(src + ref) != seq)) {
+                ip++;
+                continue;
+            }
+            size_t mlen = 4;
+            size_t maxLen = len - LZ_LASTLITERALS - ip;
+            while ((mlen < maxLen) && (src[ref + mlen] == src[ip + mlen])) {
+                mlen++;
+            }
+            size_t lit = ip - anchor;
+            if (op + 1 + lit / 255 + 1 + lit + 2 + (mlen - 4) / 255 + 1 > cap) {
+                return 0;
+            }
+            uint8_t *token = dst + op++;
+            *token = (lit >= 15 ? 15 : lit) << 4;
+            if (lit >= 15) {
+                op += _putLength(dst + op, lit - 15);
+            }
+            memcpy(dst + op, src + anchor, lit);
+            op += lit;
+            dst[op++] = (ip - ref) & 0xff;
+            dst[op++] = (ip - ref) >> 8;
+            *token |= (mlen - 4 >= 15) ? 15 : mlen - 4;
+            if (mlen - 4 >= 15) {
+                op += _putLength(dst + op, mlen - 4 - 15);
+            }
+            ip += mlen;
+            anchor = ip;
+            if (ip < limit) {
+                table[_hash(_read32(src + ip - 2))] = ip - 2;
+            }
+        }
+    }
+    size_t lit = len - anchor;
+    if (op + 1 + lit / 255 + 1 + lit > cap) {
+        return 0;
+    }
+    dst[op++] = (lit >= 15 ? 15 : lit) << 4;
+    if (lit >= 15) {
+        op += _putLength(dst + op, lit - 15);
+    }
+    memcpy(dst + op, src + anchor, lit);
+    return op + lit;
+}
+
+// Returns the decompressed length, or -1 for corrupt data
+int lfszDecompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap) {
+    size_t ip = 0, op = 0;
+    while (ip < len) {
+        uint8_t token = src[ip++];
+        size_t lit = token >> 4;
+        if (lit == 15) {
+            uint8_t b;
+            do {
+                if (ip >= len) {
+                    return -1;
+                }
+                b = src[ip++];
+                lit += b;
+            } while (b == 255);
+        }
+        if ((ip + lit > len) || (op + lit > cap)) {
+            return -1;
+        }
+        memcpy(dst + op, src + ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == len) {
+            break; // The last sequence has no match
+        }
+        if (ip + 2 > len) {
+            return -1;
+        }
+        size_t offset = src[ip] | (src[ip + 1] << 8);
+        ip += 2;
+        size_t mlen = token & 15;
+        if (mlen == 15) {
+            uint8_t b;
+            do {
+                if (ip >= len) {
+                    return -1;
+                }
+                b = src[ip++];
+                mlen += b;
+            } while (b == 255);
+        }
+        mlen += 4;
+        if (!offset || (offset > op) || (op + mlen > cap)) {
+            return -1;
+        }
+        const uint8_t *ref = dst + op - offset;
+        for (size_t i = 0; i < mlen; i++) { // May overlap, so bytewise
+            dst[op + i] = ref[i];
+        }
+        op += mlen;
+    }
+    return op;
+}
+
+LittleFSZFile::LittleFSZFile(lfs_t *lfs, lfs_file_t *fd, bool write, uint32_t size) :
+    _lfs(lfs), _fd(fd), _write(write), _size(size), _pos(0), _buf(nullptr), _cbuf(nullptr), _table(nullptr),
+    _used(0), _blockOff(0), _blockStart(0), _nextOff(0), _tailWritten(false), _dirty(false) {
+}
+
+LittleFSZFile::~LittleFSZFile() {
+    free(_buf);
+    free(_cbuf);
+    free(_table);
+}
+
+bool LittleFSZFile::begin(bool append) {
+    _buf = (uint8_t *)malloc(LFSZ_BLOCK);
+    _cbuf = (uint8_t *)malloc(LFSZ_HEADER + LFSZ_BLOCK);
+    if (_write) {
+        _table = (uint16_t *)malloc(sizeof(uint16_t) << LFSZ_HASH_BITS);
+    }
+    if (!_buf || !_cbuf || (_write && !_table)) {
+        return false;
+    }
+    if (!append || !_size) {
+        return true;
+    }
+    // Pick up the last block so new data joins it, and rewrite it in place
+    if (!_buildIndex() || _index.empty()) {
+        return false;
+    }
+    const IndexEntry &last = _index.back();
+    if (!_load(last.offset, last.start)) {
+        return false;
+    }
+    _index.clear();
+    _pos = _size;
+    _tailWritten = true;
+    if (_used == LFSZ_BLOCK) {
+        _blockOff = _nextOff;
+        _blockStart += _used;
+        _used = 0;
+        _tailWritten = false;
+    }
+    return true;
+}
+
+bool LittleFSZFile::_readHeader(uint32_t offset, uint16_t *stored, uint16_t *raw) {
+    uint8_t hdr[LFSZ_HEADER];
+    if ((lfs_file_seek(_lfs, _fd, offset, LFS_SEEK_SET) < 0) || (lfs_file_read(_lfs, _fd, hdr, sizeof(hdr)) != sizeof(hdr))) {
+        return false;
+    }
+    *stored = hdr[0] | (hdr[1] << 8);
+    *raw = hdr[2] | (hdr[3] << 8);
+    return *raw <= LFSZ_BLOCK;
+}
+
+// Reads and decompresses the block at offset into _buf
+bool LittleFSZFile::_load(uint32_t offset, uint32_t start) {
+    uint16_t stored, raw;
+    if (!_readHeader(offset, &stored, &raw)) {
+        return false;
+    }
+    size_t clen = stored & ~LFSZ_RAW;
+    if ((clen > LFSZ_BLOCK) || (lfs_file_read(_lfs, _fd, _cbuf, clen) != (lfs_ssize_t)clen)) {
+        return false;
+    }
+    if (stored & LFSZ_RAW) {
+        if (clen != raw) {
+            return false;
+        }
+        memcpy(_buf, _cbuf, raw);
+    } else if (lfszDecompress(_cbuf, clen, _buf, LFSZ_BLOCK) != raw) {
+        return false;
+    }
+    _used = raw;
+    _blockOff = offset;
+    _blockStart = start;
+    _nextOff = offset + LFSZ_HEADER + clen;
+    return true;
+}
+
+bool LittleFSZFile::_buildIndex() {
+    _index.clear();
+    uint32_t offset = 0, start = 0;
+    uint32_t fileSize = lfs_file_size(_lfs, _fd);
+    while ((offset < fileSize) && (start < _size)) {
+        uint16_t stored, raw;
+        if (!_readHeader(offset, &stored, &raw)) {
+            return false;
+        }
+        _index.push_back({offset, start});
+        offset += LFSZ_HEADER + (stored & ~LFSZ_RAW);
+        start += raw;
+    }
+    return true;
+}
+
+// Compresses and stores _buf at _blockOff, or stores it raw if it doesn't shrink
+bool LittleFSZFile::_emit() {
+    size_t clen = lfszCompress(_buf, _used, _cbuf + LFSZ_HEADER, _used ? _used - 1 : 0, _table);
+    uint16_t stored = clen;
+    if (!clen) {
+        memcpy(_cbuf + LFSZ_HEADER, _buf, _used);
+        clen = _used;
+        stored = _used | LFSZ_RAW;
+    }
+    _cbuf[0] = stored & 0xff;
+    _cbuf[1] = stored >> 8;
+    _cbuf[2] = _used & 0xff;
+    _cbuf[3] = _used >> 8;
+    if (_tailWritten && (lfs_file_truncate(_lfs, _fd, _blockOff) < 0)) {
+        return false;
+    }
+    if (lfs_file_seek(_lfs, _fd, _blockOff, LFS_SEEK_SET) < 0) {
+        return false;
+    }
+    size_t total = LFSZ_HEADER + clen;
+    if (lfs_file_write(_lfs, _fd, _cbuf, total) != (lfs_ssize_t)total) {
+        return false;
+    }
+    _nextOff = _blockOff + total;
+    return true;
+}
+
+int LittleFSZFile::write(const uint8_t *buf, size_t len) {
+    if (!_write) {
+        return 0;
+    }
+    size_t done = 0;
+    while (done < len) {
+        size_t n = std::min(len - done, (size_t)(LFSZ_BLOCK - _used));
+        memcpy(_buf + _used, buf + done, n);
+        _used += n;
+        _dirty = true;
+        done += n;
+        _pos += n;
+        _size = std::max(_size, _pos);
+        if (_used == LFSZ_BLOCK) {
+            if (!_emit()) {
+                return done - n;
+            }
+            _blockOff = _nextOff;
+            _blockStart += _used;
+            _used = 0;
+            _tailWritten = false;
+            _dirty = false;
+        }
+    }
+    return done;
+}
+
+bool LittleFSZFile::flush() {
+    if (!_write || !_dirty) {
+        return true;
+    }
+    if (!_emit()) {
+        return false;
+    }
+    _tailWritten = true;
+    _dirty = false;
+    return true;
+}
+
+int LittleFSZFile::read(uint8_t *buf, size_t len) {
+    if (_write) {
+        return 0;
+    }
+    size_t done = 0;
+    while ((done < len) && (_pos < _size)) {
+        if ((_pos < _blockStart) || (_pos >= _blockStart + _used)) {
+            // Blocks are read in order, so the next one is usually right after this one
+            if (_pos == _blockStart + _used) {
+                if (!_load(_nextOff, _pos)) {
+                    break;
+                }
+            } else if (!seek(_pos)) {
+                break;
+            }
+            if (!_used) {
+                break;
+            }
+            continue;
+        }
+        size_t off = _pos - _blockStart;
+        size_t n = std::min(len - done, (size_t)(_used - off));
+        memcpy(buf + done, _buf + off, n);
+        done += n;
+        _pos += n;
+    }
+    return done;
+}
+
+bool LittleFSZFile::seek(uint32_t pos) {
+    if (pos > _size) {
+        return false;
+    }
+    if (_write) {
+        return pos == _pos; // Writes only go at the end
+    }
+    if ((pos >= _blockStart) && (pos < _blockStart + _used)) {
+        _pos = pos;
+        return true;
+    }
+    if (pos == _size) {
+        _pos = pos;
+        return true;
+    }
+    if (_index.empty() && !_buildIndex()) {
+        return false;
+    }
+    auto it = std::upper_bound(_index.begin(), _index.end(), pos, [](uint32_t p, const IndexEntry & e) {
+        return p < e.start;
+    });
+    if (it == _index.begin()) {
+        return false;
+    }
+    --it;
+    if (!_load(it->offset, it->start)) {
+        return false;
+    }
+    _pos = pos;
+    return true;
+}
+
+// Only emptying the file is supported
+bool LittleFSZFile::truncate(uint32_t size) {
+    if (size || (lfs_file_truncate(_lfs, _fd, 0) < 0)) {
+        return false;
+    }
+    _size = _pos = 0;
+    _used = _blockOff = _blockStart = _nextOff = 0;
+    _tailWritten = false;
+    _dirty = false;
+    _index.clear();
+    return true;
+}
+
+};
@@ -0,0 +1,95 @@
+/*
+    LittleFSZ.h - Block compressed file contents for LittleFS
+    Copyright (c) 2022 Earle F. Philhower, III.  All rights reserved.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "../lib/littlefs/lfs.h"
+
+namespace littlefs_impl {
+
+// A compressed file is a run of independent blocks, each a 4 byte header (stored length,
+// with 0x8000 set if stored raw, then decompressed length, both little endian) and up to
+// LFSZ_BLOCK bytes compressed in the LZ4 block format.  Blocks stand alone so reading
+// from any point only needs its block, found through an index of block offsets built on
+// the first out-of-order seek().  The decompressed size is kept in the 'z' attribute,
+// which also marks the file as compressed.
+#ifndef LFSZ_BLOCK
+#define LFSZ_BLOCK 2048
+#endif
+#define LFSZ_ATTR 'z'
+
+size_t lfszCompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap, uint16_t *table);
+int lfszDecompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap);
+
+// The compressed stream over an open lfs_file_t, either read-only or write-only.  Writes
+// are buffered a block at a time.  flush() stores a partial block, which is rewritten in
+// place once more data arrives, so frequent flushes cost rewrites but never lose data.
+class LittleFSZFile {
+public:
+    LittleFSZFile(lfs_t *lfs, lfs_file_t *fd, bool write, uint32_t size);
+    ~LittleFSZFile();
+
+    // Allocates the buffers, and for appends reloads the last block into the write buffer
+    bool begin(bool append);
+
+    int write(const uint8_t *buf, size_t len);
+    int read(uint8_t *buf, size_t len);
+    bool seek(uint32_t pos);
+    bool flush();
+    bool truncate(uint32_t size);
+
+    uint32_t position() const {
+        return _pos;
+    }
+    uint32_t size() const {
+        return _size;
+    }
+
+private:
+    typedef struct {
+        uint32_t offset; // Of the block header in the file
+        uint32_t start;  // Decompressed position of the block's first byte
+    } IndexEntry;
+
+    bool _emit();
+    bool _readHeader(uint32_t offset, uint16_t *stored, uint16_t *raw);
+    bool _load(uint32_t offset, uint32_t start);
+    bool _buildIndex();
+
+    lfs_t *_lfs;
+    lfs_file_t *_fd;
+    bool _write;
+    uint32_t _size;      // Decompressed
+    uint32_t _pos;       // Decompressed
+    uint8_t *_buf;       // Decompressed block being written or read
+    uint8_t *_cbuf;      // Compressed block with its header
+    uint16_t *_table;    // Compressor hash table
+    uint32_t _used;      // Bytes in _buf
+    uint32_t _blockOff;  // File offset of the block in _buf
+    uint32_t _blockStart;// Decompressed position of _buf[0]
+    uint32_t _nextOff;   // File offset of the block after it
+    bool _tailWritten;   // _buf was already stored by a flush(), rewrite it in place
+    bool _dirty;         // _buf has data not yet stored
+    std::vector<IndexEntry> _index;
+};
+
+};
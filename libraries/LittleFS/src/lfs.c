@@ -8,3 +8,19 @@
 #define LFS_NO_ERROR
 
 #include "../lib/littlefs/lfs.c"
+
+// A user attribute of the entry lfs_dir_read() last returned, taken from the metadata pair
+// the directory is already positioned in instead of looking the path up again like
+// lfs_getattr().  Depends on littlefs 2.x's lfs_dir_t layout.
+lfs_ssize_t lfs_dir_lastattr(lfs_t *lfs, lfs_dir_t *dir, uint8_t type, void *buffer, lfs_size_t size) {
+    if (dir->id == 0) {
+        return LFS_ERR_NOENT; // Nothing but "." and ".." read from this pair yet
+    }
+    lfs_stag_t tag = lfs_dir_get(lfs, &dir->m, LFS_MKTAG(0x7ff, 0x3ff, 0),
+                                 LFS_MKTAG(LFS_TYPE_USERATTR + type, dir->id - 1, lfs_min(size, lfs->attr_max)),
+                                 buffer);
+    if (tag < 0) {
+        return (tag == LFS_ERR_NOENT) ? LFS_ERR_NOATTR : tag;
+    }
+    return lfs_tag_size(tag);
+}
@@ -37,12 +37,12 @@ void MD5Builder::begin(void) {
     br_md5_init(&_ctx);
 }
 
-void MD5Builder::add(const uint8_t * data, const uint16_t len) {
+void MD5Builder::add(const uint8_t * data, const size_t len) {
     br_md5_update(&_ctx, data, len);
 }
 
 void MD5Builder::addHexString(const char * data) {
-    uint16_t i, len = strlen(data);
+    size_t i, len = strlen(data);
     auto tmp = std::unique_ptr<uint8_t[]> {new (std::nothrow) uint8_t[len / 2]};
 
     if (!tmp) {
@@ -57,42 +57,24 @@ void MD5Builder::addHexString(const char * data) {
     add(tmp.get(), len / 2);
 }
 
-bool MD5Builder::addStream(Stream &stream, const size_t maxLen) {
-    const int buf_size = 512;
-    int maxLengthLeft = maxLen;
-
-    auto buf = std::unique_ptr<uint8_t[]> {new (std::nothrow) uint8_t[buf_size]};
-
-    if (!buf) {
-        return false;
+// Lets Stream::sendAll() feed the hash directly from the source's buffers
+class MD5Print : public Print {
+public:
+    MD5Print(br_md5_context *ctx) : _ctx(ctx) { }
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
     }
-
-    int bytesAvailable = stream.available();
-    while ((bytesAvailable > 0) && (maxLengthLeft > 0)) {
-
-        // determine number of bytes to read
-        int readBytes = bytesAvailable;
-        if (readBytes > maxLengthLeft) {
-            readBytes = maxLengthLeft;    // read only until max_len
-        }
-        if (readBytes > buf_size) {
-            readBytes = buf_size;    // not read more the buffer can handle
-        }
-
-        // read data and check if we got something
-        int numBytesRead = stream.readBytes(buf.get(), readBytes);
-        if (numBytesRead < 1) {
-            return false;
-        }
-
-        // Update MD5 with buffer payload
-        br_md5_update(&_ctx, buf.get(), numBytesRead);
-
-        // update available number of bytes
-        maxLengthLeft -= numBytesRead;
-        bytesAvailable = stream.available();
+    size_t write(const uint8_t *data, size_t len) override {
+        br_md5_update(_ctx, data, len);
+        return len;
     }
+private:
+    br_md5_context *_ctx;
+};
 
+bool MD5Builder::addStream(Stream &stream, const size_t maxLen) {
+    MD5Print p(&_ctx);
+    stream.sendAll(p, maxLen, 0);
     return true;
 }
 
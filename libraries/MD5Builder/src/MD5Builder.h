@@ -34,7 +34,7 @@ private:
     uint8_t _buf[16];
 public:
     void begin(void);
-    void add(const uint8_t * data, const uint16_t len);
+    void add(const uint8_t * data, const size_t len);
     void add(const char * data) {
         add((const uint8_t*)data, strlen(data));
     }
@@ -51,6 +51,8 @@ public:
     void addHexString(const String& data) {
         addHexString(data.c_str());
     }
+    // Hashes up to maxLen bytes which are already available, without a copy when the
+    // stream has a peek buffer
     bool addStream(Stream & stream, const size_t maxLen);
     void calculate(void);
     void getBytes(uint8_t * output) const;
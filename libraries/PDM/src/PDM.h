@@ -41,11 +41,17 @@ public:
     void setGain(int gain);
     void setBufferSize(int bufferSize);
     size_t getBufferSize();
+    // Ring of raw PDM buffers the DMA fills, before filtering.  More of them ride out
+    // longer gaps between calls to read().  Call before begin()
+    bool setDMABuffers(int count, int size);
 
     // private:
     void IrqHandler(bool halftranfer);
 
 private:
+    void _bufferDone(int i);
+    static void _dmaIRQ(int channel, void *param);
+
     int _dinPin;
     int _clkPin;
     int _pwrPin;
@@ -57,11 +63,15 @@ private:
     int _init;
 
     // Hardware peripherals used
-    uint _dmaChannel;
+    int _dmaChannel[2];
     PIO _pio;
     int _smIdx;
     int _pgmOffset;
 
+    volatile bool _processing;
+    void _process();
+    void _freeBuffers();
+
     PDMDoubleBuffer _doubleBuffer;
 
     void (*_onReceive)(void);
@@ -30,6 +30,7 @@
 /* Includes ------------------------------------------------------------------*/
 
 #include "OpenPDMFilter.h"
+#include "hardware/interp.h"
 
 
 /* Variables -----------------------------------------------------------------*/
@@ -41,7 +42,8 @@ uint32_t sinc1[DECIMATION_MAX];
 uint32_t sinc2[DECIMATION_MAX * 2];
 uint32_t coef[SINCN][DECIMATION_MAX];
 #ifdef USE_LUT
-int32_t lut[256][DECIMATION_MAX / 8][SINCN];
+/* Padded to SINCN + 1 so each row is 256 bytes, for Open_PDM_Filter_Interp() */
+int32_t lut[256][DECIMATION_MAX / 8][SINCN + 1];
 #endif
 
 
@@ -300,3 +302,105 @@ void Open_PDM_Filter_128(uint8_t* data, int16_t* dataOut, uint16_t volume, TPDMF
     Param->OldIn = OldIn;
     Param->OldZ = OldZ;
 }
+
+#ifdef USE_LUT
+/*
+    RP2040 version of the above for 1, 2 or 4 interleaved mics, Param pointing to one
+    filter per mic.  The SIO interpolators take each byte of a 32-bit word of PDM data
+    straight to its LUT address, and all the filter state is kept in 32 bits (the sinc3
+    sum is at most 2^21) so nothing needs the M0+'s slow 64-bit multiply and divide.
+    Byte j of each word is from mic j % channels.  data must be word aligned.
+*/
+void Open_PDM_Filter_Interp(const uint8_t* data, int16_t* dataOut, uint16_t volume, TPDMFilter_InitStruct *Param) {
+    const uint8_t channels = Param->In_MicChannels;
+    const uint32_t m = channels - 1;
+    const uint32_t words = Param->Decimation / 8 * channels / 4; // Per output sample
+    const uint32_t step = 4 / channels * sizeof(lut[0][0]); // LUT column advance per word
+    const uint32_t *w = (const uint32_t *)data;
+    interp_hw_save_t save0, save1;
+    interp_config c;
+    uint32_t i, j, k;
+
+    /* May be interrupting something else using the interpolators */
+    interp_save(interp0, &save0);
+    interp_save(interp1, &save1);
+
+    /* Byte 0 and 1 from (word << 8), bytes 2 and 3 from word, each ending up at bits 15..8 */
+    c = interp_default_config();
+    interp_config_set_mask(&c, 8, 15);
+    interp_set_config(interp0, 0, &c);
+    interp_config_set_shift(&c, 8);
+    interp_set_config(interp1, 0, &c);
+    interp_config_set_cross_input(&c, true);
+    interp_set_config(interp0, 1, &c);
+    interp_config_set_shift(&c, 16);
+    interp_set_config(interp1, 1, &c);
+    interp0->base[0] = (uint32_t)&lut[0][0 / channels][0];
+    interp0->base[1] = (uint32_t)&lut[0][1 / channels][0];
+    interp1->base[0] = (uint32_t)&lut[0][2 / channels][0];
+    interp1->base[1] = (uint32_t)&lut[0][3 / channels][0];
+
+    for (i = 0; i < Param->nSamples; i++) {
+        int32_t z[4][SINCN] = { { 0 } };
+        uint32_t off = 0;
+        for (k = 0; k < words; k++, off += step) {
+            uint32_t v = *w++;
+            interp0->accum[0] = v << 8;
+            interp1->accum[0] = v;
+            const int32_t *p0 = (const int32_t *)(interp0->peek[0] + off);
+            const int32_t *p1 = (const int32_t *)(interp0->peek[1] + off);
+            const int32_t *p2 = (const int32_t *)(interp1->peek[0] + off);
+            const int32_t *p3 = (const int32_t *)(interp1->peek[1] + off);
+            int32_t *a;
+            a = z[0];
+            a[0] += p0[0];
+            a[1] += p0[1];
+            a[2] += p0[2];
+            a = z[1 & m];
+            a[0] += p1[0];
+            a[1] += p1[1];
+            a[2] += p1[2];
+            a = z[2 & m];
+            a[0] += p2[0];
+            a[1] += p2[1];
+            a[2] += p2[2];
+            a = z[3 & m];
+            a[0] += p3[0];
+            a[1] += p3[1];
+            a[2] += p3[2];
+        }
+
+        for (j = 0; j < channels; j++) {
+            TPDMFilter_InitStruct *f = &Param[j];
+            int32_t OldOut = (int32_t)f->OldOut;
+            int32_t OldIn = (int32_t)f->OldIn;
+            int32_t OldZ = (int32_t)f->OldZ;
+            int32_t Z = (int32_t)f->Coef[1] + z[j][2] - (int32_t)sub_const;
+            f->Coef[1] = f->Coef[0] + z[j][1];
+            f->Coef[0] = z[j][0];
+
+            OldOut = (f->HP_ALFA * (OldOut + Z - OldIn)) >> 8;
+            OldIn = Z;
+            OldZ = ((256 - f->LP_ALFA) * OldZ + f->LP_ALFA * OldOut) >> 8;
+
+            if (volume == 1) {
+                Z = OldZ;
+            } else {
+                int64_t V = (int64_t)OldZ * volume;
+                Z = SaturaLH(V, -0x40000000LL, 0x40000000LL);
+            }
+            /* 32-bit divides are done by the SIO divider */
+            Z = RoundDiv(Z, (int32_t)div_const);
+            Z = SaturaLH(Z, -32700, 32700);
+
+            dataOut[i * channels + j] = Z;
+            f->OldOut = OldOut;
+            f->OldIn = OldIn;
+            f->OldZ = OldZ;
+        }
+    }
+
+    interp_restore(interp0, &save0);
+    interp_restore(interp1, &save1);
+}
+#endif
@@ -1,5 +1,3 @@
-
-
 #include "Arduino.h"
 #include "PDM.h"
 #include "OpenPDMFilter.h"
@@ -12,28 +10,32 @@ extern "C" {
 #include "hardware/sync.h"
 #include "pdm.pio.h"
 static PIOProgram _pdmPgm(&pdm_pio_program);
-
-// raw buffers contain PDM data
-#define RAW_BUFFER_SIZE 512 // should be a multiple of (decimation / 8)
-uint8_t rawBuffer0[RAW_BUFFER_SIZE];
-uint8_t rawBuffer1[RAW_BUFFER_SIZE];
-uint8_t* rawBuffer[2] = {rawBuffer0, rawBuffer1};
-volatile int rawBufferIndex = 0;
+static PIOProgram _pdmStereoPgm(&pdm_pio_stereo_program);
+static PIOProgram _pdmQuadPgm(&pdm_pio_quad_program);
+
+// raw buffers contain PDM data, a ring of them filled by two chained DMA channels
+#define RAW_BUFFER_SIZE 512 // should be a multiple of (decimation / 8) * channels
+#define RAW_BUFFER_COUNT 4
+uint8_t** rawBuffer = nullptr;
+uint8_t* unzipBuffer = nullptr; // Raw data sorted into one byte per mic
+int rawBufferCount = RAW_BUFFER_COUNT;
+int rawBufferSize = RAW_BUFFER_SIZE;
+volatile int rawBufferRead = 0;  // Oldest filled, not yet filtered
+volatile int rawBufferReady = 0; // Number filled, not yet filtered
+int rawBufferDMA[2];             // Being filled by each DMA channel
 
 int decimation = 64;
 
 // final buffer is the one to be filled with PCM data
 int16_t* volatile finalBuffer;
 
-// OpenPDM filter used to convert PDM into PCM
+// OpenPDM filter used to convert PDM into PCM, one per mic
 #define FILTER_GAIN     16
-TPDMFilter_InitStruct filter;
+#define MAX_CHANNELS    4
+TPDMFilter_InitStruct filter[MAX_CHANNELS];
 
-extern "C" {
-    __attribute__((__used__)) void dmaHandler(void) {
-        PDM.IrqHandler(true);
-    }
-}
+// With 2 or 4 mics the SM shifts in one bit from each in turn, this sorts those bits out
+static uint8_t unzip[256];
 
 
 PDMClass::PDMClass(int dinPin, int clkPin, int pwrPin) :
@@ -45,78 +47,135 @@ PDMClass::PDMClass(int dinPin, int clkPin, int pwrPin) :
     _channels(-1),
     _samplerate(-1),
     _init(-1),
-    _dmaChannel(0),
+    _dmaChannel{ -1, -1 },
     _pio(nullptr),
     _smIdx(-1),
-    _pgmOffset(-1) {
+    _pgmOffset(-1),
+    _processing(false) {
 }
 
 PDMClass::~PDMClass() {
 }
 
 int PDMClass::begin(int channels, int sampleRate) {
-    //_channels = channels; // only one channel available
+    if ((channels != 1) && (channels != 2) && (channels != MAX_CHANNELS)) {
+        return 0;
+    }
+    _channels = channels;
+
+    // Whole output samples for every mic in each raw buffer, and a word multiple
+    int bytesPerSample = decimation / 8 * channels;
+    rawBufferSize -= rawBufferSize % bytesPerSample;
+    if (rawBufferSize < bytesPerSample) {
+        rawBufferSize = bytesPerSample;
+    }
+    rawBuffer = (uint8_t **)calloc(rawBufferCount, sizeof(uint8_t *));
+    if (!rawBuffer) {
+        return 0;
+    }
+    for (int i = 0; i < rawBufferCount; i++) {
+        rawBuffer[i] = (uint8_t *)malloc(rawBufferSize);
+        if (!rawBuffer[i]) {
+            _freeBuffers();
+            return 0;
+        }
+    }
+    if (channels > 1) {
+        unzipBuffer = (uint8_t *)malloc(rawBufferSize);
+        if (!unzipBuffer) {
+            _freeBuffers();
+            return 0;
+        }
+        // Bit t (MSB first) of a raw byte is from stream t % channels
+        for (int b = 0; b < 256; b++) {
+            uint8_t u = 0;
+            for (int t = 0; t < 8; t++) {
+                if (b & (0x80 >> t)) {
+                    u |= 0x80 >> ((t % channels) * (8 / channels) + t / channels);
+                }
+            }
+            unzip[b] = u;
+        }
+    }
+    rawBufferRead = 0;
+    rawBufferReady = 0;
 
     // clear the final buffers
     _doubleBuffer.reset();
     finalBuffer = (int16_t*)_doubleBuffer.data();
-    int finalBufferLength = _doubleBuffer.availableForWrite() / sizeof(int16_t);
+    int finalBufferLength = _doubleBuffer.availableForWrite() / sizeof(int16_t) / channels;
     _doubleBuffer.swap(0);
 
-    int rawBufferLength = RAW_BUFFER_SIZE / (decimation / 8);
+    int rawBufferLength = rawBufferSize / bytesPerSample;
     // Saturate number of samples. Remaining bytes are dropped.
     if (rawBufferLength > finalBufferLength) {
         rawBufferLength = finalBufferLength;
     }
 
     /* Initialize Open PDM library */
-    filter.Fs = sampleRate;
-    filter.nSamples = rawBufferLength;
-    filter.LP_HZ = sampleRate / 2;
-    filter.HP_HZ = 10;
-    filter.In_MicChannels = 1;
-    filter.Out_MicChannels = 1;
-    filter.Decimation = decimation;
+    filter[0].Fs = sampleRate;
+    filter[0].nSamples = rawBufferLength;
+    filter[0].LP_HZ = sampleRate / 2;
+    filter[0].HP_HZ = 10;
+    filter[0].In_MicChannels = channels;
+    filter[0].Out_MicChannels = channels;
+    filter[0].Decimation = decimation;
     if (_gain == -1) {
         _gain = FILTER_GAIN;
     }
-    filter.filterGain = _gain;
-    Open_PDM_Filter_Init(&filter);
+    filter[0].filterGain = _gain;
+    Open_PDM_Filter_Init(&filter[0]);
+    for (int i = 1; i < channels; i++) {
+        filter[i] = filter[0];
+    }
 
-    // Configure PIO state machine
+    // Configure PIO state machine, which runs 2 instructions per PDM clock
     float clkDiv = (float)clock_get_hz(clk_sys) / sampleRate / decimation / 2;
 
-    if (!_pdmPgm.prepare(&_pio, &_smIdx, &_pgmOffset)) {
+    PIOProgram *pgm = (channels == 1) ? &_pdmPgm : (channels == 2) ? &_pdmStereoPgm : &_pdmQuadPgm;
+    if (!pgm->prepare(&_pio, &_smIdx, &_pgmOffset)) {
         // ERROR, no free slots
+        _freeBuffers();
         return -1;
     }
-    pdm_pio_program_init(_pio, _smIdx, _pgmOffset, _clkPin, _dinPin, clkDiv);
+    if (channels == 1) {
+        pdm_pio_program_init(_pio, _smIdx, _pgmOffset, _clkPin, _dinPin, clkDiv);
+    } else {
+        pdm_pio_multi_program_init(_pio, _smIdx, _pgmOffset, _clkPin, _dinPin, channels / 2, clkDiv);
+    }
 
     // Wait for microphone
     delay(100);
 
-    // Configure DMA for transferring PIO rx buffer to raw buffers
-    _dmaChannel = dma_claim_unused_channel(false);
-    dma_channel_config c = dma_channel_get_default_config(_dmaChannel);
-    channel_config_set_read_increment(&c, false);
-    channel_config_set_write_increment(&c, true);
-    channel_config_set_dreq(&c, pio_get_dreq(_pio, _smIdx, false));
-    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
-
-    // Clear DMA interrupts
-    dma_hw->ints0 = 1u << _dmaChannel;
-    // Enable DMA interrupts
-    dma_channel_set_irq0_enabled(_dmaChannel, true);
-    // Share but allocate a high priority to the interrupt
-    irq_add_shared_handler(DMA_IRQ_0, dmaHandler, 0);
-    irq_set_enabled(DMA_IRQ_0, true);
-
-    dma_channel_configure(_dmaChannel, &c,
-                          rawBuffer[rawBufferIndex],        // Destinatinon pointer
-                          &_pio->rxf[_smIdx],      // Source pointer
-                          RAW_BUFFER_SIZE, // Number of transfers
-                          true                // Start immediately
-                         );
+    // Configure a pair of chained DMA channels for transferring PIO rx buffer to raw buffers,
+    // so the next buffer is always already lined up when one fills
+    for (int i = 0; i < 2; i++) {
+        _dmaChannel[i] = dma_claim_unused_channel(false);
+        if (_dmaChannel[i] < 0) {
+            end();
+            return 0;
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        dma_channel_config c = dma_channel_get_default_config(_dmaChannel[i]);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_dreq(&c, pio_get_dreq(_pio, _smIdx, false));
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_chain_to(&c, _dmaChannel[i ^ 1]);
+
+        // Share the core's DMA interrupt
+        DMAChannel::attachInterrupt(_dmaChannel[i], _dmaIRQ, this);
+
+        rawBufferDMA[i] = i;
+        dma_channel_configure(_dmaChannel[i], &c,
+                              rawBuffer[i],            // Destinatinon pointer
+                              &_pio->rxf[_smIdx],      // Source pointer
+                              rawBufferSize,           // Number of transfers
+                              false                    // Started below
+                             );
+    }
+    dma_channel_start(_dmaChannel[0]);
 
     _init = 1;
 
@@ -124,25 +183,60 @@ int PDMClass::begin(int channels, int sampleRate) {
 }
 
 void PDMClass::end() {
-    dma_channel_abort(_dmaChannel);
+    for (int i = 0; i < 2; i++) {
+        if (_dmaChannel[i] >= 0) {
+            DMAChannel::detachInterrupt(_dmaChannel[i]);
+            // Break the chain first, or aborting one would just start the other
+            hw_clear_bits(&dma_hw->ch[_dmaChannel[i]].al1_ctrl, DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS);
+            hw_set_bits(&dma_hw->ch[_dmaChannel[i]].al1_ctrl, _dmaChannel[i] << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB);
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (_dmaChannel[i] >= 0) {
+            dma_channel_abort(_dmaChannel[i]);
+            dma_hw->ints0 = 1u << _dmaChannel[i];
+            dma_channel_unclaim(_dmaChannel[i]);
+            _dmaChannel[i] = -1;
+        }
+    }
+    if (_smIdx >= 0) {
+        pio_sm_set_enabled(_pio, _smIdx, false);
+        PIOProgram::unprepare(_pio, _smIdx);
+        _smIdx = -1;
+    }
+    _freeBuffers();
+    _init = -1;
     pinMode(_clkPin, INPUT);
 }
 
+void PDMClass::_freeBuffers() {
+    if (rawBuffer) {
+        for (int i = 0; i < rawBufferCount; i++) {
+            free(rawBuffer[i]);
+        }
+        free(rawBuffer);
+        rawBuffer = nullptr;
+    }
+    free(unzipBuffer);
+    unzipBuffer = nullptr;
+}
+
 int PDMClass::available() {
-    //NVIC_DisableIRQ(DMA_IRQ_0n);
-    //uint32_t interrupts = save_and_disable_interrupts();
-    irq_set_enabled(DMA_IRQ_0, false);
-    size_t avail = _doubleBuffer.available();
-    irq_set_enabled(DMA_IRQ_0, true);
-    //restore_interrupts(interrupts);
-    //NVIC_EnableIRQ(DMA_IRQ_0n);
-    return avail;
+    _process();
+    return _doubleBuffer.available();
 }
 
 int PDMClass::read(void* buffer, size_t size) {
-    irq_set_enabled(DMA_IRQ_0, false);
-    int read = _doubleBuffer.read(buffer, size);
-    irq_set_enabled(DMA_IRQ_0, true);
+    int read = 0;
+    while (size) {
+        _process();
+        int got = _doubleBuffer.read((uint8_t *)buffer + read, size);
+        if (!got) {
+            break;
+        }
+        read += got;
+        size -= got;
+    }
     return read;
 }
 
@@ -153,8 +247,11 @@ void PDMClass::onReceive(void(*function)(void)) {
 void PDMClass::setGain(int gain) {
     _gain = gain;
     if (_init == 1) {
-        filter.filterGain = _gain;
-        Open_PDM_Filter_Init(&filter);
+        filter[0].filterGain = _gain;
+        Open_PDM_Filter_Init(&filter[0]);
+        for (int i = 1; i < _channels; i++) {
+            filter[i].filterGain = _gain;
+        }
     }
 }
 
@@ -162,39 +259,119 @@ void PDMClass::setBufferSize(int bufferSize) {
     _doubleBuffer.setSize(bufferSize);
 }
 
-void PDMClass::IrqHandler(bool halftranfer) {
-    static int cutSamples = 100;
+bool PDMClass::setDMABuffers(int count, int size) {
+    if ((_init == 1) || (count < 3) || (size < 16)) {
+        return false;
+    }
+    rawBufferCount = count;
+    rawBufferSize = size;
+    return true;
+}
 
-    // Clear the interrupt request.
-    dma_hw->ints0 = 1u << _dmaChannel;
-    // Restart dma pointing to the other buffer
-    int shadowIndex = rawBufferIndex ^ 1;
-    dma_channel_set_write_addr(_dmaChannel, rawBuffer[shadowIndex], true);
+// Filters raw buffers into the PCM buffer as space is freed by read().  Runs in the
+// caller's context, not the DMA IRQ, so the ring of raw buffers absorbs any delay.
+void PDMClass::_process() {
+    static int cutSamples = 100;
 
-    if (_doubleBuffer.available()) {
-        // buffer overflow, stop
-        return end();
+    if (_processing || (_init != 1)) {
+        return; // Re-entered from onReceive, or not running
     }
+    _processing = true;
+    while (rawBufferReady && !_doubleBuffer.available()) {
+        int r = rawBufferRead;
+        const uint8_t *raw = rawBuffer[r];
+        if (_channels == 2) {
+            // Two raw bytes have 4 bits of each mic, make one byte per mic
+            for (int i = 0; i < rawBufferSize; i += 2) {
+                uint8_t u0 = unzip[raw[i]];
+                uint8_t u1 = unzip[raw[i + 1]];
+                unzipBuffer[i] = (u0 & 0xf0) | (u1 >> 4);
+                unzipBuffer[i + 1] = (u0 << 4) | (u1 & 0x0f);
+            }
+            raw = unzipBuffer;
+        } else if (_channels == 4) {
+            // Four raw bytes have 2 bits of each stream: DIN+1 L, DIN L, DIN+1 R, DIN R
+            static const uint8_t mic[4] = { 2, 0, 3, 1 };
+            for (int i = 0; i < rawBufferSize; i += 4) {
+                uint8_t u0 = unzip[raw[i]];
+                uint8_t u1 = unzip[raw[i + 1]];
+                uint8_t u2 = unzip[raw[i + 2]];
+                uint8_t u3 = unzip[raw[i + 3]];
+                for (int s = 0; s < 4; s++) {
+                    int sh = 6 - 2 * s;
+                    unzipBuffer[i + mic[s]] = (((u0 >> sh) & 3) << 6) | (((u1 >> sh) & 3) << 4) | (((u2 >> sh) & 3) << 2) | ((u3 >> sh) & 3);
+                }
+            }
+            raw = unzipBuffer;
+        }
+
+        // fill final buffer with PCM samples
+        Open_PDM_Filter_Interp(raw, finalBuffer, 1, filter);
+
+        if (cutSamples) {
+            memset(finalBuffer, 0, cutSamples);
+            cutSamples = 0;
+        }
+
+        // That raw buffer is free again, unless the IRQ already dropped it on an overrun
+        irq_set_enabled(DMA_IRQ_0, false);
+        if (rawBufferRead == r) {
+            rawBufferRead = (r + 1) % rawBufferCount;
+            rawBufferReady--;
+        }
+        irq_set_enabled(DMA_IRQ_0, true);
+
+        // swap final buffer
+        finalBuffer = (int16_t*)_doubleBuffer.data();
+        _doubleBuffer.swap(filter[0].nSamples * _channels * sizeof(int16_t));
+    }
+    _processing = false;
+}
 
-    // fill final buffer with PCM samples
-    Open_PDM_Filter_64(rawBuffer[rawBufferIndex], finalBuffer, 1, &filter);
-
-    if (cutSamples) {
-        memset(finalBuffer, 0, cutSamples);
-        cutSamples = 0;
+void PDMClass::_bufferDone(int i) {
+    // That buffer is ready for filtering, the other channel is already on the next
+    rawBufferReady++;
+    if (rawBufferReady == rawBufferCount - 1) {
+        // Overrun, the one this channel goes to next was never filtered.  Drop it
+        rawBufferRead = (rawBufferRead + 1) % rawBufferCount;
+        rawBufferReady--;
     }
+    rawBufferDMA[i] = (rawBufferDMA[i] + 2) % rawBufferCount;
+    dma_channel_set_write_addr(_dmaChannel[i], rawBuffer[rawBufferDMA[i]], false);
+    dma_channel_set_trans_count(_dmaChannel[i], rawBufferSize, false);
+}
 
-    // swap final buffer and raw buffers' indexes
-    finalBuffer = (int16_t*)_doubleBuffer.data();
-    _doubleBuffer.swap(filter.nSamples * sizeof(int16_t));
-    rawBufferIndex = shadowIndex;
+void PDMClass::IrqHandler(bool halftranfer) {
+    (void) halftranfer;
+    bool got = false;
+    for (int i = 0; i < 2; i++) {
+        if ((_dmaChannel[i] < 0) || !dma_channel_get_irq0_status(_dmaChannel[i])) {
+            continue;
+        }
+        // Clear the interrupt request.
+        dma_hw->ints0 = 1u << _dmaChannel[i];
+        got = true;
+        _bufferDone(i);
+    }
 
-    if (_onReceive) {
+    if (got && _onReceive) {
         _onReceive();
     }
 }
+
+// Already acknowledged by the core's dispatcher
+void PDMClass::_dmaIRQ(int channel, void *param) {
+    PDMClass *me = (PDMClass *)param;
+    for (int i = 0; i < 2; i++) {
+        if (me->_dmaChannel[i] == channel) {
+            me->_bufferDone(i);
+            if (me->_onReceive) {
+                me->_onReceive();
+            }
+        }
+    }
+}
+
 #ifdef PIN_PDM_DIN
 PDMClass PDM(PIN_PDM_DIN, PIN_PDM_CLK, -1);
 #endif // PIN_PDM_DIN
-
-
@@ -33,6 +33,64 @@ static inline pio_sm_config pdm_pio_program_get_default_config(uint offset) {
     sm_config_set_sideset(&c, 1, false, false);
     return c;
 }
+#endif
+
+// -------------- //
+// pdm_pio_stereo //
+// -------------- //
+
+#define pdm_pio_stereo_wrap_target 0
+#define pdm_pio_stereo_wrap 1
+
+static const uint16_t pdm_pio_stereo_program_instructions[] = {
+    //     .wrap_target
+    0x4001, //  0: in     pins, 1         side 0
+    0x5001, //  1: in     pins, 1         side 1
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program pdm_pio_stereo_program = {
+    .instructions = pdm_pio_stereo_program_instructions,
+    .length = 2,
+    .origin = -1,
+};
+
+static inline pio_sm_config pdm_pio_stereo_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + pdm_pio_stereo_wrap_target, offset + pdm_pio_stereo_wrap);
+    sm_config_set_sideset(&c, 1, false, false);
+    return c;
+}
+#endif
+
+// ------------ //
+// pdm_pio_quad //
+// ------------ //
+
+#define pdm_pio_quad_wrap_target 0
+#define pdm_pio_quad_wrap 1
+
+static const uint16_t pdm_pio_quad_program_instructions[] = {
+    //     .wrap_target
+    0x4002, //  0: in     pins, 2         side 0
+    0x5002, //  1: in     pins, 2         side 1
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program pdm_pio_quad_program = {
+    .instructions = pdm_pio_quad_program_instructions,
+    .length = 2,
+    .origin = -1,
+};
+
+static inline pio_sm_config pdm_pio_quad_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + pdm_pio_quad_wrap_target, offset + pdm_pio_quad_wrap);
+    sm_config_set_sideset(&c, 1, false, false);
+    return c;
+}
 
 #include "hardware/gpio.h"
 static inline void pdm_pio_program_init(PIO pio, uint sm, uint offset, uint clkPin, uint dataPin, float clkDiv) {
@@ -52,6 +110,22 @@ static inline void pdm_pio_program_init(PIO pio, uint sm, uint offset, uint clkP
     pio_sm_init(pio, sm, offset, &c);
     pio_sm_set_enabled(pio, sm, true);
 }
+// Stereo and quad, autopushing bytes with the mics' bits in turn
+static inline void pdm_pio_multi_program_init(PIO pio, uint sm, uint offset, uint clkPin, uint dataPin, uint dataPins, float clkDiv) {
+    // Both programs are two instructions, wrapping the same way
+    pio_sm_config c = pdm_pio_stereo_program_get_default_config(offset);
+    sm_config_set_in_shift(&c, false, true, 8);
+    sm_config_set_in_pins(&c, dataPin);
+    sm_config_set_sideset_pins(&c, clkPin);
+    sm_config_set_clkdiv(&c, clkDiv);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    pio_sm_set_consecutive_pindirs(pio, sm, dataPin, dataPins, false);
+    pio_sm_set_consecutive_pindirs(pio, sm, clkPin, 1, true);
+    pio_sm_set_pins_with_mask(pio, sm, 0, (1u << clkPin));
+    pio_gpio_init(pio, clkPin);
+    pio_sm_init(pio, sm, offset, &c);
+    pio_sm_set_enabled(pio, sm, true);
+}
 
 #endif
 
@@ -0,0 +1,48 @@
+/*
+  Mixes a looping sine drone with short 8-bit "blips" and plays them on
+  GPIO 0 using PWM.  Connect the pin through a simple RC low-pass filter
+  (e.g. 1K and 10nF) to an amplifier or headphones.
+
+  The mixing runs on core 1 here, from loop1(), so nothing happens in the
+  DMA interrupt apart from re-arming the next buffer.
+
+  Released to the public domain by Earle F. Philhower, III <earlephilhower@yahoo.com>
+*/
+
+#include <PWMAudio.h>
+
+PWMAudio pwm(0);
+
+const int sampleRate = 22050;
+
+int16_t sine[100];    // 220.5Hz at 22050Hz
+uint8_t blip[2205];   // 100ms decaying 8-bit square wave
+
+void setup() {
+  for (int i = 0; i < 100; i++) {
+    sine[i] = 8000 * sin(2.0 * PI * i / 100.0);
+  }
+  for (int i = 0; i < 2205; i++) {
+    int amp = 127 - (i * 127) / 2205;
+    blip[i] = 128 + (((i / 25) & 1) ? amp : -amp);
+  }
+  pwm.setAutoUpdate(false);
+  pwm.begin(sampleRate);
+  // Always-on background tone at half volume
+  pwm.play(sine, 100, true, 0, 128, true);
+}
+
+void loop() {
+  // Every half second play a blip, alternately at the native and half rate
+  static bool slow = false;
+  pwm.play(blip, sizeof(blip), false, slow ? sampleRate / 2 : 0);
+  slow = !slow;
+  delay(500);
+}
+
+void setup1() {
+}
+
+void loop1() {
+  pwm.update();
+}
@@ -0,0 +1,338 @@
+/*
+    PWMAudio - Mixes and plays PCM samples out a GPIO using PWM and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <hardware/pwm.h>
+#include "PWMAudio.h"
+
+// Instances mixing from the DMA IRQ.  One per PWM slice is the most that can ever run
+static PWMAudio *__autoUpdate[NUM_PWM_SLICES];
+
+PWMAudio::PWMAudio(pin_size_t pin) {
+    _pin = pin;
+    _freq = 22050;
+    _bits = 10;
+    _buffers = 6;
+    _bufferWords = 256;
+    _autoUpdate = true;
+    _running = false;
+    _top = 0;
+    _timer = -1;
+    _arb = nullptr;
+    _accum = nullptr;
+    _mixing = false;
+    memset(_voice, 0, sizeof(_voice));
+}
+
+PWMAudio::~PWMAudio() {
+    end();
+}
+
+bool PWMAudio::setPin(pin_size_t pin) {
+    if (_running || (pin > 29)) {
+        return false;
+    }
+    _pin = pin;
+    return true;
+}
+
+bool PWMAudio::setFrequency(int sampleRate) {
+    if (_running || (sampleRate <= 0)) {
+        return false;
+    }
+    _freq = sampleRate;
+    return true;
+}
+
+// PWM carrier is clk_sys / 2^bits, so fewer bits push it further above the audio band
+bool PWMAudio::setResolution(int bits) {
+    if (_running || (bits < 6) || (bits > 14)) {
+        return false;
+    }
+    _bits = bits;
+    return true;
+}
+
+bool PWMAudio::setBuffers(size_t buffers, size_t bufferWords) {
+    if (_running || (buffers < 3) || (bufferWords < 8)) {
+        return false;
+    }
+    _buffers = buffers;
+    _bufferWords = bufferWords;
+    return true;
+}
+
+bool PWMAudio::setAutoUpdate(bool autoUpdate) {
+    if (_running) {
+        return false;
+    }
+    _autoUpdate = autoUpdate;
+    return true;
+}
+
+bool PWMAudio::begin() {
+    if (_running) {
+        return false;
+    }
+    // The DMA pacing timer ticks at clk_sys * num / den, so find the closest 16-bit fraction
+    uint32_t sys = clock_get_hz(clk_sys);
+    uint32_t bestNum = 0, bestDen = 1;
+    uint64_t bestErr = UINT64_MAX;
+    for (uint32_t den = 1; den < 65536; den++) {
+        uint64_t num = ((uint64_t)_freq * den + sys / 2) / sys;
+        if (num > 65535) {
+            break;
+        }
+        if (!num) {
+            continue;
+        }
+        uint64_t rate = (uint64_t)sys * num;
+        uint64_t want = (uint64_t)_freq * den;
+        uint64_t err = rate > want ? rate - want : want - rate;
+        // Compare errors scaled by the other candidate's denominator to stay in integers
+        if (err * bestDen < bestErr * den) {
+            bestErr = err;
+            bestNum = num;
+            bestDen = den;
+            if (!err) {
+                break;
+            }
+        }
+    }
+    if (!bestNum) {
+        DEBUGV("PWMAudio: Unable to generate sample rate %d\n", _freq);
+        return false;
+    }
+    _timer = dma_claim_unused_timer(false);
+    if (_timer < 0) {
+        DEBUGV("PWMAudio: No DMA timer available\n");
+        return false;
+    }
+    dma_timer_set_fraction(_timer, bestNum, bestDen);
+
+    _top = (1 << _bits) - 1;
+    uint slice = pwm_gpio_to_slice_num(_pin);
+    pwm_config c = pwm_get_default_config();
+    pwm_config_set_wrap(&c, _top);
+    pwm_init(slice, &c, false);
+    // Both halves of CC get the same level, only the one on our pin is ever output
+    uint32_t mid = (_top + 1) / 2;
+    pwm_set_both_levels(slice, mid, mid);
+    gpio_set_function(_pin, GPIO_FUNC_PWM);
+    pwm_set_enabled(slice, true);
+
+    critical_section_init(&_lock);
+    memset(_voice, 0, sizeof(_voice));
+    _accum = new int32_t[_bufferWords];
+    _arb = new AudioRingBuffer(_buffers, _bufferWords, mid | (mid << 16), OUTPUT);
+    if (_autoUpdate) {
+        __autoUpdate[slice] = this;
+        _arb->setCallback(_irq);
+    }
+    _running = true;
+    if (!_arb->begin(dma_get_timer_dreq(_timer), &pwm_hw->slice[slice].cc)) {
+        end();
+        return false;
+    }
+    return true;
+}
+
+void PWMAudio::end() {
+    if (_timer >= 0) {
+        // A zero fraction stops the pacing timer so the DMA stalls before it's torn down
+        dma_timer_set_fraction(_timer, 0, 1);
+    }
+    uint slice = pwm_gpio_to_slice_num(_pin);
+    if (__autoUpdate[slice] == this) {
+        __autoUpdate[slice] = nullptr;
+    }
+    delete _arb;
+    _arb = nullptr;
+    delete[] _accum;
+    _accum = nullptr;
+    if (_timer >= 0) {
+        dma_timer_unclaim(_timer);
+        _timer = -1;
+    }
+    if (_running) {
+        pwm_set_enabled(slice, false);
+        gpio_set_function(_pin, GPIO_FUNC_SIO);
+        critical_section_deinit(&_lock);
+    }
+    _running = false;
+}
+
+int PWMAudio::play(const void *samples, size_t count, bool is16Bit, int sampleRate, uint16_t volume, bool loop) {
+    if (!_running || !samples || !count) {
+        return -1;
+    }
+    uint32_t step = sampleRate ? (uint32_t)(((uint64_t)sampleRate << 16) / _freq) : 1 << 16;
+    int ret = -1;
+    critical_section_enter_blocking(&_lock);
+    for (int i = 0; i < PWMAUDIO_VOICES; i++) {
+        Voice *v = &_voice[i];
+        if (!v->active) {
+            v->data = samples;
+            v->count = count;
+            v->pos = 0;
+            v->frac = 0;
+            v->step = step;
+            v->volume = volume;
+            v->is16Bit = is16Bit;
+            v->loop = loop;
+            v->gen++;
+            v->active = true;
+            ret = i;
+            break;
+        }
+    }
+    critical_section_exit(&_lock);
+    return ret;
+}
+
+void PWMAudio::stop(int voice) {
+    if (!_running || (voice < 0) || (voice >= PWMAUDIO_VOICES)) {
+        return;
+    }
+    critical_section_enter_blocking(&_lock);
+    _voice[voice].active = false;
+    _voice[voice].gen++;
+    critical_section_exit(&_lock);
+}
+
+void PWMAudio::stop() {
+    for (int i = 0; i < PWMAUDIO_VOICES; i++) {
+        stop(i);
+    }
+}
+
+bool PWMAudio::playing(int voice) {
+    if (!_running || (voice < 0) || (voice >= PWMAUDIO_VOICES)) {
+        return false;
+    }
+    return _voice[voice].active;
+}
+
+void PWMAudio::setVolume(int voice, uint16_t volume) {
+    if (!_running || (voice < 0) || (voice >= PWMAUDIO_VOICES)) {
+        return;
+    }
+    critical_section_enter_blocking(&_lock);
+    _voice[voice].volume = volume;
+    critical_section_exit(&_lock);
+}
+
+bool PWMAudio::getUnderflow() {
+    if (!_running) {
+        return false;
+    }
+    return _arb->getOverUnderflow();
+}
+
+void PWMAudio::update() {
+    if (!_running || _mixing) {
+        return;
+    }
+    _mixing = true;
+    uint32_t *buff;
+    while ((buff = _arb->getWriteBuffer(false)) != nullptr) {
+        _mix(buff);
+        _arb->commitWriteBuffer();
+    }
+    _mixing = false;
+}
+
+// Resampling uses interpolator 0.  Lane 0 adds the 16.16 step to the position on every pop
+// and lane 1 turns the position into the sample's address, so each output sample is one
+// pop, one load and one multiply.  The position is relative to the start of each run, and
+// a run always stops before the end of the data (or 32K samples in) so neither can wrap.
+void __not_in_flash_func(PWMAudio::_mix)(uint32_t *buff) {
+    memset(_accum, 0, _bufferWords * sizeof(int32_t));
+    Interpolator interp(0);
+    InterpolatorSave save(interp); // We may have interrupted the app using it
+    interp.config(0, 0, 0, 31, false, false, false, true);
+    for (int i = 0; i < PWMAUDIO_VOICES; i++) {
+        // Mix from a copy so play()/stop() from the other core or the app never wait on us
+        critical_section_enter_blocking(&_lock);
+        Voice v = _voice[i];
+        critical_section_exit(&_lock);
+        if (!v.active) {
+            continue;
+        }
+        int32_t vol = v.volume;
+        interp.config(1, v.is16Bit ? 15 : 16, v.is16Bit ? 1 : 0, 31, false, true);
+        interp.setBase(0, v.step);
+        size_t n = 0;
+        while (n < _bufferWords) {
+            uint32_t left = v.count - v.pos;
+            left = left > 0x7fff ? 0x7fff : left;
+            size_t run = v.step ? ((left << 16) - v.frac + v.step - 1) / v.step : _bufferWords;
+            size_t end = (run < _bufferWords - n) ? n + run : _bufferWords;
+            interp.setAccumulator(0, v.frac);
+            if (v.is16Bit) {
+                interp.setBase(1, (uint32_t)((const int16_t *)v.data + v.pos));
+                for (; n < end; n++) {
+                    _accum[n] += (*(const int16_t *)interp.pop(1) * vol) >> 8;
+                }
+            } else {
+                interp.setBase(1, (uint32_t)((const uint8_t *)v.data + v.pos));
+                for (; n < end; n++) {
+                    _accum[n] += (((*(const uint8_t *)interp.pop(1)) - 128) * 256 * vol) >> 8;
+                }
+            }
+            uint32_t a = interp.accumulator(0);
+            v.frac = a & 0xffff;
+            v.pos += a >> 16;
+            if (v.pos >= v.count) {
+                if (v.loop) {
+                    v.pos %= v.count;
+                } else {
+                    v.active = false;
+                    break;
+                }
+            }
+        }
+        critical_section_enter_blocking(&_lock);
+        if (_voice[i].gen == v.gen) {
+            _voice[i].pos = v.pos;
+            _voice[i].frac = v.frac;
+            _voice[i].active = v.active;
+        }
+        critical_section_exit(&_lock);
+    }
+    int shift = 16 - _bits;
+    for (size_t n = 0; n < _bufferWords; n++) {
+        int32_t s = _accum[n];
+        s = s > 32767 ? 32767 : s < -32768 ? -32768 : s;
+        uint32_t level = (uint32_t)(s + 32768) >> shift;
+        buff[n] = level | (level << 16);
+    }
+}
+
+void __not_in_flash_func(PWMAudio::_irq)() {
+    for (size_t i = 0; i < NUM_PWM_SLICES; i++) {
+        if (__autoUpdate[i]) {
+            __autoUpdate[i]->update();
+        }
+    }
+}
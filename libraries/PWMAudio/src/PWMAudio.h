@@ -0,0 +1,94 @@
+/*
+    PWMAudio - Mixes and plays PCM samples out a GPIO using PWM and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+#include <Arduino.h>
+#include <pico/critical_section.h>
+#include <AudioRingBuffer.h>
+
+#ifndef PWMAUDIO_VOICES
+#define PWMAUDIO_VOICES 8
+#endif
+
+class PWMAudio {
+public:
+    PWMAudio(pin_size_t pin = 0);
+    virtual ~PWMAudio();
+
+    bool setPin(pin_size_t pin);
+    bool setFrequency(int sampleRate);
+    bool setResolution(int bits);
+    bool setBuffers(size_t buffers, size_t bufferWords);
+    bool setAutoUpdate(bool autoUpdate);
+
+    bool begin(int sampleRate) {
+        setFrequency(sampleRate);
+        return begin();
+    }
+    bool begin();
+    void end();
+
+    // Mixes into every free output buffer.  Called from the DMA IRQ unless auto update is
+    // off, in which case the application (on either core) must call it often enough
+    void update();
+
+    // Starts a voice playing, mono samples at their own rate (0 = the output rate), unsigned
+    // 8-bit or signed 16-bit.  Data may live in RAM or flash and must stay valid until the
+    // voice finishes or is stopped.  Returns the voice number, or -1 when all are busy
+    int play(const void *samples, size_t count, bool is16Bit = true, int sampleRate = 0, uint16_t volume = 256, bool loop = false);
+    void stop(int voice);
+    void stop();
+    bool playing(int voice);
+    void setVolume(int voice, uint16_t volume);
+
+    bool getUnderflow();
+
+private:
+    void _mix(uint32_t *buff);
+    static void _irq();
+
+    typedef struct {
+        const void *data;
+        uint32_t count;
+        uint32_t pos;      // Integer sample index
+        uint16_t frac;     // Fractional sample index, 0.16
+        uint32_t step;     // Samples per output sample, 16.16
+        uint16_t volume;   // 256 = unity
+        bool is16Bit;
+        bool loop;
+        bool active;
+        uint32_t gen;      // Bumped on every play/stop so the mixer can detect changes
+    } Voice;
+
+    pin_size_t _pin;
+    int _freq;
+    int _bits;
+    size_t _buffers;
+    size_t _bufferWords;
+    bool _autoUpdate;
+    bool _running;
+    uint16_t _top;
+    int _timer;
+    AudioRingBuffer *_arb;
+    int32_t *_accum;
+    critical_section_t _lock;
+    Voice _voice[PWMAUDIO_VOICES];
+    volatile bool _mixing;
+};
@@ -0,0 +1,51 @@
+// Clears an ILI9341 320x240 TFT in 8-bit 8080 mode to a new color every second, using
+// a DMA fill while the CPU is free to do other work
+//
+// D0..D7 on GPIO 0..7, WR on GPIO 8, DC on GPIO 9, CS on GPIO 10, RD on GPIO 11
+//
+// Released to the public domain by Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+#include <ParallelBus.h>
+
+ParallelBus tft(0, 8, 8, 9, 10, 11);
+
+void cmd(uint8_t c, const uint8_t *args = nullptr, size_t len = 0) {
+  tft.command(c);
+  if (len) {
+    tft.write(args, len);
+  }
+}
+
+void setup() {
+  tft.begin();
+  tft.beginTransaction(ParallelSettings(20000000));
+  cmd(0x01); // Software reset
+  delay(120);
+  cmd(0x11); // Sleep out
+  delay(120);
+  const uint8_t pixfmt[] = { 0x55 }; // 16 bits per pixel
+  cmd(0x3a, pixfmt, sizeof(pixfmt));
+  cmd(0x29); // Display on
+  const uint8_t cols[] = { 0, 0, 0x00, 0xef };
+  cmd(0x2a, cols, sizeof(cols));
+  const uint8_t rows[] = { 0, 0, 0x01, 0x3f };
+  cmd(0x2b, rows, sizeof(rows));
+  tft.endTransaction();
+}
+
+const uint16_t colors[] = { 0xf800, 0x07e0, 0x001f, 0xffff, 0x0000 };
+int c = 0;
+
+void loop() {
+  tft.beginTransaction(ParallelSettings(20000000));
+  cmd(0x2c); // Memory write
+  uint32_t start = micros();
+  tft.fillAsync(colors[c], 320 * 240);
+  while (!tft.finishedAsync()) {
+    // The CPU is free here
+  }
+  tft.endTransaction();
+  Serial.printf("Frame took %lu us\n", micros() - start);
+  c = (c + 1) % 5;
+  delay(1000);
+}
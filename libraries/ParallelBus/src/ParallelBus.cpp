@@ -0,0 +1,259 @@
+/*
+    ParallelBus - 8080-style 8/16-bit parallel display bus using PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "ParallelBus.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include "parallel_bus.pio.h"
+
+static PIOProgram _parallel8Pgm(&parallel8_program);
+static PIOProgram _parallel16Pgm(&parallel16_program);
+
+ParallelBus::ParallelBus(pin_size_t data0, int width, pin_size_t wr, pin_size_t dc, pin_size_t cs, pin_size_t rd) {
+    _data0 = data0;
+    _width = width;
+    _wr = wr;
+    _dc = dc;
+    _cs = cs;
+    _rd = rd;
+    _running = false;
+    _initted = false;
+    _pio = nullptr;
+    _sm = -1;
+    _offset = -1;
+    _dma = -1;
+}
+
+ParallelBus::~ParallelBus() {
+    end();
+}
+
+bool ParallelBus::begin() {
+    if (_running) {
+        return false;
+    }
+    if (((_width != 8) && (_width != 16)) || (_data0 + _width > 30) || (_wr > 29) || (_dc > 29) ||
+            ((_cs != NOPIN) && (_cs > 29)) || ((_rd != NOPIN) && (_rd > 29))) {
+        DEBUGV("ParallelBus: Illegal pins or width\n");
+        return false;
+    }
+    PIOProgram *pgm = (_width == 8) ? &_parallel8Pgm : &_parallel16Pgm;
+    if (!pgm->prepare(&_pio, &_sm, &_offset)) {
+        DEBUGV("ParallelBus: No free PIO state machine\n");
+        return false;
+    }
+    _dma = dma_claim_unused_channel(false);
+    if (_dma < 0) {
+        DEBUGV("ParallelBus: No free DMA channel\n");
+        PIOProgram::unprepare(_pio, _sm);
+        return false;
+    }
+    pinMode(_dc, OUTPUT);
+    gpio_put(_dc, 1);
+    if (_cs != NOPIN) {
+        pinMode(_cs, OUTPUT);
+        gpio_put(_cs, 1);
+    }
+    if (_rd != NOPIN) {
+        pinMode(_rd, OUTPUT);
+        gpio_put(_rd, 1);
+    }
+    _settings = ParallelSettings();
+    parallel_bus_program_init(_pio, _sm, _offset, _data0, _width, _wr, 1.0f);
+    _setClock(_settings.getClockFreq());
+    pio_sm_set_enabled(_pio, _sm, true);
+    _running = true;
+    return true;
+}
+
+void ParallelBus::end() {
+    if (!_running) {
+        return;
+    }
+    abortAsync();
+    if (_initted) {
+        endTransaction();
+    }
+    pio_sm_set_enabled(_pio, _sm, false);
+    PIOProgram::unprepare(_pio, _sm);
+    _sm = -1;
+    dma_channel_unclaim(_dma);
+    _dma = -1;
+    for (int i = 0; i < _width; i++) {
+        gpio_set_function(_data0 + i, GPIO_FUNC_NULL);
+    }
+    gpio_set_function(_wr, GPIO_FUNC_NULL);
+    _running = false;
+}
+
+void ParallelBus::_setClock(uint32_t hz) {
+    // 2 PIO cycles per word
+    float div = clock_get_hz(clk_sys) / (2.0f * hz);
+    pio_sm_set_clkdiv(_pio, _sm, div < 1.0f ? 1.0f : div);
+}
+
+void ParallelBus::beginTransaction(ParallelSettings settings) {
+    if (!_running) {
+        return;
+    }
+    waitAsync();
+    if (settings != _settings) {
+        _setClock(settings.getClockFreq());
+        _settings = settings;
+    }
+    if (_cs != NOPIN) {
+        gpio_put(_cs, 0);
+    }
+    _initted = true;
+}
+
+void ParallelBus::endTransaction() {
+    if (!_running) {
+        return;
+    }
+    waitAsync();
+    _waitIdle();
+    if (_cs != NOPIN) {
+        gpio_put(_cs, 1);
+    }
+    _initted = false;
+}
+
+// Returns once the SM has sent everything and is waiting on an empty FIFO with WR high
+void ParallelBus::_waitIdle() {
+    uint32_t stall = 1u << (PIO_FDEBUG_TXSTALL_LSB + _sm);
+    _pio->fdebug = stall;
+    while (!(_pio->fdebug & stall)) {
+        /* noop busy wait */
+    }
+}
+
+void ParallelBus::command(uint16_t cmd) {
+    if (!_running) {
+        return;
+    }
+    waitAsync();
+    // DC has to stay put until the display latches the data words before it, and the command
+    _waitIdle();
+    gpio_put(_dc, 0);
+    pio_sm_put_blocking(_pio, _sm, cmd);
+    _waitIdle();
+    gpio_put(_dc, 1);
+}
+
+void ParallelBus::write(uint16_t data) {
+    if (!_running) {
+        return;
+    }
+    waitAsync();
+    pio_sm_put_blocking(_pio, _sm, data);
+}
+
+void ParallelBus::write16(uint16_t data) {
+    if (!_running) {
+        return;
+    }
+    waitAsync();
+    if (_width == 8) {
+        pio_sm_put_blocking(_pio, _sm, data >> 8);
+    }
+    pio_sm_put_blocking(_pio, _sm, data);
+}
+
+void ParallelBus::write(const void *buf, size_t count) {
+    if (!_running || !buf || !count) {
+        return;
+    }
+    if ((count >= _dmaThreshold) && writeAsync(buf, count)) {
+        waitAsync();
+        return;
+    }
+    waitAsync();
+    if (_width == 8) {
+        const uint8_t *p = (const uint8_t *)buf;
+        while (count--) {
+            pio_sm_put_blocking(_pio, _sm, *p++);
+        }
+    } else {
+        const uint16_t *p = (const uint16_t *)buf;
+        while (count--) {
+            pio_sm_put_blocking(_pio, _sm, *p++);
+        }
+    }
+}
+
+bool ParallelBus::writeAsync(const void *buf, size_t count) {
+    if (!_running || !buf || !count || dma_channel_is_busy(_dma)) {
+        return false;
+    }
+    // Narrow DMA writes are replicated across the FIFO word, the OSR takes the low bits
+    dma_channel_config c = dma_channel_get_default_config(_dma);
+    channel_config_set_transfer_data_size(&c, (_width == 8) ? DMA_SIZE_8 : DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(_pio, _sm, true));
+    dma_channel_configure(_dma, &c, &_pio->txf[_sm], buf, count, true);
+    return true;
+}
+
+bool ParallelBus::fillAsync(uint16_t value, size_t count) {
+    if (!_running || !count || dma_channel_is_busy(_dma)) {
+        return false;
+    }
+    dma_channel_config c = dma_channel_get_default_config(_dma);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(_pio, _sm, true));
+    if (_width == 8) {
+        // Loop over the 2 bytes, high one first
+        uint8_t *b = (uint8_t *)_fill;
+        b[0] = value >> 8;
+        b[1] = value & 0xff;
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_ring(&c, false, 1);
+        count *= 2;
+    } else {
+        _fill[0] = value;
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+        channel_config_set_read_increment(&c, false);
+    }
+    dma_channel_configure(_dma, &c, &_pio->txf[_sm], _fill, count, true);
+    return true;
+}
+
+bool ParallelBus::finishedAsync() {
+    return !_running || !dma_channel_is_busy(_dma);
+}
+
+void ParallelBus::waitAsync() {
+    if (!_running) {
+        return;
+    }
+    while (dma_channel_is_busy(_dma)) {
+        /* noop busy wait */
+    }
+}
+
+void ParallelBus::abortAsync() {
+    if (!_running) {
+        return;
+    }
+    dma_channel_abort(_dma);
+}
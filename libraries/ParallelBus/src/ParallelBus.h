@@ -0,0 +1,95 @@
+/*
+    ParallelBus - 8080-style 8/16-bit parallel display bus using PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+
+class ParallelSettings {
+public:
+    // Clock is the WR strobe rate, in words per second
+    ParallelSettings(uint32_t clock = 10000000) {
+        _clock = clock;
+    }
+    uint32_t getClockFreq() const {
+        return _clock;
+    }
+    bool operator==(const ParallelSettings &rhs) const {
+        return _clock == rhs._clock;
+    }
+    bool operator!=(const ParallelSettings &rhs) const {
+        return !(*this == rhs);
+    }
+
+private:
+    uint32_t _clock;
+};
+
+class ParallelBus {
+public:
+    static const pin_size_t NOPIN = 0xff;
+
+    // Data is on width (8 or 16) consecutive GPIOs starting at data0.  DC (RS) and the
+    // optional CS are driven from the CPU, RD is just held high since only writes are done
+    ParallelBus(pin_size_t data0, int width, pin_size_t wr, pin_size_t dc, pin_size_t cs = NOPIN, pin_size_t rd = NOPIN);
+    ~ParallelBus();
+
+    bool begin();
+    void end();
+
+    // Call before/after every complete transaction, CS is low in between
+    void beginTransaction(ParallelSettings settings = ParallelSettings());
+    void endTransaction();
+
+    // Sends a single word with DC low
+    void command(uint16_t cmd);
+    // Single bus word
+    void write(uint16_t data);
+    // 16-bit value, high byte first on an 8-bit bus
+    void write16(uint16_t data);
+    // Words of the bus width, uint8_t or uint16_t to match.  Large buffers go by DMA
+    void write(const void *buf, size_t count);
+
+    // DMA based transfers running in the background.  Buffers need to remain valid and
+    // no other bus calls may be made until finishedAsync() returns true.
+    bool writeAsync(const void *buf, size_t count);
+    // Sends count copies of a 16-bit value as write16() would
+    bool fillAsync(uint16_t value, size_t count);
+    bool finishedAsync();
+    void waitAsync();
+    void abortAsync();
+
+private:
+    void _waitIdle();
+    void _setClock(uint32_t hz);
+
+    pin_size_t _data0, _wr, _dc, _cs, _rd;
+    int _width;
+    bool _running;
+    bool _initted;
+    ParallelSettings _settings;
+    PIO _pio;
+    int _sm;
+    int _offset;
+    int _dma;
+    static constexpr size_t _dmaThreshold = 32; // Blocking writes at least this big will use DMA
+    uint16_t _fill[2] __attribute__((aligned(4))); // Ring source for fillAsync
+};
@@ -0,0 +1,88 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// --------- //
+// parallel8 //
+// --------- //
+
+#define parallel8_wrap_target 0
+#define parallel8_wrap 1
+
+static const uint16_t parallel8_program_instructions[] = {
+    //     .wrap_target
+    0x90a0, //  0: pull   block           side 1
+    0x6008, //  1: out    pins, 8         side 0
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program parallel8_program = {
+    .instructions = parallel8_program_instructions,
+    .length = 2,
+    .origin = -1,
+};
+
+static inline pio_sm_config parallel8_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + parallel8_wrap_target, offset + parallel8_wrap);
+    sm_config_set_sideset(&c, 1, false, false);
+    return c;
+}
+#endif
+
+// ---------- //
+// parallel16 //
+// ---------- //
+
+#define parallel16_wrap_target 0
+#define parallel16_wrap 1
+
+static const uint16_t parallel16_program_instructions[] = {
+    //     .wrap_target
+    0x90a0, //  0: pull   block           side 1
+    0x6010, //  1: out    pins, 16        side 0
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program parallel16_program = {
+    .instructions = parallel16_program_instructions,
+    .length = 2,
+    .origin = -1,
+};
+
+static inline pio_sm_config parallel16_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + parallel16_wrap_target, offset + parallel16_wrap);
+    sm_config_set_sideset(&c, 1, false, false);
+    return c;
+}
+
+static inline void parallel_bus_program_init(PIO pio, uint sm, uint offset, uint data0, uint width, uint wr, float div) {
+    for (uint i = 0; i < width; i++) {
+        pio_gpio_init(pio, data0 + i);
+    }
+    pio_gpio_init(pio, wr);
+    pio_sm_set_pins_with_mask(pio, sm, 1u << wr, (((1u << width) - 1) << data0) | (1u << wr));
+    pio_sm_set_consecutive_pindirs(pio, sm, data0, width, true);
+    pio_sm_set_consecutive_pindirs(pio, sm, wr, 1, true);
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset, offset + 1);
+    sm_config_set_sideset(&c, 1, false, false);
+    sm_config_set_out_pins(&c, data0, width);
+    sm_config_set_sideset_pins(&c, wr);
+    sm_config_set_out_shift(&c, true, false, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv(&c, div);
+    pio_sm_init(pio, sm, offset, &c);
+}
+
+#endif
+
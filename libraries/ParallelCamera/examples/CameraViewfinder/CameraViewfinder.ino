@@ -0,0 +1,90 @@
+// Shows an OV7670 camera's 160x120 RGB565 picture on an ST7735 160x128 SPI TFT.  One frame
+// buffer is captured into while the other goes to the display by DMA, so the CPU is only
+// needed to start each transfer.
+//
+// Camera D0..D7 on GPIO 6..13, PCLK on GPIO 14, HREF on GPIO 15, VSYNC on GPIO 20, XCLK on
+// GPIO 21, SIOD/SIOC on the default Wire pins (GPIO 4/5, with pull-ups)
+// TFT SCK on GPIO 18, SDA (MOSI) on GPIO 19, CS on GPIO 17, DC on GPIO 22
+//
+// Released to the public domain by Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+#include <ParallelCamera.h>
+#include <SPI.h>
+#include <Wire.h>
+
+#define WIDTH 160
+#define HEIGHT 120
+#define TFT_CS 17
+#define TFT_DC 22
+
+ParallelCamera cam(6, 14, 15, 20, 21);
+uint32_t frame[2][WIDTH * HEIGHT * 2 / 4];
+
+void sccb(uint8_t reg, uint8_t val) {
+  Wire.beginTransmission(0x21);
+  Wire.write(reg);
+  Wire.write(val);
+  Wire.endTransmission();
+}
+
+void cmd(uint8_t c, const uint8_t *args = nullptr, size_t len = 0) {
+  digitalWrite(TFT_DC, LOW);
+  SPI.transfer(c);
+  digitalWrite(TFT_DC, HIGH);
+  while (len--) {
+    SPI.transfer(*(args++));
+  }
+}
+
+void setup() {
+  // XCLK has to be running before the sensor will answer
+  cam.begin(WIDTH, HEIGHT, 2, 24000000);
+  Wire.begin();
+  sccb(0x12, 0x80); // COM7, reset
+  delay(10);
+  sccb(0x11, 0x01); // CLKRC, XCLK / 2
+  sccb(0x12, 0x04); // COM7, RGB
+  sccb(0x40, 0xd0); // COM15, RGB565 full range
+  sccb(0x0c, 0x04); // COM3, enable downsampling
+  sccb(0x3e, 0x1a); // COM14, PCLK / 4 to match
+  sccb(0x72, 0x22); // Downsample by 4 each way, QVGA to QQVGA
+  sccb(0x73, 0xf2);
+  sccb(0xa2, 0x02);
+  // Adjust the rest (window, color matrix, etc.) for your module
+
+  pinMode(TFT_CS, OUTPUT);
+  pinMode(TFT_DC, OUTPUT);
+  SPI.begin();
+  SPI.beginTransaction(SPISettings(40000000, MSBFIRST, SPI_MODE0));
+  digitalWrite(TFT_CS, LOW);
+  cmd(0x01); // Software reset
+  delay(150);
+  cmd(0x11); // Sleep out
+  delay(150);
+  const uint8_t pixfmt[] = { 0x05 }; // 16 bits per pixel
+  cmd(0x3a, pixfmt, sizeof(pixfmt));
+  const uint8_t cols[] = { 0, 0, 0, WIDTH - 1 };
+  cmd(0x2a, cols, sizeof(cols));
+  const uint8_t rows[] = { 0, 0, 0, HEIGHT - 1 };
+  cmd(0x2b, rows, sizeof(rows));
+  cmd(0x29); // Display on
+
+  cam.startFrames(frame[0], frame[1]);
+}
+
+uint32_t last = 0;
+
+void loop() {
+  // The frame being shown is only handed back by the next getFrame(), so wait for the
+  // display first
+  if (!SPI.finishedAsync() || !cam.available()) {
+    return;
+  }
+  const uint8_t *f = cam.getFrame();
+  cmd(0x2c); // Memory write, the sensor sends RGB565 high byte first just as the TFT wants
+  SPI.transferAsync(f, nullptr, WIDTH * HEIGHT * 2);
+  if (millis() - last >= 5000) {
+    last = millis();
+    Serial.printf("%lu frames\n", cam.frames());
+  }
+}
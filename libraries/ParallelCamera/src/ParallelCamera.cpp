@@ -0,0 +1,330 @@
+/*
+    ParallelCamera - 8-bit DVP camera capture using PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "ParallelCamera.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/pwm.h>
+#include "parallel_camera.pio.h"
+
+ParallelCamera::ParallelCamera(pin_size_t data0, pin_size_t pclk, pin_size_t href, pin_size_t vsync, pin_size_t xclk) {
+    _data0 = data0;
+    _pclk = pclk;
+    _href = href;
+    _vsync = vsync;
+    _xclk = xclk;
+    _xclkHz = 0;
+    _width = 0;
+    _height = 0;
+    _lineBytes = 0;
+    _running = false;
+    _capturing = false;
+    _pio = nullptr;
+    _sm = -1;
+    _offset = -1;
+    _buf[0] = _buf[1] = nullptr;
+    _nbuf = 0;
+    _lineMode = false;
+    _perLine = false;
+    _ringLines = 0;
+    _ringPos = 0;
+    _line = 0;
+    _fill = _ready = _held = -1;
+    _frames = 0;
+    _lineCB = nullptr;
+    _lineParam = nullptr;
+    _frameCB = nullptr;
+    _frameParam = nullptr;
+}
+
+ParallelCamera::~ParallelCamera() {
+    end();
+}
+
+bool ParallelCamera::begin(int width, int height, int bytesPerPixel, uint32_t xclk) {
+    if (_running) {
+        return false;
+    }
+    int lineBytes = width * bytesPerPixel;
+    if ((_data0 > 22) || (_pclk > 29) || (_href > 29) || (_vsync > 29) || ((_xclk != NOPIN) && (_xclk > 29))) {
+        DEBUGV("ParallelCamera: Illegal pins\n");
+        return false;
+    }
+    if ((width < 1) || (height < 1) || (height > 65536) || (bytesPerPixel < 1) || (lineBytes > 65536) || (lineBytes & 3)) {
+        DEBUGV("ParallelCamera: Illegal frame size\n");
+        return false;
+    }
+    // Copy the program, pointing each "wait gpio" at its signal
+    const pin_size_t sig[3] = { _vsync, _href, _pclk };
+    memcpy(_insn, parallel_camera_program.instructions, sizeof(_insn));
+    for (int i = 0; i < parallel_camera_program.length; i++) {
+        if ((_insn[i] & 0xe060) == 0x2000) {
+            _insn[i] = (_insn[i] & ~0x1f) | sig[_insn[i] & 0x1f];
+        }
+    }
+    _pgm.instructions = _insn;
+    _pgm.length = parallel_camera_program.length;
+    _pgm.origin = parallel_camera_program.origin;
+    if (!_program.prepare(&_pio, &_sm, &_offset)) {
+        DEBUGV("ParallelCamera: No free PIO state machine\n");
+        return false;
+    }
+    if (!_dma.claim()) {
+        DEBUGV("ParallelCamera: No free DMA channel\n");
+        PIOProgram::unprepare(_pio, _sm);
+        return false;
+    }
+    _width = width;
+    _height = height;
+    _lineBytes = lineBytes;
+    _frames = 0;
+
+    for (int i = 0; i < 8; i++) {
+        pinMode(_data0 + i, INPUT);
+    }
+    pinMode(_pclk, INPUT);
+    pinMode(_href, INPUT);
+    pinMode(_vsync, INPUT);
+    parallel_camera_program_init(_pio, _sm, _offset, _data0);
+
+    _dma.setSize(DMA_SIZE_32);
+    _dma.setIncrement(false, true);
+    _dma.setDREQ(pio_get_dreq(_pio, _sm, false));
+    _dma.onComplete(_dmaIRQ, this);
+
+    // Sits on the "pull" until a frame is asked for
+    pio_sm_set_enabled(_pio, _sm, true);
+
+    if (_xclk != NOPIN) {
+        _xclkHz = xclk;
+        _setXCLK();
+        gpio_set_function(_xclk, GPIO_FUNC_PWM);
+        _clockNotifier.attach();
+    }
+    _running = true;
+    return true;
+}
+
+void ParallelCamera::end() {
+    if (!_running) {
+        return;
+    }
+    stop();
+    if (_xclk != NOPIN) {
+        _clockNotifier.detach();
+        pwm_set_enabled(pwm_gpio_to_slice_num(_xclk), false);
+        pinMode(_xclk, INPUT);
+    }
+    pio_sm_set_enabled(_pio, _sm, false);
+    _dma.unclaim();
+    PIOProgram::unprepare(_pio, _sm);
+    _sm = -1;
+    _running = false;
+}
+
+void ParallelCamera::_setXCLK() {
+    // 50% duty at the closest whole divisor of clk_sys
+    uint32_t period = (clock_get_hz(clk_sys) + _xclkHz / 2) / _xclkHz;
+    if (period < 2) {
+        period = 2;
+    } else if (period > 65536) {
+        period = 65536;
+    }
+    uint slice = pwm_gpio_to_slice_num(_xclk);
+    pwm_config c = pwm_get_default_config();
+    pwm_config_set_wrap(&c, period - 1);
+    pwm_init(slice, &c, false);
+    pwm_set_gpio_level(_xclk, period / 2);
+    pwm_set_enabled(slice, true);
+}
+
+void ParallelCamera::_clockChanged(void *arg, bool after) {
+    // The SM runs undivided, only XCLK needs to follow clk_sys
+    if (after) {
+        ((ParallelCamera *)arg)->_setXCLK();
+    }
+}
+
+void ParallelCamera::onLine(void (*fn)(int, const uint8_t *, void *), void *param) {
+    _lineCB = fn;
+    _lineParam = param;
+}
+
+void ParallelCamera::onFrame(void (*fn)(const uint8_t *, void *), void *param) {
+    _frameCB = fn;
+    _frameParam = param;
+}
+
+bool ParallelCamera::startFrames(void *buf0, void *buf1) {
+    if (!_running || _capturing || !buf0 || ((uintptr_t)buf0 & 3) || ((uintptr_t)buf1 & 3)) {
+        return false;
+    }
+    _buf[0] = (uint8_t *)buf0;
+    _buf[1] = (uint8_t *)buf1;
+    _nbuf = buf1 ? 2 : 1;
+    _lineMode = false;
+    _perLine = _lineCB != nullptr;
+    _ready = _held = -1;
+    _fill = 0;
+    _capturing = true;
+    noInterrupts();
+    _armFrame();
+    interrupts();
+    return true;
+}
+
+bool ParallelCamera::startLines(void *buf, int lines) {
+    if (!_running || _capturing || !buf || ((uintptr_t)buf & 3) || (lines < 1) || !_lineCB) {
+        return false;
+    }
+    _buf[0] = (uint8_t *)buf;
+    _buf[1] = nullptr;
+    _nbuf = 0;
+    _lineMode = true;
+    _perLine = true;
+    _ringLines = lines;
+    _ringPos = 0;
+    _ready = _held = _fill = -1;
+    _capturing = true;
+    noInterrupts();
+    _armFrame();
+    interrupts();
+    return true;
+}
+
+void ParallelCamera::stop() {
+    if (!_capturing) {
+        return;
+    }
+    _capturing = false;
+    _dma.abort();
+    // Drop any partial frame and go back to waiting for the next request
+    pio_sm_set_enabled(_pio, _sm, false);
+    pio_sm_clear_fifos(_pio, _sm);
+    pio_sm_restart(_pio, _sm);
+    pio_sm_exec(_pio, _sm, pio_encode_jmp(_offset + parallel_camera_offset_start));
+    pio_sm_set_enabled(_pio, _sm, true);
+    _fill = _ready = _held = -1;
+}
+
+bool ParallelCamera::available() {
+    return _ready >= 0;
+}
+
+const uint8_t *ParallelCamera::getFrame() {
+    const uint8_t *ret = nullptr;
+    noInterrupts();
+    if (_ready >= 0) {
+        _held = _ready;
+        _ready = -1;
+        ret = _buf[_held];
+        _resume();
+    }
+    interrupts();
+    return ret;
+}
+
+void ParallelCamera::releaseFrame() {
+    noInterrupts();
+    _held = -1;
+    _resume();
+    interrupts();
+}
+
+uint8_t *__not_in_flash_func(ParallelCamera::_lineAddr)(int line) {
+    if (_lineMode) {
+        return _buf[0] + (_ringPos % _ringLines) * _lineBytes;
+    }
+    return _buf[_fill] + line * _lineBytes;
+}
+
+// Called with interrupts off or from the DMA IRQ
+void __not_in_flash_func(ParallelCamera::_armFrame)() {
+    _line = 0;
+    uint32_t words = (_perLine ? _lineBytes : _lineBytes * _height) / 4;
+    _dma.start(_lineAddr(0), &_pio->rxf[_sm], words);
+    pio_sm_put(_pio, _sm, ((uint32_t)(_lineBytes - 1) << 16) | (_height - 1));
+}
+
+// A paused capture restarts into whichever buffer the application has given back
+void ParallelCamera::_resume() {
+    if (!_capturing || (_fill >= 0)) {
+        return;
+    }
+    for (int i = 0; i < _nbuf; i++) {
+        if ((i != _held) && (i != _ready)) {
+            _fill = i;
+            _armFrame();
+            return;
+        }
+    }
+}
+
+void __not_in_flash_func(ParallelCamera::_frameDone)() {
+    _frames++;
+    if (_lineMode) {
+        if (_frameCB) {
+            _frameCB(nullptr, _frameParam);
+        }
+        _armFrame();
+        return;
+    }
+    int done = _fill;
+    _ready = done;
+    if (_frameCB) {
+        _frameCB(_buf[done], _frameParam);
+    }
+    // Go straight on into the other buffer, dropping any older frame never picked up,
+    // unless it's still held.  A single buffer always waits for the application
+    int next = done ^ 1;
+    if ((_nbuf == 2) && (next != _held)) {
+        _fill = next;
+        _armFrame();
+    } else {
+        _fill = -1;
+    }
+}
+
+void __not_in_flash_func(ParallelCamera::_dmaIRQ)(int channel, void *param) {
+    (void) channel;
+    ParallelCamera *c = (ParallelCamera *)param;
+    if (!c->_capturing) {
+        return;
+    }
+    if (c->_perLine) {
+        int line = c->_line++;
+        const uint8_t *data = c->_lineAddr(line);
+        if (c->_lineMode) {
+            c->_ringPos++;
+        }
+        // Next line's transfer goes first, there's only HREF's blanking time to do it in
+        bool more = c->_line < c->_height;
+        if (more) {
+            c->_dma.start(c->_lineAddr(c->_line), &c->_pio->rxf[c->_sm], c->_lineBytes / 4);
+        }
+        if (c->_lineCB) {
+            c->_lineCB(line, data, c->_lineParam);
+        }
+        if (more) {
+            return;
+        }
+    }
+    c->_frameDone();
+}
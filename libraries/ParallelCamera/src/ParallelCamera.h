@@ -0,0 +1,110 @@
+/*
+    ParallelCamera - 8-bit DVP camera capture using PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+
+// Captures the pixel bus of OV7670, OV2640 and similar sensors.  A PIO SM waits for VSYNC,
+// then clocks in the bytes of each HREF line on PCLK and a DMA channel stores them, so the
+// CPU is only involved once per frame (or per line when asked for).  Setting the sensor's
+// registers over SCCB (Wire) is left to the application.
+class ParallelCamera {
+public:
+    static const pin_size_t NOPIN = 0xff;
+
+    // D0-D7 are on 8 consecutive GPIOs starting at data0.  If xclk is given the sensor's
+    // master clock is generated there by its PWM slice
+    ParallelCamera(pin_size_t data0, pin_size_t pclk, pin_size_t href, pin_size_t vsync, pin_size_t xclk = NOPIN);
+    ~ParallelCamera();
+
+    // The frame the sensor has been (or will be) set up to send.  width * bytesPerPixel must
+    // be a multiple of 4.  XCLK starts here, so the sensor can be configured afterwards
+    bool begin(int width, int height, int bytesPerPixel = 2, uint32_t xclk = 24000000);
+    void end();
+
+    // Captures continuously into one or two frame buffers of width * height * bytesPerPixel
+    // bytes, 4-byte aligned.  With two, one can be processed while the other fills
+    bool startFrames(void *buf0, void *buf1 = nullptr);
+    // Captures continuously through a ring of lines, each passed to the onLine() callback,
+    // for frames which don't fit in RAM.  The callback has to be done with a line before
+    // the ring comes back around to it
+    bool startLines(void *buf, int lines);
+    void stop();
+
+    // Whether a complete frame is waiting for getFrame()
+    bool available();
+    // Returns the newest complete frame, or nullptr if there's nothing new.  The buffer is
+    // not captured into until the next successful getFrame() or releaseFrame() call
+    const uint8_t *getFrame();
+    void releaseFrame();
+
+    // Called from **INTERRUPT CONTEXT** (DMA_IRQ_0) as each line or frame is captured.  In
+    // line mode the frame callback gets nullptr.  Set them before starting
+    void onLine(void (*fn)(int line, const uint8_t *data, void *param), void *param);
+    void onFrame(void (*fn)(const uint8_t *frame, void *param), void *param);
+
+    // Frames captured since begin()
+    uint32_t frames() {
+        return _frames;
+    }
+
+private:
+    static void _dmaIRQ(int channel, void *param);
+    static void _clockChanged(void *arg, bool after);
+    void _setXCLK();
+    void _armFrame();
+    void _frameDone();
+    void _resume();
+    uint8_t *_lineAddr(int line);
+
+    pin_size_t _data0, _pclk, _href, _vsync, _xclk;
+    uint32_t _xclkHz;
+    int _width, _height, _lineBytes;
+    bool _running;
+    volatile bool _capturing;
+
+    // The program with its "wait gpio"s pointed at VSYNC, HREF, and PCLK
+    uint16_t _insn[12];
+    pio_program_t _pgm;
+    PIOProgram _program{&_pgm};
+    PIO _pio;
+    int _sm;
+    int _offset;
+    DMAChannel _dma;
+    ClockNotifier _clockNotifier{_clockChanged, this};
+
+    uint8_t *_buf[2];
+    int _nbuf;
+    bool _lineMode;
+    bool _perLine;          // One DMA transfer per line instead of per frame
+    int _ringLines;
+    uint32_t _ringPos;
+    int _line;
+    // Frame buffer being captured into (-1 when paused), complete, and held by the app
+    volatile int _fill, _ready, _held;
+    volatile uint32_t _frames;
+
+    void (*_lineCB)(int, const uint8_t *, void *);
+    void *_lineParam;
+    void (*_frameCB)(const uint8_t *, void *);
+    void *_frameParam;
+};
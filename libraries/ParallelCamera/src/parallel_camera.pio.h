@@ -0,0 +1,60 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// --------------- //
+// parallel_camera //
+// --------------- //
+
+#define parallel_camera_wrap_target 0
+#define parallel_camera_wrap 11
+
+#define parallel_camera_offset_start 0u
+
+static const uint16_t parallel_camera_program_instructions[] = {
+    //     .wrap_target
+    0x80a0, //  0: pull   block
+    0x6050, //  1: out    y, 16
+    0x2080, //  2: wait   1 gpio, 0
+    0x2000, //  3: wait   0 gpio, 0
+    0xa027, //  4: mov    x, osr
+    0x2081, //  5: wait   1 gpio, 1
+    0x2082, //  6: wait   1 gpio, 2
+    0x4008, //  7: in     pins, 8
+    0x2002, //  8: wait   0 gpio, 2
+    0x0046, //  9: jmp    x--, 6
+    0x2001, // 10: wait   0 gpio, 1
+    0x0084, // 11: jmp    y--, 4
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program parallel_camera_program = {
+    .instructions = parallel_camera_program_instructions,
+    .length = 12,
+    .origin = -1,
+};
+
+static inline pio_sm_config parallel_camera_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + parallel_camera_wrap_target, offset + parallel_camera_wrap);
+    return c;
+}
+
+static inline void parallel_camera_program_init(PIO pio, uint sm, uint offset, uint data0) {
+    pio_sm_set_consecutive_pindirs(pio, sm, data0, 8, false);
+    pio_sm_config c = parallel_camera_program_get_default_config(offset);
+    sm_config_set_in_pins(&c, data0);
+    sm_config_set_in_shift(&c, true, true, 32);
+    sm_config_set_out_shift(&c, true, false, 32);
+    sm_config_set_clkdiv(&c, 1);
+    pio_sm_init(pio, sm, offset + parallel_camera_offset_start, &c);
+}
+
+#endif
@@ -59,85 +59,264 @@ private:
 };
 
 
-// Handles generating valid OTA blocks
+// Handles generating valid OTA blocks.  Commands beyond the _OTA_MAX_COMMANDS one page holds
+// go into further pages, chained from the first, which are all carried out in the same boot.
+// Updates using chained pages, CRCs or addVerify() need the version 2 command extension, which
+// bootloaders built before it don't understand.  They leave such an update alone entirely.
 class PicoOTA {
 public:
     PicoOTA() { }
-    ~PicoOTA() { }
+    ~PicoOTA() {
+        _clear();
+    }
 
     void begin() {
-        if (_page) {
-            delete _page;
-        }
-        _page = new OTACmdPage;
-        memset(_page, 0, sizeof(*_page));
-        memcpy(_page->sign, "Pico OTA Format\0", sizeof(_page->sign));
-        _page->count = 0;
+        _clear();
+        _addPage();
     }
 
-    bool addFile(const char *filename, uint32_t offset = 0, uint32_t flashaddr = XIP_BASE, uint32_t len = 0) {
-        if (!_page  || _page->count == 8) {
+    // With verify, the bootloader checks the data's CRC32 before writing anything at all (so a
+    // damaged file leaves every region of a multi-file update untouched) and reads it back after
+    // writing.  A compressed file can only be verified when written whole.  Writes from the same
+    // file at increasing offsets are read in a single pass, for scattering one image over flash.
+    bool addFile(const char *filename, uint32_t offset = 0, uint32_t flashaddr = XIP_BASE, uint32_t len = 0, bool verify = false) {
+        if (_full()) {
             return false;
         }
         File f = LittleFS.open(filename, "r");
         if (!f) {
             return false;
         }
-        if (!len) {
-            // Check for GZIP header, and if so read real length from file
-            uint8_t hdr[4];
-            if (2 != f.read(hdr, 2)) {
-                // Error, this can't be valid
+        // Check for GZIP header, and if so read real length and CRC32 as encoded at the end
+        uint8_t hdr[8];
+        if (2 != f.read(hdr, 2)) {
+            // Error, this can't be valid
+            f.close();
+            return false;
+        }
+        bool gzip = (hdr[0] == 0x1f) && (hdr[1] == 0x8b);
+        uint32_t size = f.size();
+        uint32_t crc = 0;
+        if (gzip) {
+            f.seek(f.size() - 8);
+            if (8 != f.read(hdr, 8)) {
                 f.close();
                 return false;
             }
-            if ((hdr[0] == 0x1f) && (hdr[1] == 0x8b)) {
-                // GZIP signature matched.  Find real size as encoded at the end
-                f.seek(f.size() - 4);
-                if (4 != f.read(hdr, 4)) {
-                    f.close();
-                    return false;
-                }
-                len = hdr[0];
-                len += hdr[1] << 8;
-                len += hdr[2] << 16;
-                len += hdr[3] << 24;
-            } else {
-                len = f.size();
+            crc = hdr[0] | (hdr[1] << 8) | (hdr[2] << 16) | (hdr[3] << 24);
+            size = hdr[4] | (hdr[5] << 8) | (hdr[6] << 16) | (hdr[7] << 24);
+        }
+        if (!len) {
+            len = size - offset;
+        }
+        if (verify) {
+            if (gzip && (offset || (len != size))) {
+                f.close();
+                return false;
+            } else if (!gzip && !_crcFile(f, offset, len, &crc)) {
+                f.close();
+                return false;
             }
-            len -= offset;
         }
         f.close();
-        _page->cmd[_page->count].command = _OTA_WRITE;
-        strncpy(_page->cmd[_page->count].write.filename, filename, sizeof(_page->cmd[_page->count].write.filename));
-        _page->cmd[_page->count].write.fileOffset = offset;
-        _page->cmd[_page->count].write.fileLength = len;
-        _page->cmd[_page->count].write.flashAddress = flashaddr;
-        _page->count++;
+        Page *p;
+        commandEntry *c = _addCommand(&p);
+        if (!c) {
+            return false;
+        }
+        c->command = _OTA_WRITE;
+        strncpy(c->write.filename, filename, sizeof(c->write.filename));
+        c->write.fileOffset = offset;
+        c->write.fileLength = len;
+        c->write.flashAddress = flashaddr;
+        if (verify) {
+            int i = c - p->cmd.cmd;
+            p->ext.crcMask |= 1u << i;
+            p->ext.crc32[i] = crc;
+        }
         return true;
     }
 
-    bool commit() {
-        if (!_page) {
+    // Whether the bootloader in flash now can apply addDelta() patches.  Older ones, like the
+    // prebuilt one until it is rebuilt from ota/, would drop them and boot the old image.
+    static bool deltaSupported() {
+        // The bootloader sits between boot2 and the app at 0x3000
+        const uint8_t *ota = (const uint8_t *)XIP_BASE + 0x100;
+        return memmem(ota, 0x3000 - 0x100, _OTA_DELTA_CAPABLE, sizeof(_OTA_DELTA_CAPABLE) - 1) != nullptr;
+    }
+
+    // Stage a patch made by tools/makedelta.py against the image now at flashaddr.  The patch
+    // is checked here against that image, the bootloader checks it again before applying it.
+    bool addDelta(const char *filename, uint32_t flashaddr = XIP_BASE) {
+        if (_full() || !deltaSupported()) {
             return false;
         }
-
-        OTACRC32 crc;
-        crc.add(_page, offsetof(OTACmdPage, crc32));
-        _page->crc32 = crc.get();
-
-        File f = LittleFS.open(_OTA_COMMAND_FILE, "w");
+        File f = LittleFS.open(filename, "r");
         if (!f) {
             return false;
         }
-        auto len = f.write((uint8_t *)_page, sizeof(*_page));
+        OTADeltaHeader hdr;
+        bool ok = (sizeof(hdr) == f.read((uint8_t *)&hdr, sizeof(hdr)));
         f.close();
+        if (!ok || memcmp(hdr.sign, _OTA_DELTA_SIGN, sizeof(hdr.sign))) {
+            return false;
+        }
+        if ((hdr.baseLength > (uint32_t)&_FS_start - flashaddr) || (hdr.newLength > (uint32_t)&_FS_start - flashaddr)) {
+            return false;
+        }
+        OTACRC32 crc;
+        crc.add((const void *)flashaddr, hdr.baseLength);
+        if (crc.get() != hdr.baseCRC) {
+            return false; // Made against some other image
+        }
+        Page *p;
+        commandEntry *c = _addCommand(&p);
+        if (!c) {
+            return false;
+        }
+        c->command = _OTA_DELTA;
+        strncpy(c->delta.filename, filename, sizeof(c->delta.filename));
+        c->delta.flashAddress = flashaddr;
+        return true;
+    }
+
+    // Once the commands before it are done, check that len bytes of flash at flashaddr have
+    // the given CRC32.  If not the update stops there, and is started over on the next boot.
+    bool addVerify(uint32_t flashaddr, uint32_t len, uint32_t crc32) {
+        Page *p;
+        commandEntry *c = _addCommand(&p);
+        if (!c) {
+            return false;
+        }
+        c->command = _OTA_CHECK;
+        c->check.flashAddress = flashaddr;
+        c->check.length = len;
+        c->check.crc32 = crc32;
+        return true;
+    }
+
+    bool commit() {
+        if (!_pages) {
+            return false;
+        }
+
+        // Chained pages left from a longer update which was never run
+        char name[sizeof(_pages[0]->ext.next)];
+        for (int i = _count; i < _OTA_MAX_PAGES; i++) {
+            snprintf(name, sizeof(name), _OTA_CHAIN_FILE, (unsigned)i);
+            if (!LittleFS.remove(name)) {
+                break;
+            }
+        }
 
-        return len == sizeof(*_page);
+        // Only a single page of plain writes can be done by older bootloaders as well
+        bool needExt = _count > 1;
+        for (int i = 0; i < _count; i++) {
+            needExt |= _pages[i]->ext.crcMask != 0;
+            for (uint32_t j = 0; j < _pages[i]->cmd.count; j++) {
+                needExt |= (_pages[i]->cmd.cmd[j].command == _OTA_CHECK) || (_pages[i]->cmd.cmd[j].command == _OTA_DELTA);
+            }
+        }
+
+        // The first page, whose presence starts the update, goes last
+        for (int i = _count - 1; i >= 0; i--) {
+            Page *p = _pages[i];
+            memcpy(p->cmd.sign, needExt ? _OTA_SIGN_EXT : "Pico OTA", sizeof(p->cmd.sign));
+            OTACRC32 crc;
+            crc.add(&p->cmd, offsetof(OTACmdPage, crc32));
+            p->cmd.crc32 = crc.get();
+
+            if (i < _count - 1) {
+                snprintf(p->ext.next, sizeof(p->ext.next), _OTA_CHAIN_FILE, (unsigned)(i + 1));
+            }
+            OTACRC32 extCRC;
+            extCRC.add(&p->ext, offsetof(OTACmdExt, extCRC32));
+            p->ext.extCRC32 = extCRC.get();
+
+            if (i) {
+                snprintf(name, sizeof(name), _OTA_CHAIN_FILE, (unsigned)i);
+            } else {
+                strcpy(name, _OTA_COMMAND_FILE);
+            }
+            File f = LittleFS.open(name, "w");
+            if (!f) {
+                return false;
+            }
+            auto len = f.write((uint8_t *)&p->cmd, sizeof(p->cmd));
+            len += f.write((uint8_t *)&p->ext, sizeof(p->ext));
+            f.close();
+            if (len != sizeof(p->cmd) + sizeof(p->ext)) {
+                return false;
+            }
+        }
+        return true;
     }
 
 private:
-    OTACmdPage *_page = nullptr;
+    // A command page as stored, the OTACmdPage every bootloader reads followed by the extension
+    typedef struct {
+        OTACmdPage cmd;
+        OTACmdExt ext;
+    } Page;
+
+    void _clear() {
+        for (int i = 0; i < _count; i++) {
+            delete _pages[i];
+        }
+        delete[] _pages;
+        _pages = nullptr;
+        _count = 0;
+    }
+
+    bool _addPage() {
+        if (!_pages) {
+            _pages = new Page*[_OTA_MAX_PAGES];
+        }
+        if (_count == _OTA_MAX_PAGES) {
+            return false;
+        }
+        Page *p = new Page;
+        memset(p, 0, sizeof(*p));
+        memcpy(p->ext.sign, _OTA_EXT_SIGN, sizeof(p->ext.sign));
+        p->ext.version = _OTA_EXT_VERSION;
+        _pages[_count++] = p;
+        return true;
+    }
+
+    bool _full() const {
+        return !_pages || ((_pages[_count - 1]->cmd.count == _OTA_MAX_COMMANDS) && (_count == _OTA_MAX_PAGES));
+    }
+
+    commandEntry *_addCommand(Page **page) {
+        if (!_pages) {
+            return nullptr;
+        }
+        if ((_pages[_count - 1]->cmd.count == _OTA_MAX_COMMANDS) && !_addPage()) {
+            return nullptr;
+        }
+        *page = _pages[_count - 1];
+        return &(*page)->cmd.cmd[(*page)->cmd.count++];
+    }
+
+    static bool _crcFile(File &f, uint32_t offset, uint32_t len, uint32_t *crc) {
+        uint8_t buf[256];
+        if (!f.seek(offset)) {
+            return false;
+        }
+        *crc = 0;
+        while (len) {
+            size_t n = std::min((size_t)len, sizeof(buf));
+            if (f.read(buf, n) != n) {
+                return false;
+            }
+            *crc = rp2040.crc32(buf, n, *crc);
+            len -= n;
+        }
+        return true;
+    }
+
+    Page **_pages = nullptr;
+    int _count = 0;
 };
 
 extern PicoOTA picoOTA;
@@ -0,0 +1,39 @@
+/*
+   StartCounter
+
+   Counts how many times the board has started, and remembers a name
+   typed into the Serial Monitor, using the Preferences library.
+   Both survive power cycles and uploads of other sketches which
+   don't touch the EEPROM sector.
+
+   Released to the public domain
+*/
+
+#include <Preferences.h>
+
+Preferences prefs;
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+
+  prefs.begin("demo");
+  uint32_t starts = prefs.getUInt("starts", 0) + 1;
+  prefs.putUInt("starts", starts);
+
+  Serial.printf("Started %lu times\n", starts);
+  Serial.printf("Hello, %s\n", prefs.getString("name", "stranger").c_str());
+  Serial.printf("%u bytes free for settings\n", prefs.freeSpace());
+  Serial.println("Type a new name and press enter");
+}
+
+void loop() {
+  if (Serial.available()) {
+    String name = Serial.readStringUntil('\n');
+    name.trim();
+    if (name.length()) {
+      prefs.putString("name", name);
+      Serial.printf("Saved, I'll call you %s from now on\n", name.c_str());
+    }
+  }
+}
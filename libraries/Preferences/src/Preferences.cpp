@@ -0,0 +1,671 @@
+/*
+    Preferences.cpp - Key/value settings kept in a log-structured flash region
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <algorithm>
+#include "Preferences.h"
+#include <FlashService.h>
+#include <hardware/flash.h>
+
+extern "C" uint8_t _EEPROM_start;
+
+// Sector layout: a header, then records appended until the sector fills
+#define PREF_SECTOR 4096
+#define PREF_MAGIC 0x31465250    // "PRF1", programmed to 0 before the sector is erased
+#define PREF_HEADER 8            // uint32_t magic, uint32_t sequence, higher is newer
+#define PREF_RECORD 8            // uint32_t crc32, uint8_t type, uint8_t nameLen, uint16_t valueLen
+#define PREF_MAX_FULLNAME (2 * PREFERENCES_MAX_NAME + 1) // "namespace\0key"
+
+// Index slots, by offset of the record in the region.  Offset 0 is a sector header so can't
+// be a record.
+#define SLOT_EMPTY 0
+#define SLOT_REMOVED 1
+
+enum { PT_DELETED, PT_I8, PT_U8, PT_I16, PT_U16, PT_I32, PT_U32, PT_I64, PT_U64, PT_FLOAT, PT_DOUBLE, PT_BOOL, PT_STR, PT_BLOB };
+
+typedef struct {
+    uint32_t crc;
+    uint8_t type;
+    uint8_t nameLen;
+    uint16_t valueLen;
+} PrefRecord;
+
+typedef struct {
+    uint32_t hash;
+    uint32_t offset;
+} PrefSlot;
+
+static uint8_t *_base = &_EEPROM_start;
+static uint32_t _sectors = 1;
+static bool _mounted = false;
+static uint32_t _head;           // Sector being appended to
+static uint32_t _oldest;         // Oldest sector with records, _head itself when only one is used
+static uint32_t _headPos;        // Offset in _head of the next record
+static uint32_t _seq;            // _head's sequence
+static size_t _liveBytes;        // Records the index points to
+static PrefSlot *_index = nullptr;
+static uint32_t _indexSize = 0;  // Power of 2
+static uint32_t _indexUsed = 0;  // Including SLOT_REMOVED
+
+static uint32_t _recLen(size_t nameLen, size_t valueLen) {
+    return (PREF_RECORD + nameLen + valueLen + 3) & ~3;
+}
+
+static const PrefRecord *_rec(uint32_t offset) {
+    return (const PrefRecord *)(_base + offset);
+}
+
+static uint32_t _hash(const char *name, size_t len) {
+    uint32_t hash = 2166136261U;
+    while (len--) {
+        hash = (hash ^ (uint8_t) * name++) * 16777619U;
+    }
+    return hash;
+}
+
+static uint32_t _crc(uint8_t type, const char *name, size_t nameLen, const void *value, size_t valueLen) {
+    uint8_t hdr[4] = { type, (uint8_t)nameLen, (uint8_t)valueLen, (uint8_t)(valueLen >> 8) };
+    uint32_t crc = rp2040.crc32(hdr, sizeof(hdr));
+    crc = rp2040.crc32(name, nameLen, crc);
+    return valueLen ? rp2040.crc32(value, valueLen, crc) : crc;
+}
+
+// Index ---------------------------------------------------------------------------------------
+
+static int _find(const char *name, size_t nameLen, uint32_t hash) {
+    if (!_indexSize) {
+        return -1;
+    }
+    for (uint32_t i = hash & (_indexSize - 1); ; i = (i + 1) & (_indexSize - 1)) {
+        const PrefSlot &s = _index[i];
+        if (s.offset == SLOT_EMPTY) {
+            return -1;
+        }
+        if ((s.offset != SLOT_REMOVED) && (s.hash == hash)) {
+            const PrefRecord *r = _rec(s.offset);
+            if ((r->nameLen == nameLen) && !memcmp(r + 1, name, nameLen)) {
+                return i;
+            }
+        }
+    }
+}
+
+static bool _grow() {
+    uint32_t size = _indexSize ? _indexSize * 2 : 16;
+    PrefSlot *index = (PrefSlot *)calloc(size, sizeof(PrefSlot));
+    if (!index) {
+        return false;
+    }
+    for (uint32_t i = 0; i < _indexSize; i++) {
+        if (_index[i].offset > SLOT_REMOVED) {
+            uint32_t j = _index[i].hash & (size - 1);
+            while (index[j].offset != SLOT_EMPTY) {
+                j = (j + 1) & (size - 1);
+            }
+            index[j] = _index[i];
+        }
+    }
+    free(_index);
+    _index = index;
+    _indexSize = size;
+    _indexUsed = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        _indexUsed += _index[i].offset != SLOT_EMPTY ? 1 : 0;
+    }
+    return true;
+}
+
+// Points the name at the record at offset, or drops it for a deletion
+static bool _set(uint32_t offset) {
+    const PrefRecord *r = _rec(offset);
+    const char *name = (const char *)(r + 1);
+    uint32_t hash = _hash(name, r->nameLen);
+    int i = _find(name, r->nameLen, hash);
+    if (i >= 0) {
+        const PrefRecord *old = _rec(_index[i].offset);
+        _liveBytes -= _recLen(old->nameLen, old->valueLen);
+        if (r->type == PT_DELETED) {
+            _index[i].offset = SLOT_REMOVED;
+        } else {
+            _index[i].offset = offset;
+            _liveBytes += _recLen(r->nameLen, r->valueLen);
+        }
+        return true;
+    }
+    if (r->type == PT_DELETED) {
+        return true;
+    }
+    if (((_indexUsed + 1) * 4 > _indexSize * 3) && !_grow()) {
+        return false;
+    }
+    uint32_t j = hash & (_indexSize - 1);
+    while (_index[j].offset > SLOT_REMOVED) {
+        j = (j + 1) & (_indexSize - 1);
+    }
+    _indexUsed += _index[j].offset == SLOT_EMPTY ? 1 : 0;
+    _index[j].hash = hash;
+    _index[j].offset = offset;
+    _liveBytes += _recLen(r->nameLen, r->valueLen);
+    return true;
+}
+
+// Flash ---------------------------------------------------------------------------------------
+
+// Programs data at any offset in already erased flash.  Whole pages are written, with the
+// bytes around the data left as 0xff, which doesn't change what's there.
+static bool _program(uint32_t offset, const void *src, size_t len) {
+    const uint8_t *data = (const uint8_t *)src;
+    uint8_t page[FLASH_PAGE_SIZE];
+    while (len) {
+        uint32_t pageStart = offset & ~(FLASH_PAGE_SIZE - 1);
+        size_t skip = offset - pageStart;
+        size_t n = std::min(len, FLASH_PAGE_SIZE - skip);
+        memset(page, 0xff, sizeof(page));
+        memcpy(page + skip, data, n);
+        if (!__flashProgram((intptr_t)_base + pageStart - (intptr_t)XIP_BASE, page, FLASH_PAGE_SIZE)) {
+            return false;
+        }
+        offset += n;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool _erased(uint32_t sector) {
+    const uint32_t *p = (const uint32_t *)(_base + sector * PREF_SECTOR);
+    for (size_t i = 0; i < PREF_SECTOR / 4; i++) {
+        if (p[i] != 0xffffffff) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Erases the sector and makes it the head, with the next sequence number
+static bool _startSector(uint32_t sector) {
+    if (!_erased(sector) && !__flashErase((intptr_t)_base + sector * PREF_SECTOR - (intptr_t)XIP_BASE, PREF_SECTOR)) {
+        return false;
+    }
+    uint32_t hdr[2] = { PREF_MAGIC, _seq + 1 };
+    if (!_program(sector * PREF_SECTOR, hdr, sizeof(hdr))) {
+        return false;
+    }
+    _seq++;
+    _head = sector;
+    _headPos = PREF_HEADER;
+    return true;
+}
+
+// Invalidates the header first, so a sector half erased by a power failure is never replayed
+static bool _retireSector(uint32_t sector) {
+    uint32_t zero = 0;
+    return _program(sector * PREF_SECTOR, &zero, sizeof(zero)) &&
+           __flashErase((intptr_t)_base + sector * PREF_SECTOR - (intptr_t)XIP_BASE, PREF_SECTOR);
+}
+
+static bool _appendRecord(uint8_t type, const char *name, size_t nameLen, const void *value, size_t valueLen) {
+    uint32_t offset = _head * PREF_SECTOR + _headPos;
+    PrefRecord r = { _crc(type, name, nameLen, value, valueLen), type, (uint8_t)nameLen, (uint16_t)valueLen };
+    // The header goes first, so a record cut short by a power failure fails its CRC rather
+    // than looking like erased space to be written over
+    if (!_program(offset, &r, sizeof(r)) || !_program(offset + PREF_RECORD, name, nameLen) ||
+            (valueLen && !_program(offset + PREF_RECORD + nameLen, value, valueLen))) {
+        _headPos = PREF_SECTOR; // Whatever got written can't be reused
+        return false;
+    }
+    _headPos += _recLen(nameLen, valueLen);
+    return _set(offset);
+}
+
+// Copies a live record to the head, pointing the index at the copy
+static bool _relocate(uint32_t offset) {
+    const PrefRecord *r = _rec(offset);
+    const char *name = (const char *)(r + 1);
+    if (_headPos + _recLen(r->nameLen, r->valueLen) > PREF_SECTOR) {
+        return false;
+    }
+    return _appendRecord(r->type, name, r->nameLen, name + r->nameLen, r->valueLen);
+}
+
+// With several sectors the one after the head must be free, so when the head reaches the
+// oldest sector its live records are moved into the head and it's erased
+static bool _ensureSpare() {
+    if ((_sectors == 1) || (_oldest == _head) || (((_head + 1) % _sectors) != _oldest)) {
+        return true;
+    }
+    uint32_t start = _oldest * PREF_SECTOR;
+    for (uint32_t i = 0; i < _indexSize; i++) {
+        uint32_t o = _index[i].offset;
+        if ((o > SLOT_REMOVED) && (o >= start) && (o < start + PREF_SECTOR) && !_relocate(o)) {
+            return false;
+        }
+    }
+    if (!_retireSector(_oldest)) {
+        return false;
+    }
+    _oldest = (_oldest + 1) % _sectors;
+    return true;
+}
+
+// A single sector has nowhere to move records to, so they go through RAM
+static bool _compactSingle() {
+    uint8_t *buf = (uint8_t *)malloc(PREF_SECTOR);
+    if (!buf) {
+        return false;
+    }
+    uint32_t hdr[2] = { PREF_MAGIC, _seq + 1 };
+    memset(buf, 0xff, PREF_SECTOR);
+    memcpy(buf, hdr, sizeof(hdr));
+    uint32_t pos = PREF_HEADER;
+    for (uint32_t i = 0; i < _indexSize; i++) {
+        if (_index[i].offset > SLOT_REMOVED) {
+            const PrefRecord *r = _rec(_index[i].offset);
+            uint32_t len = _recLen(r->nameLen, r->valueLen);
+            memcpy(buf + pos, r, len);
+            _index[i].offset = pos;
+            pos += len;
+        }
+    }
+    PROFILE_CORE_SCOPE("Preferences flash");
+    bool ok = __flashErase((intptr_t)_base - (intptr_t)XIP_BASE, PREF_SECTOR) &&
+              __flashProgram((intptr_t)_base - (intptr_t)XIP_BASE, buf, (pos + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1));
+    free(buf);
+    _seq++;
+    _headPos = ok ? pos : PREF_SECTOR;
+    return ok;
+}
+
+// Writes a record, moving to a new sector (and compacting) when the head is full
+static bool _write(uint8_t type, const char *name, size_t nameLen, const void *value, size_t valueLen) {
+    uint32_t len = _recLen(nameLen, valueLen);
+    if (len > PREF_SECTOR - PREF_HEADER) {
+        return false;
+    }
+    PROFILE_CORE_SCOPE("Preferences flash");
+    for (uint32_t tries = 0; _headPos + len > PREF_SECTOR; tries++) {
+        if (tries == _sectors) {
+            return false; // Full of live records
+        }
+        if (_sectors == 1) {
+            if (!_compactSingle()) {
+                return false;
+            }
+        } else if (!_startSector((_head + 1) % _sectors) || !_ensureSpare()) {
+            return false;
+        }
+    }
+    return _appendRecord(type, name, nameLen, value, valueLen);
+}
+
+// Returns the offset in the sector after its last good record, or PREF_SECTOR if a damaged
+// record means nothing more can be appended to it
+static uint32_t _replay(uint32_t sector) {
+    uint32_t pos = PREF_HEADER;
+    while (pos + PREF_RECORD <= PREF_SECTOR) {
+        uint32_t offset = sector * PREF_SECTOR + pos;
+        const PrefRecord *r = _rec(offset);
+        const uint32_t *w = (const uint32_t *)r;
+        if ((w[0] == 0xffffffff) && (w[1] == 0xffffffff)) {
+            return pos;
+        }
+        uint32_t len = _recLen(r->nameLen, r->valueLen);
+        const char *name = (const char *)(r + 1);
+        if (!r->nameLen || (r->nameLen > PREF_MAX_FULLNAME) || (pos + len > PREF_SECTOR) ||
+                (r->crc != _crc(r->type, name, r->nameLen, name + r->nameLen, r->valueLen))) {
+            return PREF_SECTOR;
+        }
+        _set(offset);
+        pos += len;
+    }
+    return PREF_SECTOR;
+}
+
+static bool _mount() {
+    if (_mounted) {
+        return true;
+    }
+    free(_index);
+    _index = nullptr;
+    _indexSize = 0;
+    _indexUsed = 0;
+    _liveBytes = 0;
+
+    bool found = false;
+    uint32_t oldestSeq = 0;
+    for (uint32_t s = 0; s < _sectors; s++) {
+        const uint32_t *hdr = (const uint32_t *)(_base + s * PREF_SECTOR);
+        if (hdr[0] != PREF_MAGIC) {
+            continue;
+        }
+        if (!found || (hdr[1] > _seq)) {
+            _head = s;
+            _seq = hdr[1];
+        }
+        if (!found || (hdr[1] < oldestSeq)) {
+            _oldest = s;
+            oldestSeq = hdr[1];
+        }
+        found = true;
+    }
+    if (!found) {
+        _seq = 0;
+        if (!_startSector(0)) {
+            return false;
+        }
+        _oldest = 0;
+    } else {
+        // Sectors are used in turn, so oldest to head is also the order they were written
+        for (uint32_t s = _oldest; ; s = (s + 1) % _sectors) {
+            if (*(const uint32_t *)(_base + s * PREF_SECTOR) == PREF_MAGIC) {
+                uint32_t end = _replay(s);
+                if (s == _head) {
+                    _headPos = end;
+                }
+            }
+            if (s == _head) {
+                break;
+            }
+        }
+    }
+    _mounted = true;
+    if ((_sectors > 1) && (_oldest != _head) && (((_head + 1) % _sectors) == _oldest) && (_headPos == PREF_SECTOR)) {
+        // A reset cut off a record being moved into a new head.  The head only holds copies
+        // of records still in the oldest sector, so it's dropped and the move starts over.
+        _mounted = false;
+        return _retireSector(_head) && _mount();
+    }
+    // Finishes a compaction cut off by a reset.  If that fails only writes will.
+    _ensureSpare();
+    return true;
+}
+
+// Preferences ---------------------------------------------------------------------------------
+
+bool Preferences::setFlashRegion(uint8_t *start, size_t len) {
+    if (_mounted || !len || (len % PREF_SECTOR) || (((intptr_t)start - (intptr_t)XIP_BASE) % PREF_SECTOR)) {
+        return false;
+    }
+    _base = start;
+    _sectors = len / PREF_SECTOR;
+    return true;
+}
+
+bool Preferences::begin(const char *name, bool readOnly) {
+    if (_started || !name || !*name || (strlen(name) > PREFERENCES_MAX_NAME) || !_mount()) {
+        return false;
+    }
+    strcpy(_ns, name);
+    _readOnly = readOnly;
+    _started = true;
+    return true;
+}
+
+void Preferences::end() {
+    _started = false;
+}
+
+// Builds "namespace\0key", returning its length or 0 if the key is unusable
+size_t Preferences::_name(const char *key, char *full) {
+    if (!_started || !key || !*key || (strlen(key) > PREFERENCES_MAX_NAME)) {
+        return 0;
+    }
+    size_t nsLen = strlen(_ns);
+    memcpy(full, _ns, nsLen + 1);
+    strcpy(full + nsLen + 1, key);
+    return nsLen + 1 + strlen(key);
+}
+
+const uint8_t *Preferences::_get(const char *key, uint8_t type, size_t *len) {
+    char full[PREF_MAX_FULLNAME + 1];
+    size_t nameLen = _name(key, full);
+    int i = nameLen ? _find(full, nameLen, _hash(full, nameLen)) : -1;
+    if (i < 0) {
+        return nullptr;
+    }
+    const PrefRecord *r = _rec(_index[i].offset);
+    if (r->type != type) {
+        return nullptr;
+    }
+    *len = r->valueLen;
+    return (const uint8_t *)(r + 1) + nameLen;
+}
+
+size_t Preferences::_put(const char *key, uint8_t type, const void *value, size_t len) {
+    char full[PREF_MAX_FULLNAME + 1];
+    size_t nameLen = _name(key, full);
+    if (!nameLen || _readOnly || (len > 0xffff)) {
+        return 0;
+    }
+    // Rewriting the same value would only wear the flash
+    int i = _find(full, nameLen, _hash(full, nameLen));
+    if (i >= 0) {
+        const PrefRecord *r = _rec(_index[i].offset);
+        if ((r->type == type) && (r->valueLen == len) && !memcmp((const uint8_t *)(r + 1) + nameLen, value, len)) {
+            return len;
+        }
+    }
+    return _write(type, full, nameLen, value, len) ? len : 0;
+}
+
+bool Preferences::remove(const char *key) {
+    char full[PREF_MAX_FULLNAME + 1];
+    size_t nameLen = _name(key, full);
+    if (!nameLen || _readOnly) {
+        return false;
+    }
+    if (_find(full, nameLen, _hash(full, nameLen)) < 0) {
+        return true;
+    }
+    return _write(PT_DELETED, full, nameLen, nullptr, 0);
+}
+
+bool Preferences::clear() {
+    if (!_started || _readOnly) {
+        return false;
+    }
+    size_t nsLen = strlen(_ns);
+    for (uint32_t i = 0; i < _indexSize; i++) {
+        if (_index[i].offset <= SLOT_REMOVED) {
+            continue;
+        }
+        const PrefRecord *r = _rec(_index[i].offset);
+        const char *name = (const char *)(r + 1);
+        if ((r->nameLen > nsLen) && !memcmp(name, _ns, nsLen + 1)) {
+            // Copied out, since writing may move the record
+            char full[PREF_MAX_FULLNAME];
+            size_t nameLen = r->nameLen;
+            memcpy(full, name, nameLen);
+            if (!_write(PT_DELETED, full, nameLen, nullptr, 0)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Preferences::isKey(const char *key) {
+    char full[PREF_MAX_FULLNAME + 1];
+    size_t nameLen = _name(key, full);
+    return nameLen && (_find(full, nameLen, _hash(full, nameLen)) >= 0);
+}
+
+size_t Preferences::freeSpace() {
+    if (!_mounted) {
+        return 0;
+    }
+    size_t room = (_sectors == 1 ? 1 : _sectors - 1) * (PREF_SECTOR - PREF_HEADER);
+    return room > _liveBytes ? room - _liveBytes : 0;
+}
+
+size_t Preferences::putChar(const char *key, int8_t value) {
+    return _put(key, PT_I8, &value, sizeof(value));
+}
+
+size_t Preferences::putUChar(const char *key, uint8_t value) {
+    return _put(key, PT_U8, &value, sizeof(value));
+}
+
+size_t Preferences::putShort(const char *key, int16_t value) {
+    return _put(key, PT_I16, &value, sizeof(value));
+}
+
+size_t Preferences::putUShort(const char *key, uint16_t value) {
+    return _put(key, PT_U16, &value, sizeof(value));
+}
+
+size_t Preferences::putInt(const char *key, int32_t value) {
+    return _put(key, PT_I32, &value, sizeof(value));
+}
+
+size_t Preferences::putUInt(const char *key, uint32_t value) {
+    return _put(key, PT_U32, &value, sizeof(value));
+}
+
+size_t Preferences::putLong(const char *key, int32_t value) {
+    return putInt(key, value);
+}
+
+size_t Preferences::putULong(const char *key, uint32_t value) {
+    return putUInt(key, value);
+}
+
+size_t Preferences::putLong64(const char *key, int64_t value) {
+    return _put(key, PT_I64, &value, sizeof(value));
+}
+
+size_t Preferences::putULong64(const char *key, uint64_t value) {
+    return _put(key, PT_U64, &value, sizeof(value));
+}
+
+size_t Preferences::putFloat(const char *key, float value) {
+    return _put(key, PT_FLOAT, &value, sizeof(value));
+}
+
+size_t Preferences::putDouble(const char *key, double value) {
+    return _put(key, PT_DOUBLE, &value, sizeof(value));
+}
+
+size_t Preferences::putBool(const char *key, bool value) {
+    uint8_t v = value ? 1 : 0;
+    return _put(key, PT_BOOL, &v, sizeof(v));
+}
+
+size_t Preferences::putString(const char *key, const char *value) {
+    return value ? _put(key, PT_STR, value, strlen(value)) : 0;
+}
+
+size_t Preferences::putString(const char *key, const String &value) {
+    return _put(key, PT_STR, value.c_str(), value.length());
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+    return (value || !len) ? _put(key, PT_BLOB, value, len) : 0;
+}
+
+int8_t Preferences::getChar(const char *key, int8_t defaultValue) {
+    return _getValue(key, PT_I8, defaultValue);
+}
+
+uint8_t Preferences::getUChar(const char *key, uint8_t defaultValue) {
+    return _getValue(key, PT_U8, defaultValue);
+}
+
+int16_t Preferences::getShort(const char *key, int16_t defaultValue) {
+    return _getValue(key, PT_I16, defaultValue);
+}
+
+uint16_t Preferences::getUShort(const char *key, uint16_t defaultValue) {
+    return _getValue(key, PT_U16, defaultValue);
+}
+
+int32_t Preferences::getInt(const char *key, int32_t defaultValue) {
+    return _getValue(key, PT_I32, defaultValue);
+}
+
+uint32_t Preferences::getUInt(const char *key, uint32_t defaultValue) {
+    return _getValue(key, PT_U32, defaultValue);
+}
+
+int32_t Preferences::getLong(const char *key, int32_t defaultValue) {
+    return getInt(key, defaultValue);
+}
+
+uint32_t Preferences::getULong(const char *key, uint32_t defaultValue) {
+    return getUInt(key, defaultValue);
+}
+
+int64_t Preferences::getLong64(const char *key, int64_t defaultValue) {
+    return _getValue(key, PT_I64, defaultValue);
+}
+
+uint64_t Preferences::getULong64(const char *key, uint64_t defaultValue) {
+    return _getValue(key, PT_U64, defaultValue);
+}
+
+float Preferences::getFloat(const char *key, float defaultValue) {
+    return _getValue(key, PT_FLOAT, defaultValue);
+}
+
+double Preferences::getDouble(const char *key, double defaultValue) {
+    return _getValue(key, PT_DOUBLE, defaultValue);
+}
+
+bool Preferences::getBool(const char *key, bool defaultValue) {
+    return _getValue(key, PT_BOOL, (uint8_t)(defaultValue ? 1 : 0)) != 0;
+}
+
+size_t Preferences::getString(const char *key, char *value, size_t maxLen) {
+    size_t len;
+    const uint8_t *v = _get(key, PT_STR, &len);
+    if (!v || !value || !maxLen) {
+        return 0;
+    }
+    len = std::min(len, maxLen - 1);
+    memcpy(value, v, len);
+    value[len] = 0;
+    return len;
+}
+
+String Preferences::getString(const char *key, String defaultValue) {
+    size_t len;
+    const uint8_t *v = _get(key, PT_STR, &len);
+    if (!v) {
+        return defaultValue;
+    }
+    String s;
+    s.concat((const char *)v, len);
+    return s;
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+    size_t len;
+    return _get(key, PT_BLOB, &len) ? len : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+    size_t len;
+    const uint8_t *v = _get(key, PT_BLOB, &len);
+    if (!v || !buf || (len > maxLen)) {
+        return 0;
+    }
+    memcpy(buf, v, len);
+    return len;
+}
@@ -0,0 +1,112 @@
+/*
+    Preferences.h - Key/value settings kept in a log-structured flash region
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+// Longest namespace and key names, as on the ESP32
+#define PREFERENCES_MAX_NAME 15
+
+// Each put() appends a record (CRC, type, namespace, key and value) to the active sector of
+// the region, and a RAM hash table built when the region is first opened maps every key to
+// its latest record, so a get() reads the value straight out of flash.  Once a sector fills
+// the next is started, and the oldest sector's live records are copied forward before it is
+// erased, so one sector is always kept free.  Power lost mid-write only loses that write.
+// A single sector region (the default, EEPROM's) is instead compacted in place through RAM,
+// which risks all the contents if power fails during that erase.
+class Preferences {
+public:
+    Preferences() { }
+    ~Preferences() {
+        end();
+    }
+
+    // Sets the flash used by every Preferences, before the first begin().  Defaults to the
+    // EEPROM sector, which the EEPROM library must then not use.
+    static bool setFlashRegion(uint8_t *start, size_t len);
+
+    bool begin(const char *name, bool readOnly = false);
+    void end();
+
+    // Removes every key in the namespace
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putChar(const char *key, int8_t value);
+    size_t putUChar(const char *key, uint8_t value);
+    size_t putShort(const char *key, int16_t value);
+    size_t putUShort(const char *key, uint16_t value);
+    size_t putInt(const char *key, int32_t value);
+    size_t putUInt(const char *key, uint32_t value);
+    size_t putLong(const char *key, int32_t value);
+    size_t putULong(const char *key, uint32_t value);
+    size_t putLong64(const char *key, int64_t value);
+    size_t putULong64(const char *key, uint64_t value);
+    size_t putFloat(const char *key, float value);
+    size_t putDouble(const char *key, double value);
+    size_t putBool(const char *key, bool value);
+    size_t putString(const char *key, const char *value);
+    size_t putString(const char *key, const String &value);
+    size_t putBytes(const char *key, const void *value, size_t len);
+
+    int8_t getChar(const char *key, int8_t defaultValue = 0);
+    uint8_t getUChar(const char *key, uint8_t defaultValue = 0);
+    int16_t getShort(const char *key, int16_t defaultValue = 0);
+    uint16_t getUShort(const char *key, uint16_t defaultValue = 0);
+    int32_t getInt(const char *key, int32_t defaultValue = 0);
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0);
+    int32_t getLong(const char *key, int32_t defaultValue = 0);
+    uint32_t getULong(const char *key, uint32_t defaultValue = 0);
+    int64_t getLong64(const char *key, int64_t defaultValue = 0);
+    uint64_t getULong64(const char *key, uint64_t defaultValue = 0);
+    float getFloat(const char *key, float defaultValue = NAN);
+    double getDouble(const char *key, double defaultValue = NAN);
+    bool getBool(const char *key, bool defaultValue = false);
+    // Copies at most maxLen - 1 characters and a NUL, returns the length copied or 0 if missing
+    size_t getString(const char *key, char *value, size_t maxLen);
+    String getString(const char *key, String defaultValue = String());
+    size_t getBytesLength(const char *key);
+    size_t getBytes(const char *key, void *buf, size_t maxLen);
+
+    // Bytes left for new records, counting what compacting would reclaim
+    size_t freeSpace();
+
+private:
+    size_t _put(const char *key, uint8_t type, const void *value, size_t len);
+    // Pointer to the value in flash, or nullptr if the key is missing or of another type
+    const uint8_t *_get(const char *key, uint8_t type, size_t *len);
+    template<typename T> T _getValue(const char *key, uint8_t type, T defaultValue) {
+        size_t len;
+        const uint8_t *v = _get(key, type, &len);
+        T t;
+        if (!v || (len != sizeof(t))) {
+            return defaultValue;
+        }
+        memcpy(&t, v, sizeof(t));
+        return t;
+    }
+    size_t _name(const char *key, char *full);
+
+    char _ns[PREFERENCES_MAX_NAME + 1] = { 0 };
+    bool _started = false;
+    bool _readOnly = false;
+};
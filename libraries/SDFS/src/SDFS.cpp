@@ -143,12 +143,21 @@ bool SDFSImpl::format() {
     if (_mounted) {
         return false;
     }
+    FatFormatter fatFormatter;
+    if (_cfg._sdio) {
+        if (!_sdioCard.sectorCount() && !_sdioCard.begin(_cfg._clkPin, _cfg._cmdPin, _cfg._dat0Pin, _cfg._sdioClock)) {
+            return false;
+        }
+        uint8_t *sectorBuffer = new uint8_t[512];
+        bool ret = fatFormatter.format(&_sdioCard, sectorBuffer, nullptr);
+        delete[] sectorBuffer;
+        return ret;
+    }
     SdCardFactory cardFactory;
     SdCard* card = cardFactory.newCard(SdSpiConfig(_cfg._csPin, DEDICATED_SPI, _cfg._spiSettings));
     if (!card || card->errorCode()) {
         return false;
     }
-    FatFormatter fatFormatter;
     uint8_t *sectorBuffer = new uint8_t[512];
     bool ret = fatFormatter.format(card, sectorBuffer, nullptr);
     delete[] sectorBuffer;
@@ -156,5 +165,32 @@ bool SDFSImpl::format() {
 }
 
 
+#if !defined(USE_TINYUSB) && !defined(NO_USB)
+bool SDFSUSBDisk::begin(const SDFSConfig &cfg) {
+    end();
+    if (cfg._sdio) {
+        if (!_sdioCard.begin(cfg._clkPin, cfg._cmdPin, cfg._dat0Pin, cfg._sdioClock)) {
+            return false;
+        }
+        _dev = &_sdioCard;
+        return true;
+    }
+    // Sector reads go through SPI.transfer(), which uses DMA for whole sectors
+    if (!_spiCard.begin(SdSpiConfig(cfg._csPin, cfg._dedicated ? DEDICATED_SPI : SHARED_SPI, cfg._spiSettings, cfg._spi))) {
+        return false;
+    }
+    _dev = &_spiCard;
+    return true;
+}
+
+void SDFSUSBDisk::end() {
+    if (_dev) {
+        _dev->syncDevice();
+        _dev->end();
+        _dev = nullptr;
+    }
+}
+#endif
+
 }; // namespace sdfs
 
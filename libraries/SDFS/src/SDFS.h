@@ -34,6 +34,7 @@
 #include <SPI.h>
 #include <SdFat.h>
 #include <FS.h>
+#include "SDIOCard.h"
 
 using namespace fs;
 
@@ -45,7 +46,7 @@ class SDFSConfig : public FSConfig {
 public:
     static constexpr uint32_t FSId = 0x53444653;
 
-    SDFSConfig(uint8_t csPin = 4, uint32_t spi = SD_SCK_MHZ(10), HardwareSPI &port = SPI) : FSConfig(FSId, false), _csPin(csPin), _part(0), _spiSettings(spi), _spi(&port)  { }
+    SDFSConfig(uint8_t csPin = 4, uint32_t spi = SD_SCK_MHZ(10), HardwareSPI &port = SPI) : FSConfig(FSId, false), _csPin(csPin), _part(0), _spiSettings(spi), _spi(&port), _dedicated(false), _sdio(false), _clkPin(0), _cmdPin(0), _dat0Pin(0), _sdioClock(25000000)  { }
 
     SDFSConfig setAutoFormat(bool val = true) {
         _autoFormat = val;
@@ -61,7 +62,21 @@ public:
     }
     SDFSConfig setSPI(HardwareSPI &spi) {
         _spi = &spi;
-        return true;
+        return *this;
+    }
+    // The card owns the SPI bus, so consecutive sectors stream in one multi-block command
+    SDFSConfig setDedicatedSPI(bool val = true) {
+        _dedicated = val;
+        return *this;
+    }
+    // Use the card in 4-bit SD bus mode instead of over SPI, with DAT0..DAT3 on dat0Pin..dat0Pin+3
+    SDFSConfig setSDIO(uint8_t clkPin, uint8_t cmdPin, uint8_t dat0Pin, uint32_t clockHz = 25000000) {
+        _sdio = true;
+        _clkPin = clkPin;
+        _cmdPin = cmdPin;
+        _dat0Pin = dat0Pin;
+        _sdioClock = clockHz;
+        return *this;
     }
     SDFSConfig setPart(uint8_t part) {
         _part = part;
@@ -73,6 +88,12 @@ public:
     uint8_t   _part;
     uint32_t  _spiSettings;
     HardwareSPI *_spi;
+    bool      _dedicated;
+    bool      _sdio;
+    uint8_t   _clkPin;
+    uint8_t   _cmdPin;
+    uint8_t   _dat0Pin;
+    uint32_t  _sdioClock;
 };
 
 class SDFSImpl : public FSImpl {
@@ -151,7 +172,16 @@ public:
         if (_mounted) {
             return true;
         }
-        SdSpiConfig ssc(_cfg._csPin, SHARED_SPI, _cfg._spiSettings, _cfg._spi);
+        if (_cfg._sdio) {
+            _mounted = _beginSDIO();
+            if (!_mounted && _cfg._autoFormat && _sdioCard.sectorCount()) {
+                format();
+                _mounted = _beginSDIO();
+            }
+            FsDateTime::setCallback(dateTimeCB);
+            return _mounted;
+        }
+        SdSpiConfig ssc(_cfg._csPin, _cfg._dedicated ? DEDICATED_SPI : SHARED_SPI, _cfg._spiSettings, _cfg._spi);
         _mounted = _fs.begin(ssc);
         if (!_mounted && _cfg._autoFormat) {
             format();
@@ -163,6 +193,9 @@ public:
 
     void end() override {
         _mounted = false;
+        if (_cfg._sdio) {
+            _sdioCard.end();
+        }
         // TODO
     }
 
@@ -171,7 +204,7 @@ public:
     // The following are not common FS interfaces, but are needed only to
     // support the older SD.h exports
     uint8_t type() {
-        return _fs.card()->type();
+        return _cfg._sdio ? _sdioCard.type() : _fs.card()->type();
     }
     uint8_t fatType() {
         return _fs.vol()->fatType();
@@ -234,6 +267,14 @@ protected:
         return &_fs;
     }
 
+    bool _beginSDIO() {
+        if (!_sdioCard.sectorCount() && !_sdioCard.begin(_cfg._clkPin, _cfg._cmdPin, _cfg._dat0Pin, _cfg._sdioClock)) {
+            return false;
+        }
+        // SdFat only knows how to bring up SPI cards itself, so mount the volume directly
+        return _fs.FatVolume::begin(&_sdioCard);
+    }
+
 
     static int _getFlags(OpenMode openMode, AccessMode accessMode) {
         int mode = 0;
@@ -257,6 +298,7 @@ protected:
     }
 
     SdFat _fs;
+    SDIOCard _sdioCard;
     SDFSConfig   _cfg;
     bool         _mounted;
 };
@@ -328,6 +370,14 @@ public:
         return _fd->truncate(size);
     }
 
+    bool preallocate(uint32_t size) override {
+        if (!_opened) {
+            DEBUGV("SDFSFileImpl::preallocate: file not opened\n");
+            return false;
+        }
+        return _fd->preAllocate(size);
+    }
+
     void close() override {
         if (_opened) {
             _fd->close();
@@ -502,9 +552,41 @@ protected:
     bool                    _isDirectory;
 };
 
+#if !defined(USE_TINYUSB) && !defined(NO_USB)
+// The raw card for USBMassStorage, brought up with the same wiring settings as SDFS.  SDFS
+// must be ended while the card is exported, and the host's writes are only visible to it
+// after USBMassStorage.end() and a new SDFS.begin()
+class SDFSUSBDisk : public USBMSCDisk {
+public:
+    bool begin(const SDFSConfig &cfg);
+    void end();
+
+    uint32_t sectors() override {
+        return _dev ? _dev->sectorCount() : 0;
+    }
+    bool read(uint32_t sector, uint8_t *buf, uint32_t count) override {
+        return _dev && _dev->readSectors(sector, buf, count);
+    }
+    bool write(uint32_t sector, const uint8_t *buf, uint32_t count) override {
+        return _dev && _dev->writeSectors(sector, buf, count);
+    }
+    bool sync() override {
+        return _dev && _dev->syncDevice();
+    }
+
+private:
+    SdSpiCard _spiCard;
+    SDIOCard _sdioCard;
+    FsBlockDeviceInterface *_dev = nullptr;
+};
+#endif
+
 }; // namespace sdfs
 
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_SDFS)
 extern FS SDFS;
 using sdfs::SDFSConfig;
+#if !defined(USE_TINYUSB) && !defined(NO_USB)
+using sdfs::SDFSUSBDisk;
+#endif
 #endif
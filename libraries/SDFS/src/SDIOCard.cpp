@@ -0,0 +1,492 @@
+/*
+    SDIOCard.cpp - SD card block device on a 4-bit SDIO bus, using PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "SDIOCard.h"
+#include <algorithm>
+#include <hardware/dma.h>
+#include <hardware/clocks.h>
+#include "sdio.pio.h"
+
+namespace sdfs {
+
+static PIOProgram _sdioPgm(&sdio_program);
+
+// A sector on the wire is 1024 nibbles of data then a CRC16 for each of the 4 lines
+#define SDIO_RX_WORDS (512 / 4 + 2)
+// ...and going out, preceded by idle nibbles and the start bit and followed by the end bit
+#define SDIO_TX_WORDS (1 + 512 / 4 + 2 + 1)
+#define SDIO_TX_NIBBLES (8 + 1024 + 16 + 1)
+
+static uint16_t _crc16Table[256];
+
+static void _makeCRC16Table() {
+    for (int i = 0; i < 256; i++) {
+        uint16_t crc = i << 8;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+        _crc16Table[i] = crc;
+    }
+}
+
+static inline uint16_t _crc16(uint16_t crc, uint8_t b) {
+    return (crc << 8) ^ _crc16Table[(crc >> 8) ^ b];
+}
+
+// The 8 bits DAT<line> carries for one word of 8 nibbles, first one in the MSB
+static inline uint8_t _lane(uint32_t w, int line) {
+    w = (w >> line) & 0x11111111;
+    w = (w | (w >> 3)) & 0x03030303;
+    w = (w | (w >> 6)) & 0x000f000f;
+    return (w | (w >> 12)) & 0xff;
+}
+
+// Runs the 4 CRC16s over a sector, given as words in wire order
+static void _crcSector(const uint32_t *w, uint16_t crc[4]) {
+    crc[0] = crc[1] = crc[2] = crc[3] = 0;
+    for (int i = 0; i < 512 / 4; i++) {
+        for (int l = 0; l < 4; l++) {
+            crc[l] = _crc16(crc[l], _lane(w[i], l));
+        }
+    }
+}
+
+static uint8_t _crc7(uint64_t bits, int n) {
+    uint8_t crc = 0;
+    while (n--) {
+        uint8_t fb = ((bits >> n) & 1) ^ ((crc >> 6) & 1);
+        crc = (crc << 1) & 0x7f;
+        if (fb) {
+            crc ^= 0x09;
+        }
+    }
+    return crc;
+}
+
+// Bits msb..lsb of the 128-bit CSD held as big-endian words
+static uint32_t _csdBits(const uint32_t *r, int msb, int lsb) {
+    uint32_t v = 0;
+    for (int b = msb; b >= lsb; b--) {
+        v = (v << 1) | ((r[3 - b / 32] >> (b % 32)) & 1);
+    }
+    return v;
+}
+
+bool SDIOCard::begin(uint8_t clkPin, uint8_t cmdPin, uint8_t dat0Pin, uint32_t clockHz) {
+    end();
+    _clk = clkPin;
+    _cmdPin = cmdPin;
+    _dat0 = dat0Pin;
+
+    if (!_crc16Table[1]) {
+        _makeCRC16Table();
+    }
+    // Both SMs drive CLK, so they have to share a PIO
+    if (!_sdioPgm.prepare(&_pio, &_cmdSM, &_offset)) {
+        DEBUGV("SDIO: Unable to load PIO program\n");
+        return false;
+    }
+    _dataSM = pio_claim_unused_sm(_pio, false);
+    _dma = dma_claim_unused_channel(false);
+    _buff = (uint32_t *)malloc(2 * SDIO_TX_WORDS * sizeof(uint32_t));
+    if ((_dataSM < 0) || (_dma < 0) || !_buff) {
+        DEBUGV("SDIO: Unable to allocate SM, DMA or buffer\n");
+        end();
+        return false;
+    }
+
+    uint32_t dmask = 0xf << _dat0;
+    uint32_t all = (1 << _clk) | (1 << _cmdPin) | dmask;
+    pio_sm_set_pins_with_mask(_pio, _cmdSM, all & ~(1 << _clk), all);
+    pio_sm_set_pindirs_with_mask(_pio, _cmdSM, 1 << _clk, all);
+    pio_gpio_init(_pio, _clk);
+    pio_gpio_init(_pio, _cmdPin);
+    gpio_pull_up(_cmdPin);
+    for (int i = 0; i < 4; i++) {
+        pio_gpio_init(_pio, _dat0 + i);
+        gpio_pull_up(_dat0 + i);
+    }
+
+    pio_sm_config c = sdio_program_get_default_config(_offset);
+    sm_config_set_wrap(&c, _offset + sdio_offset_park, _offset + sdio_offset_park);
+    sm_config_set_sideset_pins(&c, _clk);
+    sm_config_set_out_pins(&c, _cmdPin, 1);
+    sm_config_set_set_pins(&c, _cmdPin, 1);
+    sm_config_set_in_pins(&c, _cmdPin);
+    sm_config_set_jmp_pin(&c, _cmdPin);
+    sm_config_set_out_shift(&c, false, true, 32);
+    sm_config_set_in_shift(&c, false, true, 32);
+    pio_sm_init(_pio, _cmdSM, _offset + sdio_offset_park, &c);
+
+    // Incoming data keeps the program's wrap around the nibble loop
+    _rxConfig = sdio_program_get_default_config(_offset);
+    sm_config_set_sideset_pins(&_rxConfig, _clk);
+    sm_config_set_in_pins(&_rxConfig, _dat0);
+    sm_config_set_jmp_pin(&_rxConfig, _dat0);
+    sm_config_set_in_shift(&_rxConfig, false, true, 32);
+
+    _txConfig = sdio_program_get_default_config(_offset);
+    sm_config_set_wrap(&_txConfig, _offset + sdio_offset_park, _offset + sdio_offset_park);
+    sm_config_set_sideset_pins(&_txConfig, _clk);
+    sm_config_set_out_pins(&_txConfig, _dat0, 4);
+    sm_config_set_set_pins(&_txConfig, _dat0, 4);
+    sm_config_set_in_pins(&_txConfig, _dat0);
+    sm_config_set_jmp_pin(&_txConfig, _dat0);
+    sm_config_set_out_shift(&_txConfig, false, true, 32);
+    sm_config_set_in_shift(&_txConfig, false, false, 32);
+    pio_sm_init(_pio, _dataSM, _offset + sdio_offset_park, &_txConfig);
+
+    // Identification runs at 400KHz on CMD alone
+    _setClock(400000);
+    _rca = 0;
+    _clocks(80);
+    _cmd(0, 0, 0);
+    bool v2 = _cmd(8, 0x1aa);
+    if (v2 && ((_resp[0] & 0xfff) != 0x1aa)) {
+        DEBUGV("SDIO: Bad CMD8 echo\n");
+        end();
+        return false;
+    }
+    uint32_t start = millis();
+    do {
+        if (!_acmd(41, (v2 ? 0x40000000 : 0) | 0x00ff8000) || (millis() - start > 1000)) {
+            DEBUGV("SDIO: Card didn't leave idle\n");
+            end();
+            return false;
+        }
+    } while (!(_resp[0] & 0x80000000));
+    _type = !v2 ? SD_CARD_TYPE_SD1 : (_resp[0] & 0x40000000) ? SD_CARD_TYPE_SDHC : SD_CARD_TYPE_SD2;
+
+    bool ok = _cmd(2, 0, 136) && _cmd(3, 0);
+    _rca = _resp[0] >> 16;
+    ok = ok && _cmd(9, _rca << 16, 136);
+    if (ok) {
+        if (_csdBits(_resp, 127, 126) == 1) {
+            _sectors = (_csdBits(_resp, 69, 48) + 1) * 1024;
+        } else {
+            _sectors = (_csdBits(_resp, 73, 62) + 1) << (_csdBits(_resp, 49, 47) + 2 + _csdBits(_resp, 83, 80) - 9);
+        }
+    }
+    ok = ok && _cmd(7, _rca << 16) && _waitNotBusy(100);
+    ok = ok && _acmd(6, 2); // 4-bit bus
+    ok = ok && ((_type == SD_CARD_TYPE_SDHC) || _cmd(16, 512));
+    if (!ok) {
+        DEBUGV("SDIO: Card setup failed\n");
+        end();
+        return false;
+    }
+    _setClock(clockHz);
+    return true;
+}
+
+void SDIOCard::end() {
+    if (_cmdSM >= 0) {
+        _reset(_cmdSM);
+        PIOProgram::unprepare(_pio, _cmdSM);
+        for (int i = 0; i < 4; i++) {
+            gpio_set_function(_dat0 + i, GPIO_FUNC_NULL);
+        }
+        gpio_set_function(_clk, GPIO_FUNC_NULL);
+        gpio_set_function(_cmdPin, GPIO_FUNC_NULL);
+    }
+    if (_dataSM >= 0) {
+        _reset(_dataSM);
+        pio_sm_unclaim(_pio, _dataSM);
+    }
+    if (_dma >= 0) {
+        dma_channel_abort(_dma);
+        dma_channel_unclaim(_dma);
+    }
+    free(_buff);
+    _buff = nullptr;
+    _cmdSM = -1;
+    _dataSM = -1;
+    _dma = -1;
+    _sectors = 0;
+}
+
+// The command SM gets 6 PIO cycles per clock and the data SM 4
+void SDIOCard::_setClock(uint32_t hz) {
+    float sys = (float)clock_get_hz(clk_sys);
+    pio_sm_set_clkdiv(_pio, _cmdSM, std::max(1.0f, sys / (6.0f * hz)));
+    float div = std::max(1.0f, sys / (4.0f * hz));
+    sm_config_set_clkdiv(&_rxConfig, div);
+    sm_config_set_clkdiv(&_txConfig, div);
+}
+
+void SDIOCard::_reset(int sm) {
+    pio_sm_set_enabled(_pio, sm, false);
+    pio_sm_clear_fifos(_pio, sm);
+    pio_sm_restart(_pio, sm);
+    pio_sm_exec(_pio, sm, pio_encode_jmp(_offset + sdio_offset_park));
+}
+
+// Only done while the SM is stopped, through the FIFO since X and Y need more than 5 bits
+void SDIOCard::_setXY(int sm, uint32_t x, uint32_t y) {
+    pio_sm_put(_pio, sm, x);
+    pio_sm_exec(_pio, sm, pio_encode_pull(false, false));
+    pio_sm_exec(_pio, sm, pio_encode_out(pio_x, 32));
+    pio_sm_put(_pio, sm, y);
+    pio_sm_exec(_pio, sm, pio_encode_pull(false, false));
+    pio_sm_exec(_pio, sm, pio_encode_out(pio_y, 32));
+}
+
+bool SDIOCard::_waitPark(int sm, uint32_t us) {
+    uint32_t start = micros();
+    while (pio_sm_get_pc(_pio, sm) != _offset + sdio_offset_park) {
+        if (micros() - start > us) {
+            _reset(sm);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SDIOCard::_waitNotBusy(uint32_t ms) {
+    uint32_t start = millis();
+    while (!gpio_get(_dat0)) {
+        if (millis() - start > ms) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SDIOCard::isBusy() {
+    return !gpio_get(_dat0);
+}
+
+// At least 74 clocks with CMD high are needed after power up
+bool SDIOCard::_clocks(int n) {
+    _reset(_cmdSM);
+    _setXY(_cmdSM, n - 1, 0);
+    for (int i = 0; i < n; i += 32) {
+        pio_sm_put(_pio, _cmdSM, 0xffffffff);
+    }
+    pio_sm_exec(_pio, _cmdSM, pio_encode_jmp(_offset + sdio_offset_cmd_tx));
+    pio_sm_set_enabled(_pio, _cmdSM, true);
+    return _waitPark(_cmdSM, 10000);
+}
+
+// Sends a command with 8 idle clocks in front, leaving the response's 32 bit argument in
+// _resp[0] or, for a 136 bit response, the CID or CSD in _resp[0..3]
+bool SDIOCard::_cmd(uint8_t cmd, uint32_t arg, int respBits) {
+    uint64_t frame = ((uint64_t)(0x40 | cmd) << 32) | arg;
+    frame = (frame << 8) | (_crc7(frame, 40) << 1) | 1;
+    frame |= 0xffULL << 48;
+    frame <<= 8;
+
+    _reset(_cmdSM);
+    _setXY(_cmdSM, 56 - 1, respBits ? respBits - 2 : 0);
+    pio_sm_put(_pio, _cmdSM, frame >> 32);
+    pio_sm_put(_pio, _cmdSM, (uint32_t)frame);
+    pio_sm_exec(_pio, _cmdSM, pio_encode_jmp(_offset + sdio_offset_cmd_tx));
+    pio_sm_set_enabled(_pio, _cmdSM, true);
+    if (!respBits) {
+        return _waitPark(_cmdSM, 10000);
+    }
+
+    // The start bit isn't captured, and the last word holds what's left in its low bits
+    int bits = respBits - 1;
+    int words = (bits + 31) / 32;
+    uint32_t w[5];
+    uint32_t start = micros();
+    for (int i = 0; i < words; i++) {
+        while (pio_sm_is_rx_fifo_empty(_pio, _cmdSM)) {
+            if (micros() - start > 10000) {
+                _reset(_cmdSM);
+                return false;
+            }
+        }
+        w[i] = pio_sm_get(_pio, _cmdSM);
+    }
+    w[words - 1] <<= (32 - bits % 32) % 32;
+
+    if (respBits == 136) {
+        // 7 bits of header, then the register with its CRC and the end bit in bit 0
+        for (int i = 0; i < 4; i++) {
+            _resp[i] = (w[i] << 7) | (w[i + 1] >> 25);
+        }
+        return true;
+    }
+    uint64_t r = ((uint64_t)w[0] << 15) | (w[1] >> 17);
+    _resp[0] = (uint32_t)(r >> 8);
+    // R3 has all ones instead of the command index and CRC
+    uint8_t idx = (r >> 40) & 0x3f;
+    return (idx == 0x3f) || ((idx == cmd) && (_crc7(r >> 8, 40) == ((r >> 1) & 0x7f)));
+}
+
+bool SDIOCard::_acmd(uint8_t cmd, uint32_t arg) {
+    return _cmd(55, _rca << 16) && _cmd(cmd, arg);
+}
+
+bool SDIOCard::_stop() {
+    return _cmd(12, 0) && _waitNotBusy(250);
+}
+
+// Clocks in one sector plus CRCs by DMA, stopping the clock once it's in
+void SDIOCard::_startRx(uint32_t *buff) {
+    _reset(_dataSM);
+    pio_sm_set_config(_pio, _dataSM, &_rxConfig);
+    _setXY(_dataSM, SDIO_RX_WORDS * 8, 0);
+
+    dma_channel_config c = dma_channel_get_default_config(_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, pio_get_dreq(_pio, _dataSM, false));
+    channel_config_set_bswap(&c, true); // Leaves the bytes in memory in wire order
+    dma_channel_configure(_dma, &c, buff, &_pio->rxf[_dataSM], SDIO_RX_WORDS, true);
+
+    pio_sm_exec(_pio, _dataSM, pio_encode_jmp(_offset + sdio_offset_rx_wait));
+    pio_sm_set_enabled(_pio, _dataSM, true);
+}
+
+bool SDIOCard::_waitRx() {
+    uint32_t start = millis();
+    while (dma_channel_is_busy(_dma)) {
+        if (millis() - start > 250) {
+            dma_channel_abort(_dma);
+            _reset(_dataSM);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SDIOCard::_finishRx(uint32_t *buff, uint8_t *dst) {
+    uint32_t w[SDIO_RX_WORDS];
+    for (int i = 0; i < SDIO_RX_WORDS; i++) {
+        w[i] = __builtin_bswap32(buff[i]);
+    }
+    uint16_t crc[4];
+    _crcSector(w, crc);
+    for (int l = 0; l < 4; l++) {
+        if (crc[l] != ((_lane(w[SDIO_RX_WORDS - 2], l) << 8) | _lane(w[SDIO_RX_WORDS - 1], l))) {
+            DEBUGV("SDIO: Read CRC error\n");
+            return false;
+        }
+    }
+    memcpy(dst, buff, 512);
+    return true;
+}
+
+bool SDIOCard::readSectors(uint32_t sector, uint8_t *dst, size_t ns) {
+    if (!_sectors || !_waitNotBusy(250)) {
+        return false;
+    }
+    uint32_t addr = (_type == SD_CARD_TYPE_SDHC) ? sector : sector * 512;
+    if (!_cmd((ns == 1) ? 17 : 18, addr)) {
+        return false;
+    }
+    // The next sector comes in while the last one is checked
+    uint32_t *cur = _buff;
+    uint32_t *next = _buff + SDIO_TX_WORDS;
+    bool ok = true;
+    _startRx(cur);
+    for (size_t i = 0; ok && (i < ns); i++) {
+        ok = _waitRx();
+        if (ok && (i + 1 < ns)) {
+            _startRx(next);
+        }
+        ok = ok && _finishRx(cur, dst);
+        dst += 512;
+        std::swap(cur, next);
+    }
+    if (!ok) {
+        dma_channel_abort(_dma);
+        _reset(_dataSM);
+    }
+    if (ns > 1) {
+        ok = _stop() && ok;
+    }
+    return ok;
+}
+
+bool SDIOCard::_writeBlock(const uint8_t *src) {
+    uint32_t *b = _buff;
+    b[0] = 0xfffffff0; // Idle, then the start bit
+    for (int i = 0; i < 512 / 4; i++, src += 4) {
+        b[1 + i] = (src[0] << 24) | (src[1] << 16) | (src[2] << 8) | src[3];
+    }
+    uint16_t crc[4];
+    _crcSector(b + 1, crc);
+    uint32_t c[2] = { 0, 0 };
+    for (int k = 0; k < 16; k++) {
+        uint32_t nib = 0;
+        for (int l = 0; l < 4; l++) {
+            nib |= ((crc[l] >> (15 - k)) & 1) << l;
+        }
+        c[k / 8] |= nib << (28 - 4 * (k % 8));
+    }
+    b[1 + 512 / 4] = c[0];
+    b[2 + 512 / 4] = c[1];
+    b[3 + 512 / 4] = 0xffffffff; // Only the end bit in the top nibble goes out
+
+    _reset(_dataSM);
+    pio_sm_set_config(_pio, _dataSM, &_txConfig);
+    _setXY(_dataSM, SDIO_TX_NIBBLES - 1, 0);
+
+    dma_channel_config dc = dma_channel_get_default_config(_dma);
+    channel_config_set_transfer_data_size(&dc, DMA_SIZE_32);
+    channel_config_set_read_increment(&dc, true);
+    channel_config_set_write_increment(&dc, false);
+    channel_config_set_dreq(&dc, pio_get_dreq(_pio, _dataSM, true));
+    dma_channel_configure(_dma, &dc, &_pio->txf[_dataSM], b, SDIO_TX_WORDS, true);
+
+    pio_sm_exec(_pio, _dataSM, pio_encode_jmp(_offset + sdio_offset_tx_start));
+    pio_sm_set_enabled(_pio, _dataSM, true);
+
+    uint32_t start = millis();
+    while (pio_sm_is_rx_fifo_empty(_pio, _dataSM)) {
+        if (millis() - start > 50) {
+            dma_channel_abort(_dma);
+            _reset(_dataSM);
+            return false;
+        }
+    }
+    // CRC status is 3 bits and the end bit, 010 when the sector was taken
+    uint32_t status = pio_sm_get(_pio, _dataSM);
+    if (((status >> 1) & 7) != 2) {
+        DEBUGV("SDIO: Write rejected, status %lx\n", status);
+        return false;
+    }
+    return _waitNotBusy(250);
+}
+
+bool SDIOCard::writeSectors(uint32_t sector, const uint8_t *src, size_t ns) {
+    if (!_sectors || !_waitNotBusy(250)) {
+        return false;
+    }
+    uint32_t addr = (_type == SD_CARD_TYPE_SDHC) ? sector : sector * 512;
+    if (!_cmd((ns == 1) ? 24 : 25, addr)) {
+        return false;
+    }
+    bool ok = true;
+    for (size_t i = 0; ok && (i < ns); i++, src += 512) {
+        ok = _writeBlock(src);
+    }
+    if (ns > 1) {
+        ok = _stop() && ok;
+    }
+    return ok;
+}
+
+}; // namespace sdfs
@@ -0,0 +1,98 @@
+/*
+    SDIOCard.h - SD card block device on a 4-bit SDIO bus, using PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+#include <SdFat.h>
+
+// FatVolume can only be mounted on a generic block device when SdFat's own config enables it
+#if !USE_BLOCK_DEVICE_INTERFACE
+#error SDIOCard needs USE_BLOCK_DEVICE_INTERFACE set in SdFatConfig.h
+#endif
+
+namespace sdfs {
+
+// SdFat block device for a card wired for SD bus mode.  DAT0-DAT3 must be on consecutive
+// GPIOs, CLK and CMD can be anywhere.  All lines but CLK need pull-ups, the internal ones
+// are enabled but external 10K-50K ones are recommended.
+class SDIOCard : public FsBlockDeviceInterface {
+public:
+    SDIOCard() { }
+
+    bool begin(uint8_t clkPin, uint8_t cmdPin, uint8_t dat0Pin, uint32_t clockHz = 25000000);
+    void end() override;
+
+    bool isBusy() override;
+    bool readSector(uint32_t sector, uint8_t *dst) override {
+        return readSectors(sector, dst, 1);
+    }
+    bool readSectors(uint32_t sector, uint8_t *dst, size_t ns) override;
+    uint32_t sectorCount() override {
+        return _sectors;
+    }
+    bool syncDevice() override {
+        return _waitNotBusy(500);
+    }
+    bool writeSector(uint32_t sector, const uint8_t *src) override {
+        return writeSectors(sector, src, 1);
+    }
+    bool writeSectors(uint32_t sector, const uint8_t *src, size_t ns) override;
+
+    // SD_CARD_TYPE_SD1/SD2/SDHC, like SdSpiCard::type()
+    uint8_t type() {
+        return _type;
+    }
+
+private:
+    bool _cmd(uint8_t cmd, uint32_t arg, int respBits = 48);
+    bool _acmd(uint8_t cmd, uint32_t arg);
+    bool _clocks(int n);
+    bool _waitNotBusy(uint32_t ms);
+    bool _waitPark(int sm, uint32_t us);
+    void _setClock(uint32_t hz);
+    void _setXY(int sm, uint32_t x, uint32_t y);
+    void _startRx(uint32_t *buff);
+    bool _waitRx();
+    bool _finishRx(uint32_t *buff, uint8_t *dst);
+    bool _writeBlock(const uint8_t *src);
+    bool _stop();
+    void _reset(int sm);
+
+    PIO _pio = nullptr;
+    int _cmdSM = -1;
+    int _dataSM = -1;
+    int _offset = -1;
+    int _dma = -1;
+    uint8_t _clk = 0;
+    uint8_t _cmdPin = 0;
+    uint8_t _dat0 = 0;
+    uint8_t _type = 0;
+    uint16_t _rca = 0;
+    uint32_t _sectors = 0;
+    pio_sm_config _rxConfig;
+    pio_sm_config _txConfig;
+    uint32_t _resp[4];
+    // Two sectors on the wire, so one can be checked while the next arrives
+    uint32_t *_buff = nullptr;
+};
+
+}; // namespace sdfs
@@ -0,0 +1,68 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// ---- //
+// sdio //
+// ---- //
+
+#define sdio_wrap_target 14
+#define sdio_wrap 16
+
+#define sdio_offset_cmd_tx 0u
+#define sdio_offset_rx_wait 12u
+#define sdio_offset_tx_start 17u
+#define sdio_offset_park 27u
+
+static const uint16_t sdio_program_instructions[] = {
+    0xe081, //  0: set    pindirs, 1        side 0
+    0x6201, //  1: out    pins, 1           side 0 [2]
+    0x1241, //  2: jmp    x--, 1            side 1 [2]
+    0xe080, //  3: set    pindirs, 0        side 0
+    0x007b, //  4: jmp    !y, 27            side 0
+    0xa242, //  5: nop                      side 0 [2]
+    0x12c5, //  6: jmp    pin, 5            side 1 [2]
+    0xa242, //  7: nop                      side 0 [2]
+    0x5101, //  8: in     pins, 1           side 1 [1]
+    0x1087, //  9: jmp    y--, 7            side 1
+    0x8020, // 10: push   block             side 0
+    0x001b, // 11: jmp    27                side 0
+    0xa142, // 12: nop                      side 0 [1]
+    0x11cc, // 13: jmp    pin, 12           side 1 [1]
+    //     .wrap_target
+    0x0150, // 14: jmp    x--, 16           side 0 [1]
+    0x001b, // 15: jmp    27                side 0
+    0x5104, // 16: in     pins, 4           side 1 [1]
+    //     .wrap
+    0xe08f, // 17: set    pindirs, 15       side 0
+    0x6104, // 18: out    pins, 4           side 0 [1]
+    0x1152, // 19: jmp    x--, 18           side 1 [1]
+    0xe180, // 20: set    pindirs, 0        side 0 [1]
+    0xa142, // 21: nop                      side 0 [1]
+    0x11d5, // 22: jmp    pin, 21           side 1 [1]
+    0xe123, // 23: set    x, 3              side 0 [1]
+    0x5101, // 24: in     pins, 1           side 1 [1]
+    0x0158, // 25: jmp    x--, 24           side 0 [1]
+    0x8020, // 26: push   block             side 0
+    0x80a0, // 27: pull   block             side 0
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program sdio_program = {
+    .instructions = sdio_program_instructions,
+    .length = 28,
+    .origin = -1,
+};
+
+static inline pio_sm_config sdio_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + sdio_wrap_target, offset + sdio_wrap);
+    sm_config_set_sideset(&c, 1, false, false);
+    return c;
+}
+#endif
+
@@ -0,0 +1,60 @@
+// SPI master and DMA slave demo - Earle F. Philhower, III
+// Released into the public domain
+//
+// SPI (master) sends numbered frames to SPISlave1, which answers each
+// one in the next frame with the same bytes reversed.
+//
+// To run, connect GPIO3 to GPIO12 (MOSI), GPIO11 to GPIO0 (MISO),
+// GPIO2 to GPIO10 (SCK), and GPIO1 to GPIO13 (CS) on a single Pico
+
+#include <SPI.h>
+#include <SPISlave.h>
+
+#define CS 1
+
+// Runs from the CS IRQ at the end of every frame
+void frame(const uint8_t *data, size_t len, void *param) {
+  (void) param;
+  uint8_t rev[64];
+  for (size_t i = 0; i < len; i++) {
+    rev[i] = data[len - 1 - i];
+  }
+  SPISlave1.setResponse(rev, len);
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+
+  SPISlave1.setRX(12);
+  SPISlave1.setCS(13);
+  SPISlave1.setSCK(10);
+  SPISlave1.setTX(11);
+  SPISlave1.onFrame(frame);
+  // Modes with CPHA=1 let the host send many bytes per CS assertion
+  SPISlave1.begin(SPISettings(4000000, MSBFIRST, SPI_MODE3), 64);
+
+  SPI.setRX(0);
+  SPI.setSCK(2);
+  SPI.setTX(3);
+  SPI.begin();
+  pinMode(CS, OUTPUT);
+  digitalWrite(CS, HIGH);
+}
+
+void loop() {
+  static int n;
+  char out[32];
+  char in[32];
+  snprintf(out, sizeof(out), "Frame %d", n++);
+
+  SPI.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE3));
+  digitalWrite(CS, LOW);
+  SPI.transfer(out, in, strlen(out));
+  digitalWrite(CS, HIGH);
+  SPI.endTransaction();
+
+  in[strlen(out)] = 0;
+  Serial.printf("Sent '%s', got back '%s'\n", out, in);
+  delay(1000);
+}
@@ -21,6 +21,7 @@
 #include "SPI.h"
 #include <hardware/spi.h>
 #include <hardware/gpio.h>
+#include <hardware/dma.h>
 
 #ifdef USE_TINYUSB
 // For Serial when selecting TinyUSB.  Can't include in the core because Arduino IDE
@@ -40,6 +41,11 @@ SPIClassRP2040::SPIClassRP2040(spi_inst_t *spi, pin_size_t rx, pin_size_t cs, pi
     _TX = tx;
     _SCK = sck;
     _CS = cs;
+    _bits = 0;
+    _channelDMATX = -1;
+    _channelDMARX = -1;
+    _dmaActive = false;
+    _dmaBuffer = nullptr;
 }
 
 inline spi_cpol_t SPIClassRP2040::cpol() {
@@ -72,6 +78,14 @@ inline spi_cpha_t SPIClassRP2040::cpha() {
     return SPI_CPHA_0;
 }
 
+// Only touch the HW when the data width or mode actually changes
+inline void SPIClassRP2040::setFormat(uint8_t bits) {
+    if (bits != _bits) {
+        spi_set_format(_spi, bits, _cpol, _cpha, SPI_MSB_FIRST);
+        _bits = bits;
+    }
+}
+
 inline uint8_t SPIClassRP2040::reverseByte(uint8_t b) {
     b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
     b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
@@ -83,6 +97,14 @@ inline uint16_t SPIClassRP2040::reverse16Bit(uint16_t w) {
     return (reverseByte(w & 0xff) << 8) | (reverseByte(w >> 8));
 }
 
+// Reverse the bits in each byte of a 32-bit word, 4 bytes at a time (no RBIT on the M0+)
+static inline uint32_t reverseBytes32(uint32_t w) {
+    w = ((w >> 4) & 0x0F0F0F0F) | ((w & 0x0F0F0F0F) << 4);
+    w = ((w >> 2) & 0x33333333) | ((w & 0x33333333) << 2);
+    w = ((w >> 1) & 0x55555555) | ((w & 0x55555555) << 1);
+    return w;
+}
+
 // The HW can't do LSB first, only MSB first, so need to bitreverse
 void SPIClassRP2040::adjustBuffer(const void *s, void *d, size_t cnt, bool by16) {
     if (_spis.getBitOrder() == MSBFIRST) {
@@ -90,6 +112,15 @@ void SPIClassRP2040::adjustBuffer(const void *s, void *d, size_t cnt, bool by16)
     } else if (!by16) {
         const uint8_t *src = (const uint8_t *)s;
         uint8_t *dst = (uint8_t *)d;
+        if (!(((uint32_t)src | (uint32_t)dst) & 3)) {
+            // Both word aligned, so do the bulk of it 32 bits at a time
+            while (cnt >= 4) {
+                *(uint32_t *)dst = reverseBytes32(*(const uint32_t *)src);
+                src += 4;
+                dst += 4;
+                cnt -= 4;
+            }
+        }
         for (size_t i = 0; i < cnt; i++) {
             *(dst++) = reverseByte(*(src++));
         }
@@ -108,7 +139,7 @@ byte SPIClassRP2040::transfer(uint8_t data) {
         return 0;
     }
     data = (_spis.getBitOrder() == MSBFIRST) ? data : reverseByte(data);
-    spi_set_format(_spi, 8, cpol(), cpha(), SPI_MSB_FIRST);
+    setFormat(8);
     DEBUGSPI("SPI::transfer(%02x), cpol=%d, cpha=%d\n", data, cpol(), cpha());
     spi_write_read_blocking(_spi, &data, &ret, 1);
     ret = (_spis.getBitOrder() == MSBFIRST) ? ret : reverseByte(ret);
@@ -122,23 +153,18 @@ uint16_t SPIClassRP2040::transfer16(uint16_t data) {
         return 0;
     }
     data = (_spis.getBitOrder() == MSBFIRST) ? data : reverse16Bit(data);
-    spi_set_format(_spi, 16, cpol(), cpha(), SPI_MSB_FIRST);
+    setFormat(16);
     DEBUGSPI("SPI::transfer16(%04x), cpol=%d, cpha=%d\n", data, cpol(), cpha());
     spi_write16_read16_blocking(_spi, &data, &ret, 1);
-    ret = (_spis.getBitOrder() == MSBFIRST) ? ret : reverseByte(ret);
-    DEBUGSPI("SPI: read back %02x\n", ret);
+    ret = (_spis.getBitOrder() == MSBFIRST) ? ret : reverse16Bit(ret);
+    DEBUGSPI("SPI: read back %04x\n", ret);
     return ret;
 }
 
 void SPIClassRP2040::transfer(void *buf, size_t count) {
     DEBUGSPI("SPI::transfer(%p, %d)\n", buf, count);
-    uint8_t *buff = reinterpret_cast<uint8_t *>(buf);
-    for (size_t i = 0; i < count; i++) {
-        *buff = transfer(*buff);
-        *buff = (_spis.getBitOrder() == MSBFIRST) ? *buff : reverseByte(*buff);
-        buff++;
-    }
-    DEBUGSPI("SPI::transfer completed\n");
+    // The bulk TX/RX routine reads each byte before overwriting it, so is safe in-place
+    transfer(buf, buf, count);
 }
 
 void SPIClassRP2040::transfer(void *txbuf, void *rxbuf, size_t count) {
@@ -152,7 +178,13 @@ void SPIClassRP2040::transfer(void *txbuf, void *rxbuf, size_t count) {
 
     // MSB version is easy!
     if (_spis.getBitOrder() == MSBFIRST) {
-        spi_set_format(_spi, 8, cpol(), cpha(), SPI_MSB_FIRST);
+        // Big transfers can run at the full SPI rate using DMA
+        if ((count >= _dmaThreshold) && transferAsync(txbuff, rxbuff, count)) {
+            waitAsync();
+            return;
+        }
+
+        setFormat(8);
 
         if (rxbuf == NULL) { // transmit only!
             spi_write_blocking(_spi, txbuff, count);
@@ -167,29 +199,177 @@ void SPIClassRP2040::transfer(void *txbuf, void *rxbuf, size_t count) {
         return;
     }
 
-    // If its LSB this isn't nearly as fun, we'll just let transfer(x) do it :(
-    for (size_t i = 0; i < count; i++) {
-        *rxbuff = transfer(*txbuff);
-        *rxbuff = (_spis.getBitOrder() == MSBFIRST) ? *rxbuff : reverseByte(*rxbuff);
-        txbuff++;
-        rxbuff++;
+    // If its LSB this isn't nearly as fun, bit reverse through a small buffer and send each chunk in bulk
+    setFormat(8);
+    uint32_t buff32[64]; // Word aligned for adjustBuffer's fast path
+    uint8_t *buff = reinterpret_cast<uint8_t *>(buff32);
+    while (count) {
+        size_t cnt = std::min(count, sizeof(buff32));
+        if (txbuff) {
+            adjustBuffer(txbuff, buff, cnt, false);
+            txbuff += cnt;
+        } else {
+            memset(buff, 0xff, cnt);
+        }
+        if (rxbuff) {
+            spi_write_read_blocking(_spi, buff, buff, cnt);
+            adjustBuffer(buff, rxbuff, cnt, false);
+            rxbuff += cnt;
+        } else {
+            spi_write_blocking(_spi, buff, cnt);
+        }
+        count -= cnt;
     }
     DEBUGSPI("SPI::transfer completed\n");
 }
 
+bool SPIClassRP2040::claimDMA() {
+    if (_channelDMATX < 0) {
+        _channelDMATX = dma_claim_unused_channel(false);
+    }
+    if (_channelDMARX < 0) {
+        _channelDMARX = dma_claim_unused_channel(false);
+        if ((_channelDMARX >= 0) && __isFreeRTOS) {
+            DMAChannel::attachInterrupt(_channelDMARX, _dmaDone, this);
+        }
+    }
+    if ((_channelDMATX < 0) || (_channelDMARX < 0)) {
+        releaseDMA();
+        return false;
+    }
+    return true;
+}
+
+void SPIClassRP2040::releaseDMA() {
+    if (_channelDMATX >= 0) {
+        dma_channel_unclaim(_channelDMATX);
+        _channelDMATX = -1;
+    }
+    if (_channelDMARX >= 0) {
+        if (__isFreeRTOS) {
+            DMAChannel::detachInterrupt(_channelDMARX);
+        }
+        dma_channel_unclaim(_channelDMARX);
+        _channelDMARX = -1;
+    }
+}
+
+bool SPIClassRP2040::transferAsync(const void *send, void *recv, size_t bytes) {
+    if (!_initted || _dmaActive || !bytes || !claimDMA()) {
+        return false;
+    }
+    DEBUGSPI("SPI::transferAsync(%p, %p, %d)\n", send, recv, bytes);
+    const uint8_t *txbuff = reinterpret_cast<const uint8_t *>(send);
+    if (send && (_spis.getBitOrder() != MSBFIRST)) {
+        _dmaBuffer = new uint8_t[bytes];
+        adjustBuffer(send, _dmaBuffer, bytes, false);
+        txbuff = _dmaBuffer;
+    }
+    _dmaRecv = reinterpret_cast<uint8_t *>(recv);
+    _dmaBytes = bytes;
+    _dmaFill = 0xff;
+
+    setFormat(8);
+
+    dma_channel_config c = dma_channel_get_default_config(_channelDMATX);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, txbuff != nullptr);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(_spi, true));
+    dma_channel_configure(_channelDMATX, &c, &spi_get_hw(_spi)->dr, txbuff ? txbuff : &_dmaFill, bytes, false);
+
+    c = dma_channel_get_default_config(_channelDMARX);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, _dmaRecv != nullptr);
+    channel_config_set_dreq(&c, spi_get_dreq(_spi, false));
+    dma_channel_configure(_channelDMARX, &c, _dmaRecv ? _dmaRecv : &_dmaDiscard, &spi_get_hw(_spi)->dr, bytes, false);
+
+    // Start both at once so the RX side never falls behind the TX FIFO
+    _dmaActive = true;
+    dma_start_channel_mask((1u << _channelDMATX) | (1u << _channelDMARX));
+    return true;
+}
+
+bool SPIClassRP2040::finishedAsync() {
+    if (!_dmaActive) {
+        return true;
+    }
+    // RX completes last, once the final byte has been clocked out and back in
+    if (dma_channel_is_busy(_channelDMATX) || dma_channel_is_busy(_channelDMARX)) {
+        return false;
+    }
+    while (spi_is_busy(_spi)) {
+        /* noop, wait for the last bits to leave */
+    }
+    if (_dmaRecv && (_spis.getBitOrder() != MSBFIRST)) {
+        adjustBuffer(_dmaRecv, _dmaRecv, _dmaBytes, false);
+    }
+    delete[] _dmaBuffer;
+    _dmaBuffer = nullptr;
+    _dmaActive = false;
+    DEBUGSPI("SPI::transferAsync completed\n");
+    return true;
+}
+
+void SPIClassRP2040::waitAsync() {
+    _dmaWait.until([this] { return finishedAsync(); });
+}
+
+void __not_in_flash_func(SPIClassRP2040::_dmaDone)(int channel, void *param) {
+    (void) channel;
+    ((SPIClassRP2040 *)param)->_dmaWait.notify();
+}
+
+void SPIClassRP2040::abortAsync() {
+    if (!_dmaActive) {
+        return;
+    }
+    dma_channel_abort(_channelDMATX);
+    dma_channel_abort(_channelDMARX);
+    // Throw out anything left in the RX FIFO
+    while (spi_is_readable(_spi)) {
+        (void) spi_get_hw(_spi)->dr;
+    }
+    delete[] _dmaBuffer;
+    _dmaBuffer = nullptr;
+    _dmaActive = false;
+}
+
 void SPIClassRP2040::beginTransaction(SPISettings settings) {
     DEBUGSPI("SPI::beginTransaction(clk=%d, bo=%s\n", _spis.getClockFreq(), (_spis.getBitOrder() == MSBFIRST) ? "MSB" : "LSB");
     if (_initted && settings == _spis) {
         DEBUGSPI("SPI: Reusing existing initted SPI\n");
-    } else {
+    } else if (_initted) {
+        // Only reprogram the parts that changed, no need for a full deinit/init cycle
+        if (settings.getClockFreq() != _spis.getClockFreq()) {
+            DEBUGSPI("SPI: changing baud rate\n");
+            spi_set_baudrate(_spi, settings.getClockFreq());
+        }
         _spis = settings;
-        if (_initted) {
-            DEBUGSPI("SPI: deinitting currently active SPI\n");
-            spi_deinit(_spi);
+        if ((cpol() != _cpol) || (cpha() != _cpha)) {
+            _cpol = cpol();
+            _cpha = cpha();
+            _bits = 0; // Force a format update on the next transfer
         }
+    } else {
+        _spis = settings;
         DEBUGSPI("SPI: initting SPI\n");
         spi_init(_spi, _spis.getClockFreq());
+        _cpol = cpol();
+        _cpha = cpha();
+        _bits = 0;
         _initted = true;
+        _clockNotifier.attach();
+    }
+}
+
+void SPIClassRP2040::_clockChanged(void *arg, bool after) {
+    SPIClassRP2040 *s = (SPIClassRP2040 *)arg;
+    if (!after) {
+        while (spi_is_busy(s->_spi)) { /* noop */ }
+    } else {
+        spi_set_baudrate(s->_spi, s->_spis.getClockFreq());
     }
 }
 
@@ -280,8 +460,11 @@ void SPIClassRP2040::begin(bool hwCS) {
 
 void SPIClassRP2040::end() {
     DEBUGSPI("SPI::end()\n");
+    abortAsync();
+    releaseDMA();
     if (_initted) {
         DEBUGSPI("SPI: deinitting currently active SPI\n");
+        _clockNotifier.detach();
         _initted = false;
         spi_deinit(_spi);
     }
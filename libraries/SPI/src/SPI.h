@@ -23,6 +23,7 @@
 #include <Arduino.h>
 #include <api/HardwareSPI.h>
 #include <hardware/spi.h>
+#include <IRQWait.h>
 
 class SPIClassRP2040 : public arduino::HardwareSPI {
 public:
@@ -38,6 +39,13 @@ public:
     // Sends one buffer and receives into another, much faster! can set rx or txbuf to NULL
     void transfer(void *txbuf, void *rxbuf, size_t count);
 
+    // DMA based transfer running in the background.  Buffers need to remain valid and
+    // no other SPI calls may be made until finishedAsync() returns true.
+    bool transferAsync(const void *send, void *recv, size_t bytes);
+    bool finishedAsync(); // Call to check if the async operations is completed and the buffer can be reused/read
+    void waitAsync(); // Block until the async operation completes
+    void abortAsync(); // Cancel an outstanding async operation
+
     // Call before/after every complete transaction
     void beginTransaction(SPISettings settings) override;
     void endTransaction(void) override;
@@ -73,9 +81,12 @@ public:
 private:
     spi_cpol_t cpol();
     spi_cpha_t cpha();
+    void setFormat(uint8_t bits);
     uint8_t reverseByte(uint8_t b);
     uint16_t reverse16Bit(uint16_t w);
     void adjustBuffer(const void *s, void *d, size_t cnt, bool by16);
+    bool claimDMA();
+    void releaseDMA();
 
     spi_inst_t *_spi;
     SPISettings _spis;
@@ -83,6 +94,28 @@ private:
     bool _hwCS;
     bool _running; // SPI port active
     bool _initted; // Transaction begun
+
+    // Currently programmed HW format, to avoid rewriting it on every transfer
+    uint8_t _bits; // 0 = unknown, needs to be written before next use
+    spi_cpol_t _cpol;
+    spi_cpha_t _cpha;
+
+    // DMA transfers, channels are only claimed on first use
+    static constexpr size_t _dmaThreshold = 64; // Blocking transfers at least this big will use DMA
+    int _channelDMATX;
+    int _channelDMARX;
+    bool _dmaActive;
+    uint8_t *_dmaBuffer; // Bit-reversed copy of the TX data for LSB-first transfers
+    uint8_t *_dmaRecv;
+    size_t _dmaBytes;
+    uint8_t _dmaFill;    // Source of 0xff for RX-only transfers
+    uint8_t _dmaDiscard; // Sink for TX-only transfers, apart from _dmaFill so RX can't overwrite it
+    IRQWait _dmaWait; // Under FreeRTOS waitAsync() sleeps until the RX channel's IRQ
+    static void _dmaDone(int channel, void *param);
+
+    // Reprograms the baud rate when the system clock changes
+    ClockNotifier _clockNotifier{_clockChanged, this};
+    static void _clockChanged(void *arg, bool after);
 };
 
 extern SPIClassRP2040 SPI;
@@ -0,0 +1,329 @@
+/*
+    SPI Slave library for the Raspberry Pi Pico RP2040
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "SPISlave.h"
+#include <hardware/spi.h>
+#include <hardware/gpio.h>
+#include <hardware/dma.h>
+
+#ifdef USE_TINYUSB
+// For Serial when selecting TinyUSB.  Can't include in the core because Arduino IDE
+// will not link in libraries called from the core.  Instead, add the header to all
+// the standard libraries in the hope it will still catch some user cases where they
+// use these libraries.
+// See https://github.com/earlephilhower/arduino-pico/issues/167#issuecomment-848622174
+#include <Adafruit_TinyUSB.h>
+#endif
+
+SPISlaveRP2040::SPISlaveRP2040(spi_inst_t *spi, pin_size_t rx, pin_size_t cs, pin_size_t sck, pin_size_t tx) {
+    _spi = spi;
+    _running = false;
+    _RX = rx;
+    _TX = tx;
+    _SCK = sck;
+    _CS = cs;
+    _channelDMATX = -1;
+    _channelDMARX = -1;
+    _rxBuf = nullptr;
+    _rxLen = nullptr;
+    _txBuf[0] = nullptr;
+    _txBuf[1] = nullptr;
+    _handler = nullptr;
+    _handlerParam = nullptr;
+}
+
+bool SPISlaveRP2040::setRX(pin_size_t pin) {
+    constexpr uint32_t valid[2] = { __bitset({0, 4, 16, 20}) /* SPI0 */,
+                                    __bitset({8, 12, 24, 28})  /* SPI1 */
+                                  };
+    if ((!_running) && ((1 << pin) & valid[spi_get_index(_spi)])) {
+        _RX = pin;
+        return true;
+    }
+
+    if (_running) {
+        panic("FATAL: Attempting to set SPISlave%s.RX while running", spi_get_index(_spi) ? "1" : "");
+    } else {
+        panic("FATAL: Attempting to set SPISlave%s.RX to illegal pin %d", spi_get_index(_spi) ? "1" : "", pin);
+    }
+    return false;
+}
+
+bool SPISlaveRP2040::setCS(pin_size_t pin) {
+    constexpr uint32_t valid[2] = { __bitset({1, 5, 17, 21}) /* SPI0 */,
+                                    __bitset({9, 13, 25, 29})  /* SPI1 */
+                                  };
+    if ((!_running) && ((1 << pin) & valid[spi_get_index(_spi)])) {
+        _CS = pin;
+        return true;
+    }
+
+    if (_running) {
+        panic("FATAL: Attempting to set SPISlave%s.CS while running", spi_get_index(_spi) ? "1" : "");
+    } else {
+        panic("FATAL: Attempting to set SPISlave%s.CS to illegal pin %d", spi_get_index(_spi) ? "1" : "", pin);
+    }
+    return false;
+}
+
+bool SPISlaveRP2040::setSCK(pin_size_t pin) {
+    constexpr uint32_t valid[2] = { __bitset({2, 6, 18, 22}) /* SPI0 */,
+                                    __bitset({10, 14, 26})  /* SPI1 */
+                                  };
+    if ((!_running) && ((1 << pin) & valid[spi_get_index(_spi)])) {
+        _SCK = pin;
+        return true;
+    }
+
+    if (_running) {
+        panic("FATAL: Attempting to set SPISlave%s.SCK while running", spi_get_index(_spi) ? "1" : "");
+    } else {
+        panic("FATAL: Attempting to set SPISlave%s.SCK to illegal pin %d", spi_get_index(_spi) ? "1" : "", pin);
+    }
+    return false;
+}
+
+bool SPISlaveRP2040::setTX(pin_size_t pin) {
+    constexpr uint32_t valid[2] = { __bitset({3, 7, 19, 23}) /* SPI0 */,
+                                    __bitset({11, 15, 27})  /* SPI1 */
+                                  };
+    if ((!_running) && ((1 << pin) & valid[spi_get_index(_spi)])) {
+        _TX = pin;
+        return true;
+    }
+
+    if (_running) {
+        panic("FATAL: Attempting to set SPISlave%s.TX while running", spi_get_index(_spi) ? "1" : "");
+    } else {
+        panic("FATAL: Attempting to set SPISlave%s.TX to illegal pin %d", spi_get_index(_spi) ? "1" : "", pin);
+    }
+    return false;
+}
+
+bool SPISlaveRP2040::begin(SPISettings settings, size_t frameSize, int frames) {
+    if (_running || !frameSize || (frames < 1) || (settings.getBitOrder() != MSBFIRST)) {
+        return false;
+    }
+    switch (settings.getDataMode()) {
+    case SPI_MODE0:
+        _cpol = SPI_CPOL_0;
+        _cpha = SPI_CPHA_0;
+        break;
+    case SPI_MODE1:
+        _cpol = SPI_CPOL_0;
+        _cpha = SPI_CPHA_1;
+        break;
+    case SPI_MODE2:
+        _cpol = SPI_CPOL_1;
+        _cpha = SPI_CPHA_0;
+        break;
+    case SPI_MODE3:
+        _cpol = SPI_CPOL_1;
+        _cpha = SPI_CPHA_1;
+        break;
+    }
+
+    _frameSize = frameSize;
+    _frames = frames;
+    _rxBuf = (uint8_t *)malloc((frames + 1) * frameSize);
+    _rxLen = (size_t *)malloc((frames + 1) * sizeof(size_t));
+    _txBuf[0] = (uint8_t *)malloc(frameSize);
+    _txBuf[1] = (uint8_t *)malloc(frameSize);
+    _channelDMATX = dma_claim_unused_channel(false);
+    _channelDMARX = dma_claim_unused_channel(false);
+    if (!_rxBuf || !_rxLen || !_txBuf[0] || !_txBuf[1] || (_channelDMATX < 0) || (_channelDMARX < 0)) {
+        _freeBuffers();
+        return false;
+    }
+    memset(_txBuf[0], 0xff, frameSize);
+    memset(_txBuf[1], 0xff, frameSize);
+    _txActive = 0;
+    _txPending = false;
+    _fill = 0;
+    _head = 0;
+    _dropped = 0;
+
+    DEBUGSPI("SPISlave::begin(), rx=%d, cs=%d, sck=%d, tx=%d\n", _RX, _CS, _SCK, _TX);
+    gpio_set_function(_RX, GPIO_FUNC_SPI);
+    gpio_set_function(_CS, GPIO_FUNC_SPI);
+    gpio_set_function(_SCK, GPIO_FUNC_SPI);
+    gpio_set_function(_TX, GPIO_FUNC_SPI);
+    _restart();
+    _arm();
+    _running = true;
+    // The GPIO input and its IRQ still work with the pin given to the SPI block
+    attachInterruptParam(_CS, _csRise, RISING, this);
+    return true;
+}
+
+void SPISlaveRP2040::end() {
+    if (!_running) {
+        return;
+    }
+    DEBUGSPI("SPISlave::end()\n");
+    detachInterrupt(_CS);
+    _running = false;
+    dma_channel_abort(_channelDMARX);
+    dma_channel_abort(_channelDMATX);
+    spi_deinit(_spi);
+    gpio_set_function(_RX, GPIO_FUNC_SIO);
+    gpio_set_function(_CS, GPIO_FUNC_SIO);
+    gpio_set_function(_SCK, GPIO_FUNC_SIO);
+    gpio_set_function(_TX, GPIO_FUNC_SIO);
+    _freeBuffers();
+}
+
+void SPISlaveRP2040::_freeBuffers() {
+    if (_channelDMATX >= 0) {
+        dma_channel_unclaim(_channelDMATX);
+        _channelDMATX = -1;
+    }
+    if (_channelDMARX >= 0) {
+        dma_channel_unclaim(_channelDMARX);
+        _channelDMARX = -1;
+    }
+    free(_rxBuf);
+    _rxBuf = nullptr;
+    free(_rxLen);
+    _rxLen = nullptr;
+    free(_txBuf[0]);
+    _txBuf[0] = nullptr;
+    free(_txBuf[1]);
+    _txBuf[1] = nullptr;
+}
+
+// Resetting the block is the only way to empty its FIFOs, and the TX one still holds the
+// bytes it had queued for the frame which just ended
+void SPISlaveRP2040::_restart() {
+    spi_init(_spi, 1000000); // The baud rate only matters to a master
+    spi_set_format(_spi, 8, _cpol, _cpha, SPI_MSB_FIRST);
+    spi_set_slave(_spi, true);
+}
+
+void SPISlaveRP2040::_arm() {
+    dma_channel_config c = dma_channel_get_default_config(_channelDMARX);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, spi_get_dreq(_spi, false));
+    dma_channel_configure(_channelDMARX, &c, _rxBuf + _fill * _frameSize, &spi_get_hw(_spi)->dr, _frameSize, false);
+
+    c = dma_channel_get_default_config(_channelDMATX);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(_spi, true));
+    dma_channel_configure(_channelDMATX, &c, &spi_get_hw(_spi)->dr, _txBuf[_txActive], _frameSize, false);
+
+    dma_start_channel_mask((1u << _channelDMATX) | (1u << _channelDMARX));
+}
+
+void __not_in_flash_func(SPISlaveRP2040::_csRise)(void *param) {
+    SPISlaveRP2040 *s = (SPISlaveRP2040 *)param;
+    if (!s->_running) {
+        return;
+    }
+    // Let the DMA pick up the last bytes still in the RX FIFO
+    while (spi_is_readable(s->_spi) && dma_channel_is_busy(s->_channelDMARX)) {
+        /* noop */
+    }
+    size_t len = s->_frameSize - dma_channel_hw_addr(s->_channelDMARX)->transfer_count;
+    dma_channel_abort(s->_channelDMARX);
+    dma_channel_abort(s->_channelDMATX);
+    s->_restart();
+
+    if (len) { // Nothing clocked means a glitch on CS, not a frame
+        if (s->_handler) {
+            s->_handler(s->_rxBuf + s->_fill * s->_frameSize, len, s->_handlerParam);
+        } else {
+            int next = (s->_fill + 1) % (s->_frames + 1);
+            if (next == s->_head) {
+                s->_dropped++;
+            } else {
+                s->_rxLen[s->_fill] = len;
+                __dmb();
+                s->_fill = next;
+            }
+        }
+    }
+    if (s->_txPending) {
+        s->_txActive ^= 1;
+        s->_txPending = false;
+    }
+    s->_arm();
+}
+
+void SPISlaveRP2040::onFrame(FrameHandler fn, void *param) {
+    _handler = nullptr;
+    __dmb();
+    _handlerParam = param;
+    __dmb();
+    _handler = fn;
+}
+
+int SPISlaveRP2040::available() {
+    if (!_running) {
+        return 0;
+    }
+    return (_fill - _head + _frames + 1) % (_frames + 1);
+}
+
+const uint8_t *SPISlaveRP2040::frame(size_t &len) {
+    if (!available()) {
+        return nullptr;
+    }
+    len = _rxLen[_head];
+    return _rxBuf + _head * _frameSize;
+}
+
+void SPISlaveRP2040::release() {
+    if (available()) {
+        _head = (_head + 1) % (_frames + 1);
+    }
+}
+
+uint32_t SPISlaveRP2040::dropped() {
+    return _dropped;
+}
+
+bool SPISlaveRP2040::setResponse(const void *data, size_t len) {
+    if (!_running || (len > _frameSize)) {
+        return false;
+    }
+    // The IRQ only swaps buffers when one is pending, so it can't take this one half written
+    _txPending = false;
+    __dmb();
+    uint8_t *next = _txBuf[_txActive ^ 1];
+    memcpy(next, data, len);
+    memset(next + len, 0xff, _frameSize - len);
+    __dmb();
+    _txPending = true;
+    return true;
+}
+
+#ifndef __SPI0_DEVICE
+#define __SPI0_DEVICE spi0
+#endif
+#ifndef __SPI1_DEVICE
+#define __SPI1_DEVICE spi1
+#endif
+
+SPISlaveRP2040 SPISlave(__SPI0_DEVICE, PIN_SPI0_MISO, PIN_SPI0_SS, PIN_SPI0_SCK, PIN_SPI0_MOSI);
+SPISlaveRP2040 SPISlave1(__SPI1_DEVICE, PIN_SPI1_MISO, PIN_SPI1_SS, PIN_SPI1_SCK, PIN_SPI1_MOSI);
@@ -0,0 +1,97 @@
+/*
+    SPI Slave library for the Raspberry Pi Pico RP2040
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <api/HardwareSPI.h>
+#include <hardware/spi.h>
+
+// A frame is everything clocked in while CS is low.  DMA receives it straight into one of a
+// ring of buffers and sends the preloaded response at the same time, so nothing runs per byte.
+// When CS goes high the frame is queued (or given to the onFrame() handler) and the DMA is
+// set up for the next one from the CS pin's IRQ.
+class SPISlaveRP2040 {
+public:
+    SPISlaveRP2040(spi_inst_t *spi, pin_size_t rx, pin_size_t cs, pin_size_t sck, pin_size_t tx);
+
+    // Assign pins, call before begin().  RX takes the host's MOSI and TX drives its MISO.
+    bool setRX(pin_size_t pin);
+    bool setCS(pin_size_t pin);
+    bool setSCK(pin_size_t pin);
+    bool setTX(pin_size_t pin);
+
+    // Only the data mode of settings is used, the host sets the clock (up to clk_peri / 12)
+    // and bits are always MSB first.  Frames are cut off at frameSize bytes, and up to frames
+    // of them can wait to be read before new ones are dropped.
+    bool begin(SPISettings settings, size_t frameSize = 256, int frames = 4);
+    void end();
+
+    // Called from the CS IRQ with each frame instead of queueing it.  data is only valid until
+    // it returns, and the slave isn't ready for the next frame until then either.
+    typedef void (*FrameHandler)(const uint8_t *data, size_t len, void *param);
+    void onFrame(FrameHandler fn, void *param = nullptr);
+
+    // Queued frames, oldest first.  frame() returns it without copying (nullptr if there's
+    // none), and it stays valid until release()
+    int available();
+    const uint8_t *frame(size_t &len);
+    void release();
+
+    // Frames lost because the queue was full
+    uint32_t dropped();
+
+    // What to send in the following frames, copied and padded with 0xff to frameSize.  Takes
+    // effect at the next CS deassert, so from onFrame() it answers the very next frame.
+    bool setResponse(const void *data, size_t len);
+
+private:
+    void _arm();
+    void _restart();
+    void _freeBuffers();
+    static void _csRise(void *param);
+
+    spi_inst_t *_spi;
+    pin_size_t _RX, _TX, _SCK, _CS;
+    bool _running;
+    spi_cpol_t _cpol;
+    spi_cpha_t _cpha;
+
+    int _channelDMATX;
+    int _channelDMARX;
+
+    size_t _frameSize;
+    int _frames;
+    uint8_t *_rxBuf;            // _frames + 1 buffers, one is always the DMA target
+    size_t *_rxLen;
+    volatile int _fill;         // Buffer being received into, only moved by the IRQ
+    volatile int _head;         // Oldest queued frame, only moved by release()
+    uint32_t _dropped;
+
+    uint8_t *_txBuf[2];         // The one being sent, and the next response
+    volatile int _txActive;
+    volatile bool _txPending;
+
+    FrameHandler _handler;
+    void *_handlerParam;
+};
+
+extern SPISlaveRP2040 SPISlave;
+extern SPISlaveRP2040 SPISlave1;
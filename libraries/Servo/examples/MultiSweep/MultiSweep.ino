@@ -0,0 +1,26 @@
+/* MultiSweep
+  Sweeps 18 servos on GPIO 2 through 19 in a travelling wave, all from a
+  single PIO state machine.  Every frame's positions change together.
+
+  Released to the public domain by Earle F. Philhower, III <earlephilhower@yahoo.com>
+*/
+
+#include <ServoBank.h>
+
+#define NUM_SERVOS 18
+
+ServoBank bank;
+
+void setup() {
+  bank.begin(2, NUM_SERVOS);
+}
+
+void loop() {
+  static int phase = 0;
+  int us[NUM_SERVOS];
+  for (int i = 0; i < NUM_SERVOS; i++) {
+    us[i] = 1500 + 500 * sin(2.0 * PI * (phase + i * 20) / 360.0);
+  }
+  bank.writeMicroseconds(us); // Waits for the last update to reach the pins, then queues this one
+  phase = (phase + 2) % 360;
+}
@@ -99,6 +99,7 @@ int Servo::attach(pin_size_t pin, int minUs, int maxUs, int value) {
         pio_sm_exec(_pio, _smIdx, pio_encode_pull(false, false));
         pio_sm_exec(_pio, _smIdx, pio_encode_mov(pio_x, pio_osr));
         pio_sm_set_enabled(_pio, _smIdx, true);
+        _clockNotifier.attach();
     }
 
     write(value);
@@ -106,8 +107,28 @@ int Servo::attach(pin_size_t pin, int minUs, int maxUs, int value) {
     return pin;
 }
 
+void Servo::_clockChanged(void *arg, bool after) {
+    Servo *s = (Servo *)arg;
+    if (!after) {
+        return;
+    }
+    // Same as attach(), the current frame is cut short
+    pio_sm_set_enabled(s->_pio, s->_smIdx, false);
+    pio_sm_clear_fifos(s->_pio, s->_smIdx);
+    pio_sm_put(s->_pio, s->_smIdx, RP2040::usToPIOCycles(REFRESH_INTERVAL) / 3);
+    pio_sm_exec(s->_pio, s->_smIdx, pio_encode_pull(false, false));
+    pio_sm_exec(s->_pio, s->_smIdx, pio_encode_out(pio_isr, 32));
+    pio_sm_put(s->_pio, s->_smIdx, RP2040::usToPIOCycles(s->_valueUs) / 3);
+    pio_sm_exec(s->_pio, s->_smIdx, pio_encode_pull(false, false));
+    pio_sm_exec(s->_pio, s->_smIdx, pio_encode_mov(pio_x, pio_osr));
+    pio_sm_restart(s->_pio, s->_smIdx);
+    pio_sm_exec(s->_pio, s->_smIdx, pio_encode_jmp(s->_pgmOffset));
+    pio_sm_set_enabled(s->_pio, s->_smIdx, true);
+}
+
 void Servo::detach() {
     if (_attached) {
+        _clockNotifier.detach();
         // Set a 0 for the width and then wait for the halt loop
         pio_sm_put_blocking(_pio, _smIdx, 0);
         delayMicroseconds(5);  // Avoid race condition
@@ -115,7 +136,7 @@ void Servo::detach() {
             // Do nothing until we are stuck in the halt loop (avoid short pulses
         } while (pio_sm_get_pc(_pio, _smIdx) != servo_offset_halt + _pgmOffset);
         pio_sm_set_enabled(_pio, _smIdx, false);
-        pio_sm_unclaim(_pio, _smIdx);
+        PIOProgram::unprepare(_pio, _smIdx);
         _attached = false;
         _valueUs = DEFAULT_NEUTRAL_PULSE_WIDTH;
     }
@@ -86,5 +86,9 @@ private:
     int _maxUs;
     int _valueUs;
 
+    // Reloads the refresh period and pulse width when the system clock changes
+    ClockNotifier _clockNotifier{_clockChanged, this};
+    static void _clockChanged(void *arg, bool after);
+
 
 };
@@ -0,0 +1,248 @@
+/*
+    ServoBank - Drives many servos on consecutive pins from a single PIO state machine
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include "ServoBank.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/pio.h>
+
+#include "servobank.pio.h"
+static PIOProgram _servoBankPgm(&servobank_program);
+
+extern int improved_map(int value, int minIn, int maxIn, int minOut, int maxOut);
+
+ServoBank::ServoBank() {
+    _running = false;
+    _pin = 0;
+    _count = 0;
+    _minUs = DEFAULT_MIN_PULSE_WIDTH;
+    _maxUs = DEFAULT_MAX_PULSE_WIDTH;
+    _pio = nullptr;
+    _sm = -1;
+    _offset = -1;
+    _dmaData = -1;
+    _dmaCtrl = -1;
+    _frameWords = 0;
+    _frame[0] = nullptr;
+    _frame[1] = nullptr;
+    _frameAddr = nullptr;
+    memset(_valueUs, 0, sizeof(_valueUs));
+}
+
+ServoBank::~ServoBank() {
+    end();
+}
+
+bool ServoBank::begin(pin_size_t pin, int count, int minUs, int maxUs) {
+    if (_running || (count < 1) || (pin + count > SERVOBANK_MAX_SERVOS)) {
+        return false;
+    }
+    // Same limits as Servo::attach
+    _maxUs = max(250, min(3000, maxUs));
+    _minUs = max(200, min(_maxUs, minUs));
+    _pin = pin;
+    _count = count;
+    // Channels stay low until first written, so the initial positions can all be staged first
+    memset(_valueUs, 0, sizeof(_valueUs));
+
+    // Every frame is one (state, delay) pair per servo plus the idle time to the next frame
+    _frameWords = 2 * (count + 1);
+    _frame[0] = new uint32_t[_frameWords];
+    _frame[1] = new uint32_t[_frameWords];
+    _build(_frame[0]);
+    _frameAddr = _frame[0];
+
+    if (!_servoBankPgm.prepare(&_pio, &_sm, &_offset)) {
+        DEBUGV("ServoBank: No free PIO state machine\n");
+        end();
+        return false;
+    }
+    _dmaData = dma_claim_unused_channel(false);
+    _dmaCtrl = dma_claim_unused_channel(false);
+    if ((_dmaData < 0) || (_dmaCtrl < 0)) {
+        DEBUGV("ServoBank: No free DMA channels\n");
+        end();
+        return false;
+    }
+    servobank_program_init(_pio, _sm, _offset, pin, count);
+
+    // The data channel plays a frame into the FIFO, then chains to the control channel which
+    // restarts it from whichever frame _frameAddr holds at that moment
+    dma_channel_config c = dma_channel_get_default_config(_dmaData);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(_pio, _sm, true));
+    channel_config_set_chain_to(&c, _dmaCtrl);
+    dma_channel_configure(_dmaData, &c, &_pio->txf[_sm], _frame[0], _frameWords, false);
+
+    c = dma_channel_get_default_config(_dmaCtrl);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(_dmaCtrl, &c, &dma_hw->ch[_dmaData].al3_read_addr_trig, &_frameAddr, 1, false);
+
+    pio_sm_set_enabled(_pio, _sm, true);
+    dma_channel_start(_dmaCtrl);
+    _running = true;
+    return true;
+}
+
+void ServoBank::end() {
+    if (_running) {
+        // Park on an all-low frame and let whatever is still in the FIFO drain out, so no
+        // servo sees a runt pulse
+        memset(_valueUs, 0, sizeof(_valueUs));
+        update();
+        _waitQueued();
+        delay(REFRESH_INTERVAL / 1000 + 1);
+        // Unchain before aborting so the abort can't kick off the control channel again
+        dma_channel_config c = dma_get_channel_config(_dmaData);
+        channel_config_set_chain_to(&c, _dmaData);
+        dma_channel_set_config(_dmaData, &c, false);
+        dma_channel_abort(_dmaCtrl);
+        dma_channel_abort(_dmaData);
+        pio_sm_set_enabled(_pio, _sm, false);
+        _running = false;
+    }
+    if (_sm >= 0) {
+        PIOProgram::unprepare(_pio, _sm);
+        _sm = -1;
+    }
+    if (_dmaData >= 0) {
+        dma_channel_unclaim(_dmaData);
+        _dmaData = -1;
+    }
+    if (_dmaCtrl >= 0) {
+        dma_channel_unclaim(_dmaCtrl);
+        _dmaCtrl = -1;
+    }
+    delete[] _frame[0];
+    _frame[0] = nullptr;
+    delete[] _frame[1];
+    _frame[1] = nullptr;
+    _frameAddr = nullptr;
+    _count = 0;
+}
+
+void ServoBank::write(int channel, int value) {
+    // treat any value less than 200 as angle in degrees (values equal or larger are handled as microseconds)
+    if (value < 200) {
+        value = constrain(value, 0, 180);
+        value = improved_map(value, 0, 180, _minUs, _maxUs);
+    }
+    writeMicroseconds(channel, value);
+}
+
+void ServoBank::writeMicroseconds(int channel, int value) {
+    if ((channel < 0) || (channel >= _count)) {
+        return;
+    }
+    _valueUs[channel] = constrain(value, _minUs, _maxUs);
+}
+
+void ServoBank::writeMicroseconds(const int *values) {
+    for (int i = 0; i < _count; i++) {
+        writeMicroseconds(i, values[i]);
+    }
+    update();
+}
+
+void ServoBank::detach(int channel) {
+    if ((channel < 0) || (channel >= _count)) {
+        return;
+    }
+    _valueUs[channel] = 0;
+}
+
+int ServoBank::read(int channel) {
+    return improved_map(readMicroseconds(channel), _minUs, _maxUs, 0, 180);
+}
+
+int ServoBank::readMicroseconds(int channel) {
+    if ((channel < 0) || (channel >= _count) || !_valueUs[channel]) {
+        return DEFAULT_NEUTRAL_PULSE_WIDTH;
+    }
+    return _valueUs[channel];
+}
+
+bool ServoBank::update() {
+    if (!_running) {
+        return false;
+    }
+    // Until the queued frame has started, the other one may still be on the wire
+    _waitQueued();
+    uint32_t *next = (_frameAddr == _frame[0]) ? _frame[1] : _frame[0];
+    _build(next);
+    __dmb();
+    _frameAddr = next;
+    return true;
+}
+
+void ServoBank::_waitQueued() {
+    uint32_t start = (uint32_t)_frameAddr;
+    uint32_t end = start + _frameWords * sizeof(uint32_t);
+    while (true) {
+        uint32_t ra = dma_channel_hw_addr(_dmaData)->read_addr;
+        if ((ra >= start) && (ra < end)) {
+            return;
+        }
+    }
+}
+
+void ServoBank::_build(uint32_t *frame) {
+    // Active channels sorted by width give the order their pulses end in
+    int order[SERVOBANK_MAX_SERVOS];
+    int active = 0;
+    uint32_t state = 0;
+    for (int i = 0; i < _count; i++) {
+        if (_valueUs[i]) {
+            int j = active++;
+            while (j && (_valueUs[order[j - 1]] > _valueUs[i])) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+            state |= 1 << i;
+        }
+    }
+    // Each pair holds its state for delay + 3 cycles, the minimum between edges
+    uint32_t cyclesPerUs = clock_get_hz(clk_sys) / 1000000;
+    uint32_t now = 0;
+    size_t w = 0;
+    for (int i = 0; i < active; i++) {
+        uint32_t edge = _valueUs[order[i]] * cyclesPerUs;
+        uint32_t d = (edge > now + 3) ? edge - now : 3;
+        frame[w++] = state;
+        frame[w++] = d - 3;
+        now += d;
+        state &= ~(1 << order[i]);
+    }
+    // Pad so every frame has the same number of pairs, then idle until the next frame
+    for (int i = active; i < _count; i++) {
+        frame[w++] = 0;
+        frame[w++] = 0;
+        now += 3;
+    }
+    uint32_t period = REFRESH_INTERVAL * cyclesPerUs;
+    frame[w++] = 0;
+    frame[w++] = ((period > now + 3) ? period - now : 3) - 3;
+}
@@ -0,0 +1,81 @@
+/*
+    ServoBank - Drives many servos on consecutive pins from a single PIO state machine
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+    The bank's pulses all start together at the top of each frame.  Every frame
+    is a precomputed list of pin states and delays which DMA loops over, so the
+    CPU is only involved when the positions change.
+
+    The methods are:
+       begin(pin, count) - Drives count servos on pins pin..pin+count-1
+       write(ch, value)  - Stages an angle, or microseconds when >= 200, for one channel
+       writeMicroseconds(ch, us) - Stages a pulse width for one channel
+       update()          - Makes all staged values take effect together at the next frame
+       writeMicroseconds(us[]) - Stages all channels and updates in one call
+       detach(ch)        - Stops pulsing one channel (on the next update)
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+#include "Servo.h"
+
+#define SERVOBANK_MAX_SERVOS 30 // A bank can use every GPIO
+
+class ServoBank {
+public:
+    ServoBank();
+    ~ServoBank();
+
+    bool begin(pin_size_t pin, int count, int min = DEFAULT_MIN_PULSE_WIDTH, int max = DEFAULT_MAX_PULSE_WIDTH);
+    void end();
+
+    void write(int channel, int value);
+    void writeMicroseconds(int channel, int value);
+    void writeMicroseconds(const int *values);
+    void detach(int channel);
+    bool update();
+
+    int read(int channel);
+    int readMicroseconds(int channel);
+    int channels() {
+        return _count;
+    }
+
+private:
+    void _build(uint32_t *frame);
+    void _waitQueued();
+
+    bool _running;
+    pin_size_t _pin;
+    int _count;
+    int _minUs;
+    int _maxUs;
+    PIO _pio;
+    int _sm;
+    int _offset;
+    int _dmaData;
+    int _dmaCtrl;
+    int _valueUs[SERVOBANK_MAX_SERVOS];  // 0 = not pulsing
+    size_t _frameWords;
+    uint32_t *_frame[2];
+    uint32_t *volatile _frameAddr;       // Read by the control DMA channel at each frame start
+};
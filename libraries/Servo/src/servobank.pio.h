@@ -0,0 +1,51 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// --------- //
+// servobank //
+// --------- //
+
+#define servobank_wrap_target 0
+#define servobank_wrap 2
+
+static const uint16_t servobank_program_instructions[] = {
+    //     .wrap_target
+    0x6000, //  0: out    pins, 32
+    0x6020, //  1: out    x, 32
+    0x0042, //  2: jmp    x--, 2
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program servobank_program = {
+    .instructions = servobank_program_instructions,
+    .length = 3,
+    .origin = -1,
+};
+
+static inline pio_sm_config servobank_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + servobank_wrap_target, offset + servobank_wrap);
+    return c;
+}
+
+static inline void servobank_program_init(PIO pio, uint sm, uint offset, uint pin, uint count) {
+    for (uint i = 0; i < count; i++) {
+        pio_gpio_init(pio, pin + i);
+    }
+    pio_sm_set_pins_with_mask(pio, sm, 0, ((1u << count) - 1) << pin);
+    pio_sm_set_consecutive_pindirs(pio, sm, pin, count, true);
+    pio_sm_config c = servobank_program_get_default_config(offset);
+    sm_config_set_out_pins(&c, pin, count);
+    sm_config_set_out_shift(&c, true, true, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    pio_sm_init(pio, sm, offset, &c);
+}
+
+#endif
+
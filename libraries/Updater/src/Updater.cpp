@@ -60,6 +60,10 @@ UpdaterClass& UpdaterClass::onProgress(THandlerFunction_Progress fn) {
 }
 
 void UpdaterClass::_reset() {
+    _hashWait();
+    delete[] _hashBuf;
+    _hashBuf = nullptr;
+    _hashing = false;
     if (_buffer) {
         delete[] _buffer;
     }
@@ -67,11 +71,38 @@ void UpdaterClass::_reset() {
     _bufferLen = 0;
     _startAddress = 0;
     _currentAddress = 0;
+    _erasedAddress = 0;
     _size = 0;
     _command = U_FLASH;
+    _gzip = false;
+    _delta = false;
+    _fp.close(); // Syncs whatever was staged, so it can be resumed
 }
 
 bool UpdaterClass::begin(size_t size, int command) {
+    return _begin(size, command, 0);
+}
+
+bool UpdaterClass::resume(size_t size, size_t offset) {
+    if ((offset % 4096) || (offset >= size) || (offset > staged())) {
+#ifdef DEBUG_UPDATER
+        DEBUG_UPDATER.printf_P(PSTR("[resume] can't resume at %zu\n"), offset);
+#endif
+        return false;
+    }
+    return _begin(size, U_FLASH, offset);
+}
+
+size_t UpdaterClass::staged() {
+    if (_size > 0) {
+        return 0; // Being written to
+    }
+    LittleFS.begin();
+    File f = LittleFS.open("firmware.bin", "r");
+    return f ? (f.size() & ~4095) : 0;
+}
+
+bool UpdaterClass::_begin(size_t size, int command, size_t offset) {
     uint32_t updateStartAddress;
     if (_size > 0) {
 #ifdef DEBUG_UPDATER
@@ -95,10 +126,12 @@ bool UpdaterClass::begin(size_t size, int command) {
     clearError(); //  _error = 0
     _target_md5 = "";
     _md5 = MD5Builder();
+    _target_sha256 = "";
+    memset(_sha256Out, 0, sizeof(_sha256Out));
 
     if (command == U_FLASH) {
         LittleFS.begin();
-        _fp = LittleFS.open("firmware.bin", "w+");
+        _fp = LittleFS.open("firmware.bin", offset ? "r+" : "w+");
         if (!_fp) {
 #ifdef DEBUG_UPDATER
             DEBUG_UPDATER.println(F("[begin] unable to create file"));
@@ -123,6 +156,8 @@ bool UpdaterClass::begin(size_t size, int command) {
 
     //initialize
     _startAddress = updateStartAddress;
+    _currentAddress = _startAddress;
+    _erasedAddress = _startAddress;
     _size = size;
     _bufferSize = 4096;
     _buffer = new uint8_t[_bufferSize];
@@ -135,6 +170,36 @@ bool UpdaterClass::begin(size_t size, int command) {
 
     if (!_verify) {
         _md5.begin();
+    } else if (command == U_FLASH) {
+        // The signature and its length word at the end are known sizes, so so is the image
+        const uint32_t sigLen = _verify->length();
+        const uint32_t trailer = sigLen ? sigLen + sizeof(uint32_t) : 0;
+        _hashBuf = (size > trailer) ? new uint8_t[_bufferSize] : nullptr;
+        if (_hashBuf) {
+            _hashing = true;
+            _hashLimit = size - trailer;
+            _hashed = 0;
+            _hash->begin();
+        }
+    }
+
+    if (offset) {
+        // Run what's already staged back through the hashes, as if it had just arrived
+        _fp.truncate(offset);
+        _fp.seek(0);
+        while (progress() < offset) {
+            _bufferLen = _fp.read(_buffer, _bufferSize);
+            if (_bufferLen != _bufferSize) {
+                _setError(UPDATE_ERROR_READ);
+                return false;
+            }
+            if (!_writeBuffer(false)) {
+                return false;
+            }
+        }
+#ifdef DEBUG_UPDATER
+        DEBUG_UPDATER.printf_P(PSTR("[begin] resuming at:       0x%08zX (%zd)\n"), offset, offset);
+#endif
     }
     return true;
 }
@@ -147,6 +212,23 @@ bool UpdaterClass::setMD5(const char * expected_md5) {
     return true;
 }
 
+bool UpdaterClass::setSHA256(const char * expected_sha256) {
+    if ((strlen(expected_sha256) != 64) || progress()) {
+        return false;
+    }
+    br_sha256_init(&_sha256);
+    _target_sha256 = expected_sha256;
+    return true;
+}
+
+String UpdaterClass::sha256String(void) {
+    char out[65];
+    for (size_t i = 0; i < sizeof(_sha256Out); i++) {
+        sprintf(out + (i * 2), "%02x", _sha256Out[i]);
+    }
+    return String(out);
+}
+
 bool UpdaterClass::end(bool evenIfRemaining) {
     if (_size == 0) {
 #ifdef DEBUG_UPDATER
@@ -200,17 +282,20 @@ bool UpdaterClass::end(bool evenIfRemaining) {
         if (expectedSigLen > 0) {
             binSize -= (sigLen + sizeof(uint32_t) /* The siglen word */);
         }
-        _hash->begin();
 #ifdef DEBUG_UPDATER
         DEBUG_UPDATER.printf_P(PSTR("[Updater] Adjusted binsize: %d\n"), binSize);
 #endif
-        // Calculate the MD5 and hash using proper size
-        uint8_t buff[128] __attribute__((aligned(4)));
-        _fp.seek(0);
-        for (int i = 0; i < binSize; i += sizeof(buff)) {
-            _fp.read(buff, sizeof(buff));
-            size_t read = std::min((int)sizeof(buff), binSize - i);
-            _hash->add(buff, read);
+        _hashWait();
+        if (!_hashing || (_hashed != (uint32_t)binSize)) {
+            // Cut short by end(true), so hash the staged file from the start
+            _hash->begin();
+            uint8_t buff[128] __attribute__((aligned(4)));
+            _fp.seek(0);
+            for (int i = 0; i < binSize; i += sizeof(buff)) {
+                _fp.read(buff, sizeof(buff));
+                size_t read = std::min((int)sizeof(buff), binSize - i);
+                _hash->add(buff, read);
+            }
         }
         _hash->end();
 #ifdef DEBUG_UPDATER
@@ -264,6 +349,16 @@ bool UpdaterClass::end(bool evenIfRemaining) {
         }
 #endif
     }
+    if (!_verify && _target_sha256.length()) {
+        br_sha256_out(&_sha256, _sha256Out);
+        if (strcasecmp(_target_sha256.c_str(), sha256String().c_str())) {
+            _setError(UPDATE_ERROR_SHA256);
+            return false;
+        }
+#ifdef DEBUG_UPDATER
+        DEBUG_UPDATER.printf_P(PSTR("SHA-256 Success: %s\n"), _target_sha256.c_str());
+#endif
+    }
 
     if (!_verifyEnd()) {
         _reset();
@@ -271,9 +366,43 @@ bool UpdaterClass::end(bool evenIfRemaining) {
     }
 
     if (_command == U_FLASH) {
+        // A compressed image records its inflated size in the last 4 bytes of the GZIP stream,
+        // ahead of any signature, which is what the bootloader will end up writing
+        uint32_t imageSize = _size;
+        if (_gzip) {
+            _fp.seek(_size - sizeof(uint32_t));
+            if (sizeof(uint32_t) != _fp.read((uint8_t *)&imageSize, sizeof(uint32_t))) {
+                _setError(UPDATE_ERROR_READ);
+                _reset();
+                return false;
+            }
+        }
+        if (imageSize > (uint32_t)&_FS_start - XIP_BASE) {
+#ifdef DEBUG_UPDATER
+            DEBUG_UPDATER.printf_P(PSTR("[Updater] image of %u bytes won't fit in flash\n"), imageSize);
+#endif
+            _setError(UPDATE_ERROR_SPACE);
+            _reset();
+            return false;
+        }
         _fp.close();
         picoOTA.begin();
-        picoOTA.addFile("firmware.bin");
+        if (_delta) {
+            if (!PicoOTA::deltaSupported()) {
+                _setError(UPDATE_ERROR_DELTA_UNSUPPORTED);
+                _reset();
+                return false;
+            } else if (!picoOTA.addDelta("firmware.bin")) {
+#ifdef DEBUG_UPDATER
+                DEBUG_UPDATER.println(F("[Updater] delta was not made against the running image"));
+#endif
+                _setError(UPDATE_ERROR_DELTA_BASE);
+                _reset();
+                return false;
+            }
+        } else {
+            picoOTA.addFile("firmware.bin", 0, XIP_BASE, imageSize);
+        }
         picoOTA.commit();
 #ifdef DEBUG_UPDATER
         DEBUG_UPDATER.printf_P(PSTR("Staged: address:0x%08X, size:0x%08zX\n"), _startAddress, _size);
@@ -284,27 +413,98 @@ bool UpdaterClass::end(bool evenIfRemaining) {
     return true;
 }
 
-bool UpdaterClass::_writeBuffer() {
-    if (_command == U_FLASH) {
+// store is false when resume() replays blocks already in the staged file
+bool UpdaterClass::_writeBuffer(bool store) {
+    if (!progress() && (_bufferLen >= 2)) {
+        _gzip = (_buffer[0] == 0x1f) && (_buffer[1] == 0x8b);
+        _delta = (_bufferLen >= 8) && !memcmp(_buffer, _OTA_DELTA_SIGN, 8);
+        if ((_gzip || _delta) && (_command == U_FS)) {
+            // Filesystems are written straight to flash, with no bootloader pass to inflate or patch them
+#ifdef DEBUG_UPDATER
+            DEBUG_UPDATER.println(F("[Updater] GZIP and delta filesystem images are not supported"));
+#endif
+            _setError(UPDATE_ERROR_MAGIC_BYTE);
+            return false;
+        }
+        if (_delta && !PicoOTA::deltaSupported()) {
+#ifdef DEBUG_UPDATER
+            DEBUG_UPDATER.println(F("[Updater] the OTA bootloader in flash can't apply delta updates"));
+#endif
+            _setError(UPDATE_ERROR_DELTA_UNSUPPORTED);
+            return false;
+        }
+    }
+    if (!store) {
+        // Replayed by resume(), already in the staged file
+    } else if (_command == U_FLASH) {
         if (_bufferLen != _fp.write(_buffer, _bufferLen)) {
             return false;
         }
+        if (!((progress() + _bufferLen) % UPDATER_CHECKPOINT)) {
+            _fp.flush();
+        }
     } else {
-        noInterrupts();
-        rp2040.idleOtherCore();
-        flash_range_erase((intptr_t)_currentAddress - (intptr_t)XIP_BASE, 4096);
-        flash_range_program((intptr_t)_currentAddress - (intptr_t)XIP_BASE, _buffer, 4096);
-        rp2040.resumeOtherCore();
-        interrupts();
+        PROFILE_CORE_SCOPE("Updater flash");
+        // A 64K block erase takes about as long as a single 4K sector erase, so whenever this
+        // update will overwrite an entire aligned block, erase all of it in one go
+        uint32_t eraseLen = 0;
+        if (_currentAddress >= _erasedAddress) {
+            uint32_t end = _startAddress + ((_size + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1));
+            bool aligned = !((_currentAddress - XIP_BASE) & (FLASH_BLOCK_SIZE - 1));
+            eraseLen = (aligned && (_currentAddress + FLASH_BLOCK_SIZE <= end)) ? FLASH_BLOCK_SIZE : FLASH_SECTOR_SIZE;
+        }
+        if (eraseLen) {
+            __flashErase((intptr_t)_currentAddress - (intptr_t)XIP_BASE, eraseLen, true);
+        }
+        __flashProgram((intptr_t)_currentAddress - (intptr_t)XIP_BASE, _buffer, 4096);
+        if (eraseLen) {
+            _erasedAddress = _currentAddress + eraseLen;
+        }
     }
-    if (!_verify) {
+    if (_hashing) {
+        _hashBuffer();
+    } else if (!_verify) {
         _md5.add(_buffer, _bufferLen);
+        if (_target_sha256.length()) {
+            br_sha256_update(&_sha256, _buffer, _bufferLen);
+        }
     }
     _currentAddress += _bufferLen;
     _bufferLen = 0;
     return true;
 }
 
+uint32_t UpdaterClass::_hashRun(void *arg) {
+    UpdaterClass *u = (UpdaterClass *)arg;
+    u->_hash->add(u->_hashBuf, u->_hashLen);
+    return 0;
+}
+
+// Swaps the just-written buffer out for hashing while the next one fills.  Flash writes
+// park the other core, so they wait for its hash to finish, but the hashing still overlaps
+// the download instead of all coming at end().
+void UpdaterClass::_hashBuffer() {
+    uint32_t offset = _currentAddress - _startAddress;
+    if (offset >= _hashLimit) {
+        return; // Signature and length word
+    }
+    _hashWait();
+    std::swap(_buffer, _hashBuf);
+    _hashLen = std::min((uint32_t)_bufferLen, _hashLimit - offset);
+    _hashed += _hashLen;
+    _hashPending = rp2040.runOnCore(get_core_num() ^ 1, &_hashJob, _hashRun, this);
+    if (!_hashPending) {
+        _hashRun(this);
+    }
+}
+
+void UpdaterClass::_hashWait() {
+    if (_hashPending) {
+        _hashJob.wait();
+        _hashPending = false;
+    }
+}
+
 size_t UpdaterClass::write(uint8_t *data, size_t len) {
     if (hasError() || !isRunning()) {
         return 0;
@@ -432,11 +632,20 @@ void UpdaterClass::printError(Print &out) {
         err += "Stream Read Timeout";
     } else if (_error == UPDATE_ERROR_NO_DATA) {
         err += "No data supplied";
+    } else if (_error == UPDATE_ERROR_DELTA_BASE) {
+        err += "Delta does not match running image";
+    } else if (_error == UPDATE_ERROR_DELTA_UNSUPPORTED) {
+        err += "Bootloader can't apply delta updates";
     } else if (_error == UPDATE_ERROR_MD5) {
         err += "MD5 Failed: expected:";
         err += _target_md5.c_str();
         err += " calculated:";
         err += _md5.toString();
+    } else if (_error == UPDATE_ERROR_SHA256) {
+        err += "SHA-256 Failed: expected:";
+        err += _target_sha256.c_str();
+        err += " calculated:";
+        err += sha256String();
     } else if (_error == UPDATE_ERROR_SIGN) {
         err += "Signature verification failed";
     } else {
@@ -39,6 +39,9 @@
 #define UPDATE_ERROR_BOOTSTRAP          (11)
 #define UPDATE_ERROR_SIGN               (12)
 #define UPDATE_ERROR_NO_DATA            (13)
+#define UPDATE_ERROR_DELTA_BASE         (14)
+#define UPDATE_ERROR_SHA256             (15)
+#define UPDATE_ERROR_DELTA_UNSUPPORTED  (16)
 
 #define U_FLASH   0
 #define U_FS      100
@@ -48,6 +51,12 @@
 #define DEBUG_UPDATER DEBUG_RP2040_PORT
 #endif
 
+// A staged U_FLASH image is committed to the filesystem this often, so a download cut off
+// by a reset or power loss can carry on from the last checkpoint with resume()
+#ifndef UPDATER_CHECKPOINT
+#define UPDATER_CHECKPOINT 32768
+#endif
+
 // Abstract class to implement whatever signing hash desired
 class UpdaterHashClass {
 public:
@@ -85,6 +94,19 @@ public:
     */
     bool begin(size_t size, int command = U_FLASH);
 
+    /*
+        Like begin(size) for U_FLASH, but keeps the first offset bytes staged by an
+        earlier, interrupted, update of the same image and carries on writing after
+        them.  offset must be a multiple of 4096 and no more than staged()
+    */
+    bool resume(size_t size, size_t offset);
+
+    /*
+        Returns how much of an interrupted U_FLASH update is still staged and can be
+        handed to resume(), in whole 4096 byte blocks
+    */
+    size_t staged();
+
     /*
         Run Updater from asynchronous callbacs
     */
@@ -143,6 +165,17 @@ public:
         return _md5.getBytes(result);
     }
 
+    /*
+        sets the expected SHA-256 for the firmware (hexString), hashed as the image is
+        written alongside any MD5.  Call after begin() and before the first write
+    */
+    bool setSHA256(const char * expected_sha256);
+
+    /*
+        returns the SHA-256 String of the successfully ended firmware
+    */
+    String sha256String(void);
+
     /*
         This callback will be called when Updater is receiving data
     */
@@ -221,13 +254,20 @@ public:
 
 private:
     void _reset();
-    bool _writeBuffer();
+    bool _begin(size_t size, int command, size_t offset);
+    bool _writeBuffer(bool store = true);
 
     bool _verifyHeader(uint8_t data);
     bool _verifyEnd();
 
     void _setError(int error);
 
+    // Signed images are hashed buffer by buffer as they are written, on the other core when
+    // it runs the multicore FIFO, so end() only has the signature itself left to check
+    void _hashBuffer();
+    void _hashWait();
+    static uint32_t _hashRun(void *arg);
+
     bool _async = false;
     uint8_t _error = 0;
     uint8_t *_buffer = nullptr;
@@ -236,15 +276,28 @@ private:
     size_t _size = 0;
     uint32_t _startAddress = 0;
     uint32_t _currentAddress = 0;
+    uint32_t _erasedAddress = 0; // U_FS flash is erased up to here
     uint32_t _command = U_FLASH;
+    bool _gzip = false; // Staged image is GZIP compressed, the OTA bootloader inflates it
+    bool _delta = false; // Staged file is a patch against the running image
     File _fp;
 
     String _target_md5;
     MD5Builder _md5;
+    String _target_sha256;
+    br_sha256_context _sha256;
+    uint8_t _sha256Out[32];
 
     // Optional signed binary verification
     UpdaterHashClass *_hash = nullptr;
     UpdaterVerifyClass *_verify = nullptr;
+    bool _hashing = false; // _hash is being fed during write()
+    uint8_t *_hashBuf = nullptr; // The other half of the double buffer, with the data being hashed
+    uint32_t _hashLen = 0;
+    uint32_t _hashLimit = 0; // Image bytes ahead of the signature
+    uint32_t _hashed = 0;
+    bool _hashPending = false;
+    CoreJob _hashJob;
     // Optional progress callback function
     THandlerFunction_Progress _progress_callback = nullptr;
 };
@@ -197,49 +197,47 @@ void handleFileList() {
     return;
   }
 
-  // use the same string for every line
+  // read the directory a batch at a time, and send each batch as one HTTP chunk
+  DirEntry entries[16];
+  char names[16 * 32];
   String output;
-  output.reserve(64);
-  while (dir.next()) {
+  output.reserve(sizeof(entries) / sizeof(entries[0]) * 64);
+  bool first = true;
+  size_t n;
+  while ((n = dir.readEntries(entries, sizeof(entries) / sizeof(entries[0]), names, sizeof(names))) > 0) {
+    for (size_t i = 0; i < n; i++) {
+      const char *name = entries[i].name;
 #ifdef USE_SPIFFS
-    String error = checkForUnsupportedPath(dir.fileName());
-    if (error.length() > 0) {
-      DBG_OUTPUT_PORT.println(String("Ignoring ") + error + dir.fileName());
-      continue;
-    }
+      String error = checkForUnsupportedPath(name);
+      if (error.length() > 0) {
+        DBG_OUTPUT_PORT.println(String("Ignoring ") + error + name);
+        continue;
+      }
 #endif
-    if (output.length()) {
-      // send string from previous iteration
-      // as an HTTP chunk
-      Serial.println(output);
-      server.sendContent(output);
-      output = ',';
-    } else {
-      output = '[';
-    }
+      output += first ? '[' : ',';
+      first = false;
 
-    output += "{\"type\":\"";
-    if (dir.isDirectory()) {
-      output += "dir";
-    } else {
-      output += F("file\",\"size\":\"");
-      output += dir.fileSize();
-    }
+      output += "{\"type\":\"";
+      if (entries[i].isDirectory) {
+        output += "dir";
+      } else {
+        output += F("file\",\"size\":\"");
+        output += entries[i].size;
+      }
 
-    output += F("\",\"name\":\"");
-    // Always return names without leading "/"
-    if (dir.fileName()[0] == '/') {
-      output += &(dir.fileName()[1]);
-    } else {
-      output += dir.fileName();
+      output += F("\",\"name\":\"");
+      // Always return names without leading "/"
+      output += (name[0] == '/') ? name + 1 : name;
+      output += "\"}";
+    }
+    if (output.length()) {
+      server.sendContent(output);
+      output = "";
     }
-
-    output += "\"}";
   }
 
-  // send last string
-  output += "]";
-  server.sendContent(output);
+  // close the list
+  server.sendContent(first ? "[]" : "]");
   server.chunkedResponseFinalize();
 }
 
@@ -532,8 +530,8 @@ void handleGetEdit() {
   }
 
 #ifdef INCLUDE_FALLBACK_INDEX_HTM
-  server.sendHeader(F("Content-Encoding"), "gzip");
-  server.send(200, "text/html", index_htm_gz, index_htm_gz_len);
+  // Sent straight from flash, with the ETag and headers made at build time
+  server.sendStatic(index_htm);
 #else
   replyNotFound(FPSTR(FILE_NOT_FOUND));
 #endif
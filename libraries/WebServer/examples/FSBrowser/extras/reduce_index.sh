@@ -3,7 +3,7 @@
 # Processing script to optionally reduce filesystem use by miniying, gzipping and preparing index.htm for embedding in code.
 # Please see readme.md for more information.
 
-# Requires xdd which is part of the VIM package
+# Requires python3, for tools/makewebcontent.py
 # Requires npm
 #   sudo apt install npm
 #   ln -s /usr/bin/nodejs /usr/bin/node
@@ -45,11 +45,7 @@ then
   exit -1
 fi
 
-echo '// WARNING: Auto-generated file. Please do not modify by hand.' > index_htm.h
-echo '// This file is an embeddable version of the gzipped index.htm file.' >> index_htm.h
-echo '// To update it, please rerun the `reduce_index.sh` script located in the `extras` subfolder' >> index_htm.h
-echo '// then recompile the sketch after each change to the `index.html` file.' >> index_htm.h
-xxd -i index.htm.gz >> index_htm.h
+python3 ../../../../../tools/makewebcontent.py -n index_htm -o index_htm.h index.htm.gz
 if [ $? -ne 0 ]
 then
   echo "Error creating include file from index.htm.gz"
@@ -0,0 +1,92 @@
+// Pushes live readings to every open browser over WebSockets instead of having each
+// page poll a REST endpoint.  Browse to http://picow.local/ and open several tabs.
+// Released to the public domain
+
+#include <WiFi.h>
+#include <WebServer.h>
+#include <LEAmDNS.h>
+
+#ifndef STASSID
+#define STASSID "your-ssid"
+#define STAPSK "your-password"
+#endif
+
+const char *ssid = STASSID;
+const char *password = STAPSK;
+
+WebServer server(80);
+WebSocketServer ws(server, "/ws");
+
+const char page[] = R"(<html>
+  <head><title>Pico-W Live</title></head>
+  <body>
+    <h1>Temperature: <span id="t">-</span> C</h1>
+    <p>Uptime: <span id="u">-</span> ms</p>
+    <button onclick="s.send('led')">Toggle LED</button>
+    <script>
+      var s = new WebSocket('ws://' + location.host + '/ws');
+      s.onmessage = function(e) {
+        var v = JSON.parse(e.data);
+        document.getElementById('t').innerText = v.temp.toFixed(1);
+        document.getElementById('u').innerText = v.uptime;
+      };
+    </script>
+  </body>
+</html>)";
+
+void onSocket(WebSocket &socket, WebSocketEvent event, const uint8_t *data, size_t len) {
+  switch (event) {
+    case WS_CONNECT:
+      Serial.printf("Socket %d connected, %d open\n", socket.id(), ws.connectedClients());
+      break;
+    case WS_DISCONNECT:
+      Serial.printf("Socket %d closed\n", socket.id());
+      break;
+    case WS_TEXT:
+      if ((len == 3) && !memcmp(data, "led", 3)) {
+        digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(LED_BUILTIN, OUTPUT);
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(ssid, password);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(500);
+    Serial.print(".");
+  }
+  Serial.print("\nIP address: ");
+  Serial.println(WiFi.localIP());
+
+  if (MDNS.begin("picow")) {
+    Serial.println("MDNS responder started");
+  }
+
+  server.on("/", []() {
+    server.send(200, "text/html", page);
+  });
+  ws.onEvent(onSocket);
+  server.setMaxClients(4);
+  server.begin();
+}
+
+void loop() {
+  static uint32_t last;
+  server.handleClient();
+  ws.loop();
+  MDNS.update();
+
+  // Ten updates a second, only as long as someone is watching
+  if (ws.connectedClients() && (millis() - last >= 100)) {
+    last = millis();
+    char msg[64];
+    snprintf(msg, sizeof(msg), "{\"temp\":%.1f,\"uptime\":%lu}", analogReadTemp(), millis());
+    ws.broadcastText(msg);
+  }
+}
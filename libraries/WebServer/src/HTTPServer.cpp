@@ -59,11 +59,25 @@ HTTPServer::HTTPServer()
     , _currentHeaders(nullptr)
     , _contentLength(0)
     , _clientContentLength(0)
-    , _chunked(false) {
+    , _acceptGzip(false)
+    , _upgradeWebSocket(false)
+    , _chunked(false)
+    , _keepAliveEnabled(false)
+    , _keepAlive(false)
+    , _responseKeepAlive(false)
+    , _arena(nullptr)
+    , _arenaSize(0)
+    , _arenaMaxArgs(0)
+    , _argsInArena(false)
+    , _headersInArena(false)
+    , _arenaHeaders(nullptr)
+    , _arenaArgKeys(nullptr)
+    , _arenaArgValues(nullptr) {
     log_v("HTTPServer::HTTPServer()");
 }
 
 HTTPServer::~HTTPServer() {
+    free(_arena);
     if (_currentHeaders) {
         delete[]_currentHeaders;
     }
@@ -242,12 +256,17 @@ void HTTPServer::_addRequestHandler(RequestHandler* handler) {
         _lastHandler->next(handler);
         _lastHandler = handler;
     }
+    _routes.add(handler);
 }
 
 void HTTPServer::serveStatic(const char* uri, FS& fs, const char* path, const char* cache_header) {
     _addRequestHandler(new StaticRequestHandler(fs, path, uri, cache_header));
 }
 
+void HTTPServer::serveStatic(const char* uri, const HTTPStaticContent& content, const char* cache_header) {
+    _addRequestHandler(new FlashRequestHandler(content, uri, cache_header));
+}
+
 void HTTPServer::httpHandleClient() {
     bool keepCurrentClient = false;
     bool callYield = false;
@@ -265,7 +284,14 @@ void HTTPServer::httpHandleClient() {
                     // it must be divided by 1000
                     _currentClient->setTimeout(HTTP_MAX_SEND_WAIT / 1000);
                     _contentLength = CONTENT_LENGTH_NOT_SET;
+                    _responseKeepAlive = false;
                     _handleRequest();
+                    if (_responseKeepAlive && _currentClient->connected()) {
+                        // Wait for the next request, which may already be buffered
+                        _currentStatus = HC_WAIT_READ;
+                        _statusChange = millis();
+                        keepCurrentClient = true;
+                    }
 
                     // Fix for issue with Chrome based browsers: https://github.com/espressif/arduino-esp32/issues/3652
                     //           if (_currentClient->connected()) {
@@ -325,6 +351,10 @@ void HTTPServer::setContentLength(const size_t contentLength) {
     _contentLength = contentLength;
 }
 
+void HTTPServer::enableKeepAlive(boolean value) {
+    _keepAliveEnabled = value;
+}
+
 void HTTPServer::enableDelay(boolean value) {
     _nullDelay = value;
 }
@@ -365,7 +395,13 @@ void HTTPServer::_prepareHeader(String& response, int code, const char* content_
         sendHeader(String(FPSTR("Access-Control-Allow-Methods")), String("*"));
         sendHeader(String(FPSTR("Access-Control-Allow-Headers")), String("*"));
     }
-    sendHeader(String(F("Connection")), String(F("close")));
+    // Without a length or chunking the client can only find the end of the body by the close
+    _responseKeepAlive = _keepAlive && (_currentMethod != HTTP_HEAD) && (_chunked || (_contentLength != CONTENT_LENGTH_UNKNOWN));
+    if (_responseKeepAlive) {
+        sendHeader(String(F("Connection")), String(F("keep-alive")));
+    } else {
+        sendHeader(String(F("Connection")), String(F("close")));
+    }
 
     response += _responseHeaders;
     response += "\r\n";
@@ -436,6 +472,25 @@ void HTTPServer::send_P(int code, PGM_P content_type, PGM_P content, size_t cont
     sendContent_P(content, contentLength);
 }
 
+void HTTPServer::sendStatic(const HTTPStaticContent& content, int code) {
+    if (content.etag) {
+        sendHeader(F("ETag"), content.etag);
+        if (_ifNoneMatchHeader.length() && ((_ifNoneMatchHeader == "*") || (_ifNoneMatchHeader.indexOf(content.etag) >= 0))) {
+            send(304);
+            return;
+        }
+    }
+    if (content.gzip) {
+        sendHeader(F("Content-Encoding"), F("gzip"));
+    }
+    String header;
+    _prepareHeader(header, code, content.contentType, content.length);
+    _currentClientWrite(header.c_str(), header.length());
+    if (_currentMethod != HTTP_HEAD) {
+        _currentClientWrite_P((PGM_P)content.data, content.length);
+    }
+}
+
 void HTTPServer::sendContent(const String& content) {
     sendContent(content.c_str(), content.length());
 }
@@ -507,6 +562,14 @@ String HTTPServer::arg(String name) {
             return _postArgs[j].value;
         }
     }
+    if (_argsInArena) {
+        for (int i = 0; i < _currentArgCount; ++i) {
+            if (name == _arenaArgKeys[i]) {
+                return _arenaArgValues[i];
+            }
+        }
+        return "";
+    }
     for (int i = 0; i < _currentArgCount; ++i) {
         if (_currentArgs[i].key == name) {
             return _currentArgs[i].value;
@@ -517,14 +580,14 @@ String HTTPServer::arg(String name) {
 
 String HTTPServer::arg(int i) {
     if (i < _currentArgCount) {
-        return _currentArgs[i].value;
+        return _argsInArena ? String(_arenaArgValues[i]) : _currentArgs[i].value;
     }
     return "";
 }
 
 String HTTPServer::argName(int i) {
     if (i < _currentArgCount) {
-        return _currentArgs[i].key;
+        return _argsInArena ? String(_arenaArgKeys[i]) : _currentArgs[i].key;
     }
     return "";
 }
@@ -540,7 +603,7 @@ bool HTTPServer::hasArg(String  name) {
         }
     }
     for (int i = 0; i < _currentArgCount; ++i) {
-        if (_currentArgs[i].key == name) {
+        if (_argsInArena ? (name == _arenaArgKeys[i]) : (_currentArgs[i].key == name)) {
             return true;
         }
     }
@@ -551,6 +614,9 @@ bool HTTPServer::hasArg(String  name) {
 String HTTPServer::header(String name) {
     for (int i = 0; i < _headerKeysCount; ++i) {
         if (_currentHeaders[i].key.equalsIgnoreCase(name)) {
+            if (_headersInArena) {
+                return _arenaHeaders[i] ? _arenaHeaders[i] : "";
+            }
             return _currentHeaders[i].value;
         }
     }
@@ -571,6 +637,9 @@ void HTTPServer::collectHeaders(const char* headerKeys[], const size_t headerKey
 
 String HTTPServer::header(int i) {
     if (i < _headerKeysCount) {
+        if (_headersInArena) {
+            return _arenaHeaders[i] ? _arenaHeaders[i] : "";
+        }
         return _currentHeaders[i].value;
     }
     return "";
@@ -589,8 +658,10 @@ int HTTPServer::headers() {
 
 bool HTTPServer::hasHeader(String name) {
     for (int i = 0; i < _headerKeysCount; ++i) {
-        if ((_currentHeaders[i].key.equalsIgnoreCase(name)) && (_currentHeaders[i].value.length() > 0)) {
-            return true;
+        if (_currentHeaders[i].key.equalsIgnoreCase(name)) {
+            if (_headersInArena ? (_arenaHeaders[i] && _arenaHeaders[i][0]) : (_currentHeaders[i].value.length() > 0)) {
+                return true;
+            }
         }
     }
     return false;
@@ -28,6 +28,8 @@
 #include "HTTP_Method.h"
 #include "Uri.h"
 
+extern "C" uint8_t __flash_binary_end;
+
 enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END,
                         UPLOAD_FILE_ABORTED
                       };
@@ -40,11 +42,24 @@ enum HTTPAuthMethod { BASIC_AUTH, DIGEST_AUTH };
 #define HTTP_UPLOAD_BUFLEN 1436
 #endif
 
+// Defaults for enableArenaParser()
+#ifndef HTTP_ARENA_SIZE
+#define HTTP_ARENA_SIZE 2048
+#endif
+#ifndef HTTP_ARENA_ARGS
+#define HTTP_ARENA_ARGS 16
+#endif
+
 #define HTTP_MAX_DATA_WAIT 5000 //ms to wait for the client to send the request
 #define HTTP_MAX_POST_WAIT 5000 //ms to wait for POST data to arrive
 #define HTTP_MAX_SEND_WAIT 5000 //ms to wait for data chunk to be ACKed
 #define HTTP_MAX_CLOSE_WAIT 2000 //ms to wait for the client to close the connection
 
+// Upper bound for WebServerTemplate::setMaxClients()
+#ifndef HTTP_MAX_CLIENTS
+#define HTTP_MAX_CLIENTS 6
+#endif
+
 #define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
 #define CONTENT_LENGTH_NOT_SET ((size_t) -2)
 
@@ -60,7 +75,18 @@ typedef struct {
     uint8_t buf[HTTP_UPLOAD_BUFLEN];
 } HTTPUpload;
 
+// A response body compiled into the program image, normally generated by
+// tools/makewebcontent.py.  It must be const, so it stays in flash and is sent without a copy.
+typedef struct {
+    const uint8_t *data;
+    size_t         length;
+    const char    *contentType;
+    const char    *etag;        // Quoted, or nullptr for none
+    bool           gzip;        // data is GZIP compressed, and is sent as Content-Encoding: gzip
+} HTTPStaticContent;
+
 #include "detail/RequestHandler.h"
+#include "detail/RouteTable.h"
 
 namespace fs {
 class FS;
@@ -83,6 +109,7 @@ public:
     void on(const Uri &uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn); //ufn handles file uploads
     void addHandler(RequestHandler* handler);
     void serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cache_header = NULL);
+    void serveStatic(const char* uri, const HTTPStaticContent& content, const char* cache_header = NULL);
     void onNotFound(THandlerFunction fn);  //called when handler is not assigned
     void onFileUpload(THandlerFunction ufn); //handle file uploads
 
@@ -126,6 +153,15 @@ public:
     }
 
     String hostHeader();            // get request host header if available or empty String if not
+    bool clientAcceptsGzip() {      // "Accept-Encoding" of the request includes gzip
+        return _acceptGzip;
+    }
+    String ifNoneMatchHeader() {    // "If-None-Match" of the request, or empty String
+        return _ifNoneMatchHeader;
+    }
+    String rangeHeader() {          // "Range" of the request, or empty String
+        return _rangeHeader;
+    }
 
     // send response to the client
     // code - HTTP response code, can be 200 or 404
@@ -144,6 +180,19 @@ public:
         send(code, content_type, (const char *)content, contentLength);
     }
 
+    // Answers with a 304 when the client's If-None-Match has the content's ETag, otherwise sends
+    // it straight from flash with all its headers
+    void sendStatic(const HTTPStaticContent& content, int code = 200);
+
+    // Parse requests with http_parser into one fixed buffer allocated here, so serving a
+    // request needs no heap allocations.  URI, arguments, collected headers and non-form
+    // bodies must fit in arenaSize bytes together.  Pass 0 to return to the String parser.
+    bool enableArenaParser(size_t arenaSize = HTTP_ARENA_SIZE, int maxArgs = HTTP_ARENA_ARGS);
+
+    // Keep HTTP/1.1 (and HTTP/1.0 "Connection: keep-alive") connections open between
+    // requests when the response length is known.  Pipelined requests are served in order.
+    void enableKeepAlive(boolean value = true);
+
     void enableDelay(boolean value);
     void enableCORS(boolean value = true);
     void enableCrossOrigin(boolean value = true);
@@ -180,26 +229,55 @@ public:
     template<typename T>
     size_t streamFile(T &file, const String& contentType, const int code = 200) {
         _streamFileCore(file.size(), file.name(), contentType, code);
-        return _currentClient->write(file);
+        return file.sendAll(*_currentClient, file.size(), HTTP_MAX_SEND_WAIT);
+    }
+
+    // Send length bytes from start as a 206 Partial Content response
+    template<typename T>
+    size_t streamFileRange(T &file, const String& contentType, size_t start, size_t length) {
+        sendHeader(F("Content-Range"), String(F("bytes ")) + String(start) + '-' + String(start + length - 1) + '/' + String(file.size()));
+        _streamFileCore(length, file.name(), contentType, 206);
+        if (!file.seek(start)) {
+            return 0;
+        }
+        return file.sendAll(*_currentClient, length, HTTP_MAX_SEND_WAIT);
     }
 
 protected:
+    friend class ResponseWriter;
+    friend class WebSocketServer;
+
+    // A new client object sharing the current connection, which keeps it open after the
+    // server is done with it.  WebServerTemplate makes it the right type for TLS.
+    virtual WiFiClient *_takeClient() {
+        return new WiFiClient(*_currentClient);
+    }
+
     virtual size_t _currentClientWrite(const char* b, size_t l) {
         return _currentClient->write(b, l);
     }
     virtual size_t _currentClientWrite_P(PGM_P b, size_t l) {
+        // Constants in the program image can't change under lwIP, so send them without a copy.
+        // PGM_P is a plain pointer here, so anything else (RAM, filesystem flash) is copied.
+        if (((intptr_t)b >= (intptr_t)XIP_BASE) && ((intptr_t)(b + l) <= (intptr_t)&__flash_binary_end)) {
+            return _currentClient->writeStatic(b, l);
+        }
         return _currentClient->write(b, l);
     }
     void _addRequestHandler(RequestHandler* handler);
     void _handleRequest();
     void _finalizeResponse();
     bool _parseRequest(WiFiClient* client);
+    bool _parseRequestArena(WiFiClient* client);
+    void _parseArgumentsArena(char *data);
     void _parseArguments(String data);
+    void _requestHeader(const char* name, const char* value);
+    void _resetRequestHeaders();
     static String _responseCodeToString(int code);
     bool _parseForm(WiFiClient* client, String boundary, uint32_t len);
     bool _parseFormUploadAborted();
-    void _uploadWriteByte(uint8_t b);
-    int _uploadReadByte(WiFiClient* client);
+    void _uploadWrite(const uint8_t* data, size_t len);
+    bool _uploadReadFile(WiFiClient* client, const String& boundary);
     void _prepareHeader(String& response, int code, const char* content_type, size_t contentLength);
     bool _collectHeader(const char* headerName, const char* headerValue);
 
@@ -227,6 +305,7 @@ protected:
     RequestHandler*  _currentHandler;
     RequestHandler*  _firstHandler;
     RequestHandler*  _lastHandler;
+    RouteTable       _routes;
     THandlerFunction _notFoundHandler;
     THandlerFunction _fileUploadHandler;
 
@@ -244,8 +323,27 @@ protected:
     String           _responseHeaders;
 
     String           _hostHeader;
+    bool             _acceptGzip;
+    String           _ifNoneMatchHeader;
+    String           _rangeHeader;
+    bool             _upgradeWebSocket;   // "Upgrade: websocket"
+    String           _webSocketKey;       // "Sec-WebSocket-Key"
     bool             _chunked;
 
+    bool             _keepAliveEnabled;
+    bool             _keepAlive;          // The request allows the connection to persist
+    bool             _responseKeepAlive;  // The response was sent so the connection can persist
+
+    // enableArenaParser() state, the pointer tables live at the start of the arena
+    char*            _arena;
+    size_t           _arenaSize;
+    int              _arenaMaxArgs;
+    bool             _argsInArena;
+    bool             _headersInArena;
+    const char**     _arenaHeaders;
+    const char**     _arenaArgKeys;
+    const char**     _arenaArgValues;
+
     String           _snonce;  // Store noance and opaque for future comparison
     String           _sopaque;
     String           _srealm;  // Store the Auth realm between Calls
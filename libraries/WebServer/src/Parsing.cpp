@@ -20,6 +20,7 @@
 */
 
 #include <Arduino.h>
+#include <memory>
 #include "WiFiServer.h"
 #include "WiFiClient.h"
 #include "HTTPServer.h"
@@ -79,6 +80,12 @@ static char* readBytesWithTimeout(WiFiClient* client, size_t maxLength, size_t&
 }
 
 bool HTTPServer::_parseRequest(WiFiClient* client) {
+    if (_arena) {
+        return _parseRequestArena(client);
+    }
+    _argsInArena = false;
+    _headersInArena = false;
+
     // Read the first line of HTTP request
     String req = client->readStringUntil('\r');
     client->readStringUntil('\n');
@@ -109,6 +116,8 @@ bool HTTPServer::_parseRequest(WiFiClient* client) {
     _currentUri = url;
     _chunked = false;
     _clientContentLength = 0;  // not known yet, or invalid
+    _keepAlive = _keepAliveEnabled && (_currentVersion > 0);
+    _resetRequestHeaders();
 
     HTTPMethod method = HTTP_ANY;
     size_t num_methods = sizeof(_http_method_str) / sizeof(const char *);
@@ -127,13 +136,7 @@ bool HTTPServer::_parseRequest(WiFiClient* client) {
     log_v("method: %s url: %s search: %s", methodStr.c_str(), url.c_str(), searchStr.c_str());
 
     //attach handler
-    RequestHandler* handler;
-    for (handler = _firstHandler; handler; handler = handler->next()) {
-        if (handler->canHandle(_currentMethod, _currentUri)) {
-            break;
-        }
-    }
-    _currentHandler = handler;
+    _currentHandler = _routes.find(_currentMethod, _currentUri);
 
     String formData;
     // below is needed only when POST type request
@@ -178,6 +181,8 @@ bool HTTPServer::_parseRequest(WiFiClient* client) {
                 _clientContentLength = headerValue.toInt();
             } else if (headerName.equalsIgnoreCase(F("Host"))) {
                 _hostHeader = headerValue;
+            } else {
+                _requestHeader(headerName.c_str(), headerValue.c_str());
             }
         }
 
@@ -240,6 +245,8 @@ bool HTTPServer::_parseRequest(WiFiClient* client) {
 
             if (headerName.equalsIgnoreCase("Host")) {
                 _hostHeader = headerValue;
+            } else {
+                _requestHeader(headerName.c_str(), headerValue.c_str());
             }
         }
         _parseArguments(searchStr);
@@ -252,6 +259,35 @@ bool HTTPServer::_parseRequest(WiFiClient* client) {
     return true;
 }
 
+// Headers the server itself acts on, which are kept whether or not they're collected
+void HTTPServer::_requestHeader(const char* name, const char* value) {
+    if (!strcasecmp(name, "Connection")) {
+        if (!strncasecmp(value, "close", 5)) {
+            _keepAlive = false;
+        } else if (!strncasecmp(value, "keep-alive", 10)) {
+            _keepAlive = _keepAliveEnabled;
+        }
+    } else if (!strcasecmp(name, "Accept-Encoding")) {
+        _acceptGzip = strstr(value, "gzip") != nullptr;
+    } else if (!strcasecmp(name, "If-None-Match")) {
+        _ifNoneMatchHeader = value;
+    } else if (!strcasecmp(name, "Range")) {
+        _rangeHeader = value;
+    } else if (!strcasecmp(name, "Upgrade")) {
+        _upgradeWebSocket = !strcasecmp(value, "websocket");
+    } else if (!strcasecmp(name, "Sec-WebSocket-Key")) {
+        _webSocketKey = value;
+    }
+}
+
+void HTTPServer::_resetRequestHeaders() {
+    _acceptGzip = false;
+    _ifNoneMatchHeader = "";
+    _rangeHeader = "";
+    _upgradeWebSocket = false;
+    _webSocketKey = "";
+}
+
 bool HTTPServer::_collectHeader(const char* headerName, const char* headerValue) {
     for (int i = 0; i < _headerKeysCount; i++) {
         if (_currentHeaders[i].key.equalsIgnoreCase(headerName)) {
@@ -315,58 +351,97 @@ void HTTPServer::_parseArguments(String data) {
 
 }
 
-void HTTPServer::_uploadWriteByte(uint8_t b) {
-    if (_currentUpload->currentSize == HTTP_UPLOAD_BUFLEN) {
-        if (_currentHandler && _currentHandler->canUpload(_currentUri)) {
-            _currentHandler->upload(*this, _currentUri, *_currentUpload);
+// Appends to the upload buffer, handing each full HTTP_UPLOAD_BUFLEN chunk to the handler
+void HTTPServer::_uploadWrite(const uint8_t* data, size_t len) {
+    while (len) {
+        if (_currentUpload->currentSize == HTTP_UPLOAD_BUFLEN) {
+            if (_currentHandler && _currentHandler->canUpload(_currentUri)) {
+                _currentHandler->upload(*this, _currentUri, *_currentUpload);
+            }
+            _currentUpload->totalSize += _currentUpload->currentSize;
+            _currentUpload->currentSize = 0;
         }
-        _currentUpload->totalSize += _currentUpload->currentSize;
-        _currentUpload->currentSize = 0;
+        size_t n = std::min(len, (size_t)(HTTP_UPLOAD_BUFLEN - _currentUpload->currentSize));
+        memcpy(_currentUpload->buf + _currentUpload->currentSize, data, n);
+        _currentUpload->currentSize += n;
+        data += n;
+        len -= n;
     }
-    _currentUpload->buf[_currentUpload->currentSize++] = b;
 }
 
-int HTTPServer::_uploadReadByte(WiFiClient* client) {
-    int res = client->read();
-    if (res < 0) {
-        // keep trying until you either read a valid byte or timeout
-        unsigned long startMillis = millis();
-        unsigned long timeoutIntervalMillis = client->getTimeout();
-        boolean timedOut = false;
-        for (;;) {
-            if (!client->connected()) {
-                return -1;
-            }
-            // loosely modeled after blinkWithoutDelay pattern
-            while (!timedOut && !client->available() && client->connected()) {
-                delay(2);
-                timedOut = millis() - startMillis >= timeoutIntervalMillis;
-            }
+// Boyer-Moore-Horspool search for pat in buf[from, len), returning its offset or -1
+static int _findDelimiter(const uint8_t* buf, size_t len, size_t from, const uint8_t* pat, size_t m, const uint8_t* skip) {
+    size_t i = from;
+    while (i + m <= len) {
+        uint8_t last = buf[i + m - 1];
+        if ((last == pat[m - 1]) && !memcmp(buf + i, pat, m - 1)) {
+            return i;
+        }
+        i += skip[last];
+    }
+    return -1;
+}
 
-            res = client->read();
-            if (res >= 0) {
-                return res; // exit on a valid read
+// Streams one file part to the upload handler, up to and including the "\r\n--boundary" after
+// it.  Data is peeked at in blocks, and only what precedes (and makes up) the delimiter is read,
+// so the rest of the form is left in the client for _parseForm.  The last m-1 bytes of each
+// block are held back as they may be the start of a delimiter split across two blocks.
+bool HTTPServer::_uploadReadFile(WiFiClient* client, const String& boundary) {
+    String delim = "\r\n--" + boundary;
+    const uint8_t* pat = (const uint8_t*)delim.c_str();
+    const size_t m = delim.length();
+    uint8_t skip[256];
+    memset(skip, std::min(m, (size_t)255), sizeof(skip));
+    for (size_t i = 0; i + 1 < m; i++) {
+        skip[pat[i]] = std::min(m - 1 - i, (size_t)255);
+    }
+
+    const size_t cap = HTTP_UPLOAD_BUFLEN + m;
+    std::unique_ptr<uint8_t[]> win(new (std::nothrow) uint8_t[cap]);
+    if (!win) {
+        return false;
+    }
+    size_t n = 0; // Bytes in win, already read and known not to contain the delimiter
+    while (true) {
+        if (n == cap) {
+            _uploadWrite(win.get(), n - (m - 1));
+            memmove(win.get(), win.get() + n - (m - 1), m - 1);
+            n = m - 1;
+        }
+        size_t avail = client->available();
+        if (!avail) {
+            unsigned long startMillis = millis();
+            while (!client->available()) {
+                if (!client->connected() || (millis() - startMillis >= client->getTimeout())) {
+                    return false;
+                }
+                delay(2);
             }
-            // NOTE: it is possible to get here and have all of the following
-            //       assertions hold true
-            //
-            //       -- client->available() > 0
-            //       -- client->connected == true
-            //       -- res == -1
-            //
-            //       a simple retry strategy overcomes this which is to say the
-            //       assertion is not permanent, but the reason that this works
-            //       is elusive, and possibly indicative of a more subtle underlying
-            //       issue
-
-            timedOut = millis() - startMillis >= timeoutIntervalMillis;
-            if (timedOut) {
-                return res; // exit on a timeout
+            continue;
+        }
+        size_t got = client->peekBytes(win.get() + n, std::min(avail, cap - n));
+        bool consumed = false;
+        if (!got) {
+            // No peek support underneath, so go a byte at a time
+            int c = client->read();
+            if (c < 0) {
+                continue;
             }
+            win[n] = (uint8_t)c;
+            got = 1;
+            consumed = true;
+        }
+        int p = _findDelimiter(win.get(), n + got, (n >= m - 1) ? n - (m - 1) : 0, pat, m, skip);
+        size_t take = (p >= 0) ? p + m - n : got;
+        if (!consumed && (client->read(win.get() + n, take) != (int)take)) {
+            return false;
         }
+        if (p >= 0) {
+            _uploadWrite(win.get(), p);
+            return true;
+        }
+        n += got;
     }
-
-    return res;
 }
 
 bool HTTPServer::_parseForm(WiFiClient* client, String boundary, uint32_t len) {
@@ -463,100 +538,24 @@ bool HTTPServer::_parseForm(WiFiClient* client, String boundary, uint32_t len) {
                             _currentHandler->upload(*this, _currentUri, *_currentUpload);
                         }
                         _currentUpload->status = UPLOAD_FILE_WRITE;
-                        int argByte = _uploadReadByte(client);
-readfile:
-
-                        while (argByte != 0x0D) {
-                            if (argByte < 0) {
-                                return _parseFormUploadAborted();
-                            }
-                            _uploadWriteByte(argByte);
-                            argByte = _uploadReadByte(client);
-                        }
-
-                        argByte = _uploadReadByte(client);
-                        if (argByte < 0) {
+                        if (!_uploadReadFile(client, boundary)) {
                             return _parseFormUploadAborted();
                         }
-                        if (argByte == 0x0A) {
-                            argByte = _uploadReadByte(client);
-                            if (argByte < 0) {
-                                return _parseFormUploadAborted();
-                            }
-                            if ((char)argByte != '-') {
-                                //continue reading the file
-                                _uploadWriteByte(0x0D);
-                                _uploadWriteByte(0x0A);
-                                goto readfile;
-                            } else {
-                                argByte = _uploadReadByte(client);
-                                if (argByte < 0) {
-                                    return _parseFormUploadAborted();
-                                }
-                                if ((char)argByte != '-') {
-                                    //continue reading the file
-                                    _uploadWriteByte(0x0D);
-                                    _uploadWriteByte(0x0A);
-                                    _uploadWriteByte((uint8_t)('-'));
-                                    goto readfile;
-                                }
-                            }
-
-                            uint8_t endBuf[boundary.length()];
-                            uint32_t i = 0;
-                            while (i < boundary.length()) {
-                                argByte = _uploadReadByte(client);
-                                if (argByte < 0) {
-                                    return _parseFormUploadAborted();
-                                }
-                                if ((char)argByte == 0x0D) {
-                                    _uploadWriteByte(0x0D);
-                                    _uploadWriteByte(0x0A);
-                                    _uploadWriteByte((uint8_t)('-'));
-                                    _uploadWriteByte((uint8_t)('-'));
-                                    uint32_t j = 0;
-                                    while (j < i) {
-                                        _uploadWriteByte(endBuf[j++]);
-                                    }
-                                    goto readfile;
-                                }
-                                endBuf[i++] = (uint8_t)argByte;
-                            }
-
-                            if (strstr((const char*)endBuf, boundary.c_str()) != NULL) {
-                                if (_currentHandler && _currentHandler->canUpload(_currentUri)) {
-                                    _currentHandler->upload(*this, _currentUri, *_currentUpload);
-                                }
-                                _currentUpload->totalSize += _currentUpload->currentSize;
-                                _currentUpload->status = UPLOAD_FILE_END;
-                                if (_currentHandler && _currentHandler->canUpload(_currentUri)) {
-                                    _currentHandler->upload(*this, _currentUri, *_currentUpload);
-                                }
-                                log_v("End File: %s Type: %s Size: %d", _currentUpload->filename.c_str(), _currentUpload->type.c_str(), _currentUpload->totalSize);
-                                line = client->readStringUntil(0x0D);
-                                client->readStringUntil(0x0A);
-                                if (line == "--") {
-                                    log_v("Done Parsing POST");
-                                    break;
-                                }
-                                continue;
-                            } else {
-                                _uploadWriteByte(0x0D);
-                                _uploadWriteByte(0x0A);
-                                _uploadWriteByte((uint8_t)('-'));
-                                _uploadWriteByte((uint8_t)('-'));
-                                uint32_t i = 0;
-                                while (i < boundary.length()) {
-                                    _uploadWriteByte(endBuf[i++]);
-                                }
-                                argByte = _uploadReadByte(client);
-                                goto readfile;
-                            }
-                        } else {
-                            _uploadWriteByte(0x0D);
-                            goto readfile;
+                        if (_currentHandler && _currentHandler->canUpload(_currentUri)) {
+                            _currentHandler->upload(*this, _currentUri, *_currentUpload);
+                        }
+                        _currentUpload->totalSize += _currentUpload->currentSize;
+                        _currentUpload->status = UPLOAD_FILE_END;
+                        if (_currentHandler && _currentHandler->canUpload(_currentUri)) {
+                            _currentHandler->upload(*this, _currentUri, *_currentUpload);
+                        }
+                        log_v("End File: %s Type: %s Size: %d", _currentUpload->filename.c_str(), _currentUpload->type.c_str(), _currentUpload->totalSize);
+                        line = client->readStringUntil(0x0D);
+                        client->readStringUntil(0x0A);
+                        if (line == "--") {
+                            log_v("Done Parsing POST");
+                            break;
                         }
-                        break;
                     }
                 }
             }
@@ -0,0 +1,373 @@
+/*
+    ParsingArena.cpp - Allocation-free HTTP request parsing with http_parser
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include "WiFiServer.h"
+#include "WiFiClient.h"
+#include "HTTPServer.h"
+#include "detail/mimetable.h"
+
+#ifndef log_e
+#define log_e(...)
+#define log_w(...)
+#define log_v(...)
+#endif
+
+// Bytes handed to http_parser at a time.  They're only peeked, and just what the parser
+// consumed is read, so the body is left in the socket for the form parser.
+#define HTTP_ARENA_PEEK 128
+
+static const char plain[] = "plain";
+
+bool HTTPServer::enableArenaParser(size_t arenaSize, int maxArgs) {
+    free(_arena);
+    _arena = nullptr;
+    _arenaSize = 0;
+    _argsInArena = false;
+    _headersInArena = false;
+    _currentArgCount = 0;
+    if (!arenaSize) {
+        return true;
+    }
+    _arena = (char *)malloc(arenaSize);
+    if (!_arena) {
+        return false;
+    }
+    _arenaSize = arenaSize;
+    _arenaMaxArgs = maxArgs;
+    return true;
+}
+
+static void urlDecodeInPlace(char *s) {
+    char *out = s;
+    while (*s) {
+        if ((s[0] == '%') && isxdigit(s[1]) && isxdigit(s[2])) {
+            char hex[3] = { s[1], s[2], 0 };
+            *out++ = (char)strtol(hex, nullptr, 16);
+            s += 3;
+        } else {
+            *out++ = (*s == '+') ? ' ' : *s;
+            s++;
+        }
+    }
+    *out = 0;
+}
+
+// Splits "a=1&b=2" in place into the arena's argument tables
+void HTTPServer::_parseArgumentsArena(char *data) {
+    while (data && *data) {
+        char *next = strchr(data, '&');
+        if (next) {
+            *next++ = 0;
+        }
+        char *eq = strchr(data, '=');
+        if (!eq) {
+            log_e("arg missing value: %d", _currentArgCount);
+        } else if (_currentArgCount >= _arenaMaxArgs) {
+            log_e("Too many args (max: %d) in request.", _arenaMaxArgs);
+            return;
+        } else {
+            *eq = 0;
+            urlDecodeInPlace(data);
+            urlDecodeInPlace(eq + 1);
+            _arenaArgKeys[_currentArgCount] = data;
+            _arenaArgValues[_currentArgCount] = eq + 1;
+            _currentArgCount++;
+        }
+        data = next;
+    }
+}
+
+bool HTTPServer::_parseRequestArena(WiFiClient* client) {
+    enum { NONE, URL, FIELD, VALUE };
+
+    struct State {
+        HTTPServer *server;
+        char *arena;
+        size_t size;
+        size_t used;
+        int last;           // Which callback was filling the arena
+        size_t field;       // Start of the current header name
+        size_t value;       // Start of the current header value
+        bool overflow;
+        bool isForm;
+        bool isEncoded;
+        const char *host;
+        const char *boundary;
+
+        bool append(const char *at, size_t len) {
+            if (used + len + 1 > size) { // Always leave room for terminate()
+                overflow = true;
+                return false;
+            }
+            memcpy(arena + used, at, len);
+            used += len;
+            return true;
+        }
+
+        void terminate() {
+            if (used >= size) {
+                overflow = true;
+                return;
+            }
+            arena[used++] = 0;
+        }
+
+        // Keep the header just received if it's wanted, otherwise drop it from the arena
+        void finishHeader() {
+            bool emptyValue = (last == FIELD);
+            terminate();
+            if (overflow) {
+                return;
+            }
+            char *name = arena + field;
+            char *val = emptyValue ? arena + used - 1 : arena + value;
+            size_t vlen = strlen(val);
+            while (vlen && isspace(val[vlen - 1])) {
+                val[--vlen] = 0;
+            }
+
+            int collected = -1;
+            for (int i = 0; i < server->_headerKeysCount; i++) {
+                if (!strcasecmp(server->_currentHeaders[i].key.c_str(), name)) {
+                    collected = i;
+                    break;
+                }
+            }
+            server->_requestHeader(name, val);
+            bool isHost = !strcasecmp(name, "Host");
+            bool isContentType = !strcasecmp(name, "Content-Type");
+
+            // Only the value needs to stay, slide it down over the name
+            memmove(name, val, vlen + 1);
+            val = name;
+            used = field + vlen + 1;
+            bool keep = (collected >= 0) || isHost;
+            if (collected >= 0) {
+                server->_arenaHeaders[collected] = val;
+            }
+            if (isHost) {
+                host = val;
+            }
+            if (isContentType) {
+                using namespace mime;
+                if (!strncmp_P(val, mimeTable[txt].mimeType, strlen_P(mimeTable[txt].mimeType))) {
+                    isForm = false;
+                } else if (!strncmp(val, "application/x-www-form-urlencoded", 33)) {
+                    isForm = false;
+                    isEncoded = true;
+                } else if (!strncmp(val, "multipart/", 10)) {
+                    char *b = strchr(val, '=');
+                    if (b) {
+                        b++;
+                        if (*b == '"') {
+                            char *q = strchr(++b, '"');
+                            if (q) {
+                                *q = 0;
+                            }
+                        }
+                        boundary = b;
+                        isForm = true;
+                        keep = true;
+                    }
+                }
+            }
+            if (!keep) {
+                used = field;
+            }
+        }
+    };
+
+    http_parser_settings settings;
+    http_parser_settings_init(&settings);
+    settings.on_url = [](http_parser * p, const char *at, size_t len) -> int {
+        State *s = (State *)p->data;
+        s->last = URL;
+        return s->append(at, len) ? 0 : 1;
+    };
+    settings.on_header_field = [](http_parser * p, const char *at, size_t len) -> int {
+        State *s = (State *)p->data;
+        if (s->last == URL) {
+            s->terminate();
+        } else if (s->last == VALUE) {
+            s->finishHeader();
+        }
+        if (s->last != FIELD) {
+            s->field = s->used;
+            s->last = FIELD;
+        }
+        return s->append(at, len) ? 0 : 1;
+    };
+    settings.on_header_value = [](http_parser * p, const char *at, size_t len) -> int {
+        State *s = (State *)p->data;
+        if (s->last == FIELD) {
+            s->terminate();
+            s->value = s->used;
+            s->last = VALUE;
+        }
+        return s->append(at, len) ? 0 : 1;
+    };
+    settings.on_headers_complete = [](http_parser * p) -> int {
+        State *s = (State *)p->data;
+        if (s->last == URL) {
+            s->terminate();
+        } else if ((s->last == FIELD) || (s->last == VALUE)) {
+            s->finishHeader();
+        }
+        s->last = NONE;
+        // The body is handled below, directly from the client
+        http_parser_pause(p, 1);
+        return 0;
+    };
+
+    // Pointer tables first, then the strings
+    size_t tables = sizeof(const char *) * (_headerKeysCount + 2 * _arenaMaxArgs);
+    if (tables >= _arenaSize) {
+        log_e("Arena too small");
+        return false;
+    }
+    _arenaHeaders = (const char **)_arena;
+    _arenaArgKeys = _arenaHeaders + _headerKeysCount;
+    _arenaArgValues = _arenaArgKeys + _arenaMaxArgs;
+    for (int i = 0; i < _headerKeysCount; i++) {
+        _arenaHeaders[i] = nullptr;
+    }
+    _headersInArena = true;
+    _argsInArena = true;
+    _currentArgCount = 0;
+    _resetRequestHeaders();
+
+    State st;
+    memset(&st, 0, sizeof(st));
+    st.server = this;
+    st.arena = _arena;
+    st.size = _arenaSize;
+    st.used = tables;
+    st.last = NONE;
+    const char *url = _arena + tables;
+
+    http_parser parser;
+    http_parser_init(&parser, HTTP_REQUEST);
+    parser.data = &st;
+
+    char buf[HTTP_ARENA_PEEK];
+    uint32_t start = millis();
+    while (true) {
+        size_t avail = client->available();
+        if (!avail) {
+            if (!client->connected() || (millis() - start > HTTP_MAX_DATA_WAIT)) {
+                return false;
+            }
+            delay(1);
+            continue;
+        }
+        size_t n = client->peekBytes((uint8_t *)buf, std::min(avail, sizeof(buf)));
+        size_t parsed = http_parser_execute(&parser, &settings, buf, n);
+        enum http_errno err = HTTP_PARSER_ERRNO(&parser);
+        if (st.overflow) {
+            log_e("Request does not fit in arena");
+            return false;
+        }
+        if (err == HPE_PAUSED) {
+            // Paused on the LF ending the headers, which is still part of them
+            if ((parsed < n) && (buf[parsed] == '\n')) {
+                parsed++;
+            }
+            client->read((uint8_t *)buf, parsed);
+            break;
+        } else if (err != HPE_OK) {
+            log_e("Invalid request: %s", http_errno_name(err));
+            return false;
+        }
+        client->read((uint8_t *)buf, parsed);
+    }
+
+    HTTPMethod method = (HTTPMethod)parser.method;
+    _currentMethod = method;
+    _currentVersion = parser.http_minor;
+    _chunked = false;
+    _keepAlive = _keepAliveEnabled && http_should_keep_alive(&parser);
+    _clientContentLength = (parser.content_length == (uint64_t) -1) ? 0 : (int)parser.content_length;
+
+    char *search = strchr((char *)url, '?');
+    if (search) {
+        *search++ = 0;
+    }
+    // Assigning into the existing Strings reuses their buffers
+    _currentUri = url;
+    _hostHeader = st.host ? st.host : "";
+
+    log_v("method: %s url: %s search: %s", http_method_str(parser.method), url, search ? search : "");
+
+    //attach handler
+    _currentHandler = _routes.find(_currentMethod, _currentUri);
+
+    if (method == HTTP_POST || method == HTTP_PUT || method == HTTP_PATCH || method == HTTP_DELETE) {
+        if (st.isForm) {
+            // Multipart forms and uploads are streamed by the regular String-based parser
+            _argsInArena = false;
+            _parseArguments(search ? search : "");
+            return _parseForm(client, st.boundary, _clientContentLength);
+        }
+        if (_clientContentLength > 0) {
+            if (st.used + _clientContentLength + 1 > st.size) {
+                log_e("Body does not fit in arena");
+                return false;
+            }
+            char *body = _arena + st.used;
+            size_t got = 0;
+            uint32_t wait = millis();
+            while ((got < (size_t)_clientContentLength) && (millis() - wait <= HTTP_MAX_POST_WAIT)) {
+                int r = client->read((uint8_t *)body + got, _clientContentLength - got);
+                if (r > 0) {
+                    got += r;
+                    wait = millis();
+                } else if (!client->connected()) {
+                    break;
+                } else {
+                    delay(1);
+                }
+            }
+            if (got < (size_t)_clientContentLength) {
+                return false;
+            }
+            body[got] = 0;
+            st.used += got + 1;
+            _parseArgumentsArena(search);
+            if (st.isEncoded) {
+                _parseArgumentsArena(body);
+            } else if (_currentArgCount < _arenaMaxArgs) {
+                //plain post json or other data
+                _arenaArgKeys[_currentArgCount] = plain;
+                _arenaArgValues[_currentArgCount] = body;
+                _currentArgCount++;
+            }
+            log_v("Plain: %s", body);
+        } else {
+            _parseArgumentsArena(search);
+        }
+    } else {
+        _parseArgumentsArena(search);
+    }
+    client->flush();
+
+    log_v("Request: %s", url);
+    return true;
+}
@@ -0,0 +1,197 @@
+/*
+    ResponseWriter.cpp - Buffered, chunked HTTP response body as a Print
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "ResponseWriter.h"
+#include <LWIPMutex.h>
+
+// "%04x\r\n" before the data, "\r\n" after, and room for a final "0\r\n\r\n"
+#define CHUNK_PREFIX 6
+#define CHUNK_SUFFIX 2
+#define CHUNK_LAST 5
+
+// Headers only share the first buffer if this much is left over for the body
+#define MIN_BODY 64
+
+ResponseWriter::ResponseWriter(HTTPServer &server, size_t bufferSize) : _server(server) {
+    _client = nullptr;
+    _bufferSize = std::max(bufferSize, (size_t)(2 * MIN_BODY));
+    if (_bufferSize > 0xffff) {
+        _bufferSize = 0xffff; // Chunk sizes are always written as 4 hex digits
+    }
+    _buf[0] = nullptr;
+    _buf[1] = nullptr;
+    _cur = nullptr;
+    _next = 0;
+    _start = 0;
+    _used = 0;
+    _chunked = false;
+    _started = false;
+    _failed = false;
+}
+
+ResponseWriter::~ResponseWriter() {
+    if (_started) {
+        end();
+    }
+    for (int i = 0; i < 2; i++) {
+        if (_buf[i]) {
+            // lwIP may still be sending from it, in which case the release callback frees it
+            LWIPMutex m;
+            if (_buf[i]->busy) {
+                _buf[i]->orphan = true;
+            } else {
+                free(_buf[i]);
+            }
+        }
+    }
+}
+
+void ResponseWriter::_release(void *arg) {
+    Buffer *b = (Buffer *)arg;
+    if (b->orphan) {
+        free(b);
+    } else {
+        b->busy = false;
+    }
+}
+
+bool ResponseWriter::_acquire() {
+    Buffer *b = _buf[_next];
+    if (!b) {
+        b = (Buffer *)malloc(sizeof(Buffer) + _bufferSize);
+        if (!b) {
+            _failed = true;
+            return false;
+        }
+        b->busy = false;
+        b->orphan = false;
+        _buf[_next] = b;
+    }
+    uint32_t start = millis();
+    while (b->busy) {
+        if (millis() - start > HTTP_MAX_SEND_WAIT) {
+            _failed = true;
+            return false;
+        }
+        delay(1);
+    }
+    _cur = b;
+    return true;
+}
+
+bool ResponseWriter::begin(int code, const char *contentType) {
+    if (_started || !_server._currentClient) {
+        return false;
+    }
+    _client = _server._currentClient;
+    _failed = false;
+    _server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    String header;
+    _server._prepareHeader(header, code, contentType, 0);
+    // The chunks are framed here, so the server mustn't terminate them itself
+    _chunked = _server._chunked;
+    _server._chunked = false;
+    _started = true;
+    if (!_acquire()) {
+        return false;
+    }
+    if (header.length() + MIN_BODY <= _bufferSize) {
+        memcpy(_cur->data, header.c_str(), header.length());
+        _start = header.length();
+    } else {
+        _server._currentClientWrite(header.c_str(), header.length());
+    }
+    return true;
+}
+
+bool ResponseWriter::_send(bool last) {
+    uint8_t *p = _cur->data;
+    size_t len = _start;
+    if (_chunked) {
+        if (_used) {
+            char hex[8];
+            sprintf(hex, "%04x\r\n", (unsigned)_used);
+            memcpy(p + len, hex, CHUNK_PREFIX);
+            len += CHUNK_PREFIX + _used;
+            memcpy(p + len, "\r\n", CHUNK_SUFFIX);
+            len += CHUNK_SUFFIX;
+        }
+        if (last) {
+            memcpy(p + len, "0\r\n\r\n", CHUNK_LAST);
+            len += CHUNK_LAST;
+        }
+    } else {
+        len += _used;
+    }
+    _start = 0;
+    _used = 0;
+    if (!len) {
+        return true;
+    }
+    _cur->busy = true;
+    if (_client->writeStatic(p, len, _release, _cur) != len) {
+        _failed = true;
+    }
+    _cur = nullptr;
+    _next ^= 1;
+    return !_failed;
+}
+
+size_t ResponseWriter::write(const uint8_t *data, size_t len) {
+    if (!_started || _failed) {
+        return 0;
+    }
+    size_t done = 0;
+    while (done < len) {
+        if (!_cur && !_acquire()) {
+            break;
+        }
+        size_t offset = _start + (_chunked ? CHUNK_PREFIX : 0);
+        size_t room = _bufferSize - offset - (_chunked ? CHUNK_SUFFIX + CHUNK_LAST : 0);
+        size_t n = std::min(len - done, room - _used);
+        memcpy(_cur->data + offset + _used, data + done, n);
+        _used += n;
+        done += n;
+        if ((_used == room) && !_send(false)) {
+            break;
+        }
+    }
+    return done;
+}
+
+void ResponseWriter::flush() {
+    if (_started && _cur && (_start || _used)) {
+        _send(false);
+    }
+}
+
+bool ResponseWriter::end() {
+    if (!_started) {
+        return false;
+    }
+    if (!_cur && _chunked && !_failed) {
+        _acquire();
+    }
+    if (_cur) {
+        _send(true);
+    }
+    _started = false;
+    return !_failed;
+}
@@ -0,0 +1,83 @@
+/*
+    ResponseWriter.h - Buffered, chunked HTTP response body as a Print
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "HTTPServer.h"
+
+// Size of each send buffer, so a full one goes out as a single TCP segment
+#ifndef HTTP_RESPONSE_BUFFER
+#define HTTP_RESPONSE_BUFFER TCP_MSS
+#endif
+
+// Collects many small prints into buffer-sized HTTP/1.1 chunks.  Two buffers are used in
+// turn and handed to lwIP without a copy, so one fills while the other is in flight.  The
+// response headers go out in the same segment as the first chunk.  HTTP/1.0 clients get
+// the same buffering without chunk framing, ended by closing the connection.
+//
+//    ResponseWriter out(server);
+//    out.begin(200, "application/json");
+//    out.printf("{\"uptime\":%lu}", millis());
+//    out.end();
+class ResponseWriter : public Print {
+public:
+    ResponseWriter(HTTPServer &server, size_t bufferSize = HTTP_RESPONSE_BUFFER);
+    virtual ~ResponseWriter();
+
+    // Prepare the status line and headers (plus anything from server.sendHeader())
+    bool begin(int code, const char *contentType);
+
+    virtual size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+    virtual size_t write(const uint8_t *data, size_t len) override;
+    using Print::write;
+
+    // Send what's buffered now as its own chunk
+    virtual void flush() override;
+
+    // Send the rest and the terminating chunk.  Called by the destructor if needed.
+    bool end();
+
+private:
+    // Shared with the lwIP release callback, which may run after the writer is gone
+    typedef struct {
+        volatile bool busy;
+        bool orphan;
+        uint8_t data[];
+    } Buffer;
+
+    static void _release(void *arg);
+    bool _acquire();
+    bool _send(bool last);
+
+    HTTPServer &_server;
+    WiFiClient *_client;
+    size_t _bufferSize;
+    Buffer *_buf[2];
+    Buffer *_cur;
+    int _next;
+    size_t _start;  // Response headers at the front of the current buffer
+    size_t _used;   // Body bytes in the current buffer
+    bool _chunked;
+    bool _started;
+    bool _failed;
+};
@@ -0,0 +1,141 @@
+/*
+    RouteTable.cpp - Request handler dispatch for the WebServer
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include "HTTPServer.h"
+
+RouteTable::RouteTable() {
+    _root = new Node;
+}
+
+RouteTable::~RouteTable() {
+    _free(_root);
+}
+
+void RouteTable::_free(Node *n) {
+    for (auto k : n->kids) {
+        _free(k);
+    }
+    delete n;
+}
+
+void RouteTable::add(RequestHandler *handler) {
+    uint16_t idx = _handlers.size();
+    _handlers.push_back(handler);
+
+    String key;
+    bool exact = false;
+    if (!handler->routeKey(key, exact)) {
+        _always.push_back(idx);
+        return;
+    }
+    const char *k = key.c_str();
+    size_t left = key.length();
+    Node *n = _root;
+    while (left) {
+        Node *kid = nullptr;
+        for (auto c : n->kids) {
+            if (c->label[0] == *k) {
+                kid = c;
+                break;
+            }
+        }
+        if (!kid) {
+            kid = new Node;
+            kid->label = k;
+            n->kids.push_back(kid);
+            n = kid;
+            break;
+        }
+        size_t common = 0;
+        size_t labelLen = kid->label.length();
+        while ((common < labelLen) && (common < left) && (kid->label[common] == k[common])) {
+            common++;
+        }
+        if (common < labelLen) {
+            // Split the edge, the existing node keeps its handlers under the longer label
+            Node *mid = new Node;
+            mid->label = kid->label.substring(0, common);
+            kid->label.remove(0, common);
+            mid->kids.push_back(kid);
+            for (auto &c : n->kids) {
+                if (c == kid) {
+                    c = mid;
+                }
+            }
+            kid = mid;
+        }
+        n = kid;
+        k += common;
+        left -= common;
+    }
+    (exact ? n->exact : n->prefix).push_back(idx);
+}
+
+RequestHandler *RouteTable::find(HTTPMethod method, const String &uri) {
+    // Collect the handlers whose keys this URI passes through, in the order added
+    std::vector<uint16_t> cand;
+    auto collect = [&cand](const std::vector<uint16_t> &v) {
+        for (auto i : v) {
+            auto it = cand.end();
+            while ((it != cand.begin()) && (*(it - 1) > i)) {
+                --it;
+            }
+            cand.insert(it, i);
+        }
+    };
+    const char *p = uri.c_str();
+    size_t left = uri.length();
+    Node *n = _root;
+    while (n) {
+        collect(n->prefix);
+        if (!left) {
+            collect(n->exact);
+            break;
+        }
+        Node *next = nullptr;
+        for (auto c : n->kids) {
+            size_t len = c->label.length();
+            if ((c->label[0] == *p) && (len <= left) && !memcmp(c->label.c_str(), p, len)) {
+                next = c;
+                p += len;
+                left -= len;
+                break;
+            }
+        }
+        n = next;
+    }
+
+    // Merge with the handlers that have to be asked every time
+    auto a = cand.begin();
+    auto b = _always.begin();
+    while ((a != cand.end()) || (b != _always.end())) {
+        uint16_t i;
+        if ((b == _always.end()) || ((a != cand.end()) && (*a < *b))) {
+            i = *a++;
+        } else {
+            i = *b++;
+        }
+        if (_handlers[i]->canHandle(method, uri)) {
+            return _handlers[i];
+        }
+    }
+    return nullptr;
+}
@@ -23,4 +23,13 @@ public:
     virtual bool canHandle(const String &requestUri, __attribute__((unused)) std::vector<String> &pathArgs) {
         return _uri == requestUri;
     }
+
+    // The literal text every URI canHandle() accepts starts with (or is, when exact) for
+    // the server's route table.  Subclasses with their own matching need to override this
+    // too, returning false when there's no such prefix.
+    virtual bool routeKey(String &prefix, bool &exact) const {
+        prefix = _uri;
+        exact = true;
+        return true;
+    }
 };
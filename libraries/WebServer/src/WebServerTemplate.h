@@ -21,6 +21,8 @@
 #pragma once
 
 #include "HTTPServer.h"
+#include "ResponseWriter.h"
+#include "WebSocket.h"
 
 template<typename ServerType, int DefaultPort = 80>
 class WebServerTemplate;
@@ -51,8 +53,30 @@ public:
         return *(ClientType*)_currentClient;
     }
 
+    // Number of connections serviced concurrently, up to HTTP_MAX_CLIENTS.  Each one waits
+    // for its next request without holding up the others.
+    void setMaxClients(int count) {
+        _maxClients = std::max(1, std::min(count, HTTP_MAX_CLIENTS));
+    }
+
+protected:
+    virtual WiFiClient *_takeClient() override {
+        return new ClientType(*(ClientType *)_currentClient);
+    }
+
 private:
+    void _closeClients();
+
+    struct ClientSlot {
+        ClientType *client;
+        HTTPClientStatus status;
+        unsigned long statusChange;
+    };
+
     ServerType _server;
+    ClientSlot _slots[HTTP_MAX_CLIENTS] = {};
+    int _maxClients = 1;
+    int _nextSlot = 0;
 };
 
 template <typename ServerType, int DefaultPort>
@@ -66,6 +90,7 @@ WebServerTemplate<ServerType, DefaultPort>::WebServerTemplate(int port) : HTTPSe
 template <typename ServerType, int DefaultPort>
 WebServerTemplate<ServerType, DefaultPort>::~WebServerTemplate() {
     _server.close();
+    _closeClients();
 }
 
 template <typename ServerType, int DefaultPort>
@@ -84,30 +109,63 @@ void WebServerTemplate<ServerType, DefaultPort>::begin(uint16_t port) {
 
 template <typename ServerType, int DefaultPort>
 void WebServerTemplate<ServerType, DefaultPort>::handleClient() {
-    if (_currentStatus == HC_NONE) {
-        if (_currentClient) {
-            delete _currentClient;
-            _currentClient = nullptr;
+    int active = 0;
+    for (auto &s : _slots) {
+        if (s.client) {
+            active++;
         }
+    }
 
+    // Accept new connections into any free slots
+    while (active < _maxClients) {
         ClientType client = _server.available();
         if (!client) {
-            if (_nullDelay) {
-                delay(1);
+            break;
+        }
+        for (auto &s : _slots) {
+            if (!s.client) {
+                s.client = new ClientType(client);
+                s.status = HC_WAIT_READ;
+                s.statusChange = millis();
+                break;
             }
-            return;
         }
+        active++;
+    }
+
+    if (!active) {
+        if (_nullDelay) {
+            delay(1);
+        }
+        return;
+    }
 
-        _currentClient = new ClientType(client);
-        _currentStatus = HC_WAIT_READ;
-        _statusChange = millis();
+    // Give every connection one turn, starting from a different one each call so a
+    // client with a stream of pipelined requests can't starve the rest
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+        ClientSlot &s = _slots[(_nextSlot + i) % HTTP_MAX_CLIENTS];
+        if (!s.client) {
+            continue;
+        }
+        _currentClient = s.client;
+        _currentStatus = s.status;
+        _statusChange = s.statusChange;
+        httpHandleClient();
+        if (_currentStatus == HC_NONE) {
+            delete s.client;
+            s.client = nullptr;
+        } else {
+            s.status = _currentStatus;
+            s.statusChange = _statusChange;
+        }
     }
-    httpHandleClient();
+    _nextSlot = (_nextSlot + 1) % HTTP_MAX_CLIENTS;
 }
 
 template <typename ServerType, int DefaultPort>
 void WebServerTemplate<ServerType, DefaultPort>::close() {
     _server.close();
+    _closeClients();
     httpClose();
 }
 
@@ -115,3 +173,12 @@ template <typename ServerType, int DefaultPort>
 void WebServerTemplate<ServerType, DefaultPort>::stop() {
     close();
 }
+
+template <typename ServerType, int DefaultPort>
+void WebServerTemplate<ServerType, DefaultPort>::_closeClients() {
+    for (auto &s : _slots) {
+        delete s.client;
+        s.client = nullptr;
+    }
+    _currentClient = nullptr;
+}
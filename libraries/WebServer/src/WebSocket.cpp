@@ -0,0 +1,397 @@
+/*
+    WebSocket.cpp - RFC 6455 WebSocket connections upgraded from a WebServer request
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "WebSocket.h"
+#include <libb64/cencode.h>
+#include <bearssl/bearssl_hash.h>
+
+#define WS_OP_CONT   0x0
+#define WS_OP_TEXT   0x1
+#define WS_OP_BINARY 0x2
+#define WS_OP_CLOSE  0x8
+#define WS_OP_PING   0x9
+#define WS_OP_PONG   0xa
+
+// Frames handled per socket per loop(), so one chatty client can't starve the rest
+#define WS_FRAMES_PER_POLL 8
+
+WebSocket::~WebSocket() {
+    _drop();
+}
+
+void WebSocket::_attach(WiFiClient *client) {
+    _client = client;
+    _msgLen = 0;
+    _msgOpcode = 0;
+    _closing = false;
+}
+
+void WebSocket::_drop() {
+    delete _client; // The last reference, so this closes the connection
+    _client = nullptr;
+    free(_msg);
+    _msg = nullptr;
+    _msgLen = 0;
+    _msgOpcode = 0;
+    _closing = false;
+}
+
+bool WebSocket::connected() {
+    return _client && !_closing && _client->connected();
+}
+
+bool WebSocket::_sendFrame(uint8_t opcode, const uint8_t *data, size_t len) {
+    if (!_client || (_closing && (opcode != WS_OP_CLOSE))) {
+        return false;
+    }
+    // Server frames are never masked.  Small ones go out as one write, so one segment.
+    uint8_t buf[128];
+    size_t hlen;
+    buf[0] = 0x80 | opcode;
+    if (len < 126) {
+        buf[1] = len;
+        hlen = 2;
+    } else if (len < 65536) {
+        buf[1] = 126;
+        buf[2] = len >> 8;
+        buf[3] = len & 0xff;
+        hlen = 4;
+    } else {
+        buf[1] = 127;
+        memset(buf + 2, 0, 4);
+        buf[6] = len >> 24;
+        buf[7] = (len >> 16) & 0xff;
+        buf[8] = (len >> 8) & 0xff;
+        buf[9] = len & 0xff;
+        hlen = 10;
+    }
+    if (hlen + len <= sizeof(buf)) {
+        memcpy(buf + hlen, data, len);
+        return _client->write(buf, hlen + len) == hlen + len;
+    }
+    if (_client->write(buf, hlen) != hlen) {
+        return false;
+    }
+    return _client->write(data, len) == len;
+}
+
+bool WebSocket::sendText(const char *msg, size_t len) {
+    return _sendFrame(WS_OP_TEXT, (const uint8_t *)msg, len);
+}
+
+bool WebSocket::sendBinary(const uint8_t *data, size_t len) {
+    return _sendFrame(WS_OP_BINARY, data, len);
+}
+
+bool WebSocket::ping(const uint8_t *data, size_t len) {
+    if (len > 125) {
+        return false;
+    }
+    return _sendFrame(WS_OP_PING, data, len);
+}
+
+void WebSocket::close(uint16_t code) {
+    if (!_client || _closing) {
+        return;
+    }
+    uint8_t c[2] = { (uint8_t)(code >> 8), (uint8_t)(code & 0xff) };
+    _sendFrame(WS_OP_CLOSE, c, sizeof(c));
+    _closing = true;
+    _closeStart = millis();
+}
+
+// The reassembly buffer is only allocated for sockets which need it
+bool WebSocket::_alloc() {
+    if (!_msg) {
+        _msg = (uint8_t *)malloc(WEBSOCKET_MAX_MESSAGE);
+    }
+    return _msg != nullptr;
+}
+
+bool WebSocket::_append(const uint8_t *data, size_t len) {
+    if ((_msgLen + len > WEBSOCKET_MAX_MESSAGE) || !_alloc()) {
+        return false;
+    }
+    if (data != _msg + _msgLen) {
+        memcpy(_msg + _msgLen, data, len);
+    }
+    _msgLen += len;
+    return true;
+}
+
+// Returns false once the socket has been dropped
+bool WebSocket::_poll(WebSocketServer *server) {
+    if (!_client) {
+        return false;
+    }
+    if ((!_client->connected() && !_client->available()) || (_closing && (millis() - _closeStart > HTTP_MAX_CLOSE_WAIT))) {
+        server->_event(*this, WS_DISCONNECT);
+        _drop();
+        return false;
+    }
+
+    for (int frames = 0; frames < WS_FRAMES_PER_POLL; frames++) {
+        size_t avail = _client->available();
+        if (avail < 2) {
+            break;
+        }
+
+        // The header is at most 14 bytes but may straddle two pbufs
+        uint8_t hdr[14] = {};
+        size_t got = 0;
+        WiFiClientSegment seg[4];
+        size_t segs = _client->peekSegments(seg, 4);
+        for (size_t i = 0; (i < segs) && (got < sizeof(hdr)); i++) {
+            size_t n = std::min(seg[i].len, sizeof(hdr) - got);
+            memcpy(hdr + got, seg[i].data, n);
+            got += n;
+        }
+
+        bool fin = hdr[0] & 0x80;
+        uint8_t opcode = hdr[0] & 0x0f;
+        size_t hlen = 2;
+        uint64_t len = hdr[1] & 0x7f;
+        if (len == 126) {
+            hlen = 4;
+            len = (hdr[2] << 8) | hdr[3];
+        } else if (len == 127) {
+            hlen = 10;
+            len = 0;
+            for (int i = 2; i < 10; i++) {
+                len = (len << 8) | hdr[i];
+            }
+        }
+        uint8_t mask[4];
+        memcpy(mask, hdr + hlen, 4);
+        hlen += 4;
+        if (got < hlen) {
+            break;
+        }
+
+        // Clients must mask, no extensions are negotiated, and control frames are short
+        // and never fragmented
+        int err = 0;
+        if (!(hdr[1] & 0x80) || (hdr[0] & 0x70) || ((opcode & 0x08) && (!fin || (len > 125)))) {
+            err = 1002;
+        } else if (len > WEBSOCKET_MAX_MESSAGE) {
+            err = 1009;
+        }
+        if (err) {
+            close(err);
+            server->_event(*this, WS_DISCONNECT);
+            _drop();
+            return false;
+        }
+        if (avail < hlen + len) {
+            break; // Wait for the rest of the frame
+        }
+
+        // Whole frame in the first pbuf: unmask it where lwIP put it, it's ours until
+        // consumed.  Otherwise copy it out, straight to where a fragment would be appended.
+        uint8_t *payload;
+        uint8_t ctrl[125];
+        bool inPlace = _client->peekAvailable() >= hlen + len;
+        if (inPlace) {
+            payload = (uint8_t *)_client->peekBuffer() + hlen;
+        } else if (opcode & 0x08) {
+            payload = ctrl;
+        } else {
+            if ((_msgLen + len > WEBSOCKET_MAX_MESSAGE) || !_alloc()) {
+                close(1009);
+                server->_event(*this, WS_DISCONNECT);
+                _drop();
+                return false;
+            }
+            payload = _msg + _msgLen;
+        }
+        if (!inPlace) {
+            _client->peekConsume(hlen);
+            _client->read(payload, len);
+        }
+        for (size_t i = 0; i < len; i++) {
+            payload[i] ^= mask[i & 3];
+        }
+
+        bool alive = true;
+        switch (opcode) {
+        case WS_OP_TEXT:
+        case WS_OP_BINARY:
+        case WS_OP_CONT:
+            if ((opcode == WS_OP_CONT) == !_msgOpcode) {
+                // A continuation with nothing to continue, or a new message inside one
+                err = 1002;
+            } else if (fin && !_msgOpcode) {
+                server->_event(*this, opcode == WS_OP_TEXT ? WS_TEXT : WS_BINARY, payload, len);
+            } else if (!_append(payload, len)) {
+                err = 1009;
+            } else {
+                if (opcode != WS_OP_CONT) {
+                    _msgOpcode = opcode;
+                }
+                if (fin) {
+                    server->_event(*this, _msgOpcode == WS_OP_TEXT ? WS_TEXT : WS_BINARY, _msg, _msgLen);
+                    _msgLen = 0;
+                    _msgOpcode = 0;
+                }
+            }
+            break;
+        case WS_OP_PING:
+            _sendFrame(WS_OP_PONG, payload, len);
+            break;
+        case WS_OP_PONG:
+            server->_event(*this, WS_PONG, payload, len);
+            break;
+        case WS_OP_CLOSE:
+            if (!_closing) {
+                // Echo the peer's status code back, completing the handshake
+                _sendFrame(WS_OP_CLOSE, payload, len >= 2 ? 2 : 0);
+            }
+            alive = false;
+            break;
+        default:
+            err = 1002;
+            break;
+        }
+
+        if (inPlace && _client) {
+            _client->peekConsume(hlen + len);
+        }
+        if (err) {
+            close(err);
+            alive = false;
+        }
+        if (!alive) {
+            server->_event(*this, WS_DISCONNECT);
+            _drop();
+            return false;
+        }
+    }
+    return true;
+}
+
+WebSocketServer::WebSocketServer(HTTPServer &server, const char *uri, int maxSockets) : _server(server) {
+    _maxSockets = std::max(1, maxSockets);
+    _socket = new WebSocket[_maxSockets];
+    for (int i = 0; i < _maxSockets; i++) {
+        _socket[i]._id = i;
+    }
+    _server.on(uri, HTTP_GET, [this]() {
+        _upgrade();
+    });
+}
+
+WebSocketServer::~WebSocketServer() {
+    closeAll();
+    delete[] _socket;
+}
+
+void WebSocketServer::_upgrade() {
+    if (!_server._upgradeWebSocket || !_server._webSocketKey.length()) {
+        _server.send(400, "text/plain", "WebSocket upgrade required\r\n");
+        return;
+    }
+    WebSocket *s = nullptr;
+    for (int i = 0; i < _maxSockets; i++) {
+        if (!_socket[i]._client) {
+            s = &_socket[i];
+            break;
+        }
+    }
+    if (!s) {
+        _server.send(503, "text/plain", "Too many WebSockets\r\n");
+        return;
+    }
+
+    // Sec-WebSocket-Accept is base64(SHA1(key + the RFC's fixed GUID))
+    static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    br_sha1_context ctx;
+    uint8_t hash[br_sha1_SIZE];
+    br_sha1_init(&ctx);
+    br_sha1_update(&ctx, _server._webSocketKey.c_str(), _server._webSocketKey.length());
+    br_sha1_update(&ctx, guid, sizeof(guid) - 1);
+    br_sha1_out(&ctx, hash);
+    char accept[32];
+    base64_encode_chars((const char *)hash, sizeof(hash), accept);
+
+    String resp;
+    resp.reserve(160);
+    resp = F("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: ");
+    resp += accept;
+    resp += F("\r\n\r\n");
+
+    // The WebServer drops its own reference once we return, leaving the socket ours
+    WiFiClient *client = _server._takeClient();
+    if (client->write((const uint8_t *)resp.c_str(), resp.length()) != resp.length()) {
+        delete client;
+        return;
+    }
+    client->setNoDelay(true);
+    s->_attach(client);
+    _event(*s, WS_CONNECT);
+}
+
+void WebSocketServer::loop() {
+    for (int i = 0; i < _maxSockets; i++) {
+        _socket[i]._poll(this);
+    }
+}
+
+int WebSocketServer::connectedClients() {
+    int cnt = 0;
+    for (int i = 0; i < _maxSockets; i++) {
+        if (_socket[i].connected()) {
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
+WebSocket *WebSocketServer::socket(int id) {
+    if ((id < 0) || (id >= _maxSockets) || !_socket[id]._client) {
+        return nullptr;
+    }
+    return &_socket[id];
+}
+
+int WebSocketServer::broadcastText(const char *msg, size_t len) {
+    int cnt = 0;
+    for (int i = 0; i < _maxSockets; i++) {
+        if (_socket[i].connected() && _socket[i].sendText(msg, len)) {
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
+int WebSocketServer::broadcastBinary(const uint8_t *data, size_t len) {
+    int cnt = 0;
+    for (int i = 0; i < _maxSockets; i++) {
+        if (_socket[i].connected() && _socket[i].sendBinary(data, len)) {
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
+void WebSocketServer::closeAll(uint16_t code) {
+    for (int i = 0; i < _maxSockets; i++) {
+        _socket[i].close(code);
+    }
+}
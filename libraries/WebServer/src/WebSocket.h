@@ -0,0 +1,147 @@
+/*
+    WebSocket.h - RFC 6455 WebSocket connections upgraded from a WebServer request
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include "HTTPServer.h"
+
+// Largest message accepted, whole or reassembled from fragments.  A frame is only parsed
+// once all of it has arrived, so this must stay below the lwIP receive window (TCP_WND).
+#ifndef WEBSOCKET_MAX_MESSAGE
+#define WEBSOCKET_MAX_MESSAGE 4096
+#endif
+
+// Default number of open sockets per WebSocketServer
+#ifndef WEBSOCKET_MAX_CLIENTS
+#define WEBSOCKET_MAX_CLIENTS 4
+#endif
+
+enum WebSocketEvent { WS_CONNECT, WS_DISCONNECT, WS_TEXT, WS_BINARY, WS_PONG };
+
+class WebSocketServer;
+
+// One open connection.  These belong to the WebSocketServer and are handed to its event
+// callback, they can't be created by the sketch.
+class WebSocket {
+public:
+    bool connected();
+    // Slot number, 0...maxSockets-1, stable while the socket is open
+    int id() {
+        return _id;
+    }
+    IPAddress remoteIP() {
+        return _client ? _client->remoteIP() : IPAddress();
+    }
+
+    bool sendText(const char *msg, size_t len);
+    bool sendText(const char *msg) {
+        return sendText(msg, strlen(msg));
+    }
+    bool sendText(const String &msg) {
+        return sendText(msg.c_str(), msg.length());
+    }
+    bool sendBinary(const uint8_t *data, size_t len);
+    bool ping(const uint8_t *data = nullptr, size_t len = 0);
+
+    // Starts the closing handshake, WS_DISCONNECT follows once it completes
+    void close(uint16_t code = 1000);
+
+private:
+    friend class WebSocketServer;
+
+    WebSocket() { }
+    ~WebSocket();
+
+    void _attach(WiFiClient *client);
+    void _drop();
+    bool _poll(WebSocketServer *server);
+    bool _sendFrame(uint8_t opcode, const uint8_t *data, size_t len);
+    bool _alloc();
+    bool _append(const uint8_t *data, size_t len);
+
+    int _id = 0;
+    WiFiClient *_client = nullptr;
+    uint8_t *_msg = nullptr;        // Fragments of a message, or a frame split across pbufs
+    size_t _msgLen = 0;
+    uint8_t _msgOpcode = 0;         // Opcode of the message being reassembled, 0 for none
+    bool _closing = false;
+    unsigned long _closeStart = 0;
+};
+
+// Accepts WebSocket upgrades of GET requests to one URI on an existing WebServer (or
+// WebServerSecure) and runs any number of sockets side by side.  Incoming frames are
+// parsed in place in the client's receive buffer, so a message which arrives in one
+// piece is handed to the callback without being copied.
+//
+//    WebServer server(80);
+//    WebSocketServer ws(server, "/ws");
+//    ws.onEvent([](WebSocket &s, WebSocketEvent e, const uint8_t *data, size_t len) {
+//        if (e == WS_TEXT) { s.sendText((const char *)data, len); }
+//    });
+//    void loop() { server.handleClient(); ws.loop(); ws.broadcastText(status); }
+class WebSocketServer {
+public:
+    // data is only valid during the call, and text is not NUL terminated.  WS_CONNECT and
+    // WS_DISCONNECT have no data, WS_DISCONNECT's socket may no longer be written to.
+    typedef std::function<void(WebSocket &socket, WebSocketEvent event, const uint8_t *data, size_t len)> THandlerFunction;
+
+    WebSocketServer(HTTPServer &server, const char *uri, int maxSockets = WEBSOCKET_MAX_CLIENTS);
+    ~WebSocketServer();
+
+    void onEvent(THandlerFunction fn) {
+        _onEvent = fn;
+    }
+
+    // Reads and dispatches what each socket has received.  Call every loop(), alongside
+    // the WebServer's handleClient()
+    void loop();
+
+    int connectedClients();
+    WebSocket *socket(int id);
+
+    // Sends to every open socket, returns how many it was sent to
+    int broadcastText(const char *msg, size_t len);
+    int broadcastText(const char *msg) {
+        return broadcastText(msg, strlen(msg));
+    }
+    int broadcastText(const String &msg) {
+        return broadcastText(msg.c_str(), msg.length());
+    }
+    int broadcastBinary(const uint8_t *data, size_t len);
+
+    void closeAll(uint16_t code = 1001);
+
+private:
+    friend class WebSocket;
+
+    void _upgrade();
+    void _event(WebSocket &s, WebSocketEvent e, const uint8_t *data = nullptr, size_t len = 0) {
+        if (_onEvent) {
+            _onEvent(s, e, data, len);
+        }
+    }
+
+    HTTPServer &_server;
+    WebSocket *_socket;
+    int _maxSockets;
+    THandlerFunction _onEvent;
+};
@@ -26,6 +26,14 @@ public:
         (void) requestUri;
         (void) upload;
     }
+    // Lets the server skip asking this handler about requests it can't take: every URI
+    // canHandle() accepts starts with prefix, and is exactly prefix when exact is set.
+    // Handlers returning false are asked about every request.
+    virtual bool routeKey(String &prefix, bool &exact) {
+        (void) prefix;
+        (void) exact;
+        return false;
+    }
 
     RequestHandler* next() {
         return _next;
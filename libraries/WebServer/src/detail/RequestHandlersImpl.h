@@ -61,6 +61,10 @@ public:
         }
     }
 
+    bool routeKey(String &prefix, bool &exact) override {
+        return _uri->routeKey(prefix, exact);
+    }
+
 protected:
     HTTPServer::THandlerFunction _fn;
     HTTPServer::THandlerFunction _ufn;
@@ -79,6 +83,9 @@ public:
         _isFile = (f && (! f.isDirectory()));
         log_v("StaticRequestHandler: path=%s uri=%s isFile=%d, cache_header=%s\r\n", path, uri, _isFile, cache_header ? cache_header : ""); // issue 5506 - cache_header can be nullptr
         _baseUriLength = _uri.length();
+        if (_isFile) {
+            _contentType = getContentType(_path);
+        }
     }
 
     bool canHandle(HTTPMethod requestMethod, String requestUri) override  {
@@ -93,6 +100,12 @@ public:
         return true;
     }
 
+    bool routeKey(String &prefix, bool &exact) override {
+        prefix = _uri;
+        exact = _isFile;
+        return true;
+    }
+
     bool handle(HTTPServer& server, HTTPMethod requestMethod, String requestUri) override {
         if (!canHandle(requestMethod, requestUri)) {
             return false;
@@ -114,14 +127,19 @@ public:
         }
         log_v("StaticRequestHandler::handle: path=%s, isFile=%d\r\n", path.c_str(), _isFile);
 
-        String contentType = getContentType(path);
+        String contentType = _isFile ? _contentType : getContentType(path);
 
-        // look for gz file, only if the original specified path is not a gz.  So part only works to send gzip via content encoding when a non compressed is asked for
-        // if you point the the path to gzip you will serve the gzip as content type "application/x-gzip", not text or javascript etc...
-        if (!path.endsWith(FPSTR(mimeTable[gz].endsWith)) && !_fs.exists(path))  {
+        // Serve the precompressed sibling when the client takes gzip, or when it's the only copy.
+        // If you point the the path to gzip you will serve the gzip as content type "application/x-gzip", not text or javascript etc...
+        bool vary = false;
+        if (!path.endsWith(FPSTR(mimeTable[gz].endsWith))) {
             String pathWithGz = path + FPSTR(mimeTable[gz].endsWith);
             if (_fs.exists(pathWithGz)) {
-                path += FPSTR(mimeTable[gz].endsWith);
+                bool plain = _fs.exists(path);
+                if (server.clientAcceptsGzip() || !plain) {
+                    path = pathWithGz;
+                }
+                vary = plain;
             }
         }
 
@@ -133,24 +151,103 @@ public:
         if (_cache_header.length() != 0) {
             server.sendHeader("Cache-Control", _cache_header);
         }
+        if (vary) {
+            server.sendHeader("Vary", "Accept-Encoding");
+        }
+        String etag = getETag(f);
+        server.sendHeader("ETag", etag);
+
+        String inm = server.ifNoneMatchHeader();
+        if (inm.length() && ((inm == "*") || (inm.indexOf(etag) >= 0))) {
+            server.send(304);
+            return true;
+        }
+
+        server.sendHeader("Accept-Ranges", "bytes");
+        String range = server.rangeHeader();
+        if (range.length()) {
+            size_t start, length;
+            int r = parseRange(range, f.size(), start, length);
+            if (r > 0) {
+                server.streamFileRange(f, contentType, start, length);
+                return true;
+            } else if (r < 0) {
+                server.sendHeader("Content-Range", String("bytes */") + String(f.size()));
+                server.send(416);
+                return true;
+            }
+        }
 
         server.streamFile(f, contentType);
         return true;
     }
 
-    static String getContentType(const String& path) {
-        char buff[sizeof(mimeTable[0].mimeType)];
-        // Check all entries but last one for match, return if found
-        for (size_t i = 0; i < sizeof(mimeTable) / sizeof(mimeTable[0]) - 1; i++) {
-            strcpy_P(buff, mimeTable[i].endsWith);
-            if (path.endsWith(buff)) {
-                strcpy_P(buff, mimeTable[i].mimeType);
-                return String(buff);
+    // Built from the size and modification time LittleFS stores with each file, so nothing
+    // has to be read.  Filesystems without timestamps fall back to hashing the contents.
+    static String getETag(File &f) {
+        uint32_t size = f.size();
+        uint32_t stamp = (uint32_t)f.getLastWrite();
+        if (!stamp) {
+            uint8_t buf[64];
+            int n;
+            stamp = 2166136261UL; // FNV-1a
+            while ((n = f.read(buf, sizeof(buf))) > 0) {
+                for (int i = 0; i < n; i++) {
+                    stamp = (stamp ^ buf[i]) * 16777619UL;
+                }
             }
+            f.seek(0);
         }
-        // Fall-through and just return default type
-        strcpy_P(buff, mimeTable[sizeof(mimeTable) / sizeof(mimeTable[0]) - 1].mimeType);
-        return String(buff);
+        char etag[20];
+        sprintf(etag, "\"%08lx%08lx\"", size, stamp);
+        return String(etag);
+    }
+
+    // Single "bytes=" ranges only.  Returns 1 with the span to send, 0 to ignore the header
+    // and send everything, or -1 when the range lies outside the file.
+    static int parseRange(const String &range, size_t size, size_t &start, size_t &length) {
+        if (!range.startsWith("bytes=") || (range.indexOf(',') >= 0)) {
+            return 0;
+        }
+        const char *s = range.c_str() + 6;
+        char *end;
+        if (*s == '-') {
+            size_t suffix = strtoul(s + 1, &end, 10);
+            if ((end == s + 1) || *end) {
+                return 0;
+            }
+            if (!suffix || !size) {
+                return -1;
+            }
+            length = std::min(suffix, size);
+            start = size - length;
+            return 1;
+        }
+        size_t first = strtoul(s, &end, 10);
+        if ((end == s) || (*end != '-')) {
+            return 0;
+        }
+        s = end + 1;
+        size_t last = size - 1;
+        if (*s) {
+            last = strtoul(s, &end, 10);
+            if ((end == s) || *end) {
+                return 0;
+            }
+        }
+        if (first >= size) {
+            return -1;
+        }
+        if (last < first) {
+            return 0;
+        }
+        start = first;
+        length = std::min(last, size - 1) - first + 1;
+        return 1;
+    }
+
+    static String getContentType(const String& path) {
+        return mime::getContentType(path);
     }
 
 protected:
@@ -158,6 +255,43 @@ protected:
     String _uri;
     String _path;
     String _cache_header;
+    String _contentType; // Only for a single file, directories look it up per request
     bool _isFile;
     size_t _baseUriLength;
 };
+
+// Serves one HTTPStaticContent at an exact URI
+class FlashRequestHandler : public RequestHandler {
+public:
+    FlashRequestHandler(const HTTPStaticContent& content, const char* uri, const char* cache_header)
+        : _content(content)
+        , _uri(uri)
+        , _cache_header(cache_header) {
+    }
+
+    bool canHandle(HTTPMethod requestMethod, String requestUri) override  {
+        return ((requestMethod == HTTP_GET) || (requestMethod == HTTP_HEAD)) && (requestUri == _uri);
+    }
+
+    bool routeKey(String &prefix, bool &exact) override {
+        prefix = _uri;
+        exact = true;
+        return true;
+    }
+
+    bool handle(HTTPServer& server, HTTPMethod requestMethod, String requestUri) override {
+        if (!canHandle(requestMethod, requestUri)) {
+            return false;
+        }
+        if (_cache_header.length() != 0) {
+            server.sendHeader("Cache-Control", _cache_header);
+        }
+        server.sendStatic(_content);
+        return true;
+    }
+
+protected:
+    HTTPStaticContent _content;
+    String _uri;
+    String _cache_header;
+};
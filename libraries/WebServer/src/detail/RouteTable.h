@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <api/String.h>
+
+class RequestHandler;
+
+// Finds the first registered handler which can take a request without asking every
+// handler in turn.  Handlers which report a literal prefix (or exact URI) through
+// RequestHandler::routeKey() are kept in a radix trie, so a lookup only walks the
+// request URI once and then calls canHandle() on the few handlers whose prefixes it
+// passed.  Everything else is tried on every request, as before.  Handlers are
+// still tried in the order they were added, so the result is the same as walking
+// the whole list.
+class RouteTable {
+public:
+    RouteTable();
+    ~RouteTable();
+
+    void add(RequestHandler *handler);
+    RequestHandler *find(HTTPMethod method, const String &uri);
+
+private:
+    struct Node {
+        String label;                 // Text from the parent to this node
+        std::vector<Node *> kids;     // At most one per distinct first character
+        std::vector<uint16_t> prefix; // Handlers matching URIs starting with the path here
+        std::vector<uint16_t> exact;  // Handlers matching only the path here
+    };
+    static void _free(Node *n);
+
+    Node *_root;
+    std::vector<RequestHandler *> _handlers; // Indexed by order added
+    std::vector<uint16_t> _always;           // Handlers with no route key
+};
@@ -32,13 +32,43 @@ const Entry mimeTable[maxType] = {
 };
 
 
-arduino::String getContentType(const arduino::String& path) {
-    for (size_t i = 0; i < maxType; i++) {
-        if (path.endsWith(FPSTR(mimeTable[i].endsWith))) {
-            return arduino::String(FPSTR(mimeTable[i].mimeType));
+// mimeTable entries in strcmp() order of their extensions, keep in sync when adding types
+static const uint8_t byExtension[maxType - 1] = {
+    appcache, css, eot, gif, gz, htm, html, ico, jpg, js, json, otf,
+    pdf, png, sfnt, svg, ttf, txt, woff, woff2, xml, zip
+};
+
+type getType(const char *path, size_t len) {
+    // Every extension in the table is a '.' and no more than 15 characters
+    const char *ext = nullptr;
+    for (size_t i = len; i > 0 && len - i < sizeof(mimeTable[0].endsWith); i--) {
+        if (path[i - 1] == '.') {
+            ext = path + i - 1;
+            break;
+        }
+        if (path[i - 1] == '/') {
+            break;
+        }
+    }
+    if (!ext) {
+        return none;
+    }
+    int lo = 0, hi = maxType - 2;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int c = strcmp(ext, mimeTable[byExtension[mid]].endsWith);
+        if (!c) {
+            return (type)byExtension[mid];
+        } else if (c < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
         }
     }
-    // Fall-through and just return default type
-    return arduino::String(FPSTR(mimeTable[none].mimeType));
+    return none;
+}
+
+arduino::String getContentType(const arduino::String& path) {
+    return arduino::String(FPSTR(mimeTable[getType(path.c_str(), path.length())].mimeType));
 }
 }
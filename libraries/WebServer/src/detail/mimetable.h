@@ -38,6 +38,8 @@ struct Entry {
 
 extern const Entry mimeTable[maxType];
 
+// Looks up the extension after the final '.' with a binary search, none if unknown
+type getType(const char *path, size_t len);
 arduino::String getContentType(const arduino::String& path);
 
 }
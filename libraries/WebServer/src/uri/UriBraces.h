@@ -24,6 +24,14 @@ public:
         pathArgs.resize(numParams);
     }
 
+    bool routeKey(String &prefix, bool &exact) const override final {
+        int brace = _uri.indexOf("{}");
+        prefix = (brace < 0) ? _uri : _uri.substring(0, brace);
+        // The template text itself is accepted too, which the prefix still covers
+        exact = brace < 0;
+        return true;
+    }
+
     bool canHandle(const String &requestUri, std::vector<String> &pathArgs) override final {
         if (Uri::canHandle(requestUri, pathArgs)) {
             return true;
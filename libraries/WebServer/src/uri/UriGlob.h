@@ -13,6 +13,17 @@ public:
         return new UriGlob(_uri);
     };
 
+    bool routeKey(String &prefix, bool &exact) const override final {
+        // Everything up to the first wildcard or escape only matches itself
+        int i = 0;
+        while (_uri[i] && !strchr("*?[\\", _uri[i])) {
+            i++;
+        }
+        prefix = _uri.substring(0, i);
+        exact = !_uri[i];
+        return true;
+    }
+
     bool canHandle(const String &requestUri, __attribute__((unused)) std::vector<String> &pathArgs) override final {
         return fnmatch(_uri.c_str(), requestUri.c_str(), 0) == 0;
     }
@@ -6,8 +6,9 @@
 class UriRegex : public Uri {
 
 public:
-    explicit UriRegex(const char *uri) : Uri(uri) {};
-    explicit UriRegex(const String &uri) : Uri(uri) {};
+    // Compiled once here instead of for every request
+    explicit UriRegex(const char *uri) : Uri(uri), _rgx(uri) {};
+    explicit UriRegex(const String &uri) : Uri(uri), _rgx(uri.c_str()) {};
 
     Uri* clone() const override final {
         return new UriRegex(_uri);
@@ -27,10 +28,9 @@ public:
         }
 
         unsigned int pathArgIndex = 0;
-        std::regex rgx(_uri.c_str());
         std::smatch matches;
         std::string s(requestUri.c_str());
-        if (std::regex_search(s, matches, rgx)) {
+        if (std::regex_search(s, matches, _rgx)) {
             for (size_t i = 1; i < matches.size(); ++i) {  // skip first
                 pathArgs[pathArgIndex] = String(matches[i].str().c_str());
                 pathArgIndex++;
@@ -39,4 +39,13 @@ public:
         }
         return false;
     }
+
+    bool routeKey(String &prefix, bool &exact) const override final {
+        (void) prefix;
+        (void) exact;
+        return false; // Regexes are searched for anywhere in the URI
+    }
+
+private:
+    std::regex _rgx;
 };
@@ -28,6 +28,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <Arduino.h>
+#include <CoreMutex.h>
+#include <new>
 #include "StackThunk.h"
 
 #include <Updater_Signing.h>
@@ -35,6 +37,12 @@
 #define ARDUINO_SIGNING 0
 #endif
 
+#ifndef BEARSSL_KEY_CACHE_SIZE
+#define BEARSSL_KEY_CACHE_SIZE 4
+#endif
+
+extern "C" uint8_t __flash_binary_end;
+
 namespace brssl {
 // Code here is pulled from brssl sources, with the copyright and license
 // shown below.  I've rewritten things using C++ semantics and removed
@@ -331,7 +339,8 @@ pem_object *decode_pem(const void *src, size_t len, size_t *num) {
 
 // Parse out DER or PEM encoded certificates from a binary buffer,
 // potentially stored in PROGMEM.
-br_x509_certificate *read_certificates(const char *buff, size_t len, size_t *num) {
+// A single DER certificate in the program image is referenced where it is, and *borrowed set.
+br_x509_certificate *read_certificates(const char *buff, size_t len, size_t *num, bool *borrowed) {
     std::vector<br_x509_certificate> cert_list;
     pem_object *pos;
     size_t u, num_pos;
@@ -339,18 +348,24 @@ br_x509_certificate *read_certificates(const char *buff, size_t len, size_t *num
     br_x509_certificate dummy;
 
     *num = 0;
+    *borrowed = false;
 
     if (looks_like_DER((const unsigned char *)buff, len)) {
         xcs = (br_x509_certificate*)malloc(2 * sizeof(*xcs));
         if (!xcs) {
             return nullptr;
         }
-        xcs[0].data = (uint8_t*)malloc(len);
-        if (!xcs[0].data) {
-            free(xcs);
-            return nullptr;
+        if (((intptr_t)buff >= (intptr_t)XIP_BASE) && ((intptr_t)(buff + len) <= (intptr_t)&__flash_binary_end)) {
+            xcs[0].data = (uint8_t*)buff;
+            *borrowed = true;
+        } else {
+            xcs[0].data = (uint8_t*)malloc(len);
+            if (!xcs[0].data) {
+                free(xcs);
+                return nullptr;
+            }
+            memcpy_P(xcs[0].data, buff, len);
         }
-        memcpy_P(xcs[0].data, buff, len);
         xcs[0].data_len = len;
         xcs[1].data = nullptr;
         xcs[1].data_len = 0;
@@ -396,9 +411,9 @@ br_x509_certificate *read_certificates(const char *buff, size_t len, size_t *num
     return xcs;
 }
 
-void free_certificates(br_x509_certificate *certs, size_t num) {
+void free_certificates(br_x509_certificate *certs, size_t num, bool borrowed) {
     if (certs) {
-        for (size_t u = 0; u < num; u ++) {
+        for (size_t u = 0; !borrowed && (u < num); u ++) {
             free(certs[u].data);
         }
         free(certs);
@@ -642,6 +657,169 @@ static uint8_t *loadStream(Stream& stream, size_t size) {
     }
     return dest;
 }
+
+// The decoded form of one PEM/DER blob.  While cached, every key or certificate list made
+// from the same bytes shares it instead of decoding them again, so the contents must never
+// be modified.
+enum { BLOB_CERTS, BLOB_PUBLIC_KEY, BLOB_PRIVATE_KEY };
+
+class parsed_blob {
+public:
+    uint8_t sha256[32];  // Of the source bytes, the cache key
+    int kind;
+    uint32_t refs;
+    uint32_t used;       // Last access, for least-recently-used eviction
+    bool cached;         // Otherwise freed with the last reference
+    size_t count;
+    br_x509_certificate *certs;
+    br_x509_trust_anchor *tas;
+    bool borrowed;       // certs[0].data is in the program image
+    public_key *pk;
+    private_key *sk;
+};
+
+static parsed_blob **_blobCache = nullptr;
+static size_t _blobCacheSize = BEARSSL_KEY_CACHE_SIZE;
+static uint32_t _blobTick = 0;
+auto_init_mutex(_blobMutex);
+
+static void free_blob(parsed_blob *b) {
+    for (size_t i = 0; b->tas && (i < b->count); i++) {
+        free_ta_contents(&b->tas[i]);
+    }
+    free(b->tas);
+    free_certificates(b->certs, b->count, b->borrowed);
+    free_public_key(b->pk);
+    free_private_key(b->sk);
+    delete b;
+}
+
+static parsed_blob *parse_blob(int kind, const uint8_t *src, size_t len) {
+    parsed_blob *b = new (std::nothrow) parsed_blob();
+    if (!b) {
+        return nullptr;
+    }
+    b->kind = kind;
+    bool ok = false;
+    switch (kind) {
+    case BLOB_CERTS:
+        b->certs = read_certificates((const char *)src, len, &b->count, &b->borrowed);
+        if (b->certs) {
+            b->tas = (br_x509_trust_anchor*)calloc(b->count, sizeof(br_x509_trust_anchor));
+            ok = b->tas != nullptr;
+            for (size_t i = 0; ok && (i < b->count); i++) {
+                ok = certificate_to_trust_anchor_inner(&b->tas[i], &b->certs[i]);
+            }
+        }
+        break;
+    case BLOB_PUBLIC_KEY:
+        b->pk = read_public_key((const char *)src, len);
+        ok = b->pk != nullptr;
+        break;
+    case BLOB_PRIVATE_KEY:
+        b->sk = read_private_key((const char *)src, len);
+        ok = b->sk != nullptr;
+        break;
+    }
+    if (!ok) {
+        free_blob(b);
+        return nullptr;
+    }
+    return b;
+}
+
+// Takes an empty slot or the least recently used idle entry, else leaves b uncached
+static void cache_blob(parsed_blob *b) {
+    if (!_blobCache) {
+        _blobCache = (parsed_blob **)calloc(_blobCacheSize, sizeof(parsed_blob *));
+        if (!_blobCache) {
+            return;
+        }
+    }
+    parsed_blob **victim = nullptr;
+    for (size_t i = 0; i < _blobCacheSize; i++) {
+        parsed_blob *e = _blobCache[i];
+        if (!e) {
+            victim = &_blobCache[i];
+            break;
+        }
+        if (!e->refs && (!victim || (e->used < (*victim)->used))) {
+            victim = &_blobCache[i];
+        }
+    }
+    if (!victim) {
+        return;
+    }
+    if (*victim) {
+        free_blob(*victim);
+    }
+    *victim = b;
+    b->cached = true;
+    b->used = ++_blobTick;
+}
+
+// Idle entries are freed, ones still in use are left to go with their last reference
+static void flush_blobs() {
+    for (size_t i = 0; _blobCache && (i < _blobCacheSize); i++) {
+        parsed_blob *e = _blobCache[i];
+        if (e) {
+            if (e->refs) {
+                e->cached = false;
+            } else {
+                free_blob(e);
+            }
+            _blobCache[i] = nullptr;
+        }
+    }
+}
+
+parsed_blob *acquire_blob(int kind, const uint8_t *src, size_t len) {
+    uint8_t sha256[32];
+    if (_blobCacheSize) {
+        br_sha256_context ctx;
+        br_sha256_init(&ctx);
+        br_sha256_update(&ctx, src, len);
+        br_sha256_out(&ctx, sha256);
+
+        CoreMutex m(&_blobMutex);
+        for (size_t i = 0; _blobCache && (i < _blobCacheSize); i++) {
+            parsed_blob *e = _blobCache[i];
+            if (e && (e->kind == kind) && !memcmp(e->sha256, sha256, sizeof(sha256))) {
+                e->refs++;
+                e->used = ++_blobTick;
+                return e;
+            }
+        }
+    }
+
+    // Decoding is slow, so it's done without the lock.  Two callers racing on the same new
+    // blob just end up with two entries.
+    parsed_blob *b = parse_blob(kind, src, len);
+    if (!b) {
+        return nullptr;
+    }
+    b->refs = 1;
+    if (_blobCacheSize) {
+        memcpy(b->sha256, sha256, sizeof(sha256));
+        CoreMutex m(&_blobMutex);
+        cache_blob(b);
+    }
+    return b;
+}
+
+void release_blob(parsed_blob *b) {
+    if (!b) {
+        return;
+    }
+    bool dead;
+    {
+        CoreMutex m(&_blobMutex);
+        dead = !--b->refs && !b->cached;
+    }
+    if (dead) {
+        free_blob(b);
+    }
+}
 };
 
 
@@ -652,20 +830,24 @@ namespace BearSSL {
 
 PublicKey::PublicKey() {
     _key = nullptr;
+    _blob = nullptr;
 }
 
 PublicKey::PublicKey(const char *pemKey) {
     _key = nullptr;
+    _blob = nullptr;
     parse(pemKey);
 }
 
 PublicKey::PublicKey(const uint8_t *derKey, size_t derLen) {
     _key = nullptr;
+    _blob = nullptr;
     parse(derKey, derLen);
 }
 
 PublicKey::PublicKey(Stream &stream, size_t size) {
     _key = nullptr;
+    _blob = nullptr;
     auto buff = brssl::loadStream(stream, size);
     if (buff) {
         parse(buff, size);
@@ -674,9 +856,7 @@ PublicKey::PublicKey(Stream &stream, size_t size) {
 }
 
 PublicKey::~PublicKey() {
-    if (_key) {
-        brssl::free_public_key(_key);
-    }
+    brssl::release_blob(_blob);
 }
 
 bool PublicKey::parse(const char *pemKey) {
@@ -684,11 +864,9 @@ bool PublicKey::parse(const char *pemKey) {
 }
 
 bool PublicKey::parse(const uint8_t *derKey, size_t derLen) {
-    if (_key) {
-        brssl::free_public_key(_key);
-        _key = nullptr;
-    }
-    _key = brssl::read_public_key((const char *)derKey, derLen);
+    brssl::release_blob(_blob);
+    _blob = brssl::acquire_blob(brssl::BLOB_PUBLIC_KEY, derKey, derLen);
+    _key = _blob ? _blob->pk : nullptr;
     return _key ? true : false;
 }
 
@@ -724,20 +902,24 @@ const br_ec_public_key *PublicKey::getEC() const {
 
 PrivateKey::PrivateKey() {
     _key = nullptr;
+    _blob = nullptr;
 }
 
 PrivateKey::PrivateKey(const char *pemKey) {
     _key = nullptr;
+    _blob = nullptr;
     parse(pemKey);
 }
 
 PrivateKey::PrivateKey(const uint8_t *derKey, size_t derLen) {
     _key = nullptr;
+    _blob = nullptr;
     parse(derKey, derLen);
 }
 
 PrivateKey::PrivateKey(Stream &stream, size_t size) {
     _key = nullptr;
+    _blob = nullptr;
     auto buff = brssl::loadStream(stream, size);
     if (buff) {
         parse(buff, size);
@@ -746,9 +928,7 @@ PrivateKey::PrivateKey(Stream &stream, size_t size) {
 }
 
 PrivateKey::~PrivateKey() {
-    if (_key) {
-        brssl::free_private_key(_key);
-    }
+    brssl::release_blob(_blob);
 }
 
 bool PrivateKey::parse(const char *pemKey) {
@@ -756,11 +936,9 @@ bool PrivateKey::parse(const char *pemKey) {
 }
 
 bool PrivateKey::parse(const uint8_t *derKey, size_t derLen) {
-    if (_key) {
-        brssl::free_private_key(_key);
-        _key = nullptr;
-    }
-    _key = brssl::read_private_key((const char *)derKey, derLen);
+    brssl::release_blob(_blob);
+    _blob = brssl::acquire_blob(brssl::BLOB_PRIVATE_KEY, derKey, derLen);
+    _key = _blob ? _blob->sk : nullptr;
     return _key ? true : false;
 }
 
@@ -798,12 +976,16 @@ X509List::X509List() {
     _count = 0;
     _cert = nullptr;
     _ta = nullptr;
+    _blobs = nullptr;
+    _blobCount = 0;
 }
 
 X509List::X509List(const char *pemCert) {
     _count = 0;
     _cert = nullptr;
     _ta = nullptr;
+    _blobs = nullptr;
+    _blobCount = 0;
     append(pemCert);
 }
 
@@ -812,6 +994,8 @@ X509List::X509List(const uint8_t *derCert, size_t derLen) {
     _count = 0;
     _cert = nullptr;
     _ta = nullptr;
+    _blobs = nullptr;
+    _blobCount = 0;
     append(derCert, derLen);
 }
 
@@ -819,6 +1003,8 @@ X509List::X509List(Stream &stream, size_t size) {
     _count = 0;
     _cert = nullptr;
     _ta = nullptr;
+    _blobs = nullptr;
+    _blobCount = 0;
     auto buff = brssl::loadStream(stream, size);
     if (buff) {
         append(buff, size);
@@ -827,11 +1013,13 @@ X509List::X509List(Stream &stream, size_t size) {
 }
 
 X509List::~X509List() {
-    brssl::free_certificates(_cert, _count); // also frees cert
-    for (size_t i = 0; i < _count; i++) {
-        brssl::free_ta_contents(&_ta[i]);
-    }
+    // The certificates and TAs themselves belong to the blobs
+    free(_cert);
     free(_ta);
+    for (size_t i = 0; i < _blobCount; i++) {
+        brssl::release_blob(_blobs[i]);
+    }
+    free(_blobs);
 }
 
 bool X509List::append(const char *pemCert) {
@@ -839,47 +1027,61 @@ bool X509List::append(const char *pemCert) {
 }
 
 bool X509List::append(const uint8_t *derCert, size_t derLen) {
-    size_t numCerts;
-    br_x509_certificate *newCerts = brssl::read_certificates((const char *)derCert, derLen, &numCerts);
-    if (!newCerts) {
+    brssl::parsed_blob *blob = brssl::acquire_blob(brssl::BLOB_CERTS, derCert, derLen);
+    if (!blob) {
         return false;
     }
 
-    // Add in the certificates
-    br_x509_certificate *saveCert = _cert;
-    _cert = (br_x509_certificate*)realloc(_cert, (numCerts + _count) * sizeof(br_x509_certificate));
-    if (!_cert) {
-        free(newCerts);
-        _cert = saveCert;
+    brssl::parsed_blob **blobs = (brssl::parsed_blob **)realloc(_blobs, (_blobCount + 1) * sizeof(*blobs));
+    if (!blobs) {
+        brssl::release_blob(blob);
         return false;
     }
-    memcpy(&_cert[_count], newCerts, numCerts * sizeof(br_x509_certificate));
-    free(newCerts);
-
-    // Build TAs for each certificate
-    br_x509_trust_anchor *saveTa = _ta;
-    _ta = (br_x509_trust_anchor*)realloc(_ta, (numCerts + _count) * sizeof(br_x509_trust_anchor));
-    if (!_ta) {
-        _ta = saveTa;
+    _blobs = blobs;
+    br_x509_certificate *cert = (br_x509_certificate*)realloc(_cert, (_count + blob->count) * sizeof(br_x509_certificate));
+    if (!cert) {
+        brssl::release_blob(blob);
         return false;
     }
-    for (size_t i = 0; i < numCerts; i++) {
-        br_x509_trust_anchor *newTa = brssl::certificate_to_trust_anchor(&_cert[_count + i]);
-        if (newTa) {
-            _ta[_count + i ] = *newTa;
-            free(newTa);
-        } else {
-            return false; // OOM
-        }
+    _cert = cert;
+    br_x509_trust_anchor *ta = (br_x509_trust_anchor*)realloc(_ta, (_count + blob->count) * sizeof(br_x509_trust_anchor));
+    if (!ta) {
+        brssl::release_blob(blob);
+        return false;
     }
-    _count += numCerts;
+    _ta = ta;
+
+    // Shallow copies, pointing into the blob
+    memcpy(&_cert[_count], blob->certs, blob->count * sizeof(br_x509_certificate));
+    memcpy(&_ta[_count], blob->tas, blob->count * sizeof(br_x509_trust_anchor));
+    _blobs[_blobCount++] = blob;
+    _count += blob->count;
 
     return true;
 }
 
+// ----- Decoded key cache -----
+
+void KeyCache::setSize(size_t entries) {
+    CoreMutex m(&brssl::_blobMutex);
+    brssl::flush_blobs();
+    free(brssl::_blobCache);
+    brssl::_blobCache = nullptr;
+    brssl::_blobCacheSize = entries;
+}
+
+size_t KeyCache::size() {
+    return brssl::_blobCacheSize;
+}
+
+void KeyCache::clear() {
+    CoreMutex m(&brssl::_blobMutex);
+    brssl::flush_blobs();
+}
+
 ServerSessions::~ServerSessions() {
     if (_isDynamic && _store != nullptr) {
-        delete _store;
+        delete[] _store;
     }
 }
 
@@ -895,6 +1097,68 @@ const br_ssl_session_cache_class **ServerSessions::getCache() {
     return _size > 0 ? &_cache.vtable : nullptr;
 }
 
+ClientSessions::ClientSessions(uint32_t size) : _size(0), _tick(0), _store(nullptr) {
+    if (size > 0) {
+        _store = new (std::nothrow) Entry[size];
+        if (_store) {
+            _size = size;
+            clear();
+        }
+    }
+}
+
+ClientSessions::~ClientSessions() {
+    delete[] _store;
+}
+
+void ClientSessions::clear() {
+    if (_store) {
+        memset(_store, 0, _size * sizeof(Entry));
+    }
+}
+
+// FNV-1a, collisions only cost a failed resumption as the server won't know the session
+uint32_t ClientSessions::key(const char *host, uint16_t port) {
+    uint32_t h = 2166136261UL;
+    while (host && *host) {
+        h = (h ^ (uint8_t)*host++) * 16777619UL;
+    }
+    h = (h ^ (port & 0xff)) * 16777619UL;
+    h = (h ^ (port >> 8)) * 16777619UL;
+    return h ? h : 1;
+}
+
+ClientSessions::Entry *ClientSessions::find(uint32_t key) {
+    for (uint32_t i = 0; i < _size; i++) {
+        if (_store[i].key == key) {
+            _store[i].used = ++_tick;
+            return &_store[i];
+        }
+    }
+    return nullptr;
+}
+
+ClientSessions::Entry *ClientSessions::insert(uint32_t key) {
+    if (!_size) {
+        return nullptr;
+    }
+    Entry *e = find(key);
+    if (e) {
+        return e;
+    }
+    e = &_store[0];
+    for (uint32_t i = 1; i < _size; i++) {
+        if (_store[i].used < e->used) {
+            e = &_store[i];
+        }
+    }
+    memset(e, 0, sizeof(*e));
+    e->key = key;
+    e->mfln = -1;
+    e->used = ++_tick;
+    return e;
+}
+
 // SHA256 hash for updater
 void HashSHA256::begin() {
     br_sha256_init(&_cc);
@@ -996,4 +1260,5 @@ make_stack_thunk_void(br_ssl_engine_sendapp_ack, (br_ssl_engine_context *cc, siz
 make_stack_thunk_unsigned_char_ptr(br_ssl_engine_sendapp_buf, (const br_ssl_engine_context *cc, size_t *len), (cc, len));
 make_stack_thunk_void(br_ssl_engine_sendrec_ack, (br_ssl_engine_context *cc, size_t len), (cc, len));
 make_stack_thunk_unsigned_char_ptr(br_ssl_engine_sendrec_buf, (const br_ssl_engine_context *cc, size_t *len), (cc, len));
+make_stack_thunk_core1_void(br_ssl_engine_recvrec_ack, (br_ssl_engine_context *cc, size_t len), (cc, len));
 #pragma GCC pop_options
@@ -26,18 +26,20 @@
 #include <bearssl/bearssl.h>
 #include <Updater.h>
 #include <StackThunk.h>
+#include <new>
 
 // Internal opaque structures, not needed by user applications
 namespace brssl {
 class public_key;
 class private_key;
+class parsed_blob;
 };
 
 namespace BearSSL {
 
 // Holds either a single public RSA or EC key for use when BearSSL wants a pubkey.
 // Copies all associated data so no need to keep input PEM/DER keys.
-// All inputs can be either in RAM or PROGMEM.
+// All inputs can be either in RAM or PROGMEM.  The decoded key is shared through the KeyCache.
 class PublicKey {
 public:
     PublicKey();
@@ -61,12 +63,13 @@ public:
     PublicKey& operator=(const PublicKey& that) = delete;
 
 private:
-    brssl::public_key *_key;
+    brssl::public_key *_key; // Owned by _blob
+    brssl::parsed_blob *_blob;
 };
 
 // Holds either a single private RSA or EC key for use when BearSSL wants a secretkey.
 // Copies all associated data so no need to keep input PEM/DER keys.
-// All inputs can be either in RAM or PROGMEM.
+// All inputs can be either in RAM or PROGMEM.  The decoded key is shared through the KeyCache.
 class PrivateKey {
 public:
     PrivateKey();
@@ -90,15 +93,18 @@ public:
     PrivateKey& operator=(const PrivateKey& that) = delete;
 
 private:
-    brssl::private_key *_key;
+    brssl::private_key *_key; // Owned by _blob
+    brssl::parsed_blob *_blob;
 };
 
 // Holds one or more X.509 certificates and associated trust anchors for
 // use whenever BearSSL needs a cert or TA.  May want to have multiple
 // certs for things like a series of trusted CAs (but check the CertStore class
 // for a more memory efficient way).
-// Copies all associated data so no need to keep input PEM/DER certs.
-// All inputs can be either in RAM or PROGMEM.
+// Copies all associated data so no need to keep input PEM/DER certs, except that a single
+// DER certificate in flash (PROGMEM) is used in place rather than copied to RAM.
+// All inputs can be either in RAM or PROGMEM.  Decoded certificates are shared through the
+// KeyCache, so the returned certificates and TAs must not be modified.
 class X509List {
 public:
     X509List();
@@ -130,6 +136,21 @@ private:
     size_t _count;
     br_x509_certificate *_cert;
     br_x509_trust_anchor *_ta;
+    brssl::parsed_blob **_blobs; // One per append(), holding the decoded data
+    size_t _blobCount;
+};
+
+// Process-wide cache of decoded certificates and keys.  Making an X509List, PublicKey or
+// PrivateKey again from the same PEM/DER bytes (say, for every connection) shares the
+// earlier decoding instead of repeating it.  The last few unused ones are kept, which
+// means a cached private key stays in RAM after its PrivateKey is deleted until clear().
+class KeyCache {
+public:
+    // Number of decoded blobs kept, 0 disables caching.  Defaults to BEARSSL_KEY_CACHE_SIZE
+    static void setSize(size_t entries);
+    static size_t size();
+    // Drops everything not in use right now
+    static void clear();
 };
 
 // Opaque object which wraps the BearSSL SSL session to make repeated connections
@@ -154,6 +175,47 @@ private:
     br_ssl_session_parameters _session;
 };
 
+// Cache of the TLS sessions (and MFLN support) of the last few servers connected to, so
+// reconnecting to one resumes its session instead of doing a full handshake.
+// Use with BearSSL::WiFiClientSecure::setSessionCache, may be shared by several clients.
+class ClientSessions {
+    friend class WiFiClientSecureCtx;
+
+public:
+    // Dynamically allocates room for the given number of servers.
+    // If the allocation wasn't successful, the value returned by size() will be 0.
+    ClientSessions(uint32_t size);
+    ~ClientSessions();
+
+    // Returns the number of servers the cache can hold.
+    uint32_t size() {
+        return _size;
+    }
+
+    // Forget all sessions
+    void clear();
+
+private:
+    typedef struct {
+        uint32_t key;     // Hash of host and port, 0 if unused
+        uint32_t used;    // Last access, for least-recently-used eviction
+        bool valid;       // Session parameters can be resumed
+        int8_t mfln;      // -1 unknown, 0 unsupported, 1 supported for mflnLen
+        uint16_t mflnLen;
+        br_ssl_session_parameters session;
+    } Entry;
+
+    static uint32_t key(const char *host, uint16_t port);
+    // Returns the entry for a server, or nullptr if not cached
+    Entry *find(uint32_t key);
+    // Returns the entry for a server, replacing the least recently used one if not cached
+    Entry *insert(uint32_t key);
+
+    uint32_t _size;
+    uint32_t _tick;
+    Entry *_store;
+};
+
 // Represents a single server session.
 // Use with BearSSL::ServerSessions.
 typedef uint8_t ServerSession[100];
@@ -170,7 +232,7 @@ public:
     // Dynamically allocates a cache for the given number of sessions and initializes it.
     // If the allocation of the buffer wasn't successful, the value
     // returned by size() will be 0.
-    ServerSessions(uint32_t size) : ServerSessions(size > 0 ? new ServerSession[size] : nullptr, size, true) {}
+    ServerSessions(uint32_t size) : ServerSessions(size > 0 ? new (std::nothrow) ServerSession[size] : nullptr, size, true) {}
 
     ~ServerSessions();
 
@@ -242,3 +304,4 @@ extern "C" unsigned char *thunk_br_ssl_engine_sendapp_buf(const br_ssl_engine_co
 extern "C" void thunk_br_ssl_engine_sendapp_ack(br_ssl_engine_context *cc, size_t len);
 extern "C" unsigned char *thunk_br_ssl_engine_sendrec_buf(const br_ssl_engine_context *cc, size_t *len);
 extern "C" void thunk_br_ssl_engine_sendrec_ack(br_ssl_engine_context *cc, size_t len);
+extern "C" void thunk_core1_br_ssl_engine_recvrec_ack(br_ssl_engine_context *cc, size_t len);
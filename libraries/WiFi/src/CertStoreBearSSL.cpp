@@ -19,6 +19,8 @@
 
 #include "CertStoreBearSSL.h"
 #include <memory>
+#include <vector>
+#include <algorithm>
 
 
 #if defined(DEBUG_ESP_SSL) && defined(DEBUG_ESP_PORT)
@@ -39,10 +41,21 @@ extern "C" {
 
 
 CertStore::~CertStore() {
+    clearCache();
     free(_indexName);
     free(_dataName);
 }
 
+void CertStore::clearCache() {
+    for (int i = 0; i < CERTSTORE_CACHE_SIZE; i++) {
+        if (_cache[i].refs) {
+            continue; // Still in a handshake, freeHashedTA will clean it up
+        }
+        delete _cache[i].x509;
+        _cache[i].x509 = nullptr;
+    }
+}
+
 CertStore::CertInfo CertStore::_preprocessCert(uint32_t length, uint32_t offset, const void *raw) {
     CertStore::CertInfo ci;
 
@@ -103,6 +116,8 @@ int CertStore::initCertStore(fs::FS &fs, const char *indexFileName, const char *
     memcpy_P(_indexName, indexFileName, strlen_P(indexFileName) + 1);
     memcpy_P(_dataName, dataFileName, strlen_P(dataFileName) + 1);
 
+    clearCache();
+
     fs::File index = _fs->open(_indexName, "w");
     if (!index) {
         return 0;
@@ -123,6 +138,9 @@ int CertStore::initCertStore(fs::FS &fs, const char *indexFileName, const char *
     }
     offset += sizeof(magic);
 
+    // The index is written sorted by hash at the end so lookups can binary search it
+    std::vector<CertInfo> infos;
+
     while (true) {
         uint8_t fileHeader[60];
         // 0..15 = filename in ASCII
@@ -148,12 +166,7 @@ int CertStore::initCertStore(fs::FS &fs, const char *indexFileName, const char *
 
         // If the filename starts with "//" then this is a rename file, skip it
         if (fileHeader[0] != '/' || fileHeader[1] != '/') {
-            CertStore::CertInfo ci = _preprocessCert(length, offset, raw);
-            if (index.write((uint8_t *)&ci, sizeof(ci)) != (ssize_t)sizeof(ci)) {
-                free(raw);
-                break;
-            }
-            count++;
+            infos.push_back(_preprocessCert(length, offset, raw));
         }
 
         offset += length;
@@ -165,6 +178,16 @@ int CertStore::initCertStore(fs::FS &fs, const char *indexFileName, const char *
         }
     }
     data.close();
+
+    std::sort(infos.begin(), infos.end(), [](const CertInfo & a, const CertInfo & b) {
+        return memcmp(a.sha256, b.sha256, sizeof(a.sha256)) < 0;
+    });
+    for (auto &ci : infos) {
+        if (index.write((uint8_t *)&ci, sizeof(ci)) != (ssize_t)sizeof(ci)) {
+            break;
+        }
+        count++;
+    }
     index.close();
     return count;
 }
@@ -173,6 +196,65 @@ void CertStore::installCertStore(br_x509_minimal_context *ctx) {
     br_x509_minimal_set_dynamic(ctx, (void*)this, findHashedTA, freeHashedTA);
 }
 
+bool CertStore::_findIndex(const void *hashed_dn, CertInfo *ci) {
+    fs::File index = _fs->open(_indexName, "r");
+    if (!index) {
+        return false;
+    }
+    int lo = 0;
+    int hi = (int)(index.size() / sizeof(CertInfo)) - 1;
+    bool found = false;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (!index.seek(mid * sizeof(CertInfo), fs::SeekSet) ||
+                (index.read((uint8_t *)ci, sizeof(CertInfo)) != sizeof(CertInfo))) {
+            break;
+        }
+        int cmp = memcmp(ci->sha256, hashed_dn, sizeof(ci->sha256));
+        if (!cmp) {
+            found = true;
+            break;
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    index.close();
+    return found;
+}
+
+X509List *CertStore::_loadTA(const CertInfo &ci, uint8_t *hashedDN) {
+    uint8_t *der = (uint8_t*)malloc(ci.length);
+    if (!der) {
+        return nullptr;
+    }
+    fs::File data = _fs->open(_dataName, "r");
+    if (!data) {
+        free(der);
+        return nullptr;
+    }
+    if (!data.seek(ci.offset, fs::SeekSet) || (data.read(der, ci.length) != (int)ci.length)) {
+        data.close();
+        free(der);
+        return nullptr;
+    }
+    data.close();
+    X509List *x509 = new (std::nothrow) X509List(der, ci.length);
+    free(der);
+    if (!x509) {
+        DEBUG_BSSL("CertStore::findHashedTA: OOM\n");
+        return nullptr;
+    }
+    // The decoded DN may be shared with other lists through the KeyCache, so only this
+    // list's own TA entry is repointed, at the hash
+    br_x509_trust_anchor *ta = (br_x509_trust_anchor*)x509->getTrustAnchors();
+    memcpy(hashedDN, ci.sha256, sizeof(ci.sha256));
+    ta->dn.data = hashedDN;
+    ta->dn.len = sizeof(ci.sha256);
+    return x509;
+}
+
 const br_x509_trust_anchor *CertStore::findHashedTA(void *ctx, void *hashed_dn, size_t len) {
     CertStore *cs = static_cast<CertStore*>(ctx);
     CertStore::CertInfo ci;
@@ -181,56 +263,53 @@ const br_x509_trust_anchor *CertStore::findHashedTA(void *ctx, void *hashed_dn,
         return nullptr;
     }
 
-    fs::File index = cs->_fs->open(cs->_indexName, "r");
-    if (!index) {
-        return nullptr;
+    CacheEntry *victim = nullptr;
+    for (int i = 0; i < CERTSTORE_CACHE_SIZE; i++) {
+        CacheEntry *e = &cs->_cache[i];
+        if (e->x509 && !memcmp(e->sha256, hashed_dn, sizeof(e->sha256))) {
+            e->used = ++cs->_cacheTick;
+            e->refs++;
+            return e->x509->getTrustAnchors();
+        }
+        if (!e->refs && (!victim || !e->x509 || (victim->x509 && (e->used < victim->used)))) {
+            victim = e;
+        }
     }
 
-    while (index.read((uint8_t *)&ci, sizeof(ci)) == sizeof(ci)) {
-        if (!memcmp(ci.sha256, hashed_dn, sizeof(ci.sha256))) {
-            index.close();
-            uint8_t *der = (uint8_t*)malloc(ci.length);
-            if (!der) {
-                return nullptr;
-            }
-            fs::File data = cs->_fs->open(cs->_dataName, "r");
-            if (!data) {
-                free(der);
-                return nullptr;
-            }
-            if (!data.seek(ci.offset, fs::SeekSet)) {
-                data.close();
-                free(der);
-                return nullptr;
-            }
-            if (data.read(der, ci.length) != (int)ci.length) {
-                free(der);
-                return nullptr;
-            }
-            data.close();
-            cs->_x509 = new (std::nothrow) X509List(der, ci.length);
-            free(der);
-            if (!cs->_x509) {
-                DEBUG_BSSL("CertStore::findHashedTA: OOM\n");
-                return nullptr;
-            }
-
-            br_x509_trust_anchor *ta = (br_x509_trust_anchor*)cs->_x509->getTrustAnchors();
-            memcpy(ta->dn.data, ci.sha256, sizeof(ci.sha256));
-            ta->dn.len = sizeof(ci.sha256);
-
-            return ta;
-        }
+    if (!cs->_findIndex(hashed_dn, &ci)) {
+        return nullptr;
     }
-    index.close();
-    return nullptr;
+    if (!victim) {
+        // Every cached TA is in use, hand this one out uncached
+        delete cs->_x509;
+        cs->_x509 = cs->_loadTA(ci, cs->_x509sha256);
+        return cs->_x509 ? cs->_x509->getTrustAnchors() : nullptr;
+    }
+    delete victim->x509;
+    victim->x509 = cs->_loadTA(ci, victim->sha256);
+    if (!victim->x509) {
+        return nullptr;
+    }
+    victim->used = ++cs->_cacheTick;
+    victim->refs = 1;
+    return victim->x509->getTrustAnchors();
 }
 
 void CertStore::freeHashedTA(void *ctx, const br_x509_trust_anchor *ta) {
     CertStore *cs = static_cast<CertStore*>(ctx);
-    (void) ta; // Unused
-    delete cs->_x509;
-    cs->_x509 = nullptr;
+    for (int i = 0; i < CERTSTORE_CACHE_SIZE; i++) {
+        CacheEntry *e = &cs->_cache[i];
+        if (e->x509 && (e->x509->getTrustAnchors() == ta)) {
+            if (e->refs) {
+                e->refs--;
+            }
+            return;
+        }
+    }
+    if (cs->_x509 && (cs->_x509->getTrustAnchors() == ta)) {
+        delete cs->_x509;
+        cs->_x509 = nullptr;
+    }
 }
 
 }
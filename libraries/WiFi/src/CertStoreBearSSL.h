@@ -49,17 +49,34 @@ public:
     // Installs the cert store into the X509 decoder (normally via static function callbacks)
     void installCertStore(br_x509_minimal_context *ctx);
 
+    // Drop any decoded trust anchors kept in RAM
+    void clearCache();
+
 protected:
     fs::FS *_fs = nullptr;
     char *_indexName = nullptr;
     char *_dataName = nullptr;
     X509List *_x509 = nullptr;
+    uint8_t _x509sha256[32] = {};
+
+    // Recently used trust anchors, kept decoded so repeat connections skip the FS and parsing
+#ifndef CERTSTORE_CACHE_SIZE
+#define CERTSTORE_CACHE_SIZE 4
+#endif
+    typedef struct {
+        uint8_t sha256[32];
+        X509List *x509;   // nullptr if this slot is unused
+        uint32_t used;    // Last lookup, for least-recently-used eviction
+        uint16_t refs;    // Handshakes currently using it, can't be evicted while non-zero
+    } CacheEntry;
+    CacheEntry _cache[CERTSTORE_CACHE_SIZE] = {};
+    uint32_t _cacheTick = 0;
 
     // These need to be static as they are callbacks from BearSSL C code
     static const br_x509_trust_anchor *findHashedTA(void *ctx, void *hashed_dn, size_t len);
     static void freeHashedTA(void *ctx, const br_x509_trust_anchor *ta);
 
-    // The binary format of the index file
+    // The binary format of the index file, which is sorted by sha256
     class CertInfo {
     public:
         uint8_t sha256[32];
@@ -67,6 +84,9 @@ protected:
         uint32_t length;
     };
     static CertInfo _preprocessCert(uint32_t length, uint32_t offset, const void *raw);
+    bool _findIndex(const void *hashed_dn, CertInfo *ci);
+    // The TA's DN is pointed at hashedDN, which must live as long as the X509List
+    X509List *_loadTA(const CertInfo &ci, uint8_t *hashedDN);
 
 };
 
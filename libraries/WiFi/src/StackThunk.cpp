@@ -67,6 +67,36 @@ extern "C" {
         }
     }
 
+    uint32_t *stack_thunk_core1_ptr = NULL;
+    uint32_t *stack_thunk_core1_top = NULL;
+    uint32_t *stack_thunk_core1_save = NULL;
+    uint32_t stack_thunk_core1_refcnt = 0;
+
+    void stack_thunk_core1_add_ref() {
+        stack_thunk_core1_refcnt++;
+        if (stack_thunk_core1_refcnt == 1) {
+            stack_thunk_core1_ptr = (uint32_t *)malloc(_stackSize * sizeof(uint32_t));
+            if (!stack_thunk_core1_ptr) {
+                abort();
+            }
+            stack_thunk_core1_top = stack_thunk_core1_ptr + _stackSize - 1;
+            stack_thunk_core1_save = NULL;
+        }
+    }
+
+    void stack_thunk_core1_del_ref() {
+        if (stack_thunk_core1_refcnt == 0) {
+            return;
+        }
+        stack_thunk_core1_refcnt--;
+        if (!stack_thunk_core1_refcnt) {
+            free(stack_thunk_core1_ptr);
+            stack_thunk_core1_ptr = NULL;
+            stack_thunk_core1_top = NULL;
+            stack_thunk_core1_save = NULL;
+        }
+    }
+
     void stack_thunk_repaint() {
         for (int i = 0; i < _stackSize; i++) {
             stack_thunk_ptr[i] = _stackPaint;
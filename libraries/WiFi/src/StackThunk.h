@@ -43,6 +43,13 @@ extern uint32_t *stack_thunk_top;
 extern uint32_t *stack_thunk_save;
 extern uint32_t stack_thunk_refcnt;
 
+// Separate stack for BearSSL work run on core 1 (i.e. offloaded handshakes) so it never
+// shares the main thunk stack with core 0
+extern void stack_thunk_core1_add_ref();
+extern void stack_thunk_core1_del_ref();
+extern uint32_t *stack_thunk_core1_top;
+extern uint32_t *stack_thunk_core1_save;
+
 #define make_stack_thunk_void(fcnToThunk, proto, params) \
 extern "C" void thunk_##fcnToThunk proto { \
     register uint32_t* sp asm("sp"); \
@@ -72,6 +79,15 @@ extern "C" bool thunk_##fcnToThunk proto { \
     return x; \
 }
 
+#define make_stack_thunk_core1_void(fcnToThunk, proto, params) \
+extern "C" void thunk_core1_##fcnToThunk proto { \
+    register uint32_t* sp asm("sp"); \
+    stack_thunk_core1_save = sp; \
+    sp = stack_thunk_core1_top; \
+    fcnToThunk params; \
+    sp = stack_thunk_core1_save; \
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,6 +11,7 @@
 #include "WiFiClientSecure.h"
 #include "WiFiServerSecure.h"
 #include "WiFiUdp.h"
+#include "WiFiAsyncTCP.h"
 
 #include "WiFiMulti.h"
 
@@ -0,0 +1,371 @@
+/*
+    WiFiAsyncTCP - Callback driven TCP client and server on raw lwIP
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "WiFi.h"
+#include "WiFiAsyncTCP.h"
+#include "lwip/opt.h"
+#include "lwip/tcp.h"
+#include <LWIPMutex.h>
+#include <new>
+
+// The PCB whose lwIP callback is running right now.  A handler may close, abort or delete
+// the client it was called for, and then the dispatcher must neither touch the client again
+// nor return anything but ERR_ABRT for an aborted PCB.  lwIP callbacks never nest.
+static tcp_pcb *_cbPcb = nullptr;
+static bool _cbDetached;
+static bool _cbAborted;
+
+static inline void _cbBegin(tcp_pcb *pcb) {
+    _cbPcb = pcb;
+    _cbDetached = false;
+    _cbAborted = false;
+}
+
+static inline err_t _cbEnd() {
+    _cbPcb = nullptr;
+    return _cbAborted ? ERR_ABRT : ERR_OK;
+}
+
+static void _abortPcb(tcp_pcb *pcb) {
+    tcp_abort(pcb);
+    if (pcb == _cbPcb) {
+        _cbAborted = true;
+    }
+}
+
+AsyncClient::AsyncClient() {
+}
+
+AsyncClient::AsyncClient(tcp_pcb *pcb) {
+    _attach(pcb);
+}
+
+AsyncClient::~AsyncClient() {
+    LWIPMutex m;
+    tcp_pcb *pcb = _detach();
+    if (pcb) {
+        _abortPcb(pcb);
+    }
+}
+
+void AsyncClient::_attach(tcp_pcb *pcb) {
+    _pcb = pcb;
+    tcp_setprio(pcb, TCP_PRIO_MIN);
+    tcp_arg(pcb, this);
+    tcp_recv(pcb, _s_recv);
+    tcp_sent(pcb, _s_sent);
+    tcp_err(pcb, _s_error);
+    tcp_poll(pcb, _s_poll, _pollInterval);
+}
+
+tcp_pcb *AsyncClient::_detach() {
+    tcp_pcb *pcb = _pcb;
+    if (pcb) {
+        tcp_arg(pcb, nullptr);
+        tcp_recv(pcb, nullptr);
+        tcp_sent(pcb, nullptr);
+        tcp_err(pcb, nullptr);
+        tcp_poll(pcb, nullptr, 0);
+        _pcb = nullptr;
+        if (pcb == _cbPcb) {
+            _cbDetached = true;
+        }
+    }
+    return pcb;
+}
+
+// The handler may delete us, so nothing may follow this
+void AsyncClient::_disconnected() {
+    if (_onDisconnect) {
+        _onDisconnect(*this);
+    }
+}
+
+bool AsyncClient::connect(const IPAddress &ip, uint16_t port) {
+    ip_addr_t addr = ip;
+#if LWIP_IPV6
+    // Set zone so that link local addresses use the default interface
+    if (IP_IS_V6(&addr) && ip6_addr_lacks_zone(ip_2_ip6(&addr), IP6_UNKNOWN)) {
+        ip6_addr_assign_zone(ip_2_ip6(&addr), IP6_UNKNOWN, netif_default);
+    }
+#endif
+    LWIPMutex m;
+    if (_pcb) {
+        return false;
+    }
+    tcp_pcb *pcb = tcp_new();
+    if (!pcb) {
+        return false;
+    }
+    _attach(pcb);
+    LwipIntf::routeConnection(pcb, &addr);
+    if (tcp_connect(pcb, &addr, port, _s_connected) != ERR_OK) {
+        _detach();
+        tcp_close(pcb);
+        return false;
+    }
+    return true;
+}
+
+void AsyncClient::close() {
+    LWIPMutex m;
+    tcp_pcb *pcb = _detach();
+    if (!pcb) {
+        return;
+    }
+    if (tcp_close(pcb) != ERR_OK) {
+        _abortPcb(pcb);
+    }
+    _disconnected();
+}
+
+void AsyncClient::abort() {
+    LWIPMutex m;
+    tcp_pcb *pcb = _detach();
+    if (!pcb) {
+        return;
+    }
+    _abortPcb(pcb);
+    _disconnected();
+}
+
+bool AsyncClient::connected() const {
+    return _pcb && (_pcb->state == ESTABLISHED);
+}
+
+uint8_t AsyncClient::state() const {
+    return _pcb ? _pcb->state : CLOSED;
+}
+
+size_t AsyncClient::space() const {
+    LWIPMutex m;
+    if (!_pcb || ((_pcb->state != ESTABLISHED) && (_pcb->state != CLOSE_WAIT))) {
+        return 0;
+    }
+    if (tcp_sndqueuelen(_pcb) >= TCP_SND_QUEUELEN) {
+        return 0;
+    }
+    return tcp_sndbuf(_pcb);
+}
+
+size_t AsyncClient::add(const void *data, size_t len, bool copy) {
+    LWIPMutex m;
+    size_t n = std::min(std::min(len, space()), (size_t)0xffff);
+    if (!n) {
+        return 0;
+    }
+    if (tcp_write(_pcb, data, n, copy ? TCP_WRITE_FLAG_COPY : 0) != ERR_OK) {
+        return 0;
+    }
+    return n;
+}
+
+bool AsyncClient::send() {
+    LWIPMutex m;
+    return _pcb && (tcp_output(_pcb) == ERR_OK);
+}
+
+void AsyncClient::ack(size_t len) {
+    LWIPMutex m;
+    while (_pcb && len) {
+        uint16_t n = std::min(len, (size_t)0xffff);
+        tcp_recved(_pcb, n);
+        len -= n;
+    }
+}
+
+void AsyncClient::setNoDelay(bool noDelay) {
+    LWIPMutex m;
+    if (!_pcb) {
+        return;
+    }
+    if (noDelay) {
+        tcp_nagle_disable(_pcb);
+    } else {
+        tcp_nagle_enable(_pcb);
+    }
+}
+
+void AsyncClient::setPollInterval(uint8_t ticks) {
+    LWIPMutex m;
+    _pollInterval = ticks;
+    if (_pcb) {
+        tcp_poll(_pcb, _s_poll, ticks);
+    }
+}
+
+IPAddress AsyncClient::remoteIP() const {
+    return _pcb ? IPAddress(&_pcb->remote_ip) : IPAddress();
+}
+
+uint16_t AsyncClient::remotePort() const {
+    return _pcb ? _pcb->remote_port : 0;
+}
+
+IPAddress AsyncClient::localIP() const {
+    return _pcb ? IPAddress(&_pcb->local_ip) : IPAddress();
+}
+
+uint16_t AsyncClient::localPort() const {
+    return _pcb ? _pcb->local_port : 0;
+}
+
+err_t AsyncClient::_s_connected(void *arg, tcp_pcb *pcb, err_t err) {
+    (void) err;
+    AsyncClient *c = reinterpret_cast<AsyncClient *>(arg);
+    _cbBegin(pcb);
+    if (c->_onConnect) {
+        c->_onConnect(*c);
+    }
+    return _cbEnd();
+}
+
+err_t AsyncClient::_s_recv(void *arg, tcp_pcb *pcb, pbuf *p, err_t err) {
+    (void) err;
+    AsyncClient *c = reinterpret_cast<AsyncClient *>(arg);
+    if (!p) {
+        // Remote closed, so finish our side too
+        c->_detach();
+        err_t ret = ERR_OK;
+        if (tcp_close(pcb) != ERR_OK) {
+            tcp_abort(pcb);
+            ret = ERR_ABRT;
+        }
+        c->_disconnected();
+        return ret;
+    }
+    // Each pbuf of the chain goes to the handler in place, without copying
+    _cbBegin(pcb);
+    for (pbuf *q = p; q && !_cbDetached; q = q->next) {
+        if (c->_onData) {
+            c->_onData(*c, reinterpret_cast<const uint8_t *>(q->payload), q->len);
+        }
+    }
+    if (!_cbDetached && c->_autoAck) {
+        tcp_recved(pcb, p->tot_len);
+    }
+    pbuf_free(p);
+    return _cbEnd();
+}
+
+err_t AsyncClient::_s_sent(void *arg, tcp_pcb *pcb, uint16_t len) {
+    AsyncClient *c = reinterpret_cast<AsyncClient *>(arg);
+    _cbBegin(pcb);
+    if (c->_onAck) {
+        c->_onAck(*c, len);
+    }
+    return _cbEnd();
+}
+
+err_t AsyncClient::_s_poll(void *arg, tcp_pcb *pcb) {
+    AsyncClient *c = reinterpret_cast<AsyncClient *>(arg);
+    _cbBegin(pcb);
+    if (c->_onPoll) {
+        c->_onPoll(*c);
+    }
+    return _cbEnd();
+}
+
+// lwIP has already freed the PCB
+void AsyncClient::_s_error(void *arg, err_t err) {
+    AsyncClient *c = reinterpret_cast<AsyncClient *>(arg);
+    c->_pcb = nullptr;
+    if (c->_onError) {
+        c->_onError(*c, err);
+    }
+    c->_disconnected();
+}
+
+AsyncServer::AsyncServer(uint16_t port)
+    : _addr(IP_ANY_TYPE)
+    , _port(port) {
+}
+
+AsyncServer::AsyncServer(const IPAddress &addr, uint16_t port)
+    : _addr(addr)
+    , _port(port) {
+}
+
+AsyncServer::~AsyncServer() {
+    end();
+}
+
+bool AsyncServer::begin() {
+    if (_listen) {
+        return true;
+    }
+
+    LWIPMutex m;
+    tcp_pcb *pcb = tcp_new();
+    if (!pcb) {
+        return false;
+    }
+
+    pcb->so_options |= SOF_REUSEADDR;
+
+    // (IPAddress _addr) operator-converted to (const ip_addr_t*)
+    if (tcp_bind(pcb, _addr, _port) != ERR_OK) {
+        tcp_close(pcb);
+        return false;
+    }
+
+    tcp_pcb *listen_pcb = tcp_listen(pcb);
+    if (!listen_pcb) {
+        tcp_close(pcb);
+        return false;
+    }
+    _listen = listen_pcb;
+    tcp_arg(listen_pcb, this);
+    tcp_accept(listen_pcb, _s_accept);
+    return true;
+}
+
+void AsyncServer::end() {
+    if (!_listen) {
+        return;
+    }
+    LWIPMutex m;
+    tcp_arg(_listen, nullptr);
+    tcp_accept(_listen, nullptr);
+    tcp_close(_listen);
+    _listen = nullptr;
+}
+
+uint8_t AsyncServer::status() const {
+    return _listen ? _listen->state : CLOSED;
+}
+
+err_t AsyncServer::_s_accept(void *arg, tcp_pcb *pcb, err_t err) {
+    AsyncServer *s = reinterpret_cast<AsyncServer *>(arg);
+    if ((err != ERR_OK) || !pcb) {
+        return ERR_VAL;
+    }
+    AsyncClient *c = s->_onClient ? new (std::nothrow) AsyncClient(pcb) : nullptr;
+    if (!c) {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    if (s->_noDelay) {
+        tcp_nagle_disable(pcb);
+    }
+    _cbBegin(pcb);
+    s->_onClient(c);
+    return _cbEnd();
+}
@@ -0,0 +1,166 @@
+/*
+    WiFiAsyncTCP - Callback driven TCP client and server on raw lwIP
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <functional>
+#include <lwip/err.h>
+
+struct tcp_pcb;
+struct pbuf;
+
+// Nothing here blocks.  Events are delivered straight from lwIP's callbacks, in the network
+// context (an IRQ, or core 1 with network_core1), so handlers must not delay() or wait on
+// other connections.  Any method may be called from inside a handler.
+//
+// An AsyncClient must only be deleted from its onDisconnect handler or from outside any
+// of its handlers.  onDisconnect is always the last event for a connection.
+class AsyncClient {
+public:
+    using EventCB = std::function<void(AsyncClient &)>;
+    // Received data, handed over a pbuf at a time straight from lwIP's buffers
+    using DataCB = std::function<void(AsyncClient &, const uint8_t *data, size_t len)>;
+    using AckCB = std::function<void(AsyncClient &, size_t len)>;
+    using ErrorCB = std::function<void(AsyncClient &, err_t err)>;
+
+    AsyncClient();
+    ~AsyncClient();
+    AsyncClient(const AsyncClient &) = delete;
+    AsyncClient &operator=(const AsyncClient &) = delete;
+
+    // Sends the SYN, then onConnect or onError/onDisconnect follows
+    bool connect(const IPAddress &ip, uint16_t port);
+    // Graceful close, any data already added still goes out
+    void close();
+    // Sends a RST and drops everything
+    void abort();
+
+    bool connected() const;
+    uint8_t state() const;
+
+    // Bytes add() can take right now
+    size_t space() const;
+    // Queues data without sending it yet, so several pieces can go out together.  With
+    // copy == false the data is referenced, and must stay unchanged until onAck covers it.
+    size_t add(const void *data, size_t len, bool copy = true);
+    bool send();
+    size_t write(const void *data, size_t len, bool copy = true) {
+        size_t n = add(data, len, copy);
+        send();
+        return n;
+    }
+    size_t write(const char *str) {
+        return write(str, strlen(str));
+    }
+
+    // Received data is normally acknowledged (opening the window again) once onData
+    // returns.  Turn that off to apply back pressure, then ack() as it is consumed.
+    void setAutoAck(bool autoAck) {
+        _autoAck = autoAck;
+    }
+    void ack(size_t len);
+
+    void setNoDelay(bool noDelay);
+    // onPoll interval, in lwIP's 500ms ticks
+    void setPollInterval(uint8_t ticks);
+
+    IPAddress remoteIP() const;
+    uint16_t remotePort() const;
+    IPAddress localIP() const;
+    uint16_t localPort() const;
+
+    void onConnect(EventCB cb) {
+        _onConnect = cb;
+    }
+    void onData(DataCB cb) {
+        _onData = cb;
+    }
+    void onAck(AckCB cb) {
+        _onAck = cb;
+    }
+    void onPoll(EventCB cb) {
+        _onPoll = cb;
+    }
+    void onError(ErrorCB cb) {
+        _onError = cb;
+    }
+    void onDisconnect(EventCB cb) {
+        _onDisconnect = cb;
+    }
+
+private:
+    friend class AsyncServer;
+    explicit AsyncClient(tcp_pcb *pcb);
+
+    void _attach(tcp_pcb *pcb);
+    tcp_pcb *_detach();
+    void _disconnected();
+
+    static err_t _s_connected(void *arg, tcp_pcb *pcb, err_t err);
+    static err_t _s_recv(void *arg, tcp_pcb *pcb, pbuf *p, err_t err);
+    static err_t _s_sent(void *arg, tcp_pcb *pcb, uint16_t len);
+    static err_t _s_poll(void *arg, tcp_pcb *pcb);
+    static void _s_error(void *arg, err_t err);
+
+    tcp_pcb *_pcb = nullptr;
+    bool _autoAck = true;
+    uint8_t _pollInterval = 1;
+
+    EventCB _onConnect;
+    DataCB _onData;
+    AckCB _onAck;
+    EventCB _onPoll;
+    ErrorCB _onError;
+    EventCB _onDisconnect;
+};
+
+class AsyncServer {
+public:
+    // The new client belongs to the handler, which should set up its events and delete it
+    // from its onDisconnect.  Deleting it straight away refuses the connection.
+    using ClientCB = std::function<void(AsyncClient *client)>;
+
+    AsyncServer(uint16_t port);
+    AsyncServer(const IPAddress &addr, uint16_t port);
+    ~AsyncServer();
+
+    bool begin();
+    void end();
+    uint8_t status() const;
+
+    void setNoDelay(bool noDelay) {
+        _noDelay = noDelay;
+    }
+
+    void onClient(ClientCB cb) {
+        _onClient = cb;
+    }
+
+private:
+    static err_t _s_accept(void *arg, tcp_pcb *pcb, err_t err);
+
+    IPAddress _addr;
+    uint16_t _port;
+    tcp_pcb *_listen = nullptr;
+    bool _noDelay = false;
+    ClientCB _onClient;
+};
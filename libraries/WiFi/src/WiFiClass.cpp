@@ -26,6 +26,7 @@
 #include "lwip/raw.h"
 #include "lwip/icmp.h"
 #include "lwip/inet_chksum.h"
+#include "lwip/dhcp.h"
 #include <map>
 #include "WiFi.h"
 
@@ -33,6 +34,39 @@
 #include <LwipEthernet.h>
 static CYW43lwIP _wifi(1);
 
+// Where the last station join ended up, for the next begin() to the same network to go
+// straight back to.  Like CrashDump's record it lives in .uninitialized_data, which crt0
+// leaves alone, so it's still there after a reboot, and the check word weeds out the
+// garbage it holds at power on.
+typedef struct {
+    uint32_t magic;
+    uint32_t check;
+    uint32_t network;   // Hash of the SSID and password
+    uint32_t ip;        // DHCP address, 0 for a static one
+    uint8_t  bssid[6];
+    uint8_t  channel;
+    uint8_t  pad;
+} FastReconnect;
+static FastReconnect _reconnect __attribute__((section(".uninitialized_data.wifireconnect")));
+static constexpr uint32_t RECONNECT_MAGIC = 0x4e434552; // "RECN"
+
+static uint32_t _fnv(uint32_t h, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (len--) {
+        h = (h ^ *(p++)) * 16777619UL;
+    }
+    return h;
+}
+
+static uint32_t _reconnectCheck(const FastReconnect *r) {
+    return _fnv(2166136261UL, &r->network, sizeof(*r) - offsetof(FastReconnect, network));
+}
+
+static uint32_t _networkHash(const char *ssid, const char *passphrase) {
+    uint32_t h = _fnv(2166136261UL, ssid, strlen(ssid) + 1);
+    return passphrase ? _fnv(h, passphrase, strlen(passphrase)) : h;
+}
+
 WiFiClass::WiFiClass() {
 }
 
@@ -77,6 +111,14 @@ int WiFiClass::begin(const char* ssid) {
           must be between ASCII 32-126 (decimal).
 */
 int WiFiClass::begin(const char* ssid, const char *passphrase) {
+    return _beginSTA(ssid, passphrase, true);
+}
+
+int WiFiClass::beginNoBlock(const char* ssid, const char *passphrase) {
+    return _beginSTA(ssid, passphrase, false);
+}
+
+int WiFiClass::_beginSTA(const char* ssid, const char *passphrase, bool block) {
     // Simple ESP8266 compatibility hack
     if (_modeESP == WIFI_AP) {
         return beginAP(ssid, passphrase);
@@ -90,17 +132,40 @@ int WiFiClass::begin(const char* ssid, const char *passphrase) {
     _wifi.setPassword(passphrase);
     _wifi.setTimeout(_timeout);
     _wifi.setSTA();
+    _wifi.setBlocking(block);
+    _network = _networkHash(ssid, passphrase);
+    _reconnectSaved = false;
+    bool fast = _fastReconnect && _loadReconnect();
+    _wifi.setBSSID(fast ? _reconnect.bssid : nullptr, _reconnect.channel);
+    _directPending = fast && !block;
     _apMode = false;
     _wifiHWInitted = true;
     uint32_t start = millis(); // The timeout starts from network init, not network link up
     if (!_wifi.begin()) {
         return WL_IDLE_STATUS;
     }
+    // A different AP on the same network will most likely still honor the old lease
+    uint32_t ip = fast ? _reconnect.ip : 0;
+    if (_wifi.directJoinFailed()) {
+        _forgetReconnect();
+    }
+    if (ip) {
+        _rebootDHCP(ip);
+    }
+    // Bringing the interface up resets the driver's power management
+    _boosted = false;
+    if (_powerMode != WIFI_PM_BALANCED) {
+        _applyPowerMode(_powerMode);
+    }
+    if (!block) {
+        return status();
+    }
     // Enable CYW43 event debugging (make sure Debug Port is set)
     //cyw43_state.trace_flags = 0xffff;
     while (!_calledESP && ((millis() - start < (uint32_t)2 * _timeout)) && !connected()) {
         delay(10);
     }
+    _reconnectService();
     return status();
 }
 
@@ -145,7 +210,12 @@ uint8_t WiFiClass::beginAP(const char *ssid, const char* passphrase) {
         // OOM
         return WL_IDLE_STATUS;
     }
-    dhcp_server_init(_dhcpServer, gw, mask);
+    if (!dhcp_server_init_n(_dhcpServer, gw, mask, _dhcpLeases)) {
+        free(_dhcpServer);
+        _dhcpServer = nullptr;
+        return WL_IDLE_STATUS;
+    }
+    _loadLeases();
 
     _wifiHWInitted = true;
 
@@ -153,6 +223,156 @@ uint8_t WiFiClass::beginAP(const char *ssid, const char* passphrase) {
 }
 #endif
 
+void WiFiClass::_loadLeases() {
+    if (!_leaseFS) {
+        return;
+    }
+    File f = _leaseFS->open(_leasePath, "r");
+    if (!f) {
+        return;
+    }
+    size_t len = f.size();
+    uint8_t *macs = (uint8_t *)malloc(len);
+    if (macs && (f.read(macs, len) == len)) {
+        LWIPMutex m;
+        dhcp_server_set_bindings(_dhcpServer, macs, len / 6);
+    }
+    free(macs);
+    f.close();
+}
+
+void WiFiClass::_dhcpService() {
+    if (!_dhcpServer || !_leaseFS || !_dhcpServer->changed) {
+        return;
+    }
+    size_t len = _dhcpServer->lease_count * 6;
+    uint8_t *macs = (uint8_t *)malloc(len);
+    if (!macs) {
+        return;
+    }
+    {
+        LWIPMutex m;
+        _dhcpServer->changed = false;
+        dhcp_server_get_bindings(_dhcpServer, macs, _dhcpServer->lease_count);
+    }
+    File f = _leaseFS->open(_leasePath, "w");
+    if (f) {
+        if (f.write(macs, len) != len) {
+            _dhcpServer->changed = true; // Try again later
+        }
+        f.close();
+    }
+    free(macs);
+}
+
+void WiFiClass::setFastReconnect(bool enable) {
+    _fastReconnect = enable;
+    if (!enable) {
+        _reconnect.magic = 0;
+    }
+}
+
+// Fills _reconnect with the record for the network being joined, from RAM or the file
+bool WiFiClass::_loadReconnect() {
+    auto valid = [this]() {
+        return (_reconnect.magic == RECONNECT_MAGIC) && (_reconnect.check == _reconnectCheck(&_reconnect)) && (_reconnect.network == _network);
+    };
+    if (valid()) {
+        return true;
+    }
+    if (!_reconnectFS) {
+        return false;
+    }
+    File f = _reconnectFS->open(_reconnectPath, "r");
+    if (!f) {
+        return false;
+    }
+    bool ok = (f.read((uint8_t *)&_reconnect, sizeof(_reconnect)) == sizeof(_reconnect)) && valid();
+    f.close();
+    if (!ok) {
+        _reconnect.magic = 0;
+    }
+    return ok;
+}
+
+void WiFiClass::_saveReconnect() {
+    FastReconnect r = {};
+    if (!CYW43::linkInfo(r.bssid, &r.channel)) {
+        return;
+    }
+    r.magic = RECONNECT_MAGIC;
+    r.network = _network;
+    {
+        LWIPMutex m;
+        netif *n = _wifi.getNetIf();
+        struct dhcp *d = netif_dhcp_data(n);
+        if (d && (d->state == DHCP_STATE_BOUND)) {
+            r.ip = ip4_addr_get_u32(netif_ip4_addr(n));
+        }
+    }
+    r.check = _reconnectCheck(&r);
+    _reconnectSaved = true;
+    if (!memcmp(&r, &_reconnect, sizeof(r))) {
+        return;
+    }
+    _reconnect = r;
+    // Flash only sees a write when the AP or address actually changes
+    if (_reconnectFS) {
+        File f = _reconnectFS->open(_reconnectPath, "w");
+        if (f) {
+            f.write((const uint8_t *)&r, sizeof(r));
+            f.close();
+        }
+    }
+}
+
+void WiFiClass::_forgetReconnect() {
+    _reconnect.magic = 0;
+    if (_reconnectFS) {
+        _reconnectFS->remove(_reconnectPath);
+    }
+}
+
+// Puts the just started DHCP client into INIT-REBOOT, asking for the last lease's address
+// with a single REQUEST instead of going through DISCOVER and OFFER.  lwIP falls back to
+// a DISCOVER by itself on a NAK or no answer.
+void WiFiClass::_rebootDHCP(uint32_t ip) {
+    LWIPMutex m;
+    netif *n = _wifi.getNetIf();
+    struct dhcp *d = netif_dhcp_data(n);
+    if (!d || (d->state == DHCP_STATE_BOUND)) {
+        return;
+    }
+    ip4_addr_set_u32(&d->offered_ip_addr, ip);
+    d->state = DHCP_STATE_REBOOTING;
+    d->tries = 0;
+    // Otherwise the link up at the end of the join starts it
+    if (netif_is_link_up(n)) {
+        dhcp_network_changed(n);
+    }
+}
+
+void WiFiClass::_reconnectService() {
+    if (_apMode || !_wifiHWInitted) {
+        return;
+    }
+    if (_directPending) {
+        int link = cyw43_wifi_link_status(&cyw43_state, 0);
+        if (link < 0) {
+            // The remembered AP has moved channel or gone, look for the network instead
+            _directPending = false;
+            _forgetReconnect();
+            _wifi.rejoin();
+            return;
+        } else if (link == CYW43_LINK_JOIN) {
+            _directPending = false;
+        }
+    }
+    if (_fastReconnect && !_reconnectSaved && connected()) {
+        _saveReconnect();
+    }
+}
+
 bool WiFiClass::connected() {
     return (_apMode && _wifiHWInitted) || (_wifi.connected() && localIP().isSet() && (cyw43_wifi_link_status(&cyw43_state, _apMode ? 1 : 0) == CYW43_LINK_JOIN));
 }
@@ -236,6 +456,7 @@ const char *WiFiClass::getHostname() {
 */
 int WiFiClass::disconnect(void) {
     if (_dhcpServer) {
+        _dhcpService(); // Save any last lease changes
         dhcp_server_deinit(_dhcpServer);
         free(_dhcpServer);
         _dhcpServer = nullptr;
@@ -311,8 +532,10 @@ const char* WiFiClass::SSID() {
     return: pointer to uint8_t array with length WL_MAC_ADDR_LENGTH
 */
 uint8_t* WiFiClass::BSSID(uint8_t* bssid) {
-    // TODO - driver does not return this?!
-    memset(bssid, 0xee, WL_MAC_ADDR_LENGTH);
+    uint8_t channel;
+    if (_apMode || !_wifiHWInitted || !CYW43::linkInfo(bssid, &channel)) {
+        memset(bssid, 0, WL_MAC_ADDR_LENGTH);
+    }
     return bssid;
 }
 
@@ -327,6 +550,14 @@ int32_t WiFiClass::RSSI() {
     return 0;
 }
 
+LwipIntf::IntfStats WiFiClass::intfStats() {
+    return _wifi.intfStats();
+}
+
+netif* WiFiClass::getNetIf() {
+    return _wifi.getNetIf();
+}
+
 /*
     Return the Encryption Type associated with the network
 
@@ -366,6 +597,10 @@ int WiFiClass::_scanCB(void *env, const cyw43_ev_scan_result_t *result) {
     return: Number of discovered networks
 */
 int8_t WiFiClass::scanNetworks() {
+    return scanNetworks(false);
+}
+
+bool WiFiClass::_startScan() {
     cyw43_wifi_scan_options_t scan_options;
     memset(&scan_options, 0, sizeof(scan_options));
     _scan.clear();
@@ -374,17 +609,57 @@ int8_t WiFiClass::scanNetworks() {
         cyw43_arch_enable_sta_mode();
         _wifiHWInitted = true;
     }
-    int err = cyw43_wifi_scan(&cyw43_state, &scan_options, this, _scanCB);
-    if (err) {
-        return 0;
+    _scanStart = millis();
+    _scanning = !cyw43_wifi_scan(&cyw43_state, &scan_options, this, _scanCB);
+    return _scanning;
+}
+
+int8_t WiFiClass::scanNetworks(bool async) {
+    if (!_startScan()) {
+        return async ? WIFI_SCAN_FAILED : 0;
     }
-    uint32_t now = millis();
-    while (cyw43_wifi_scan_active(&cyw43_state) && (millis() - now < 10000)) {
+    if (async) {
+        return WIFI_SCAN_RUNNING;
+    }
+    while (scanComplete() == WIFI_SCAN_RUNNING) {
         delay(10);
     }
     return _scan.size();
 }
 
+void WiFiClass::scanNetworksAsync(ScanCallback onComplete) {
+    // A failed start still reports (0 networks) through the callback
+    _startScan();
+    _scanDone = onComplete;
+}
+
+int8_t WiFiClass::scanComplete() {
+    if (_scanning && (!cyw43_wifi_scan_active(&cyw43_state) || (millis() - _scanStart >= WIFI_SCAN_TIMEOUT))) {
+        _scanning = false;
+    }
+    return _scanning ? WIFI_SCAN_RUNNING : (int8_t)_scan.size();
+}
+
+void WiFiClass::scanDelete() {
+    if (!_scanning) {
+        _scan.clear();
+    }
+}
+
+// Called between loop() iterations to run the scan completion callback and power boost
+void __wifiService() {
+    WiFi._powerService();
+    CYW43::multicastService();
+    WiFi._dhcpService();
+    WiFi._reconnectService();
+    NTP._service();
+    if (WiFi._scanDone && (WiFi.scanComplete() != WIFI_SCAN_RUNNING)) {
+        auto cb = WiFi._scanDone;
+        WiFi._scanDone = nullptr;
+        cb(WiFi._scan.size());
+    }
+}
+
 /*
     Return the SSID discovered during the network scan.
 
@@ -516,11 +791,45 @@ unsigned long WiFiClass::getTime() {
 }
 
 void WiFiClass::lowPowerMode() {
-    cyw43_wifi_pm(&cyw43_state, CYW43_AGGRESSIVE_PM);
+    setPowerMode(WIFI_PM_LOWPOWER);
 }
 
 void WiFiClass::noLowPowerMode() {
-    cyw43_wifi_pm(&cyw43_state, CYW43_DEFAULT_PM);
+    setPowerMode(WIFI_PM_BALANCED);
+}
+
+void WiFiClass::setPowerMode(WiFiPowerMode mode) {
+    _powerMode = mode;
+    _boosted = false;
+    _applyPowerMode(mode);
+}
+
+void WiFiClass::_applyPowerMode(WiFiPowerMode mode) {
+    switch (mode) {
+    case WIFI_PM_PERFORMANCE:
+        cyw43_wifi_pm(&cyw43_state, cyw43_pm_value(CYW43_NO_POWERSAVE_MODE, 200, 1, 1, 10));
+        break;
+    case WIFI_PM_LOWPOWER:
+        cyw43_wifi_pm(&cyw43_state, CYW43_AGGRESSIVE_PM);
+        break;
+    default:
+        cyw43_wifi_pm(&cyw43_state, CYW43_DEFAULT_PM);
+        break;
+    }
+}
+
+// Changing the mode is a bus transaction which can't be done from inside the driver's
+// packet callbacks, so the shim just notes the time of the last frame and this runs
+// from loop() to follow it
+void WiFiClass::_powerService() {
+    if (!_boostIdle || (_powerMode == WIFI_PM_PERFORMANCE) || _apMode || !_wifiHWInitted) {
+        return;
+    }
+    bool busy = millis() - CYW43::_lastTraffic < _boostIdle;
+    if (busy != _boosted) {
+        _boosted = busy;
+        _applyPowerMode(busy ? WIFI_PM_PERFORMANCE : _powerMode);
+    }
 }
 
 int WiFiClass::ping(const char* hostname, uint8_t ttl) {
@@ -27,9 +27,12 @@
 
 #include <inttypes.h>
 #include <map>
+#include <functional>
 
 #include <cyw43.h>
 #include "dhcpserver/dhcpserver.h"
+#include <FS.h>
+#include <LwipIntf.h>
 
 #define WIFI_FIRMWARE_LATEST_VERSION PICO_SDK_VERSION_STRING
 
@@ -37,6 +40,16 @@ typedef void(*FeedHostProcessorWatchdogFuncPointer)();
 
 typedef enum { WIFI_STA, WIFI_AP, WIFI_OFF } _wifiModeESP; // For ESP8266 compatibility
 
+// scanComplete() results, matching the ESP8266
+#define WIFI_SCAN_RUNNING   (-1)
+#define WIFI_SCAN_FAILED    (-2)
+
+// Longest a scan is waited for before taking whatever has been found
+#define WIFI_SCAN_TIMEOUT   10000
+
+// STA power saving, from always awake to sleeping through most beacons
+typedef enum { WIFI_PM_PERFORMANCE, WIFI_PM_BALANCED, WIFI_PM_LOWPOWER } WiFiPowerMode;
+
 class WiFiClass {
 public:
     WiFiClass();
@@ -74,6 +87,12 @@ public:
     */
     int begin(const char* ssid, const char *passphrase);
 
+    /*  Start the same connection as begin() but return immediately, without waiting
+        for the join or DHCP.  Poll status() or connected() to follow its progress.
+        The strings must remain valid until the connection is made.
+    */
+    int beginNoBlock(const char* ssid, const char *passphrase = nullptr);
+
     bool connected();
     int8_t waitForConnectResult(unsigned long timeoutLength = 60000) {
         uint32_t now = millis();
@@ -121,6 +140,43 @@ public:
 
     uint8_t softAPgetStationNum();
 
+    /*
+        Number of addresses the AP mode DHCP server hands out, starting at .16
+        (default 8, at most 239).  Takes effect on the next beginAP().
+    */
+    void setDHCPLeases(size_t count) {
+        _dhcpLeases = count;
+    }
+
+    /*
+        Keep the AP mode DHCP lease table in a file (e.g. on LittleFS) so clients
+        get their old addresses back after a reboot.  The file is read by beginAP()
+        and rewritten from the main loop whenever a client is bound or released.
+    */
+    void setDHCPLeaseFile(FS &fs, const char *path) {
+        _leaseFS = &fs;
+        _leasePath = path;
+    }
+
+    /*
+        Remember the AP, channel and DHCP address each station connection ends up
+        with, so the next begin() to the same network joins that AP without scanning
+        and asks for the same address again with a single DHCP REQUEST.  The record
+        is kept in RAM, which survives a reboot or watchdog wake but not a power
+        cycle.  On by default.
+    */
+    void setFastReconnect(bool enable);
+
+    /*
+        Also keep the fast reconnect record in a file (e.g. on LittleFS), for
+        devices which are powered off between connections.  It is only rewritten
+        when the AP, channel or address changes.
+    */
+    void setFastReconnectFile(FS &fs, const char *path) {
+        _reconnectFS = &fs;
+        _reconnectPath = path;
+    }
+
     IPAddress softAPIP() {
         return localIP();
     }
@@ -267,6 +323,21 @@ public:
     */
     int32_t RSSI();
 
+    /*
+        Return the frame and byte counters for the WiFi interface.  Stack-wide
+        counters (pbuf pool use, TCP retransmits, ...) are in LwipIntf::stats()
+
+        return: LwipIntf::IntfStats
+    */
+    LwipIntf::IntfStats intfStats();
+
+    /*
+        Return the lwIP interface, for LwipIntf::addRoute() and friends
+
+        return: netif pointer
+    */
+    netif* getNetIf();
+
     /*
         Return the Encryption Type associated with the network
 
@@ -281,6 +352,33 @@ public:
     */
     int8_t scanNetworks();
 
+    /*
+        Start scan WiFi networks available, optionally without waiting for it
+
+        return: Number of discovered networks, or WIFI_SCAN_RUNNING when async
+    */
+    int8_t scanNetworks(bool async);
+
+    /*
+        Start a scan in the background and return immediately.  Once it's finished
+        onComplete is called with the number of networks found, from the main
+        loop() context between iterations (not from an interrupt).
+    */
+    typedef std::function<void(int)> ScanCallback;
+    void scanNetworksAsync(ScanCallback onComplete);
+
+    /*
+        Check on a scan started with scanNetworks(true) or scanNetworksAsync()
+
+        return: WIFI_SCAN_RUNNING, or the number of discovered networks
+    */
+    int8_t scanComplete();
+
+    /*
+        Free the results of the last scan
+    */
+    void scanDelete();
+
     /*
         Return the SSID discovered during the network scan.
 
@@ -337,11 +435,70 @@ public:
     }
     int hostByName(const char* aHostname, IPAddress& aResult, int timeout);
 
+    /*
+        Start resolving the hostname without waiting for the answer.
+        return: a handle to poll with hostByNameResult(), or -1 if no lookup slot is free
+    */
+    int hostByNameAsync(const char* aHostname) {
+        return LwipIntf::hostByNameAsync(aHostname);
+    }
+
+    /*
+        return: -1 while the lookup is running, 1 with aResult filled in, or 0 if it failed.
+                The handle is freed once a result is returned, or by hostByNameCancel()
+    */
+    int hostByNameResult(int handle, IPAddress& aResult) {
+        return LwipIntf::hostByNameResult(handle, aResult);
+    }
+
+    void hostByNameCancel(int handle) {
+        LwipIntf::hostByNameCancel(handle);
+    }
+
+    /*
+        Start resolving the hostname and call cb with the answer, straight away if cached.
+        return: false if no lookup slot is free
+    */
+    bool hostByNameAsync(const char* aHostname, LwipIntf::DNSCBType cb) {
+        return LwipIntf::hostByNameAsync(aHostname, std::move(cb));
+    }
+
+    /*
+        How long looked up names (foundMS) and failed lookups (failedMS) are remembered,
+        0 to not cache them.  Clears the cache.
+    */
+    void dnsCacheTTL(uint32_t foundMS, uint32_t failedMS) {
+        LwipIntf::dnsCacheTTL(foundMS, failedMS);
+    }
+
+    void dnsCacheClear() {
+        LwipIntf::dnsCacheClear();
+    }
+
     unsigned long getTime();
 
     void lowPowerMode();
     void noLowPowerMode();
 
+    /*
+        Select the power saving used while connected as a station.  BALANCED is the
+        driver default.  The mode is kept across begin() calls.
+    */
+    void setPowerMode(WiFiPowerMode mode);
+    WiFiPowerMode getPowerMode() {
+        return _powerMode;
+    }
+
+    /*
+        With a non-zero idleMs, any packet sent or received switches the radio to
+        PERFORMANCE until there's been no traffic for idleMs, then back to the
+        selected mode.  Bursts (uploads, request/response exchanges) then avoid the
+        power save wakeup latency while the link still sleeps when idle.  0 disables.
+    */
+    void setPowerBoost(uint32_t idleMs) {
+        _boostIdle = idleMs;
+    }
+
     int ping(const char* hostname, uint8_t ttl = 128);
     int ping(const String &hostname, uint8_t ttl = 128);
     int ping(IPAddress host, uint8_t ttl = 128);
@@ -358,12 +515,44 @@ private:
     bool _wifiHWInitted = false;
     bool _apMode = false;
 
+    int _beginSTA(const char* ssid, const char *passphrase, bool block);
+
     // WiFi Scan callback
     std::map<uint64_t, cyw43_ev_scan_result_t> _scan;
     static int _scanCB(void *env, const cyw43_ev_scan_result_t *result);
+    bool _startScan();
+    bool _scanning = false;
+    uint32_t _scanStart;
+    ScanCallback _scanDone = nullptr;
+    friend void __wifiService();
+
+    // Power management
+    WiFiPowerMode _powerMode = WIFI_PM_BALANCED;
+    uint32_t _boostIdle = 0;
+    bool _boosted = false;
+    void _applyPowerMode(WiFiPowerMode mode);
+    void _powerService();
 
     // DHCP for AP mode
     dhcp_server_t *_dhcpServer = nullptr;
+    size_t _dhcpLeases = DHCPS_MAX_IP;
+    FS *_leaseFS = nullptr;
+    String _leasePath;
+    void _loadLeases();
+    void _dhcpService();
+
+    // Fast reconnect
+    bool _fastReconnect = true;
+    bool _reconnectSaved = false;
+    bool _directPending = false; // A non-blocking join to a remembered AP is under way
+    uint32_t _network = 0;       // Hash of the SSID and password being joined
+    FS *_reconnectFS = nullptr;
+    String _reconnectPath;
+    bool _loadReconnect();
+    void _saveReconnect();
+    void _forgetReconnect();
+    void _rebootDHCP(uint32_t ip);
+    void _reconnectService();
 
     // ESP compat
     bool _calledESP = false; // Should we behave like the ESP8266 for connect?
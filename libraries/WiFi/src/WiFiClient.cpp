@@ -77,6 +77,7 @@ WiFiClient::WiFiClient(ClientContext* client)
 
 WiFiClient::~WiFiClient() {
     WiFiClient::_remove(this);
+    LwipIntf::hostByNameCancel(_dnsHandle);
     if (_client) {
         _client->unref();
     }
@@ -124,11 +125,53 @@ int WiFiClient::connect(const String& host, uint16_t port) {
 }
 
 int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    return _connect(ip, port, false);
+}
+
+int WiFiClient::connectAsync(IPAddress ip, uint16_t port) {
+    return _connect(ip, port, true);
+}
+
+int WiFiClient::connectAsync(const char* host, uint16_t port) {
+    if (_client) {
+        stop();
+        _client->unref();
+        _client = nullptr;
+    }
+    LwipIntf::hostByNameCancel(_dnsHandle);
+    _dnsHandle = LwipIntf::hostByNameAsync(host);
+    if (_dnsHandle < 0) {
+        return 0;
+    }
+    _dnsPort = port;
+    _dnsStart = millis();
+    return 1;
+}
+
+bool WiFiClient::connectPending() {
+    if (_dnsHandle >= 0) {
+        IPAddress ip;
+        int r = LwipIntf::hostByNameResult(_dnsHandle, ip);
+        if (r < 0) {
+            if (millis() - _dnsStart < _timeout) {
+                return true;
+            }
+            LwipIntf::hostByNameCancel(_dnsHandle);
+        }
+        _dnsHandle = -1;
+        return (r > 0) && _connect(ip, _dnsPort, true);
+    }
+    return _client && _client->connectPending();
+}
+
+int WiFiClient::_connect(IPAddress ip, uint16_t port, bool async) {
     if (_client) {
         stop();
         _client->unref();
         _client = nullptr;
     }
+    LwipIntf::hostByNameCancel(_dnsHandle);
+    _dnsHandle = -1;
 
     LWIPMutex m;  // Block the timer sys_check_timeouts call
 
@@ -144,7 +187,7 @@ int WiFiClient::connect(IPAddress ip, uint16_t port) {
     _client = new ClientContext(pcb, nullptr, nullptr);
     _client->ref();
     _client->setTimeout(_timeout);
-    int res = _client->connect(ip, port);
+    int res = async ? _client->connectAsync(ip, port) : _client->connect(ip, port);
     if (res == 0) {
         _client->unref();
         _client = nullptr;
@@ -201,12 +244,23 @@ size_t WiFiClient::write(const uint8_t *buf, size_t size) {
     return _client->write((const char*)buf, size);
 }
 
+size_t WiFiClient::writeStatic(const void *buf, size_t size, WiFiClientReleaseCB release, void *arg) {
+    if (!_client) {
+        if (release) {
+            release(arg);
+        }
+        return 0;
+    }
+    _client->setTimeout(_timeout);
+    return _client->writeStatic((const char*)buf, size, release, arg);
+}
+
 size_t WiFiClient::write(Stream& stream) {
     if (!_client || !stream.available()) {
         return 0;
     }
-    _client->setTimeout(_timeout);
-    return _client->write(stream);
+    // Only what's already there, pushed in availableForWrite() sized chunks
+    return stream.sendAll(*this, (size_t) -1, 0);
 }
 
 int WiFiClient::available() {
@@ -276,6 +330,8 @@ bool WiFiClient::flush(unsigned int maxWaitMs) {
 }
 
 bool WiFiClient::stop(unsigned int maxWaitMs) {
+    LwipIntf::hostByNameCancel(_dnsHandle);
+    _dnsHandle = -1;
     if (!_client) {
         return true;
     }
@@ -383,27 +439,29 @@ uint8_t WiFiClient::getKeepAliveCount() const {
     return _client->getKeepAliveCount();
 }
 
-//bool WiFiClient::hasPeekBufferAPI () const
-//{
-//    return true;
-//}
+bool WiFiClient::hasPeekBufferAPI() const {
+    return true;
+}
 
 // return a pointer to available data buffer (size = peekAvailable())
 // semantic forbids any kind of read() before calling peekConsume()
-//const char* WiFiClient::peekBuffer ()
-//{
-//    return _client? _client->peekBuffer(): nullptr;
-//}
+const char* WiFiClient::peekBuffer() {
+    return _client ? _client->peekBuffer() : nullptr;
+}
 
 // return number of byte accessible by peekBuffer()
-//size_t WiFiClient::peekAvailable ()
-//{
-//    return _client? _client->peekAvailable(): 0;
-//}
+size_t WiFiClient::peekAvailable() {
+    return _client ? _client->peekAvailable() : 0;
+}
+
+// zero-copy views over the whole received pbuf chain
+size_t WiFiClient::peekSegments(WiFiClientSegment *segs, size_t maxSegs) {
+    return _client ? _client->peekSegments(segs, maxSegs) : 0;
+}
 
 // consume bytes after use (see peekBuffer)
-//void WiFiClient::peekConsume (size_t consume)
-//{
-//    if (_client)
-//        _client->peekConsume(consume);
-//}
+void WiFiClient::peekConsume(size_t consume) {
+    if (_client) {
+        _client->peekConsume(consume);
+    }
+}
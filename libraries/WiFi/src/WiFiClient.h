@@ -42,6 +42,15 @@
 class ClientContext;
 class WiFiServer;
 
+// One contiguous span of received data, see WiFiClient::peekSegments()
+typedef struct {
+    const char *data;
+    size_t len;
+} WiFiClientSegment;
+
+// Called once a buffer passed to WiFiClient::writeStatic() is no longer referenced
+typedef void (*WiFiClientReleaseCB)(void *arg);
+
 class WiFiClient : public Client, public SList<WiFiClient> {
 protected:
     WiFiClient(ClientContext* client);
@@ -68,9 +77,19 @@ public:
     virtual int connect(IPAddress ip, uint16_t port) override;
     virtual int connect(const char *host, uint16_t port) override;
     virtual int connect(const String& host, uint16_t port);
+    // Start connecting (and resolving the host) and return at once.  Poll connectPending()
+    // until it returns false, then connected() tells whether it worked.  The lookup and the
+    // connection each time out after getTimeout() ms.  TLS clients don't support this.
+    virtual int connectAsync(IPAddress ip, uint16_t port);
+    virtual int connectAsync(const char *host, uint16_t port);
+    bool connectPending();
     virtual size_t write(uint8_t) override;
     virtual size_t write(const uint8_t *buf, size_t size) override;
     size_t write(Stream& stream);
+    // Zero-copy write, the data is sent straight from buf so it must stay unchanged until
+    // acknowledged by the peer: use for flash/const data, or pass a release callback which
+    // will be called (from the network context) once buf may be reused or freed
+    virtual size_t writeStatic(const void *buf, size_t size, WiFiClientReleaseCB release = nullptr, void *arg = nullptr);
 
     virtual int available() override;
     virtual int read() override;
@@ -139,20 +158,27 @@ public:
     void setSync(bool sync);
 
     // peek buffer API is present
-    //virtual bool hasPeekBufferAPI () const override;
+    virtual bool hasPeekBufferAPI() const override;
 
     // return number of byte accessible by peekBuffer()
-    //virtual size_t peekAvailable () override;
+    virtual size_t peekAvailable() override;
 
     // return a pointer to available data buffer (size = peekAvailable())
     // semantic forbids any kind of read() before calling peekConsume()
-    //virtual const char* peekBuffer () override;
+    virtual const char* peekBuffer() override;
+
+    // fill segs[] with up to maxSegs zero-copy views of all received data (the whole
+    // pbuf chain, not just the current buffer), returns # of segments filled
+    // semantic forbids any kind of read() before calling peekConsume()
+    virtual size_t peekSegments(WiFiClientSegment *segs, size_t maxSegs);
 
-    // consume bytes after use (see peekBuffer)
-    //virtual void peekConsume (size_t consume) override;
+    // consume bytes after use (see peekBuffer/peekSegments), may span segments
+    virtual void peekConsume(size_t consume) override;
 
     //virtual bool outputCanTimeout () override { return connected(); }
-    //virtual bool inputCanTimeout () override { return connected(); }
+    virtual bool inputCanTimeout() override {
+        return connected();
+    }
 
 protected:
 
@@ -162,7 +188,14 @@ protected:
     int8_t _connected(void* tpcb, int8_t err);
     void _err(int8_t err);
 
+    int _connect(IPAddress ip, uint16_t port, bool async);
+
     ClientContext* _client;
     WiFiClient* _owned;
     static uint16_t _localPort;
+
+    // connectAsync(host) lookup in progress, never shared with copies
+    int _dnsHandle = -1;
+    uint16_t _dnsPort = 0;
+    uint32_t _dnsStart = 0;
 };
@@ -61,10 +61,6 @@
 #define DEBUG_BSSL(...)
 #endif
 
-extern "C" uint32_t __picoRand() {
-    return rp2040.hwrand32();
-}
-
 namespace BearSSL {
 
 void WiFiClientSecureCtx::_clear() {
@@ -87,6 +83,10 @@ void WiFiClientSecureCtx::_clear() {
     _recvapp_len = 0;
     _oom_err = false;
     _session = nullptr;
+    _clientSessions = nullptr;
+    _sessionKey = 0;
+    _mfln_len = 0;
+    _offload_handshake = false;
     _cipher_list = nullptr;
     _cipher_cnt = 0;
     _tls_min = BR_TLS10;
@@ -125,9 +125,22 @@ WiFiClientSecureCtx::~WiFiClientSecureCtx() {
     }
     _cipher_list = nullptr; // std::shared will free if last reference
     _freeSSL();
+    setOffloadHandshake(false);
     stack_thunk_del_ref();
 }
 
+void WiFiClientSecureCtx::setOffloadHandshake(bool enable) {
+    if (enable == _offload_handshake) {
+        return;
+    }
+    if (enable) {
+        stack_thunk_core1_add_ref();
+    } else {
+        stack_thunk_core1_del_ref();
+    }
+    _offload_handshake = enable;
+}
+
 WiFiClientSecureCtx::WiFiClientSecureCtx(ClientContext* client,
         const X509List *chain, const PrivateKey *sk,
         int iobuf_in_size, int iobuf_out_size, ServerSessions *cache,
@@ -231,7 +244,30 @@ bool WiFiClientSecureCtx::flush(unsigned int maxWaitMs) {
     return WiFiClient::flush(maxWaitMs);
 }
 
+// Pick the cache entry and, if requested, receive buffer size for a new connection
+void WiFiClientSecureCtx::_prepareConnect(const char *host, IPAddress ip, uint16_t port) {
+    _sessionKey = ClientSessions::key(host ? host : IPAddressString(ip).c_str(), port);
+    if (!_mfln_len) {
+        return;
+    }
+    ClientSessions::Entry *e = _clientSessions ? _clientSessions->insert(_sessionKey) : nullptr;
+    bool mfln;
+    if (e && (e->mfln >= 0) && (e->mflnLen == _mfln_len)) {
+        mfln = e->mfln > 0;
+    } else {
+        mfln = WiFiClientSecure::probeMaxFragmentLength(ip, port, _mfln_len);
+        DEBUG_BSSL("_prepareConnect: MFLN %d %ssupported\n", _mfln_len, mfln ? "" : "not ");
+        if (e) {
+            e->mfln = mfln ? 1 : 0;
+            e->mflnLen = _mfln_len;
+        }
+    }
+    // Transmit records can always be kept small, BearSSL splits them as needed
+    setBufferSizes(mfln ? _mfln_len : 16384, _mfln_len);
+}
+
 int WiFiClientSecureCtx::connect(IPAddress ip, uint16_t port) {
+    _prepareConnect(nullptr, ip, port);
     if (!WiFiClient::connect(ip, port)) {
         return 0;
     }
@@ -244,6 +280,7 @@ int WiFiClientSecureCtx::connect(const char* name, uint16_t port) {
         DEBUG_BSSL("connect: Name lookup failure\n");
         return 0;
     }
+    _prepareConnect(name, remote_addr, port);
     if (!WiFiClient::connect(remote_addr, port)) {
         DEBUG_BSSL("connect: Unable to connect TCP socket\n");
         return 0;
@@ -255,6 +292,15 @@ int WiFiClientSecureCtx::connect(const String& host, uint16_t port) {
     return connect(host.c_str(), port);
 }
 
+// Seeds the engine's HMAC-DRBG from the core's entropy pool before each handshake.  BearSSL
+// still adds its own system seed (__picoRand) on top.
+void WiFiClientSecureCtx::_injectEntropy() {
+    uint8_t seed[32];
+    rp2040.getEntropy(seed, sizeof(seed));
+    br_ssl_engine_inject_entropy(_eng, seed, sizeof(seed));
+    memset(seed, 0, sizeof(seed));
+}
+
 void WiFiClientSecureCtx::_freeSSL() {
     // These are smart pointers and will free if refcnt==0
     _sc = nullptr;
@@ -349,17 +395,25 @@ size_t WiFiClientSecureCtx::write(const uint8_t *buf, size_t size) {
     return _write(buf, size, false);
 }
 
+size_t WiFiClientSecureCtx::writeStatic(const void *buf, size_t size, WiFiClientReleaseCB release, void *arg) {
+    size_t ret = _write((const uint8_t *)buf, size, false);
+    if (release) {
+        release(arg);
+    }
+    return ret;
+}
+
 //size_t WiFiClientSecureCtx::write_P(PGM_P buf, size_t size) {
 //  return _write((const uint8_t *)buf, size, true);
 //}
 
-//size_t WiFiClientSecureCtx::write(Stream& stream) {
-//  if (!connected() || !_handshake_done) {
-//    DEBUG_BSSL("write: Connect/handshake not completed yet\n");
-//    return 0;
-//  }
-//  return stream.sendAll(this);
-//}
+size_t WiFiClientSecureCtx::write(Stream& stream) {
+    if (!connected() || !_handshake_done) {
+        DEBUG_BSSL("write: Connect/handshake not completed yet\n");
+        return 0;
+    }
+    return stream.sendAll(*this, (size_t) -1, 0);
+}
 
 int WiFiClientSecureCtx::read(uint8_t *buf, size_t size) {
     if (!ctx_present() || !_handshake_done) {
@@ -392,13 +446,22 @@ int WiFiClientSecureCtx::read(uint8_t *buf, size_t size) {
     }
     return 0; // If we're connected, no error but no read.
 }
-#if 0
 // return a pointer to available data buffer (size = peekAvailable())
 // semantic forbids any kind of read() before calling peekConsume()
 const char* WiFiClientSecureCtx::peekBuffer() {
     return (const char*)_recvapp_buf;
 }
 
+size_t WiFiClientSecureCtx::peekSegments(WiFiClientSegment *segs, size_t maxSegs) {
+    size_t len = peekAvailable();
+    if (!maxSegs || !len || !_recvapp_buf) {
+        return 0;
+    }
+    segs[0].data = (const char *)_recvapp_buf;
+    segs[0].len = len;
+    return 1;
+}
+
 // consume bytes after use (see peekBuffer)
 void WiFiClientSecureCtx::peekConsume(size_t consume) {
     // according to WiFiClientSecureCtx::read:
@@ -406,7 +469,6 @@ void WiFiClientSecureCtx::peekConsume(size_t consume) {
     _recvapp_buf = nullptr;
     _recvapp_len = 0;
 }
-#endif
 int WiFiClientSecureCtx::read() {
     uint8_t c;
     if (1 == read(&c, 1)) {
@@ -472,6 +534,34 @@ size_t WiFiClientSecureCtx::peekBytes(uint8_t *buffer, size_t length) {
     combination of both (the combination matches either). When a match is
     achieved, this function returns 0. On error, it returns -1.
 */
+typedef struct {
+    br_ssl_engine_context *eng;
+    size_t len;
+} RecvrecAck;
+
+static uint32_t _recvrecAckCore1(void *arg) {
+    RecvrecAck *r = (RecvrecAck *)arg;
+    thunk_core1_br_ssl_engine_recvrec_ack(r->eng, r->len);
+    return 0;
+}
+
+// Handing a record to the engine is where all the handshake's validation and key exchange
+// math happens.  When offloading, that runs from core 1's FIFO IRQ on its own thunk stack.
+// A CertStore may need the filesystem to find the TA, so those are always done here.
+void WiFiClientSecureCtx::_recvrec_ack(size_t len) {
+    if (_offload_handshake && !_handshake_done && !_certStore && (get_core_num() == 0)) {
+        RecvrecAck r = { _eng, len };
+        CoreJob job;
+        if (rp2040.runOnCore(1, &job, _recvrecAckCore1, &r)) {
+            while (!job.done()) {
+                yield();
+            }
+            return;
+        }
+    }
+    br_ssl_engine_recvrec_ack(_eng, len);
+}
+
 int WiFiClientSecureCtx::_run_until(unsigned target, bool blocking) {
     if (!ctx_present()) {
         DEBUG_BSSL("_run_until: Not connected\n");
@@ -575,7 +665,7 @@ int WiFiClientSecureCtx::_run_until(unsigned target, bool blocking) {
                     return -1;
                 }
                 if (rlen > 0) {
-                    br_ssl_engine_recvrec_ack(_eng, rlen);
+                    _recvrec_ack(rlen);
                 }
                 no_work = 0;
                 continue;
@@ -1197,12 +1287,22 @@ bool WiFiClientSecureCtx::_connectSSL(const char* hostName) {
                                      _esp32_sk->getRSA(), br_rsa_pkcs1_sign_get_default());
     }
 
-    // Restore session from the storage spot, if present
+    // Restore session from the storage spot or the cache, if present
+    br_ssl_session_parameters *resume = nullptr;
     if (_session) {
-        br_ssl_engine_set_session_parameters(_eng, _session->getSession());
+        resume = _session->getSession();
+    } else if (_clientSessions && _sessionKey) {
+        ClientSessions::Entry *e = _clientSessions->find(_sessionKey);
+        if (e && e->valid) {
+            resume = &e->session;
+        }
+    }
+    if (resume) {
+        br_ssl_engine_set_session_parameters(_eng, resume);
     }
 
-    if (!br_ssl_client_reset(_sc.get(), hostName, _session ? 1 : 0)) {
+    _injectEntropy();
+    if (!br_ssl_client_reset(_sc.get(), hostName, resume ? 1 : 0)) {
         _freeSSL();
         DEBUG_BSSL("_connectSSL: Can't reset client\n");
         return false;
@@ -1219,6 +1319,17 @@ bool WiFiClientSecureCtx::_connectSSL(const char* hostName) {
     }
 #endif
 
+    // Save the (possibly new) session right away, the connection may never be stop()ed cleanly
+    if (!_session && _clientSessions && _sessionKey) {
+        ClientSessions::Entry *e = ret ? _clientSessions->insert(_sessionKey) : _clientSessions->find(_sessionKey);
+        if (e) {
+            if (ret) {
+                br_ssl_engine_get_session_parameters(_eng, &e->session);
+            }
+            e->valid = ret;
+        }
+    }
+
     // Session is already validated here, there is no need to keep following
     _x509_minimal = nullptr;
     _x509_insecure = nullptr;
@@ -1301,6 +1412,7 @@ bool WiFiClientSecureCtx::_connectSSLServerRSA(const X509List *chain,
         DEBUG_BSSL("_connectSSLServerRSA: Can't install serverX509check\n");
         return false;
     }
+    _injectEntropy();
     if (!br_ssl_server_reset(_sc_svr.get())) {
         _freeSSL();
         DEBUG_BSSL("_connectSSLServerRSA: Can't reset server ctx\n");
@@ -1346,6 +1458,7 @@ bool WiFiClientSecureCtx::_connectSSLServerEC(const X509List *chain,
         DEBUG_BSSL("_connectSSLServerEC: Can't install serverX509check\n");
         return false;
     }
+    _injectEntropy();
     if (!br_ssl_server_reset(_sc_svr.get())) {
         _freeSSL();
         DEBUG_BSSL("_connectSSLServerEC: Can't reset server ctx\n");
@@ -49,9 +49,22 @@ public:
     int connect(IPAddress ip, uint16_t port) override;
     int connect(const String& host, uint16_t port) override;
     int connect(const char* name, uint16_t port) override;
+    // The handshake needs the connection up front, so no async connects
+    int connectAsync(IPAddress ip, uint16_t port) override {
+        (void) ip;
+        (void) port;
+        return 0;
+    }
+    int connectAsync(const char* host, uint16_t port) override {
+        (void) host;
+        (void) port;
+        return 0;
+    }
 
     uint8_t connected() override;
     size_t write(const uint8_t *buf, size_t size) override;
+    // Records are encrypted into the TLS buffer, so this is a normal write()
+    size_t writeStatic(const void *buf, size_t size, WiFiClientReleaseCB release = nullptr, void *arg = nullptr) override;
     //    size_t write_P(PGM_P buf, size_t size) override;
     size_t write(Stream& stream); // Note this is not virtual
     int read(uint8_t *buf, size_t size) override;
@@ -78,6 +91,11 @@ public:
         _session = session;
     }
 
+    // Look up and store sessions by host and port in a shared cache (when no setSession)
+    void setSessionCache(ClientSessions *cache) {
+        _clientSessions = cache;
+    }
+
     // Don't validate the chain, just accept whatever is given.  VERY INSECURE!
     void setInsecure() {
         _clearAuthenticationSettings();
@@ -119,11 +137,20 @@ public:
     // Sets the requested buffer size for transmit and receive
     void setBufferSizes(int recv, int xmit);
 
+    // Ask for len byte records (512...4096) and size the receive buffer to match if the server
+    // supports MFLN, otherwise use the full 16KB.  Probes once per server when using a session cache.
+    void setMaxFragmentLength(uint16_t len) {
+        _mfln_len = len;
+    }
+
     // Returns whether MFLN negotiation for the above buffer sizes succeeded (after connection)
     int getMFLNStatus() {
         return connected() && br_ssl_engine_get_mfln_negotiated(_eng);
     }
 
+    // Run the handshake's public key crypto on core 1 while this core waits in yield()
+    void setOffloadHandshake(bool enable);
+
     // Return an error code and possibly a text string in a passed-in buffer with last SSL failure
     int getLastSSLError(char *dest = NULL, size_t len = 0);
 
@@ -141,7 +168,6 @@ public:
     // Limit the TLS versions BearSSL will connect with.  Default is
     // BR_TLS10...BR_TLS12
     bool setSSLVersion(uint32_t min = BR_TLS10, uint32_t max = BR_TLS12);
-#if 0
     // peek buffer API is present
     virtual bool hasPeekBufferAPI() const override {
         return true;
@@ -156,9 +182,11 @@ public:
     // semantic forbids any kind of read() before calling peekConsume()
     virtual const char* peekBuffer() override;
 
+    // decrypted data is always a single contiguous segment
+    virtual size_t peekSegments(WiFiClientSegment *segs, size_t maxSegs) override;
+
     // consume bytes after use (see peekBuffer)
     virtual void peekConsume(size_t consume) override;
-#endif
 
     // ESP32 compatibility
     void setCACert(const char *rootCA) {
@@ -284,6 +312,16 @@ private:
     // Will be used on connect and updated on close
     Session *_session;
 
+    // Optional per-server session cache, and this connection's key in it
+    ClientSessions *_clientSessions;
+    uint32_t _sessionKey;
+
+    // Automatic MFLN buffer sizing, 0 to use setBufferSizes as given
+    uint16_t _mfln_len;
+
+    // Process handshake records on core 1
+    bool _offload_handshake;
+
     bool _use_insecure;
     bool _use_fingerprint;
     uint8_t _fingerprint[20];
@@ -305,6 +343,9 @@ private:
     bool _clientConnected(); // Is the underlying socket alive?
     std::shared_ptr<unsigned char> _alloc_iobuf(size_t sz);
     void _freeSSL();
+    void _injectEntropy();
+    void _prepareConnect(const char *host, IPAddress ip, uint16_t port);
+    void _recvrec_ack(size_t len);
     int _run_until(unsigned target, bool blocking = true);
     size_t _write(const uint8_t *buf, size_t size, bool pmem);
     bool _wait_for_handshake(); // Sets and return the _handshake_done after connecting
@@ -390,6 +431,12 @@ public:
     int connect(const char* name, uint16_t port) override {
         return _ctx->connect(name, port);
     }
+    int connectAsync(IPAddress ip, uint16_t port) override {
+        return _ctx->connectAsync(ip, port);
+    }
+    int connectAsync(const char* host, uint16_t port) override {
+        return _ctx->connectAsync(host, port);
+    }
 
     uint8_t connected() override {
         return _ctx->connected();
@@ -397,6 +444,9 @@ public:
     size_t write(const uint8_t *buf, size_t size) override {
         return _ctx->write(buf, size);
     }
+    size_t writeStatic(const void *buf, size_t size, WiFiClientReleaseCB release = nullptr, void *arg = nullptr) override {
+        return _ctx->writeStatic(buf, size, release, arg);
+    }
     //size_t write_P(PGM_P buf, size_t size) override { return _ctx->write_P(buf, size); }
     size_t write(const char *buf) {
         return write((const uint8_t*)buf, strlen(buf));
@@ -441,6 +491,11 @@ public:
         _ctx->setSession(session);
     }
 
+    // Look up and store sessions by host and port in a shared cache (when no setSession)
+    void setSessionCache(ClientSessions *cache) {
+        _ctx->setSessionCache(cache);
+    }
+
     // Don't validate the chain, just accept whatever is given.  VERY INSECURE!
     void setInsecure() {
         _ctx->setInsecure();
@@ -484,11 +539,21 @@ public:
         _ctx->setBufferSizes(recv, xmit);
     }
 
+    // Ask for len byte records and size the receive buffer to match if the server supports MFLN
+    void setMaxFragmentLength(uint16_t len) {
+        _ctx->setMaxFragmentLength(len);
+    }
+
     // Returns whether MFLN negotiation for the above buffer sizes succeeded (after connection)
     int getMFLNStatus() {
         return _ctx->getMFLNStatus();
     }
 
+    // Run the handshake's public key crypto on core 1 while this core waits in yield()
+    void setOffloadHandshake(bool enable) {
+        _ctx->setOffloadHandshake(enable);
+    }
+
     // Return an error code and possibly a text string in a passed-in buffer with last SSL failure
     int getLastSSLError(char *dest = NULL, size_t len = 0) {
         return _ctx->getLastSSLError(dest, len);
@@ -521,7 +586,6 @@ public:
     static bool probeMaxFragmentLength(IPAddress ip, uint16_t port, uint16_t len);
     static bool probeMaxFragmentLength(const char *hostname, uint16_t port, uint16_t len);
     static bool probeMaxFragmentLength(const String& host, uint16_t port, uint16_t len);
-#if 0
     // peek buffer API is present
     virtual bool hasPeekBufferAPI() const override {
         return true;
@@ -538,11 +602,14 @@ public:
         return _ctx->peekBuffer();
     }
 
+    virtual size_t peekSegments(WiFiClientSegment *segs, size_t maxSegs) override {
+        return _ctx->peekSegments(segs, maxSegs);
+    }
+
     // consume bytes after use (see peekBuffer)
     virtual void peekConsume(size_t consume) override {
         return _ctx->peekConsume(consume);
     }
-#endif
 
     // ESP32 compatibility
     void setCACert(const char *rootCA) {
@@ -55,52 +55,93 @@ bool WiFiMulti::addAP(const char *ssid, const char *pass) {
     }
     DEBUGV("[WIFIMULTI] Adding: '%s' %s' to list\n", ap.ssid, ap.pass);
     _list.push_front(ap);
+    _seen.clear(); // Rescan so the new AP is considered
     return true;
 }
 
-uint8_t WiFiMulti::run(uint32_t to) {
+void WiFiMulti::_readScan() {
+    // Keep the best RSSI of each known SSID.  Probably more efficient searches, but the list
+    // of APs will have < 5 in > 99% of the cases so it's a don't care.
+    _seen.clear();
+    int cnt = WiFi.scanComplete();
+    for (int i = 0; i < cnt; i++) {
+        DEBUGV("[WIFIMULTI] Checking for '%s' at %d\n", WiFi.SSID(i), WiFi.RSSI(i));
+        for (auto j = _list.begin(); j != _list.end(); j++) {
+            if (strcmp(j->ssid, WiFi.SSID(i))) {
+                continue;
+            }
+            auto k = _seen.begin();
+            while ((k != _seen.end()) && (k->ap != &*j)) {
+                k++;
+            }
+            if (k == _seen.end()) {
+                _seen.push_back({ &*j, WiFi.RSSI(i) });
+            } else {
+                k->rssi = std::max(k->rssi, WiFi.RSSI(i));
+            }
+        }
+    }
+    std::sort(_seen.begin(), _seen.end(), [](const struct _Seen & a, const struct _Seen & b) {
+        return a.rssi > b.rssi;
+    });
+    _scanTime = millis();
+}
 
+uint8_t WiFiMulti::runAsync(uint32_t to) {
+    uint8_t status = WiFi.status();
     // If we're already connected, don't re-scan/etc.
-    if (WiFi.status() == WL_CONNECTED) {
+    if (status == WL_CONNECTED) {
+        _state = _IDLE;
         return WL_CONNECTED;
     }
 
-    int cnt = WiFi.scanNetworks();
-    if (!cnt) {
-        return WL_DISCONNECTED;
-    }
+    switch (_state) {
+    case _CONNECTING:
+        if ((status != WL_CONNECT_FAILED) && (millis() - _connectStart < to)) {
+            return WL_DISCONNECTED;
+        }
+        // Give up on this one, the next call tries the next strongest
+        DEBUGV("[WIFIMULTI] Connection to '%s' failed\n", _seen.front().ap->ssid);
+        _seen.erase(_seen.begin());
+        _state = _IDLE;
+        return WL_CONNECT_FAILED;
 
-    // Find the highest RSSI network in our list.  Probably more efficient searches, but the list
-    // of APs will have < 5 in > 99% of the cases so it's a don't care.
-    int maxRSSID = -999;
-    std::list<struct _AP>::iterator hit;
-    bool found = false;
-    for (int i = 0; i < cnt; i++) {
-        if (WiFi.RSSI(i) > maxRSSID) {
-            for (auto j = _list.begin(); j != _list.end(); j++) {
-                DEBUGV("[WIFIMULTI] Checking for '%s' at %d\n", WiFi.SSID(i), WiFi.RSSI(i));
-                if (!strcmp(j->ssid, WiFi.SSID(i))) {
-                    hit = j;
-                    maxRSSID = WiFi.RSSI(i);
-                    found = true;
-                }
+    case _SCANNING:
+        if (WiFi.scanComplete() == WIFI_SCAN_RUNNING) {
+            return WL_DISCONNECTED;
+        }
+        _readScan();
+        _state = _IDLE;
+        if (_seen.empty()) {
+            return WL_NO_SSID_AVAIL;
+        }
+        break;
+
+    case _IDLE:
+        if (_seen.empty() || (millis() - _scanTime >= _cacheTime)) {
+            if (WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING) {
+                _state = _SCANNING;
             }
+            return WL_DISCONNECTED;
         }
-    }
-    if (!found) {
-        return WL_DISCONNECTED;
+        break;
     }
 
     // Connect!
+    const struct _AP *hit = _seen.front().ap;
     DEBUGV("[WIFIMULTI] Connecting to '%s' and '%s'\n", hit->ssid, hit->pass);
-    uint32_t start = millis();
-    if (hit->pass) {
-        WiFi.begin(hit->ssid, hit->pass);
-    } else {
-        WiFi.begin(hit->ssid);
-    }
-    while (!WiFi.connected() && (millis() - start < to)) {
+    WiFi.beginNoBlock(hit->ssid, hit->pass);
+    _connectStart = millis();
+    _state = _CONNECTING;
+    return WL_DISCONNECTED;
+}
+
+uint8_t WiFiMulti::run(uint32_t to) {
+    // Drive the state machine through at most one scan and connection attempt
+    uint8_t status = runAsync(to);
+    while (_state != _IDLE) {
         delay(5);
+        status = runAsync(to);
     }
-    return WiFi.status();
+    return status == WL_NO_SSID_AVAIL ? WL_DISCONNECTED : status;
 }
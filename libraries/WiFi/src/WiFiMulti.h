@@ -22,6 +22,7 @@
 #pragma once
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "wl_definitions.h"
 
@@ -32,12 +33,39 @@ public:
 
     bool addAP(const char *ssid, const char *pass = NULL);
 
+    // Scans (unless the cached results are still fresh) and tries to connect to the
+    // strongest known AP, waiting up to "to" ms for the connection
     uint8_t run(uint32_t to = 10000);
 
+    // Non-blocking version of run(), to call from every loop().  Each call moves the
+    // background scan or connection attempt along and returns the current status.
+    // An AP which fails to connect within "to" ms is skipped in favor of the next
+    // strongest one, and a new scan is only started when none are left.
+    uint8_t runAsync(uint32_t to = 10000);
+
+    // How long scan results are reused for reconnecting, 0 to always rescan
+    void setScanCacheTime(uint32_t ms) {
+        _cacheTime = ms;
+    }
+
 private:
     struct _AP {
         char *ssid;
         char *pass;
     };
     std::list<struct _AP> _list;
+
+    // Known APs seen in the last scan, strongest first
+    struct _Seen {
+        const struct _AP *ap;
+        int32_t rssi;
+    };
+    std::vector<struct _Seen> _seen;
+    uint32_t _scanTime = 0;
+    uint32_t _cacheTime = 30000;
+
+    enum { _IDLE, _SCANNING, _CONNECTING } _state = _IDLE;
+    uint32_t _connectStart;
+
+    void _readScan();
 };
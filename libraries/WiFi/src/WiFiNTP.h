@@ -21,8 +21,12 @@
 
 #include <Arduino.h>
 #include <time.h>
+#include <functional>
 #include <lwip/apps/sntp.h>
 
+// From the core's clock discipline: NTP samples applied, last offset, and crystal drift estimate
+extern "C" uint32_t __getTimeSync(int64_t *offsetUs, int32_t *driftPPB);
+
 class NTPClass {
 public:
     NTPClass() { }
@@ -56,26 +60,53 @@ public:
         _running = true;
     }
 
+    // Names are looked up by SNTP itself on every poll, so these return immediately
     void begin(const char *server, int timeout = 3600) {
-        IPAddress addr;
-        if (WiFi.hostByName(server, addr)) {
-            begin(addr, timeout);
-        }
-        _running = true;
+        begin(server, nullptr, timeout);
     }
 
     void begin(const char *s1, const char *s2, int timeout = 3600) {
-        IPAddress a1, a2;
-        if (WiFi.hostByName(s1, a1)) {
-            if (WiFi.hostByName(s2, a2)) {
-                begin(a1, a2, timeout);
-            } else {
-                begin(a1, timeout);
-            }
+        (void) timeout;
+        sntp_stop();
+        _name[0] = s1 ? s1 : "";
+        _name[1] = s2 ? s2 : "";
+        for (int i = 0; i < 2; i++) {
+            sntp_setservername(i, _name[i].length() ? _name[i].c_str() : nullptr);
         }
+        sntp_setoperatingmode(SNTP_OPMODE_POLL);
+        sntp_init();
         _running = true;
     }
 
+    // Called from the main loop (never from the network stack) every time an NTP reply
+    // has been applied to the system clock, including the first one
+    typedef std::function<void(void)> SyncCallback;
+    void onSync(SyncCallback cb) {
+        _syncs = __getTimeSync(nullptr, nullptr);
+        _onSync = cb;
+    }
+
+    // Whether at least one NTP reply has set the clock
+    bool isSet() {
+        return __getTimeSync(nullptr, nullptr) > 0;
+    }
+
+    // Difference of the last NTP reply to the local clock, in microseconds.  Offsets up to
+    // 128ms are slewed in gradually so time never jumps, larger ones step the clock.
+    int64_t offset() {
+        int64_t o;
+        __getTimeSync(&o, nullptr);
+        return o;
+    }
+
+    // Estimated crystal frequency error which the clock is being corrected for, in parts per
+    // billion (positive when the crystal is slow).
+    int32_t drift() {
+        int32_t d;
+        __getTimeSync(nullptr, &d);
+        return d;
+    }
+
     bool waitSet(uint32_t timeout = 10000) {
         return waitSet(nullptr, timeout);
     }
@@ -91,7 +122,7 @@ public:
                 cb();
             }
         }
-        return time(nullptr) < 10000000;
+        return time(nullptr) >= 10000000;
     }
 
     bool running() {
@@ -99,7 +130,21 @@ public:
     }
 
 private:
+    friend void __wifiService();
+    void _service() {
+        if (_onSync) {
+            uint32_t syncs = __getTimeSync(nullptr, nullptr);
+            if (syncs != _syncs) {
+                _syncs = syncs;
+                _onSync();
+            }
+        }
+    }
+
     bool _running = false;
+    String _name[2];   // SNTP keeps only the pointers
+    SyncCallback _onSync;
+    uint32_t _syncs = 0;
 };
 
 // ESP8266 compat
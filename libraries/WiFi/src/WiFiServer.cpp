@@ -26,6 +26,7 @@
 #include "lwip/tcp.h"
 #include "lwip/inet.h"
 #include <include/ClientContext.h>
+#include <new>
 
 #ifndef MAX_PENDING_CLIENTS_PER_PORT
 #define MAX_PENDING_CLIENTS_PER_PORT 5
@@ -55,6 +56,7 @@ void WiFiServer::begin(uint16_t port, uint8_t backlog) {
         return;
     }
     _port = port;
+    _backlog = backlog;
 
     LWIPMutex m;  // Block the timer sys_check_timeouts call
 
@@ -116,11 +118,12 @@ size_t WiFiServer::hasClientData() {
 }
 
 bool WiFiServer::hasMaxPendingClients() {
-#if TCP_LISTEN_BACKLOG
-    return ((struct tcp_pcb_listen *)_listen_pcb)->accepts_pending >= MAX_PENDING_CLIENTS_PER_PORT;
-#else
-    return false;
-#endif
+    LWIPMutex m;  // Block the timer sys_check_timeouts call
+    int pending = 0;
+    for (ClientContext* c = _unclaimed; c; c = c->next()) {
+        pending++;
+    }
+    return pending >= _backlog;
 }
 
 WiFiClient WiFiServer::available(byte* status) {
@@ -128,18 +131,26 @@ WiFiClient WiFiServer::available(byte* status) {
     return accept();
 }
 
-WiFiClient WiFiServer::accept() {
-    if (_unclaimed) {
-        WiFiClient result(_unclaimed);
-
+// Takes the first waiting client off the queue, which _accept() may be pruning
+ClientContext* WiFiServer::_popUnclaimed() {
+    LWIPMutex m;  // Block the timer sys_check_timeouts call
+    ClientContext* c = _unclaimed;
+    if (c) {
         // pcb can be null when peer has already closed the connection
-        if (_unclaimed->getPCB()) {
-            LWIPMutex m;  // Block the timer sys_check_timeouts call
+        if (c->getPCB()) {
             // give permission to lwIP to accept one more peer
-            tcp_backlog_accepted(_unclaimed->getPCB());
+            tcp_backlog_accepted(c->getPCB());
         }
+        _unclaimed = c->next();
+        c->next(nullptr);
+    }
+    return c;
+}
 
-        _unclaimed = _unclaimed->next();
+WiFiClient WiFiServer::accept() {
+    ClientContext* c = _popUnclaimed();
+    if (c) {
+        WiFiClient result(c);
         result.setNoDelay(getNoDelay());
         DEBUGV("WS:av status=%d WCav=%d\r\n", result.status(), result.available());
         return result;
@@ -188,9 +199,40 @@ err_t WiFiServer::_accept(tcp_pcb* apcb, err_t err) {
     (void) err;
     DEBUGV("WS:ac\r\n");
 
+    // Forget clients reset before they were claimed which left nothing to read
+    int pending = 0;
+    ClientContext* prev = nullptr;
+    for (ClientContext* c = _unclaimed; c;) {
+        ClientContext* next = c->next();
+        if (!c->getPCB() && !c->getSize()) {
+            if (prev) {
+                prev->next(next);
+            } else {
+                _unclaimed = next;
+            }
+            c->ref();
+            c->unref(); // Last reference, deletes it
+        } else {
+            pending++;
+            prev = c;
+        }
+        c = next;
+    }
+
+    if (pending >= _backlog) {
+        // Full, so reset it now rather than hold a PCB and buffers for it
+        DEBUGV("WS:rst\r\n");
+        tcp_abort(apcb);
+        return ERR_ABRT;
+    }
+
     // always accept new PCB so incoming data can be stored in our buffers even before
     // user calls ::available()
-    ClientContext* client = new ClientContext(apcb, &WiFiServer::_s_discard, this);
+    ClientContext* client = new (std::nothrow) ClientContext(apcb, &WiFiServer::_s_discard, this);
+    if (!client) {
+        tcp_abort(apcb);
+        return ERR_ABRT;
+    }
 
     // backlog doc:
     // http://lwip.100.n7.nabble.com/Problem-re-opening-listening-pbc-tt32484.html#a32494
@@ -202,6 +244,10 @@ err_t WiFiServer::_accept(tcp_pcb* apcb, err_t err) {
 
     _unclaimed = slist_append_tail(_unclaimed, client);
 
+    if (_onClient) {
+        _onClient(*this);
+    }
+
     return ERR_OK;
 }
 
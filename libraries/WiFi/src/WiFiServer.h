@@ -28,6 +28,7 @@ struct tcp_pcb;
 #include <Server.h>
 #include <IPAddress.h>
 #include <lwip/err.h>
+#include <functional>
 
 // lwIP-v2 backlog facility allows to keep memory safe by limiting the
 // maximum number of incoming *pending clients*.  Default number of possibly
@@ -59,6 +60,12 @@ struct tcp_pcb;
 //
 // When user calls WiFiServer::available(), the tcp server stops muting and
 // answers to newcomers (until the "backlog" pending list is full again).
+//
+// The same count also caps the clients accepted by lwIP but not yet claimed
+// by the sketch: once that many are waiting, new connections are reset at
+// once instead of each taking a PCB and receive buffers, and clients which
+// were reset before being claimed (as a port scanner's are) are dropped from
+// the queue.
 
 class ClientContext;
 class WiFiClient;
@@ -73,6 +80,8 @@ protected:
     ClientContext* _unclaimed = nullptr;
     ClientContext* _discarded = nullptr;
     enum { _ndDefault, _ndFalse, _ndTrue } _noDelay = _ndDefault;
+    uint8_t _backlog = 0;
+    std::function<void(WiFiServer&)> _onClient;
 
 public:
     WiFiServer(const IPAddress& addr, uint16_t port);
@@ -99,9 +108,16 @@ public:
     void close();
     void stop();
 
+    // Called from the network context (an IRQ, or core 1) as each client is queued
+    // for accept(), so keep it short: set a flag, notify a task, etc.
+    void onClient(std::function<void(WiFiServer&)> cb) {
+        _onClient = cb;
+    }
+
     using ClientType = WiFiClient;
 
 protected:
+    ClientContext* _popUnclaimed();
     err_t  _accept(tcp_pcb* newpcb, err_t err);
     void   _discard(ClientContext* client);
 
@@ -80,23 +80,32 @@ WiFiClientSecure WiFiServerSecure::available(uint8_t* status) {
 }
 
 WiFiClientSecure WiFiServerSecure::accept() {
-    if (_unclaimed) {
-        if (_sk && _sk->isRSA()) {
-            WiFiClientSecure result(_unclaimed, _chain, _sk, _iobuf_in_size, _iobuf_out_size, _cache, _client_CA_ta, _tls_min, _tls_max);
-            _unclaimed = _unclaimed->next();
+    // The handshake in the constructors can take a while, so the client is taken off
+    // the queue first rather than holding the lwIP lock throughout
+    ClientContext* c = (_sk && (_sk->isRSA() || _sk->isEC())) ? _popUnclaimed() : nullptr;
+    if (c) {
+        // Resuming a session skips the public key operations, which is most of the handshake
+        ServerSessions *cache = _cache;
+        if (!cache && _sessions) {
+            if (!_ownCache) {
+                _ownCache = std::make_shared<ServerSessions>(_sessions);
+            }
+            cache = _ownCache->size() ? _ownCache.get() : nullptr;
+        }
+        if (_sk->isRSA()) {
+            WiFiClientSecure result(c, _chain, _sk, _iobuf_in_size, _iobuf_out_size, cache, _client_CA_ta, _tls_min, _tls_max);
             result.setNoDelay(_noDelay);
             DEBUGV("WS:av\r\n");
             return result;
-        } else if (_sk && _sk->isEC()) {
-            WiFiClientSecure result(_unclaimed, _chain, _cert_issuer_key_type, _sk, _iobuf_in_size, _iobuf_out_size, _cache, _client_CA_ta, _tls_min, _tls_max);
-            _unclaimed = _unclaimed->next();
+        } else {
+            WiFiClientSecure result(c, _chain, _cert_issuer_key_type, _sk, _iobuf_in_size, _iobuf_out_size, cache, _client_CA_ta, _tls_min, _tls_max);
             result.setNoDelay(_noDelay);
             DEBUGV("WS:av\r\n");
             return result;
-        } else {
-            // No key was defined, so we can't actually accept and attempt accept() and SSL handshake.
-            DEBUGV("WS:nokey\r\n");
         }
+    } else if (_unclaimed) {
+        // No key was defined, so we can't actually accept and attempt accept() and SSL handshake.
+        DEBUGV("WS:nokey\r\n");
     }
 
     // Something weird, return a no-op object
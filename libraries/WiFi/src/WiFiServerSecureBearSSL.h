@@ -23,6 +23,12 @@
 #include "WiFiClientSecureBearSSL.h"
 #include "BearSSLHelpers.h"
 #include <bearssl/bearssl.h>
+#include <memory>
+
+// Sessions cached by a server which hasn't been given a cache of its own, at 100 bytes each
+#ifndef WIFISERVERSECURE_SESSIONS
+#define WIFISERVERSECURE_SESSIONS 8
+#endif
 
 namespace BearSSL {
 
@@ -46,6 +52,14 @@ public:
         _cache = cache;
     }
 
+    // Has the server allocate its own cache for this many sessions (100 bytes each) on the
+    // first accept(), instead of a given one.  0 turns session resumption off.
+    void setCacheSize(uint32_t sessions) {
+        _cache = nullptr;
+        _ownCache.reset();
+        _sessions = sessions;
+    }
+
     // Set the server's RSA key and x509 certificate (required, pick one).
     // Caller needs to preserve the chain and key throughout the life of the server.
     void setRSACert(const X509List *chain, const PrivateKey *sk);
@@ -79,6 +93,8 @@ private:
     int _iobuf_out_size = 837;
     const X509List *_client_CA_ta = nullptr;
     ServerSessions *_cache = nullptr;
+    std::shared_ptr<ServerSessions> _ownCache; // Shared by copies of the server
+    uint32_t _sessions = WIFISERVERSECURE_SESSIONS;
 
     // TLS ciphers allowed
     uint32_t _tls_min = BR_TLS10;
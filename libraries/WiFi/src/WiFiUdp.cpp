@@ -37,6 +37,122 @@
 template<>
 WiFiUDP* SList<WiFiUDP>::_s_first = 0;
 
+// beginMulticastRing() subscriptions, open addressed by group and port.  All are touched
+// under the lwIP lock, the receive side being in lwIP context.
+typedef struct {
+    uint32_t group;   // 0 for a free slot
+    uint16_t port;
+    ip4_addr_t iface;
+    UdpContext *ctx;  // Not referenced, the context takes itself out when it goes
+} McastGroup;
+
+// The socket shared by the subscriptions on one port
+typedef struct {
+    udp_pcb *pcb;
+    uint16_t port;
+    int users;
+} McastPort;
+
+static constexpr int _mcastSlots = 2 * WIFIUDP_MAX_GROUPS;
+static McastGroup _mcastGroup[_mcastSlots];
+static McastPort _mcastPort[WIFIUDP_MAX_GROUPS];
+static int _mcastCount = 0;
+
+static int _mcastHash(uint32_t group, uint16_t port) {
+    return (((group ^ port) * 2654435761u) >> 16) % _mcastSlots;
+}
+
+static McastGroup *_mcastFind(uint32_t group, uint16_t port) {
+    for (int i = _mcastHash(group, port); _mcastGroup[i].group; i = (i + 1) % _mcastSlots) {
+        if ((_mcastGroup[i].group == group) && (_mcastGroup[i].port == port)) {
+            return &_mcastGroup[i];
+        }
+    }
+    return nullptr;
+}
+
+static void _mcastInsert(const McastGroup &g) {
+    int i = _mcastHash(g.group, g.port);
+    while (_mcastGroup[i].group) {
+        i = (i + 1) % _mcastSlots;
+    }
+    _mcastGroup[i] = g;
+}
+
+static void _mcastRecv(void *arg, udp_pcb *pcb, pbuf *pb, const ip_addr_t *srcaddr, u16_t srcport) {
+    (void) arg;
+    const ip_addr_t *dst = ip_current_dest_addr();
+    McastGroup *g = IP_IS_V4(dst) ? _mcastFind(ip4_addr_get_u32(ip_2_ip4(dst)), pcb->local_port) : nullptr;
+    if (!g) {
+        pbuf_free(pb);
+        return;
+    }
+    g->ctx->pushRx(pb, srcaddr, srcport);
+}
+
+static bool _mcastListen(uint16_t port) {
+    McastPort *slot = nullptr;
+    for (auto &p : _mcastPort) {
+        if (p.users && (p.port == port)) {
+            p.users++;
+            return true;
+        }
+        if (!p.users && !slot) {
+            slot = &p;
+        }
+    }
+    if (!slot) {
+        return false;
+    }
+    udp_pcb *pcb = udp_new();
+    if (!pcb) {
+        return false;
+    }
+    if (udp_bind(pcb, IP_ADDR_ANY, port) != ERR_OK) {
+        udp_remove(pcb);
+        return false;
+    }
+    udp_recv(pcb, _mcastRecv, nullptr);
+    slot->pcb = pcb;
+    slot->port = port;
+    slot->users = 1;
+    return true;
+}
+
+static void _mcastUnlisten(uint16_t port) {
+    for (auto &p : _mcastPort) {
+        if (p.users && (p.port == port)) {
+            if (!--p.users) {
+                udp_remove(p.pcb);
+                p.pcb = nullptr;
+            }
+            return;
+        }
+    }
+}
+
+static void _mcastRelease(UdpContext *ctx) {
+    LWIPMutex m;
+    for (int i = 0; i < _mcastSlots; i++) {
+        if (_mcastGroup[i].group && (_mcastGroup[i].ctx == ctx)) {
+            McastGroup g = _mcastGroup[i];
+            ip4_addr_t group;
+            ip4_addr_set_u32(&group, g.group);
+            igmp_leavegroup(&g.iface, &group);
+            _mcastUnlisten(g.port);
+            _mcastCount--;
+            // Put back the rest of the run, so none are left behind the hole
+            _mcastGroup[i].group = 0;
+            for (int j = (i + 1) % _mcastSlots; _mcastGroup[j].group; j = (j + 1) % _mcastSlots) {
+                McastGroup moved = _mcastGroup[j];
+                _mcastGroup[j].group = 0;
+                _mcastInsert(moved);
+            }
+            return;
+        }
+    }
+}
+
 /* Constructor */
 WiFiUDP::WiFiUDP() : _ctx(0) {
     WiFiUDP::_add(this);
@@ -97,6 +213,54 @@ uint8_t WiFiUDP::beginMulticast(IPAddress interfaceAddr, IPAddress multicast, ui
     return 1;
 }
 
+uint8_t WiFiUDP::beginMulticastRing(IPAddress interfaceAddr, IPAddress multicast, uint16_t port, int packets) {
+    if (_ctx) {
+        _ctx->unref();
+        _ctx = 0;
+    }
+
+    if (!multicast.isV4() || !interfaceAddr.isV4() || !ip4_addr_ismulticast(ip_2_ip4((const ip_addr_t*)multicast))) {
+        return 0;
+    }
+
+    UdpContext *ctx = new UdpContext;
+    if (!ctx->setRxRing(packets)) {
+        delete ctx;
+        return 0;
+    }
+
+    LWIPMutex m;
+    McastGroup g;
+    g.group = ip4_addr_get_u32(ip_2_ip4((const ip_addr_t*)multicast));
+    g.port = port;
+    ip4_addr_copy(g.iface, *ip_2_ip4((const ip_addr_t*)interfaceAddr));
+    g.ctx = ctx;
+    if ((_mcastCount >= WIFIUDP_MAX_GROUPS) || _mcastFind(g.group, port) || !_mcastListen(port)) {
+        delete ctx;
+        return 0;
+    }
+    if (igmp_joingroup(&g.iface, ip_2_ip4((const ip_addr_t*)multicast)) != ERR_OK) {
+        _mcastUnlisten(port);
+        delete ctx;
+        return 0;
+    }
+    _mcastInsert(g);
+    _mcastCount++;
+    ctx->onRelease(_mcastRelease);
+
+    _ctx = ctx;
+    _ctx->ref();
+    return 1;
+}
+
+uint32_t WiFiUDP::droppedPackets() const {
+    if (!_ctx) {
+        return 0;
+    }
+
+    return _ctx->getRxDropped();
+}
+
 /*  return number of bytes available in the current packet,
     will return zero if parsePacket hasn't been called yet */
 int WiFiUDP::available() {
@@ -174,6 +338,48 @@ size_t WiFiUDP::write(const uint8_t *buffer, size_t size) {
     return _ctx->append(reinterpret_cast<const char*>(buffer), size);
 }
 
+size_t WiFiUDP::sendBatch(const Packet *pkts, size_t count) {
+    if (!_ctx) {
+        return 0;
+    }
+
+    LWIPMutex m;
+    size_t sent = 0;
+    for (; sent < count; sent++) {
+        const Packet *p = &pkts[sent];
+        const ip_addr_t *addr = p->ip.isSet() ? (const ip_addr_t *)p->ip : nullptr;
+        if (_ctx->sendPooled(addr, p->port, p->data, p->len) != ERR_OK) {
+            break;
+        }
+    }
+    return sent;
+}
+
+size_t WiFiUDP::recvBatch(Packet *pkts, size_t count) {
+    if (!_ctx) {
+        return 0;
+    }
+
+    LWIPMutex m;
+    size_t got = 0;
+    for (; got < count; got++) {
+        if (!_ctx->next()) {
+            break;
+        }
+        Packet *p = &pkts[got];
+        p->ip = _ctx->getRemoteAddress();
+        p->port = _ctx->getRemotePort();
+        p->len = _ctx->read((char *)p->data, p->len);
+    }
+    return got;
+}
+
+void WiFiUDP::setRxBufferDepth(int packets) {
+    if (_ctx) {
+        _ctx->setRxBufferDepth(packets);
+    }
+}
+
 int WiFiUDP::parsePacket() {
     if (!_ctx) {
         return 0;
@@ -26,8 +26,21 @@
 
 #define UDP_TX_PACKET_MAX_SIZE 8192
 
+// Most beginMulticastRing() group and port subscriptions at once
+#ifndef WIFIUDP_MAX_GROUPS
+#define WIFIUDP_MAX_GROUPS 16
+#endif
+
 class UdpContext;
 
+// One datagram for WiFiUDP::sendBatch() and recvBatch()
+typedef struct {
+    IPAddress ip;   // Destination to send to (unset for the beginPacket() target), or source received from
+    uint16_t port;
+    uint8_t *data;  // Payload to send, or buffer to receive into
+    size_t len;     // Payload size, or on receive the buffer size in and the bytes stored out
+} WiFiUDPPacket;
+
 class WiFiUDP : public UDP, public SList<WiFiUDP> {
 private:
     UdpContext* _ctx;
@@ -49,6 +62,13 @@ public:
     void stop() override;
     // join a multicast group and listen on the given port
     uint8_t beginMulticast(IPAddress interfaceAddr, IPAddress multicast, uint16_t port);
+    // Join an IPv4 multicast group and receive only its datagrams to the given port, queued in
+    // a ring of this many packets which drops the oldest when full.  Every WiFiUDP doing this
+    // on a port shares one lwIP socket, and incoming datagrams are handed out by a hash of
+    // their group and port.  Not for a port also used by begin() or beginMulticast().
+    uint8_t beginMulticastRing(IPAddress interfaceAddr, IPAddress multicast, uint16_t port, int packets = 16);
+    // Datagrams dropped because the beginMulticastRing() ring was full
+    uint32_t droppedPackets() const;
 
     // Sending UDP packets
 
@@ -78,6 +98,19 @@ public:
 
     using Print::write;
 
+    // Batched I/O for high packet rates.  The whole batch is done under one lwIP lock,
+    // and sends go straight from each buffer via reused pbufs, no beginPacket() needed.
+    typedef WiFiUDPPacket Packet;
+    // Returns the number of packets sent, stopping at the first failure
+    size_t sendBatch(const Packet *pkts, size_t count);
+    // Fills up to count packets with the waiting datagrams (each truncated to its len)
+    // and returns how many were received
+    size_t recvBatch(Packet *pkts, size_t count);
+
+    // Number of received datagrams held for reading before new ones are dropped
+    // (default 4).  Call after begin(), servers with bursty clients may want more.
+    void setRxBufferDepth(int packets);
+
     // Start processing the next available incoming packet
     // Returns the size of the packet in bytes, or 0 if no packets are available
     int parsePacket() override;
@@ -29,6 +29,7 @@
 //  https://tools.ietf.org/html/rfc2132 -- DHCP Options and BOOTP Vendor Extensions
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 
@@ -178,6 +179,122 @@ static void opt_write_u32(uint8_t **opt, uint8_t cmd, uint32_t val) {
     *opt = o;
 }
 
+static const uint8_t mac_none[MAC_LEN] = { 0 };
+
+// Leases are found by MAC through a linear probing hash table over the lease numbers
+static uint16_t lease_hash(const dhcp_server_t *d, const uint8_t *mac) {
+    uint32_t h = 2166136261u; // FNV-1a
+    for (int i = 0; i < MAC_LEN; i++) {
+        h = (h ^ mac[i]) * 16777619u;
+    }
+    return (h ^ (h >> 16)) & d->index_mask;
+}
+
+static int lease_find(const dhcp_server_t *d, const uint8_t *mac) {
+    for (uint16_t p = lease_hash(d, mac); d->index[p]; p = (p + 1) & d->index_mask) {
+        if (memcmp(d->lease[d->index[p] - 1].mac, mac, MAC_LEN) == 0) {
+            return d->index[p] - 1;
+        }
+    }
+    return -1;
+}
+
+static void index_insert(dhcp_server_t *d, int yi) {
+    uint16_t p = lease_hash(d, d->lease[yi].mac);
+    while (d->index[p]) {
+        p = (p + 1) & d->index_mask;
+    }
+    d->index[p] = yi + 1;
+}
+
+static void index_remove(dhcp_server_t *d, int yi) {
+    uint16_t p = lease_hash(d, d->lease[yi].mac);
+    while (d->index[p] && (d->index[p] != yi + 1)) {
+        p = (p + 1) & d->index_mask;
+    }
+    if (!d->index[p]) {
+        return;
+    }
+    // Backward shift delete, so no later entry becomes unreachable
+    uint16_t q = p;
+    while (true) {
+        d->index[p] = 0;
+        while (true) {
+            q = (q + 1) & d->index_mask;
+            if (!d->index[q]) {
+                return;
+            }
+            uint16_t home = lease_hash(d, d->lease[d->index[q] - 1].mac);
+            // Leave entries whose home slot lies cyclically in (p, q]
+            if ((p <= q) ? ((p < home) && (home <= q)) : ((p < home) || (home <= q))) {
+                continue;
+            }
+            break;
+        }
+        d->index[p] = d->index[q];
+        p = q;
+    }
+}
+
+static void lease_release(dhcp_server_t *d, int yi) {
+    if (memcmp(d->lease[yi].mac, mac_none, MAC_LEN) != 0) {
+        index_remove(d, yi);
+        memset(d->lease[yi].mac, 0, MAC_LEN);
+        d->changed = true;
+    }
+}
+
+static void lease_bind(dhcp_server_t *d, int yi, const uint8_t *mac) {
+    if (memcmp(d->lease[yi].mac, mac, MAC_LEN) == 0) {
+        return;
+    }
+    // One address per client
+    int old = lease_find(d, mac);
+    if (old >= 0) {
+        lease_release(d, old);
+    }
+    lease_release(d, yi);
+    memcpy(d->lease[yi].mac, mac, MAC_LEN);
+    index_insert(d, yi);
+    d->changed = true;
+}
+
+static bool lease_expired(const dhcp_server_t *d, int yi) {
+    uint32_t expiry = d->lease[yi].expiry << 16 | 0xffff;
+    return (int32_t)(expiry - cyw43_hal_ticks_ms()) < 0;
+}
+
+static bool lease_usable(const dhcp_server_t *d, int yi) {
+    // Never hand out the server's own address
+    return (DHCPS_BASE_IP + yi) != ip4_addr4(ip_2_ip4(&d->ip));
+}
+
+static void lease_renew(dhcp_server_t *d, int yi) {
+    d->lease[yi].expiry = (cyw43_hal_ticks_ms() + DEFAULT_LEASE_TIME_S * 1000) >> 16;
+}
+
+// An unused lease, or failing that an expired one which is released.  -1 when full
+static int lease_find_free(dhcp_server_t *d) {
+    int expired = -1;
+    for (int n = 0; n < d->lease_count; n++) {
+        int i = (d->next_free + n) % d->lease_count;
+        if (!lease_usable(d, i)) {
+            continue;
+        }
+        if (memcmp(d->lease[i].mac, mac_none, MAC_LEN) == 0) {
+            d->next_free = (i + 1) % d->lease_count;
+            return i;
+        }
+        if ((expired < 0) && lease_expired(d, i)) {
+            expired = i;
+        }
+    }
+    if (expired >= 0) {
+        lease_release(d, expired);
+    }
+    return expired;
+}
+
 static void dhcp_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p, const ip_addr_t *src_addr, u16_t src_port) {
     dhcp_server_t *d = arg;
     (void)upcb;
@@ -205,28 +322,11 @@ static void dhcp_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p,
 
     switch (opt[2]) {
     case DHCPDISCOVER: {
-        int yi = DHCPS_MAX_IP;
-        for (int i = 0; i < DHCPS_MAX_IP; ++i) {
-            if (memcmp(d->lease[i].mac, dhcp_msg.chaddr, MAC_LEN) == 0) {
-                // MAC match, use this IP address
-                yi = i;
-                break;
-            }
-            if (yi == DHCPS_MAX_IP) {
-                // Look for a free IP address
-                if (memcmp(d->lease[i].mac, "\x00\x00\x00\x00\x00\x00", MAC_LEN) == 0) {
-                    // IP available
-                    yi = i;
-                }
-                uint32_t expiry = d->lease[i].expiry << 16 | 0xffff;
-                if ((int32_t)(expiry - cyw43_hal_ticks_ms()) < 0) {
-                    // IP expired, reuse it
-                    memset(d->lease[i].mac, 0, MAC_LEN);
-                    yi = i;
-                }
-            }
+        int yi = lease_find(d, dhcp_msg.chaddr);
+        if (yi < 0) {
+            yi = lease_find_free(d);
         }
-        if (yi == DHCPS_MAX_IP) {
+        if (yi < 0) {
             // No more IP addresses left
             goto ignore_request;
         }
@@ -236,31 +336,28 @@ static void dhcp_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p,
     }
 
     case DHCPREQUEST: {
+        // Selecting and rebooting clients name the address, renewing ones use ciaddr
         uint8_t *o = opt_find(opt, DHCP_OPT_REQUESTED_IP);
-        if (o == NULL) {
-            // Should be NACK
-            goto ignore_request;
-        }
-        if (memcmp(o + 2, ip_2_ip4(&d->ip), 3) != 0) {
+        const uint8_t *req = o ? o + 2 : dhcp_msg.ciaddr;
+        if (memcmp(req, ip_2_ip4(&d->ip), 3) != 0) {
             // Should be NACK
             goto ignore_request;
         }
-        uint8_t yi = o[5] - DHCPS_BASE_IP;
-        if (yi >= DHCPS_MAX_IP) {
+        int yi = req[3] - DHCPS_BASE_IP;
+        if ((yi < 0) || (yi >= d->lease_count) || !lease_usable(d, yi)) {
             // Should be NACK
             goto ignore_request;
         }
-        if (memcmp(d->lease[yi].mac, dhcp_msg.chaddr, MAC_LEN) == 0) {
-            // MAC match, ok to use this IP address
-        } else if (memcmp(d->lease[yi].mac, "\x00\x00\x00\x00\x00\x00", MAC_LEN) == 0) {
-            // IP unused, ok to use this IP address
-            memcpy(d->lease[yi].mac, dhcp_msg.chaddr, MAC_LEN);
+        if ((memcmp(d->lease[yi].mac, dhcp_msg.chaddr, MAC_LEN) == 0)
+                || (memcmp(d->lease[yi].mac, mac_none, MAC_LEN) == 0) || lease_expired(d, yi)) {
+            // MAC match or IP unused, ok to use this IP address
+            lease_bind(d, yi, dhcp_msg.chaddr);
         } else {
             // IP already in use
             // Should be NACK
             goto ignore_request;
         }
-        d->lease[yi].expiry = (cyw43_hal_ticks_ms() + DEFAULT_LEASE_TIME_S * 1000) >> 16;
+        lease_renew(d, yi);
         dhcp_msg.yiaddr[3] = DHCPS_BASE_IP + yi;
         opt_write_u8(&opt, DHCP_OPT_MSG_TYPE, DHCPACK);
         /*            printf("DHCPS: client connected: MAC=%02x:%02x:%02x:%02x:%02x:%02x IP=%u.%u.%u.%u\n",
@@ -269,6 +366,15 @@ static void dhcp_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p,
         break;
     }
 
+    case DHCPRELEASE: {
+        // Free the address right away instead of letting it time out, no reply is sent
+        int yi = lease_find(d, dhcp_msg.chaddr);
+        if ((yi >= 0) && (dhcp_msg.ciaddr[3] == DHCPS_BASE_IP + yi)) {
+            lease_release(d, yi);
+        }
+        goto ignore_request;
+    }
+
     default:
         goto ignore_request;
     }
@@ -287,15 +393,68 @@ ignore_request:
 }
 
 void dhcp_server_init(dhcp_server_t *d, ip_addr_t *ip, ip_addr_t *nm) {
+    dhcp_server_init_n(d, ip, nm, DHCPS_MAX_IP);
+}
+
+bool dhcp_server_init_n(dhcp_server_t *d, ip_addr_t *ip, ip_addr_t *nm, size_t leases) {
     ip_addr_copy(d->ip, *ip);
     ip_addr_copy(d->nm, *nm);
-    memset(d->lease, 0, sizeof(d->lease));
-    if (dhcp_socket_new_dgram(&d->udp, d, dhcp_server_process) != 0) {
-        return;
+    d->udp = NULL;
+    if (leases < 1) {
+        leases = 1;
+    } else if (leases > DHCPS_LEASE_LIMIT) {
+        leases = DHCPS_LEASE_LIMIT;
+    }
+    d->lease_count = leases;
+    d->next_free = 0;
+    d->changed = false;
+    // Keep the hash at most half full
+    uint16_t slots = 2;
+    while (slots < 2 * leases) {
+        slots <<= 1;
+    }
+    d->index_mask = slots - 1;
+    d->lease = calloc(leases, sizeof(dhcp_server_lease_t));
+    d->index = calloc(slots, 1);
+    if (!d->lease || !d->index || (dhcp_socket_new_dgram(&d->udp, d, dhcp_server_process) != 0)) {
+        dhcp_server_deinit(d);
+        return false;
     }
     dhcp_socket_bind(&d->udp, 0, PORT_DHCP_SERVER);
+    return true;
 }
 
 void dhcp_server_deinit(dhcp_server_t *d) {
     dhcp_socket_free(&d->udp);
+    free(d->lease);
+    d->lease = NULL;
+    free(d->index);
+    d->index = NULL;
+    d->lease_count = 0;
+}
+
+size_t dhcp_server_get_bindings(dhcp_server_t *d, uint8_t *macs, size_t leases) {
+    if (leases > d->lease_count) {
+        leases = d->lease_count;
+    }
+    for (size_t i = 0; i < leases; i++) {
+        memcpy(macs + i * MAC_LEN, d->lease[i].mac, MAC_LEN);
+    }
+    return leases;
+}
+
+void dhcp_server_set_bindings(dhcp_server_t *d, const uint8_t *macs, size_t leases) {
+    if (leases > d->lease_count) {
+        leases = d->lease_count;
+    }
+    for (size_t i = 0; i < leases; i++) {
+        const uint8_t *mac = macs + i * MAC_LEN;
+        if ((memcmp(mac, mac_none, MAC_LEN) != 0) && lease_usable(d, i) && (lease_find(d, mac) < 0)) {
+            lease_release(d, i);
+            memcpy(d->lease[i].mac, mac, MAC_LEN);
+            index_insert(d, i);
+            lease_renew(d, i);
+        }
+    }
+    d->changed = false;
 }
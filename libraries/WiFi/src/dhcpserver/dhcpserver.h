@@ -30,10 +30,16 @@ extern "C" {
 #endif // __cplusplus
 
 
+#include <stdbool.h>
 #include "lwip/ip_addr.h"
 
 #define DHCPS_BASE_IP (16)
+// Default number of leases, can be changed at runtime with dhcp_server_init_n()
+#ifndef DHCPS_MAX_IP
 #define DHCPS_MAX_IP (8)
+#endif
+// Leases are handed out from .DHCPS_BASE_IP up to .254
+#define DHCPS_LEASE_LIMIT (255 - DHCPS_BASE_IP)
 
 typedef struct _dhcp_server_lease_t {
     uint8_t mac[6];
@@ -43,12 +49,23 @@ typedef struct _dhcp_server_lease_t {
 typedef struct _dhcp_server_t {
     ip_addr_t ip;
     ip_addr_t nm;
-    dhcp_server_lease_t lease[DHCPS_MAX_IP];
+    dhcp_server_lease_t *lease;
+    uint16_t lease_count;
+    uint16_t next_free;   // Where the search for an unused lease starts
+    uint8_t *index;       // Open addressed hash of the lease MACs, lease number + 1, 0 if empty
+    uint16_t index_mask;
+    volatile bool changed; // Set whenever a MAC is bound to or released from a lease
     struct udp_pcb *udp;
 } dhcp_server_t;
 
 void dhcp_server_init(dhcp_server_t *d, ip_addr_t *ip, ip_addr_t *nm);
+bool dhcp_server_init_n(dhcp_server_t *d, ip_addr_t *ip, ip_addr_t *nm, size_t leases);
 void dhcp_server_deinit(dhcp_server_t *d);
+
+// Copies out (or restores) the MAC bound to each lease, 6 bytes per lease starting at
+// .DHCPS_BASE_IP, so the table can outlive a reboot.  Restored leases start a new lease time.
+size_t dhcp_server_get_bindings(dhcp_server_t *d, uint8_t *macs, size_t leases);
+void dhcp_server_set_bindings(dhcp_server_t *d, const uint8_t *macs, size_t leases);
 #ifdef __cplusplus
 }
 #endif // __cplusplus
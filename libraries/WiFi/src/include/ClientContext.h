@@ -27,6 +27,7 @@ class WiFiClient;
 typedef void (*discard_cb_t)(void*, ClientContext*);
 
 #include <assert.h>
+#include <PolledTimeout.h>
 //#include <esp_priv.h>
 //#include <coredecls.h>
 
@@ -34,8 +35,9 @@ bool getDefaultPrivateGlobalSyncValue();
 
 template <typename T>
 inline void esp_delay(const uint32_t timeout_ms, T&& blocked, const uint32_t intvl_ms) {
-    const auto start_ms = millis();
-    while ((((uint32_t)millis() - start_ms) < timeout_ms) && blocked()) {
+    esp8266::polledTimeout::oneShotTimerMs timeout(timeout_ms);
+    while (!timeout && blocked()) {
+        LWIPUnlock u; // Let a network core deliver the callback we're waiting on
         delay(intvl_ms);
     }
 }
@@ -72,6 +74,7 @@ public:
             tcp_abort(_pcb);
             _pcb = nullptr;
         }
+        _release_static(true);
         return ERR_ABRT;
     }
 
@@ -79,13 +82,19 @@ public:
         err_t err = ERR_OK;
         if (_pcb) {
             DEBUGV(":close\r\n");
+            if (_release_count) {
+                // lwIP keeps transmitting after tcp_close(), so any referenced buffers
+                // need to be acknowledged before ownership goes back to the app
+                wait_until_acked();
+            }
+            bool pending = _release_count > 0;
             tcp_arg(_pcb, NULL);
             tcp_sent(_pcb, NULL);
             tcp_recv(_pcb, NULL);
             tcp_err(_pcb, NULL);
             tcp_poll(_pcb, NULL, 0);
             LWIPMutex m;  // Block the timer sys_check_timeouts call
-            err = tcp_close(_pcb);
+            err = pending ? ERR_ABRT : tcp_close(_pcb);
             if (err != ERR_OK) {
                 DEBUGV(":tc err %d\r\n", (int) err);
                 tcp_abort(_pcb);
@@ -93,6 +102,7 @@ public:
             }
             _pcb = nullptr;
         }
+        _release_static(true);
         return err;
     }
 
@@ -126,7 +136,8 @@ public:
         }
     }
 
-    int connect(ip_addr_t* addr, uint16_t port) {
+    // Sends the SYN and returns, connectPending() then tells when it's resolved
+    int connectAsync(ip_addr_t* addr, uint16_t port) {
         // note: not using `const ip_addr_t* addr` because
         // - `ip6_addr_assign_zone()` below modifies `*addr`
         // - caller's parameter `WiFiClient::connect` is a local copy
@@ -137,12 +148,30 @@ public:
         }
 #endif
         LWIPMutex m;  // Block the timer sys_check_timeouts call
+        LwipIntf::routeConnection(_pcb, addr);
         err_t err = tcp_connect(_pcb, addr, port, &ClientContext::_s_connected);
         if (err != ERR_OK) {
             return 0;
         }
         _connect_pending = true;
         _op_start_time = millis();
+        return 1;
+    }
+
+    // Cleared by _connected or _notify_error, or here once the timeout has passed
+    bool connectPending() {
+        if (_connect_pending && _is_timeout()) {
+            DEBUGV(":ctmo\r\n");
+            _connect_pending = false;
+            abort();
+        }
+        return _connect_pending;
+    }
+
+    int connect(ip_addr_t* addr, uint16_t port) {
+        if (!connectAsync(addr, port)) {
+            return 0;
+        }
         // will resume on timeout or when _connected or _notify_error fires
         // give scheduled functions a chance to run (e.g. Ethernet uses recurrent)
         esp_delay(_timeout_ms, [this]() {
@@ -374,6 +403,22 @@ public:
         return _write_from_source(ds, dl);
     }
 
+    // like write(), but lwIP references ds instead of copying it so it must stay valid
+    // until acknowledged: either forever (flash, const data) or until release(arg) is
+    // called, which happens exactly once, from the network context, even on error
+    size_t writeStatic(const char* ds, const size_t dl, WiFiClientReleaseCB release = nullptr, void* arg = nullptr) {
+        size_t ret = 0;
+        if (_pcb) {
+            _nocopy = true;
+            ret = _write_from_source(ds, dl);
+            _nocopy = false;
+        }
+        if (release) {
+            _add_release(release, arg);
+        }
+        return ret;
+    }
+
     size_t write(Stream& stream) {
         if (!_pcb) {
             return 0;
@@ -443,9 +488,31 @@ public:
         return _rx_buf->len - _rx_buf_offset;
     }
 
-    // consume bytes after use (see peekBuffer)
+    // fill segs[] with views of the received data, one per pbuf starting at the read position,
+    // without copying.  Returns the number of segments filled, release with peekConsume()
+    size_t peekSegments(WiFiClientSegment *segs, size_t maxSegs) {
+        LWIPMutex m; // _recv may be appending to the chain
+        size_t n = 0;
+        size_t off = _rx_buf_offset;
+        for (pbuf *p = _rx_buf; p && (n < maxSegs); p = p->next) {
+            if (p->len > off) {
+                segs[n].data = (const char *)p->payload + off;
+                segs[n].len = p->len - off;
+                n++;
+            }
+            off = 0;
+        }
+        return n;
+    }
+
+    // consume bytes after use (see peekBuffer and peekSegments), freeing pbufs as they empty
     void peekConsume(size_t consume) {
-        _consume(consume);
+        while (consume && _rx_buf) {
+            size_t seg = _rx_buf->len - _rx_buf_offset;
+            size_t now = std::min(seg, consume);
+            _consume(now);
+            consume -= now;
+        }
     }
 
 protected:
@@ -539,7 +606,7 @@ protected:
             {
                 flags |= TCP_WRITE_FLAG_MORE;    // do not tcp-PuSH (yet)
             }
-            if (!_sync)
+            if (!_sync && !_nocopy)
                 // user data must be copied when data are sent but not yet acknowledged
                 // (with sync, we wait for acknowledgment before returning to user)
             {
@@ -552,6 +619,7 @@ protected:
 
             if (err == ERR_OK) {
                 _written += next_chunk_size;
+                _sent_total += next_chunk_size;
                 has_written = true;
             } else if (err == ERR_MEM) {
                 if (scale < 4) {
@@ -590,10 +658,46 @@ protected:
         (void) pcb;
         (void) len;
         DEBUGV(":ack %d\r\n", len);
+        _acked_total += len;
+        _release_static(false);
         _write_some_from_cb();
         return ERR_OK;
     }
 
+    // Queue a writeStatic() release until everything sent so far is acknowledged
+    void _add_release(WiFiClientReleaseCB release, void* arg) {
+        {
+            LWIPMutex m;  // _acked may be draining the list
+            if (!_pcb || ((int32_t)(_acked_total - _sent_total) >= 0)) {
+                // Nothing in flight references the buffer any more
+            } else if (_release_count < MAX_STATIC_RELEASE) {
+                _release[_release_count++] = { _sent_total, release, arg };
+                return;
+            }
+        }
+        if (_pcb && ((int32_t)(_acked_total - _sent_total) < 0)) {
+            // No room to track it, so block until it's done instead
+            if (!wait_until_acked()) {
+                abort();
+            }
+        }
+        release(arg);
+    }
+
+    // Give back the buffers which have been acknowledged, or all of them once the PCB is gone
+    void _release_static(bool all) {
+        LWIPMutex m;
+        int done = 0;
+        while ((done < _release_count) && (all || ((int32_t)(_acked_total - _release[done].mark) >= 0))) {
+            _release[done].cb(_release[done].arg);
+            done++;
+        }
+        if (done) {
+            _release_count -= done;
+            memmove(&_release[0], &_release[done], _release_count * sizeof(_release[0]));
+        }
+    }
+
     void _consume(size_t size) {
         ptrdiff_t left = _rx_buf->len - _rx_buf_offset - size;
         LWIPMutex m;  // Block the timer sys_check_timeouts call
@@ -656,6 +760,7 @@ protected:
         tcp_recv(_pcb, NULL);
         tcp_err(_pcb, NULL);
         _pcb = nullptr;
+        _release_static(true);
         _notify_error();
     }
 
@@ -717,4 +822,17 @@ private:
     ClientContext* _next;
 
     bool _sync;
+
+    // writeStatic() bookkeeping, byte counts wrap and are compared as differences
+    static constexpr int MAX_STATIC_RELEASE = 4;
+    typedef struct {
+        uint32_t mark;  // _acked_total once this buffer is no longer referenced
+        WiFiClientReleaseCB cb;
+        void* arg;
+    } StaticRelease;
+    StaticRelease _release[MAX_STATIC_RELEASE];
+    int _release_count = 0;
+    uint32_t _sent_total = 0;
+    uint32_t _acked_total = 0;
+    bool _nocopy = false;
 };
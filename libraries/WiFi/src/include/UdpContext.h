@@ -29,6 +29,8 @@ extern "C" {
 
 #include <AddrList.h>
 #include <Arduino.h>
+#include <LWIPMutex.h>
+#include <new>
 //#include <PolledTimeout.h>
 
 #define PBUF_ALIGNER_ADJUST 4
@@ -39,6 +41,7 @@ class UdpContext {
 public:
 
     typedef std::function<void(void)> rxhandler_t;
+    typedef void (*releasefn_t)(UdpContext *ctx);
 
     UdpContext()
         : _pcb(0)
@@ -50,6 +53,7 @@ public:
         , _tx_buf_head(0)
         , _tx_buf_cur(0)
         , _tx_buf_offset(0) {
+        LWIPMutex m;
         _pcb = udp_new();
 #if LWIP_IPV6
         // local_ip defaults to 0.0.0.0
@@ -62,8 +66,18 @@ public:
     }
 
     ~UdpContext() {
+        LWIPMutex m;
+        if (_on_release) {
+            _on_release(this);
+        }
         udp_remove(_pcb);
         _pcb = 0;
+        for (int i = 0; i < txPoolSize; i++) {
+            if (_tx_pool[i].pb) {
+                pbuf_free(_tx_pool[i].pb);
+                _tx_pool[i].pb = nullptr;
+            }
+        }
         if (_tx_buf_head) {
             pbuf_free(_tx_buf_head);
             _tx_buf_head = 0;
@@ -76,6 +90,14 @@ public:
             _rx_buf_offset = 0;
             _rx_buf_size = 0;
         }
+        if (_ring) {
+            for (; _ring_count; _ring_count--) {
+                pbuf_free(_ring[_ring_head].pb);
+                _ring_head = (_ring_head + 1) % _ring_size;
+            }
+            delete[] _ring;
+            _ring = nullptr;
+        }
     }
 
     void ref() {
@@ -90,6 +112,7 @@ public:
     }
 
     bool connect(const IPAddress& addr, uint16_t port) {
+        LWIPMutex m;
         _pcb->remote_ip = addr;
         _pcb->remote_port = port;
 #if LWIP_IPV6
@@ -102,12 +125,14 @@ public:
     }
 
     bool listen(const IPAddress& addr, uint16_t port) {
+        LWIPMutex m;
         udp_recv(_pcb, &_s_recv, (void *) this);
         err_t err = udp_bind(_pcb, addr, port);
         return err == ERR_OK;
     }
 
     void disconnect() {
+        LWIPMutex m;
         udp_disconnect(_pcb);
     }
 
@@ -130,12 +155,14 @@ public:
                 }
             assert(addr.isV4());
         }
+        LWIPMutex m;
         udp_set_multicast_netif_addr(_pcb, ip_2_ip4((const ip_addr_t*)addr));
     }
 
 #else // !LWIP_IPV6
 
     void setMulticastInterface(const IPAddress& addr) {
+        LWIPMutex m;
         udp_set_multicast_netif_addr(_pcb, ip_2_ip4((const ip_addr_t*)addr));
     }
 
@@ -145,6 +172,7 @@ public:
         Add a netif (by its index) as the multicast interface
     */
     void setMulticastInterface(netif* p_pNetIf) {
+        LWIPMutex m;
         udp_set_multicast_netif_index(_pcb, (p_pNetIf ? netif_get_index(p_pNetIf) : NETIF_NO_INDEX));
     }
 
@@ -155,10 +183,59 @@ public:
         return _pcb;
     }
 
+    // Datagrams which may wait to be read before new ones are dropped (not in ring mode)
+    void setRxBufferDepth(int packets) {
+        _rxBufMaxDepth = (packets > 0) ? packets : 1;
+    }
+
+    // Keeps received datagrams in a ring of this many, each with its addresses, instead of
+    // chaining them with helper pbufs.  When it's full the oldest one is dropped for the new
+    // one.  Only before anything has been received.
+    bool setRxRing(int packets) {
+        if (_ring || _rx_buf || (packets < 1)) {
+            return false;
+        }
+        _ring = new (std::nothrow) RxSlot[packets];
+        if (!_ring) {
+            return false;
+        }
+        _ring_size = packets;
+        return true;
+    }
+
+    // Queues a received datagram in the ring, from lwIP context, taking over pb
+    void pushRx(pbuf* pb, const ip_addr_t* srcaddr, uint16_t srcport) {
+        if (_ring_count == _ring_size) {
+            pbuf_free(_ring[_ring_head].pb);
+            _ring_head = (_ring_head + 1) % _ring_size;
+            _ring_count--;
+            _rx_dropped++;
+        }
+        RxSlot &slot = _ring[(_ring_head + _ring_count) % _ring_size];
+        slot.pb = pb;
+        slot.addr = AddrHelper(srcaddr, ip_current_dest_addr(), srcport, ip_current_input_netif());
+        _ring_count++;
+
+        if (_on_rx) {
+            _on_rx();
+        }
+    }
+
+    // Datagrams dropped from a full ring
+    uint32_t getRxDropped() const {
+        return _rx_dropped;
+    }
+
+    // Called from the destructor, e.g. to unhook a context from whatever was feeding pushRx()
+    void onRelease(releasefn_t fn) {
+        _on_release = fn;
+    }
+
     void setMulticastTTL(int ttl) {
 #ifdef LWIP_MAYBE_XCC
         _mcast_ttl = ttl;
 #else
+        LWIPMutex m;
         udp_set_multicast_ttl(_pcb, ttl);
 #endif
     }
@@ -235,6 +312,9 @@ public:
     }
 
     bool next() {
+        if (_ring) {
+            return _ringNext();
+        }
         if (!_rx_buf) {
             return false;
         }
@@ -243,6 +323,8 @@ public:
             return true;
         }
 
+        LWIPMutex m; // _recv may be appending to the chain
+
         // We have interleaved information on addresses within received pbuf chain:
         // (before ipv6 code we had: (data-pbuf) -> (data-pbuf) -> (data-pbuf) -> ... in the receiving order)
         // Now:         (address-info-pbuf -> chained-data-pbuf [-> chained-data-pbuf...]) ->
@@ -293,6 +375,8 @@ public:
             return -1;
         }
 
+        LWIPMutex m;
+
         char c = pbuf_get_at(_rx_buf, _rx_buf_offset);
         _consume(1);
         return c;
@@ -307,6 +391,7 @@ public:
         size = (size < max_size) ? size : max_size;
         DEBUGV(":urd %d, %d, %d\r\n", size, _rx_buf_size, _rx_buf_offset);
 
+        LWIPMutex m;
         void* buf = pbuf_get_contiguous(_rx_buf, dst, size, size, _rx_buf_offset);
         if (!buf) {
             return 0;
@@ -326,6 +411,8 @@ public:
             return -1;
         }
 
+        LWIPMutex m;
+
         return pbuf_get_at(_rx_buf, _rx_buf_offset);
     }
 
@@ -339,6 +426,7 @@ public:
     }
 
     size_t append(const char* data, size_t size) {
+        LWIPMutex m;
         if (!_tx_buf_head || _tx_buf_head->tot_len < _tx_buf_offset + size) {
             _reserve(_tx_buf_offset + size);
         }
@@ -365,7 +453,22 @@ public:
         return size;
     }
 
+    // Bytes appended to the outgoing packet so far
+    size_t getTxSize() const {
+        return _tx_buf_offset;
+    }
+
+    // Copies the outgoing packet composed so far, e.g. to replay it later with append()
+    size_t copyTxBuffer(void* dst, size_t size) const {
+        LWIPMutex m;
+        if (!_tx_buf_head) {
+            return 0;
+        }
+        return pbuf_copy_partial(_tx_buf_head, dst, (size < _tx_buf_offset) ? size : _tx_buf_offset, 0);
+    }
+
     void cancelBuffer() {
+        LWIPMutex m;
         if (_tx_buf_head) {
             pbuf_free(_tx_buf_head);
         }
@@ -390,9 +493,86 @@ public:
         return err == ERR_OK;
     }
 
+    // Send one datagram straight from data, using a small set of pbufs which are
+    // reused once lwIP has let go of them, rather than append()+send() which
+    // allocates and copies twice per packet.  Callers doing several in a row
+    // should hold an LWIPMutex across them.
+    err_t sendPooled(const ip_addr_t* addr, uint16_t port, const void* data, size_t size) {
+        LWIPMutex m;
+        pbuf* pb = _poolGet(size);
+        if (!pb) {
+            DEBUGV("failed pool pbuf_alloc");
+            return ERR_MEM;
+        }
+        memcpy(pb->payload, data, size);
+        if (!addr) {
+            addr = &_pcb->remote_ip;
+            port = _pcb->remote_port;
+        }
+        err_t err = udp_sendto(_pcb, pb, addr, port);
+        if (err != ERR_OK) {
+            DEBUGV(":usp rc=%d\r\n", (int) err);
+        }
+        return err;
+    }
+
 private:
 
+    bool _ringNext() {
+        LWIPMutex m;
+        if (_rx_buf) {
+            pbuf_free(_rx_buf);
+            _rx_buf = nullptr;
+        }
+        if (!_ring_count) {
+            return false;
+        }
+        RxSlot &slot = _ring[_ring_head];
+        _ring_head = (_ring_head + 1) % _ring_size;
+        _ring_count--;
+        _rx_buf = slot.pb;
+        _currentAddr = slot.addr;
+        _rx_buf_offset = 0;
+        _rx_buf_size = _rx_buf->tot_len;
+        return true;
+    }
+
+    // An idle pool pbuf (only our reference left) of at least size bytes, with its
+    // payload rewound to where the UDP data starts
+    pbuf* _poolGet(size_t size) {
+        int slot = -1;
+        for (int i = 0; i < txPoolSize; i++) {
+            if (_tx_pool[i].pb && (_tx_pool[i].pb->ref == 1) && (_tx_pool[i].size >= size)) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            // Replace the oldest entry.  If lwIP still holds it (e.g. queued on ARP) this
+            // just drops our reference and lwIP frees it when done.
+            slot = _tx_pool_next;
+            _tx_pool_next = (_tx_pool_next + 1) % txPoolSize;
+            if (_tx_pool[slot].pb) {
+                pbuf_free(_tx_pool[slot].pb);
+            }
+            // Round up so slightly varying packet sizes keep hitting the same buffers
+            size_t alloc = (size + txPoolUnit - 1) & ~(txPoolUnit - 1);
+            _tx_pool[slot].pb = pbuf_alloc(PBUF_TRANSPORT, alloc, PBUF_RAM);
+            if (!_tx_pool[slot].pb) {
+                return nullptr;
+            }
+            _tx_pool[slot].payload = _tx_pool[slot].pb->payload;
+            _tx_pool[slot].size = alloc;
+        }
+        pbuf* pb = _tx_pool[slot].pb;
+        // lwIP prepends its headers in place, undo that and set this packet's length
+        pb->payload = _tx_pool[slot].payload;
+        pb->len = pb->tot_len = size;
+        return pb;
+    }
+
     err_t trySend(const ip_addr_t* addr, uint16_t port, bool keepBufferOnError) {
+        LWIPMutex m;
         size_t data_size = _tx_buf_offset;
         pbuf* tx_copy = pbuf_alloc(PBUF_TRANSPORT, data_size, PBUF_RAM);
         if (tx_copy) {
@@ -482,12 +662,17 @@ private:
     void _recv(udp_pcb *upcb, pbuf *pb,
                const ip_addr_t *srcaddr, u16_t srcport) {
         (void) upcb;
+        if (_ring) {
+            pushRx(pb, srcaddr, srcport);
+            return;
+        }
+
         // check receive pbuf chain depth
         // optimization path: cache the pbuf chain length
         {
             pbuf* p;
             int count = 0;
-            for (p = _rx_buf; p && ++count < rxBufMaxDepth * 2; p = p->next);
+            for (p = _rx_buf; p && ++count < _rxBufMaxDepth * 2; p = p->next);
             if (p) {
                 // pbuf chain too deep, dropping
                 pbuf_free(pb);
@@ -562,6 +747,16 @@ private:
     pbuf* _tx_buf_head;
     pbuf* _tx_buf_cur;
     size_t _tx_buf_offset;
+
+    // sendPooled() buffers
+    static constexpr int txPoolSize = 4;
+    static constexpr size_t txPoolUnit = 64;
+    struct {
+        pbuf* pb;
+        void* payload;
+        size_t size;
+    } _tx_pool[txPoolSize] = { };
+    int _tx_pool_next = 0;
     rxhandler_t _on_rx;
 #ifdef LWIP_MAYBE_XCC
     uint16_t _mcast_ttl;
@@ -577,9 +772,22 @@ private:
     };
     AddrHelper _currentAddr;
 
+    // setRxRing() mode
+    struct RxSlot {
+        pbuf* pb;
+        AddrHelper addr;
+    };
+    RxSlot* _ring = nullptr;
+    int _ring_size = 0;
+    int _ring_head = 0;
+    int _ring_count = 0;
+    uint32_t _rx_dropped = 0;
+    releasefn_t _on_release = nullptr;
+
     // rx pbuf depth barrier (counter of buffered UDP received packets)
     // keep it small
-    static constexpr int rxBufMaxDepth = 4;
+    static constexpr int rxBufDefaultDepth = 4;
+    int _rxBufMaxDepth = rxBufDefaultDepth;
 };
 
 
@@ -25,6 +25,7 @@
 #include <hardware/gpio.h>
 #include <hardware/i2c.h>
 #include <hardware/irq.h>
+#include <hardware/dma.h>
 #include <hardware/regs/intctrl.h>
 #include "Wire.h"
 
@@ -44,9 +45,38 @@ TwoWire::TwoWire(i2c_inst_t *i2c, pin_size_t sda, pin_size_t scl) {
     _clkHz = TWI_CLOCK;
     _running = false;
     _txBegun = false;
+    _buff = nullptr;
+    _buffSize = WIRE_BUFFER_SIZE;
+    _userBuff = false;
     _buffLen = 0;
 }
 
+size_t TwoWire::setBufferSize(size_t bufferSize) {
+    if (_running || !bufferSize) {
+        return 0;
+    }
+    if (!_userBuff) {
+        delete[] _buff;
+    }
+    _buff = nullptr;
+    _userBuff = false;
+    _buffSize = bufferSize;
+    return _buffSize;
+}
+
+bool TwoWire::setBuffer(uint8_t *buffer, size_t bufferSize) {
+    if (_running || !buffer || !bufferSize) {
+        return false;
+    }
+    if (!_userBuff) {
+        delete[] _buff;
+    }
+    _buff = buffer;
+    _buffSize = bufferSize;
+    _userBuff = true;
+    return true;
+}
+
 bool TwoWire::setSDA(pin_size_t pin) {
     constexpr uint32_t valid[2] = { __bitset({0, 4, 8, 12, 16, 20, 24, 28}) /* I2C0 */,
                                     __bitset({2, 6, 10, 14, 18, 22, 26})  /* I2C1 */
@@ -95,6 +125,9 @@ void TwoWire::begin() {
         return;
     }
     _slave = false;
+    if (!_buff) {
+        _buff = new uint8_t[_buffSize];
+    }
     i2c_init(_i2c, _clkHz);
     i2c_set_slave_mode(_i2c, false, 0);
     gpio_set_function(_sda, GPIO_FUNC_I2C);
@@ -105,6 +138,14 @@ void TwoWire::begin() {
     _running = true;
     _txBegun = false;
     _buffLen = 0;
+    _clockNotifier.attach();
+}
+
+void TwoWire::_clockChanged(void *arg, bool after) {
+    TwoWire *w = (TwoWire *)arg;
+    if (after) {
+        i2c_set_baudrate(w->_i2c, w->_clkHz);
+    }
 }
 
 static void _handler0() {
@@ -122,9 +163,18 @@ void TwoWire::begin(uint8_t addr) {
         return;
     }
     _slave = true;
+    if (!_buff) {
+        _buff = new uint8_t[_buffSize];
+    }
     i2c_init(_i2c, _clkHz);
     i2c_set_slave_mode(_i2c, true, addr);
 
+    // Only interrupt when the RX FIFO is half full, and hold the bus instead of overflowing
+    _i2c->hw->enable = 0;
+    hw_set_bits(&_i2c->hw->con, I2C_IC_CON_RX_FIFO_FULL_HLD_CTRL_BITS);
+    _i2c->hw->rx_tl = 7;
+    _i2c->hw->enable = 1;
+
     // Our callback IRQ
     _i2c->hw->intr_mask = (1 << 12) | (1 << 10) | (1 << 9) | (1 << 6) | (1 << 5) | (1 << 2);
 
@@ -138,10 +188,27 @@ void TwoWire::begin(uint8_t addr) {
     gpio_pull_up(_scl);
 
     _running = true;
+    _clockNotifier.attach();
+}
+
+// Pull everything out of the HW FIFO in one go instead of a byte per IRQ
+void TwoWire::_slaveDrainRX() {
+    while (_i2c->hw->rxflr) {
+        uint8_t d = _i2c->hw->data_cmd & 0xff;
+        if (_slaveStartDet && (_buffLen < (int)_buffSize)) {
+            _buff[_buffLen++] = d;
+        }
+    }
 }
 
 void TwoWire::onIRQ() {
+    if (!_slave) {
+        _handleAsyncIRQ();
+        return;
+    }
     if (_i2c->hw->intr_stat & (1 << 12)) {
+        // Anything below the RX threshold is still in the FIFO, so grab it before reporting
+        _slaveDrainRX();
         if (_onReceiveCallback && _buffLen) {
             _onReceiveCallback(_buffLen);
         }
@@ -157,6 +224,7 @@ void TwoWire::onIRQ() {
         _i2c->hw->clr_start_det;
     }
     if (_i2c->hw->intr_stat & (1 << 9)) {
+        _slaveDrainRX();
         if (_onReceiveCallback && _buffLen) {
             _onReceiveCallback(_buffLen);
         }
@@ -178,11 +246,7 @@ void TwoWire::onIRQ() {
     }
     if (_i2c->hw->intr_stat & (1 << 2)) {
         // RX_FULL
-        if (_slaveStartDet && (_buffLen < (int)sizeof(_buff))) {
-            _buff[_buffLen++] = _i2c->hw->data_cmd & 0xff;
-        } else {
-            _i2c->hw->data_cmd;
-        }
+        _slaveDrainRX();
     }
 }
 
@@ -191,17 +255,36 @@ void TwoWire::end() {
         // ERROR
         return;
     }
+    _clockNotifier.detach();
 
-    if (_slave) {
+    if (!_slave) {
+        abortAsync();
+        if (_channelDMATX >= 0) {
+            dma_channel_unclaim(_channelDMATX);
+            _channelDMATX = -1;
+        }
+        if (_channelDMARX >= 0) {
+            DMAChannel::detachInterrupt(_channelDMARX);
+            dma_channel_unclaim(_channelDMARX);
+            _channelDMARX = -1;
+        }
+    }
+
+    if (_slave || _asyncIRQ) {
         int irqNo = I2C0_IRQ + i2c_hw_index(_i2c);
         irq_remove_handler(irqNo, i2c_hw_index(_i2c) == 0 ? _handler0 : _handler1);
         irq_set_enabled(irqNo, false);
+        _asyncIRQ = false;
     }
 
     i2c_deinit(_i2c);
 
     pinMode(_sda, INPUT);
     pinMode(_scl, INPUT);
+    if (!_userBuff) {
+        delete[] _buff;
+        _buff = nullptr;
+    }
     _running = false;
     _txBegun = false;
 }
@@ -218,7 +301,7 @@ void TwoWire::beginTransmission(uint8_t addr) {
 }
 
 size_t TwoWire::requestFrom(uint8_t address, size_t quantity, bool stopBit) {
-    if (!_running || _txBegun || !quantity || (quantity > sizeof(_buff))) {
+    if (!_running || _txBegun || !quantity || (quantity > _buffSize)) {
         return 0;
     }
 
@@ -334,7 +417,7 @@ size_t TwoWire::write(uint8_t ucData) {
         _i2c->hw->data_cmd = ucData;
         return 1;
     } else {
-        if (!_txBegun || (_buffLen == sizeof(_buff))) {
+        if (!_txBegun || (_buffLen == (int)_buffSize)) {
             return 0;
         }
         _buff[_buffLen++] = ucData;
@@ -384,6 +467,218 @@ void TwoWire::onRequest(void(*function)(void)) {
     _onRequestCallback = function;
 }
 
+bool TwoWire::writeAsync(uint8_t address, const void *buffer, size_t bytes, bool sendStop) {
+    return _queueAsync(address, false, (uint8_t *)buffer, bytes, sendStop);
+}
+
+bool TwoWire::requestFromAsync(uint8_t address, void *buffer, size_t bytes, bool sendStop) {
+    return _queueAsync(address, true, (uint8_t *)buffer, bytes, sendStop);
+}
+
+bool TwoWire::_queueAsync(uint8_t address, bool read, uint8_t *buffer, size_t bytes, bool sendStop) {
+    if (!_running || _slave || _txBegun || !bytes) {
+        return false;
+    }
+    _freeAsync();
+    if (_asyncHead - _asyncFree >= WIRE_ASYNC_QUEUE_SIZE) {
+        return false; // Queue full
+    }
+    if (_channelDMATX < 0) {
+        _channelDMATX = dma_claim_unused_channel(false);
+    }
+    if (_channelDMARX < 0) {
+        _channelDMARX = dma_claim_unused_channel(false);
+        if ((_channelDMARX >= 0) && !DMAChannel::attachInterrupt(_channelDMARX, _dmaRXDone, this)) {
+            dma_channel_unclaim(_channelDMARX);
+            _channelDMARX = -1;
+        }
+    }
+    if ((_channelDMATX < 0) || (_channelDMARX < 0)) {
+        return false;
+    }
+    if (!_asyncLock) {
+        _asyncLock = spin_lock_instance(next_striped_spin_lock_num());
+    }
+    if (!_asyncIRQ) {
+        _i2c->hw->intr_mask = 0;
+        int irqNo = I2C0_IRQ + i2c_hw_index(_i2c);
+        irq_set_exclusive_handler(irqNo, i2c_hw_index(_i2c) == 0 ? _handler0 : _handler1);
+        irq_set_enabled(irqNo, true);
+        _asyncIRQ = true;
+    }
+
+    // Build the command words here, in app context, so the IRQ never needs to allocate
+    uint16_t *cmd = new uint16_t[bytes];
+    for (size_t i = 0; i < bytes; i++) {
+        cmd[i] = read ? I2C_IC_DATA_CMD_CMD_BITS : buffer[i];
+    }
+    if (sendStop) {
+        cmd[bytes - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    }
+    AsyncOp *op = &_asyncQueue[_asyncHead % WIRE_ASYNC_QUEUE_SIZE];
+    op->addr = address;
+    op->read = read;
+    op->buff = buffer;
+    op->cmd = cmd;
+    op->len = bytes;
+
+    // The IRQ only starts the next transaction on completion, so if idle we need to kick it off
+    uint32_t irqs = spin_lock_blocking(_asyncLock);
+    bool idle = _asyncRun == _asyncHead;
+    _asyncHead++;
+    if (idle) {
+        _asyncIndex = 0;
+        _asyncErrors = 0;
+        _startAsync();
+    }
+    spin_unlock(_asyncLock, irqs);
+    return true;
+}
+
+void __not_in_flash_func(TwoWire::_startAsync)() {
+    AsyncOp *op = &_asyncQueue[_asyncRun % WIRE_ASYNC_QUEUE_SIZE];
+
+    // Changing the target address requires the block be disabled
+    _i2c->hw->enable = 0;
+    _i2c->hw->tar = op->addr;
+    _i2c->hw->enable = 1;
+    // Drop any stale status from the last transaction
+    _i2c->hw->clr_intr;
+
+    if (op->read) {
+        dma_channel_config c = dma_channel_get_default_config(_channelDMARX);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_dreq(&c, i2c_get_dreq(_i2c, false));
+        dma_channel_configure(_channelDMARX, &c, op->buff, &_i2c->hw->data_cmd, op->len, true);
+    }
+    dma_channel_config c = dma_channel_get_default_config(_channelDMATX);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(_i2c, true));
+    dma_channel_configure(_channelDMATX, &c, &_i2c->hw->data_cmd, op->cmd, op->len, true);
+
+    // A STOP marks the end of a normal transaction, but without one the only way to know is an empty TX FIFO
+    bool stop = op->cmd[op->len - 1] & I2C_IC_DATA_CMD_STOP_BITS;
+    _i2c->hw->intr_mask = I2C_IC_INTR_MASK_M_TX_ABRT_BITS | (stop ? I2C_IC_INTR_MASK_M_STOP_DET_BITS : I2C_IC_INTR_MASK_M_TX_EMPTY_BITS);
+}
+
+void __not_in_flash_func(TwoWire::_handleAsyncIRQ)() {
+    if (_asyncRun == _asyncHead) {
+        _i2c->hw->intr_mask = 0;
+        return;
+    }
+    AsyncOp *op = &_asyncQueue[_asyncRun % WIRE_ASYNC_QUEUE_SIZE];
+    uint32_t stat = _i2c->hw->intr_stat;
+    bool done = false;
+    if (stat & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        // NACK or lost arbitration, the HW has flushed the TX FIFO
+        dma_channel_abort(_channelDMATX);
+        dma_channel_abort(_channelDMARX);
+        _i2c->hw->clr_tx_abrt;
+        if (_asyncIndex < 32) {
+            _asyncErrors |= 1 << _asyncIndex;
+        }
+        done = true;
+    }
+    if (stat & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        _i2c->hw->clr_stop_det;
+        done = true;
+    }
+    if ((stat & I2C_IC_INTR_STAT_R_TX_EMPTY_BITS) && !dma_channel_is_busy(_channelDMATX)) {
+        done = true;
+    }
+    if (!done) {
+        return;
+    }
+    if (op->read) {
+        // The last bytes may still be on their way out of the RX FIFO.  Rather than spin here,
+        // leave it to the RX DMA's completion IRQ to finish the transaction
+        uint32_t irqs = spin_lock_blocking(_asyncLock);
+        bool wait = dma_channel_is_busy(_channelDMARX);
+        _asyncRXWait = wait;
+        spin_unlock(_asyncLock, irqs);
+        if (wait) {
+            _i2c->hw->intr_mask = 0;
+            return;
+        }
+    }
+    _finishAsync();
+}
+
+void __not_in_flash_func(TwoWire::_dmaRXDone)(int channel, void *param) {
+    (void) channel;
+    TwoWire *w = (TwoWire *)param;
+    uint32_t irqs = spin_lock_blocking(w->_asyncLock);
+    bool finish = w->_asyncRXWait;
+    w->_asyncRXWait = false;
+    spin_unlock(w->_asyncLock, irqs);
+    if (finish) {
+        w->_finishAsync();
+    }
+}
+
+void __not_in_flash_func(TwoWire::_finishAsync)() {
+    uint32_t irqs = spin_lock_blocking(_asyncLock);
+    _asyncIndex++;
+    _asyncRun = _asyncRun + 1;
+    bool more = _asyncRun != _asyncHead;
+    if (more) {
+        _startAsync();
+    } else {
+        _i2c->hw->intr_mask = 0;
+    }
+    spin_unlock(_asyncLock, irqs);
+    if (!more && _onFinishedAsyncCallback) {
+        _onFinishedAsyncCallback();
+    }
+}
+
+void TwoWire::_freeAsync() {
+    while (_asyncFree != _asyncRun) {
+        AsyncOp *op = &_asyncQueue[_asyncFree % WIRE_ASYNC_QUEUE_SIZE];
+        delete[] op->cmd;
+        op->cmd = nullptr;
+        _asyncFree++;
+    }
+}
+
+bool TwoWire::finishedAsync() {
+    _freeAsync();
+    return _asyncRun == _asyncHead;
+}
+
+void TwoWire::abortAsync() {
+    if (!_asyncIRQ) {
+        return;
+    }
+    int irqNo = I2C0_IRQ + i2c_hw_index(_i2c);
+    irq_set_enabled(irqNo, false);
+    uint32_t irqs = spin_lock_blocking(_asyncLock);
+    if (_asyncRun != _asyncHead) {
+        _i2c->hw->intr_mask = 0;
+        dma_channel_abort(_channelDMATX);
+        dma_channel_abort(_channelDMARX);
+        // Make sure the bus is released if we stopped mid-transaction
+        _i2c->hw->enable = 0;
+        _asyncRun = _asyncHead;
+    }
+    _asyncRXWait = false;
+    spin_unlock(_asyncLock, irqs);
+    _freeAsync();
+    irq_set_enabled(irqNo, true);
+}
+
+uint32_t TwoWire::errorsAsync() {
+    return _asyncErrors;
+}
+
+void TwoWire::onFinishedAsync(void(*function)(void)) {
+    _onFinishedAsyncCallback = function;
+}
+
 #ifndef __WIRE0_DEVICE
 #define __WIRE0_DEVICE i2c0
 #endif
@@ -26,6 +26,7 @@
 #include <Arduino.h>
 #include "api/HardwareI2C.h"
 #include <hardware/i2c.h>
+#include <hardware/sync.h>
 
 // WIRE_HAS_END means Wire has end()
 #define WIRE_HAS_END 1
@@ -34,6 +35,11 @@
 #define WIRE_BUFFER_SIZE 256
 #endif
 
+// Maximum number of queued asynchronous master transactions
+#ifndef WIRE_ASYNC_QUEUE_SIZE
+#define WIRE_ASYNC_QUEUE_SIZE 16
+#endif
+
 class TwoWire : public HardwareI2C {
 public:
     TwoWire(i2c_inst_t *i2c, pin_size_t sda, pin_size_t scl);
@@ -51,6 +57,12 @@ public:
 
     void setClock(uint32_t freqHz) override;
 
+    // Change the size of the internal TX/RX buffer (default WIRE_BUFFER_SIZE).  Call before ::begin()
+    size_t setBufferSize(size_t bufferSize);
+    // Use a caller-owned buffer instead, which is filled directly in slave mode so onReceive
+    // handlers can parse it in place.  Must remain valid until ::end().  Call before ::begin()
+    bool setBuffer(uint8_t *buffer, size_t bufferSize);
+
     void beginTransmission(uint8_t) override;
     uint8_t endTransmission(bool stopBit) override;
     uint8_t endTransmission(void) override;
@@ -68,6 +80,16 @@ public:
     void onReceive(void(*)(int));
     void onRequest(void(*)(void));
 
+    // DMA/IRQ driven master transactions.  Transactions are queued and run back-to-back in the
+    // background.  Buffers must remain valid until finishedAsync() returns true, and the
+    // synchronous master calls must not be used while any async transactions are outstanding.
+    bool writeAsync(uint8_t address, const void *buffer, size_t bytes, bool sendStop = true);
+    bool requestFromAsync(uint8_t address, void *buffer, size_t bytes, bool sendStop = true);
+    bool finishedAsync(); // True when all queued transactions have completed
+    void abortAsync(); // Cancel the running transaction and any queued ones
+    uint32_t errorsAsync(); // Bit N set if the Nth transaction since the queue was last empty failed
+    void onFinishedAsync(void(*)(void)); // Called from the IRQ when the queue empties
+
     inline size_t write(unsigned long n) {
         return write((uint8_t)n);
     }
@@ -96,9 +118,16 @@ private:
     uint8_t _addr;
     bool _txBegun;
 
-    uint8_t _buff[WIRE_BUFFER_SIZE];
+    uint8_t *_buff;
+    size_t _buffSize;
+    bool _userBuff; // _buff is owned by the app, don't free it
     int _buffLen;
     int _buffOff;
+    void _slaveDrainRX();
+
+    // Reprograms the SCL timing when the system clock changes
+    ClockNotifier _clockNotifier{_clockChanged, this};
+    static void _clockChanged(void *arg, bool after);
 
     // Callback user functions
     void (*_onRequestCallback)(void);
@@ -106,6 +135,35 @@ private:
 
     bool _slaveStartDet = false;
 
+    // Async master transaction queue.  _asyncHead and _asyncFree are only changed by the app,
+    // _asyncRun only by the IRQs once a transaction is running.  The I2C and RX DMA IRQs may
+    // be on different cores, so moving on to the next transaction is done under _asyncLock
+    typedef struct {
+        uint8_t addr;
+        bool read;
+        uint8_t *buff;
+        uint16_t *cmd; // Command words for the I2C data_cmd register
+        size_t len;
+    } AsyncOp;
+    AsyncOp _asyncQueue[WIRE_ASYNC_QUEUE_SIZE];
+    uint32_t _asyncHead = 0;
+    volatile uint32_t _asyncRun = 0;
+    uint32_t _asyncFree = 0;
+    volatile uint32_t _asyncErrors = 0;
+    uint32_t _asyncIndex = 0; // Position of the running transaction since the queue was empty
+    bool _asyncIRQ = false;
+    int _channelDMATX = -1;
+    int _channelDMARX = -1;
+    spin_lock_t *_asyncLock = nullptr;
+    bool _asyncRXWait = false; // The bus is done, the RX DMA's completion IRQ finishes the read
+    void (*_onFinishedAsyncCallback)(void) = nullptr;
+    bool _queueAsync(uint8_t address, bool read, uint8_t *buffer, size_t bytes, bool sendStop);
+    void _startAsync();
+    void _handleAsyncIRQ();
+    void _finishAsync();
+    static void _dmaRXDone(int channel, void *param);
+    void _freeAsync();
+
     // TWI clock frequency
     static const uint32_t TWI_CLOCK = 100000;
 };
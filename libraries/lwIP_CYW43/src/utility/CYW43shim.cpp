@@ -24,6 +24,8 @@ extern "C" {
 #include "cyw43_stats.h"
 }
 #include "pico/cyw43_arch.h"
+#include "lwip/prot/ethernet.h"
+#include "lwip/snmp.h"
 #include <Arduino.h>
 
 // From cyw43_ctrl.c
@@ -37,8 +39,19 @@ extern "C" {
 #define WIFI_JOIN_STATE_KEYED   (0x0800)
 #define WIFI_JOIN_STATE_ALL     (0x0e01)
 
+// From Broadcom's wlioctl.h.  cyw43_ioctl() takes them shifted up, with the set flag in bit 0
+#define WLC_GET_BSSID   (23)
+#define WLC_GET_CHANNEL (29)
+
 
 netif *CYW43::_netif = nullptr;
+volatile uint32_t CYW43::_lastTraffic = 0;
+CYW43::McastEntry CYW43::_mcast[CYW43_MCAST_FILTERS];
+uint8_t CYW43::_mcastOverflow = 0;
+bool CYW43::_mcastFailed = false;
+bool CYW43::_mcastDirty = false;
+bool CYW43::_allmulti = false;
+bool CYW43::_staMode = false;
 
 CYW43::CYW43(int8_t cs, arduino::SPIClass& spi, int8_t intrpin) {
     (void) cs;
@@ -57,35 +70,159 @@ bool CYW43::begin(const uint8_t* address, netif* netif) {
         cyw43_arch_enable_sta_mode();
         cyw43_wifi_get_mac(_self, _itf, netif->hwaddr);
 
-        auto authmode = CYW43_AUTH_WPA2_AES_PSK;
-        if (_password == nullptr) {
-            authmode = CYW43_AUTH_OPEN;
-        }
-
-        // Not currently possible to hook up igmp_mac_filter and mld_mac_filter
-        // TODO: implement igmp_mac_filter and mld_mac_filter
-        cyw43_set_allmulti(_self, true);
+        // Only the groups lwIP has joined get through, so busy LANs full of SSDP and
+        // mDNS traffic for other hosts don't wake the CPU for every frame
+        _staMode = true;
+        _mcastSync(true);
 
-        if (cyw43_arch_wifi_connect_timeout_ms(_ssid, _password, authmode, _timeout)) {
-            return false;
-        } else {
-            return true;
+        _directFailed = false;
+        if (!_blocking) {
+            // Only start the join, progress shows up in cyw43_wifi_link_status()
+            return !_join(_direct);
         }
+        uint32_t start = millis();
+        if (_direct) {
+            if (!_join(true) && _waitJoin(std::min(_timeout, CYW43_DIRECT_JOIN_MS))) {
+                return true;
+            }
+            // The AP has moved channel or gone, so look for the network the usual way
+            _directFailed = true;
+            cyw43_wifi_leave(_self, _itf);
+        }
+        int left = _timeout - std::min((int)(millis() - start), _timeout);
+        return !cyw43_arch_wifi_connect_timeout_ms(_ssid, _password, _password ? CYW43_AUTH_WPA2_AES_PSK : CYW43_AUTH_OPEN, left);
     } else {
         _itf = 1;
+        _staMode = false;
         cyw43_arch_enable_ap_mode(_ssid, _password, _password ? CYW43_AUTH_WPA2_AES_PSK : CYW43_AUTH_OPEN);
         cyw43_wifi_get_mac(_self, _itf, netif->hwaddr);
         return true;
     }
 }
 
+// Starts a STA join, straight to the setBSSID() AP and channel when direct
+int CYW43::_join(bool direct) {
+    auto authmode = _password ? CYW43_AUTH_WPA2_AES_PSK : CYW43_AUTH_OPEN;
+    if (!direct) {
+        return cyw43_arch_wifi_connect_async(_ssid, _password, authmode);
+    }
+    return cyw43_wifi_join(_self, strlen(_ssid), (const uint8_t *)_ssid, _password ? strlen(_password) : 0,
+                           (const uint8_t *)_password, authmode, _bssid, _channel);
+}
+
+bool CYW43::_waitJoin(uint32_t ms) {
+    uint32_t start = millis();
+    while (millis() - start < ms) {
+        int status = cyw43_wifi_link_status(_self, _itf);
+        if (status == CYW43_LINK_JOIN) {
+            return true;
+        } else if (status < 0) {
+            // CYW43_LINK_FAIL, _NONET or _BADAUTH
+            return false;
+        }
+        delay(1);
+    }
+    return false;
+}
+
+bool CYW43::rejoin() {
+    _direct = false;
+    _directFailed = true;
+    cyw43_wifi_leave(_self, _itf);
+    return !_join(false);
+}
+
+bool CYW43::linkInfo(uint8_t *bssid, uint8_t *channel) {
+    uint8_t info[12] = {}; // channel_info_t, hw_channel first
+    memset(bssid, 0, 6);
+    if (cyw43_ioctl(&cyw43_state, WLC_GET_BSSID << 1, 6, bssid, CYW43_ITF_STA) ||
+            cyw43_ioctl(&cyw43_state, WLC_GET_CHANNEL << 1, sizeof(info), info, CYW43_ITF_STA)) {
+        return false;
+    }
+    *channel = info[0];
+    return true;
+}
+
 void CYW43::end() {
     _netif = nullptr;
+    _staMode = false;
     cyw43_deinit(&cyw43_state);
 }
 
+bool CYW43::multicastFilter(const uint8_t* mac, bool add) {
+    McastEntry *e = nullptr;
+    McastEntry *freeSlot = nullptr;
+    for (auto &m : _mcast) {
+        // A slot still waiting to be removed from the chip is simply taken back
+        if ((m.refs || m.programmed) && !memcmp(m.mac, mac, 6)) {
+            e = &m;
+        } else if (!m.refs && !m.programmed && !freeSlot) {
+            freeSlot = &m;
+        }
+    }
+    if (add) {
+        if (e) {
+            e->refs++;
+            return true;
+        } else if (!freeSlot) {
+            _mcastOverflow++;
+        } else {
+            memcpy(freeSlot->mac, mac, 6);
+            freeSlot->refs = 1;
+        }
+    } else if (e && e->refs) {
+        if (--e->refs) {
+            return true;
+        }
+    } else if (_mcastOverflow) {
+        // Can't tell which overflowed join this was, the count is all that matters
+        _mcastOverflow--;
+    }
+    _mcastDirty = true;
+    if (!__get_current_exception()) {
+        _mcastSync(false);
+    }
+    return true;
+}
+
+void CYW43::multicastService() {
+    if (_mcastDirty) {
+        _mcastSync(false);
+    }
+}
+
+void CYW43::_mcastSync(bool reset) {
+    _mcastDirty = false;
+    if (reset || !_staMode) {
+        // The chip's list is empty after a restart, and begin() will sync it then
+        for (auto &m : _mcast) {
+            m.programmed = false;
+        }
+        if (!_staMode) {
+            return;
+        }
+    }
+    _mcastFailed = false;
+    for (auto &m : _mcast) {
+        if (m.refs && !m.programmed) {
+            m.programmed = !cyw43_wifi_update_multicast_filter(&cyw43_state, m.mac, true);
+            _mcastFailed |= !m.programmed;
+        } else if (!m.refs && m.programmed) {
+            cyw43_wifi_update_multicast_filter(&cyw43_state, m.mac, false);
+            m.programmed = false;
+        }
+    }
+    bool all = _mcastOverflow || _mcastFailed;
+    if (reset || (all != _allmulti)) {
+        _allmulti = all;
+        cyw43_set_allmulti(&cyw43_state, all);
+    }
+}
 
+// The driver's is_pbuf gather path needs CYW43_LWIP, which the core builds without
+// (it has its own netif glue, below), so LwipIntfDev flattens any chain before here
 uint16_t CYW43::sendFrame(const uint8_t* data, uint16_t datalen) {
+    _lastTraffic = millis();
     if (0 == cyw43_send_ethernet(_self, _itf, datalen, data, false)) {
         return datalen;
     }
@@ -99,6 +236,31 @@ uint16_t CYW43::readFrame(uint8_t* buffer, uint16_t bufsize) {
     return 0;
 }
 
+// The frame has to be copied out of the driver's bus buffer before the next poll
+// reuses it, and lwIP holds on to received pbufs (TCP queues, WiFiClient), so it
+// can't be lent as a PBUF_REF.  What can be saved is the pool pbuf and copy for
+// frames lwIP would only throw away: other ethertypes (the chip passes them all,
+// and all multicast too if its filter list overflowed) and unicast meant for
+// another MAC.
+bool CYW43::wantFrame(const netif *netif, size_t len, const uint8_t *buf) {
+    if (len < SIZEOF_ETH_HDR) {
+        return false;
+    }
+    uint16_t type = (buf[12] << 8) | buf[13];
+    if ((type != ETHTYPE_IP) && (type != ETHTYPE_ARP)
+#if LWIP_IPV6
+            && (type != ETHTYPE_IPV6)
+#endif
+       ) {
+        return false;
+    }
+    // Group (multicast and broadcast) bit, left for the IP layer to sort out
+    if (buf[0] & 1) {
+        return true;
+    }
+    return !memcmp(buf, netif->hwaddr, ETH_HWADDR_LEN);
+}
+
 // CB from the cyg32_driver
 extern "C" void cyw43_cb_process_ethernet(void *cb_data, int itf, size_t len, const uint8_t *buf) {
     //cyw43_t *self = (cyw43_t *)cb_data
@@ -110,14 +272,25 @@ extern "C" void cyw43_cb_process_ethernet(void *cb_data, int itf, size_t len, co
         cyw43_ethernet_trace(self, netif, len, buf, NETUTILS_TRACE_NEWLINE);
     }
 #endif
-    if (netif->flags & NETIF_FLAG_LINK_UP) {
+    if ((netif->flags & NETIF_FLAG_LINK_UP) && CYW43::wantFrame(netif, len, buf)) {
+        CYW43::_lastTraffic = millis();
         struct pbuf *p = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
         if (p != NULL) {
             pbuf_take(p, buf, len);
+            MIB2_STATS_NETIF_ADD(netif, ifinoctets, len);
+            if (buf[0] & 1) {
+                MIB2_STATS_NETIF_INC(netif, ifinnucastpkts);
+            } else {
+                MIB2_STATS_NETIF_INC(netif, ifinucastpkts);
+            }
+            PROFILE_CORE_SCOPE("lwIP input");
             if (netif->input(p, netif) != ERR_OK) {
+                MIB2_STATS_NETIF_INC(netif, ifinerrors);
                 pbuf_free(p);
             }
             CYW43_STAT_INC(PACKET_IN_COUNT);
+        } else {
+            MIB2_STATS_NETIF_INC(netif, ifindiscards);
         }
     }
 }
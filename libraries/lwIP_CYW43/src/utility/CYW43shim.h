@@ -27,6 +27,16 @@ extern "C" {
 #include "cyw43.h"
 #include "cyw43_stats.h"
 }
+// Entries in the chip's multicast address list (MAX_MULTICAST_REGISTERED_ADDRESS in the driver)
+#ifndef CYW43_MCAST_FILTERS
+#define CYW43_MCAST_FILTERS 10
+#endif
+
+// How long a blocking begin() gives a join to a remembered AP before scanning instead
+#ifndef CYW43_DIRECT_JOIN_MS
+#define CYW43_DIRECT_JOIN_MS 3000
+#endif
+
 class CYW43 {
 public:
     /**
@@ -66,10 +76,38 @@ public:
     */
     uint16_t readFrame(uint8_t* buffer, uint16_t bufsize);
 
+    // Frames are pushed to lwIP by the CYW43 driver's own IRQ (cyw43_cb_process_ethernet),
+    // so there is never anything for LwipIntfDev::handlePackets to pull
+    uint16_t readFrameSize() {
+        return 0;
+    }
+    uint16_t readFrameData(pbuf* p, uint16_t framesize) {
+        (void) p;
+        (void) framesize;
+        return 0;
+    }
+    void discardFrame(uint16_t framesize) {
+        (void) framesize;
+    }
+
     bool interruptIsPossible() {
         return true;
     }
 
+    /**
+        Pass (or stop passing) frames for a multicast MAC address, called by lwIP for
+        every group joined or left.  Joins are counted, as several IP groups share one
+        MAC.  The chip is only updated from thread context, so a change made from an
+        IRQ waits for the next multicastService()
+        @param mac the group MAC address
+        @param add true to join, false to leave
+        @return true always, a full list falls back to passing all multicast
+    */
+    bool multicastFilter(const uint8_t* mac, bool add);
+
+    // Push any pending multicast list changes to the chip, called from the WiFi loop hook
+    static void multicastService();
+
     void setSSID(const char *p) {
         _ssid = p;
     }
@@ -89,14 +127,71 @@ public:
         _timeout = timeout;
     }
 
+    // When false, begin() in STA mode returns as soon as the join has started
+    void setBlocking(bool blocking) {
+        _blocking = blocking;
+    }
+
+    /**
+        Make the next STA begin() join this AP on this channel without scanning for it,
+        falling back to a normal join if it isn't there.  nullptr goes back to scanning
+    */
+    void setBSSID(const uint8_t *bssid, uint8_t channel) {
+        _direct = bssid != nullptr;
+        if (_direct) {
+            memcpy(_bssid, bssid, sizeof(_bssid));
+            _channel = channel;
+        }
+    }
+
+    // The last begin() had to give up on the setBSSID() AP
+    bool directJoinFailed() {
+        return _directFailed;
+    }
+
+    // Abandons a non-blocking join to the setBSSID() AP and scans for the network instead
+    bool rejoin();
+
+    // BSSID and channel of the AP the station is associated with
+    static bool linkInfo(uint8_t *bssid, uint8_t *channel);
+
     // LWIP netif for the IRQ packet processing
     static netif   *_netif;
+
+    // millis() of the last frame sent or received, for power save decisions
+    static volatile uint32_t _lastTraffic;
+
+    // Whether a received frame is worth copying into a pbuf for lwIP
+    static bool wantFrame(const netif *netif, size_t len, const uint8_t *buf);
 protected:
+    int _join(bool direct);
+    bool _waitJoin(uint32_t ms);
+
+    // Brings the chip's multicast list and allmulti setting in line with _mcast
+    static void _mcastSync(bool reset);
+
+    typedef struct {
+        uint8_t mac[6];
+        uint8_t refs;       // lwIP groups mapping to this MAC, 0 when the slot is free
+        bool    programmed; // Present in the chip's list
+    } McastEntry;
+    static McastEntry _mcast[CYW43_MCAST_FILTERS];
+    static uint8_t    _mcastOverflow; // Joins that found no free slot
+    static bool       _mcastFailed;   // The chip refused an address on the last sync
+    static bool       _mcastDirty;
+    static bool       _allmulti;
+    static bool       _staMode;
+
     int _timeout = 10000;
     bool     _ap = false;
+    bool     _blocking = true;
     // The WiFi driver object
     cyw43_t *_self;
     int      _itf;
     const char *_ssid = nullptr;
     const char *_password = nullptr;
+    uint8_t  _bssid[6];
+    uint8_t  _channel = 0;
+    bool     _direct = false;
+    bool     _directFailed = false;
 };
@@ -1,14 +1,8 @@
 
 #include <LwipEthernet.h>
-//#include <SPI.h>
-
-//#ifndef ETHERNET_SPI_CLOCK_DIV
-//#define ETHERNET_SPI_CLOCK_DIV SPI_CLOCK_DIV4  // 4MHz (SPI.h)
-//#endif
+#include <SPI.h>
 
+// Clock rate, bit order and mode come from each driver's own SPISettings, per transaction
 void SPI4EthInit() {
-    //SPI.begin();
-    //    SPI.setClockDivider(ETHERNET_SPI_CLOCK_DIV);
-    //    SPI.setBitOrder(MSBFIRST);
-    //    SPI.setDataMode(SPI_MODE0);
+    SPI.begin();
 }
@@ -29,12 +29,14 @@
 //#include <W5100lwIP.h>
 //#include <W5500lwIP.h>
 //#include <ENC28J60lwIP.h>
+//#include <lwIP_RMII.h>
 
 // One of them is to be declared in the main sketch
 // and passed to ethInitDHCP() or ethInitStatic():
 // Wiznet5500lwIP eth(CSPIN);
 // Wiznet5100lwIP eth(CSPIN);
 // ENC28J60lwIP eth(CSPIN);
+// RMIIlwIP eth(RXBASE, TXBASE, REFCLK, MDIO, MDC);
 
 void SPI4EthInit();
 
@@ -28,12 +28,16 @@ extern "C"
 #include "lwip/dns.h"
 #include "lwip/dhcp.h"
 #include "lwip/init.h"  // LWIP_VERSION_
+#include "lwip/stats.h"
+#include "lwip/memp.h"
 #if LWIP_IPV6
 #include "lwip/netif.h"  // struct netif
 #endif
 }
 
 #include "LwipIntf.h"
+#include <LWIPMutex.h>
+#include <Arduino.h>
 using arduino::IPAddress;
 using arduino::String;
 
@@ -183,3 +187,300 @@ bool LwipIntf::hostname(const char* aHostname) {
 
     return ret && compliant;
 }
+
+#ifndef LWIP_DNS_CACHE_SIZE
+#define LWIP_DNS_CACHE_SIZE 8
+#endif
+// Longer names are looked up every time
+#define LWIP_DNS_CACHE_NAME 64
+
+static struct {
+    char name[LWIP_DNS_CACHE_NAME];  // Empty for an unused entry
+    ip_addr_t addr;
+    bool found;
+    uint32_t expires;                // millis()
+} _dnsCache[LWIP_DNS_CACHE_SIZE];
+
+static uint32_t _dnsCacheFoundTTL = 60000;
+static uint32_t _dnsCacheFailedTTL = 10000;
+
+void LwipIntf::dnsCacheTTL(uint32_t foundMS, uint32_t failedMS) {
+    LWIPMutex m;
+    _dnsCacheFoundTTL = foundMS;
+    _dnsCacheFailedTTL = failedMS;
+    dnsCacheClear();
+}
+
+void LwipIntf::dnsCacheClear() {
+    LWIPMutex m;
+    for (auto &e : _dnsCache) {
+        e.name[0] = 0;
+    }
+}
+
+int LwipIntf::dnsCacheGet(const char* name, IPAddress& aResult) {
+    uint32_t now = millis();
+    for (auto &e : _dnsCache) {
+        if (e.name[0] && !strcasecmp(e.name, name)) {
+            if ((int32_t)(e.expires - now) <= 0) {
+                e.name[0] = 0;
+                return -1;
+            }
+            if (e.found) {
+                aResult = IPAddress(&e.addr);
+            }
+            return e.found ? 1 : 0;
+        }
+    }
+    return -1;
+}
+
+void LwipIntf::dnsCachePut(const char* name, const ip_addr_t* addr) {
+    uint32_t ttl = addr ? _dnsCacheFoundTTL : _dnsCacheFailedTTL;
+    if (!ttl || (strlen(name) >= LWIP_DNS_CACHE_NAME)) {
+        return;
+    }
+    // Replace the same name, else a free entry, else the one closest to expiring
+    uint32_t now = millis();
+    int victim = 0;
+    for (int i = 0; i < LWIP_DNS_CACHE_SIZE; i++) {
+        if (_dnsCache[i].name[0] && !strcasecmp(_dnsCache[i].name, name)) {
+            victim = i;
+            break;
+        }
+        if (!_dnsCache[i].name[0]) {
+            victim = i;
+        } else if (_dnsCache[victim].name[0] && ((int32_t)(_dnsCache[i].expires - _dnsCache[victim].expires) < 0)) {
+            victim = i;
+        }
+    }
+    strcpy(_dnsCache[victim].name, name);
+    _dnsCache[victim].found = addr != nullptr;
+    if (addr) {
+        ip_addr_copy(_dnsCache[victim].addr, *addr);
+    }
+    _dnsCache[victim].expires = now + ttl;
+}
+
+// Lookups lwIP may still call back into, so the slots are static and a cancelled one is only
+// reused once its answer (or lwIP's own timeout) has come in
+#define LWIP_DNS_ASYNC_SLOTS 8
+
+typedef enum { DNS_FREE, DNS_PENDING, DNS_FOUND, DNS_FAILED, DNS_CANCELLED } DNSState;
+
+static struct {
+    volatile DNSState state;
+    ip_addr_t addr;
+    LwipIntf::DNSCBType cb;          // Set for a callback lookup, which frees itself
+} _dnsSlot[LWIP_DNS_ASYNC_SLOTS];
+
+// Exposes the protected cache calls to the plain lwIP callback below
+class LwipIntfDNS : public LwipIntf {
+public:
+    using LwipIntf::dnsCacheGet;
+    using LwipIntf::dnsCachePut;
+};
+
+static void _dnsAsyncFound(const char* name, const ip_addr_t* ipaddr, void* arg) {
+    int i = (int)(intptr_t)arg;
+    LwipIntfDNS::dnsCachePut(name, ipaddr);
+    if (_dnsSlot[i].state == DNS_CANCELLED) {
+        _dnsSlot[i].state = DNS_FREE;
+    } else if (_dnsSlot[i].cb) {
+        LwipIntf::DNSCBType cb = std::move(_dnsSlot[i].cb);
+        _dnsSlot[i].cb = nullptr;
+        _dnsSlot[i].state = DNS_FREE;
+        cb(name, ipaddr ? IPAddress(ipaddr) : IPAddress(), ipaddr != nullptr);
+    } else if (ipaddr) {
+        ip_addr_copy(_dnsSlot[i].addr, *ipaddr);
+        _dnsSlot[i].state = DNS_FOUND;
+    } else {
+        _dnsSlot[i].state = DNS_FAILED;
+    }
+}
+
+// Answers from the cache or lwIP's table right away, else starts a lookup in a free slot.
+// Returns 1 (found) or 0 (failed) with the slot unused, -1 when pending in *slot, or -2
+// if there's no free slot.
+static int _dnsStart(const char* aHostname, ip_addr_t* addr, int* slot) {
+    IPAddress ip;
+    int r = ip.fromString(aHostname) ? 1 : LwipIntfDNS::dnsCacheGet(aHostname, ip);
+    if (r >= 0) {
+        *addr = (ip_addr_t)ip;
+        return r;
+    }
+    int i;
+    for (i = 0; i < LWIP_DNS_ASYNC_SLOTS; i++) {
+        if (_dnsSlot[i].state == DNS_FREE) {
+            break;
+        }
+    }
+    if (i == LWIP_DNS_ASYNC_SLOTS) {
+        return -2;
+    }
+    _dnsSlot[i].state = DNS_PENDING;
+#if LWIP_IPV4 && LWIP_IPV6
+    err_t err = dns_gethostbyname_addrtype(aHostname, addr, &_dnsAsyncFound, (void*)(intptr_t)i, LWIP_DNS_ADDRTYPE_DEFAULT);
+#else
+    err_t err = dns_gethostbyname(aHostname, addr, &_dnsAsyncFound, (void*)(intptr_t)i);
+#endif
+    if (err != ERR_INPROGRESS) {
+        _dnsSlot[i].state = DNS_FREE;
+        if (err == ERR_OK) {
+            LwipIntfDNS::dnsCachePut(aHostname, addr);
+            return 1;
+        }
+        return 0;
+    }
+    *slot = i;
+    return -1;
+}
+
+int LwipIntf::hostByNameAsync(const char* aHostname) {
+    LWIPMutex m;
+    ip_addr_t addr;
+    int i = -1;
+    int r = _dnsStart(aHostname, &addr, &i);
+    if (r == -2) {
+        return -1;
+    } else if (r >= 0) {
+        // Park the answer in a slot so it's read like any other
+        for (i = 0; i < LWIP_DNS_ASYNC_SLOTS; i++) {
+            if (_dnsSlot[i].state == DNS_FREE) {
+                break;
+            }
+        }
+        if (i == LWIP_DNS_ASYNC_SLOTS) {
+            return -1;
+        }
+        _dnsSlot[i].addr = addr;
+        _dnsSlot[i].state = r ? DNS_FOUND : DNS_FAILED;
+    }
+    return i;
+}
+
+bool LwipIntf::hostByNameAsync(const char* aHostname, DNSCBType&& cb) {
+    ip_addr_t addr;
+    int r;
+    {
+        LWIPMutex m;
+        int i = -1;
+        r = _dnsStart(aHostname, &addr, &i);
+        if (r == -1) {
+            _dnsSlot[i].cb = std::move(cb);
+            return true;
+        } else if (r == -2) {
+            return false;
+        }
+    }
+    cb(aHostname, r ? IPAddress(&addr) : IPAddress(), r == 1);
+    return true;
+}
+int LwipIntf::hostByNameResult(int handle, IPAddress& aResult) {
+    if ((handle < 0) || (handle >= LWIP_DNS_ASYNC_SLOTS)) {
+        return 0;
+    }
+    LWIPMutex m;
+    switch (_dnsSlot[handle].state) {
+    case DNS_PENDING:
+        return -1;
+    case DNS_FOUND:
+        aResult = IPAddress(&_dnsSlot[handle].addr);
+        _dnsSlot[handle].state = DNS_FREE;
+        return 1;
+    case DNS_FAILED:
+        _dnsSlot[handle].state = DNS_FREE;
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+void LwipIntf::hostByNameCancel(int handle) {
+    if ((handle < 0) || (handle >= LWIP_DNS_ASYNC_SLOTS)) {
+        return;
+    }
+    LWIPMutex m;
+    _dnsSlot[handle].state = (_dnsSlot[handle].state == DNS_PENDING) ? DNS_CANCELLED : DNS_FREE;
+}
+
+#if LWIP_PICO_STATS
+extern "C" uint32_t __lwipTcpOutOfOrder; // Counted by the TCP input hook in the core
+
+LwipIntf::Stats LwipIntf::stats() {
+    LWIPMutex m;
+    Stats s;
+    s.pbufPoolSize = lwip_stats.memp[MEMP_PBUF_POOL]->avail;
+    s.pbufPoolMax = lwip_stats.memp[MEMP_PBUF_POOL]->max;
+    s.pbufPoolErrors = lwip_stats.memp[MEMP_PBUF_POOL]->err;
+    s.tcpSegSize = lwip_stats.memp[MEMP_TCP_SEG]->avail;
+    s.tcpSegMax = lwip_stats.memp[MEMP_TCP_SEG]->max;
+    s.tcpSegErrors = lwip_stats.memp[MEMP_TCP_SEG]->err;
+    s.memSize = lwip_stats.mem.avail;
+    s.memMax = lwip_stats.mem.max;
+    s.memErrors = lwip_stats.mem.err;
+    s.tcpRx = lwip_stats.tcp.recv;
+    s.tcpTx = lwip_stats.tcp.xmit;
+    s.tcpDrop = lwip_stats.tcp.drop;
+    s.tcpMemErrors = lwip_stats.tcp.memerr;
+    s.tcpRetransmits = lwip_stats.mib2.tcpretranssegs;
+    s.tcpOutOfOrder = __lwipTcpOutOfOrder;
+    s.udpRx = lwip_stats.udp.recv;
+    s.udpTx = lwip_stats.udp.xmit;
+    s.udpDrop = lwip_stats.udp.drop;
+    s.udpMemErrors = lwip_stats.udp.memerr;
+    return s;
+}
+
+LwipIntf::IntfStats LwipIntf::intfStats(const netif* intf) {
+    LWIPMutex m;
+    const stats_mib2_netif_ctrs& c = intf->mib2_counters;
+    IntfStats s;
+    s.rxFrames = c.ifinucastpkts + c.ifinnucastpkts;
+    s.rxBytes = c.ifinoctets;
+    s.rxDrops = c.ifindiscards;
+    s.rxErrors = c.ifinerrors;
+    s.txFrames = c.ifoutucastpkts + c.ifoutnucastpkts;
+    s.txBytes = c.ifoutoctets;
+    s.txErrors = c.ifouterrors + c.ifoutdiscards;
+    return s;
+}
+
+// High water marks restart from what's in use now, and the sizes are left alone
+void LwipIntf::resetStats() {
+    LWIPMutex m;
+    for (int i = 0; i < MEMP_MAX; i++) {
+        lwip_stats.memp[i]->max = lwip_stats.memp[i]->used;
+        lwip_stats.memp[i]->err = 0;
+    }
+    lwip_stats.mem.max = lwip_stats.mem.used;
+    lwip_stats.mem.err = 0;
+    memset(&lwip_stats.tcp, 0, sizeof(lwip_stats.tcp));
+    memset(&lwip_stats.udp, 0, sizeof(lwip_stats.udp));
+    memset(&lwip_stats.mib2, 0, sizeof(lwip_stats.mib2));
+    __lwipTcpOutOfOrder = 0;
+    for (netif* intf = netif_list; intf; intf = intf->next) {
+        memset(&intf->mib2_counters, 0, sizeof(intf->mib2_counters));
+    }
+}
+#else
+// The prebuilt libpico keeps no counters, so only the sizes are known
+LwipIntf::Stats LwipIntf::stats() {
+    Stats s;
+    memset(&s, 0, sizeof(s));
+    s.pbufPoolSize = PBUF_POOL_SIZE;
+    s.tcpSegSize = MEMP_NUM_TCP_SEG;
+    s.memSize = MEM_SIZE;
+    return s;
+}
+
+LwipIntf::IntfStats LwipIntf::intfStats(const netif* intf) {
+    (void) intf;
+    IntfStats s;
+    memset(&s, 0, sizeof(s));
+    return s;
+}
+
+void LwipIntf::resetStats() {
+}
+#endif
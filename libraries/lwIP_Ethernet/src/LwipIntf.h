@@ -28,6 +28,18 @@
 
 #include <functional>
 
+// Most policy routes (addRoute()) at once
+#ifndef LWIP_ROUTES
+#define LWIP_ROUTES 8
+#endif
+
+// Most interfaces followed by the health check
+#ifndef LWIP_ROUTE_INTFS
+#define LWIP_ROUTE_INTFS 4
+#endif
+
+struct tcp_pcb;
+
 class LwipIntf {
 public:
     using CBType = std::function<void(netif*)>;
@@ -63,6 +75,118 @@ public:
     // ESP32 API compatibility
     const char* getHostname();
 
+    // Stack-wide counters, kept in every build.  Pool and heap figures are high water
+    // marks; everything else counts up from boot or the last resetStats().  They need
+    // LWIP_PICO_STATS in lwipopts.h and a matching libpico, otherwise everything but the
+    // sizes reads as 0
+    typedef struct {
+        uint32_t pbufPoolSize;    // PBUF_POOL_SIZE, the RX buffers
+        uint32_t pbufPoolMax;     // Most ever in use at once
+        uint32_t pbufPoolErrors;  // Times the pool was empty, each one a dropped frame
+        uint32_t tcpSegSize;      // MEMP_NUM_TCP_SEG, the TCP send and out-of-order queues
+        uint32_t tcpSegMax;
+        uint32_t tcpSegErrors;
+        uint32_t memSize;         // MEM_SIZE, the lwIP heap for TX data
+        uint32_t memMax;
+        uint32_t memErrors;       // Failed allocations, which return ERR_MEM to the caller
+        uint32_t tcpRx;           // Segments
+        uint32_t tcpTx;
+        uint32_t tcpDrop;
+        uint32_t tcpMemErrors;    // Segments dropped or not sent for lack of memory
+        uint32_t tcpRetransmits;
+        uint32_t tcpOutOfOrder;   // Segments which arrived ahead of the next expected byte
+        uint32_t udpRx;
+        uint32_t udpTx;
+        uint32_t udpDrop;
+        uint32_t udpMemErrors;
+    } Stats;
+
+    // Per-interface counters, from the MIB-2 ones lwIP keeps in each netif
+    typedef struct {
+        uint32_t rxFrames;
+        uint32_t rxBytes;
+        uint32_t rxDrops;         // No pbuf to put the frame in
+        uint32_t rxErrors;        // Rejected by lwIP
+        uint32_t txFrames;
+        uint32_t txBytes;
+        uint32_t txErrors;        // The device didn't take the frame
+    } IntfStats;
+
+    // Non-blocking DNS.  hostByNameAsync() starts a lookup and returns a handle (or -1 if
+    // none are free), then hostByNameResult() returns -1 while it's running, 1 with the
+    // address filled in, or 0 on failure.  A finished lookup's handle is freed by reading
+    // its result; cancel one which is no longer wanted.
+    static int hostByNameAsync(const char* aHostname);
+    static int hostByNameResult(int handle, arduino::IPAddress& aResult);
+    static void hostByNameCancel(int handle);
+
+    // The same with a callback, called once with the answer from the lwIP context (so keep
+    // it short), or before returning when the name is cached.  false if no slot is free.
+    using DNSCBType = std::function<void(const char* name, const arduino::IPAddress& ip, bool found)>;
+    static bool hostByNameAsync(const char* aHostname, DNSCBType&& cb);
+
+    // Answers are cached for every interface's hostByName() and hostByNameAsync(), with
+    // LWIP_DNS_CACHE_SIZE entries ahead of lwIP's own small table.  lwIP doesn't pass record
+    // TTLs on, so names are kept for foundMS and failed lookups for failedMS (0 disables).
+    static void dnsCacheTTL(uint32_t foundMS, uint32_t failedMS);
+    static void dnsCacheClear();
+
+    static Stats stats();
+    static IntfStats intfStats(const netif* intf);
+    static void resetStats();
+
+    // Routing between several interfaces (say WiFi and Ethernet).  On its own lwIP sends
+    // everything not on one of the local subnets to the default interface's gateway.  Once
+    // any of these are used, packets from one of the local addresses also always leave
+    // through the interface which owns it.  Routes, source address routing and failover
+    // need LWIP_PICO_ROUTE_HOOK in lwipopts.h and a libpico rebuilt with it.
+
+#if LWIP_PICO_ROUTE_HOOK
+    // Send traffic for dest/prefixLen out through intf (anything with getNetIf(), or a
+    // netif) while it's healthy.  The longest matching prefix wins.  Adding a route which
+    // is already there moves it to the new interface.
+    static bool addRoute(const arduino::IPAddress& dest, uint8_t prefixLen, netif* intf);
+    template<class T> static bool addRoute(const arduino::IPAddress& dest, uint8_t prefixLen, T& intf) {
+        return addRoute(dest, prefixLen, intf.getNetIf());
+    }
+    static bool removeRoute(const arduino::IPAddress& dest, uint8_t prefixLen);
+    static void clearRoutes();
+#endif
+
+    // An interface is healthy while it's up with an address and link.  With a non-zero
+    // intervalMs each one also pings its gateway (or probe, when set) that often, and stops
+    // being healthy after misses answers in a row have gone missing, until one comes back.
+    // Routes through an unhealthy interface are skipped, and if it's the default one the
+    // traffic fails over to the next healthy interface with a gateway (both with the hook).
+    static void healthCheck(uint32_t intervalMs, uint8_t misses = 3, const arduino::IPAddress& probe = arduino::IPAddress());
+    static bool healthy(const netif* intf);
+    template<class T> static bool healthy(T& intf) {
+        return healthy(intf.getNetIf());
+    }
+
+    // Hand new outgoing TCP connections to the healthy interfaces with a gateway in turn,
+    // so several uplinks are all used.  Destinations on a local subnet or covered by a
+    // route aren't affected.  Each connection stays on the interface it started on.
+    static void balanceConnections(bool enable);
+
+    // Called by the TCP clients, with the lwIP lock held, just before tcp_connect()
+    static void routeConnection(tcp_pcb* pcb, const ip_addr_t* dest);
+
 protected:
     static bool stateChangeSysCB(LwipIntf::CBType&& cb);
+
+    // Called with the lwIP lock held.  Get returns 1 for a cached address, 0 for a cached
+    // failure and -1 if the name isn't cached; a null addr stores a failure.
+    static int dnsCacheGet(const char* name, arduino::IPAddress& aResult);
+    static void dnsCachePut(const char* name, const ip_addr_t* addr);
+
+    // Interrupt-driven interfaces only flag work from their GPIO ISR, then process
+    // the packets from one shared lowest-priority IRQ where lwIP can safely be called
+    typedef void (*DeferredCB)(void* arg);
+    static int  deferredIRQAttach(DeferredCB cb, void* arg);
+    static void deferredIRQDetach(int id);
+    static void deferredIRQPend(int id);
+
+    // Brings lwIP up and runs its timers on boards where no CYW43 driver already does
+    static bool stackBegin();
 };
@@ -22,10 +22,24 @@
 */
 
 #include <LwipIntf.h>
+#include <LWIPMutex.h>
+#include <hardware/irq.h>
+#include <pico/time.h>
+#include <lwip/init.h>
+#include <lwip/timeouts.h>
 //#include <Schedule.h>
 //#include <debug.h>
 
 #define NETIF_STATUS_CB_SIZE 3
+#define NETIF_DEFERRED_CB_SIZE 3
+
+// How long to wait before retrying when the IRQ interrupted application code using lwIP
+#define NETIF_DEFERRED_RETRY_US 250
+
+// How often lwIP's timers are run when this code, not the CYW43 driver, started the stack
+#define NETIF_TIMEOUTS_MS 50
+
+extern "C" volatile bool __lwipStarted;
 
 static int       netifStatusChangeListLength = 0;
 LwipIntf::CBType netifStatusChangeList[NETIF_STATUS_CB_SIZE];
@@ -64,3 +78,98 @@ bool LwipIntf::stateUpCB(LwipIntf::CBType&& cb) {
     //                    });
     //        });
 }
+
+typedef struct {
+    LwipIntf::DeferredCB cb;
+    void* arg;
+    volatile bool pending;
+} DeferredEntry;
+
+static DeferredEntry deferredList[NETIF_DEFERRED_CB_SIZE];
+static int deferredIRQ = -1;
+
+static int64_t deferredRetry(alarm_id_t id, void* user_data) {
+    (void) id;
+    (void) user_data;
+    irq_set_pending(deferredIRQ);
+    return 0;
+}
+
+static void deferredIRQHandler() {
+    if (__inLWIP) {
+        // Application code on this core is in the middle of an lwIP call, come back shortly
+        add_alarm_in_us(NETIF_DEFERRED_RETRY_US, deferredRetry, nullptr, true);
+        return;
+    }
+    for (int i = 0; i < NETIF_DEFERRED_CB_SIZE; i++) {
+        if (deferredList[i].cb && deferredList[i].pending) {
+            deferredList[i].pending = false;
+            deferredList[i].cb(deferredList[i].arg);
+        }
+    }
+}
+
+int LwipIntf::deferredIRQAttach(LwipIntf::DeferredCB cb, void* arg) {
+    if (deferredIRQ < 0) {
+        deferredIRQ = user_irq_claim_unused(false);
+        if (deferredIRQ < 0) {
+            return -1;
+        }
+        irq_set_exclusive_handler(deferredIRQ, deferredIRQHandler);
+        irq_set_priority(deferredIRQ, PICO_LOWEST_IRQ_PRIORITY);
+        irq_set_enabled(deferredIRQ, true);
+    }
+    for (int i = 0; i < NETIF_DEFERRED_CB_SIZE; i++) {
+        if (!deferredList[i].cb) {
+            deferredList[i].arg = arg;
+            deferredList[i].pending = false;
+            deferredList[i].cb = cb;
+            return i;
+        }
+    }
+#if defined(DEBUG_ESP_CORE)
+    DEBUGV("NETIF_DEFERRED_CB_SIZE is too low\n");
+#endif
+    return -1;
+}
+
+void LwipIntf::deferredIRQDetach(int id) {
+    if ((id >= 0) && (id < NETIF_DEFERRED_CB_SIZE)) {
+        deferredList[id].pending = false;
+        deferredList[id].cb = nullptr;
+    }
+}
+
+// Safe to call from any ISR on the core which attached the handler
+void LwipIntf::deferredIRQPend(int id) {
+    if ((id >= 0) && (id < NETIF_DEFERRED_CB_SIZE)) {
+        deferredList[id].pending = true;
+        irq_set_pending(deferredIRQ);
+    }
+}
+
+static repeating_timer_t timeoutsTimer;
+static int timeoutsId = -1;
+
+// Plain Picos have nothing else calling lwip_init() or sys_check_timeouts(), so the first
+// wired interface does both, the timers from the deferred IRQ so they never run inside lwIP
+bool LwipIntf::stackBegin() {
+    if (__lwipStarted) {
+        return true;
+    }
+    timeoutsId = deferredIRQAttach([](void* arg) {
+        (void) arg;
+        sys_check_timeouts();
+    }, nullptr);
+    if (timeoutsId < 0) {
+        return false;
+    }
+    lwip_init();
+    __lwipStarted = true;
+    add_repeating_timer_ms(NETIF_TIMEOUTS_MS, [](repeating_timer_t* t) {
+        (void) t;
+        deferredIRQPend(timeoutsId);
+        return true;
+    }, nullptr, &timeoutsTimer);
+    return true;
+}
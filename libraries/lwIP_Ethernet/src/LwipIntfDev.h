@@ -40,6 +40,7 @@
 #include <lwip/icmp.h>
 #include <lwip/timeouts.h>
 #include <lwip/inet_chksum.h>
+#include <lwip/snmp.h>
 #include <lwip/apps/sntp.h>
 
 //#include <user_interface.h>  // wifi_get_macaddr()
@@ -53,8 +54,23 @@
 #define DEFAULT_MTU 1500
 #endif
 
+// Most frames handled per deferred IRQ before yielding to other lowest-priority work
+#ifndef LWIP_INTF_IRQ_BATCH
+#define LWIP_INTF_IRQ_BATCH 32
+#endif
+
 extern "C" void cyw43_hal_generate_laa_mac(__unused int idx, uint8_t buf[6]);
 
+// RawDev is the device driver.  Besides begin/end/sendFrame it provides, for polled or
+// interrupt-driven RX:
+//   uint16_t readFrameSize();    // length of the next waiting frame, 0 if none
+//   uint16_t readFrameData(pbuf* p, uint16_t framesize); // copy it into the (possibly
+//                                // chained) pbuf, one SPI transfer per segment so the
+//                                // SPI DMA path writes straight into each payload
+//   void     discardFrame(uint16_t framesize);
+// and the multicast filter lwIP programs as groups are joined and left, once per group
+// (several groups can share a MAC).  A device receiving all multicast just returns true:
+//   bool     multicastFilter(const uint8_t* mac, bool add);
 template<class RawDev>
 class LwipIntfDev: public LwipIntf, public RawDev {
 public:
@@ -111,6 +127,11 @@ public:
 
     int hostByName(const char* aHostname, IPAddress& aResult, int timeout);
 
+    // Frame and byte counts for this interface, see LwipIntf::stats() for the whole stack
+    IntfStats intfStats() const {
+        return LwipIntf::intfStats(&_netif);
+    }
+
     // ESP8266WiFi API compatibility
 
     wl_status_t status();
@@ -123,9 +144,21 @@ protected:
     static err_t netif_init_s(netif* netif);
     static err_t linkoutput_s(netif* netif, struct pbuf* p);
     static void  netif_status_callback_s(netif* netif);
+#if LWIP_IGMP
+    static err_t igmp_mac_filter_s(netif* netif, const ip4_addr_t* group, enum netif_mac_filter_action action);
+#endif
+#if LWIP_IPV6_MLD
+    static err_t mld_mac_filter_s(netif* netif, const ip6_addr_t* group, enum netif_mac_filter_action action);
+    static constexpr uint8_t _allNodesMAC[6] = { 0x33, 0x33, 0x00, 0x00, 0x00, 0x01 };
+#endif
 
     // called on a regular basis or on interrupt
-    err_t handlePackets();
+    err_t handlePackets(int maxFrames = 10);
+
+    // interrupt-driven RX: the GPIO ISR just pends the shared deferred IRQ,
+    // which drains every waiting frame
+    static void _intr_s(void* arg);
+    static void _deferred_s(void* arg);
 
     // members
 
@@ -136,6 +169,8 @@ protected:
     uint8_t  _macAddress[6];
     bool     _started;
     bool     _default;
+    int      _deferredId = -1;
+    bool     _rxMore = false;
 
     // ICMP Ping
     int _ping_seq_num = 1;
@@ -155,8 +190,8 @@ protected:
 
 template<class RawDev>
 void LwipIntfDev<RawDev>::_dns_found_callback(const char *name, const ip_addr_t *ipaddr, void *callback_arg) {
-    (void) name;
     _dns_cb_t *cb = (_dns_cb_t *)callback_arg;
+    dnsCachePut(name, ipaddr);
     if (!cb->wifi->_dns_lookup_pending) {
         return;
     }
@@ -177,6 +212,11 @@ int LwipIntfDev<RawDev>::hostByName(const char* aHostname, IPAddress& aResult, i
     }
 
     LWIPMutex m;
+    int cached = dnsCacheGet(aHostname, aResult);
+    if (cached >= 0) {
+        return cached;
+    }
+
     _dns_cb_t cb = { &aResult, this };
 #if LWIP_IPV4 && LWIP_IPV6
     err_t err = dns_gethostbyname_addrtype(aHostname, &addr, &_dns_found_callback, &cb, LWIP_DNS_ADDRTYPE_DEFAULT);
@@ -185,11 +225,13 @@ int LwipIntfDev<RawDev>::hostByName(const char* aHostname, IPAddress& aResult, i
 #endif
     if (err == ERR_OK) {
         aResult = IPAddress(&addr);
+        dnsCachePut(aHostname, &addr);
     } else if (err == ERR_INPROGRESS) {
         _dns_lookup_pending = true;
         uint32_t now = millis();
         while ((millis() - now < (uint32_t)timeout_ms) && _dns_lookup_pending) {
             sys_check_timeouts();
+            LWIPUnlock u;
             delay(10);
         }
         _dns_lookup_pending = false;
@@ -256,6 +298,7 @@ int LwipIntfDev<RawDev>::ping(IPAddress host, uint8_t ttl, uint32_t _timeout) {
         uint32_t now = millis();
         while ((millis() - now < _timeout) && (_ping_ttl < 0)) {
             sys_check_timeouts();
+            LWIPUnlock u;
             delay(10);
         }
         pbuf_free(p);
@@ -299,6 +342,10 @@ bool LwipIntfDev<RawDev>::config(const IPAddress& localIP, const IPAddress& gate
 extern char wifi_station_hostname[];
 template<class RawDev>
 boolean LwipIntfDev<RawDev>::begin(const uint8_t* macAddress, const uint16_t mtu) {
+    if (!stackBegin()) {
+        return false;
+    }
+
     if (mtu) {
         _mtu = mtu;
     }
@@ -379,8 +426,10 @@ boolean LwipIntfDev<RawDev>::begin(const uint8_t* macAddress, const uint16_t mtu
     _started = true;
 
     if (_intrPin >= 0) {
-        if (RawDev::interruptIsPossible()) {
-            // attachInterrupt(_intrPin, [&]() { this->handlePackets(); }, FALLING);
+        if (RawDev::interruptIsPossible() && ((_deferredId = deferredIRQAttach(_deferred_s, this)) >= 0)) {
+            attachInterruptParam(_intrPin, _intr_s, FALLING, this);
+            // Anything which arrived during setup won't generate another edge
+            deferredIRQPend(_deferredId);
         } else {
             ::printf((PGM_P)F(
                          "lwIP_Intf: Interrupt not implemented yet, enabling transparent polling\r\n"));
@@ -405,8 +454,16 @@ boolean LwipIntfDev<RawDev>::begin(const uint8_t* macAddress, const uint16_t mtu
 
 template<class RawDev>
 void LwipIntfDev<RawDev>::end() {
+    if (_deferredId >= 0) {
+        detachInterrupt(_intrPin);
+        deferredIRQDetach(_deferredId);
+        _deferredId = -1;
+    }
     RawDev::end();
     netif_remove(&_netif);
+#if LWIP_IPV6_MLD
+    RawDev::multicastFilter(_allNodesMAC, false);
+#endif
     memset(&_netif, 0, sizeof(_netif));
 }
 
@@ -420,8 +477,17 @@ template<class RawDev>
 err_t LwipIntfDev<RawDev>::linkoutput_s(netif* netif, struct pbuf* pbuf) {
     LwipIntfDev* lid = (LwipIntfDev*)netif->state;
 
-    if (pbuf->len != pbuf->tot_len || pbuf->next) {
-        Serial.println("ERRTOT\r\n");
+    // LWIP_NETIF_TX_SINGLE_PBUF only covers TCP.  IP fragments and UDP datagrams
+    // without header room still arrive as a chain, which sendFrame() can't take,
+    // so gather those into one buffer instead of sending just the first segment.
+    struct pbuf* flat = nullptr;
+    if (pbuf->next) {
+        flat = pbuf_clone(PBUF_RAW, PBUF_RAM, pbuf);
+        if (!flat) {
+            MIB2_STATS_NETIF_INC(netif, ifoutdiscards);
+            return ERR_MEM;
+        }
+        pbuf = flat;
     }
 
     uint16_t len = lid->sendFrame((const uint8_t*)pbuf->payload, pbuf->len);
@@ -433,7 +499,21 @@ err_t LwipIntfDev<RawDev>::linkoutput_s(netif* netif, struct pbuf* pbuf) {
     }
 #endif
 
-    return len == pbuf->len ? ERR_OK : ERR_MEM;
+    err_t ret = len == pbuf->len ? ERR_OK : ERR_MEM;
+    if (ret == ERR_OK) {
+        MIB2_STATS_NETIF_ADD(netif, ifoutoctets, len);
+        if (((const uint8_t*)pbuf->payload)[0] & 1) {
+            MIB2_STATS_NETIF_INC(netif, ifoutnucastpkts);
+        } else {
+            MIB2_STATS_NETIF_INC(netif, ifoutucastpkts);
+        }
+    } else {
+        MIB2_STATS_NETIF_INC(netif, ifouterrors);
+    }
+    if (flat) {
+        pbuf_free(flat);
+    }
+    return ret;
 }
 
 template<class RawDev>
@@ -446,6 +526,27 @@ void LwipIntfDev<RawDev>::netif_status_callback_s(struct netif* netif) {
     ((LwipIntfDev*)netif->state)->netif_status_callback();
 }
 
+#if LWIP_IGMP
+template<class RawDev>
+err_t LwipIntfDev<RawDev>::igmp_mac_filter_s(netif* netif, const ip4_addr_t* group, enum netif_mac_filter_action action) {
+    // 01:00:5e followed by the low 23 bits of the group, RFC 1112
+    const uint8_t mac[6] = { 0x01, 0x00, 0x5e, (uint8_t)(ip4_addr2(group) & 0x7f), ip4_addr3(group), ip4_addr4(group) };
+    LwipIntfDev* lid = (LwipIntfDev*)netif->state;
+    return lid->RawDev::multicastFilter(mac, action == NETIF_ADD_MAC_FILTER) ? ERR_OK : ERR_IF;
+}
+#endif
+
+#if LWIP_IPV6_MLD
+template<class RawDev>
+err_t LwipIntfDev<RawDev>::mld_mac_filter_s(netif* netif, const ip6_addr_t* group, enum netif_mac_filter_action action) {
+    // 33:33 followed by the low 32 bits of the group, RFC 2464
+    uint8_t mac[6] = { 0x33, 0x33 };
+    memcpy(mac + 2, &group->addr[3], 4);
+    LwipIntfDev* lid = (LwipIntfDev*)netif->state;
+    return lid->RawDev::multicastFilter(mac, action == NETIF_ADD_MAC_FILTER) ? ERR_OK : ERR_IF;
+}
+#endif
+
 template<class RawDev>
 err_t LwipIntfDev<RawDev>::netif_init() {
     _netif.name[0]      = 'e';
@@ -456,6 +557,13 @@ err_t LwipIntfDev<RawDev>::netif_init() {
 
 #if LWIP_IPV6_MLD
     _netif.flags |= NETIF_FLAG_MLD6;
+    netif_set_mld_mac_filter(&_netif, mld_mac_filter_s);
+    // lwIP never joins all-nodes itself, but router advertisements go there
+    RawDev::multicastFilter(_allNodesMAC, true);
+#endif
+#if LWIP_IGMP
+    // Called by igmp_start() in netif_add(), before the device is begun, for all-systems
+    netif_set_igmp_mac_filter(&_netif, igmp_mac_filter_s);
 #endif
 
     // lwIP's doc: This function typically first resolves the hardware
@@ -499,10 +607,28 @@ void LwipIntfDev<RawDev>::check_route() {
 }
 
 template<class RawDev>
-err_t LwipIntfDev<RawDev>::handlePackets() {
+void LwipIntfDev<RawDev>::_intr_s(void* arg) {
+    LwipIntfDev* lid = (LwipIntfDev*)arg;
+    deferredIRQPend(lid->_deferredId);
+}
+
+template<class RawDev>
+void LwipIntfDev<RawDev>::_deferred_s(void* arg) {
+    LwipIntfDev* lid = (LwipIntfDev*)arg;
+    lid->handlePackets(LWIP_INTF_IRQ_BATCH);
+    if (lid->_rxMore) {
+        // The interrupt line stays asserted with frames still queued, so no new
+        // edge will come.  Go around again after any other waiting IRQ work.
+        deferredIRQPend(lid->_deferredId);
+    }
+}
+
+template<class RawDev>
+err_t LwipIntfDev<RawDev>::handlePackets(int maxFrames) {
     int pkt = 0;
+    _rxMore = true;
     while (1) {
-        if (++pkt == 10)
+        if (++pkt > maxFrames)
             // prevent starvation
         {
             return ERR_OK;
@@ -510,36 +636,42 @@ err_t LwipIntfDev<RawDev>::handlePackets() {
 
         uint16_t tot_len = RawDev::readFrameSize();
         if (!tot_len) {
+            _rxMore = false;
             return ERR_OK;
         }
 
         // from doc: use PBUF_RAM for TX, PBUF_POOL from RX
-        // however:
-        // PBUF_POOL can return chained pbuf (not in one piece)
-        // and WiznetDriver does not have the proper API to deal with that
-        // so in the meantime, we use PBUF_RAM instead which is currently
-        // guarantying to deliver a continuous chunk of memory.
-        // TODO: tweak the wiznet driver to allow copying partial chunk
-        //       of received data and use PBUF_POOL.
-        pbuf* pbuf = pbuf_alloc(PBUF_RAW, tot_len, PBUF_RAM);
-        if (!pbuf || pbuf->len < tot_len) {
-            if (pbuf) {
-                pbuf_free(pbuf);
-            }
+        // Pool pbufs are fixed size blocks reserved at boot, so a steady RX stream
+        // doesn't fragment the lwIP heap.  A frame bigger than PBUF_POOL_BUFSIZE comes
+        // back as a chain, which the device's readFrameData(pbuf*, ...) fills in place.
+        pbuf* pbuf = pbuf_alloc(PBUF_RAW, tot_len, PBUF_POOL);
+        if (!pbuf) {
             RawDev::discardFrame(tot_len);
-            return ERR_BUF;
+            MIB2_STATS_NETIF_INC(&_netif, ifindiscards);
+            return ERR_MEM;
         }
 
-        uint16_t len = RawDev::readFrameData((uint8_t*)pbuf->payload, tot_len);
+        uint16_t len = RawDev::readFrameData(pbuf, tot_len);
         if (len != tot_len) {
             // tot_len is given by readFrameSize()
             // and is supposed to be honoured by readFrameData()
-            // todo: ensure this test is unneeded, remove the print
             pbuf_free(pbuf);
+            MIB2_STATS_NETIF_INC(&_netif, ifinerrors);
             return ERR_BUF;
         }
 
-        err_t err = _netif.input(pbuf, &_netif);
+        MIB2_STATS_NETIF_ADD(&_netif, ifinoctets, tot_len);
+        if (((const uint8_t*)pbuf->payload)[0] & 1) {
+            MIB2_STATS_NETIF_INC(&_netif, ifinnucastpkts);
+        } else {
+            MIB2_STATS_NETIF_INC(&_netif, ifinucastpkts);
+        }
+
+        err_t err;
+        {
+            PROFILE_CORE_SCOPE("lwIP input");
+            err = _netif.input(pbuf, &_netif);
+        }
 
 #if PHY_HAS_CAPTURE
         if (phy_capture) {
@@ -549,6 +681,7 @@ err_t LwipIntfDev<RawDev>::handlePackets() {
 #endif
 
         if (err != ERR_OK) {
+            MIB2_STATS_NETIF_INC(&_netif, ifinerrors);
             pbuf_free(pbuf);
             return err;
         }
@@ -0,0 +1,348 @@
+/*
+    LwipIntfRoute.cpp
+
+    Policy routing, interface health checks and connection balancing across
+    several lwIP interfaces
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <LwipIntf.h>
+#include <LWIPMutex.h>
+#include <Arduino.h>
+#include <lwip/raw.h>
+#include <lwip/icmp.h>
+#include <lwip/inet_chksum.h>
+#include <lwip/prot/ip4.h>
+#include <lwip/tcp.h>
+#include <lwip/timeouts.h>
+
+#if LWIP_PICO_ROUTE_HOOK
+// In the core's lwip_route.cpp, called for every IPv4 route lwIP looks up
+extern "C" struct netif *(*__lwipRouteHook)(const ip4_addr_t *src, const ip4_addr_t *dest);
+#endif
+
+typedef struct {
+    ip4_addr_t net;
+    uint8_t    prefixLen;
+    netif     *intf;    // nullptr for a free slot
+} Route;
+
+typedef struct {
+    netif   *intf;      // nullptr for a free slot
+    uint8_t  misses;    // Probes in a row which went unanswered
+    bool     waiting;   // For an answer to the last probe
+} Health;
+
+static Route _routes[LWIP_ROUTES];
+static Health _health[LWIP_ROUTE_INTFS];
+static uint32_t _probeMS = 0;
+static uint8_t _probeMisses = 3;
+static ip4_addr_t _probeHost;       // Any for each interface's own gateway
+static raw_pcb *_probePCB = nullptr;
+static bool _balance = false;
+static uint8_t _lastNum = 255;      // netif num of the last balanced connection
+
+static constexpr uint16_t PROBE_ID = 0x7e57;
+static constexpr int PROBE_DATA_SIZE = 8;
+
+static uint32_t _mask(uint8_t prefixLen) {
+    return prefixLen ? PP_HTONL(0xffffffffUL << (32 - prefixLen)) : 0;
+}
+
+static bool _usable(const netif *n) {
+    return netif_is_up(n) && netif_is_link_up(n) && !ip4_addr_isany_val(*netif_ip4_addr(n));
+}
+
+static bool _healthy(const netif *n) {
+    if (!_usable(n)) {
+        return false;
+    }
+    for (auto &h : _health) {
+        if (h.intf == n) {
+            return h.misses < _probeMisses;
+        }
+    }
+    return true; // Not probed (yet)
+}
+
+static netif *_policy(const ip4_addr_t *dest) {
+    netif *best = nullptr;
+    int bestLen = -1;
+    for (auto &r : _routes) {
+        if (r.intf && (r.prefixLen > bestLen) && ((ip4_addr_get_u32(dest) & _mask(r.prefixLen)) == ip4_addr_get_u32(&r.net)) && _healthy(r.intf)) {
+            best = r.intf;
+            bestLen = r.prefixLen;
+        }
+    }
+    return best;
+}
+
+static bool _onLink(const ip4_addr_t *dest) {
+    netif *n;
+    NETIF_FOREACH(n) {
+        if (netif_is_up(n) && ip4_addr_netcmp(dest, netif_ip4_addr(n), netif_ip4_netmask(n))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if LWIP_PICO_ROUTE_HOOK
+static netif *_route(const ip4_addr_t *src, const ip4_addr_t *dest) {
+    netif *n;
+    if (src) {
+        if (ip4_addr_isany(src)) {
+            return nullptr; // ip4_route() will ask again without a source
+        }
+        // A packet from one of our addresses can only go out of the interface owning it
+        NETIF_FOREACH(n) {
+            if (ip4_addr_cmp(src, netif_ip4_addr(n)) && _usable(n)) {
+                return n;
+            }
+        }
+        return nullptr;
+    }
+    n = _policy(dest);
+    if (n || !netif_default || _healthy(netif_default)) {
+        return n;
+    }
+    // The default interface is down or not answering, so fail over
+    NETIF_FOREACH(n) {
+        if ((n != netif_default) && !ip4_addr_isany_val(*netif_ip4_gw(n)) && _healthy(n)) {
+            return n;
+        }
+    }
+    return nullptr;
+}
+
+static void _install() {
+    __lwipRouteHook = _route;
+}
+
+bool LwipIntf::addRoute(const IPAddress& dest, uint8_t prefixLen, netif* intf) {
+    if (!intf || (prefixLen > 32) || !dest.isV4()) {
+        return false;
+    }
+    LWIPMutex m;
+    ip4_addr_t net;
+    ip4_addr_set_u32(&net, dest.v4() & _mask(prefixLen));
+    Route *slot = nullptr;
+    for (auto &r : _routes) {
+        if (r.intf && (r.prefixLen == prefixLen) && ip4_addr_cmp(&r.net, &net)) {
+            slot = &r;
+            break;
+        } else if (!r.intf && !slot) {
+            slot = &r;
+        }
+    }
+    if (!slot) {
+        DEBUGV("LwipIntf: LWIP_ROUTES is too low\n");
+        return false;
+    }
+    slot->net = net;
+    slot->prefixLen = prefixLen;
+    slot->intf = intf;
+    _install();
+    return true;
+}
+
+bool LwipIntf::removeRoute(const IPAddress& dest, uint8_t prefixLen) {
+    if ((prefixLen > 32) || !dest.isV4()) {
+        return false;
+    }
+    LWIPMutex m;
+    uint32_t net = dest.v4() & _mask(prefixLen);
+    for (auto &r : _routes) {
+        if (r.intf && (r.prefixLen == prefixLen) && (ip4_addr_get_u32(&r.net) == net)) {
+            r.intf = nullptr;
+            return true;
+        }
+    }
+    return false;
+}
+
+void LwipIntf::clearRoutes() {
+    LWIPMutex m;
+    for (auto &r : _routes) {
+        r.intf = nullptr;
+    }
+}
+#else
+// Without the hook lwIP never asks, so only connection balancing works
+static void _install() {
+}
+#endif
+
+static u8_t _probeRecv(void *arg, raw_pcb *pcb, pbuf *p, const ip_addr_t *addr) {
+    (void) arg;
+    (void) pcb;
+    (void) addr;
+    // Raw PCBs get the IP header too
+    const struct ip_hdr *iph = (const struct ip_hdr *)p->payload;
+    size_t hlen = IPH_HL_BYTES(iph);
+    if (p->len < hlen + sizeof(struct icmp_echo_hdr)) {
+        return 0;
+    }
+    const struct icmp_echo_hdr *iecho = (const struct icmp_echo_hdr *)((const uint8_t *)p->payload + hlen);
+    uint16_t idx = lwip_ntohs(iecho->seqno);
+    if ((ICMPH_TYPE(iecho) != ICMP_ER) || (iecho->id != PROBE_ID) || (idx >= LWIP_ROUTE_INTFS)) {
+        return 0; // Wasn't ours
+    }
+    _health[idx].misses = 0;
+    _health[idx].waiting = false;
+    pbuf_free(p);
+    return 1;
+}
+
+static void _probeSend(int idx, netif *n) {
+    const ip4_addr_t *dst = ip4_addr_isany_val(_probeHost) ? netif_ip4_gw(n) : &_probeHost;
+    if (ip4_addr_isany(dst)) {
+        return; // Nothing to ask, it's only good for its own subnet anyway
+    }
+    int size = sizeof(struct icmp_echo_hdr) + PROBE_DATA_SIZE;
+    pbuf *p = pbuf_alloc(PBUF_IP, size, PBUF_RAM);
+    if (!p) {
+        return;
+    }
+    struct icmp_echo_hdr *iecho = (struct icmp_echo_hdr *)p->payload;
+    ICMPH_TYPE_SET(iecho, ICMP_ECHO);
+    ICMPH_CODE_SET(iecho, 0);
+    iecho->chksum = 0;
+    iecho->id = PROBE_ID;
+    iecho->seqno = lwip_htons(idx);
+    memset((uint8_t *)iecho + sizeof(*iecho), 0, PROBE_DATA_SIZE);
+    iecho->chksum = inet_chksum(iecho, size);
+    ip_addr_t to, from;
+    ip_addr_copy_from_ip4(to, *dst);
+    ip_addr_copy_from_ip4(from, *netif_ip4_addr(n));
+    // Straight out of this interface, whatever the routing says
+    raw_sendto_if_src(_probePCB, p, &to, n, &from);
+    pbuf_free(p);
+}
+
+// lwIP timer, every _probeMS.  An answer still outstanding from the last round is a miss
+static void _probeAll(void *arg) {
+    (void) arg;
+    for (auto &h : _health) {
+        netif *n;
+        bool present = false;
+        NETIF_FOREACH(n) {
+            present |= (n == h.intf);
+        }
+        if (!present) {
+            h.intf = nullptr;
+        }
+    }
+    netif *n;
+    NETIF_FOREACH(n) {
+        if (!_usable(n)) {
+            continue;
+        }
+        Health *h = nullptr;
+        for (auto &e : _health) {
+            if (e.intf == n) {
+                h = &e;
+                break;
+            } else if (!e.intf && !h) {
+                h = &e;
+            }
+        }
+        if (!h) {
+            continue;
+        }
+        if (h->intf != n) {
+            h->intf = n;
+            h->misses = 0;
+            h->waiting = false;
+        }
+        if (h->waiting && (h->misses < 255)) {
+            h->misses++;
+        }
+        h->waiting = true;
+        _probeSend(h - _health, n);
+    }
+    sys_timeout(_probeMS, _probeAll, nullptr);
+}
+
+void LwipIntf::healthCheck(uint32_t intervalMs, uint8_t misses, const IPAddress& probe) {
+    LWIPMutex m;
+    sys_untimeout(_probeAll, nullptr);
+    _probeMS = intervalMs;
+    _probeMisses = misses ? misses : 1;
+    ip4_addr_set_u32(&_probeHost, probe.isV4() ? probe.v4() : 0);
+    for (auto &h : _health) {
+        h.intf = nullptr;
+    }
+    if (!intervalMs) {
+        if (_probePCB) {
+            raw_remove(_probePCB);
+            _probePCB = nullptr;
+        }
+        return;
+    }
+    if (!_probePCB) {
+        _probePCB = raw_new(IP_PROTO_ICMP);
+        if (!_probePCB) {
+            _probeMS = 0;
+            return;
+        }
+        raw_recv(_probePCB, _probeRecv, nullptr);
+        raw_bind(_probePCB, IP_ADDR_ANY);
+    }
+    _install();
+    _probeAll(nullptr);
+}
+
+bool LwipIntf::healthy(const netif* intf) {
+    LWIPMutex m;
+    return intf && _healthy(intf);
+}
+
+void LwipIntf::balanceConnections(bool enable) {
+    LWIPMutex m;
+    _balance = enable;
+    _install();
+}
+
+void LwipIntf::routeConnection(tcp_pcb* pcb, const ip_addr_t* dest) {
+    if (!_balance || !IP_IS_V4(dest) || (pcb->netif_idx != NETIF_NO_INDEX) || !ip_addr_isany(&pcb->local_ip)) {
+        return;
+    }
+    const ip4_addr_t *d = ip_2_ip4(dest);
+    if (_onLink(d) || _policy(d)) {
+        return;
+    }
+    // The next healthy interface with a gateway after the last one used, by number
+    netif *n, *first = nullptr, *next = nullptr;
+    NETIF_FOREACH(n) {
+        if (ip4_addr_isany_val(*netif_ip4_gw(n)) || !_healthy(n)) {
+            continue;
+        }
+        if (!first || (n->num < first->num)) {
+            first = n;
+        }
+        if ((n->num > _lastNum) && (!next || (n->num < next->num))) {
+            next = n;
+        }
+    }
+    n = next ? next : first;
+    if (n) {
+        _lastNum = n->num;
+        tcp_bind_netif(pcb, n);
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <LwipIntfDev.h>
+#include <utility/RMII.h>
+
+// rxBase: RXD0, RXD1, CRS_DV.  txBase: TXD0, TXD1, TX_EN.  CRS_DV doubles as the RX interrupt.
+class RMIIlwIP : public LwipIntfDev<RMII> {
+public:
+    RMIIlwIP(pin_size_t rxBase, pin_size_t txBase, pin_size_t refClk, pin_size_t mdio, pin_size_t mdc) :
+        LwipIntfDev<RMII>(-1, SPI, rxBase + 2) {
+        setPins(rxBase, txBase, refClk, mdio, mdc);
+    }
+};
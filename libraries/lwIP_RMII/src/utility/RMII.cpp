@@ -0,0 +1,388 @@
+/*
+    RMII <-> LWIP driver for 100Mbit Ethernet PHYs (LAN8720 and the like), using PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "RMII.h"
+#include "rmii.pio.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/irq.h>
+#include <hardware/sync.h>
+
+extern "C" uint32_t __dmaCRC32Raw(uint32_t crc, const void *data, size_t len);
+
+// The CRC32 register after running over a frame and its own good FCS
+#define RMII_CRC_RESIDUE 0xdebb20e3
+
+// 7 bytes of preamble and the SFD, sent ahead of every frame
+static const uint8_t _preamble[8] = { 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5 };
+
+// Only one RMII port at a time, its RX SM's frame-end IRQ comes here
+static RMII *_instance = nullptr;
+
+RMII::RMII(int8_t cs, arduino::SPIClass& spi, int8_t intr) {
+    (void) cs;
+    (void) spi;
+    (void) intr;
+}
+
+void RMII::setPins(pin_size_t rxBase, pin_size_t txBase, pin_size_t refClk, pin_size_t mdio, pin_size_t mdc) {
+    _rxBase = rxBase;
+    _txBase = txBase;
+    _refClk = refClk;
+    _mdio = mdio;
+    _mdc = mdc;
+}
+
+// Copy a program, pointing each "wait gpio" at REF_CLK
+static void _patchProgram(pio_program_t *p, uint16_t *insn, const pio_program_t *pg, int ref) {
+    memcpy(insn, pg->instructions, pg->length * 2);
+    for (int i = 0; i < pg->length; i++) {
+        if ((insn[i] & 0xe060) == 0x2000) {
+            insn[i] = (insn[i] & ~0x1f) | ref;
+        }
+    }
+    p->instructions = insn;
+    p->length = pg->length;
+    p->origin = pg->origin;
+}
+
+// Clause 22 management frames, bit-banged with MDC well under its 2.5MHz limit.  MDIO is
+// only ever driven low, the PHY board's pull-up gives the ones.
+void RMII::_mdioOut(uint32_t bits, int count) {
+    while (count--) {
+        gpio_set_dir(_mdio, (bits & (1u << count)) ? GPIO_IN : GPIO_OUT);
+        delayMicroseconds(1);
+        gpio_put(_mdc, 1);
+        delayMicroseconds(1);
+        gpio_put(_mdc, 0);
+    }
+}
+
+uint16_t RMII::phyRead(int reg) {
+    _mdioOut(0xffffffff, 32);
+    _mdioOut(0x6 << 10 | (_phy & 0x1f) << 5 | (reg & 0x1f), 14);
+    gpio_set_dir(_mdio, GPIO_IN);
+    uint16_t v = 0;
+    for (int i = 0; i < 18; i++) {  // Turnaround, 16 data bits, and idle
+        delayMicroseconds(1);
+        gpio_put(_mdc, 1);
+        delayMicroseconds(1);
+        gpio_put(_mdc, 0);
+        if ((i >= 1) && (i <= 16)) {
+            v = (v << 1) | (gpio_get(_mdio) ? 1 : 0);
+        }
+    }
+    return v;
+}
+
+void RMII::phyWrite(int reg, uint16_t value) {
+    _mdioOut(0xffffffff, 32);
+    _mdioOut(0x5 << 12 | (_phy & 0x1f) << 7 | (reg & 0x1f) << 2 | 0x2, 16);
+    _mdioOut(value, 16);
+    gpio_set_dir(_mdio, GPIO_IN);
+}
+
+bool RMII::linkUp() {
+    if (_phy < 0) {
+        return false;
+    }
+    phyRead(1);   // Link status latches low, the second read is the current state
+    return phyRead(1) & 0x0004;
+}
+
+bool RMII::begin(const uint8_t* address, netif* netif) {
+    (void) netif;
+    if (_running || _instance) {
+        return false;
+    }
+    // Each REF_CLK half period must be at least two PIO instructions
+    uint32_t sys = clock_get_hz(clk_sys);
+    if (sys < 200000000) {
+        DEBUGV("RMII: needs a system clock of at least 200MHz\n");
+        return false;
+    }
+    memcpy(_mac, address, 6);
+
+    if (_refOut) {
+        if (sys % 50000000) {
+            DEBUGV("RMII: can't make REF_CLK from %lu Hz\n", sys);
+            return false;
+        }
+        clock_gpio_init(_refClk, CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_SYS, sys / 50000000);
+    } else {
+        gpio_init(_refClk);
+    }
+
+    gpio_init(_mdc);
+    gpio_set_dir(_mdc, GPIO_OUT);
+    gpio_init(_mdio);
+    gpio_put(_mdio, 0);
+    gpio_set_dir(_mdio, GPIO_IN);
+    gpio_pull_up(_mdio);
+    for (_phy = 0; _phy < 32; _phy++) {
+        uint16_t id = phyRead(2);
+        if (id && (id != 0xffff)) {
+            break;
+        }
+    }
+    if (_phy == 32) {
+        DEBUGV("RMII: no PHY found\n");
+        _phy = -1;
+        return false;
+    }
+    phyWrite(0, 0x8000);
+    uint32_t start = millis();
+    while ((phyRead(0) & 0x8000) && (millis() - start < 500)) {
+        delay(1);
+    }
+    // There's no collision handling, so only 100Mbit full duplex is offered
+    phyWrite(4, 0x0101);
+    phyWrite(0, 0x1200);
+
+    _rxRing = (uint8_t *)aligned_alloc(RMII_RX_BUFFER, RMII_RX_BUFFER);
+    _rxDMA = dma_claim_unused_channel(false);
+    _txDMA = dma_claim_unused_channel(false);
+    _patchProgram(&_rxPgm, _rxInsn, &rmii_rx_program, _refClk);
+    _patchProgram(&_txPgm, _txInsn, &rmii_tx_program, _refClk);
+    if (!_rxProgram) {
+        _rxProgram = new PIOProgram(&_rxPgm);
+        _txProgram = new PIOProgram(&_txPgm);
+    }
+    int off;
+    if (!_rxRing || (_rxDMA < 0) || (_txDMA < 0) || !_rxProgram->prepare(&_rxPIO, &_rxSM, &off)) {
+        DEBUGV("RMII: out of memory, DMA channels or PIO resources\n");
+        _rxSM = -1;
+        end();
+        return false;
+    }
+    rmii_rx_program_init(_rxPIO, _rxSM, off, _rxBase);
+    if (!_txProgram->prepare(&_txPIO, &_txSM, &off)) {
+        DEBUGV("RMII: out of PIO resources\n");
+        _txSM = -1;
+        end();
+        return false;
+    }
+    rmii_tx_program_init(_txPIO, _txSM, off, _txBase);
+
+    // Bytes come from the top of each FIFO word into the ring, until 4G of them have gone by
+    _rxBaseCount = 0;
+    _rxEnd = 0;
+    _rxWriter = 0;
+    _rxReader = 0;
+    dma_channel_config c = dma_channel_get_default_config(_rxDMA);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, __builtin_ctz(RMII_RX_BUFFER));
+    channel_config_set_dreq(&c, pio_get_dreq(_rxPIO, _rxSM, false));
+    dma_channel_configure(_rxDMA, &c, _rxRing, (io_rw_8 *)&_rxPIO->rxf[_rxSM] + 3, 0xffffffff, true);
+
+    c = dma_channel_get_default_config(_txDMA);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(_txPIO, _txSM, true));
+    dma_channel_configure(_txDMA, &c, &_txPIO->txf[_txSM], _txBuf[0], 0, false);
+
+    // The SM's relative IRQ flag is its own number, routed to the PIO's second IRQ line
+    _instance = this;
+    int irqn = (_rxPIO == pio0) ? PIO0_IRQ_1 : PIO1_IRQ_1;
+    pio_interrupt_clear(_rxPIO, _rxSM);
+    pio_set_irq1_source_enabled(_rxPIO, (pio_interrupt_source)(pis_interrupt0 + _rxSM), true);
+    irq_set_exclusive_handler(irqn, (_rxPIO == pio0) ? _rxIRQ0 : _rxIRQ1);
+    irq_set_enabled(irqn, true);
+
+    pio_sm_set_enabled(_rxPIO, _rxSM, true);
+    pio_sm_set_enabled(_txPIO, _txSM, true);
+    _running = true;
+    return true;
+}
+
+void RMII::end() {
+    _running = false;
+    if (_rxSM >= 0) {
+        int irqn = (_rxPIO == pio0) ? PIO0_IRQ_1 : PIO1_IRQ_1;
+        irq_set_enabled(irqn, false);
+        irq_remove_handler(irqn, (_rxPIO == pio0) ? _rxIRQ0 : _rxIRQ1);
+        pio_set_irq1_source_enabled(_rxPIO, (pio_interrupt_source)(pis_interrupt0 + _rxSM), false);
+        pio_sm_set_enabled(_rxPIO, _rxSM, false);
+        PIOProgram::unprepare(_rxPIO, _rxSM);
+        _rxSM = -1;
+    }
+    if (_txSM >= 0) {
+        pio_sm_set_enabled(_txPIO, _txSM, false);
+        PIOProgram::unprepare(_txPIO, _txSM);
+        _txSM = -1;
+    }
+    if (_rxDMA >= 0) {
+        dma_channel_abort(_rxDMA);
+        dma_channel_unclaim(_rxDMA);
+        _rxDMA = -1;
+    }
+    if (_txDMA >= 0) {
+        dma_channel_abort(_txDMA);
+        dma_channel_unclaim(_txDMA);
+        _txDMA = -1;
+    }
+    free(_rxRing);
+    _rxRing = nullptr;
+    if (_instance == this) {
+        _instance = nullptr;
+    }
+}
+
+void RMII::_rxIRQ0() {
+    _instance->_rxIRQ();
+}
+
+void RMII::_rxIRQ1() {
+    _instance->_rxIRQ();
+}
+
+// The frame ends wherever the DMA has got to once the last bytes are out of the FIFO
+void RMII::_rxIRQ() {
+    pio_interrupt_clear(_rxPIO, _rxSM);
+    while (!pio_sm_is_rx_fifo_empty(_rxPIO, _rxSM)) {
+        /* noop */
+    }
+    uint32_t remaining = dma_channel_hw_addr(_rxDMA)->transfer_count;
+    uint32_t now = _rxBaseCount + (0xffffffff - remaining);
+    uint32_t len = now - _rxEnd;
+    if ((len < 64) || (len > 1522) || (_rxWriter - _rxReader >= RMII_RX_FRAMES)) {
+        _rxErrors++;
+    } else {
+        Frame &f = _frames[_rxWriter % RMII_RX_FRAMES];
+        f.start = _rxEnd;
+        f.len = len;
+        f.checked = false;
+        _rxWriter++;
+    }
+    _rxEnd = now;
+    // Between frames is the only safe time to restart the count
+    if (remaining < 0x80000000) {
+        dma_channel_abort(_rxDMA);
+        remaining = dma_channel_hw_addr(_rxDMA)->transfer_count;
+        _rxBaseCount += 0xffffffff - remaining;
+        dma_channel_set_trans_count(_rxDMA, 0xffffffff, true);
+    }
+}
+
+uint32_t RMII::_rxWritten() {
+    uint32_t irqs = save_and_disable_interrupts();
+    uint32_t w = _rxBaseCount + (0xffffffff - dma_channel_hw_addr(_rxDMA)->transfer_count);
+    restore_interrupts(irqs);
+    return w;
+}
+
+void RMII::_rxCopy(uint32_t pos, uint8_t* dst, size_t len) {
+    pos &= RMII_RX_BUFFER - 1;
+    size_t n = std::min(len, (size_t)(RMII_RX_BUFFER - pos));
+    memcpy(dst, _rxRing + pos, n);
+    memcpy(dst + n, _rxRing, len - n);
+}
+
+// Drops frames the DMA has lapped, frames for other stations, and bad FCSs
+bool RMII::_rxCheck(Frame& f) {
+    if (_rxWritten() - f.start > RMII_RX_BUFFER) {
+        _rxErrors++;
+        return false;
+    }
+    uint8_t dst[6];
+    _rxCopy(f.start, dst, 6);
+    if (!(dst[0] & 1) && memcmp(dst, _mac, 6)) {
+        return false;
+    }
+    uint32_t pos = f.start & (RMII_RX_BUFFER - 1);
+    size_t n = std::min((size_t)f.len, (size_t)(RMII_RX_BUFFER - pos));
+    uint32_t crc = __dmaCRC32Raw(0xffffffff, _rxRing + pos, n);
+    if (n < f.len) {
+        crc = __dmaCRC32Raw(crc, _rxRing, f.len - n);
+    }
+    if (crc != RMII_CRC_RESIDUE) {
+        _rxErrors++;
+        return false;
+    }
+    return true;
+}
+
+uint16_t RMII::readFrameSize() {
+    if (!_running) {
+        return 0;
+    }
+    while (_rxReader != _rxWriter) {
+        Frame &f = _frames[_rxReader % RMII_RX_FRAMES];
+        if (f.checked || _rxCheck(f)) {
+            f.checked = true;
+            return f.len - 4;
+        }
+        _rxReader++;
+    }
+    return 0;
+}
+
+uint16_t RMII::readFrameData(pbuf* p, uint16_t framesize) {
+    Frame &f = _frames[_rxReader % RMII_RX_FRAMES];
+    uint32_t pos = f.start;
+    for (pbuf* q = p; q && (pos - f.start < framesize); q = q->next) {
+        _rxCopy(pos, (uint8_t *)q->payload, q->len);
+        pos += q->len;
+    }
+    _rxReader++;
+    // New frames may have come in over this one while it was being copied
+    if (_rxWritten() - f.start > RMII_RX_BUFFER) {
+        _rxErrors++;
+        return 0;
+    }
+    return framesize;
+}
+
+void RMII::discardFrame(uint16_t framesize) {
+    (void) framesize;
+    if (_rxReader != _rxWriter) {
+        _rxReader++;
+    }
+}
+
+// The frame is copied in behind the preamble, padded to the 60 byte minimum and followed
+// by its FCS, while the DMA is still sending the one before
+uint16_t RMII::sendFrame(const uint8_t* data, uint16_t datalen) {
+    if (!_running || (datalen > 1514)) {
+        return 0;
+    }
+    uint32_t *buf = _txBuf[_txNext];
+    _txNext ^= 1;
+    uint8_t *b = (uint8_t *)(buf + 1);
+    memcpy(b, _preamble, sizeof(_preamble));
+    memcpy(b + 8, data, datalen);
+    size_t len = datalen;
+    if (len < 60) {
+        memset(b + 8 + len, 0, 60 - len);
+        len = 60;
+    }
+    uint32_t fcs = ~__dmaCRC32Raw(0xffffffff, b + 8, len);
+    memcpy(b + 8 + len, &fcs, 4);
+    len += 8 + 4;
+    buf[0] = len * 4 - 1;
+    while (dma_channel_is_busy(_txDMA)) {
+        /* noop */
+    }
+    dma_channel_transfer_from_buffer_now(_txDMA, buf, 1 + len / 4 + 1);
+    return datalen;
+}
@@ -0,0 +1,135 @@
+/*
+    RMII <-> LWIP driver for 100Mbit Ethernet PHYs (LAN8720 and the like), using PIO and DMA
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "lwip/netif.h"
+
+// Received frames land in this DMA ring (a power of 2, at most 32K) and wait there for lwIP
+#ifndef RMII_RX_BUFFER
+#define RMII_RX_BUFFER 8192
+#endif
+
+// Frames which can be waiting in the ring at once
+#ifndef RMII_RX_FRAMES
+#define RMII_RX_FRAMES 16
+#endif
+
+class RMII {
+public:
+    // LwipIntfDev's constructor arguments.  There's no SPI, and intr must be CRS_DV, whose
+    // falling edge at the end of every frame gets the received frames processed.
+    RMII(int8_t cs, arduino::SPIClass& spi, int8_t intr);
+
+    // RXD0, RXD1, CRS_DV on rxBase..rxBase+2 and TXD0, TXD1, TX_EN on txBase..txBase+2, plus
+    // the 50MHz REF_CLK and the PHY's management interface.  Call before begin().
+    void setPins(pin_size_t rxBase, pin_size_t txBase, pin_size_t refClk, pin_size_t mdio, pin_size_t mdc);
+
+    // Drive REF_CLK from the RP2040 (GPIO 21, 23, 24 or 25) instead of the PHY's oscillator.
+    // The system clock must then be a multiple of 50MHz.
+    void setRefClockOutput(bool out) {
+        _refOut = out;
+    }
+
+    bool begin(const uint8_t* address, netif* netif);
+    void end();
+
+    uint16_t sendFrame(const uint8_t* data, uint16_t datalen);
+    uint16_t readFrameSize();
+    uint16_t readFrameData(pbuf* p, uint16_t framesize);
+    void discardFrame(uint16_t framesize);
+
+    bool interruptIsPossible() {
+        return true;
+    }
+
+    // Every multicast frame is received, lwIP filters them
+    bool multicastFilter(const uint8_t* mac, bool add) {
+        (void) mac;
+        (void) add;
+        return true;
+    }
+
+    // Only 100Mbit full duplex is advertised, so up means that
+    bool linkUp();
+
+    // The PHY's management registers
+    uint16_t phyRead(int reg);
+    void phyWrite(int reg, uint16_t value);
+
+    // Frames dropped for a bad FCS, a bad length, or because the ring or frame list was full
+    uint32_t rxErrors() const {
+        return _rxErrors;
+    }
+
+protected:
+    typedef struct {
+        uint32_t start;       // Ring position, counted in bytes since begin()
+        uint16_t len;         // Including the FCS
+        bool checked;
+    } Frame;
+
+    void _mdioOut(uint32_t bits, int count);
+    uint32_t _rxWritten();
+    void _rxCopy(uint32_t pos, uint8_t* dst, size_t len);
+    bool _rxCheck(Frame& f);
+    void _rxIRQ();
+    static void _rxIRQ0();
+    static void _rxIRQ1();
+
+    pin_size_t _rxBase = 0;
+    pin_size_t _txBase = 0;
+    pin_size_t _refClk = 0;
+    pin_size_t _mdio = 0;
+    pin_size_t _mdc = 0;
+    bool _refOut = false;
+    bool _running = false;
+    int _phy = -1;
+    uint8_t _mac[6];
+
+    // The programs with their "wait gpio" pointed at REF_CLK
+    uint16_t _rxInsn[14];
+    uint16_t _txInsn[15];
+    pio_program_t _rxPgm;
+    pio_program_t _txPgm;
+    PIOProgram* _rxProgram = nullptr;
+    PIOProgram* _txProgram = nullptr;
+    PIO _rxPIO;
+    PIO _txPIO;
+    int _rxSM = -1;
+    int _txSM = -1;
+
+    int _rxDMA = -1;
+    int _txDMA = -1;
+    uint8_t* _rxRing = nullptr;
+    uint32_t _rxBaseCount = 0;    // Bytes written by earlier runs of the RX DMA
+    uint32_t _rxEnd = 0;          // Where the last frame ended
+    Frame _frames[RMII_RX_FRAMES];
+    volatile uint32_t _rxWriter = 0;
+    volatile uint32_t _rxReader = 0;
+    volatile uint32_t _rxErrors = 0;
+
+    // Two frames, each behind its dibit count, so one fills while the other goes out.  The
+    // last word is always partly or wholly padding.
+    uint32_t _txBuf[2][1 + (8 + 1514 + 4) / 4 + 1];
+    int _txNext = 0;
+};
@@ -0,0 +1,121 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// ------- //
+// rmii_rx //
+// ------- //
+
+#define rmii_rx_wrap_target 0
+#define rmii_rx_wrap 13
+
+static const uint16_t rmii_rx_program_instructions[] = {
+    //     .wrap_target
+    0x2022, //  0: wait   0 pin, 2
+    0x20a2, //  1: wait   1 pin, 2
+    0x20a1, //  2: wait   1 pin, 1
+    0x2000, //  3: wait   0 gpio, 0
+    0x2080, //  4: wait   1 gpio, 0
+    0x2000, //  5: wait   0 gpio, 0
+    0x4002, //  6: in     pins, 2
+    0x00c4, //  7: jmp    pin, 4
+    0x2080, //  8: wait   1 gpio, 0
+    0x2000, //  9: wait   0 gpio, 0
+    0x4002, // 10: in     pins, 2
+    0x00c4, // 11: jmp    pin, 4
+    0xa0c3, // 12: mov    isr, null
+    0xc010, // 13: irq    nowait 0 rel
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program rmii_rx_program = {
+    .instructions = rmii_rx_program_instructions,
+    .length = 14,
+    .origin = -1,
+};
+
+static inline pio_sm_config rmii_rx_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + rmii_rx_wrap_target, offset + rmii_rx_wrap);
+    return c;
+}
+#endif
+
+// ------- //
+// rmii_tx //
+// ------- //
+
+#define rmii_tx_wrap_target 0
+#define rmii_tx_wrap 14
+
+static const uint16_t rmii_tx_program_instructions[] = {
+    //     .wrap_target
+    0x7020, //  0: out    x, 32           side 0
+    0x2080, //  1: wait   1 gpio, 0
+    0x2000, //  2: wait   0 gpio, 0
+    0x7802, //  3: out    pins, 2         side 1
+    0x0041, //  4: jmp    x--, 1
+    0x2080, //  5: wait   1 gpio, 0
+    0x2000, //  6: wait   0 gpio, 0
+    0xb003, //  7: mov    pins, null      side 0
+    0x6060, //  8: out    null, 32
+    0xe057, //  9: set    y, 23
+    0x2080, // 10: wait   1 gpio, 0
+    0x2000, // 11: wait   0 gpio, 0
+    0x2080, // 12: wait   1 gpio, 0
+    0x2000, // 13: wait   0 gpio, 0
+    0x008a, // 14: jmp    y--, 10
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program rmii_tx_program = {
+    .instructions = rmii_tx_program_instructions,
+    .length = 15,
+    .origin = -1,
+};
+
+static inline pio_sm_config rmii_tx_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + rmii_tx_wrap_target, offset + rmii_tx_wrap);
+    sm_config_set_sideset(&c, 2, true, false);
+    return c;
+}
+
+static inline void rmii_rx_program_init(PIO pio, uint sm, uint offset, uint pin_rx) {
+    pio_sm_set_consecutive_pindirs(pio, sm, pin_rx, 3, false);
+    pio_sm_config c = rmii_rx_program_get_default_config(offset);
+    sm_config_set_in_pins(&c, pin_rx);
+    sm_config_set_jmp_pin(&c, pin_rx + 2);
+    // IN shifts to right, autopush every byte
+    sm_config_set_in_shift(&c, true, true, 8);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    pio_sm_init(pio, sm, offset, &c);
+}
+
+static inline void rmii_tx_program_init(PIO pio, uint sm, uint offset, uint pin_tx) {
+    // TXD0, TXD1 and TX_EN all start low
+    pio_sm_set_pins_with_mask(pio, sm, 0, 7u << pin_tx);
+    pio_sm_set_consecutive_pindirs(pio, sm, pin_tx, 3, true);
+    for (uint i = 0; i < 3; i++) {
+        pio_gpio_init(pio, pin_tx + i);
+    }
+    pio_sm_config c = rmii_tx_program_get_default_config(offset);
+    sm_config_set_out_pins(&c, pin_tx, 2);
+    sm_config_set_sideset_pins(&c, pin_tx + 2);
+    // OUT shifts to right, autopull every word
+    sm_config_set_out_shift(&c, true, true, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    pio_sm_init(pio, sm, offset, &c);
+    // Start with the OSR empty, so the first out autopulls
+    pio_sm_exec(pio, sm, pio_encode_out(pio_null, 32));
+}
+
+#endif
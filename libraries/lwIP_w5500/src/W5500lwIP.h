@@ -0,0 +1,6 @@
+#pragma once
+
+#include <LwipIntfDev.h>
+#include <utility/w5500.h>
+
+using Wiznet5500lwIP = LwipIntfDev<Wiznet5500>;
@@ -0,0 +1,270 @@
+/*
+    WIZnet W5500 <-> LWIP driver, the chip's socket 0 in MACRAW mode
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "w5500.h"
+
+// SPI frame block selects
+#define BSB_COMMON   0
+#define BSB_S0_REG   1
+#define BSB_S0_TX    2
+#define BSB_S0_RX    3
+#define BSB_SN_REG(n) (1 + 4 * (n))
+
+// Common registers
+#define MR           0x0000
+#define SHAR         0x0009
+#define SIMR         0x0018
+#define PHYCFGR      0x002e
+#define VERSIONR     0x0039
+
+// Socket registers
+#define Sn_MR        0x0000
+#define Sn_CR        0x0001
+#define Sn_IR        0x0002
+#define Sn_SR        0x0003
+#define Sn_RXBUF_SIZE 0x001e
+#define Sn_TXBUF_SIZE 0x001f
+#define Sn_TX_WR     0x0024
+#define Sn_RX_RSR    0x0026
+#define Sn_RX_RD     0x0028
+#define Sn_IMR       0x002c
+
+#define Sn_MR_MACRAW 0x04
+#define Sn_MR_MFEN   0x80
+#define Sn_CR_OPEN   0x01
+#define Sn_CR_CLOSE  0x10
+#define Sn_CR_SEND   0x20
+#define Sn_CR_RECV   0x40
+#define Sn_IR_RECV   0x04
+#define Sn_IR_SENDOK 0x10
+#define SOCK_MACRAW  0x42
+
+// Every RX frame comes behind its length, which counts these 2 bytes too
+#define RX_HDR       2
+#define MAX_FRAME    1514
+
+static_assert(W5500_RX_BURST >= 2 * (RX_HDR + MAX_FRAME), "W5500_RX_BURST must hold two frames");
+
+// Only SPIClassRP2040 implements HardwareSPI here, and it has the transfer() we want
+Wiznet5500::Wiznet5500(int8_t cs, arduino::SPIClass& spi, int8_t intr) :
+    _cs(cs), _spi(static_cast<SPIClassRP2040&>(spi)) {
+    (void) intr;
+}
+
+// One variable length data mode frame: address, control byte, then any amount of data with
+// the chip incrementing the address.  Big transfers go by DMA straight to or from the buffer.
+void Wiznet5500::_xfer(uint16_t addr, uint8_t block, bool write, void* data, size_t len) {
+    uint8_t hdr[3] = { (uint8_t)(addr >> 8), (uint8_t)addr, (uint8_t)((block << 3) | (write ? 0x04 : 0x00)) };
+    _spi.beginTransaction(SPISettings(W5500_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+    digitalWrite(_cs, LOW);
+    _spi.transfer(hdr, nullptr, sizeof(hdr));
+    if (write) {
+        _spi.transfer(data, nullptr, len);
+    } else {
+        _spi.transfer(nullptr, data, len);
+    }
+    digitalWrite(_cs, HIGH);
+    _spi.endTransaction();
+}
+
+uint8_t Wiznet5500::_read8(uint16_t addr, uint8_t block) {
+    uint8_t v;
+    _xfer(addr, block, false, &v, 1);
+    return v;
+}
+
+// The chip's 16-bit counters can change between the two bytes, so read until two agree
+uint16_t Wiznet5500::_read16(uint16_t addr, uint8_t block) {
+    uint16_t v, last;
+    uint8_t b[2];
+    _xfer(addr, block, false, b, 2);
+    v = (b[0] << 8) | b[1];
+    do {
+        last = v;
+        _xfer(addr, block, false, b, 2);
+        v = (b[0] << 8) | b[1];
+    } while (v != last);
+    return v;
+}
+
+void Wiznet5500::_write8(uint16_t addr, uint8_t block, uint8_t value) {
+    _xfer(addr, block, true, &value, 1);
+}
+
+void Wiznet5500::_write16(uint16_t addr, uint8_t block, uint16_t value) {
+    uint8_t b[2] = { (uint8_t)(value >> 8), (uint8_t)value };
+    _xfer(addr, block, true, b, 2);
+}
+
+// Sn_CR reads back 0 once the chip has taken the command
+void Wiznet5500::_command(uint8_t cmd) {
+    _write8(Sn_CR, BSB_S0_REG, cmd);
+    uint32_t start = millis();
+    while (_read8(Sn_CR, BSB_S0_REG) && (millis() - start < 10)) {
+        /* noop */
+    }
+}
+
+bool Wiznet5500::_open() {
+    _command(Sn_CR_CLOSE);
+    _write8(Sn_MR, BSB_S0_REG, Sn_MR_MACRAW | Sn_MR_MFEN);
+    _command(Sn_CR_OPEN);
+    if (_read8(Sn_SR, BSB_S0_REG) != SOCK_MACRAW) {
+        return false;
+    }
+    _rxRd = _read16(Sn_RX_RD, BSB_S0_REG);
+    _txWr = _read16(Sn_TX_WR, BSB_S0_REG);
+    _txBusy = false;
+    _rxPos = 0;
+    _rxLen = 0;
+    return true;
+}
+
+bool Wiznet5500::begin(const uint8_t* address, netif* netif) {
+    (void) netif;
+    _spi.begin();
+    pinMode(_cs, OUTPUT);
+    digitalWrite(_cs, HIGH);
+
+    _write8(MR, BSB_COMMON, 0x80);
+    uint32_t start = millis();
+    while (_read8(MR, BSB_COMMON) & 0x80) {
+        if (millis() - start > 100) {
+            return false;
+        }
+    }
+    if (_read8(VERSIONR, BSB_COMMON) != 0x04) {
+        DEBUGV("W5500: not found\n");
+        return false;
+    }
+    _xfer(SHAR, BSB_COMMON, true, (void *)address, 6);
+
+    // Socket 0 gets all 16K of RX and TX buffer
+    for (int i = 0; i < 8; i++) {
+        _write8(Sn_RXBUF_SIZE, BSB_SN_REG(i), i ? 0 : 16);
+        _write8(Sn_TXBUF_SIZE, BSB_SN_REG(i), i ? 0 : 16);
+    }
+    if (!_open()) {
+        return false;
+    }
+    // Only RX raises INTn, SEND completion is polled for
+    _write8(Sn_IMR, BSB_S0_REG, Sn_IR_RECV);
+    _write8(SIMR, BSB_COMMON, 0x01);
+    _running = true;
+    return true;
+}
+
+void Wiznet5500::end() {
+    if (_running) {
+        _write8(SIMR, BSB_COMMON, 0);
+        _command(Sn_CR_CLOSE);
+        _write8(MR, BSB_COMMON, 0x80);
+        _running = false;
+    }
+}
+
+bool Wiznet5500::isLinked() {
+    return _read8(PHYCFGR, BSB_COMMON) & 0x01;
+}
+
+// Hands back what lwIP has taken from the last burst and reads out as much as is waiting.
+// RECV is cleared first, so a frame arriving after the RSR read pulls INTn low again.
+bool Wiznet5500::_rxRefill() {
+    if (_rxPos) {
+        _rxRd += _rxPos;
+        _write16(Sn_RX_RD, BSB_S0_REG, _rxRd);
+        _command(Sn_CR_RECV);
+    }
+    _rxPos = 0;
+    _rxLen = 0;
+    _write8(Sn_IR, BSB_S0_REG, Sn_IR_RECV);
+    uint16_t rsr = _read16(Sn_RX_RSR, BSB_S0_REG);
+    if (!rsr) {
+        return false;
+    }
+    _rxLen = std::min((size_t)rsr, sizeof(_rxBuf));
+    _xfer(_rxRd, BSB_S0_RX, false, _rxBuf, _rxLen);
+    return true;
+}
+
+// Frames come out of the burst one by one, with a new burst once the last whole one is gone
+uint16_t Wiznet5500::readFrameSize() {
+    if (!_running) {
+        return 0;
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        if (_rxPos + RX_HDR <= _rxLen) {
+            size_t n = (_rxBuf[_rxPos] << 8) | _rxBuf[_rxPos + 1];
+            if ((n <= RX_HDR) || (n > RX_HDR + MAX_FRAME + 4)) {
+                // Lost our place in the RX buffer, only a restart finds it again
+                DEBUGV("W5500: bad RX length %d, restarting socket\n", n);
+                _open();
+                return 0;
+            }
+            if (_rxPos + n <= _rxLen) {
+                return n - RX_HDR;
+            }
+        }
+        // Nothing more (or only the start of a frame) in this burst
+        if ((pass == 1) || !_rxRefill()) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+uint16_t Wiznet5500::readFrameData(pbuf* p, uint16_t framesize) {
+    const uint8_t *src = _rxBuf + _rxPos + RX_HDR;
+    for (pbuf* q = p; q; q = q->next) {
+        memcpy(q->payload, src, q->len);
+        src += q->len;
+    }
+    _rxPos += RX_HDR + framesize;
+    return framesize;
+}
+
+void Wiznet5500::discardFrame(uint16_t framesize) {
+    _rxPos += RX_HDR + framesize;
+}
+
+// The frame is written to the chip while the previous one may still be going out, and
+// only then does this wait for its SENDOK before moving the write pointer and sending.
+// The 16K TX buffer always has room for both.
+uint16_t Wiznet5500::sendFrame(const uint8_t* data, uint16_t datalen) {
+    if (!_running || (datalen > MAX_FRAME)) {
+        return 0;
+    }
+    _xfer(_txWr, BSB_S0_TX, true, (void *)data, datalen);
+    if (_txBusy) {
+        uint32_t start = millis();
+        while (!(_read8(Sn_IR, BSB_S0_REG) & Sn_IR_SENDOK)) {
+            if (millis() - start > 10) {
+                DEBUGV("W5500: SEND timed out\n");
+                break;
+            }
+        }
+        _write8(Sn_IR, BSB_S0_REG, Sn_IR_SENDOK);
+    }
+    _txWr += datalen;
+    _write16(Sn_TX_WR, BSB_S0_REG, _txWr);
+    _command(Sn_CR_SEND);
+    _txBusy = true;
+    return datalen;
+}
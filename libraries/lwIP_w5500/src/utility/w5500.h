@@ -0,0 +1,92 @@
+/*
+    WIZnet W5500 <-> LWIP driver, the chip's socket 0 in MACRAW mode
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "lwip/netif.h"
+
+// The W5500 is specified to 33.3MHz, the SPI block picks the fastest rate not above this
+#ifndef W5500_SPI_CLOCK
+#define W5500_SPI_CLOCK 33333333
+#endif
+
+// Received frames are read out of the chip in bursts of up to this many bytes, which must
+// hold at least two full frames
+#ifndef W5500_RX_BURST
+#define W5500_RX_BURST 4096
+#endif
+
+class Wiznet5500 {
+public:
+    /**
+        Constructor that uses the default hardware SPI pins
+        @param cs the Arduino Chip Select / Slave Select pin (default 10)
+    */
+    Wiznet5500(int8_t cs = SS, arduino::SPIClass& spi = SPI, int8_t intr = -1);
+
+    bool begin(const uint8_t* address, netif* netif);
+    void end();
+
+    uint16_t sendFrame(const uint8_t* data, uint16_t datalen);
+    uint16_t readFrameSize();
+    uint16_t readFrameData(pbuf* p, uint16_t framesize);
+    void discardFrame(uint16_t framesize);
+
+    // INTn goes low while socket 0 has received data
+    bool interruptIsPossible() {
+        return true;
+    }
+
+    // The MAC filter only blocks other stations' unicast, every multicast frame comes in
+    bool multicastFilter(const uint8_t* mac, bool add) {
+        (void) mac;
+        (void) add;
+        return true;
+    }
+
+    // From the chip's PHY
+    bool isLinked();
+
+protected:
+    void _xfer(uint16_t addr, uint8_t block, bool write, void* data, size_t len);
+    uint8_t _read8(uint16_t addr, uint8_t block);
+    uint16_t _read16(uint16_t addr, uint8_t block);
+    void _write8(uint16_t addr, uint8_t block, uint8_t value);
+    void _write16(uint16_t addr, uint8_t block, uint16_t value);
+    void _command(uint8_t cmd);
+    bool _open();
+    bool _rxRefill();
+
+    int8_t _cs;
+    SPIClassRP2040& _spi;     // For its two-buffer, DMA-backed transfer()
+    bool _running = false;
+
+    // Chip pointers we keep our own copies of, they only ever move forward by our writes
+    uint16_t _rxRd = 0;
+    uint16_t _txWr = 0;
+    bool _txBusy = false;     // A SEND hasn't been seen to finish yet
+
+    // The last burst, frames [_rxPos, _rxLen) of it still to hand to lwIP
+    uint8_t _rxBuf[W5500_RX_BURST];
+    size_t _rxPos = 0;
+    size_t _rxLen = 0;
+};
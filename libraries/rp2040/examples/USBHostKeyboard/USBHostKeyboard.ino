@@ -0,0 +1,80 @@
+/* Prints whatever is typed on a USB keyboard plugged into a second, PIO-based, USB port */
+/* D+ goes to GP16 and D- to GP17, each through a 22 ohm resistor, and the keyboard's    */
+/* VBUS and GND to the Pico's.  Set Tools->CPU Speed to 120MHz or 240MHz                 */
+/* Needs USBHOST_PIO set to 1 in tusb_config.h and libpico rebuilt, see docs/usb.rst     */
+/* Released to the public domain by Earle F. Philhower, III                             */
+
+#include "tusb.h"
+
+#if !USBHOST_PIO
+
+void setup() {
+  Serial.begin(115200);
+}
+
+void loop() {
+  Serial.println("This core's libpico was built without the USB host port");
+  delay(1000);
+}
+
+#else
+
+static const uint8_t keycodeToAscii[128][2] = { HID_KEYCODE_TO_ASCII };
+static uint8_t lastKeys[6];
+
+void setup() {
+  Serial.begin(115200);
+}
+
+void loop() {
+  // The native USB port still works as usual, Serial and all
+}
+
+void setup1() {
+  // The host port runs entirely on core 1
+  if (!USBHost.begin(16)) {
+    Serial.println("Unable to start the USB host port");
+  }
+}
+
+void loop1() {
+  USBHost.task();
+}
+
+// TinyUSB calls these from USBHost.task(), so on core 1
+extern "C" void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *desc_report, uint16_t desc_len) {
+  (void) desc_report;
+  (void) desc_len;
+  if (tuh_hid_interface_protocol(dev_addr, instance) == HID_ITF_PROTOCOL_KEYBOARD) {
+    Serial.println("Keyboard attached");
+    tuh_hid_receive_report(dev_addr, instance);
+  }
+}
+
+extern "C" void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance) {
+  (void) dev_addr;
+  (void) instance;
+  Serial.println("\nKeyboard removed");
+}
+
+extern "C" void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *report, uint16_t len) {
+  if (len >= sizeof(hid_keyboard_report_t)) {
+    const hid_keyboard_report_t *kbd = (const hid_keyboard_report_t *)report;
+    bool shift = kbd->modifier & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT);
+    for (int i = 0; i < 6; i++) {
+      uint8_t k = kbd->keycode[i];
+      // Only keys which have just gone down, not ones still held from the last report
+      if (k && (k < 128) && !memchr(lastKeys, k, sizeof(lastKeys))) {
+        char c = keycodeToAscii[k][shift ? 1 : 0];
+        if (c) {
+          Serial.print(c == '\r' ? '\n' : c);
+        }
+      }
+    }
+    memcpy(lastKeys, kbd->keycode, sizeof(lastKeys));
+  }
+  // Ask for the next one
+  tuh_hid_receive_report(dev_addr, instance);
+}
+
+#endif
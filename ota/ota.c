@@ -23,6 +23,7 @@
 #include <hardware/structs/scb.h>
 #include <hardware/sync.h>
 #include <hardware/flash.h>
+#include <hardware/dma.h>
 #include <pico/time.h>
 #include <hardware/gpio.h>
 #include <hardware/uart.h>
@@ -54,6 +55,346 @@ void dumphex(uint32_t x) {
 }
 
 static OTACmdPage _ota_cmd;
+const char _ota_delta_capable[] = _OTA_DELTA_CAPABLE;
+static OTACmdExt _ota_ext;
+
+static uint32_t bitrev32(uint32_t x) {
+    uint32_t r = 0;
+    for (int i = 0; i < 32; i++) {
+        r = (r << 1) | (x & 1);
+        x >>= 1;
+    }
+    return r;
+}
+
+// The DMA sniffer runs the CRC at a byte per clock as a throwaway copy goes by, instead of
+// a loop per bit.  Its CRC32R mode keeps the register in non-reflected form, so the running
+// value is bit-reversed going in and coming back out.
+#define OTA_DMA 0
+static uint32_t crc32_add(uint32_t crc, const void *d, uint32_t len) {
+    static uint8_t sink;
+    if (!len) {
+        return crc;
+    }
+    dma_channel_config c = dma_channel_get_default_config(OTA_DMA);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_sniff_enable(&c, true);
+    dma_sniffer_enable(OTA_DMA, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+    dma_hw->sniff_data = bitrev32(crc);
+    dma_channel_configure(OTA_DMA, &c, &sink, d, len, true);
+    dma_channel_wait_for_finish_blocking(OTA_DMA);
+    return bitrev32(dma_hw->sniff_data);
+}
+
+static uint8_t _delta_block[_OTA_DELTA_BLOCK];   // Block being rebuilt
+static uint8_t _delta_done[PICO_FLASH_SIZE_BYTES / _OTA_DELTA_BLOCK / 8]; // Blocks already rewritten
+
+static bool delta_read(void *dst, uint32_t len) {
+    uint8_t *p = lfsRead(len);
+    if (!p) {
+        return false;
+    }
+    memcpy(dst, p, len);
+    return true;
+}
+
+static bool delta_open(const char *filename, OTADeltaHeader *hdr) {
+    if (!lfsOpen(filename) || !delta_read(hdr, sizeof(*hdr))) {
+        return false;
+    }
+    if (memcmp(hdr->sign, _OTA_DELTA_SIGN, sizeof(hdr->sign))) {
+        return false;
+    }
+    return (hdr->baseLength <= PICO_FLASH_SIZE_BYTES) && (hdr->newLength <= PICO_FLASH_SIZE_BYTES);
+}
+
+#define DELTA_DONE(b) (_delta_done[(b) / 8] & (1 << ((b) & 7)))
+
+// Rebuilds every block listed in the patch.  With program false nothing is written and
+// blocks are only marked as done, so the whole patch can be checked against its CRC, and
+// against copies from blocks that would already be overwritten, before touching flash.
+static bool delta_apply(const OTADeltaHeader *hdr, uint32_t flashAddress, bool program) {
+    const uint32_t blocks = (hdr->newLength + _OTA_DELTA_BLOCK - 1) / _OTA_DELTA_BLOCK;
+    uint32_t crc = 0xffffffff;
+    memset(_delta_done, 0, sizeof(_delta_done));
+    for (uint32_t i = 0; i < hdr->blockCount; i++) {
+        uint32_t block;
+        if (!delta_read(&block, sizeof(block)) || (block >= blocks) || DELTA_DONE(block)) {
+            return false;
+        }
+        uint32_t want = hdr->newLength - block * _OTA_DELTA_BLOCK;
+        if (want > _OTA_DELTA_BLOCK) {
+            want = _OTA_DELTA_BLOCK;
+        }
+        memset(_delta_block, 0xff, sizeof(_delta_block));
+        uint32_t have = 0;
+        while (have < want) {
+            uint32_t op;
+            if (!delta_read(&op, sizeof(op))) {
+                return false;
+            }
+            uint32_t len = op & ~_OTA_DELTA_INSERT;
+            if (!len || (len > want - have)) {
+                return false;
+            }
+            if (op & _OTA_DELTA_INSERT) {
+                if (!delta_read(_delta_block + have, len)) {
+                    return false;
+                }
+            } else {
+                uint32_t src;
+                if (!delta_read(&src, sizeof(src)) || (src >= hdr->baseLength) || (len > hdr->baseLength - src)) {
+                    return false;
+                }
+                // Everything copied has to still be the base image
+                for (uint32_t b = src / _OTA_DELTA_BLOCK; b <= (src + len - 1) / _OTA_DELTA_BLOCK; b++) {
+                    if ((b != block) && DELTA_DONE(b)) {
+                        return false;
+                    }
+                }
+                memcpy(_delta_block + have, (const void *)(flashAddress + src), len);
+            }
+            have += len;
+        }
+        crc = crc32_add(crc, _delta_block, want);
+        _delta_done[block / 8] |= 1 << (block & 7);
+
+        uint32_t toWrite = flashAddress + block * _OTA_DELTA_BLOCK;
+        if (program && memcmp(_delta_block, (void *)toWrite, _OTA_DELTA_BLOCK)) {
+            uart_puts(uart0, "delta writing ");
+            dumphex(toWrite);
+            uart_puts(uart0, "\n");
+            int save = save_and_disable_interrupts();
+            flash_range_erase((intptr_t)toWrite - XIP_BASE, _OTA_DELTA_BLOCK);
+            flash_range_program((intptr_t)toWrite - XIP_BASE, _delta_block, _OTA_DELTA_BLOCK);
+            restore_interrupts(save);
+        }
+    }
+    return ~crc == hdr->patchCRC;
+}
+
+static char _openName[64];  // File lfsRead() is part way through, for scatter writes
+static uint32_t _openPos;
+
+// Positions the read at offset into filename.  Carries on from the last write when it's the
+// same file and further on, instead of opening (and for GZIP, inflating) it from the start.
+static bool write_seek(const char *filename, uint32_t offset) {
+    if (strncmp(filename, _openName, sizeof(_openName)) || (offset < _openPos)) {
+        _openName[0] = 0;
+        uart_puts(uart0, "write: open ");
+        uart_puts(uart0, filename);
+        uart_puts(uart0, "\n");
+        if (!lfsOpen(filename)) {
+            return false;
+        }
+        memcpy(_openName, filename, sizeof(_openName));
+        _openPos = 0;
+    }
+    uart_puts(uart0, "seek ");
+    dumphex(offset);
+    uart_puts(uart0, "\n");
+    if (!lfsSeek(offset - _openPos)) {
+        _openName[0] = 0;
+        return false;
+    }
+    _openPos = offset;
+    return true;
+}
+
+// Reads the data a write would program, nothing is written
+static bool write_check(const commandEntry *c, uint32_t crc32) {
+    if (!write_seek(c->write.filename, c->write.fileOffset)) {
+        return false;
+    }
+    uint32_t crc = 0xffffffff;
+    for (uint32_t toRead = c->write.fileLength; toRead; ) {
+        uint32_t len = (toRead < OTA_BLOCK_SIZE) ? toRead : OTA_BLOCK_SIZE;
+        uint8_t *p = lfsRead(len);
+        if (!p) {
+            _openName[0] = 0;
+            return false;
+        }
+        crc = crc32_add(crc, p, len);
+        toRead -= len;
+    }
+    _openPos += c->write.fileLength;
+    return ~crc == crc32;
+}
+
+// With a crc32, the flash is read back and checked afterwards
+static bool write_flash(const commandEntry *c, const uint32_t *crc32) {
+    if (!write_seek(c->write.filename, c->write.fileOffset)) {
+        return false;
+    }
+    uint32_t toRead = c->write.fileLength;
+    uint32_t toWrite = c->write.flashAddress;
+
+    while (toRead) {
+        // Work a 64K erase block at a time, so mostly changed blocks can use one
+        // block erase instead of sixteen sector erases
+        uint32_t len = OTA_BLOCK_SIZE - ((toWrite - XIP_BASE) % OTA_BLOCK_SIZE);
+        if (toRead < len) {
+            len = toRead;
+        }
+        uint8_t *p = lfsRead(len);
+        if (!p) {
+            uart_puts(uart0, "read failed\n");
+            _openName[0] = 0;
+            return false;
+        }
+        uart_puts(uart0, "toread = ");
+        dumphex(toRead);
+        uart_puts(uart0, "\ntowrite = ");
+        dumphex(toWrite);
+        uart_puts(uart0, "\n");
+        // A short last sector is padded out as erased flash, not left with stale buffer contents
+        if (len % 4096) {
+            memset(p + len, 0xff, 4096 - (len % 4096));
+        }
+        // Only write pages which differ (i.e. preserve OTA pages unless the OTA shim changes)
+        uint32_t sectors = (len + 4095) / 4096;
+        uint32_t differ = 0;
+        for (uint32_t s = 0; s < sectors; s++) {
+            if (memcmp(p + s * 4096, (void *)(toWrite + s * 4096), 4096)) {
+                differ++;
+            }
+        }
+        // Never block erase over the OTA shim itself, a power loss then would brick
+        if ((sectors == OTA_BLOCK_SIZE / 4096) && (differ > sectors / 2) && (toWrite != XIP_BASE)) {
+            uart_puts(uart0, "writing block\n");
+            int save = save_and_disable_interrupts();
+            flash_range_erase((intptr_t)toWrite - XIP_BASE, OTA_BLOCK_SIZE);
+            flash_range_program((intptr_t)toWrite - XIP_BASE, (const uint8_t *)p, OTA_BLOCK_SIZE);
+            restore_interrupts(save);
+        } else {
+            for (uint32_t s = 0; s < sectors; s++) {
+                uint32_t addr = toWrite + s * 4096;
+                if (memcmp(p + s * 4096, (void *)addr, 4096)) {
+                    uart_puts(uart0, "writing\n");
+                    int save = save_and_disable_interrupts();
+                    flash_range_erase((intptr_t)addr - XIP_BASE, 4096);
+                    flash_range_program((intptr_t)addr - XIP_BASE, (const uint8_t *)p + s * 4096, 4096);
+                    restore_interrupts(save);
+                } else {
+                    uart_puts(uart0, "identical to flash, skipping\n");
+                }
+            }
+        }
+        toRead -= len;
+        toWrite += sectors * 4096;
+    }
+    _openPos += c->write.fileLength;
+    lfsClose();
+    if (crc32) {
+        // Read back what was written
+        return ~crc32_add(0xffffffff, (const void *)c->write.flashAddress, c->write.fileLength) == *crc32;
+    }
+    return true;
+}
+
+// With program false the patch is only checked, against the image in flash and its own CRC
+static bool delta(const commandEntry *c, bool program) {
+    OTADeltaHeader hdr;
+    _openName[0] = 0;
+    uart_puts(uart0, "delta: open ");
+    uart_puts(uart0, c->delta.filename);
+    uart_puts(uart0, "\n");
+    if (!delta_open(c->delta.filename, &hdr)) {
+        uart_puts(uart0, "bad delta file\n");
+        return false;
+    }
+    const uint8_t *base = (const uint8_t *)c->delta.flashAddress;
+    if (~crc32_add(0xffffffff, base, hdr.baseLength) != hdr.baseCRC) {
+        // Power lost after the last block but before the command was erased?
+        if (~crc32_add(0xffffffff, base, hdr.newLength) == hdr.newCRC) {
+            uart_puts(uart0, "delta already applied\n");
+            return true;
+        }
+        uart_puts(uart0, "delta base mismatch\n");
+        return false;
+    }
+    if (!delta_apply(&hdr, c->delta.flashAddress, program)) {
+        uart_puts(uart0, program ? "delta apply failed\n" : "delta check failed\n");
+        return false;
+    }
+    lfsClose();
+    return true;
+}
+
+// A "Pico OTA" page may come with or without the extension, an _OTA_SIGN_EXT one needs it.
+// Without a valid one _ota_ext is cleared, so there are no CRCs and no next page.
+static bool page_ok() {
+    bool needExt = !memcmp(_ota_cmd.sign, _OTA_SIGN_EXT, 8);
+    if (!needExt && memcmp(_ota_cmd.sign, "Pico OTA", 8)) {
+        return false; // No signature
+    }
+    uint32_t crc = ~crc32_add(0xffffffff, &_ota_cmd, offsetof(OTACmdPage, crc32));
+    if (crc != _ota_cmd.crc32) {
+        uart_puts(uart0, "\ncrc32 mismatch\n");
+        return false;
+    }
+    if (_ota_cmd.count > _OTA_MAX_COMMANDS) {
+        return false;
+    }
+    bool ext = !memcmp(_ota_ext.sign, _OTA_EXT_SIGN, 8) && (_ota_ext.version == _OTA_EXT_VERSION) &&
+               (~crc32_add(0xffffffff, &_ota_ext, offsetof(OTACmdExt, extCRC32)) == _ota_ext.extCRC32);
+    if (!ext) {
+        memset(&_ota_ext, 0, sizeof(_ota_ext));
+    }
+    return ext || !needExt;
+}
+
+// Goes through every command, starting with the page in _ota_cmd and following the chain.  The
+// check pass reads every file with a CRC and every delta, so nothing is written unless all of
+// them are intact.  Deltas are checked against the image in flash before anything is written.
+static bool run(bool program) {
+    char next[sizeof(_ota_ext.next)];
+    _openName[0] = 0;
+    for (int page = 0; page < _OTA_MAX_PAGES; page++) {
+        for (uint32_t i = 0; i < _ota_cmd.count; i++) {
+            const commandEntry *c = &_ota_cmd.cmd[i];
+            const uint32_t *crc32 = (_ota_ext.crcMask & (1u << i)) ? &_ota_ext.crc32[i] : NULL;
+            bool ok = true;
+            switch (c->command) {
+                case _OTA_WRITE:
+                    if (program) {
+                        ok = write_flash(c, crc32);
+                    } else if (crc32) {
+                        ok = write_check(c, *crc32);
+                    }
+                    break;
+                case _OTA_DELTA:
+                    ok = delta(c, program);
+                    break;
+                case _OTA_CHECK:
+                    if (program) {
+                        ok = ~crc32_add(0xffffffff, (const void *)c->check.flashAddress, c->check.length) == c->check.crc32;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            if (!ok) {
+                uart_puts(uart0, program ? "command failed\n" : "check failed\n");
+                return false;
+            }
+        }
+        if (!_ota_ext.next[0]) {
+            return true;
+        }
+        memcpy(next, _ota_ext.next, sizeof(next));
+        next[sizeof(next) - 1] = 0;
+        uart_puts(uart0, "next page ");
+        uart_puts(uart0, next);
+        uart_puts(uart0, "\n");
+        if (!lfsReadPage(next, &_ota_cmd, &_ota_ext) || !page_ok()) {
+            return false;
+        }
+    }
+    return false; // Chained back on itself
+}
 
 void do_ota() {
     if (*__FS_START__ == *__FS_END__) {
@@ -67,29 +408,11 @@ void do_ota() {
     // We are very naughty and record the last block read, since it should be the actual data block of the
     // OTA structure.  We'll erase it behind the scenes to avoid bringing in all of LittleFS write infra.
     uint32_t blockToErase;
-    if (!lfsReadOTA(&_ota_cmd, &blockToErase)) {
+    if (!lfsReadOTA(&_ota_cmd, &_ota_ext, &blockToErase)) {
         return;
     }
 
-    if (memcmp(_ota_cmd.sign, "Pico OTA", 8)) {
-        return; // No signature
-    }
-
-    uint32_t crc = 0xffffffff;
-    const uint8_t *data = (const uint8_t *)&_ota_cmd;
-    for (uint32_t i = 0; i < offsetof(OTACmdPage, crc32); i++) {
-        crc ^= data[i];
-        for (int j = 0; j < 8; j++) {
-            if (crc & 1) {
-                crc = (crc >> 1) ^ 0xedb88320;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-    crc = ~crc;
-    if (crc != _ota_cmd.crc32) {
-        uart_puts(uart0, "\ncrc32 mismatch\n");
+    if (!page_ok()) {
         return;
     }
 
@@ -98,59 +421,13 @@ void do_ota() {
         return;
     }
 
-    for (uint32_t i = 0; i < _ota_cmd.count; i++) {
-        switch (_ota_cmd.cmd[i].command) {
-            case _OTA_WRITE:
-                uart_puts(uart0, "write: open ");
-                uart_puts(uart0, _ota_cmd.cmd[i].write.filename);
-                uart_puts(uart0, " = ");
-                if (!lfsOpen(_ota_cmd.cmd[i].write.filename)) {
-                    uart_puts(uart0, "failed\n");
-                    return;
-                }
-                uart_puts(uart0, "success\n");
-                uart_puts(uart0, "seek ");
-                dumphex(_ota_cmd.cmd[i].write.fileOffset);
-                uart_puts(uart0, " = ");
-                if (!lfsSeek(_ota_cmd.cmd[i].write.fileOffset)) {
-                    uart_puts(uart0, "failed\n");
-                    return;
-                }
-                uart_puts(uart0, "success\n");
-                uint32_t toRead = _ota_cmd.cmd[i].write.fileLength;
-                uint32_t toWrite = _ota_cmd.cmd[i].write.flashAddress;
-
-                while (toRead) {
-                    uint32_t len = (toRead < 4096) ? toRead : 4096;
-                    uint8_t *p = lfsRead(len);
-                    if (!p) {
-                        uart_puts(uart0, "read failed\n");
-                        return;
-                    }
-                    uart_puts(uart0, "toread = ");
-                    dumphex(toRead);
-                    uart_puts(uart0, "\ntowrite = ");
-                    dumphex(toWrite);
-                    uart_puts(uart0, "\n");
-                    // Only write pages which differ (i.e. preserve OTA pages unless the OTA shim changes)
-                    if (memcmp(p, (void*)toWrite, 4096)) {
-                        uart_puts(uart0, "writing\n");
-                        int save = save_and_disable_interrupts();
-                        flash_range_erase((intptr_t)toWrite - XIP_BASE, 4096);
-                        flash_range_program((intptr_t)toWrite - XIP_BASE, (const uint8_t *)p, 4096);
-                        restore_interrupts(save);
-                    } else {
-                        uart_puts(uart0, "identical to flash, skipping\n");
-                    }
-                    toRead -= len;
-                    toWrite += 4096;
-                }
-                lfsClose();
-                break;
-            default:
-                // TODO - verify
-                break;
-        }
+    // Check everything, then start over from the first page and do it
+    if (!run(false)) {
+        return;
+    }
+    if (!lfsReadPage(_OTA_COMMAND_FILE, &_ota_cmd, &_ota_ext) || !page_ok() || !run(true)) {
+        // Leave the command in place, so the next boot tries again from the start
+        return;
     }
 
     uart_puts(uart0, "\nota completed\n");
@@ -177,6 +454,9 @@ int main(int a, unsigned char **b) {
     uart_set_format(uart0, 8, 1, UART_PARITY_NONE);
 #endif
 
+    // Keep the delta marker in the image, it's only ever searched for by the app
+    (void) *(volatile const char *)_ota_delta_capable;
+
     do_ota();
 
     // Reset the interrupt/etc. vectors to the real app.  Will be copied to RAM in app's runtime_init
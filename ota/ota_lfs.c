@@ -70,8 +70,10 @@ static int lfs_flash_sync(const struct lfs_config *c) {
     return 0;
 }
 
-uint8_t _read_buffer[256];
-uint8_t _prog_buffer[256];
+// Caches the size of a whole block, so walking a file's blocks costs one fill each
+#define OTA_CACHE_SIZE 4096
+uint8_t _read_buffer[OTA_CACHE_SIZE];
+uint8_t _prog_buffer[OTA_CACHE_SIZE];
 uint8_t _lookahead_buffer[256];
 bool lfsMount(uint8_t *start, uint32_t blockSize, uint32_t size) {
     _start = start;
@@ -90,7 +92,7 @@ bool lfsMount(uint8_t *start, uint32_t blockSize, uint32_t size) {
     _lfs_cfg.block_size =  _blockSize;
     _lfs_cfg.block_count = _blockSize ? _size / _blockSize : 0;
     _lfs_cfg.block_cycles = 16; // TODO - need better explanation
-    _lfs_cfg.cache_size = 256;
+    _lfs_cfg.cache_size = OTA_CACHE_SIZE;
     _lfs_cfg.lookahead_size = 256;
     _lfs_cfg.read_buffer = _read_buffer;
     _lfs_cfg.prog_buffer = _prog_buffer;
@@ -104,24 +106,35 @@ bool lfsMount(uint8_t *start, uint32_t blockSize, uint32_t size) {
 static bool _gzip = false;
 static lfs_file_t _file;
 
-static unsigned char __attribute__((aligned(4))) uzlib_read_buff[4096];
+static unsigned char __attribute__((aligned(4))) uzlib_read_buff[16384];
 static unsigned char gzip_dict[32768];
-static uint8_t _flash_buff[4096]; // no room for this on the stack
+static uint8_t _flash_buff[OTA_BLOCK_SIZE]; // no room for this on the stack
 static struct uzlib_uncomp m_uncomp;
 
-static uint8_t _ota_buff[256];
+static uint8_t _ota_buff[OTA_CACHE_SIZE];
 static struct lfs_file_config _ota_cfg = { (void *)_ota_buff, NULL, 0 };
 
-static uint8_t _file_buff[256];
+static uint8_t _file_buff[OTA_CACHE_SIZE];
 static struct lfs_file_config _file_cfg = { (void *)_file_buff, NULL, 0 };
 
-bool lfsReadOTA(OTACmdPage *ota, uint32_t *blockToErase) {
+// The extension is optional, a file without it reads as one with an all zero extension
+static bool _readPage(lfs_file_t *f, OTACmdPage *ota, OTACmdExt *ext) {
+    if (sizeof(*ota) != lfs_file_read(&_lfs, f, ota, sizeof(*ota))) {
+        return false;
+    }
+    if (sizeof(*ext) != lfs_file_read(&_lfs, f, ext, sizeof(*ext))) {
+        memset(ext, 0, sizeof(*ext));
+    }
+    return true;
+}
+
+bool lfsReadOTA(OTACmdPage *ota, OTACmdExt *ext, uint32_t *blockToErase) {
     lfs_file_t f;
 
     if (lfs_file_opencfg(&_lfs, &f, _OTA_COMMAND_FILE, LFS_O_RDONLY, &_ota_cfg) < 0) {
         return false;
     }
-    if (sizeof(*ota) != lfs_file_read(&_lfs, &f, ota, sizeof(*ota))) {
+    if (!_readPage(&f, ota, ext)) {
         return false;
     }
     *blockToErase = _lastBlock;
@@ -130,6 +143,16 @@ bool lfsReadOTA(OTACmdPage *ota, uint32_t *blockToErase) {
     return true;
 }
 
+// A chained command page, or the first one again
+bool lfsReadPage(const char *filename, OTACmdPage *ota, OTACmdExt *ext) {
+    lfs_file_t f;
+
+    if (lfs_file_opencfg(&_lfs, &f, filename, LFS_O_RDONLY, &_ota_cfg) < 0) {
+        return false;
+    }
+    return _readPage(&f, ota, ext);
+}
+
 static int uzlib_read_cb(struct uzlib_uncomp *m) {
     m->source = uzlib_read_buff;
     int len = lfs_file_read(&_lfs, &_file, uzlib_read_buff, sizeof(uzlib_read_buff));
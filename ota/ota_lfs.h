@@ -23,11 +23,15 @@
 #include <stdbool.h>
 #include "ota_command.h"
 
+// Largest lfsRead(), one flash erase block
+#define OTA_BLOCK_SIZE 65536
+
 bool lfsMount(uint8_t *start, uint32_t blockSize, uint32_t size);
 bool lfsOpen(const char *filename);
 bool lfsSeek(uint32_t offset);
 uint8_t *lfsRead(uint32_t len);
 void lfsClose();
 
-bool lfsReadOTA(OTACmdPage *ota, uint32_t *blockToErase);
+bool lfsReadOTA(OTACmdPage *ota, OTACmdExt *ext, uint32_t *blockToErase);
+bool lfsReadPage(const char *filename, OTACmdPage *ota, OTACmdExt *ext);
 void lfsEraseBlock(uint32_t blockToErase);
@@ -0,0 +1,288 @@
+// On-target benchmark of the core's peripheral drivers, driven by tests/benchmark/run_bench.py
+//
+// Measures GPIO IRQ latency, inter-core FIFO round trips, and UART, SPI and I2C loopback
+// throughput, and acts as the device end of the USB CDC throughput test.  Each result is
+// printed as a "BENCH {json}" line.
+//
+// Jumpers needed on a Pico (change the pins below to suit other boards):
+//   GP2  -> GP3    GPIO IRQ latency
+//   GP0  -> GP1    Serial1 TX -> RX
+//   GP19 -> GP16   SPI0 MOSI -> MISO
+//   GP4  -> GP6    Wire SDA -> Wire1 SDA  (with a 4.7K pull-up to 3.3V)
+//   GP5  -> GP7    Wire SCL -> Wire1 SCL  (with a 4.7K pull-up to 3.3V)
+// A test whose loopback isn't connected reports an error instead of a number.
+//
+// Released to the public domain
+
+#include <SPI.h>
+#include <Wire.h>
+
+#define BENCH_IRQ_OUT 2
+#define BENCH_IRQ_IN 3
+#define BENCH_UART_BAUD 1000000
+#define BENCH_SPI_HZ 20000000
+#define BENCH_I2C_HZ 1000000
+#define BENCH_I2C_ADDR 0x42
+
+static void result(const char *name, double value, const char *unit, bool higherIsBetter) {
+  Serial.printf("BENCH {\"name\":\"%s\",\"value\":%.3f,\"unit\":\"%s\",\"better\":\"%s\"}\n",
+                name, value, unit, higherIsBetter ? "higher" : "lower");
+}
+
+static void error(const char *name, const char *why) {
+  Serial.printf("BENCH {\"name\":\"%s\",\"error\":\"%s\"}\n", name, why);
+}
+
+static double cyclesToNs(uint32_t cycles) {
+  return cycles * 1.0e9 / rp2040.f_cpu();
+}
+
+static uint8_t txbuf[4096];
+static uint8_t rxbuf[4096];
+
+// GPIO IRQ latency: from the output edge to the first line of the handler
+
+static volatile uint32_t irqAt;
+static volatile bool irqSeen;
+
+static void edgeIRQ() {
+  irqAt = rp2040.getCycleCount();
+  irqSeen = true;
+}
+
+static void benchGPIOIRQ() {
+  const int runs = 1000;
+  pinMode(BENCH_IRQ_OUT, OUTPUT);
+  digitalWrite(BENCH_IRQ_OUT, LOW);
+  pinMode(BENCH_IRQ_IN, INPUT);
+  attachInterrupt(digitalPinToInterrupt(BENCH_IRQ_IN), edgeIRQ, RISING);
+  uint32_t worst = 0;
+  uint64_t total = 0;
+  for (int i = 0; i < runs; i++) {
+    irqSeen = false;
+    uint32_t start = rp2040.getCycleCount();
+    digitalWrite(BENCH_IRQ_OUT, HIGH);
+    uint32_t timeout = millis();
+    while (!irqSeen) {
+      if (millis() - timeout > 10) {
+        detachInterrupt(digitalPinToInterrupt(BENCH_IRQ_IN));
+        error("gpio_irq_latency", "no edge seen, jumper GP2 to GP3");
+        return;
+      }
+    }
+    uint32_t lat = irqAt - start;
+    total += lat;
+    worst = std::max(worst, lat);
+    digitalWrite(BENCH_IRQ_OUT, LOW);
+    delayMicroseconds(20);
+  }
+  detachInterrupt(digitalPinToInterrupt(BENCH_IRQ_IN));
+  result("gpio_irq_latency_avg", cyclesToNs(total / runs), "ns", false);
+  result("gpio_irq_latency_max", cyclesToNs(worst), "ns", false);
+}
+
+// Inter-core FIFO: core 1 echoes every word straight back
+
+static volatile bool echoing = false;
+
+void setup1() {
+  while (!echoing) {
+    /* wait for the test */
+  }
+}
+
+void loop1() {
+  rp2040.fifo.push(rp2040.fifo.pop());
+}
+
+static void benchFIFO() {
+  const int runs = 10000;
+  echoing = true;
+  rp2040.fifo.push(0); // Make sure core 1 is up before timing anything
+  rp2040.fifo.pop();
+  uint32_t worst = 0;
+  uint64_t total = 0;
+  for (int i = 0; i < runs; i++) {
+    uint32_t start = rp2040.getCycleCount();
+    rp2040.fifo.push(i);
+    uint32_t v = rp2040.fifo.pop();
+    uint32_t lat = rp2040.getCycleCount() - start;
+    if (v != (uint32_t)i) {
+      error("fifo_roundtrip", "echo mismatch");
+      return;
+    }
+    total += lat;
+    worst = std::max(worst, lat);
+  }
+  result("fifo_roundtrip_avg", cyclesToNs(total / runs), "ns", false);
+  result("fifo_roundtrip_max", cyclesToNs(worst), "ns", false);
+}
+
+// UART loopback throughput, writing and reading concurrently
+
+static void benchUART() {
+  const size_t total = 64 * 1024;
+  Serial1.setFIFOSize(4096);
+  Serial1.begin(BENCH_UART_BAUD);
+  while (Serial1.available()) {
+    Serial1.read();
+  }
+  size_t sent = 0, got = 0;
+  bool ok = true;
+  uint32_t start = micros();
+  uint32_t last = millis();
+  while (got < total) {
+    if (sent < total) {
+      size_t n = std::min((size_t)Serial1.availableForWrite(), total - sent);
+      for (size_t i = 0; i < n; i++) {
+        Serial1.write((uint8_t)(sent + i));
+      }
+      sent += n;
+    }
+    int n = Serial1.readBytes(rxbuf, std::min((size_t)Serial1.available(), sizeof(rxbuf)));
+    for (int i = 0; i < n; i++) {
+      ok &= rxbuf[i] == (uint8_t)(got + i);
+    }
+    got += n;
+    if (n) {
+      last = millis();
+    } else if (millis() - last > 100) {
+      break;
+    }
+  }
+  uint32_t us = micros() - start;
+  Serial1.end();
+  if (got < total) {
+    error("uart_loopback", "data lost, jumper GP0 to GP1");
+  } else if (!ok) {
+    error("uart_loopback", "data corrupted");
+  } else {
+    result("uart_loopback", total * 1.0e6 / us, "B/s", true);
+  }
+}
+
+// SPI loopback throughput in 4KB transfers, which go through DMA
+
+static void benchSPI() {
+  const int runs = 64;
+  for (size_t i = 0; i < sizeof(txbuf); i++) {
+    txbuf[i] = (uint8_t)(i * 7 + 3);
+  }
+  SPI.begin();
+  SPI.beginTransaction(SPISettings(BENCH_SPI_HZ, MSBFIRST, SPI_MODE0));
+  bool ok = true;
+  uint32_t start = micros();
+  for (int i = 0; i < runs; i++) {
+    SPI.transfer(txbuf, rxbuf, sizeof(txbuf));
+    ok &= !memcmp(txbuf, rxbuf, sizeof(txbuf));
+  }
+  uint32_t us = micros() - start;
+  SPI.endTransaction();
+  SPI.end();
+  if (!ok) {
+    error("spi_loopback", "data mismatch, jumper GP19 to GP16");
+  } else {
+    result("spi_loopback", runs * sizeof(txbuf) * 1.0e6 / us, "B/s", true);
+  }
+}
+
+// I2C throughput, Wire as master writing to Wire1 as slave
+
+static volatile size_t i2cGot;
+
+static void i2cRecv(int n) {
+  while (n--) {
+    Wire1.read();
+    i2cGot = i2cGot + 1;
+  }
+}
+
+static void benchI2C() {
+  const int runs = 200;
+  const size_t len = 32;
+  Wire1.setSDA(6);
+  Wire1.setSCL(7);
+  Wire1.onReceive(i2cRecv);
+  Wire1.begin(BENCH_I2C_ADDR);
+  Wire.setClock(BENCH_I2C_HZ);
+  Wire.begin();
+  i2cGot = 0;
+  bool ok = true;
+  uint32_t start = micros();
+  for (int i = 0; i < runs && ok; i++) {
+    Wire.beginTransmission(BENCH_I2C_ADDR);
+    Wire.write(txbuf, len);
+    ok = Wire.endTransmission() == 0;
+  }
+  uint32_t us = micros() - start;
+  delay(1);
+  Wire.end();
+  Wire1.end();
+  if (!ok || (i2cGot != runs * len)) {
+    error("i2c_write", "no ACK, jumper GP4/5 to GP6/7 with pull-ups");
+  } else {
+    result("i2c_write", runs * len * 1.0e6 / us, "B/s", true);
+  }
+}
+
+// USB CDC: the host times these, as the device can't see when the data arrives
+
+static void usbSend(size_t len) {
+  for (size_t i = 0; i < sizeof(txbuf); i++) {
+    txbuf[i] = (uint8_t)i;
+  }
+  while (len) {
+    size_t n = Serial.write(txbuf, std::min(len, sizeof(txbuf)));
+    if (!n) {
+      return; // Host went away
+    }
+    len -= n;
+  }
+  Serial.flush();
+}
+
+static void usbReceive(size_t len) {
+  uint32_t start = 0;
+  size_t got = 0;
+  uint32_t last = millis();
+  while ((got < len) && (millis() - last < 2000)) {
+    int n = Serial.readBytes(rxbuf, std::min((size_t)Serial.available(), sizeof(rxbuf)));
+    if (n) {
+      if (!got) {
+        start = micros();
+      }
+      got += n;
+      last = millis();
+    }
+  }
+  uint32_t us = micros() - start;
+  Serial.printf("USBRX %u %lu\n", (unsigned)got, (unsigned long)us);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+}
+
+void loop() {
+  if (!Serial.available()) {
+    return;
+  }
+  String cmd = Serial.readStringUntil('\n');
+  cmd.trim();
+  if (cmd == "RUN") {
+    Serial.printf("BENCH {\"board\":\"%s\",\"f_cpu\":%d}\n", ARDUINO_VARIANT, rp2040.f_cpu());
+    benchGPIOIRQ();
+    benchFIFO();
+    benchUART();
+    benchSPI();
+    benchI2C();
+    Serial.println("BENCH DONE");
+  } else if (cmd.startsWith("USBTX ")) {
+    usbSend(cmd.substring(6).toInt());
+  } else if (cmd.startsWith("USBRX ")) {
+    usbReceive(cmd.substring(6).toInt());
+  }
+}
@@ -0,0 +1,118 @@
+// On-target filesystem throughput benchmark, driven by tests/benchmark/run_bench.py
+//
+// Writes and reads back a file on LittleFS, and on an SD card if BENCH_SD_CS is set, and
+// prints each result as a "BENCH {json}" line.
+//
+// WARNING:  The LittleFS filesystem is formatted at the start of the test!  Select a
+// Flash Size with at least 512KB of filesystem.
+//
+// Released to the public domain
+
+#include <LittleFS.h>
+#include <SD.h>
+
+// SPI0 chip select of an SD card to test as well, -1 to skip it
+#define BENCH_SD_CS -1
+
+#define BENCH_FILE_KB 256
+#define BENCH_CHUNK 4096
+
+static uint8_t buf[BENCH_CHUNK];
+
+static void result(const char *name, double value, const char *unit, bool higherIsBetter) {
+  Serial.printf("BENCH {\"name\":\"%s\",\"value\":%.3f,\"unit\":\"%s\",\"better\":\"%s\"}\n",
+                name, value, unit, higherIsBetter ? "higher" : "lower");
+}
+
+static void error(const char *name, const char *why) {
+  Serial.printf("BENCH {\"name\":\"%s\",\"error\":\"%s\"}\n", name, why);
+}
+
+static void benchFS(FS &fs, const char *tag) {
+  char name[32];
+  const size_t total = BENCH_FILE_KB * 1024;
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = (uint8_t)i;
+  }
+
+  fs.remove("/bench.bin");
+  uint32_t start = micros();
+  File f = fs.open("/bench.bin", "w");
+  if (!f) {
+    sprintf(name, "%s_write", tag);
+    error(name, "can't create file");
+    return;
+  }
+  size_t done = 0;
+  while (done < total) {
+    size_t n = f.write(buf, sizeof(buf));
+    if (!n) {
+      break;
+    }
+    done += n;
+  }
+  f.close();
+  uint32_t us = micros() - start;
+  sprintf(name, "%s_write", tag);
+  if (done < total) {
+    error(name, "filesystem full");
+    return;
+  }
+  result(name, total * 1.0e6 / us, "B/s", true);
+
+  bool ok = true;
+  start = micros();
+  f = fs.open("/bench.bin", "r");
+  done = 0;
+  while (f && (done < total)) {
+    size_t n = f.read(buf, sizeof(buf));
+    if (!n) {
+      break;
+    }
+    ok &= buf[n - 1] == (uint8_t)(n - 1);
+    done += n;
+  }
+  f.close();
+  us = micros() - start;
+  sprintf(name, "%s_read", tag);
+  if ((done < total) || !ok) {
+    error(name, "read back failed");
+  } else {
+    result(name, total * 1.0e6 / us, "B/s", true);
+  }
+  fs.remove("/bench.bin");
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+}
+
+void loop() {
+  if (!Serial.available()) {
+    return;
+  }
+  String cmd = Serial.readStringUntil('\n');
+  cmd.trim();
+  if (cmd != "RUN") {
+    return;
+  }
+  Serial.printf("BENCH {\"board\":\"%s\",\"f_cpu\":%d}\n", ARDUINO_VARIANT, rp2040.f_cpu());
+  if (LittleFS.format() && LittleFS.begin()) {
+    benchFS(LittleFS, "littlefs");
+    LittleFS.end();
+  } else {
+    error("littlefs_write", "can't format, select a Flash Size with a filesystem");
+  }
+#if BENCH_SD_CS >= 0
+  if (SD.begin(BENCH_SD_CS, SPI_FULL_SPEED)) {
+    benchFS(SDFS, "sd");
+    SD.end();
+  } else {
+    error("sd_write", "no card");
+  }
+#endif
+  Serial.println("BENCH DONE");
+}
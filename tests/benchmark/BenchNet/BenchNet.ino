@@ -0,0 +1,203 @@
+// On-target network throughput benchmark, driven by tests/benchmark/run_bench.py
+//
+// Measures TCP send and receive, UDP send and TLS handshake time against the servers the
+// runner starts on the host, and prints each result as a "BENCH {json}" line.  The runner
+// sends the WiFi credentials and its own address before starting the test.
+//
+// Uses the Pico W's CYW43 WiFi.  To test a W5500 Ethernet module instead, install the
+// W5500lwIP driver and set BENCH_W5500_CS to its SPI0 chip select.
+//
+// Released to the public domain
+
+#include <WiFi.h>
+
+#define BENCH_W5500_CS -1
+
+#if BENCH_W5500_CS >= 0
+#include <W5500lwIP.h>
+Wiznet5500lwIP eth(BENCH_W5500_CS);
+#define BENCH_IF "w5500"
+#else
+#define BENCH_IF "cyw43"
+#endif
+
+#define BENCH_TCP_BYTES (1024 * 1024)
+#define BENCH_UDP_PACKETS 1000
+#define BENCH_UDP_SIZE 1024
+#define BENCH_TLS_RUNS 3
+
+static String ssid, pass;
+static IPAddress host;
+static uint16_t port = 5201; // TCP sink, then TCP source, UDP sink and TLS on the next ports
+static uint8_t buf[4096];
+
+static void result(const char *name, double value, const char *unit, bool higherIsBetter) {
+  Serial.printf("BENCH {\"name\":\"%s_" BENCH_IF "\",\"value\":%.3f,\"unit\":\"%s\",\"better\":\"%s\"}\n",
+                name, value, unit, higherIsBetter ? "higher" : "lower");
+}
+
+static void error(const char *name, const char *why) {
+  Serial.printf("BENCH {\"name\":\"%s_" BENCH_IF "\",\"error\":\"%s\"}\n", name, why);
+}
+
+static bool netBegin() {
+#if BENCH_W5500_CS >= 0
+  if (!eth.begin()) {
+    return false;
+  }
+  uint32_t start = millis();
+  while (!eth.connected() && (millis() - start < 20000)) {
+    delay(100);
+  }
+  return eth.connected();
+#else
+  WiFi.begin(ssid.c_str(), pass.c_str());
+  uint32_t start = millis();
+  while ((WiFi.status() != WL_CONNECTED) && (millis() - start < 20000)) {
+    delay(100);
+  }
+  return WiFi.status() == WL_CONNECTED;
+#endif
+}
+
+// Send to the host's sink, which replies with the byte count once it has it all
+static void benchTCPSend() {
+  WiFiClient c;
+  if (!c.connect(host, port)) {
+    error("tcp_send", "can't connect");
+    return;
+  }
+  c.setNoDelay(true);
+  c.printf("%d\n", BENCH_TCP_BYTES);
+  uint32_t start = micros();
+  size_t sent = 0;
+  while (c.connected() && (sent < BENCH_TCP_BYTES)) {
+    sent += c.write(buf, std::min(sizeof(buf), (size_t)(BENCH_TCP_BYTES - sent)));
+  }
+  c.setTimeout(5000);
+  String ack = c.readStringUntil('\n');
+  uint32_t us = micros() - start;
+  c.stop();
+  if (ack.toInt() != BENCH_TCP_BYTES) {
+    error("tcp_send", "host didn't get everything");
+  } else {
+    result("tcp_send", BENCH_TCP_BYTES * 1.0e6 / us, "B/s", true);
+  }
+}
+
+// Receive from the host's source, which closes the connection when done
+static void benchTCPReceive() {
+  WiFiClient c;
+  if (!c.connect(host, port + 1)) {
+    error("tcp_receive", "can't connect");
+    return;
+  }
+  c.printf("%d\n", BENCH_TCP_BYTES);
+  uint32_t start = micros();
+  size_t got = 0;
+  uint32_t last = millis();
+  while ((got < BENCH_TCP_BYTES) && (millis() - last < 5000)) {
+    int n = c.read(buf, sizeof(buf));
+    if (n > 0) {
+      got += n;
+      last = millis();
+    }
+  }
+  uint32_t us = micros() - start;
+  c.stop();
+  if (got != BENCH_TCP_BYTES) {
+    error("tcp_receive", "short read");
+  } else {
+    result("tcp_receive", BENCH_TCP_BYTES * 1.0e6 / us, "B/s", true);
+  }
+}
+
+// Blast datagrams at the host, which replies with how many arrived
+static void benchUDPSend() {
+  WiFiUDP udp;
+  udp.begin(port + 2);
+  uint32_t start = micros();
+  for (int i = 0; i < BENCH_UDP_PACKETS; i++) {
+    udp.beginPacket(host, port + 2);
+    udp.write(buf, BENCH_UDP_SIZE);
+    udp.endPacket();
+  }
+  uint32_t us = micros() - start;
+  delay(100);
+  int arrived = -1;
+  for (int tries = 0; (tries < 10) && (arrived < 0); tries++) {
+    udp.beginPacket(host, port + 2);
+    udp.write("END");
+    udp.endPacket();
+    uint32_t wait = millis();
+    while ((millis() - wait < 200) && (arrived < 0)) {
+      if (udp.parsePacket()) {
+        char reply[16] = {};
+        udp.read(reply, sizeof(reply) - 1);
+        arrived = atoi(reply);
+      }
+    }
+  }
+  udp.stop();
+  if (arrived < 0) {
+    error("udp_send", "no reply from host");
+    return;
+  }
+  result("udp_send", BENCH_UDP_PACKETS * BENCH_UDP_SIZE * 1.0e6 / us, "B/s", true);
+  result("udp_send_delivered", 100.0 * arrived / BENCH_UDP_PACKETS, "%", true);
+}
+
+// Full handshakes with a fresh client each time, so no session resumption
+static void benchTLS() {
+  uint32_t total = 0;
+  for (int i = 0; i < BENCH_TLS_RUNS; i++) {
+    BearSSL::WiFiClientSecure c;
+    c.setInsecure();
+    uint32_t start = millis();
+    if (!c.connect(host, port + 3)) {
+      error("tls_handshake", "handshake failed");
+      return;
+    }
+    total += millis() - start;
+    c.stop();
+  }
+  result("tls_handshake", (double)total / BENCH_TLS_RUNS, "ms", false);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = (uint8_t)i;
+  }
+}
+
+void loop() {
+  if (!Serial.available()) {
+    return;
+  }
+  String cmd = Serial.readStringUntil('\n');
+  cmd.trim();
+  if (cmd.startsWith("SSID ")) {
+    ssid = cmd.substring(5);
+  } else if (cmd.startsWith("PASS ")) {
+    pass = cmd.substring(5);
+  } else if (cmd.startsWith("HOST ")) {
+    host.fromString(cmd.substring(5));
+  } else if (cmd.startsWith("PORT ")) {
+    port = cmd.substring(5).toInt();
+  } else if (cmd == "RUN") {
+    Serial.printf("BENCH {\"board\":\"%s\",\"f_cpu\":%d}\n", ARDUINO_VARIANT, rp2040.f_cpu());
+    if (!netBegin()) {
+      error("tcp_send", "network didn't come up");
+    } else {
+      benchTCPSend();
+      benchTCPReceive();
+      benchUDPSend();
+      benchTLS();
+    }
+    Serial.println("BENCH DONE");
+  }
+}
@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+#
+# Host-side runner for the on-target benchmarks in tests/benchmark
+#
+# Optionally builds and uploads each benchmark sketch with arduino-cli, runs it over the
+# USB serial port, and writes every result to one JSON file.  Given the JSON file of an
+# earlier run with --baseline, it flags any result that got worse by more than
+# --threshold percent and exits non-zero, so regressions show up release to release.
+#
+#   python3 run_bench.py --port /dev/ttyACM0 --out bench.json BenchCore BenchFS
+#   python3 run_bench.py --port /dev/ttyACM0 --fqbn rp2040:rp2040:rpipicow \
+#       --ssid myap --password secret --out bench.json --baseline last.json BenchNet
+#
+# BenchNet needs the Pico to reach this host on --net-port .. --net-port+3 (TCP, UDP)
+# and the openssl command line tool, to make a throwaway certificate for the TLS test.
+#
+# Requires pyserial.
+
+import argparse
+import datetime
+import json
+import os
+import socket
+import ssl
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+import serial
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SKETCHES = ["BenchCore", "BenchFS", "BenchNet"]
+USB_BYTES = 1024 * 1024
+
+
+def upload(sketch, fqbn, port):
+    path = os.path.join(HERE, sketch)
+    subprocess.check_call(["arduino-cli", "compile", "--fqbn", fqbn, "--upload", "--port", port, path])
+    time.sleep(3)  # Let the new sketch re-enumerate
+
+
+def open_port(port):
+    # The port may take a few seconds to come back after an upload
+    for _ in range(20):
+        try:
+            ser = serial.Serial(port, 115200, timeout=1)
+            time.sleep(0.5)
+            ser.reset_input_buffer()
+            return ser
+        except serial.SerialException:
+            time.sleep(0.5)
+    raise RuntimeError("Unable to open " + port)
+
+
+def collect(ser, timeout):
+    """Reads BENCH lines until BENCH DONE, returning (board info, results)"""
+    info = {}
+    results = []
+    end = time.time() + timeout
+    while time.time() < end:
+        line = ser.readline().decode("utf-8", "replace").strip()
+        if not line.startswith("BENCH "):
+            continue
+        if line == "BENCH DONE":
+            return info, results
+        try:
+            rec = json.loads(line[6:])
+        except ValueError:
+            print("Garbled: " + line, file=sys.stderr)
+            continue
+        if "name" in rec:
+            print("  {0:28} {1}".format(rec["name"], rec.get("error") or "{0:.3f} {1}".format(rec["value"], rec["unit"])))
+            results.append(rec)
+        else:
+            info.update(rec)
+    raise RuntimeError("Timed out waiting for the benchmark to finish")
+
+
+def bench_usb(ser):
+    """CDC throughput, timed here as the device can't see when its data arrives"""
+    results = []
+    ser.write("USBTX {0}\n".format(USB_BYTES).encode())
+    got = 0
+    start = time.time()
+    while got < USB_BYTES:
+        data = ser.read(min(65536, USB_BYTES - got))
+        if not data:
+            break
+        got += len(data)
+    secs = time.time() - start
+    if got == USB_BYTES:
+        results.append({"name": "usb_cdc_send", "value": USB_BYTES / secs, "unit": "B/s", "better": "higher"})
+    else:
+        results.append({"name": "usb_cdc_send", "error": "short read"})
+
+    ser.reset_input_buffer()
+    ser.write("USBRX {0}\n".format(USB_BYTES).encode())
+    time.sleep(0.1)
+    block = bytes(range(256)) * 256
+    for _ in range(USB_BYTES // len(block)):
+        ser.write(block)
+    reply = ""
+    while not reply.startswith("USBRX "):
+        reply = ser.readline().decode("utf-8", "replace").strip()
+        if not reply:
+            break
+    try:
+        _, n, us = reply.split()
+        results.append({"name": "usb_cdc_receive", "value": int(n) * 1e6 / int(us), "unit": "B/s", "better": "higher"})
+    except ValueError:
+        results.append({"name": "usb_cdc_receive", "error": "no reply"})
+    for r in results:
+        print("  {0:28} {1}".format(r["name"], r.get("error") or "{0:.3f} {1}".format(r["value"], r["unit"])))
+    return results
+
+
+class NetServers:
+    """The far ends of BenchNet: TCP sink, TCP source, UDP counter and TLS server"""
+
+    def __init__(self, port):
+        self.port = port
+        self.tmp = tempfile.mkdtemp()
+        cert = os.path.join(self.tmp, "cert.pem")
+        key = os.path.join(self.tmp, "key.pem")
+        subprocess.check_call(["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "1",
+                               "-subj", "/CN=bench", "-keyout", key, "-out", cert],
+                              stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        self.tls = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        self.tls.load_cert_chain(cert, key)
+        for fn, proto, off in ((self.tcp_sink, socket.SOCK_STREAM, 0), (self.tcp_source, socket.SOCK_STREAM, 1),
+                               (self.udp_count, socket.SOCK_DGRAM, 2), (self.tls_accept, socket.SOCK_STREAM, 3)):
+            s = socket.socket(socket.AF_INET, proto)
+            s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+            s.bind(("", port + off))
+            if proto == socket.SOCK_STREAM:
+                s.listen(2)
+            threading.Thread(target=fn, args=(s,), daemon=True).start()
+
+    @staticmethod
+    def read_count(conn):
+        line = b""
+        while not line.endswith(b"\n"):
+            c = conn.recv(1)
+            if not c:
+                return 0
+            line += c
+        return int(line)
+
+    def tcp_sink(self, s):
+        while True:
+            conn, _ = s.accept()
+            with conn:
+                want = self.read_count(conn)
+                got = 0
+                while got < want:
+                    data = conn.recv(65536)
+                    if not data:
+                        break
+                    got += len(data)
+                conn.sendall("{0}\n".format(got).encode())
+
+    def tcp_source(self, s):
+        block = bytes(range(256)) * 16
+        while True:
+            conn, _ = s.accept()
+            with conn:
+                left = self.read_count(conn)
+                while left > 0:
+                    n = min(left, len(block))
+                    conn.sendall(block[:n])
+                    left -= n
+
+    def udp_count(self, s):
+        count = 0
+        while True:
+            data, addr = s.recvfrom(2048)
+            if data == b"END":
+                s.sendto(str(count).encode(), addr)
+                count = 0
+            else:
+                count += 1
+
+    def tls_accept(self, s):
+        while True:
+            conn, _ = s.accept()
+            try:
+                with self.tls.wrap_socket(conn, server_side=True) as t:
+                    t.recv(1)  # Wait for the client to close
+            except (ssl.SSLError, OSError):
+                pass
+
+
+def local_ip():
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    try:
+        s.connect(("10.255.255.255", 1))
+        return s.getsockname()[0]
+    finally:
+        s.close()
+
+
+def compare(results, baseline, threshold):
+    old = {r["name"]: r for r in baseline.get("results", []) if "value" in r}
+    bad = []
+    for r in results:
+        if "value" not in r or r["name"] not in old or not old[r["name"]]["value"]:
+            continue
+        change = 100.0 * (r["value"] - old[r["name"]]["value"]) / old[r["name"]]["value"]
+        worse = -change if r["better"] == "higher" else change
+        if worse > threshold:
+            bad.append("{0}: {1:.3f} -> {2:.3f} {3} ({4:+.1f}%)".format(r["name"], old[r["name"]]["value"],
+                                                                      r["value"], r["unit"], change))
+    return bad
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the on-target core benchmarks")
+    parser.add_argument("sketches", nargs="*", default=SKETCHES, help="Benchmarks to run, default all")
+    parser.add_argument("--port", required=True, help="Serial port of the board")
+    parser.add_argument("--fqbn", help="Build and upload each sketch with arduino-cli for this board first")
+    parser.add_argument("--out", default="bench.json", help="Results file to write")
+    parser.add_argument("--baseline", help="Earlier results file to compare against")
+    parser.add_argument("--threshold", type=float, default=10.0, help="Percent change counted as a regression")
+    parser.add_argument("--ssid", help="WiFi network for BenchNet")
+    parser.add_argument("--password", default="", help="WiFi password for BenchNet")
+    parser.add_argument("--host", help="Address of this host as seen by the board, for BenchNet")
+    parser.add_argument("--net-port", type=int, default=5201, help="First of 4 ports used by BenchNet")
+    parser.add_argument("--timeout", type=float, default=120, help="Seconds allowed for each sketch")
+    args = parser.parse_args()
+
+    try:
+        version = subprocess.check_output(["git", "describe", "--tags", "--always", "--dirty"], cwd=HERE,
+                                          stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        version = "unknown"
+    report = {"core": version, "date": datetime.datetime.now(datetime.timezone.utc).isoformat(),
+              "board": {}, "results": []}
+
+    servers = None
+    for sketch in args.sketches:
+        if sketch not in SKETCHES:
+            parser.error("Unknown benchmark " + sketch)
+        print(sketch)
+        if args.fqbn:
+            upload(sketch, args.fqbn, args.port)
+        ser = open_port(args.port)
+        if sketch == "BenchNet":
+            if not args.ssid:
+                parser.error("BenchNet needs --ssid")
+            if not servers:
+                servers = NetServers(args.net_port)
+            for line in ("SSID " + args.ssid, "PASS " + args.password, "HOST " + (args.host or local_ip()),
+                         "PORT {0}".format(args.net_port)):
+                ser.write((line + "\n").encode())
+        ser.write(b"RUN\n")
+        info, results = collect(ser, args.timeout)
+        if sketch == "BenchCore":
+            results += bench_usb(ser)
+        ser.close()
+        for r in results:
+            r["sketch"] = sketch
+        report["board"].update(info)
+        report["results"] += results
+
+    with open(args.out, "w") as f:
+        json.dump(report, f, indent=2)
+    print("Results written to " + args.out)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            bad = compare(report["results"], json.load(f), args.threshold)
+        if bad:
+            print("Regressions over {0}%:".format(args.threshold))
+            for b in bad:
+                print("  " + b)
+            return 1
+        print("No regressions over {0}%".format(args.threshold))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,64 @@
+/*
+    Heap call counting for the host performance harness
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+// Replaces glibc's malloc family so every allocation made by the code under test, including
+// operator new from libstdc++, is counted.  realloc counts as an allocation whenever it may
+// move the block, which is what fragments the heap on the target.
+
+#include <stddef.h>
+#include "alloc.h"
+
+extern "C" {
+    void *__libc_malloc(size_t);
+    void *__libc_calloc(size_t, size_t);
+    void *__libc_realloc(void *, size_t);
+    void __libc_free(void *);
+}
+
+AllocStats allocStats;
+
+extern "C" void *malloc(size_t size) {
+    allocStats.allocs++;
+    allocStats.bytes += size;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t n, size_t size) {
+    allocStats.allocs++;
+    allocStats.bytes += n * size;
+    return __libc_calloc(n, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) {
+    if (ptr) {
+        allocStats.reallocs++;
+    } else {
+        allocStats.allocs++;
+    }
+    allocStats.bytes += size;
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void *ptr) {
+    if (ptr) {
+        allocStats.frees++;
+    }
+    __libc_free(ptr);
+}
@@ -0,0 +1,48 @@
+/*
+    newlib functions the core relies on which glibc doesn't have
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+char *utoa(unsigned value, char *str, int base) {
+    char tmp[33];
+    int i = 0;
+    if ((base < 2) || (base > 36)) {
+        str[0] = 0;
+        return str;
+    }
+    do {
+        int d = value % base;
+        tmp[i++] = (d < 10) ? '0' + d : 'a' + d - 10;
+        value /= base;
+    } while (value);
+    char *p = str;
+    while (i) {
+        *p++ = tmp[--i];
+    }
+    *p = 0;
+    return str;
+}
+
+char *itoa(int value, char *str, int base) {
+    if ((base == 10) && (value < 0)) {
+        str[0] = '-';
+        utoa(-(unsigned)value, str + 1, base);
+        return str;
+    }
+    return utoa((unsigned)value, str, base);
+}
@@ -0,0 +1,257 @@
+/*
+    Host performance harness for the core's portable code
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+// Runs one named case and prints its per-operation heap use (and time) as a JSON line.
+// Under callgrind (see run_perf.py) only the timed loop is instrumented, so the totals are
+// the instructions for exactly "ops" operations.
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include "api/String.h"
+#include "api/Print.h"
+#include "alloc.h"
+
+#if __has_include(<valgrind/callgrind.h>)
+#include <valgrind/callgrind.h>
+#else
+#define CALLGRIND_TOGGLE_COLLECT
+#endif
+
+#define LFS_NAME_MAX 32
+#include "../../libraries/LittleFS/lib/littlefs/lfs.h"
+
+using arduino::String;
+using arduino::Print;
+
+// Print sink which only counts, so Print's own formatting is what gets measured
+class NullPrint : public Print {
+public:
+    size_t write(uint8_t) override {
+        _count++;
+        return 1;
+    }
+    size_t write(const uint8_t *, size_t size) override {
+        _count += size;
+        return size;
+    }
+    size_t _count = 0;
+};
+
+// String
+
+static void stringConcat(int ops) {
+    for (int i = 0; i < ops; i++) {
+        String s;
+        for (int j = 0; j < 16; j++) {
+            s += "header: ";
+            s += j;
+            s += "\r\n";
+        }
+    }
+}
+
+static void stringReserveConcat(int ops) {
+    for (int i = 0; i < ops; i++) {
+        String s;
+        s.reserve(256);
+        for (int j = 0; j < 16; j++) {
+            s += "header: ";
+            s += j;
+            s += "\r\n";
+        }
+    }
+}
+
+static void stringNumbers(int ops) {
+    for (int i = 0; i < ops; i++) {
+        String a(i);
+        String b(i * 3.14159f, 3);
+        String c((unsigned long)i, 16);
+    }
+}
+
+static void stringSearch(int ops) {
+    String s("GET /index.html?name=value&other=thing HTTP/1.1");
+    for (int i = 0; i < ops; i++) {
+        int q = s.indexOf('?');
+        int sp = s.indexOf(' ', q);
+        String args = s.substring(q + 1, sp);
+        args.replace("&", "\n");
+        args.toUpperCase();
+    }
+}
+
+// Print
+
+static void printNumbers(int ops) {
+    NullPrint p;
+    for (int i = 0; i < ops; i++) {
+        p.print(i);
+        p.print(' ');
+        p.println((unsigned long)i * 7919, 16);
+    }
+}
+
+static void printFloat(int ops) {
+    NullPrint p;
+    for (int i = 0; i < ops; i++) {
+        p.println(i * 0.001, 4);
+    }
+}
+
+static void printPrintf(int ops) {
+    NullPrint p;
+    for (int i = 0; i < ops; i++) {
+        p.printf("%s=%d (0x%08x) %5.2f\n", "value", i, i, i / 3.0);
+    }
+}
+
+// LittleFS, with the same geometry as LittleFS.h on a 1MB RAM "flash"
+
+static const int FLASH_BLOCK = 4096;
+static const int FLASH_BLOCKS = 256;
+static uint8_t flash[FLASH_BLOCK * FLASH_BLOCKS];
+
+static int ramRead(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size) {
+    memcpy(buffer, flash + block * c->block_size + off, size);
+    return 0;
+}
+
+static int ramProg(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size) {
+    memcpy(flash + block * c->block_size + off, buffer, size);
+    return 0;
+}
+
+static int ramErase(const struct lfs_config *c, lfs_block_t block) {
+    memset(flash + block * c->block_size, 0xff, c->block_size);
+    return 0;
+}
+
+static int ramSync(const struct lfs_config *) {
+    return 0;
+}
+
+static lfs_t lfs;
+
+static void lfsMount() {
+    static struct lfs_config cfg;
+    cfg.read = ramRead;
+    cfg.prog = ramProg;
+    cfg.erase = ramErase;
+    cfg.sync = ramSync;
+    cfg.read_size = 256;
+    cfg.prog_size = 256;
+    cfg.block_size = FLASH_BLOCK;
+    cfg.block_count = FLASH_BLOCKS;
+    cfg.block_cycles = 16;
+    cfg.cache_size = 256;
+    cfg.lookahead_size = 256;
+    memset(flash, 0xff, sizeof(flash));
+    lfs_format(&lfs, &cfg);
+    lfs_mount(&lfs, &cfg);
+}
+
+// One op = write and close a 4KB file
+static void lfsWrite(int ops) {
+    static uint8_t buf[FLASH_BLOCK];
+    for (int i = 0; i < ops; i++) {
+        char name[16];
+        sprintf(name, "f%d", i % 64);
+        lfs_file_t f;
+        lfs_file_open(&lfs, &f, name, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC);
+        lfs_file_write(&lfs, &f, buf, sizeof(buf));
+        lfs_file_close(&lfs, &f);
+    }
+}
+
+// One op = open, read and close a 4KB file in 256 byte reads
+static void lfsRead(int ops) {
+    static uint8_t buf[256];
+    for (int i = 0; i < ops; i++) {
+        char name[16];
+        sprintf(name, "f%d", i % 64);
+        lfs_file_t f;
+        lfs_file_open(&lfs, &f, name, LFS_O_RDONLY);
+        while (lfs_file_read(&lfs, &f, buf, sizeof(buf)) > 0) {
+            /* discard */
+        }
+        lfs_file_close(&lfs, &f);
+    }
+}
+
+static void lfsSetupRead() {
+    lfsMount();
+    lfsWrite(64);
+}
+
+typedef struct {
+    const char *name;
+    int ops;
+    void (*setup)();
+    void (*run)(int ops);
+} PerfCase;
+
+static const PerfCase cases[] = {
+    { "string_concat", 1000, nullptr, stringConcat },
+    { "string_reserve_concat", 1000, nullptr, stringReserveConcat },
+    { "string_numbers", 1000, nullptr, stringNumbers },
+    { "string_search", 1000, nullptr, stringSearch },
+    { "print_numbers", 1000, nullptr, printNumbers },
+    { "print_float", 1000, nullptr, printFloat },
+    { "print_printf", 1000, nullptr, printPrintf },
+    { "littlefs_write_4k", 200, lfsMount, lfsWrite },
+    { "littlefs_read_4k", 200, lfsSetupRead, lfsRead },
+};
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <case>|list\n", argv[0]);
+        return 1;
+    }
+    for (const PerfCase &c : cases) {
+        if (!strcmp(argv[1], "list")) {
+            printf("%s\n", c.name);
+            continue;
+        }
+        if (strcmp(argv[1], c.name)) {
+            continue;
+        }
+        if (c.setup) {
+            c.setup();
+        }
+        AllocStats before = allocStats;
+        auto start = std::chrono::steady_clock::now();
+        CALLGRIND_TOGGLE_COLLECT;
+        c.run(c.ops);
+        CALLGRIND_TOGGLE_COLLECT;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        printf("{\"name\":\"%s\",\"ops\":%d,\"allocs_per_op\":%.3f,\"reallocs_per_op\":%.3f,\"bytes_per_op\":%.1f,\"ns_per_op\":%.1f}\n",
+               c.name, c.ops, (double)(allocStats.allocs - before.allocs) / c.ops,
+               (double)(allocStats.reallocs - before.reallocs) / c.ops,
+               (double)(allocStats.bytes - before.bytes) / c.ops, (double)ns / c.ops);
+        return 0;
+    }
+    if (strcmp(argv[1], "list")) {
+        fprintf(stderr, "Unknown case %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+#
+# Runs the host performance harness (bin/perf) case by case and checks the results
+#
+# Every case reports heap allocations per operation, which is what fragments the target's
+# heap.  With --callgrind each case is also run under valgrind's callgrind tool, which
+# only instruments the measured loop, to give instructions per operation; unlike wall
+# time these are repeatable enough to check against a threshold.
+#
+#   python3 run_perf.py --thresholds thresholds.json
+#   python3 run_perf.py --callgrind --update thresholds.json   # Accept the current numbers
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+PERF = os.path.join(HERE, "bin", "perf")
+CHECKED = ("allocs_per_op", "reallocs_per_op", "instructions_per_op")
+
+
+def run(case, callgrind):
+    if not callgrind:
+        return json.loads(subprocess.check_output([PERF, case]))
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, "callgrind.out")
+        res = json.loads(subprocess.check_output(["valgrind", "--tool=callgrind", "--collect-atstart=no",
+                                                  "--callgrind-out-file=" + out, PERF, case],
+                                                 stderr=subprocess.DEVNULL))
+        with open(out) as f:
+            for line in f:
+                if line.startswith("totals:") or line.startswith("summary:"):
+                    res["instructions_per_op"] = int(line.split()[1]) / res["ops"]
+                    break
+    return res
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the host performance harness")
+    parser.add_argument("cases", nargs="*", help="Cases to run, default all")
+    parser.add_argument("--callgrind", action="store_true", help="Also count instructions under valgrind")
+    parser.add_argument("--thresholds", help="Fail if any case exceeds the limits in this file")
+    parser.add_argument("--update", help="Write the current results, plus --slack, as new limits to this file")
+    parser.add_argument("--slack", type=float, default=5.0, help="Percent headroom given to instruction limits")
+    parser.add_argument("--out", help="Write all results to this JSON file")
+    args = parser.parse_args()
+
+    cases = args.cases or subprocess.check_output([PERF, "list"]).decode().split()
+    results = []
+    for case in cases:
+        r = run(case, args.callgrind)
+        print("{0:24} allocs/op {1:8.3f}  reallocs/op {2:8.3f}  bytes/op {3:9.1f}  {4}".format(
+            r["name"], r["allocs_per_op"], r["reallocs_per_op"], r["bytes_per_op"],
+            "instr/op {0:.0f}".format(r["instructions_per_op"]) if "instructions_per_op" in r else
+            "ns/op {0:.1f}".format(r["ns_per_op"])))
+        results.append(r)
+
+    if args.out:
+        with open(args.out, "w") as f:
+            json.dump(results, f, indent=2)
+
+    if args.update:
+        limits = {}
+        for r in results:
+            limits[r["name"]] = {k: r[k] for k in CHECKED if k in r}
+            if "instructions_per_op" in r:
+                limits[r["name"]]["instructions_per_op"] = round(r["instructions_per_op"] * (1 + args.slack / 100))
+        with open(args.update, "w") as f:
+            json.dump(limits, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("Limits written to " + args.update)
+
+    failed = False
+    if args.thresholds:
+        with open(args.thresholds) as f:
+            limits = json.load(f)
+        for r in results:
+            for k, limit in limits.get(r["name"], {}).items():
+                if k in r and r[k] > limit + 1e-6:
+                    print("REGRESSION {0}: {1} {2:.3f} > {3}".format(r["name"], k, r[k], limit))
+                    failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
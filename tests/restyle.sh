@@ -4,11 +4,14 @@ for dir in ./cores/rp2040 ./libraries/EEPROM ./libraries/I2S \
            ./libraries/LittleFS/src ./libraries/LittleFS/examples \
            ./libraries/rp2040 ./libraries/SD ./libraries/ESP8266SdFat \
            ./libraries/Servo ./libraries/SPI ./libraries/Wire ./libraries/PDM \
-           ./libraries/WiFi ./libraries/lwIP_Ethernet ./libraries/lwIP_CYW43 \
+           ./libraries/WiFi ./libraries/lwIP_Ethernet ./libraries/lwIP_CYW43 ./libraries/lwIP_RMII ./libraries/lwIP_w5500 \
            ./libraries/FreeRTOS/src ./libraries/LEAmDNS ./libraries/MD5Builder \
            ./libraries/PicoOTA ./libraries/SDFS ./libraries/ArduinoOTA \
            ./libraries/Updater ./libraries/HTTPClient ./libraries/HTTPUpdate \
-           ./libraries/WebServer ./libraries/HTTPUpdateServer ./libraries/DNSServer ; do
+           ./libraries/WebServer ./libraries/HTTPUpdateServer ./libraries/DNSServer \
+           ./libraries/PWMAudio ./libraries/ADCInput ./libraries/ParallelBus ./libraries/DSP \
+           ./libraries/Preferences ./libraries/CANBus \
+           ./libraries/ParallelCamera ; do
     find $dir -type f \( -name "*.c" -o -name "*.h" -o -name "*.cpp" \) -a  \! -path '*api*' -exec astyle --suffix=none --options=./tests/astyle_core.conf \{\} \;
     find $dir -type f -name "*.ino" -exec astyle --suffix=none --options=./tests/astyle_examples.conf \{\} \;
 done
@@ -27,6 +27,9 @@
 # 2016-01-03:
 # - Added more options to parser.
 #
+# Changes
+# - Stream the image instead of waiting for a reply to every packet.
+#
 
 from __future__ import print_function
 import socket
@@ -36,12 +39,15 @@ import optparse
 import logging
 import hashlib
 import random
+import select
 
 # Commands
 FLASH = 0
 SPIFFS = 100
 AUTH = 200
 PROGRESS = False
+# Bytes handed to the socket at a time while streaming the image
+UPLOAD_CHUNK = 16384
 # update_progress() : Displays or updates a console progress bar
 ## Accepts a float between 0 and 1. Any int will be converted to a float.
 ## A value under 0 represents a 'halt'.
@@ -162,17 +168,24 @@ def serve(remoteAddr, localAddr, remotePort, localPort, password, filename, comm
       sys.stderr.write('Uploading')
       sys.stderr.flush()
     offset = 0
+    replies = ''
     while True:
-      chunk = f.read(1460)
+      chunk = f.read(UPLOAD_CHUNK)
       if not chunk: break
       offset += len(chunk)
       update_progress(offset/float(content_size))
       connection.settimeout(10)
       try:
+        # Stream without waiting for each progress reply, TCP flow control paces the upload.
+        # Replies are drained as they come so an early error is seen right away
         connection.sendall(chunk)
-        if connection.recv(32).decode().find('O') >= 0:
-          # connection will receive only digits or 'OK'
-          received_ok = True
+        while select.select([connection], [], [], 0)[0]:
+          data = connection.recv(64).decode()
+          if not data:
+            raise Exception('Connection closed')
+          replies += data
+        if replies.find('E') >= 0:
+          raise Exception(replies)
       except Exception:
         sys.stderr.write('\n')
         logging.error('Error Uploading')
@@ -188,8 +201,12 @@ def serve(remoteAddr, localAddr, remotePort, localPort, password, filename, comm
     # the connection before receiving the 'O' of 'OK'
     try:
       connection.settimeout(60)
+      # connection will receive only digits or 'OK', which may have arrived with the last data
       received_ok = False
       received_error = False
+      if replies.find('O') >= 0:
+        logging.info('Result: OK')
+        received_ok = True
       while not (received_ok or received_error):
         reply = connection.recv(64).decode()
         # Look for either the "E" in ERROR or the "O" in OK response
@@ -0,0 +1,172 @@
+/*
+    Inflates the compressed CYW43 firmware into the chip during bring-up
+
+    Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+// The driver downloads the firmware in 64 byte blocks through cyw43_write_bytes(), each
+// read from where it thinks the firmware sits in flash.  Only the CLM behind it is really
+// there (see cyw43_firmware_compress.py), so writes from that range are fed from a
+// deflate stream instead, in order.  The PIO SPI clock is also raised for the download
+// and put back once the last block is out.  cyw43_ll.c is built calling
+// cyw43_firmware_write_bytes() in its place (see CMakeLists.txt), so no link time
+// wrapping is needed and nothing outside libpico changes.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "hardware/clocks.h"
+#include "hardware/pio.h"
+#include "uzlib.h"
+
+// Average SPI clock during the download, the CYW43439's limit.  0 leaves it alone
+#ifndef CYW43_FIRMWARE_SPI_HZ
+#define CYW43_FIRMWARE_SPI_HZ 50000000
+#endif
+
+#ifndef CYW43_PIN_WL_CLOCK
+#define CYW43_PIN_WL_CLOCK 29
+#endif
+
+// From the generated cyw43_firmware_z.c
+extern const uint32_t __cyw43_fw_len;
+extern const uint32_t __cyw43_fw_z_len;
+extern const uint32_t __cyw43_fw_z_window;
+extern const uint8_t __cyw43_fw_z[];
+extern const uint8_t fw_43439A0_7_95_49_00_start[];
+
+int cyw43_write_bytes(void *self, uint32_t fn, uint32_t addr, size_t len, const uint8_t *src);
+
+static struct uzlib_uncomp *_z; // Followed by its dictionary
+static uint32_t _pos;
+static bool _eof;
+static pio_hw_t *_pio;
+static int _sm;
+static uint32_t _clkdiv;
+
+static void _speedUp() {
+    if (!CYW43_FIRMWARE_SPI_HZ) {
+        return;
+    }
+    // The bus SM is the one side-setting the WL clock.  It takes 2 cycles per bit
+    for (int p = 0; p < 2; p++) {
+        pio_hw_t *pio = p ? pio1_hw : pio0_hw;
+        for (int sm = 0; sm < 4; sm++) {
+            uint32_t pinctrl = pio->sm[sm].pinctrl;
+            if (!(pinctrl & PIO_SM0_PINCTRL_SIDESET_COUNT_BITS) ||
+                    (((pinctrl & PIO_SM0_PINCTRL_SIDESET_BASE_BITS) >> PIO_SM0_PINCTRL_SIDESET_BASE_LSB) != CYW43_PIN_WL_CLOCK)) {
+                continue;
+            }
+            // In 1/256ths, as the divider register has it
+            uint32_t cur = pio->sm[sm].clkdiv >> PIO_SM0_CLKDIV_FRAC_LSB;
+            uint32_t div = ((uint64_t)clock_get_hz(clk_sys) * 128 + CYW43_FIRMWARE_SPI_HZ - 1) / CYW43_FIRMWARE_SPI_HZ;
+            if (div < 256) {
+                div = 256;
+            }
+            if (div < cur) {
+                _pio = pio;
+                _sm = sm;
+                _clkdiv = pio->sm[sm].clkdiv;
+                pio->sm[sm].clkdiv = div << PIO_SM0_CLKDIV_FRAC_LSB;
+            }
+            return;
+        }
+    }
+}
+
+static void _done() {
+    if (_pio) {
+        _pio->sm[_sm].clkdiv = _clkdiv;
+        _pio = NULL;
+    }
+    free(_z);
+    _z = NULL;
+}
+
+static bool _start() {
+    _done();
+    _z = (struct uzlib_uncomp *)malloc(sizeof(*_z) + __cyw43_fw_z_window);
+    if (!_z) {
+        return false;
+    }
+    uzlib_init();
+    _z->source = __cyw43_fw_z;
+    _z->source_limit = __cyw43_fw_z + __cyw43_fw_z_len;
+    _z->source_read_cb = NULL;
+    uzlib_uncompress_init(_z, (unsigned char *)(_z + 1), __cyw43_fw_z_window);
+    _pos = 0;
+    _eof = false;
+    _speedUp();
+    return true;
+}
+
+// The next len bytes of firmware, zeros once the stream has ended
+static bool _inflate(uint8_t *dst, size_t len) {
+    _z->dest_start = dst;
+    _z->dest = dst;
+    _z->dest_limit = dst + len;
+    if (!_eof) {
+        int res = uzlib_uncompress(_z);
+        if ((res != TINF_OK) && (res != TINF_DONE)) {
+            return false;
+        }
+        _eof = res == TINF_DONE;
+    }
+    while (_z->dest < _z->dest_limit) {
+        *(_z->dest++) = 0;
+    }
+    _pos += len;
+    return true;
+}
+
+int cyw43_firmware_write_bytes(void *self, uint32_t fn, uint32_t addr, size_t len, const uint8_t *src) {
+    uint32_t off = (uint32_t)(src - fw_43439A0_7_95_49_00_start);
+    if (off >= __cyw43_fw_len) {
+        return cyw43_write_bytes(self, fn, addr, len, src);
+    }
+    uint8_t buf[64];
+    // A new download (or one going backwards) starts the stream over, gaps are skipped
+    if ((!_z || (off < _pos)) && !_start()) {
+        return -1;
+    }
+    while (_pos < off) {
+        size_t n = (off - _pos) > sizeof(buf) ? sizeof(buf) : (off - _pos);
+        if (!_inflate(buf, n)) {
+            _done();
+            return -1;
+        }
+    }
+    // Larger writes are never asked for, but would go out as several
+    while (len) {
+        size_t n = len > sizeof(buf) ? sizeof(buf) : len;
+        if (!_inflate(buf, n)) {
+            _done();
+            return -1;
+        }
+        int ret = cyw43_write_bytes(self, fn, addr, n, buf);
+        if (ret) {
+            _done();
+            return ret;
+        }
+        addr += n;
+        len -= n;
+    }
+    if (_pos >= __cyw43_fw_len) {
+        _done();
+    }
+    return 0;
+}
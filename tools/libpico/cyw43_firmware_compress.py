@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+
+# Deflates the CYW43 firmware for libpico, see cyw43_firmware.c
+#
+# Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+# The combined blob is the firmware, padded to 512 bytes, followed by the CLM.  The
+# firmware part is stored as a raw deflate stream and the CLM as-is, because the driver
+# reads the CLM straight from flash.  The resource symbols the driver links against are
+# placed so the CLM is where it expects, and every firmware read goes through the
+# redirected cyw43_write_bytes() which inflates it instead.
+
+import argparse
+import zlib
+
+
+def array(f, name, data, align):
+    f.write("const uint8_t __attribute__((aligned(%d))) %s[%d] = {\n" % (align, name, len(data)))
+    for i in range(0, len(data), 16):
+        f.write("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",\n")
+    f.write("};\n\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Deflate the CYW43 firmware into a C source")
+    parser.add_argument("--fw-len", type=int, default=224190, help="Firmware length (CYW43_WIFI_FW_LEN)")
+    parser.add_argument("--symbol", default="fw_43439A0_7_95_49_00", help="Resource symbol prefix the driver uses")
+    parser.add_argument("--window-bits", type=int, default=12, help="Deflate window, the RAM needed to inflate it")
+    parser.add_argument("input", help="Combined firmware and CLM blob")
+    parser.add_argument("output", help="C source to write")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        blob = f.read()
+    fwlen = (args.fw_len + 511) & ~511
+    if len(blob) < fwlen:
+        raise SystemExit("%s is shorter than the firmware length" % args.input)
+    fw = blob[:fwlen]
+    clm = blob[fwlen:]
+
+    z = zlib.compressobj(9, zlib.DEFLATED, -args.window_bits, 9)
+    fwz = z.compress(fw) + z.flush()
+    # Make sure it'll come back out the same
+    if zlib.decompress(fwz, -args.window_bits) != fw:
+        raise SystemExit("Compressed firmware doesn't match")
+
+    with open(args.output, "w") as f:
+        f.write("// Generated by cyw43_firmware_compress.py from %s, do not edit\n" % args.input.split("/")[-1])
+        f.write("// %d byte firmware deflated to %d bytes, %d byte CLM\n\n" % (fwlen, len(fwz), len(clm)))
+        f.write("#include <stdint.h>\n\n")
+        f.write("const uint32_t __cyw43_fw_len = %d;\n" % fwlen)
+        f.write("const uint32_t __cyw43_fw_z_len = %d;\n" % len(fwz))
+        f.write("const uint32_t __cyw43_fw_z_window = %d;\n\n" % (1 << args.window_bits))
+        array(f, "__cyw43_fw_z", fwz, 4)
+        array(f, "__cyw43_clm", clm, 4)
+        f.write("// The firmware would end right where the CLM starts\n")
+        f.write("__asm__(\".global %s_start\\n\"\n" % args.symbol)
+        f.write("        \".set %s_start, __cyw43_clm - %d\\n\"\n" % (args.symbol, fwlen))
+        f.write("        \".global %s_end\\n\"\n" % args.symbol)
+        f.write("        \".set %s_end, __cyw43_clm + %d\\n\"\n" % (args.symbol, len(clm)))
+        f.write("        \".global %s_size\\n\"\n" % args.symbol)
+        f.write("        \".set %s_size, %d\\n\");\n" % (args.symbol, len(blob)))
+
+
+if __name__ == "__main__":
+    main()
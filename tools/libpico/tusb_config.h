@@ -39,6 +39,15 @@
 #endif
 
 #define CFG_TUSB_RHPORT0_MODE     OPT_MODE_DEVICE
+// The PIO host port in USBHost.cpp, which supplies the hcd_* driver.  TinyUSB's host stack
+// lives in libpico, so this needs libpico rebuilt (make-libpico.sh) with the same setting.
+// The prebuilt libraries are built without it.
+#ifndef USBHOST_PIO
+#define USBHOST_PIO               0
+#endif
+#if USBHOST_PIO
+#define CFG_TUSB_RHPORT1_MODE     OPT_MODE_HOST
+#endif
 #define CFG_TUSB_OS               OPT_OS_PICO
 
 // CFG_TUSB_DEBUG is defined by compiler in DEBUG build
@@ -85,6 +94,26 @@
 // HID buffer size Should be sufficient to hold ID (if any) + Data
 #define CFG_TUD_HID_EP_BUFSIZE  (64)
 
+//--------------------------------------------------------------------
+// HOST CONFIGURATION
+//--------------------------------------------------------------------
+
+#if USBHOST_PIO
+// Only a single device plugged straight in, no hubs
+#define CFG_TUH_ENUMERATION_BUFSIZE (256)
+#define CFG_TUH_HUB              (0)
+#define CFG_TUH_DEVICE_MAX       (1)
+
+//------------- CLASS -------------//
+#define CFG_TUH_HID              (4)
+#define CFG_TUH_MSC              (1)
+#define CFG_TUH_CDC              (0)
+#define CFG_TUH_VENDOR           (0)
+
+#define CFG_TUH_HID_EPIN_BUFSIZE  (64)
+#define CFG_TUH_HID_EPOUT_BUFSIZE (64)
+#endif
+
 #ifdef __cplusplus
  }
 #endif
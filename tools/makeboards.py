@@ -28,23 +28,58 @@ def BuildDebugPort(name):
 
 def BuildDebugLevel(name):
     for l in [ ("None", ""), ("Core", "-DDEBUG_RP2040_CORE"), ("SPI", "-DDEBUG_RP2040_SPI"), ("Wire", "-DDEBUG_RP2040_WIRE"),
-               ("All", "-DDEBUG_RP2040_WIRE -DDEBUG_RP2040_SPI -DDEBUG_RP2040_CORE"), ("NDEBUG", "-DNDEBUG") ]:
+               ("All", "-DDEBUG_RP2040_WIRE -DDEBUG_RP2040_SPI -DDEBUG_RP2040_CORE"), ("NDEBUG", "-DNDEBUG"),
+               ("Profiler", "-DPROFILE_RP2040_CORE") ]:
         print("%s.menu.dbglvl.%s=%s" % (name, l[0], l[0]))
         print("%s.menu.dbglvl.%s.build.debug_level=%s" % (name, l[0], l[1]))
 
 def BuildFreq(name):
     for f in [ 133,  50, 100, 120, 125, 150, 175, 200, 225, 240, 250, 275, 300]:
         warn = ""
-        if f > 133: warn = " (Overclock)"
+        if f > 275: warn = " (Overclock, 1.20V)"
+        elif f > 250: warn = " (Overclock, 1.15V)"
+        elif f > 133: warn = " (Overclock)"
         print("%s.menu.freq.%s=%s MHz%s" % (name, f, f, warn))
         print("%s.menu.freq.%s.build.f_cpu=%dL" % (name, f, f * 1000000))
 
+def BuildFlashClock(name):
+    for l in [ ("boot2", "Boot Stage 2 Default", ""), ("div2", "Fast /2 (known-good flash)", "-DRP2040_QSPI_CLKDIV=2") ]:
+        print("%s.menu.flashclk.%s=%s" % (name, l[0], l[1]))
+        print("%s.menu.flashclk.%s.build.flashclk=%s" % (name, l[0], l[2]))
+
 def BuildOptimize(name):
     for l in [ ("Small", "Small", "-Os", " (standard)"), ("Optimize", "Optimize", "-O", ""), ("Optimize2", "Optimize More", "-O2", ""),
                ("Optimize3", "Optimize Even More", "-O3", ""), ("Fast", "Fast", "-Ofast", " (maybe slower)"), ("Debug", "Debug", "-Og", "") ]:
         print("%s.menu.opt.%s=%s (%s)%s" % (name, l[0], l[1], l[2], l[3]))
         print("%s.menu.opt.%s.build.flags.optimize=%s" % (name, l[0], l[2]))
 
+def BuildLTO(name):
+    print("%s.menu.lto.Disabled=Disabled (standard)" % (name))
+    print("%s.menu.lto.Disabled.build.flags.lto=" % (name))
+    print("%s.menu.lto.Enabled=Enabled" % (name))
+    print("%s.menu.lto.Enabled.build.flags.lto=-flto=auto -fuse-linker-plugin" % (name))
+
+# Objects whose code runs from RAM instead of flash, so XIP cache misses can't stall them.  memcpy/memset
+# and libgcc are always in RAM
+ramfunctions = [ "*core.a:Print.cpp.o", "*core.a:Stream.cpp.o",
+                 "*libpico*.a:pbuf.c.obj", "*libpico*.a:inet_chksum.c.obj", "*libpico*.a:ip.c.obj", "*libpico*.a:ip4.c.obj",
+                 "*libpico*.a:tcp_in.c.obj", "*libpico*.a:tcp_out.c.obj", "*libpico*.a:udp.c.obj", "*libpico*.a:etharp.c.obj",
+                 "*libpico*.a:ethernet.c.obj", "*libpico*.a:usbd.c.obj", "*libpico*.a:dcd_rp2040.c.obj",
+                 "*libpico*.a:rp2040_usb.c.obj", "*libpico*.a:cdc_device.c.obj",
+                 "*libbearssl.a:i15_montmul.o", "*libbearssl.a:i15_mulacc.o", "*libbearssl.a:i15_muladd.o",
+                 "*libbearssl.a:i15_modpow2.o", "*libbearssl.a:i15_reduce.o", "*libbearssl.a:i15_add.o",
+                 "*libbearssl.a:i15_sub.o", "*libbearssl.a:ec_p256_m15.o", "*libbearssl.a:ec_c25519_m15.o" ]
+
+def BuildRAMFunctions(name):
+    print("%s.menu.ramfunc.Flash=Run From Flash (standard)" % (name))
+    print("%s.menu.ramfunc.Flash.build.ramfunc=" % (name))
+    print("%s.menu.ramfunc.Flash.build.ramfuncdefs=" % (name))
+    print("%s.menu.ramfunc.RAM=Hot Paths in RAM" % (name))
+    print("%s.menu.ramfunc.RAM.build.ramfunc=%s" % (name, " ".join(ramfunctions)))
+    # LTO merges the core objects so the patterns above can't find Print and Stream, this
+    # places their hot methods by section instead
+    print("%s.menu.ramfunc.RAM.build.ramfuncdefs=-DRP2040_HOT_CODE_RAM=1" % (name))
+
 def BuildRTTI(name):
     print("%s.menu.rtti.Disabled=Disabled" % (name))
     print("%s.menu.rtti.Disabled.build.flags.rtti=-fno-rtti" % (name))
@@ -83,6 +118,16 @@ def BuildWithoutUSBStack(name):
     print("%s.menu.usbstack.nousb=No USB" % (name))
     print('%s.menu.usbstack.nousb.build.usbstack_flags="-DNO_USB -DDISABLE_USB_SERIAL -I{runtime.platform.path}/tools/libpico"' % (name))
 
+def BuildCDCFifo(name):
+    for l in [ ("256", "256 Bytes", 256, 256), ("1k", "1KB", 1024, 1024), ("4k", "4KB", 4096, 4096) ]:
+        print("%s.menu.cdcfifo.%s=%s" % (name, l[0], l[1]))
+        print("%s.menu.cdcfifo.%s.build.cdcfifo=-DSERIALUSB_RX_FIFO=%d -DSERIALUSB_TX_FIFO=%d" % (name, l[0], l[2], l[3]))
+
+def BuildHIDPoll(name):
+    for l in [ ("10", "10ms"), ("4", "4ms"), ("1", "1ms") ]:
+        print("%s.menu.hidpoll.%s=%s" % (name, l[0], l[1]))
+        print("%s.menu.hidpoll.%s.build.hidpoll=-DUSBD_HID_POLL_MS=%s" % (name, l[0], l[0]))
+
 def BuildIPStack(name):
     print("%s.menu.ipstack.ipv4only=IPv4 Only" % (name))
     print('%s.menu.ipstack.ipv4only.build.libpico=libpico.a' % (name))
@@ -138,7 +183,10 @@ def BuildGlobalMenuList():
     print("menu.BoardModel=Model")
     print("menu.flash=Flash Size")
     print("menu.freq=CPU Speed")
+    print("menu.flashclk=Flash Clock")
     print("menu.opt=Optimize")
+    print("menu.lto=Link-Time Optimization")
+    print("menu.ramfunc=Hot Code")
     print("menu.rtti=RTTI")
     print("menu.stackprotect=Stack Protector")
     print("menu.exceptions=C++ Exceptions")
@@ -146,6 +194,8 @@ def BuildGlobalMenuList():
     print("menu.dbglvl=Debug Level")
     print("menu.boot2=Boot Stage 2")
     print("menu.usbstack=USB Stack")
+    print("menu.cdcfifo=USB CDC FIFO")
+    print("menu.hidpoll=USB HID Polling")
     print("menu.ipstack=IP Stack")
 
 def MakeBoard(name, vendor_name, product_name, vid, pid, pwr, boarddefine, flashsizemb, boot2, extra = None):
@@ -174,7 +224,10 @@ def MakeBoard(name, vendor_name, product_name, vid, pid, pwr, boarddefine, flash
         else:
             BuildFlashMenu(n, flashsizemb * 1024 * 1024, fssizelist)
         BuildFreq(n)
+        BuildFlashClock(n)
         BuildOptimize(n)
+        BuildLTO(n)
+        BuildRAMFunctions(n)
         BuildRTTI(n)
         BuildStackProtect(n)
         BuildExceptions(n)
@@ -184,6 +237,8 @@ def MakeBoard(name, vendor_name, product_name, vid, pid, pwr, boarddefine, flash
             BuildWithoutUSBStack(n)
         else:
             BuildUSBStack(n)
+            BuildCDCFifo(n)
+            BuildHIDPoll(n)
         BuildIPStack(n)
         if name == "generic":
             BuildBoot(n)
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Makes an OTA delta patch rebuilding new.bin from old.bin, the image already in flash.
+#
+# The OTA bootloader rewrites flash in place, one 4K block at a time, in the order the
+# blocks appear in the patch.  A copy can only read base blocks which haven't been
+# rewritten yet, so blocks are ordered to satisfy their copies, and where two blocks copy
+# from each other one of them has those copies turned into inserts.
+
+import argparse
+import struct
+import sys
+import zlib
+
+BLOCK = 4096
+WINDOW = 16       # Shortest match worth a copy record
+CANDIDATES = 8    # Positions kept per window when indexing the base image
+INSERT = 0x80000000
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='OTA delta patch generator')
+    parser.add_argument('-b', '--base', help='Binary running on the device', required=True)
+    parser.add_argument('-n', '--new', help='New binary', required=True)
+    parser.add_argument('-o', '--out', help='Output patch file', required=True)
+    return parser.parse_args()
+
+def index_base(base):
+    idx = {}
+    for i in range(0, len(base) - WINDOW + 1):
+        l = idx.setdefault(base[i:i + WINDOW], [])
+        if len(l) < CANDIDATES:
+            l.append(i)
+    return idx
+
+def match_len(base, src, new, pos, end):
+    n = 0
+    limit = min(end - pos, len(base) - src)
+    while n < limit and base[src + n] == new[pos + n]:
+        n += 1
+    return n
+
+def diff_block(base, new, idx, start, end):
+    """Returns the [('copy', src, len) | ('insert', bytes)] ops producing new[start:end]"""
+    ops = []
+    lit = bytearray()
+    pos = start
+    delta = None  # src - pos of the last copy, tried first since code usually just moves
+    while pos < end:
+        best_src, best_len = None, 0
+        tries = list(idx.get(new[pos:pos + WINDOW], []))
+        if delta is not None and 0 <= pos + delta < len(base):
+            tries.insert(0, pos + delta)
+        for src in tries:
+            l = match_len(base, src, new, pos, end)
+            if l > best_len:
+                best_src, best_len = src, l
+        if best_len >= WINDOW or (best_len and best_len == end - pos):
+            if lit:
+                ops.append(('insert', bytes(lit)))
+                lit = bytearray()
+            ops.append(('copy', best_src, best_len))
+            delta = best_src - pos
+            pos += best_len
+        else:
+            lit.append(new[pos])
+            pos += 1
+    if lit:
+        ops.append(('insert', bytes(lit)))
+    return ops
+
+def sources(block, ops):
+    """Base blocks, other than its own, that the ops read"""
+    s = set()
+    for op in ops:
+        if op[0] == 'copy':
+            s.update(range(op[1] // BLOCK, (op[1] + op[2] - 1) // BLOCK + 1))
+    s.discard(block)
+    return s
+
+def inline(ops, victim, base):
+    """Turns any copy reading base block victim into an insert"""
+    out = []
+    for op in ops:
+        if op[0] == 'copy' and op[1] // BLOCK <= victim <= (op[1] + op[2] - 1) // BLOCK:
+            out.append(('insert', base[op[1]:op[1] + op[2]]))
+        else:
+            out.append(op)
+    return out
+
+def order_blocks(blocks, base):
+    """Orders the blocks so each one is rebuilt before anything it copies from is rewritten"""
+    order = []
+    pending = dict(blocks)
+    while pending:
+        # Blocks nothing still pending wants to copy from are safe to rewrite now
+        wanted = set()
+        for b, ops in pending.items():
+            wanted.update(sources(b, ops) & pending.keys())
+        ready = [b for b in pending if b not in wanted]
+        if not ready:
+            # A cycle.  Stop copying from the block that the fewest bytes are read from.
+            cost = {}
+            for b, ops in pending.items():
+                for op in ops:
+                    if op[0] == 'copy':
+                        for s in sources(b, [op]) & pending.keys():
+                            cost[s] = cost.get(s, 0) + op[2]
+            victim = min(cost, key=cost.get)
+            for b in pending:
+                pending[b] = inline(pending[b], victim, base)
+            continue
+        for b in sorted(ready):
+            order.append((b, pending.pop(b)))
+    return order
+
+def main():
+    args = parse_args()
+    with open(args.base, "rb") as f:
+        base = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+
+    idx = index_base(base)
+    blocks = {}
+    for b in range((len(new) + BLOCK - 1) // BLOCK):
+        start = b * BLOCK
+        end = min(start + BLOCK, len(new))
+        if new[start:end] != base[start:end]:
+            blocks[b] = diff_block(base, new, idx, start, end)
+
+    body = bytearray()
+    crc = 0
+    for b, ops in order_blocks(blocks, base):
+        body += struct.pack('<I', b)
+        for op in ops:
+            if op[0] == 'copy':
+                body += struct.pack('<II', op[2], op[1])
+            else:
+                body += struct.pack('<I', len(op[1]) | INSERT) + op[1]
+        crc = zlib.crc32(new[b * BLOCK:min((b + 1) * BLOCK, len(new))], crc)
+
+    hdr = b'PicoDiff' + struct.pack('<IIIIII', len(base), zlib.crc32(base), len(new), zlib.crc32(new), len(blocks), crc)
+    with open(args.out, "wb") as out:
+        out.write(hdr)
+        out.write(body)
+    sys.stderr.write("Delta: %d of %d blocks changed, %d byte patch for a %d byte image\n" % (len(blocks), (len(new) + BLOCK - 1) // BLOCK, len(hdr) + len(body), len(new)))
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Turns web files into a header of HTTPStaticContent, for WebServer::serveStatic() and
+# sendStatic() to send straight out of flash.
+#
+# Everything a response needs is worked out here instead of on the device: the body is
+# GZIP compressed (unless it already is, or --no-gzip), and its length, Content-Type and
+# ETag are stored next to it.  The data is const so it stays in flash, which lets the
+# WebServer hand it to the TCP stack by reference without copying it into RAM.
+#
+# Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+# Same as the WebServer's detail/mimetable.cpp
+MIME = {
+    ".html": "text/html", ".htm": "text/html", ".css": "text/css", ".txt": "text/plain",
+    ".js": "application/javascript", ".json": "application/json", ".png": "image/png",
+    ".gif": "image/gif", ".jpg": "image/jpeg", ".ico": "image/x-icon", ".svg": "image/svg+xml",
+    ".ttf": "application/x-font-ttf", ".otf": "application/x-font-opentype",
+    ".woff": "application/font-woff", ".woff2": "application/font-woff2",
+    ".eot": "application/vnd.ms-fontobject", ".sfnt": "application/font-sfnt",
+    ".xml": "text/xml", ".pdf": "application/pdf", ".zip": "application/zip",
+    ".gz": "application/x-gzip", ".appcache": "text/cache-manifest"
+}
+
+# Already compressed, so GZIP would only make them bigger
+NOGZIP = (".png", ".gif", ".jpg", ".ico", ".woff", ".woff2", ".zip", ".gz", ".pdf")
+
+
+def content_type(path):
+    base = path[:-3] if path.endswith(".gz") else path
+    return MIME.get(os.path.splitext(base)[1].lower(), "application/octet-stream")
+
+
+def c_name(path):
+    name = re.sub(r"[^0-9A-Za-z_]", "_", os.path.basename(path[:-3] if path.endswith(".gz") else path))
+    return "_" + name if name[0].isdigit() else name
+
+
+def convert(path, name, compress):
+    with open(path, "rb") as f:
+        data = f.read()
+    ctype = content_type(path)
+    if data[:2] == b"\x1f\x8b":
+        gz = True
+    elif compress and not os.path.splitext(path)[1].lower() in NOGZIP:
+        # mtime=0 so the same input always gives the same bytes, and so the same ETag
+        packed = gzip.compress(data, compresslevel=9, mtime=0)
+        gz = len(packed) < len(data)
+        if gz:
+            data = packed
+    else:
+        gz = False
+    etag = '"' + hashlib.sha1(data).hexdigest()[:16] + '"'
+
+    out = []
+    out.append("// %s: %d bytes%s, %s" % (os.path.basename(path), len(data), " gzip" if gz else "", ctype))
+    out.append("static const uint8_t %s_data[] __attribute__((aligned(4))) = {" % name)
+    for i in range(0, len(data), 16):
+        out.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    out.append("};")
+    out.append("static const HTTPStaticContent %s = {" % name)
+    out.append("    %s_data, sizeof(%s_data), \"%s\", \"%s\", %s" % (name, name, ctype, etag.replace('"', '\\"'), "true" if gz else "false"))
+    out.append("};")
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Make a header of HTTPStaticContent from web files")
+    parser.add_argument("-o", "--output", help="Header to write, stdout if not given")
+    parser.add_argument("-n", "--name", action="append", default=[], help="C name for each input, in order, by default from its file name")
+    parser.add_argument("--no-gzip", action="store_true", help="Don't compress inputs which aren't already GZIP files")
+    parser.add_argument("input", nargs="+", help="Files to embed")
+    args = parser.parse_args()
+
+    if len(args.name) > len(args.input):
+        raise SystemExit("More names than input files")
+    out = []
+    out.append("// WARNING: Auto-generated file by tools/makewebcontent.py.  Please do not modify by hand.")
+    out.append("")
+    out.append("#pragma once")
+    out.append("")
+    out.append("#include <HTTPServer.h>")
+    out.append("")
+    for i, path in enumerate(args.input):
+        name = args.name[i] if i < len(args.name) else c_name(path)
+        out.append(convert(path, name, not args.no_gzip))
+    text = "\n".join(out)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
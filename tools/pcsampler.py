@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+
+# Turns PCSampler::dump() output into a report by function, library and memory region
+#
+# Copyright (c) 2022 Earle F. Philhower, III <earlephilhower@yahoo.com>
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+# Functions come from the .elf's symbol table (through arm-none-eabi-nm), and the object
+# file or library each address was linked from comes from the .map, which platform.txt
+# writes next to the .elf.  The dump can be captured from the serial monitor, anything
+# before its "pcsampler" line and after its "end" line is ignored.
+
+import argparse
+import bisect
+import os
+import re
+import subprocess
+import sys
+
+# RP2040 IRQ numbers, exceptions 16 and up
+IRQS = ["TIMER_0", "TIMER_1", "TIMER_2", "TIMER_3", "PWM_WRAP", "USBCTRL", "XIP", "PIO0_0", "PIO0_1",
+        "PIO1_0", "PIO1_1", "DMA_0", "DMA_1", "IO_BANK0", "IO_QSPI", "SIO_PROC0", "SIO_PROC1", "CLOCKS",
+        "SPI0", "SPI1", "UART0", "UART1", "ADC_FIFO", "I2C0", "I2C1", "RTC"]
+EXCEPTIONS = {0: "thread", 2: "NMI", 3: "HardFault", 11: "SVCall", 14: "PendSV", 15: "SysTick"}
+
+
+def exception_name(e):
+    if e in EXCEPTIONS:
+        return EXCEPTIONS[e]
+    if 16 <= e < 16 + len(IRQS):
+        return "IRQ %d (%s)" % (e - 16, IRQS[e - 16])
+    return "exception %d" % e
+
+
+def region(addr):
+    if addr < 0x4000:
+        return "ROM"
+    if 0x10000000 <= addr < 0x20000000:
+        return "flash"
+    if 0x20000000 <= addr < 0x21000000:
+        return "RAM"
+    return "other"
+
+
+def read_dump(f):
+    hz = 0
+    samples = [0, 0]
+    dropped = 0
+    exc = {}
+    pcs = []
+    lrs = []
+    started = False
+    for line in f:
+        w = line.split()
+        if not w:
+            continue
+        if w[0] == "pcsampler" and len(w) == 5:
+            hz, samples[0], samples[1], dropped = (int(x) for x in w[1:])
+            started = True
+        elif not started:
+            continue
+        elif w[0] == "exc" and len(w) == 4:
+            exc[(int(w[1]), int(w[2]))] = int(w[3])
+        elif w[0] in ("pc", "lr") and len(w) == 4:
+            (pcs if w[0] == "pc" else lrs).append((int(w[1], 16), int(w[2]), int(w[3])))
+        elif w[0] == "end":
+            break
+    if not started:
+        raise SystemExit("No PCSampler dump found")
+    return hz, samples, dropped, exc, pcs, lrs
+
+
+def read_symbols(nm, elf):
+    out = subprocess.check_output([nm, "-n", "-S", "-C", elf], universal_newlines=True)
+    syms = []
+    for line in out.splitlines():
+        w = line.split(None, 3)
+        if (len(w) == 4) and (w[2] in ("t", "T", "w", "W")):
+            syms.append((int(w[0], 16) & ~1, int(w[1], 16), w[3]))
+    syms.sort()
+    return syms
+
+
+# Input sections in the "Linker script and memory map" part, where a long section name puts
+# the address, size and file on the next line
+def read_map(path):
+    ranges = []
+    section = re.compile(r"^ (\.\S+)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*))?$")
+    cont = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*)$")
+    pending = False
+    inmap = False
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if line.startswith("Linker script and memory map"):
+                inmap = True
+                continue
+            if not inmap:
+                continue
+            m = section.match(line)
+            if m:
+                pending = m.group(2) is None
+                if not pending:
+                    ranges.append((int(m.group(2), 16), int(m.group(3), 16), m.group(4)))
+                continue
+            if pending:
+                m = cont.match(line)
+                if m:
+                    ranges.append((int(m.group(1), 16), int(m.group(2), 16), m.group(3)))
+                pending = False
+    ranges = [r for r in ranges if r[1]]
+    ranges.sort()
+    return ranges
+
+
+def lookup(table, addr):
+    i = bisect.bisect_right(table, (addr, float("inf"), "")) - 1
+    if i >= 0:
+        start, size, name = table[i]
+        if start <= addr < start + max(size, 1):
+            return name
+    return None
+
+
+# libfoo.a(bar.o) becomes libfoo.a, a loose object file is labelled by its directory
+def library(obj):
+    m = re.match(r"(.*?)\((.*)\)$", obj)
+    if m:
+        return os.path.basename(m.group(1))
+    parent = os.path.basename(os.path.dirname(obj))
+    return (parent + "/" if parent else "") + os.path.basename(obj)
+
+
+def table(title, counts, total, top):
+    print("%s" % title)
+    print("%8s %6s  %s" % ("Samples", "%", "Where"))
+    for name, n in sorted(counts.items(), key=lambda x: -x[1])[:top]:
+        print("%8d %5.1f%%  %s" % (n, 100.0 * n / total if total else 0, name))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Symbolize a PCSampler dump")
+    parser.add_argument("--map", help="Linker map, by default the .elf's name with .map")
+    parser.add_argument("--nm", help="arm-none-eabi-nm to use, by default the core's own")
+    parser.add_argument("--core", type=int, choices=[0, 1], help="Only report this core")
+    parser.add_argument("--top", type=int, default=25, help="Rows per table")
+    parser.add_argument("elf", help="The sketch's .elf")
+    parser.add_argument("dump", nargs="?", help="Captured dump, stdin if not given")
+    args = parser.parse_args()
+
+    nm = args.nm
+    if not nm:
+        nm = os.path.join(os.path.dirname(os.path.realpath(__file__)), "..", "system", "arm-none-eabi", "bin", "arm-none-eabi-nm")
+        if not os.path.exists(nm):
+            nm = "arm-none-eabi-nm"
+    mapfile = args.map or os.path.splitext(args.elf)[0] + ".map"
+
+    if args.dump:
+        with open(args.dump) as f:
+            hz, samples, dropped, exc, pcs, lrs = read_dump(f)
+    else:
+        hz, samples, dropped, exc, pcs, lrs = read_dump(sys.stdin)
+    syms = read_symbols(nm, args.elf)
+    objs = read_map(mapfile) if os.path.exists(mapfile) else []
+
+    cores = [args.core] if args.core is not None else [0, 1]
+    total = sum(samples[c] for c in cores)
+    print("%d Hz, %d samples on core 0, %d on core 1, %d not in the table" % (hz, samples[0], samples[1], dropped))
+    print()
+
+    funcs = {}
+    libs = {}
+    regions = {}
+    callers = {}
+    for addr, c0, c1 in pcs:
+        n = sum((c0, c1)[c] for c in cores)
+        if not n:
+            continue
+        f = lookup(syms, addr) or "0x%08x" % addr
+        o = lookup(objs, addr)
+        funcs[f] = funcs.get(f, 0) + n
+        lib = library(o) if o else "(unknown)"
+        libs[lib] = libs.get(lib, 0) + n
+        regions[region(addr)] = regions.get(region(addr), 0) + n
+    for addr, c0, c1 in lrs:
+        n = sum((c0, c1)[c] for c in cores)
+        if n:
+            f = lookup(syms, addr) or "0x%08x" % addr
+            callers[f] = callers.get(f, 0) + n
+    excs = {}
+    for (c, e), n in exc.items():
+        if c in cores:
+            excs[exception_name(e)] = excs.get(exception_name(e), 0) + n
+
+    table("By function", funcs, total, args.top)
+    table("By caller (LR, approximate)", callers, total, args.top)
+    table("By library or object", libs, total, args.top)
+    table("By memory region", regions, total, args.top)
+    table("By exception", excs, total, args.top)
+
+
+if __name__ == "__main__":
+    main()
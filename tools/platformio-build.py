@@ -266,6 +266,31 @@ configure_network_flags(cpp_defines)
 # ensure LWIP headers are in path after any TINYUSB distributed versions, also PicoSDK USB path headers
 env.Append(CPPPATH=[os.path.join(FRAMEWORK_DIR, "include")])
 
+# board_build.ram_functions = yes runs the hot core, lwIP, USB and BearSSL paths from RAM, as the
+# IDE's "Hot Code" menu does.  memcpy/memset and libgcc are always in RAM
+ram_functions = ""
+if board.get("build.ram_functions", "no") in ("yes", "true", "1"):
+    ram_functions = " ".join([
+        "*libFrameworkArduino.a:Print.cpp.o", "*libFrameworkArduino.a:Stream.cpp.o",
+        "*libpico*.a:pbuf.c.obj", "*libpico*.a:inet_chksum.c.obj", "*libpico*.a:ip.c.obj", "*libpico*.a:ip4.c.obj",
+        "*libpico*.a:tcp_in.c.obj", "*libpico*.a:tcp_out.c.obj", "*libpico*.a:udp.c.obj", "*libpico*.a:etharp.c.obj",
+        "*libpico*.a:ethernet.c.obj", "*libpico*.a:usbd.c.obj", "*libpico*.a:dcd_rp2040.c.obj",
+        "*libpico*.a:rp2040_usb.c.obj", "*libpico*.a:cdc_device.c.obj",
+        "*libbearssl.a:i15_montmul.o", "*libbearssl.a:i15_mulacc.o", "*libbearssl.a:i15_muladd.o",
+        "*libbearssl.a:i15_modpow2.o", "*libbearssl.a:i15_reduce.o", "*libbearssl.a:i15_add.o",
+        "*libbearssl.a:i15_sub.o", "*libbearssl.a:ec_p256_m15.o", "*libbearssl.a:ec_c25519_m15.o"])
+    # Print and Stream's hot methods by section too, which still works when LTO merges objects
+    env.Append(CPPDEFINES=[("RP2040_HOT_CODE_RAM", 1)])
+
+# board_build.lto = yes links with link-time optimization, as the IDE's "Link-Time Optimization"
+# menu does.  gcc-ar gives the framework archive the LTO symbol index the linker plugin needs
+if board.get("build.lto", "no") in ("yes", "true", "1"):
+    env.Append(
+        CCFLAGS=["-flto=auto", "-fuse-linker-plugin"],
+        LINKFLAGS=["-flto=auto", "-fuse-linker-plugin"]
+    )
+    env.Replace(AR="arm-none-eabi-gcc-ar", RANLIB="arm-none-eabi-gcc-ranlib")
+
 # info about the filesystem is already parsed by the platform's main.py 
 # script. We can just use the info here
  
@@ -282,6 +307,7 @@ linkerscript_cmd = env.Command(
         "--sub", "__FS_START__", "$FS_START",
         "--sub", "__FS_END__", "$FS_END",
         "--sub", "__RAM_LENGTH__", "%dk" % (ram_size // 1024),
+        "--sub", "__RAM_FUNCTIONS__", '"%s"' % ram_functions,
     ]), "Generating linkerscript $BUILD_DIR/memmap_default.ld")
 )
 
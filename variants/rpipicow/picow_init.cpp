@@ -20,6 +20,29 @@
 
 #include <pico/cyw43_arch.h>
 
+extern bool __networkCore1;
+
 extern "C" void initVariant() {
+    // In network core mode the driver is started from core 1 so its IRQs (and all
+    // lwIP processing they do) stay on that core
+    if (!__networkCore1) {
+        cyw43_arch_init();
+    }
+}
+
+void initVariantCore1() {
     cyw43_arch_init();
 }
+
+// Core 0 code touching lwIP has to keep the driver's background work on core 1 out
+extern "C" void __lwipLock() {
+    if (__networkCore1) {
+        cyw43_thread_enter();
+    }
+}
+
+extern "C" void __lwipUnlock() {
+    if (__networkCore1) {
+        cyw43_thread_exit();
+    }
+}